@@ -147,6 +147,7 @@ typedef unsigned char		psych_bool;
         typedef unsigned int                    psych_uint32;
         typedef unsigned char                   psych_uint8;
         typedef unsigned short                  psych_uint16;
+        typedef short                           psych_int16;
         typedef GLubyte                         ubyte;          
         #if PSYCH_LANGUAGE == PSYCH_OCTAVE
         typedef psych_bool                      mxLogical;
@@ -177,6 +178,7 @@ typedef unsigned char		psych_bool;
         typedef DWORD                           psych_uint32;
         typedef BYTE                            psych_uint8;
         typedef WORD                            psych_uint16;
+        typedef SHORT                           psych_int16;
         typedef GLubyte                         ubyte;
 		#ifndef PTBOCTAVE3MEX
         #ifndef __cplusplus
@@ -223,6 +225,7 @@ typedef unsigned char		psych_bool;
 	typedef unsigned long 			psych_uint32;
 	typedef Byte					psych_uint8;
 	typedef unsigned short 			psych_uint16;
+	typedef short 					psych_int16;
 	typedef GLubyte				ubyte;		
 
 #elif PSYCH_SYSTEM == PSYCH_OSX
@@ -233,6 +236,7 @@ typedef unsigned char		psych_bool;
         typedef GLubyte				psych_uint8;
         typedef GLubyte				ubyte;
 		typedef UInt16				psych_uint16;
+		typedef SInt16				psych_int16;
         typedef UInt32				psych_uint32;
         typedef unsigned long long	psych_uint64;
         typedef long long			psych_int64;
@@ -2313,6 +2313,42 @@ psych_bool PsychCopyOutUnsignedInt16MatArg(int position, PsychArgRequirementType
 	return(putOut);
 }
 
+/*
+    PsychAllocOutInt16MatArg()
+
+    Like PsychAllocOutDoubleMatArg() execept for signed 16 bit integers instead of doubles.
+*/
+psych_bool PsychAllocOutInt16MatArg(int position, PsychArgRequirementType isRequired, psych_int64 m, psych_int64 n, psych_int64 p, psych_int16 **array)
+{
+	mxArray			**mxpp;
+	PsychError		matchError;
+	psych_bool		putOut;
+	mwSize			dimArray[3];
+	int			numDims;
+
+	// Compute output array dimensions:
+	if (m<=0 || n<=0) {
+		dimArray[0] = 0; dimArray[1] = 0; dimArray[2] = 0;	//this prevents a 0x1 or 1x0 empty matrix, we want 0x0 for empty matrices.
+	} else {
+		PsychCheckmWSizeLimits(m,n,p);
+		dimArray[0] = (mwSize) m; dimArray[1] = (mwSize) n; dimArray[2] = (mwSize) p;
+	}
+	numDims = (p == 0 || p == 1) ? 2 : 3;
+
+	PsychSetReceivedArgDescriptor(position, TRUE, PsychArgOut);
+	PsychSetSpecifiedArgDescriptor(position, PsychArgOut, PsychArgType_int16, isRequired, m,m,n,n,p,p);
+	matchError=PsychMatchDescriptors();
+	putOut=PsychAcceptOutputArgumentDecider(isRequired, matchError);
+	if(putOut){
+		mxpp = PsychGetOutArgMxPtr(position);
+		*mxpp = mxCreateNumericArray(numDims, (mwSize*) dimArray, mxINT16_CLASS, mxREAL);
+		*array = (psych_int16*) mxGetData(*mxpp);
+	}else{
+		*array = (psych_int16*) mxMalloc(sizeof(psych_int16) * (size_t) m * (size_t) n * (size_t) maxInt(1,p));
+	}
+	return(putOut);
+}
+
 /*
 	PsychCopyOutCharArg()
 
@@ -87,6 +87,9 @@ void 	PsychAllocateNativeDoubleMat(psych_int64 m, psych_int64 n, psych_int64 p,
 // for unsigned 16 bit integer:
 psych_bool PsychCopyOutUnsignedInt16MatArg(int position, PsychArgRequirementType isRequired, psych_int64 m, psych_int64 n, psych_int64 p, psych_uint16 *fromArray);
 
+// for signed 16 bit integer:
+psych_bool PsychAllocOutInt16MatArg(int position, PsychArgRequirementType isRequired, psych_int64 m, psych_int64 n, psych_int64 p, psych_int16 **array);
+
 //for psych_bool.  These should be consolidated with the flags below. 
 psych_bool PsychAllocOutBooleanMatArg(int position, PsychArgRequirementType isRequired, psych_int64 m, psych_int64 n, psych_int64 p, PsychNativeBooleanType **array);
 psych_bool PsychCopyOutBooleanArg(int position, PsychArgRequirementType isRequired, PsychNativeBooleanType value);
@@ -22,6 +22,7 @@
 		4/6/05		awi		Updated header comments.
 	  11/14/07		mk		Add debug diagnosis code for Windoze.
 	  11/20/07		mk		Add gettimeofday() and dummy code for OS/X and Linux.
+	  10/19/26		agent	Add 'ClockInfo' subfunction.
 
 	DESCRIPTION:
    
@@ -95,3 +96,62 @@ PsychError GETSECSGetSecs(void)
 	 
     return(PsychError_none);	
 }
+
+PsychError GETSECSClockInfo(void)
+{
+    static char useString[] = "info = GetSecs('ClockInfo');";
+    //                         1
+    static char synopsisString[] = 
+    "Return a struct 'info' with information about the clock used by GetSecs and all timestamps of Psychtoolbox:\n"
+    "'ClockSource' Name of the clock source.\n"
+    "'Resolution' Resolution of the clock in seconds.\n"
+    "'QueryOverhead' Measured mean duration of one query of the clock in seconds.\n"
+    "'MappingUncertainty' Uncertainty in seconds of the calibrated mapping of the clock to the GetSecs timebase, "
+    "zero if the clock defines the timebase itself.\n"
+    "'FrequencyErrorPPM' Estimated error of the clocks frequency calibration in ppm, zero if no calibration is needed.\n"
+    "On Linux, the clock source can be selected via the environment variable PSYCHTOOLBOX_CLOCKSOURCE, see 'help GetSecs'.\n";
+    static char seeAlsoString[] = "";
+
+    const char *FieldNames[] = { "ClockSource", "Resolution", "QueryOverhead", "MappingUncertainty", "FrequencyErrorPPM" };
+    PsychGenericScriptType *s;
+    const char *name;
+    double resolution, overhead = 0, uncertainty = 0, errorPPM = 0;
+    #if PSYCH_SYSTEM != PSYCH_LINUX
+    double t0, t1;
+    int i;
+    #endif
+
+    //all sub functions should have these two lines
+    PsychPushHelp(useString, synopsisString,seeAlsoString);
+    if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+    //check to see if the user supplied superfluous arguments
+    PsychErrorExit(PsychCapNumOutputArgs(1));
+    PsychErrorExit(PsychCapNumInputArgs(0));
+
+    #if PSYCH_SYSTEM == PSYCH_LINUX
+        name = PsychOSGetClockSourceInfo(&resolution, &overhead, &uncertainty, &errorPPM);
+    #else
+        #if PSYCH_SYSTEM == PSYCH_WINDOWS
+            name = "QueryPerformanceCounter";
+        #else
+            name = "mach_absolute_time";
+        #endif
+        PsychGetPrecisionTimerTicksPerSecond(&resolution);
+        resolution = 1.0 / resolution;
+
+        // Measure mean per-call overhead:
+        PsychGetPrecisionTimerSeconds(&t0);
+        for (i = 0; i < 1000; i++) PsychGetPrecisionTimerSeconds(&t1);
+        overhead = (t1 - t0) / 1000;
+    #endif
+
+    PsychAllocOutStructArray(1, FALSE, -1, 5, FieldNames, &s);
+    PsychSetStructArrayStringElement("ClockSource", 0, (char*) name, s);
+    PsychSetStructArrayDoubleElement("Resolution", 0, resolution, s);
+    PsychSetStructArrayDoubleElement("QueryOverhead", 0, overhead, s);
+    PsychSetStructArrayDoubleElement("MappingUncertainty", 0, uncertainty, s);
+    PsychSetStructArrayDoubleElement("FrequencyErrorPPM", 0, errorPPM, s);
+
+    return(PsychError_none);
+}
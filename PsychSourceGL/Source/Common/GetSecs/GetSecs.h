@@ -38,6 +38,7 @@
 //function prototypes
 PsychError MODULEVersion(void); 
 PsychError GETSECSGetSecs(void);
+PsychError GETSECSClockInfo(void);
 
 //end include once
 #endif
@@ -44,6 +44,9 @@ PsychError PsychModuleInit(void)
 	//report the version
 	PsychErrorExit(PsychRegister("Version",  &MODULEVersion));
 
+	// Report info about the clock source:
+	PsychErrorExit(PsychRegister("ClockInfo",  &GETSECSClockInfo));
+
 	//register the module name
 	PsychErrorExit(PsychRegister("GetSecs", NULL));
 	
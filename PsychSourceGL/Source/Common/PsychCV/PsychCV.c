@@ -109,6 +109,8 @@ void InitializeSynopsis()
 	synopsis[i++] = "[markerId] = PsychCV('ARLoadMarker', markerFilename [, isMultiMarker][, patt_width][, patt_center_x][, patt_center_y]);";
 	synopsis[i++] = "[templateMatchingInColor, imageProcessingFullSized, imageProcessingIdeal, trackingWithPCA] = PsychCV('ARTrackerSettings' [, templateMatchingInColor][, imageProcessingFullSized][, imageProcessingIdeal][, trackingWithPCA]);";
 	synopsis[i++] = "[detectedMarkers] = PsychCV('ARDetectMarkers'[, markerSubset][, threshold] [, infoType]);";
+	synopsis[i++] = "[frameId, droppedFrames] = PsychCV('ARDetectMarkersAsync'[, markerSubset][, threshold][, frameTimestamp][, minConfidence]);";
+	synopsis[i++] = "[detectedMarkers, frameTimestamp, frameId, detectDuration, pendingFrames] = PsychCV('ARDetectMarkersPoll'[, waitForResult=0]);";
 	synopsis[i++] = "[scale, minDist, maxDist] = PsychCV('ARRenderSettings' [, scale][, minDist][, maxDist]);";
 	synopsis[i++] = "PsychCV('ARRenderImage');";
 //	synopsis[i++] 
@@ -10,6 +10,7 @@
 	HISTORY:
 	
 	19.04.09		mk		Initial implementation.  
+	19.10.26		agent	Add asynchronous marker detection on a background worker thread.
 	
 	DESCRIPTION:
 	
@@ -25,6 +26,10 @@
 	* Support for 2-Camera stereo processing.
 	* Input image format/color conversion to cope with different input formats.
 	* Use of other nice bits inside toolkit?
+	* Parallel pose estimation for multiple markers: Not possible as long as ARToolkit's
+	  arDetectMarker() and arGetTransMat() family keep their working state in static
+	  variables. Therefore asynchronous detection uses one worker thread which processes
+	  all frames and all markers, serialized against the synchronous path via arToolkitMutex.
 
 */
 
@@ -94,17 +99,61 @@ typedef struct PsychCVARMarkerInfoStruct {
 struct PsychCVARMarkerInfoStruct	arMarkers[PSYCHCVAR_MAX_MARKERCOUNT];
 static int							markerCount = 0;
 
-// Internal helper: Perform image data conversion if required:
-void PsychCVARConvertInputImage(void)
+// Detection result for one candidate marker in one video frame:
+typedef struct PsychCVARMarkerResultStruct {
+	int		id;
+	int		isMultiMarker;
+	double	matchError;
+	double	xformMatrix[16];
+	double	modelviewMatrix[16];
+} PsychCVARMarkerResultStruct;
+
+// Number of video frames that can be queued for asynchronous detection:
+#define PSYCHCVAR_MAX_ASYNCFRAMES 4
+
+// Frame slot for asynchronous detection:
+typedef struct PsychCVARAsyncFrameStruct {
+	int			state;				// 0 = Free, 1 = Queued, 2 = Detection in progress, 3 = Results ready, 4 = Results being fetched.
+	int			frameId;			// Unique, monotonically increasing id of frame.
+	psych_bool	valid;				// Was detection successfull?
+	ARUint8*	image;				// Private copy of input image.
+	ARUint8*	trackimage;			// Image in ARToolkit format, can be == image if no conversion needed.
+	int			threshold;			// Binarization threshold for this frame.
+	double		minConfidence;		// Minimum confidence value for single markers to count as detected.
+	double		frameTimestamp;		// Capture timestamp of frame as provided by usercode, or submission time.
+	double		detectDuration;		// Time in seconds spent by worker on detection.
+	int			numCandidates;		// Number of candidate markers to detect.
+	int			candidates[PSYCHCVAR_MAX_MARKERCOUNT];
+	PsychCVARMarkerResultStruct results[PSYCHCVAR_MAX_MARKERCOUNT];
+} PsychCVARAsyncFrameStruct;
+
+static PsychCVARAsyncFrameStruct	arAsyncFrames[PSYCHCVAR_MAX_ASYNCFRAMES];
+static int							arAsyncFrameCount = 0;
+static int							arAsyncDroppedFrames = 0;
+static psych_bool					arAsyncActive = FALSE;
+static psych_bool					arAsyncShutdown = FALSE;
+static psych_thread					arAsyncThread;
+
+// Mutex protecting arAsyncFrames et al., and condition variables for signalling
+// new work to the worker thread and finished frames to the main thread:
+static psych_mutex					arAsyncMutex;
+static psych_condition				arAsyncWorkSignal;
+static psych_condition				arAsyncDoneSignal;
+
+// Mutex serializing all use of ARToolkit's non-reentrant detection and pose
+// estimation routines and the marker definitions in arMarkers[]:
+static psych_mutex					arToolkitMutex;
+
+// Internal helper: Perform image data conversion from 'src' to 'dst' if required.
+// Returns FALSE if the requested conversion is not supported:
+static psych_bool PsychCVARConvertImage(ARUint8* src, ARUint8* dst)
 {
-	ARUint8* src = arImagebuffer;
-	ARUint8* dst = arTrackBuffer;
 	ARUint8  dummy;
 	int i, count;
-	
+
 	// Conversion needed at all? If input matches requested channelcount and image format
 	// of ARToolkit, then there ain't nothing to do and we can return immediately:
-	if (imgChannels == AR_PIX_SIZE_DEFAULT && imgFormat == AR_DEFAULT_PIXEL_FORMAT) return;
+	if (imgChannels == AR_PIX_SIZE_DEFAULT && imgFormat == AR_DEFAULT_PIXEL_FORMAT) return(TRUE);
 
 	count = imgWidth * imgHeight;
 	
@@ -123,7 +172,7 @@ void PsychCVARConvertInputImage(void)
 			}
 
 			// Done:
-			return;
+			return(TRUE);
 		}
 		else {
 			// ARGB -> BGRA or vice versa. Switch 1st with 4th, 2nd with 3rd:
@@ -138,7 +187,7 @@ void PsychCVARConvertInputImage(void)
 			}
 
 			// Done:
-			return;
+			return(TRUE);
 		}
 	}
 	else {
@@ -154,7 +203,7 @@ void PsychCVARConvertInputImage(void)
 				}
 
 				// Done:
-				return;
+				return(TRUE);
 			}
 			else {
 				// Luminance -> RGBA (or ABGR) expansion: As
@@ -169,7 +218,7 @@ void PsychCVARConvertInputImage(void)
 				}			
 
 				// Done:
-				return;
+				return(TRUE);
 			}
 		}
 		
@@ -187,7 +236,7 @@ void PsychCVARConvertInputImage(void)
 				}
 
 				// Done:
-				return;				
+				return(TRUE);				
 			}
 			
 			if (AR_DEFAULT_PIXEL_FORMAT == AR_PIXEL_FORMAT_BGRA) {
@@ -202,7 +251,7 @@ void PsychCVARConvertInputImage(void)
 				}
 
 				// Done:
-				return;
+				return(TRUE);
 			}
 		
 			// Other target formats etc. are not relevant to our platforms...
@@ -222,7 +271,7 @@ void PsychCVARConvertInputImage(void)
 				}
 
 				// Done:
-				return;
+				return(TRUE);
 			}
 			
 			if (imgFormat == AR_PIXEL_FORMAT_BGRA) {
@@ -237,7 +286,7 @@ void PsychCVARConvertInputImage(void)
 				}
 
 				// Done:
-				return;
+				return(TRUE);
 			}
 		
 			// Other target formats etc. are not relevant to our platforms...
@@ -246,18 +295,291 @@ void PsychCVARConvertInputImage(void)
 
 	// If we reach this point, then some unsupported input -> output conversion
 	// was requested!
-	PsychErrorExitMsg(PsychError_user, "Unknown or unsupported input image format settings 'imgChannels' and/or 'imgFormat' encountered! Check your settings in PsychCV('ARInitialize')!");
+	return(FALSE);
+}
+
+// Internal helper: Perform image data conversion of input image buffer if required:
+void PsychCVARConvertInputImage(void)
+{
+	if (!PsychCVARConvertImage(arImagebuffer, arTrackBuffer)) {
+		PsychErrorExitMsg(PsychError_user, "Unknown or unsupported input image format settings 'imgChannels' and/or 'imgFormat' encountered! Check your settings in PsychCV('ARInitialize')!");
+	}
 	
 	return;
 }
 
+// Internal helper: Match candidate marker 'candHandle' against the 'marker_num' detected markers
+// in 'marker_info', compute its pose and store it in 'result'. Single markers with a confidence
+// value below 'minConfidence' are treated as not detected. Caller must hold arToolkitMutex if
+// asynchronous detection is active:
+static void PsychCVARComputeMarkerPose(int candHandle, ARMarkerInfo* marker_info, int marker_num, double minConfidence, PsychCVARMarkerResultStruct* result)
+{
+	int j, k;
+
+	result->id = candHandle;
+	result->isMultiMarker = arMarkers[candHandle].isMultiMarker;
+
+	// Init 4x4 xform matrices with all-zeros, in case of no detection:
+	memset(result->xformMatrix, 0, sizeof(double) * 4 * 4);
+	memset(result->modelviewMatrix, 0, sizeof(double) * 4 * 4);
+
+	// Multimarker candidate?
+	if (arMarkers[candHandle].isMultiMarker) {
+		// Multimarker candidate:
+		if ( (arMarkers[candHandle].matchError = (double) arMultiGetTransMat(marker_info, marker_num, arMarkers[candHandle].marker.multiMarker)) >= 0) {
+			// Got it! Assign transform Matrix:
+			if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Multimarker %i has matchError %f\n", candHandle, (float) arMarkers[candHandle].matchError);
+			argConvGlpara(arMarkers[candHandle].marker.multiMarker->trans, result->xformMatrix);
+			arglCameraViewRH(arMarkers[candHandle].marker.multiMarker->trans, result->modelviewMatrix, view_scalefactor);
+		}
+		else {
+			// This one not detected, transform matrix will be all-zero:
+			if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Non-Matched MultiMarker %i has matchError %f\n", candHandle, (float) arMarkers[candHandle].matchError);
+			arMarkers[candHandle].matchError = DBL_MAX;
+		}
+	}
+	else {
+		// Singlemarker candidate: Search for best matching pattern:
+		k = -1;
+		for( j = 0; j < marker_num; j++ ) {
+			if( arMarkers[candHandle].marker.singleMarker == marker_info[j].id ) {
+				if( k == -1 ) k = j;
+				else if( marker_info[k].cf < marker_info[j].cf ) k = j;
+			}
+		}
+
+		// Reject best match if it is not reliable enough:
+		if ((k != -1) && (marker_info[k].cf < minConfidence)) k = -1;
+
+		if (k == -1) {
+			arMarkers[candHandle].matchError = DBL_MAX;
+			if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Non-Matched Marker %i with pattern id %i has matchError %f\n", candHandle, arMarkers[candHandle].marker.singleMarker, (float) arMarkers[candHandle].matchError);
+		}
+		else {
+			if (arMarkers[candHandle].matchError == DBL_MAX) {
+				// Previous iteration didn't detect this marker: Previous trans
+				// matrix is invalid:
+				arGetTransMat(&marker_info[k], arMarkers[candHandle].patt_center, arMarkers[candHandle].patt_width, arMarkers[candHandle].oldTrans);
+			}
+			else {
+				// Previous iteration delivered valid result: Use old trans matrix
+				// to stabilize reconstruction in this cycle:
+				arGetTransMatCont(&marker_info[k], arMarkers[candHandle].oldTrans, arMarkers[candHandle].patt_center, arMarkers[candHandle].patt_width, arMarkers[candHandle].oldTrans);
+			}
+
+			// Update reliability:
+			arMarkers[candHandle].matchError = 1.0 - marker_info[k].cf;
+
+			// Extract useful matrices for OpenGL:
+			argConvGlpara(arMarkers[candHandle].oldTrans, result->xformMatrix);
+			arglCameraViewRH(arMarkers[candHandle].oldTrans, result->modelviewMatrix, view_scalefactor);
+
+			if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Marker %i with pattern id %i has matchError %f\n", candHandle, arMarkers[candHandle].marker.singleMarker, (float) arMarkers[candHandle].matchError);
+		}
+	}
+
+	// Assign final matchError
+	result->matchError = arMarkers[candHandle].matchError;
+
+	return;
+}
+
+// Internal helper: Copy 'n' detection results into a newly created struct array
+// in return argument slot 'position':
+static void PsychCVARCopyOutMarkerResults(int position, int n, PsychCVARMarkerResultStruct* results)
+{
+	int i;
+	double*		xformMatrix;
+	double*		ModelviewMatrixGL;
+	PsychGenericScriptType 	*detectedMarkers, *myMatrix;
+	const char *FieldNames[]={	"Id", "MatchError", "MultiMarker", "TransformMatrix", "ModelViewMatrix"};
+
+	// Create our fixed size return array with one slot per requested candidate marker:
+	PsychAllocOutStructArray(position, TRUE, n, 5, FieldNames, &detectedMarkers);
+
+	for (i = 0; i < n; i++) {
+		PsychSetStructArrayDoubleElement("Id", i, results[i].id, detectedMarkers);
+		PsychSetStructArrayDoubleElement("MultiMarker", i, results[i].isMultiMarker, detectedMarkers);
+		PsychSetStructArrayDoubleElement("MatchError", i, results[i].matchError, detectedMarkers);
+
+		xformMatrix = NULL;
+		PsychAllocateNativeDoubleMat(4, 4, 1, &xformMatrix, &myMatrix);
+		memcpy(xformMatrix, results[i].xformMatrix, sizeof(double) * 4 * 4);
+		PsychSetStructArrayNativeElement("TransformMatrix", i, myMatrix, detectedMarkers);
+
+		ModelviewMatrixGL = NULL;
+		PsychAllocateNativeDoubleMat(4, 4, 1, &ModelviewMatrixGL, &myMatrix);
+		memcpy(ModelviewMatrixGL, results[i].modelviewMatrix, sizeof(double) * 4 * 4);
+		PsychSetStructArrayNativeElement("ModelViewMatrix", i, myMatrix, detectedMarkers);
+	}
+
+	return;
+}
+
+// Main routine of the asynchronous detection worker thread: Fetches queued
+// frames in order of submission, runs detection and pose estimation on them,
+// then marks them as ready for pickup by PsychCV('ARDetectMarkersPoll'):
+static void* PsychCVARDetectionThreadMain(void* dummy)
+{
+	PsychCVARAsyncFrameStruct* frame;
+	ARMarkerInfo    *marker_info;
+	int             marker_num;
+	int				i;
+	double			tStart, tEnd;
+
+	while (TRUE) {
+		PsychLockMutex(&arAsyncMutex);
+
+		// Wait for the oldest queued frame or a shutdown request:
+		frame = NULL;
+		while (!arAsyncShutdown) {
+			for (i = 0; i < PSYCHCVAR_MAX_ASYNCFRAMES; i++) {
+				if ((arAsyncFrames[i].state == 1) && ((frame == NULL) || (arAsyncFrames[i].frameId < frame->frameId))) frame = &arAsyncFrames[i];
+			}
+
+			if (frame) break;
+			PsychWaitCondition(&arAsyncWorkSignal, &arAsyncMutex);
+		}
+
+		if (arAsyncShutdown) {
+			PsychUnlockMutex(&arAsyncMutex);
+			break;
+		}
+
+		// Mark frame as in progress, so main thread doesn't recycle it:
+		frame->state = 2;
+		PsychUnlockMutex(&arAsyncMutex);
+
+		PsychGetAdjustedPrecisionTimerSeconds(&tStart);
+
+		// Perform image data conversion if required:
+		frame->valid = PsychCVARConvertImage(frame->image, frame->trackimage);
+
+		PsychLockMutex(&arToolkitMutex);
+
+		// Do the actual detection:
+		if (frame->valid && (arDetectMarker(frame->trackimage, frame->threshold, &marker_info, &marker_num) < 0)) frame->valid = FALSE;
+
+		// Pose estimation for all candidates:
+		for (i = 0; i < frame->numCandidates; i++) {
+			if (frame->valid) {
+				PsychCVARComputeMarkerPose(frame->candidates[i], marker_info, marker_num, frame->minConfidence, &(frame->results[i]));
+			}
+			else {
+				memset(&(frame->results[i]), 0, sizeof(PsychCVARMarkerResultStruct));
+				frame->results[i].id = frame->candidates[i];
+				frame->results[i].isMultiMarker = arMarkers[frame->candidates[i]].isMultiMarker;
+				frame->results[i].matchError = DBL_MAX;
+			}
+		}
+
+		PsychUnlockMutex(&arToolkitMutex);
+
+		PsychGetAdjustedPrecisionTimerSeconds(&tEnd);
+
+		// Hand results over to main thread:
+		PsychLockMutex(&arAsyncMutex);
+		frame->detectDuration = tEnd - tStart;
+		frame->state = 3;
+		PsychSignalCondition(&arAsyncDoneSignal);
+		PsychUnlockMutex(&arAsyncMutex);
+	}
+
+	return(NULL);
+}
+
+// Internal helper: Release all frame buffers for asynchronous detection:
+static void PsychCVARReleaseAsyncFrames(void)
+{
+	int i;
+
+	for (i = 0; i < PSYCHCVAR_MAX_ASYNCFRAMES; i++) {
+		if ((arAsyncFrames[i].trackimage) && (arAsyncFrames[i].trackimage != arAsyncFrames[i].image)) free(arAsyncFrames[i].trackimage);
+		arAsyncFrames[i].trackimage = NULL;
+
+		if (arAsyncFrames[i].image) free(arAsyncFrames[i].image);
+		arAsyncFrames[i].image = NULL;
+
+		arAsyncFrames[i].state = 0;
+	}
+
+	return;
+}
+
+// Internal helper: Stop asynchronous detection worker thread, if any, and release its frame buffers:
+static void PsychCVARStopAsyncDetection(void)
+{
+	if (!arAsyncActive) return;
+
+	// Send shutdown request to thread and wait for it to die peacefully:
+	PsychLockMutex(&arAsyncMutex);
+	arAsyncShutdown = TRUE;
+	PsychSignalCondition(&arAsyncWorkSignal);
+	PsychUnlockMutex(&arAsyncMutex);
+	PsychDeleteThread(&arAsyncThread);
+
+	PsychCVARReleaseAsyncFrames();
+
+	arAsyncActive = FALSE;
+	arAsyncShutdown = FALSE;
+
+	return;
+}
+
+// Internal helper: Allocate frame buffers and start asynchronous detection worker thread:
+static void PsychCVARStartAsyncDetection(void)
+{
+	int i, rc;
+
+	if (arAsyncActive) return;
+
+	memset(arAsyncFrames, 0, sizeof(arAsyncFrames));
+	for (i = 0; i < PSYCHCVAR_MAX_ASYNCFRAMES; i++) {
+		// Same allocation strategy as for arImagebuffer and arTrackBuffer in PsychCV('ARInitialize'):
+		arAsyncFrames[i].image = (ARUint8*) malloc(imgWidth * imgHeight * 4);
+		if (AR_PIX_SIZE_DEFAULT != imgChannels) {
+			arAsyncFrames[i].trackimage = (ARUint8*) malloc(imgWidth * imgHeight * AR_PIX_SIZE_DEFAULT);
+		}
+		else {
+			arAsyncFrames[i].trackimage = arAsyncFrames[i].image;
+		}
+
+		if ((NULL == arAsyncFrames[i].image) || (NULL == arAsyncFrames[i].trackimage)) {
+			PsychCVARReleaseAsyncFrames();
+			PsychErrorExitMsg(PsychError_outofMemory, "Out of memory when trying to allocate buffers for asynchronous marker detection!");
+		}
+	}
+
+	arAsyncShutdown = FALSE;
+	arAsyncDroppedFrames = 0;
+
+	if ((rc = PsychCreateThread(&arAsyncThread, NULL, PsychCVARDetectionThreadMain, NULL))) {
+		printf("PsychCV-ERROR: Could not create marker detection thread [%s].\n", strerror(rc));
+		PsychCVARReleaseAsyncFrames();
+		PsychErrorExitMsg(PsychError_system, "Thread creation failed!");
+	}
+
+	arAsyncActive = TRUE;
+
+	return;
+}
+
 void PsychCVARExit(void)
 {
 	int i;
-	
+
 	// Perform Shutdown operation, if needed. Called from PsychCVExit routine
 	// at PsychCV shutdown/flush time, or explicitely via subfunction 'ARShutdown':
 	if (psychCVARInitialized) {
+		// Stop asynchronous detection, if active. Must happen before anything else
+		// gets released, as the worker thread may still use it:
+		PsychCVARStopAsyncDetection();
+
+		PsychDestroyCondition(&arAsyncWorkSignal);
+		PsychDestroyCondition(&arAsyncDoneSignal);
+		PsychDestroyMutex(&arAsyncMutex);
+		PsychDestroyMutex(&arToolkitMutex);
+
 		// Release buffer memory, if any:
 		if ((arTrackBuffer) && (arTrackBuffer != arImagebuffer)) free(arTrackBuffer);
 		arTrackBuffer = NULL;
@@ -416,6 +738,14 @@ PsychError PSYCHCVARInitialize(void)
 	// Init threshold to 128 == 50% max intensity on 8 bit input values:
 	imgBinarizationThreshold = 128;
 
+	// Setup locking and signalling for asynchronous marker detection:
+	PsychInitMutex(&arAsyncMutex);
+	PsychInitMutex(&arToolkitMutex);
+	PsychInitCondition(&arAsyncWorkSignal, NULL);
+	PsychInitCondition(&arAsyncDoneSignal, NULL);
+	arAsyncActive = FALSE;
+	arAsyncFrameCount = 0;
+
 	// We're online!
 	psychCVARInitialized = TRUE;
 	
@@ -474,6 +804,9 @@ PsychError PSYCHCVARLoadMarker(void)
 
 	char*			markerFilename = NULL;
 	int				isMultiMarker = 0;
+	int				loadError = 0;
+	double			patt_width;
+	double			patt_center[2];
 	
 	// Setup online help: 
 	PsychPushHelp(useString, synopsisString, seeAlsoString);
@@ -495,44 +828,57 @@ PsychError PSYCHCVARLoadMarker(void)
 	// Find next slot in our array:
 	if (markerCount >= PSYCHCVAR_MAX_MARKERCOUNT) PsychErrorExitMsg(PsychError_user, "Cannot load new marker definition, as maximum allowable markercount exceeded!");
 
+	// Get optional pattern properties for single marker matching:
+
+	// Init pattern width to 80 mm, with optional override:
+	patt_width = 80.0;
+	PsychCopyInDoubleArg(3, FALSE, &patt_width);
+
+	// Init pattern center to (0,0), with optional (x,y) override:
+	patt_center[0] = 0.0;
+	patt_center[1] = 0.0;
+	PsychCopyInDoubleArg(4, FALSE, &(patt_center[0]));
+	PsychCopyInDoubleArg(5, FALSE, &(patt_center[1]));
+
+	// Loading and activation of patterns modifies ARToolkit's internal pattern tables,
+	// which must not happen while an asynchronous marker detection is in progress:
+	PsychLockMutex(&arToolkitMutex);
+
 	// Multimarker load?
 	if (isMultiMarker) {
 		// Load multi marker:
 		arMarkers[markerCount].isMultiMarker = 1;
 		if((arMarkers[markerCount].marker.multiMarker = arMultiReadConfigFile(markerFilename)) == NULL) {
-			printf("PsychCV: ERROR: Failed to load multi-markerfile %s .\n", markerFilename);
-			PsychErrorExitMsg(PsychError_user, "Failed to load multimarker definition file! Invalid filename or file inaccessible?");
+			loadError = 1;
 		}
-
-		if (-1 == arMultiActivate(arMarkers[markerCount].marker.multiMarker)) PsychErrorExitMsg(PsychError_user, "Failed to activate multimarker!");
+		else if (-1 == arMultiActivate(arMarkers[markerCount].marker.multiMarker)) loadError = 2;
 	}
 	else {
 		// Load single marker:
 		arMarkers[markerCount].isMultiMarker = 0;
 		if((arMarkers[markerCount].marker.singleMarker = arLoadPatt(markerFilename)) < 0) {
-			printf("PsychCV: ERROR: Failed to load single-markerfile %s.\n", markerFilename);
-			PsychErrorExitMsg(PsychError_user, "Failed to load single marker definition file! Invalid filename or file inaccessible?");
+			loadError = 1;
 		}
-		
-		// Static pattern properties for single marker matching:
-		
-		// Init pattern width to 80 mm:
-		arMarkers[markerCount].patt_width = 80.0;
+		else {
+			// Static pattern properties for single marker matching:
+			arMarkers[markerCount].patt_width = patt_width;
+			arMarkers[markerCount].patt_center[0] = patt_center[0];
+			arMarkers[markerCount].patt_center[1] = patt_center[1];
 
-		// Optional override:
-		PsychCopyInDoubleArg(3, FALSE, &(arMarkers[markerCount].patt_width));
-		
-		// Init pattern center to (0,0)
-		arMarkers[markerCount].patt_center[0] = 0.0;
-		arMarkers[markerCount].patt_center[1] = 0.0;
+			if (-1 == arActivatePatt(arMarkers[markerCount].marker.singleMarker)) loadError = 2;
+		}
+	}
 
-		// Optional (x,y) override:
-		PsychCopyInDoubleArg(4, FALSE, &(arMarkers[markerCount].patt_center[0]));
-		PsychCopyInDoubleArg(5, FALSE, &(arMarkers[markerCount].patt_center[1]));
+	PsychUnlockMutex(&arToolkitMutex);
 
-		if (-1 == arActivatePatt(arMarkers[markerCount].marker.singleMarker)) PsychErrorExitMsg(PsychError_user, "Failed to activate pattern!");
+	if (loadError == 1) {
+		printf("PsychCV: ERROR: Failed to load %s-markerfile %s.\n", (isMultiMarker) ? "multi" : "single", markerFilename);
+		if (isMultiMarker) PsychErrorExitMsg(PsychError_user, "Failed to load multimarker definition file! Invalid filename or file inaccessible?");
+		PsychErrorExitMsg(PsychError_user, "Failed to load single marker definition file! Invalid filename or file inaccessible?");
 	}
 
+	if (loadError == 2) PsychErrorExitMsg(PsychError_user, (isMultiMarker) ? "Failed to activate multimarker!" : "Failed to activate pattern!");
+
 	// Initialize matchError to infinite:
 	arMarkers[markerCount].matchError = DBL_MAX;
 
@@ -546,6 +892,51 @@ PsychError PSYCHCVARLoadMarker(void)
 	return(PsychError_none);
 }
 
+// Internal helper: Get optional list of candidate marker handles from input argument
+// 'position' into 'candidates', or all loaded markers if omitted. Returns count of candidates:
+static int PsychCVARGetMarkerSubset(int position, int* candidates)
+{
+	double*		markerSubset = NULL;
+	int			i, m, n, p;
+
+	if (PsychAllocInDoubleMatArg(position, FALSE, &m, &n, &p, &markerSubset)) {
+		// List provided: Sanity check!
+		if (p != 1 || (m*n < 1) || (m*n > PSYCHCVAR_MAX_MARKERCOUNT)) PsychErrorExitMsg(PsychError_user, "Invalid 'markerSubset' specified: Must be a 1D or 2D vector or matrix with handles!");
+		n = m * n;
+
+		// Validate...
+		for (i = 0; i < n; i++) {
+			if (markerSubset[i] < 0 || markerSubset[i] >= markerCount) {
+				printf("PsychCV-ERROR: Invalid markerhandle %i passed in 'markerSubset' argument! No such marker available!\n", (int) markerSubset[i]);
+				PsychErrorExitMsg(PsychError_user, "Invalid 'markerSubset' specified: Must be a 1D or 2D vector or matrix with handles!");
+			}
+			candidates[i] = (int) markerSubset[i];
+		}
+	}
+	else {
+		// No list provided: Create our default match list which contains all current markers:
+		n = markerCount;
+		for (i = 0; i < n; i++) candidates[i] = i;
+	}
+
+	return(n);
+}
+
+// Internal helper: Get optional binarization threshold from input argument 'position',
+// defaulting to and updating our current default threshold:
+static void PsychCVARGetThreshold(int position)
+{
+	double		threshold;
+
+	// Get optional threshold value, default to our startup default:
+	threshold = (double) imgBinarizationThreshold;
+	PsychCopyInDoubleArg(position, FALSE, &threshold);
+	if (threshold < 1 || threshold > 254) PsychErrorExitMsg(PsychError_user, "Invalid 'threshold' provided. Must be integer between 1 and 254!");
+
+	// Update our default threshold with new value:
+	imgBinarizationThreshold = (int) (threshold + 0.5);
+}
+
 PsychError PSYCHCVARDetectMarkers(void)
 {
  	static char useString[] = "[detectedMarkers] = PsychCV('ARDetectMarkers'[, markerSubset][, threshold] [, infoType]);";
@@ -563,25 +954,18 @@ PsychError PSYCHCVARDetectMarkers(void)
 		"If you don't want to detect all markers, but only a subset, pass a list of "
 		"candidate marker handles via 'markerSubset'. Provide an optional greylevel "
 		"threshold value for image processing in 'threshold'. Ask only for a subset of "
-		"information by providing 'infoType'.\n\n";
+		"information by providing 'infoType'.\n\n"
+		"See PsychCV('ARDetectMarkersAsync') for a non-blocking variant of this function.\n\n";
 
-	static char seeAlsoString[] = "";	 
-	double*		markerSubset = NULL;
-	int			i,m,n,p;
-	double		threshold;
+	static char seeAlsoString[] = "ARDetectMarkersAsync ARDetectMarkersPoll";	 
+	int			i, n;
 	int			infoType;
-	int			candHandle;
+	int			candidates[PSYCHCVAR_MAX_MARKERCOUNT];
+	PsychCVARMarkerResultStruct* results;
 
     ARMarkerInfo    *marker_info;
     int             marker_num;
-    int             j, k;
 
-	double*		xformMatrix;
-	double*		ModelviewMatrixGL;
-	
-	PsychGenericScriptType 	*detectedMarkers, *myMatrix;
-	const char *FieldNames[]={	"Id", "MatchError", "MultiMarker", "TransformMatrix", "ModelViewMatrix"};
-	
 	// Setup online help: 
 	PsychPushHelp(useString, synopsisString, seeAlsoString);
 	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
@@ -600,41 +984,24 @@ PsychError PSYCHCVARDetectMarkers(void)
 	arDebug = (verbosity > 5) ? 1 : 0;
 
 	// Get optional markerSubset list:
-	if (PsychAllocInDoubleMatArg(1, FALSE, &m, &n, &p, &markerSubset)) {
-		// List provided: Sanity check!
-		if (p != 1 || (m*n < 1)) PsychErrorExitMsg(PsychError_user, "Invalid 'markerSubset' specified: Must be a 1D or 2D vector or matrix with handles!");
-		n = m * n;
+	n = PsychCVARGetMarkerSubset(1, candidates);
 
-		// Validate...
-		for (i = 0; i < n; i++) {
-			if (markerSubset[i] < 0 || markerSubset[i] >= markerCount) {
-				printf("PsychCV-ERROR: Invalid markerhandle %i passed in 'markerSubset' argument! No such marker available!\n", markerSubset[i]);
-				PsychErrorExitMsg(PsychError_user, "Invalid 'markerSubset' specified: Must be a 1D or 2D vector or matrix with handles!");
-			}
-		}
-	}
-	else {
-		// No list provided: Create our default match list which contains all current markers:
-		markerSubset = (double*) PsychMallocTemp(sizeof(double) * markerCount);
-		n = markerCount;
-		for (i = 0; i < n; i++) markerSubset[i] = (double) i;
-	}
-	
-	// Get optional threshold value, default to our startup default:
-	threshold = (double) imgBinarizationThreshold;
-	PsychCopyInDoubleArg(2, FALSE, &threshold);
-	if (threshold < 1 || threshold > 254) PsychErrorExitMsg(PsychError_user, "Invalid 'threshold' provided. Must be integer between 1 and 254!");
-
-	// Update our default threshold with new value:
-	imgBinarizationThreshold = (int) (threshold + 0.5);
+	// Get optional threshold value:
+	PsychCVARGetThreshold(2);
 
 	// Get optional infoType flag:
 	infoType = 0xffffff;
 	PsychCopyInIntegerArg(3, FALSE, &infoType);
 	if (infoType < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'infoType' provided. Must be positive integer!");
-	
+
+	results = (PsychCVARMarkerResultStruct*) PsychMallocTemp(sizeof(PsychCVARMarkerResultStruct) * n);
+
+	// Serialize against a possibly running asynchronous detection:
+	PsychLockMutex(&arToolkitMutex);
+
 	// Ok, we got the user arguments. Let's do the actual detection:
 	if(arDetectMarker(arTrackBuffer, imgBinarizationThreshold, &marker_info, &marker_num) < 0) {
+		PsychUnlockMutex(&arToolkitMutex);
 		PsychErrorExitMsg(PsychError_user, "Marker detection failed for some reason. [arDetectMarker() failed]!");
 	}
 
@@ -644,88 +1011,10 @@ PsychError PSYCHCVARDetectMarkers(void)
 			printf("Marker %i: id = %i, cf = %f\n", i, marker_info[i].id, marker_info[i].cf);
 		}
 	}
-	
-	// Any markers detected?
-	// Create our fixed size return array with one slot per requested candidate marker:
-	PsychAllocOutStructArray(1, TRUE, n, 5, FieldNames, &detectedMarkers);
 
 	// Process all our 'n' candidate markers against detected markers:
-	for (i = 0; i < n; i++) {
-		// Retrieve handle of i'th candidate:
-		candHandle = (int) markerSubset[i];
-		
-		// Assign marker id to output slot:
-		PsychSetStructArrayDoubleElement("Id", i, candHandle, detectedMarkers);
-		
-		// Assign multimarker flag:
-		PsychSetStructArrayDoubleElement("MultiMarker", i, arMarkers[candHandle].isMultiMarker, detectedMarkers);
-		
-		// Allocate and assign 4x4 xform matrix: xformmatrix must be filled with the 16 values
-		// of the actual matrix later on, we init it with all-zeros:
-		xformMatrix = NULL;
-		PsychAllocateNativeDoubleMat(4, 4, 1, &xformMatrix, &myMatrix);
-		PsychSetStructArrayNativeElement("TransformMatrix", i, myMatrix, detectedMarkers);
-		memset(xformMatrix, 0, sizeof(double) * 4 * 4);
-		ModelviewMatrixGL = NULL;
-		PsychAllocateNativeDoubleMat(4, 4, 1, &ModelviewMatrixGL, &myMatrix);
-		PsychSetStructArrayNativeElement("ModelViewMatrix", i, myMatrix, detectedMarkers);
-		memset(ModelviewMatrixGL, 0, sizeof(double) * 4 * 4);
-
-		// Multimarker candidate?
-		if (arMarkers[candHandle].isMultiMarker) {
-			// Multimarker candidate:
-			if ( (arMarkers[candHandle].matchError = (double) arMultiGetTransMat(marker_info, marker_num, arMarkers[candHandle].marker.multiMarker)) >= 0) {
-				// Got it! Assign transform Matrix:
-				if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Multimarker %i has matchError %f\n", candHandle, (float) arMarkers[candHandle].matchError);
-				argConvGlpara(arMarkers[candHandle].marker.multiMarker->trans, xformMatrix);  
-				arglCameraViewRH(arMarkers[candHandle].marker.multiMarker->trans, ModelviewMatrixGL, view_scalefactor);
-			}
-			else {
-				// This one not detected, transform matrix will be all-zero:
-				if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Non-Matched MultiMarker %i has matchError %f\n", candHandle, (float) arMarkers[candHandle].matchError);
-				arMarkers[candHandle].matchError = DBL_MAX;
-			}
-		}
-		else {
-			// Singlemarker candidate: Search for best matching pattern:
-			k = -1;
-			for( j = 0; j < marker_num; j++ ) {
-				if( arMarkers[candHandle].marker.singleMarker == marker_info[j].id ) {
-					if( k == -1 ) k = j;
-					else if( marker_info[k].cf < marker_info[j].cf ) k = j;
-				}
-			}
-			if (k == -1) {
-				arMarkers[candHandle].matchError = DBL_MAX;
-				if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Non-Matched Marker %i with pattern id %i has matchError %f\n", candHandle, arMarkers[candHandle].marker.singleMarker, (float) arMarkers[candHandle].matchError);
-			}
-			else {
-				if (arMarkers[candHandle].matchError == DBL_MAX) {
-					// Previous iteration didn't detect this marker: Previous trans
-					// matrix is invalid:
-					arGetTransMat(&marker_info[k], arMarkers[candHandle].patt_center, arMarkers[candHandle].patt_width, arMarkers[candHandle].oldTrans);
-				}
-				else {
-					// Previous iteration delivered valid result: Use old trans matrix
-					// to stabilize reconstruction in this cycle:
-					arGetTransMatCont(&marker_info[k], arMarkers[candHandle].oldTrans, arMarkers[candHandle].patt_center, arMarkers[candHandle].patt_width, arMarkers[candHandle].oldTrans);
-				}
-				
-				// Update reliability:
-				arMarkers[candHandle].matchError = 1.0 - marker_info[k].cf;
-				
-				// Extract useful matrices for OpenGL:
-				argConvGlpara(arMarkers[candHandle].oldTrans, xformMatrix);
-				arglCameraViewRH(arMarkers[candHandle].oldTrans, ModelviewMatrixGL, view_scalefactor);
-
-				if (verbosity > 4) printf("PsychCV-INFO: ARDetectMarkers: Marker %i with pattern id %i has matchError %f\n", candHandle, arMarkers[candHandle].marker.singleMarker, (float) arMarkers[candHandle].matchError);
-			}			
-		}
+	for (i = 0; i < n; i++) PsychCVARComputeMarkerPose(candidates[i], marker_info, marker_num, 0.0, &results[i]);
 
-		// Assign final matchError
-		PsychSetStructArrayDoubleElement("MatchError", i, arMarkers[candHandle].matchError, detectedMarkers);
-	}
-	
 	// Ouput binarized debug image?
 	if (verbosity > 6) {
 		if (NULL != arImage) {
@@ -735,6 +1024,197 @@ PsychError PSYCHCVARDetectMarkers(void)
 		else printf("PsychCV-DEBUG: arImage == NULL! arDebug = %i\n", arDebug);
 	}
 
+	PsychUnlockMutex(&arToolkitMutex);
+
+	// Create our fixed size return array with one slot per requested candidate marker:
+	PsychCVARCopyOutMarkerResults(1, n, results);
+
+	// Ready.
+	return(PsychError_none);
+}
+
+PsychError PSYCHCVARDetectMarkersAsync(void)
+{
+ 	static char useString[] = "[frameId, droppedFrames] = PsychCV('ARDetectMarkersAsync'[, markerSubset][, threshold][, frameTimestamp][, minConfidence]);";
+	//							1		 2															1				2			 3				   4
+	static char synopsisString[] = 
+		"Queue the current video image for asynchronous marker detection, return immediately.\n\n"
+		"A copy of the current video image in the internal input image buffer is handed "
+		"over to a background worker thread, which performs the same detection and pose "
+		"estimation as PsychCV('ARDetectMarkers'), while your script continues. Fetch the "
+		"results via PsychCV('ARDetectMarkersPoll'). The input image buffer can be refilled "
+		"with the next video image immediately after this call returns.\n"
+		"'markerSubset' and 'threshold' have the same meaning as in PsychCV('ARDetectMarkers'). "
+		"'frameTimestamp' is an optional timestamp to associate with this frame, e.g., the "
+		"capture timestamp returned by Screen('GetCapturedImage'). It defaults to the GetSecs "
+		"time of submission. 'minConfidence' is an optional minimum confidence value between "
+		"0 and 1 that a detected single marker must reach to count as detected. It defaults to "
+		"zero, ie., accept all matches.\n"
+		"The worker thread is started at first invocation and stopped by PsychCV('ARShutdown'). "
+		"At most 4 frames can be pending. If the queue is full, the oldest frame which "
+		"is not yet in processing, or whose results have not yet been fetched, gets dropped.\n"
+		"Returns a unique 'frameId' for the queued frame and the total count of dropped "
+		"frames 'droppedFrames' so far.\n\n";
+
+	static char seeAlsoString[] = "ARDetectMarkers ARDetectMarkersPoll";	 
+
+	PsychCVARAsyncFrameStruct* frame;
+	int			i, n;
+	int			candidates[PSYCHCVAR_MAX_MARKERCOUNT];
+	double		frameTimestamp, minConfidence;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(0)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(2));	 // The maximum number of outputs
+
+	if (!psychCVARInitialized) PsychErrorExitMsg(PsychError_user, "ARToolkit not yet initialized! Call PsychCV('ARInitialize') first and retry!");
+	if (markerCount < 1) PsychErrorExitMsg(PsychError_user, "No markers loaded for detection! Call PsychCV('ARLoadMarker') first to load at least one marker and retry!");
+
+	// Get optional markerSubset list:
+	n = PsychCVARGetMarkerSubset(1, candidates);
+
+	// Get optional threshold value:
+	PsychCVARGetThreshold(2);
+
+	// Get optional frame timestamp, default to now:
+	PsychGetAdjustedPrecisionTimerSeconds(&frameTimestamp);
+	PsychCopyInDoubleArg(3, FALSE, &frameTimestamp);
+
+	// Get optional confidence threshold:
+	minConfidence = 0.0;
+	PsychCopyInDoubleArg(4, FALSE, &minConfidence);
+	if (minConfidence < 0 || minConfidence > 1) PsychErrorExitMsg(PsychError_user, "Invalid 'minConfidence' provided. Must be between 0 and 1!");
+
+	// Start worker thread on first use:
+	PsychCVARStartAsyncDetection();
+
+	PsychLockMutex(&arAsyncMutex);
+
+	// Find a free slot, or the oldest droppable frame if none is free:
+	frame = NULL;
+	for (i = 0; i < PSYCHCVAR_MAX_ASYNCFRAMES; i++) {
+		if (arAsyncFrames[i].state == 0) {
+			frame = &arAsyncFrames[i];
+			break;
+		}
+
+		if (((arAsyncFrames[i].state == 1) || (arAsyncFrames[i].state == 3)) && ((frame == NULL) || (arAsyncFrames[i].frameId < frame->frameId))) frame = &arAsyncFrames[i];
+	}
+
+	// This can't fail, as only one frame can be in processing at a time:
+	if (frame->state != 0) arAsyncDroppedFrames++;
+
+	// Mark frame as free while we fill it, so the worker doesn't touch it:
+	frame->state = 0;
+	PsychUnlockMutex(&arAsyncMutex);
+
+	// Assign parameters, copy current input image:
+	frame->numCandidates = n;
+	memcpy(frame->candidates, candidates, sizeof(int) * n);
+	frame->threshold = imgBinarizationThreshold;
+	frame->frameTimestamp = frameTimestamp;
+	frame->minConfidence = minConfidence;
+	frame->detectDuration = 0;
+	memcpy(frame->image, arImagebuffer, imgWidth * imgHeight * imgChannels);
+
+	// Queue it for processing by the worker thread:
+	PsychLockMutex(&arAsyncMutex);
+	frame->frameId = arAsyncFrameCount++;
+	frame->state = 1;
+	PsychSignalCondition(&arAsyncWorkSignal);
+	PsychUnlockMutex(&arAsyncMutex);
+
+	PsychCopyOutDoubleArg(1, FALSE, frame->frameId);
+	PsychCopyOutDoubleArg(2, FALSE, arAsyncDroppedFrames);
+
+	// Ready.
+	return(PsychError_none);
+}
+
+PsychError PSYCHCVARDetectMarkersPoll(void)
+{
+ 	static char useString[] = "[detectedMarkers, frameTimestamp, frameId, detectDuration, pendingFrames] = PsychCV('ARDetectMarkersPoll'[, waitForResult=0]);";
+	//							1				 2				 3		  4				  5														   1
+	static char synopsisString[] = 
+		"Fetch results of asynchronous marker detection started via PsychCV('ARDetectMarkersAsync').\n\n"
+		"Returns results for the oldest frame whose detection has completed. If no results "
+		"are available yet, an empty 'detectedMarkers' array and a 'frameId' of -1 are returned "
+		"immediately, unless the optional flag 'waitForResult' is set to 1, in which case the "
+		"function waits for the next frame to complete, as long as any frames are pending.\n"
+		"'detectedMarkers' is an array of structs in the same format as returned by "
+		"PsychCV('ARDetectMarkers'). 'frameTimestamp' is the timestamp associated with the frame "
+		"at submission time, 'frameId' is its unique id as returned by PsychCV('ARDetectMarkersAsync'). "
+		"'detectDuration' is the time in seconds the worker thread spent on detection and pose "
+		"estimation for this frame. 'pendingFrames' is the number of frames still queued or in "
+		"processing.\n\n";
+
+	static char seeAlsoString[] = "ARDetectMarkers ARDetectMarkersAsync";	 
+
+	PsychCVARAsyncFrameStruct* frame;
+	int			i, pending, waitForResult;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(1));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(0)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(5));	 // The maximum number of outputs
+
+	if (!psychCVARInitialized) PsychErrorExitMsg(PsychError_user, "ARToolkit not yet initialized! Call PsychCV('ARInitialize') first and retry!");
+
+	waitForResult = 0;
+	PsychCopyInIntegerArg(1, FALSE, &waitForResult);
+
+	frame = NULL;
+	pending = 0;
+
+	if (arAsyncActive) {
+		PsychLockMutex(&arAsyncMutex);
+		while (TRUE) {
+			// Find oldest completed frame, count pending ones:
+			pending = 0;
+			for (i = 0; i < PSYCHCVAR_MAX_ASYNCFRAMES; i++) {
+				if ((arAsyncFrames[i].state == 3) && ((frame == NULL) || (arAsyncFrames[i].frameId < frame->frameId))) frame = &arAsyncFrames[i];
+				if ((arAsyncFrames[i].state == 1) || (arAsyncFrames[i].state == 2)) pending++;
+			}
+
+			if (frame || !waitForResult || (pending == 0)) break;
+			PsychWaitCondition(&arAsyncDoneSignal, &arAsyncMutex);
+		}
+
+		// Take frame out of the queue, so submission doesn't recycle it while we copy out:
+		if (frame) frame->state = 4;
+		PsychUnlockMutex(&arAsyncMutex);
+	}
+
+	if (NULL == frame) {
+		// Nothing available:
+		PsychCVARCopyOutMarkerResults(1, 0, NULL);
+		PsychCopyOutDoubleArg(2, FALSE, -1);
+		PsychCopyOutDoubleArg(3, FALSE, -1);
+		PsychCopyOutDoubleArg(4, FALSE, 0);
+		PsychCopyOutDoubleArg(5, FALSE, pending);
+		return(PsychError_none);
+	}
+
+	PsychCVARCopyOutMarkerResults(1, frame->numCandidates, frame->results);
+	PsychCopyOutDoubleArg(2, FALSE, frame->frameTimestamp);
+	PsychCopyOutDoubleArg(3, FALSE, frame->frameId);
+	PsychCopyOutDoubleArg(4, FALSE, frame->detectDuration);
+	PsychCopyOutDoubleArg(5, FALSE, pending);
+
+	// Release slot:
+	PsychLockMutex(&arAsyncMutex);
+	frame->state = 0;
+	PsychUnlockMutex(&arAsyncMutex);
+
+	if (!frame->valid) PsychErrorExitMsg(PsychError_user, "Marker detection failed for some reason. Unsupported 'imgChannels' and/or 'imgFormat' settings or arDetectMarker() failed!");
+
 	// Ready.
 	return(PsychError_none);
 }
@@ -863,15 +1343,23 @@ PsychError PSYCHCVARTrackerSettings(void)
 	PsychCopyOutDoubleArg(3, FALSE, (arFittingMode == AR_FITTING_TO_IDEAL) ? 1 : 0);
 	PsychCopyOutDoubleArg(4, FALSE, (arMatchingPCAMode == AR_MATCHING_WITH_PCA) ? 1 : 0);
 
-	// Copy in optional new settings:
+	// Copy in optional new settings, defaulting to old settings:
+	templateMatchingInColor = (arTemplateMatchingMode == AR_TEMPLATE_MATCHING_COLOR) ? 1 : 0;
+	imageProcessingFullSized = (arImageProcMode == AR_IMAGE_PROC_IN_FULL) ? 1 : 0;
+	imageProcessingIdeal = (arFittingMode == AR_FITTING_TO_IDEAL) ? 1 : 0;
+	trackingWithPCA = (arMatchingPCAMode == AR_MATCHING_WITH_PCA) ? 1 : 0;
 	PsychCopyInIntegerArg(1, FALSE, &templateMatchingInColor);
-	arTemplateMatchingMode = (templateMatchingInColor) ? AR_TEMPLATE_MATCHING_COLOR : AR_TEMPLATE_MATCHING_BW;
 	PsychCopyInIntegerArg(2, FALSE, &imageProcessingFullSized);
-	arImageProcMode = (imageProcessingFullSized) ? AR_IMAGE_PROC_IN_FULL : AR_IMAGE_PROC_IN_HALF;
 	PsychCopyInIntegerArg(3, FALSE, &imageProcessingIdeal);
-	arFittingMode = (imageProcessingIdeal) ? AR_FITTING_TO_IDEAL : AR_FITTING_TO_INPUT;
 	PsychCopyInIntegerArg(4, FALSE, &trackingWithPCA);
+
+	// Apply them, but not while an asynchronous marker detection is in progress:
+	if (psychCVARInitialized) PsychLockMutex(&arToolkitMutex);
+	arTemplateMatchingMode = (templateMatchingInColor) ? AR_TEMPLATE_MATCHING_COLOR : AR_TEMPLATE_MATCHING_BW;
+	arImageProcMode = (imageProcessingFullSized) ? AR_IMAGE_PROC_IN_FULL : AR_IMAGE_PROC_IN_HALF;
+	arFittingMode = (imageProcessingIdeal) ? AR_FITTING_TO_IDEAL : AR_FITTING_TO_INPUT;
 	arMatchingPCAMode = (trackingWithPCA) ? AR_MATCHING_WITH_PCA : AR_MATCHING_WITHOUT_PCA;
+	if (psychCVARInitialized) PsychUnlockMutex(&arToolkitMutex);
 
 	// Ready.
 	return(PsychError_none);	
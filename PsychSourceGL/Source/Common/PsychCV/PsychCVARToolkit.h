@@ -28,6 +28,8 @@ PsychError PSYCHCVARInitialize(void);
 PsychError PSYCHCVARShutdown(void);
 PsychError PSYCHCVARLoadMarker(void);
 PsychError PSYCHCVARDetectMarkers(void);
+PsychError PSYCHCVARDetectMarkersAsync(void);
+PsychError PSYCHCVARDetectMarkersPoll(void);
 PsychError PSYCHCVARRenderImage(void);
 PsychError PSYCHCVARTrackerSettings(void);
 PsychError PSYCHCVARRenderSettings(void);
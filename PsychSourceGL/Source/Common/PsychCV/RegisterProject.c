@@ -56,6 +56,8 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("ARShutdown", &PSYCHCVARShutdown));
 	PsychErrorExit(PsychRegister("ARLoadMarker", &PSYCHCVARLoadMarker));
 	PsychErrorExit(PsychRegister("ARDetectMarkers", &PSYCHCVARDetectMarkers));
+	PsychErrorExit(PsychRegister("ARDetectMarkersAsync", &PSYCHCVARDetectMarkersAsync));
+	PsychErrorExit(PsychRegister("ARDetectMarkersPoll", &PSYCHCVARDetectMarkersPoll));
 	PsychErrorExit(PsychRegister("ARRenderImage", &PSYCHCVARRenderImage));
 	PsychErrorExit(PsychRegister("ARTrackerSettings", &PSYCHCVARTrackerSettings));
 	PsychErrorExit(PsychRegister("ARRenderSettings", &PSYCHCVARRenderSettings));
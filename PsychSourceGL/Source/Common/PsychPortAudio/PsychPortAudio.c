@@ -10,6 +10,14 @@
 	21.03.2007		mk		wrote it.
 	03.04.2011		mk		Make 64 bit clean. Allow 64-bit sized operations and float matrices.
 	03.04.2011		mk		License changed to MIT with some restrictions.
+	19.10.2026		agent	Add offline render backend via 'OpenOffline' for testing and benchmarking without sound hardware.
+	19.10.2026		agent	Segment-wise sample copy loops in paCallback() without per-sample modulo and limit checks.
+	19.10.2026		agent	Optional parallel processing of slaves on mixer threads via 'MixerThreads'.
+	19.10.2026		agent	Polyphase sample rate conversion and playback rate control for slaves and buffers via 'Resampling'.
+	19.10.2026		agent	Realtime effect chains with biquads, partitioned convolution and limiter via 'DspBiquads' et al.
+	19.10.2026		agent	Capture event detection for voice keys in the audio callback via 'CaptureDetector' and 'GetCaptureEvents'.
+	19.10.2026		agent	Time-indexed capture retrieval with decimation and single/int16 output via 'GetAudioDataRange'.
+	19.10.2026		agent	Add file backed audio buffers via 'CreateBufferFromFile', with read-ahead thread.
 	
 	DESCRIPTION:
 	
@@ -38,6 +46,15 @@
 #include "pa_asio.h"
 #endif
 
+#if PSYCH_SYSTEM != PSYCH_WINDOWS
+// For memory mapping of sound files in 'CreateBufferFromFile':
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
 // Need to define these as they aren't defined in portaudio.h
 // for some mysterious reason:
 typedef void (*PaUtilLogCallback ) (const char *log);
@@ -81,6 +98,64 @@ static const char *synopsisSYNOPSIS[MAX_SYNOPSIS_STRINGS];
 // many slots whenever it needs to grow:
 #define PSYCH_AUDIO_BUFFERLIST_INCREMENT 1024
 
+// File backed audio buffers are decoded / prefetched in chunks of this many sample frames:
+#define PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES 16384
+
+// Number of playposition hints per file backed audio buffer, ie., how many concurrent
+// playbacks of one buffer the read-ahead thread can track reliably:
+#define PSYCH_AUDIO_FILEBUFFER_HINTS 4
+
+// Service interval of the read-ahead thread for file backed audio buffers in seconds:
+#define PSYCH_AUDIO_FILEBUFFER_SERVICEINTERVAL 0.005
+
+// Maximum number of mixer threads per master device:
+#define PSYCH_AUDIO_MAX_MIXER_THREADS 32
+
+// Default minimum estimated total processing time of all slaves of a master per callback, in seconds,
+// above which slaves are processed in parallel if the master has mixer threads:
+#define PSYCH_AUDIO_MIXER_DEFAULT_MINCOST 0.0001
+
+// Mixer threads stop spin-waiting for new jobs if no jobs arrived for this many seconds:
+#define PSYCH_AUDIO_MIXER_SPINTIMEOUT 0.1
+
+// The master callback waits for its mixer threads to finish their slaves for at most this fraction of
+// the duration of its buffer. Slaves not finished by then are dropped from the mix and count as underruns:
+#define PSYCH_AUDIO_MIXER_MAXWAIT 0.5
+
+// Maximum time in seconds to wait for new mixer threads to report if they got realtime priority:
+#define PSYCH_AUDIO_MIXER_STARTTIMEOUT 1.0
+
+// Scratch buffers of mixer threads are allocated at pool creation for callbacks of up to this many sample
+// frames, or the current buffersize of the master, whatever is larger. Larger callbacks mix serially:
+#define PSYCH_AUDIO_MIXER_MAXFRAMES 8192
+
+// Number of quality presets of the resampler:
+#define PSYCH_AUDIO_RESAMPLER_PRESETS 4
+
+// Default quality preset of the resampler:
+#define PSYCH_AUDIO_RESAMPLER_DEFAULTQUALITY 2
+
+// Number of filter phases in the polyphase filter table of the resampler:
+#define PSYCH_AUDIO_RESAMPLER_PHASES 256
+
+// Maximum number of cascaded biquad filter sections in the effect chain of a device:
+#define PSYCH_AUDIO_DSP_MAX_BIQUADS 16
+
+// Number of sample frames over which changed biquad coefficients get interpolated:
+#define PSYCH_AUDIO_DSP_RAMP_FRAMES 512
+
+// Capacity of the event queue of the capture event detector:
+#define PSYCH_AUDIO_DETECTOR_QUEUESIZE 256
+
+// Offset threshold of the capture event detector, relative to onset threshold:
+#define PSYCH_AUDIO_DETECTOR_HYSTERESIS 0.7
+
+// Time constants of noise floor estimation of the capture event detector for rising and falling levels,
+// and duration of initial estimation without detection, all in seconds:
+#define PSYCH_AUDIO_DETECTOR_FLOORRISE 2.0
+#define PSYCH_AUDIO_DETECTOR_FLOORFALL 0.2
+#define PSYCH_AUDIO_DETECTOR_WARMUP 0.1
+
 // PA_ANTICLAMPGAIN is premultiplied onto any sample provided by usercode, reducing
 // signal amplitude by a tiny fraction. This is a workaround for a bug in the
 // sampleformat converters in Portaudio for float -> 32 bit int and float -> 24 bit int.
@@ -110,6 +185,15 @@ typedef struct PsychPASchedule {
 	unsigned int	command;			// Command code: 0 = Normal playback buffer. 1 = Pause & Restart playback, 2 = Schedule end of playback, ..
 } PsychPASchedule;
 
+// Polyphase sample rate converter of a playback device:
+typedef struct PsychPAResampler {
+	int			quality;		// Quality preset.
+	int			taps;			// Number of filter taps per phase.
+	double		designRatio;	// Highest conversion ratio the anti-aliasing cutoff of the filter is designed for.
+	float*		table;			// PSYCH_AUDIO_RESAMPLER_PHASES + 1 phases with 'taps' filter coefficients each.
+	float*		window;			// Scratch buffer for the source samples around the current position, 'taps' per channel.
+} PsychPAResampler;
+
 // Our device record:
 typedef struct PsychPADevice {
 	psych_mutex	mutex;			// Mutex lock for the PsychPADevice struct.
@@ -122,6 +206,8 @@ typedef struct PsychPADevice {
 	int		indeviceidx;		// Device index of capture device. -1 if none open.
 	int		outdeviceidx;		// Device index of output device. -1 if none open.
 	volatile double	 reqStartTime;		// Requested start time in system time (secs).
+	volatile double	 triggerStartTime;	// Start time posted by the capture event detector of another device, valid if triggerPosted.
+	volatile int	 triggerPosted;		// 1 = triggerStartTime got posted, but not yet picked up by our paCallback().
 	volatile double	 startTime;			// Real start time in system time (secs). Returns real start time after start.
 								// The real start time is the time when the first sample hit the speaker in playback or full-duplex mode.
 								// Its the time when the first sample was captured in pure capture mode - or when the first sample should
@@ -182,8 +268,73 @@ typedef struct PsychPADevice {
 	// Mixer volume related:
 	float*	outChannelVolumes;	// Array of per-outputchannel volume settings on slave devices, NULL and not used on non-slave devices.
 	float	masterVolume;		// Master volume setting for all non-slave audio devices, i.e., masters and regular devices. Unused on slaves.
+
+	// Parallel slave processing related:
+	struct PsychPAMixerPool* mixerPool;	// Pool of mixer threads for parallel processing of slaves on masters, NULL if none.
+	double	mixerSlaveCost;		// Running estimate of processing time per slave and callback in seconds, measured if mixerPool exists.
+	double	mixerMinCost;		// Minimum estimated processing time for all slaves per callback above which mixerPool is used.
+
+	// Sample rate conversion related, on regular and slave playback devices:
+	double	sourceRate;			// Samplerate of the sound data in the devices own playback buffer in Hz, 0 = Samplerate of the device.
+	double	playbackRate;		// Playback speed factor, 1.0 = Normal speed.
+	int		resampleQuality;	// Quality preset of the resampler.
+	PsychPAResampler* resampler;	// Resampler, NULL if none needed so far.
+	double	resamplePhase;		// Fractional part of the current playposition in sample frames.
+	double	resampleRatio;		// Conversion ratio at end of last resampled callback, 0 = Not resampling.
+	double	slotSampleRate;		// Samplerate of the buffer of the current schedule slot, 0 = Unspecified.
+	struct PsychPAFileBuffer* slotFileBuffer;	// Backing store of the buffer of the current schedule slot, if file backed, NULL otherwise.
+
+	// Realtime effect chain, on regular, master and slave playback devices:
+	struct PsychPADspChain* dspActive;				// Chain in use by the audio thread.
+	struct PsychPADspChain* volatile dspPending;	// Chain published by the main thread, not yet picked up by the audio thread.
+	struct PsychPADspChain* volatile dspRetired;	// Chain replaced by the audio thread, to be released by the main thread.
+	struct PsychPADspChain* dspLast;				// Chain last published by the main thread, template for the next one.
+
+	struct PsychPADetector* detector;	// Capture event detector, NULL if none.
 } PsychPADevice;
 
+// A mixer thread of a master device:
+typedef struct PsychPAMixerWorker {
+	struct PsychPAMixerPool* pool;	// Pool we belong to.
+	psych_thread	thread;				// Our thread.
+	int				running;			// 1 = Thread was created successfully.
+	volatile int	realtime;			// 0 = Thread didn't start yet, 1 = Thread runs at realtime priority, -1 = It failed to get realtime priority.
+	volatile int	busy;				// 1 = Thread is claiming or processing slaves, so its mixBuffer may be incomplete.
+	float*			mixBuffer;			// Private mix buffer for the output of all slaves processed by us during a job.
+	float*			outBuffer;			// Scratch buffers like the masters slaveOutBuffer, slaveGainBuffer and slaveInBuffer.
+	float*			gainBuffer;
+	float*			inBuffer;
+	volatile int	mixJob;				// Job for which mixBuffer contains valid data, -1 if none.
+	volatile double	cost;				// Time spent in slave processing during job 'mixJob'.
+} PsychPAMixerWorker;
+
+// Pool of mixer threads of a master device: Workers spin-wait for a new 'job', then claim slaves to process
+// via atomic increments of 'nextTask' and count them as finished via atomic increments of 'tasksDone'. The
+// master callback processes slaves as well, and waits for completion of all slaves of a job by spinning on
+// 'tasksDone', for a bounded time. If a mixer thread doesn't finish in time, e.g., because it got preempted,
+// the job is abandoned: Its unfinished slaves stay owned by the mixer thread until it marks them in 'taskDone',
+// and no new job gets published until then. Apart from thread creation and destruction, no mutexes or other
+// blocking calls are involved:
+typedef struct PsychPAMixerPool {
+	int				numWorkers;			// Number of mixer threads.
+	PsychPAMixerWorker* workers;		// Array of mixer threads.
+	volatile int	shutdown;			// 1 = Mixer threads shall exit.
+	volatile int	job;				// Id of current job, incremented for each new job.
+	volatile long	nextTask;			// Index of next unclaimed slave in 'tasks', PSYCH_AUDIO_MIXER_NOTASKS while no job pending.
+	volatile long	tasksDone;			// Number of finished slaves of current job.
+	psych_int64		outCapacity;		// Capacity of workers output scratch buffers in samples.
+	psych_int64		inCapacity;			// Capacity of workers input scratch buffers in samples.
+	// Parameters of current job:
+	PsychPADevice*	dev;				// Master device.
+	const float*	in;					// Captured sound of master.
+	int				tasks[MAX_PSYCH_AUDIO_SLAVES_PER_DEVICE];	// pahandle's of slaves to process.
+	volatile int	taskDone[MAX_PSYCH_AUDIO_SLAVES_PER_DEVICE];	// 1 = Slave tasks[i] is finished.
+	int				numTasks;			// Number of slaves to process.
+	psych_int64		committedFrames;	// Frames of silence at start of buffer.
+	PaStreamCallbackTimeInfo timeInfo;	// Copy of the timestamps of the master callback, as late workers may still use them after it returned.
+	PaStreamCallbackFlags statusFlags;
+} PsychPAMixerPool;
+
 PsychPADevice audiodevices[MAX_PSYCH_AUDIO_DEVS];
 unsigned int  audiodevicecount = 0;
 unsigned int  verbosity = 4;
@@ -197,12 +348,65 @@ double debugdummy1, debugdummy2;
 
 psych_bool pa_initialized = FALSE;
 
+// Atomic operations, memory barriers and spin-wait hints for the lock-free parts of file backed buffers, the mixer thread pool and effect chains:
+#if PSYCH_SYSTEM == PSYCH_WINDOWS
+#define PsychPAAtomicFetchAndIncrement(p) (InterlockedIncrement((volatile LONG*) (p)) - 1)
+#define PsychPAAtomicFetchAndDecrement(p) (InterlockedDecrement((volatile LONG*) (p)) + 1)
+#define PsychPAAtomicExchangePointer(p, v) InterlockedExchangePointer((PVOID volatile*) (p), (PVOID) (v))
+#define PsychPAMemoryBarrier() MemoryBarrier()
+#define PsychPACpuRelax() YieldProcessor()
+#else
+#define PsychPAAtomicFetchAndIncrement(p) __sync_fetch_and_add((p), 1)
+#define PsychPAAtomicFetchAndDecrement(p) __sync_fetch_and_sub((p), 1)
+#define PsychPAAtomicExchangePointer(p, v) (__sync_synchronize(), __sync_lock_test_and_set((p), (v)))
+#define PsychPAMemoryBarrier() __sync_synchronize()
+#if defined(__i386__) || defined(__x86_64__)
+#define PsychPACpuRelax() __builtin_ia32_pause()
+#else
+#define PsychPACpuRelax()
+#endif
+#endif
+
+// Definition of the backing store of a file backed audio buffer, as created by 'CreateBufferFromFile':
+typedef struct PsychPAFileBuffer {
+	struct PsychPAFileBuffer* next;	// Next file backed buffer in fileBufferList, NULL if this is the last one.
+	char*		mapbase;		// Start of copy-on-write memory mapping of the whole sound file.
+	size_t		maplength;		// Length of memory mapping in bytes.
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	HANDLE		file;			// Handle of the opened sound file.
+	HANDLE		mapping;		// Handle of the file mapping object.
+	#endif
+	char*		sampledata;		// Start of the sample data of the sound within the mapping.
+	int			sampleformat;	// Sample format of sampledata: 0 = float32, 1 = int16, 2 = float32 at unaligned file offset.
+	float*		decodebuffer;	// Buffer for float samples decoded from sampledata, or NULL if the float samples in the mapping are used directly.
+	size_t		decodebuffersize;	// Size of decodebuffer in bytes.
+	volatile unsigned char* chunkready;	// Array of flags for each chunk of PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES frames: 1 = Chunk decoded into decodebuffer.
+	psych_int64	chunkcount;		// Number of chunks.
+	psych_bool	pinned;			// TRUE = Decoded chunks are never released, e.g., because the buffer content was modified.
+	volatile long activeReaders;	// Number of paCallback()'s currently reading samples from decodebuffer. Chunks are not released while > 0.
+	psych_int64	outchannels;	// Number of channels.
+	psych_int64	nrFrames;		// Number of sample frames.
+	psych_int64	readAheadFrames;	// Size of read-ahead window in sample frames.
+	// Playposition hints, published by paCallback via PsychPAProcessSchedule(), consumed by the read-ahead thread:
+	volatile psych_int64 hintPosition[PSYCH_AUDIO_FILEBUFFER_HINTS];	// Sample index of current playposition, -1 = No hint.
+	volatile psych_int64 hintLoopStart[PSYCH_AUDIO_FILEBUFFER_HINTS];	// Sample index of start of current playloop.
+	volatile psych_int64 hintLoopSize[PSYCH_AUDIO_FILEBUFFER_HINTS];	// Size of current playloop in samples.
+	volatile unsigned int hintCount;	// Number of hints published so far.
+	unsigned int servicedHintCount;		// Value of hintCount at last service by the read-ahead thread.
+	// Regions primed for upcoming playback by PsychPAPrimeFileBuffer(), protected from release:
+	psych_int64 primeStart[PSYCH_AUDIO_FILEBUFFER_HINTS];	// Sample index of start of primed region.
+	psych_int64 primeLength[PSYCH_AUDIO_FILEBUFFER_HINTS];	// Size of primed region in samples, 0 = None.
+	unsigned int primeNext;				// Next slot in primeStart/primeLength to use.
+} PsychPAFileBuffer;
+
 // Definition of an audio buffer:
 struct PsychPABuffer_Struct {
 	unsigned int locked;		// locked: >= 1 = Buffer in use by some active audio device. 0 = Buffer unused.
 	float*	 outputbuffer;		// Pointer to float memory buffer with sound output data.
 	psych_int64 outputbuffersize;	// Size of output buffer in bytes.
 	psych_int64 outchannels;	// Number of channels.
+	PsychPAFileBuffer* filebuffer;	// Backing store of a file backed buffer, NULL for regular buffers in system memory.
+	double	sampleRate;			// Samplerate of the sound data in Hz, 0 = Unspecified, ie., samplerate of the device which plays it.
 };
 
 typedef struct PsychPABuffer_Struct PsychPABuffer;
@@ -211,517 +415,3080 @@ psych_mutex	bufferListmutex;			// Mutex lock for the audio bufferList.
 PsychPABuffer*  bufferList;				// Pointer to start of audio bufferList.
 int	bufferListCount;					// Number of slots allocated in bufferList.
 
-// Scan all schedules of all active and open audio devices to check if
-// given audiobuffer is referenced. Invalidate reference, if so:
-// The special handle == -1 invalidates all references except the ones to special buffer zero.
-psych_bool PsychPAInvalidateBufferReferences(int handle)
+// File backed audio buffers and their read-ahead thread:
+psych_mutex			fileBufferMutex;		// Mutex lock for fileBufferList and decoding of file backed buffers.
+psych_condition		fileBufferSignal;		// Wakeup signal for the read-ahead thread.
+psych_thread		fileBufferThread;		// Read-ahead thread.
+psych_bool			fileBufferThreadActive = FALSE;	// Is the read-ahead thread running?
+psych_bool			fileBufferThreadShutdown = FALSE;	// Request to the read-ahead thread to terminate.
+PsychPAFileBuffer*	fileBufferList = NULL;	// Linked list of all file backed buffers.
+volatile int		fileBufferSink;			// Target for page touching reads, so they don't get optimized away.
+
+// Decode chunk 'chunk' of file backed buffer 'fb' from its file mapping into its decodebuffer.
+// Called with fileBufferMutex held:
+static void PsychPADecodeFileBufferChunk(PsychPAFileBuffer* fb, psych_int64 chunk)
 {
-	unsigned int i, j;
-	psych_bool anylocked = FALSE;
+	psych_int64 i, start, count;
+	short* in16;
+	float* out;
 
-	// Scan all open audio devices:
-	for(i = 0; i < MAX_PSYCH_AUDIO_DEVS; i++) {
-		// Device open?
-		if (audiodevices[i].stream) {
-			// Schedule attached?
-			if (audiodevices[i].schedule) {
-				// Scan it and mark all references to our buffer(s) as invalid:
-				for (j = 0; j < audiodevices[i].schedule_size; j++) {
-					// Slot active and with relevant bufferhandle?
-					if ((audiodevices[i].schedule[j].bufferhandle == handle) || ((audiodevices[i].schedule[j].bufferhandle !=0) && (handle == -1)) ) {
-						// Invalidate this reference:
-						audiodevices[i].schedule[j].mode = 0;
-						audiodevices[i].schedule[j].bufferhandle = 0;
-						anylocked = TRUE;
-					}
-				}
-			}
-		}
+	start = chunk * PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels;
+	count = PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels;
+	if (start + count > fb->nrFrames * fb->outchannels) count = fb->nrFrames * fb->outchannels - start;
+	out = fb->decodebuffer + start;
+
+	if (fb->sampleformat == 1) {
+		// 16 bit signed integer samples:
+		in16 = ((short*) fb->sampledata) + start;
+		for (i = 0; i < count; i++) *(out++) = (float) (PA_ANTICLAMPGAIN * ((double) *(in16++) / 32768.0));
 	}
-	
-	return(anylocked);
+	else {
+		// 32 bit float samples at a file offset which is not a multiple of 4 bytes:
+		memcpy(out, fb->sampledata + start * sizeof(float), (size_t) count * sizeof(float));
+		for (i = 0; i < count; i++, out++) *out = (float) (PA_ANTICLAMPGAIN * *out);
+	}
+
+	// Decoded samples must be visible to paCallback() before it sees the chunk as ready:
+	PsychPAMemoryBarrier();
+	fb->chunkready[chunk] = 1;
 }
 
-// Create a new audiobuffer for 'outchannels' audio channels and 'nrFrames' samples
-// per channel. Init header, allocate zero-filled memory, enqeue in bufferList.
-// Resize/Grow bufferList if neccessary. Return handle to buffer.
-int PsychPACreateAudioBuffer(psych_int64 outchannels, psych_int64 nrFrames)
+// Release decoded chunk 'chunk' of file backed buffer 'fb', so memory consumption for decoding stays
+// bounded by the read-ahead windows, instead of growing to the decoded size of the whole sound. The
+// pages are returned to the OS and read as zeros, or on some systems as their old content, until the
+// chunk gets decoded again. A paCallback() which is reading from the buffer may have checked the chunk
+// as ready before we cleared the flag, so we leave the chunk alone while any reader is active and try
+// again at the next service. Called by the read-ahead thread with fileBufferMutex held:
+static void PsychPAReleaseFileBufferChunk(PsychPAFileBuffer* fb, psych_int64 chunk)
 {
-	PsychPABuffer* tmpptr;
-	int i, handle;
-	
-	// Does a bufferList exist?
-	if ((bufferListCount <= 0) || (bufferList == NULL)) {
-		// First call. Allocate and zero-fill initial bufferList:
-		bufferList = (PsychPABuffer*) calloc(PSYCH_AUDIO_BUFFERLIST_INCREMENT, sizeof(PsychPABuffer));
-		if (NULL == bufferList) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for allocating new audio buffers when trying to create internal bufferlist!");
+	size_t start, length;
 
-		bufferListCount = PSYCH_AUDIO_BUFFERLIST_INCREMENT;
-	} 
+	// Clear flag before checking for readers, so a reader starting after the check sees the chunk as not ready:
+	fb->chunkready[chunk] = 0;
+	PsychPAMemoryBarrier();
+	if (fb->activeReaders > 0) {
+		// Content is still intact, as we didn't release anything yet:
+		fb->chunkready[chunk] = 1;
+		return;
+	}
 
-	// Search a free slot in bufferList: We start at slot 1, ie., we skip slot 0.
-	// This because we don't want to ever return a handle of zero, as zero denotes the
-	// special per-audiodevice playback buffer.
-	i = 1; while ((i < bufferListCount) && (NULL != bufferList[i].outputbuffer)) i++;
+	// Chunks are a multiple of 64 KB in size, so start is page aligned:
+	start = (size_t) (chunk * PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels) * sizeof(float);
+	length = (size_t) (PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels) * sizeof(float);
+	if (start + length > fb->decodebuffersize) length = fb->decodebuffersize - start;
 
-	// Success?
-	if ((i >= bufferListCount)) {
-		// Nope. Could not find free slot. Need to resize the bufferList with more capacity.
-		
-		// Need to lock bufferList lock to do this:
-		PsychLockMutex(&bufferListmutex);
-		
-		// Reallocate bufferList: This may relocate the bufferList:
-		tmpptr = (PsychPABuffer*) realloc((void*) bufferList, (bufferListCount + PSYCH_AUDIO_BUFFERLIST_INCREMENT) * sizeof(PsychPABuffer) );		
-		if (NULL == tmpptr) {
-			// Failed! Unlock mutex:
-			PsychUnlockMutex(&bufferListmutex);
-			
-			// Error out. The old allocation and parameters are still valid:
-			PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for allocating new audio buffers when trying to grow internal bufferlist!");
-		}
-		
-		// Assign new pointer and size:
-		bufferList = tmpptr;
-		tmpptr = &(bufferList[i]);
-		bufferListCount += PSYCH_AUDIO_BUFFERLIST_INCREMENT;
-		
-		// Initialize new segment of list to zero:
-		memset((void*) tmpptr, 0, PSYCH_AUDIO_BUFFERLIST_INCREMENT * sizeof(PsychPABuffer));
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	VirtualAlloc(((char*) fb->decodebuffer) + start, length, MEM_RESET, PAGE_READWRITE);
+	#else
+	madvise(((char*) fb->decodebuffer) + start, length, MADV_DONTNEED);
+	#endif
+}
 
-		// Done resizing bufferlist. Unlock mutex:
-		PsychUnlockMutex(&bufferListmutex);
+// Is chunk 'chunk' of file backed buffer 'fb' within the 'count' samples from sample index 'start'?
+static psych_bool PsychPAFileBufferChunkInRange(PsychPAFileBuffer* fb, psych_int64 chunk, psych_int64 start, psych_int64 count)
+{
+	psych_int64 chunksamples = PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels;
 
-		// Ready. 'i' now points to first free slot in new segment of extended bufferList.
+	if (count <= 0) return(FALSE);
+	if (start < 0) {
+		count += start;
+		start = 0;
 	}
-	
-	// Assign slotid of bufferList slot in handle:
-	handle = i;
 
-	// Invalidate all potential stale references to the new 'handle' in all schedules:
-	PsychPAInvalidateBufferReferences(handle);
-
-	// Allocate actual data buffer:
-	bufferList[handle].outputbuffersize = outchannels * nrFrames * sizeof(float);
-	bufferList[handle].outchannels = outchannels;
-	
-	if (NULL == ( bufferList[handle].outputbuffer = (float*) calloc(1, (size_t) bufferList[handle].outputbuffersize) )) {
-		// Out of memory: Release bufferList header and error out:
-		PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for allocating new audio buffer when trying to allocate actual buffer!");
-	}
-	
-	// Ok, we're ready with an empty, silence filled audiobuffer. Return its handle:
-	return(handle);
+	return(((count > 0) && (chunk >= start / chunksamples) && (chunk <= (start + count - 1) / chunksamples)) ? TRUE : FALSE);
 }
 
-// Delete all audio buffers and bufferList itself: Called during shutdown.
-void PsychPADeleteAllAudioBuffers(void)
+// Check if the 'count' samples from playposition 'position' of the playloop of 'loopsize' samples, starting
+// at sample index 'loopoffset' of file backed buffer 'fb', are decoded and can be played by paCallback().
+// Wraps around at the end of the playloop, like playback does. Always TRUE for buffers which need no
+// decoding. Called from paCallback() between PsychPAFileBufferBeginRead() and PsychPAFileBufferEndRead(),
+// so it doesn't lock:
+static psych_bool PsychPAFileBufferReady(PsychPAFileBuffer* fb, psych_int64 loopoffset, psych_int64 loopsize, psych_int64 position, psych_int64 count)
 {
-	int i;
-	
-	if (bufferListCount > 0) {
-		
-		// Lock list:
-		PsychLockMutex(&bufferListmutex);
+	psych_int64 chunksamples, segmentpos, segment, chunk, lastchunk;
 
-		// Invalidate all referencing slots in all schedules:
-		PsychPAInvalidateBufferReferences(-1);
-		
-		// Free all audio buffers:
-		for (i = 0; i < bufferListCount; i++) {
-			if (NULL != bufferList[i].outputbuffer) free(bufferList[i].outputbuffer);
+	if ((fb->decodebuffer == NULL) || (loopsize <= 0)) return(TRUE);
+
+	chunksamples = PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels;
+	if (count > loopsize) count = loopsize;
+
+	while (count > 0) {
+		segmentpos = position % loopsize;
+		segment = loopsize - segmentpos;
+		if (segment > count) segment = count;
+
+		lastchunk = (loopoffset + segmentpos + segment - 1) / chunksamples;
+		if (lastchunk >= fb->chunkcount) lastchunk = fb->chunkcount - 1;
+		for (chunk = (loopoffset + segmentpos) / chunksamples; chunk <= lastchunk; chunk++) {
+			if (!fb->chunkready[chunk]) return(FALSE);
 		}
-		
-		// Release memory for bufferheader array itself:
-		free(bufferList);
-		bufferList = NULL;
-		bufferListCount = 0;
 
-		// Unlock list:
-		PsychUnlockMutex(&bufferListmutex);
+		position += segment;
+		count -= segment;
 	}
-	
-	return;
+
+	// Don't read samples before their chunk was seen as ready:
+	PsychPAMemoryBarrier();
+
+	return(TRUE);
 }
 
-PsychPABuffer* PsychPAGetAudioBuffer(int handle)
+// Mark start of reading from file backed buffer 'fb' by paCallback(). Until the matching
+// PsychPAFileBufferEndRead(), the read-ahead thread doesn't release any decoded chunks, so
+// chunks checked by PsychPAFileBufferReady() stay valid while they are read. Lock-free:
+static void PsychPAFileBufferBeginRead(PsychPAFileBuffer* fb)
 {
-	// Does buffer with given handle exist?
-	if ((handle < 0) || (handle >= bufferListCount) || (bufferList[handle].outputbuffer == NULL)) {
-		PsychErrorExitMsg(PsychError_user, "Invalid audio bufferhandle provided! The handle doesn't correspond to an existing audiobuffer.");
-	}
-	
-	return( &(bufferList[handle]) );
+	// Full barrier, as the increment must be visible before we check any chunkready flags:
+	PsychPAAtomicFetchAndIncrement(&(fb->activeReaders));
+	PsychPAMemoryBarrier();
 }
 
-// Scan all schedules of all active and open audio devices to check which
-// audiobuffers are active and lock them:
-psych_bool PsychPAUpdateBufferReferences(void)
+// Mark end of reading from file backed buffer 'fb' by paCallback():
+static void PsychPAFileBufferEndRead(PsychPAFileBuffer* fb)
 {
-	int i;
-	unsigned int j;
-	psych_bool anylocked = FALSE;
-	
-	// First we reset all locked flags of all buffers:
-	for (i = 0; i < bufferListCount; i++) bufferList[i].locked = 0;
-	
-	// Scan all open audio devices:
-	for(i = 0; i < MAX_PSYCH_AUDIO_DEVS; i++) {
-		// Device open?
-		if (audiodevices[i].stream) {
-			// Schedule attached and device active?
-			if ((audiodevices[i].schedule) && ((audiodevices[i].state > 0) && Pa_IsStreamActive(audiodevices[i].stream))) {
-				// Active schedule. Scan it and mark all referenced buffers as locked:
-				for (j = 0; j < audiodevices[i].schedule_size; j++) {
-					// Slot active and with valid bufferhandle?
-					if ((audiodevices[i].schedule[j].mode & 2) && (audiodevices[i].schedule[j].bufferhandle > 0)) {
-						// Mark used and active audiobuffer as locked:
-						bufferList[ audiodevices[i].schedule[j].bufferhandle ].locked = 1;
-						anylocked = TRUE;
-					}
-				}
-			}
-		}
-	}
-	
-	return(anylocked);
+	// All reads of samples must be complete before the read-ahead thread may release chunks:
+	PsychPAMemoryBarrier();
+	PsychPAAtomicFetchAndDecrement(&(fb->activeReaders));
 }
 
-// Delete audiobuffer 'handle' if this is possible. If it isn't possible
-// at the moment, 'waitmode' will determine the strategy:
-int PsychPADeleteAudioBuffer(int handle, int waitmode)
+// Make sure 'count' samples starting at sample index 'start' of file backed buffer 'fb' are
+// available in system memory: Decode them if decoding is needed, otherwise advise the OS
+// to read them ahead and touch all pages, so they are resident and mapped in by the time
+// paCallback() needs them. Called with fileBufferMutex held:
+static void PsychPAPrefetchFileBuffer(PsychPAFileBuffer* fb, psych_int64 start, psych_int64 count)
 {
-	// Retrieve buffer:
-	PsychPABuffer* buffer = PsychPAGetAudioBuffer(handle);
-	
-	// Make sure all buffer locked flags are up to date:
-	PsychPAUpdateBufferReferences();
-	
-	// Buffer locked?
-	if (buffer->locked) {
-		// Yes :-( In 'waitmode' zero we fail:
-		if (waitmode == 0) return(0);
-		
-		// In waitmode 1, we retry spin-waiting until buffer available:
-		while (buffer->locked) {
-			PsychYieldIntervalSeconds(yieldInterval);
-			PsychPAUpdateBufferReferences();
-		}
+	psych_int64 chunk, lastchunk, totalsamples, pagesize;
+	char *p, *pend;
+
+	totalsamples = fb->nrFrames * fb->outchannels;
+	if (start < 0) start = 0;
+	if (start + count > totalsamples) count = totalsamples - start;
+	if (count <= 0) return;
+
+	if (fb->decodebuffer) {
+		chunk = start / (PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels);
+		lastchunk = (start + count - 1) / (PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels);
+		for (; chunk <= lastchunk; chunk++) if (!fb->chunkready[chunk]) PsychPADecodeFileBufferChunk(fb, chunk);
+		return;
 	}
-	
-	// Delete buffer:
-	if (NULL != buffer->outputbuffer) free(buffer->outputbuffer);
-	memset(buffer, 0, sizeof(PsychPABuffer));
-	
-	// Success:
-	return(1);
-}
 
-static void PsychPALockDeviceMutex(PsychPADevice* dev)
-{
-	#ifdef MUTEX_LOCK_TIME_STATS
-	// Compute effective mutex lock hold time. Typical duration on a 2nd Rev. MacBookPro DualCore
-	// under typical playback load in the paCallback() is less than 100 microseconds, usually around 50 usecs, so
-	// nothing to worry about yet.
-	PsychGetAdjustedPrecisionTimerSeconds(&debugdummy1);
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	pagesize = 4096;
+	#else
+	pagesize = (psych_int64) sysconf(_SC_PAGESIZE);
 	#endif
-	
-	if (uselocking) {
-		PsychLockMutex(&(dev->mutex));
-	}
-}
 
-static void PsychPAUnlockDeviceMutex(PsychPADevice* dev)
-{
-	if (uselocking) {
-		PsychUnlockMutex(&(dev->mutex));
-	}
+	p = fb->sampledata + start * sizeof(float);
+	pend = p + count * sizeof(float);
 
-	#ifdef MUTEX_LOCK_TIME_STATS
-	PsychGetAdjustedPrecisionTimerSeconds(&debugdummy2);
-	dev->predictedLatency = debugdummy2 - debugdummy1;
+	// Page align start of range, then prefetch:
+	p = fb->mapbase + (((p - fb->mapbase) / pagesize) * pagesize);
+	#if PSYCH_SYSTEM != PSYCH_WINDOWS
+	madvise(p, (size_t) (pend - p), MADV_WILLNEED);
 	#endif
+	for (; p < pend; p += pagesize) fileBufferSink += *p;
 }
 
-static void PsychPACreateSignal(PsychPADevice* dev)
+// Decode all not yet decoded samples of file backed buffer 'fb', e.g., before the buffer
+// gets used as source or target of a copy operation. The buffer is pinned afterwards, so
+// its decoded chunks never get released, as they may contain modified sound data:
+static void PsychPADecodeFileBufferFully(PsychPAFileBuffer* fb)
 {
-	if (uselocking) {
-		PsychInitCondition(&(dev->changeSignal), NULL);
-	}
-}
+	psych_int64 chunk;
 
+	if ((fb == NULL) || (fb->decodebuffer == NULL)) return;
 
-static void PsychPADestroySignal(PsychPADevice* dev)
-{
-	if (uselocking) {
-		PsychDestroyCondition(&(dev->changeSignal));
-	}
+	PsychLockMutex(&fileBufferMutex);
+	fb->pinned = TRUE;
+	for (chunk = 0; chunk < fb->chunkcount; chunk++) if (!fb->chunkready[chunk]) PsychPADecodeFileBufferChunk(fb, chunk);
+	PsychUnlockMutex(&fileBufferMutex);
 }
 
-static void PsychPASignalChange(PsychPADevice* dev)
+// Publish current playposition 'position', playloop start 'loopstart' and playloop size 'loopsize',
+// all in samples, of a playback of file backed buffer 'fb' to the read-ahead thread. Called from
+// paCallback(), so must be cheap and must not block. Just writes a new hint into the hint ring,
+// the read-ahead thread picks it up at its next service iteration:
+static void PsychPAFileBufferHint(PsychPAFileBuffer* fb, psych_int64 position, psych_int64 loopstart, psych_int64 loopsize)
 {
-	if (uselocking) {
-		PsychSignalCondition(&(dev->changeSignal));
-	}
+	unsigned int slot = fb->hintCount % PSYCH_AUDIO_FILEBUFFER_HINTS;
+
+	fb->hintLoopStart[slot] = loopstart;
+	fb->hintLoopSize[slot] = loopsize;
+	fb->hintPosition[slot] = position;
+	fb->hintCount++;
 }
 
-static void PsychPAWaitForChange(PsychPADevice* dev)
+// Prefetch 'count' samples starting at sample index 'start' of file backed buffer 'fb' for upcoming
+// playback, e.g., at the start of a new playloop, and protect them from release by the read-ahead
+// thread until the region gets replaced by a newer one. Called with fileBufferMutex held:
+static void PsychPAPrimeFileBuffer(PsychPAFileBuffer* fb, psych_int64 start, psych_int64 count)
 {
-	if (uselocking) {
+	PsychPAPrefetchFileBuffer(fb, start, count);
+
+	fb->primeStart[fb->primeNext] = start;
+	fb->primeLength[fb->primeNext] = count;
+	fb->primeNext = (fb->primeNext + 1) % PSYCH_AUDIO_FILEBUFFER_HINTS;
+}
+
+// Prefetch the read-ahead window for all recent playposition hints of 'fb', then release all
+// decoded chunks outside of these windows and the primed regions. Called by the read-ahead
+// thread with fileBufferMutex held:
+static void PsychPAServiceFileBuffer(PsychPAFileBuffer* fb)
+{
+	psych_int64 position, loopstart, loopsize, count, ahead, chunk, chunksamples;
+	psych_int64 keepStart[3 * PSYCH_AUDIO_FILEBUFFER_HINTS], keepCount[3 * PSYCH_AUDIO_FILEBUFFER_HINTS];
+	unsigned int hintCount = fb->hintCount;
+	int i, j, nkeep = 0;
+
+	// Nothing new since last iteration?
+	if (hintCount == fb->servicedHintCount) return;
+	fb->servicedHintCount = hintCount;
+
+	for (i = 0; i < PSYCH_AUDIO_FILEBUFFER_HINTS; i++) {
+		position = fb->hintPosition[i];
+		loopstart = fb->hintLoopStart[i];
+		loopsize = fb->hintLoopSize[i];
+		if ((position < 0) || (loopsize <= 0) || (position < loopstart)) continue;
+
+		// Read-ahead window from current playposition to at most end of playloop...
+		count = fb->readAheadFrames * fb->outchannels;
+		ahead = loopstart + loopsize - position;
+		if (ahead > count) ahead = count;
+		PsychPAPrefetchFileBuffer(fb, position, ahead);
+
+		// Keep it, and one chunk behind the playposition, as the hint may be slightly outdated:
+		chunksamples = PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES * fb->outchannels;
+		keepStart[nkeep] = position - chunksamples;
+		keepCount[nkeep++] = ahead + chunksamples;
+
+		// ...and the remainder of the window from start of playloop, in case playback wraps around:
+		count -= ahead;
+		if (count > loopsize) count = loopsize;
+		if (count > 0) {
+			PsychPAPrefetchFileBuffer(fb, loopstart, count);
+			keepStart[nkeep] = loopstart;
+			keepCount[nkeep++] = count;
+		}
+	}
+
+	// Release decoded chunks behind the playpositions, unless the buffer is pinned:
+	if ((fb->decodebuffer == NULL) || fb->pinned) return;
+
+	for (i = 0; i < PSYCH_AUDIO_FILEBUFFER_HINTS; i++) {
+		keepStart[nkeep] = fb->primeStart[i];
+		keepCount[nkeep++] = fb->primeLength[i];
+	}
+
+	for (chunk = 0; chunk < fb->chunkcount; chunk++) {
+		if (!fb->chunkready[chunk]) continue;
+		for (j = 0; (j < nkeep) && !PsychPAFileBufferChunkInRange(fb, chunk, keepStart[j], keepCount[j]); j++);
+		if (j == nkeep) PsychPAReleaseFileBufferChunk(fb, chunk);
+	}
+}
+
+// Main routine of read-ahead thread for file backed buffers:
+static void* PsychPAFileBufferThreadMain(void* arg)
+{
+	PsychPAFileBuffer* fb;
+	int rc;
+
+	// Try to run at elevated priority, so read-ahead keeps up with playback on a loaded system.
+	// Failure is not fatal, we just run at normal priority then:
+	if ((rc = PsychSetThreadPriority(NULL, 1, 0)) > 0) {
+		if (verbosity > 5) printf("PTB-DEBUG: PsychPortAudio: Failed to raise priority of file buffer read-ahead thread [%s].\n", strerror(rc));
+	}
+
+	PsychLockMutex(&fileBufferMutex);
+	while (!fileBufferThreadShutdown) {
+		for (fb = fileBufferList; fb; fb = fb->next) PsychPAServiceFileBuffer(fb);
+
+		// Poll at service interval while file backed buffers exist, sleep until signalled otherwise:
+		if (fileBufferList) {
+			PsychTimedWaitCondition(&fileBufferSignal, &fileBufferMutex, PSYCH_AUDIO_FILEBUFFER_SERVICEINTERVAL);
+		}
+		else {
+			PsychWaitCondition(&fileBufferSignal, &fileBufferMutex);
+		}
+	}
+	PsychUnlockMutex(&fileBufferMutex);
+
+	return(NULL);
+}
+
+// Stop read-ahead thread, if it is running:
+static void PsychPAStopFileBufferThread(void)
+{
+	if (!fileBufferThreadActive) return;
+
+	PsychLockMutex(&fileBufferMutex);
+	fileBufferThreadShutdown = TRUE;
+	PsychSignalCondition(&fileBufferSignal);
+	PsychUnlockMutex(&fileBufferMutex);
+	PsychDeleteThread(&fileBufferThread);
+
+	fileBufferThreadActive = FALSE;
+	fileBufferThreadShutdown = FALSE;
+}
+
+// Unmap file and release all memory of file backed buffer 'fb'. 'fb' must not be in fileBufferList anymore:
+static void PsychPAReleaseFileBuffer(PsychPAFileBuffer* fb)
+{
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	if (fb->decodebuffer) VirtualFree(fb->decodebuffer, 0, MEM_RELEASE);
+	if (fb->mapbase) UnmapViewOfFile(fb->mapbase);
+	if (fb->mapping) CloseHandle(fb->mapping);
+	if (fb->file && (fb->file != INVALID_HANDLE_VALUE)) CloseHandle(fb->file);
+	#else
+	if (fb->decodebuffer) munmap(fb->decodebuffer, fb->decodebuffersize);
+	if (fb->mapbase) munmap(fb->mapbase, fb->maplength);
+	#endif
+
+	if (fb->chunkready) free((void*) fb->chunkready);
+	free(fb);
+}
+
+// Remove file backed buffer 'fb' from fileBufferList, then release it:
+static void PsychPADeleteFileBuffer(PsychPAFileBuffer* fb)
+{
+	PsychPAFileBuffer** pfb;
+
+	PsychLockMutex(&fileBufferMutex);
+	for (pfb = &fileBufferList; *pfb; pfb = &((*pfb)->next)) {
+		if (*pfb == fb) {
+			*pfb = fb->next;
+			break;
+		}
+	}
+	PsychUnlockMutex(&fileBufferMutex);
+
+	PsychPAReleaseFileBuffer(fb);
+}
+
+// Error exit helper for PsychPAOpenFileBuffer(): Release partially setup 'fb', then error out with 'msg':
+static void PsychPAOpenFileBufferFailed(PsychPAFileBuffer* fb, const char* filename, const char* msg)
+{
+	PsychPAReleaseFileBuffer(fb);
+	if (verbosity > 0) printf("PTB-ERROR: PsychPortAudio('CreateBufferFromFile'): Failed for sound file '%s'.\n", filename);
+	PsychErrorExitMsg(PsychError_user, msg);
+}
+
+static unsigned int PsychPAGetLE16(const unsigned char* p) { return((unsigned int) p[0] | ((unsigned int) p[1] << 8)); }
+static unsigned int PsychPAGetLE32(const unsigned char* p) { return((unsigned int) p[0] | ((unsigned int) p[1] << 8) | ((unsigned int) p[2] << 16) | ((unsigned int) p[3] << 24)); }
+
+// Open sound file 'filename' and memory map it. If it is a WAV file with 16 bit integer or 32 bit float
+// samples, parse its header for the sample format, channel count, samplerate and sample data location.
+// Otherwise treat it as raw file with 'outchannels' channels of interleaved samples of format 'sampleformat'
+// (0 = float32, 1 = int16) in native byte order, starting at byte offset 'dataoffset'. Return the new file
+// backed buffer, and the samplerate of a WAV file in 'sampleRate', or NaN for raw files.
+static PsychPAFileBuffer* PsychPAOpenFileBuffer(const char* filename, psych_int64 outchannels, int sampleformat, psych_int64 dataoffset, psych_int64 readAheadFrames, double* sampleRate)
+{
+	PsychPAFileBuffer* fb;
+	const unsigned char* hdr;
+	psych_int64 filelength, pos, chunksize, datasize, samplesize, i;
+	unsigned int fmttag, bits;
+	double wavRate = 0;
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	LARGE_INTEGER size;
+	#else
+	struct stat st;
+	int fd;
+	#endif
+
+	fb = (PsychPAFileBuffer*) calloc(1, sizeof(PsychPAFileBuffer));
+	if (NULL == fb) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for file backed audio buffer!");
+	for (i = 0; i < PSYCH_AUDIO_FILEBUFFER_HINTS; i++) fb->hintPosition[i] = -1;
+
+	// Map the whole file copy-on-write, so 'RefillBuffer' can modify the buffer without touching the file:
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	fb->file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (fb->file == INVALID_HANDLE_VALUE) PsychPAOpenFileBufferFailed(fb, filename, "Could not open sound file.");
+	if (!GetFileSizeEx(fb->file, &size)) PsychPAOpenFileBufferFailed(fb, filename, "Could not query size of sound file.");
+	filelength = (psych_int64) size.QuadPart;
+	if ((filelength <= 0) || ((psych_int64) (size_t) filelength != filelength)) PsychPAOpenFileBufferFailed(fb, filename, "Sound file is empty or too big to map into memory.");
+	fb->mapping = CreateFileMapping(fb->file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (NULL == fb->mapping) PsychPAOpenFileBufferFailed(fb, filename, "Could not create file mapping for sound file.");
+	fb->mapbase = (char*) MapViewOfFile(fb->mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (NULL == fb->mapbase) PsychPAOpenFileBufferFailed(fb, filename, "Could not map sound file into memory.");
+	fb->maplength = (size_t) filelength;
+	#else
+	fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		if (verbosity > 0) printf("PTB-ERROR: PsychPortAudio: Could not open sound file '%s' [%s].\n", filename, strerror(errno));
+		PsychPAOpenFileBufferFailed(fb, filename, "Could not open sound file.");
+	}
+
+	if (fstat(fd, &st) || (st.st_size <= 0) || ((psych_int64) (size_t) st.st_size != (psych_int64) st.st_size)) {
+		close(fd);
+		PsychPAOpenFileBufferFailed(fb, filename, "Sound file is empty or too big to map into memory.");
+	}
+	filelength = (psych_int64) st.st_size;
+
+	fb->mapbase = (char*) mmap(NULL, (size_t) filelength, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (fb->mapbase == (char*) MAP_FAILED) {
+		fb->mapbase = NULL;
+		PsychPAOpenFileBufferFailed(fb, filename, "Could not map sound file into memory.");
+	}
+	fb->maplength = (size_t) filelength;
+
+	// Playback mostly reads sequentially, so ask for aggressive kernel read-ahead:
+	madvise(fb->mapbase, fb->maplength, MADV_SEQUENTIAL);
+	#endif
+
+	*sampleRate = PsychGetNanValue();
+	hdr = (const unsigned char*) fb->mapbase;
+	datasize = filelength - dataoffset;
+
+	// WAV file? Only a RIFF header with little endian values is supported, which is also the native
+	// byte order of all our supported platforms:
+	if ((filelength >= 12) && !memcmp(hdr, "RIFF", 4) && !memcmp(hdr + 8, "WAVE", 4)) {
+		outchannels = 0;
+		datasize = -1;
+		pos = 12;
+
+		// Walk the chunk list until the "data" chunk:
+		while (pos + 8 <= filelength) {
+			chunksize = (psych_int64) PsychPAGetLE32(hdr + pos + 4);
+
+			if (!memcmp(hdr + pos, "fmt ", 4) && (chunksize >= 16) && (pos + 8 + 16 <= filelength)) {
+				fmttag = PsychPAGetLE16(hdr + pos + 8);
+				outchannels = (psych_int64) PsychPAGetLE16(hdr + pos + 10);
+				wavRate = (double) PsychPAGetLE32(hdr + pos + 12);
+				bits = PsychPAGetLE16(hdr + pos + 22);
+
+				// WAVE_FORMAT_EXTENSIBLE: Real format tag is in the first two bytes of the subformat GUID:
+				if ((fmttag == 0xFFFE) && (chunksize >= 40) && (pos + 8 + 40 <= filelength)) fmttag = PsychPAGetLE16(hdr + pos + 32);
+
+				if ((fmttag == 1) && (bits == 16)) {
+					sampleformat = 1;
+				}
+				else if ((fmttag == 3) && (bits == 32)) {
+					sampleformat = 0;
+				}
+				else {
+					if (verbosity > 0) printf("PTB-ERROR: PsychPortAudio: WAV file has unsupported format tag %i with %i bits per sample.\n", fmttag, bits);
+					PsychPAOpenFileBufferFailed(fb, filename, "Unsupported WAV sample format. Only 16 bit integer PCM and 32 bit float WAV files are supported.");
+				}
+			}
+
+			if (!memcmp(hdr + pos, "data", 4)) {
+				dataoffset = pos + 8;
+				datasize = chunksize;
+				// Truncated files, or files written by streaming writers which never patched the size fields:
+				if ((datasize == 0) || (dataoffset + datasize > filelength)) datasize = filelength - dataoffset;
+				break;
+			}
+
+			// Chunks are padded to even size:
+			pos += 8 + chunksize + (chunksize & 1);
+		}
+
+		if ((outchannels < 1) || (datasize < 0)) PsychPAOpenFileBufferFailed(fb, filename, "Invalid or corrupt WAV file: No valid 'fmt ' or 'data' chunk found.");
+		if (wavRate > 0) *sampleRate = wavRate;
+	}
+
+	if ((outchannels < 1) || (outchannels > MAX_PSYCH_AUDIO_CHANNELS_PER_DEVICE)) PsychPAOpenFileBufferFailed(fb, filename, "Invalid number of audio channels for sound file.");
+	if ((dataoffset < 0) || (dataoffset >= filelength)) PsychPAOpenFileBufferFailed(fb, filename, "Invalid 'dataOffset': Beyond end of file.");
+
+	samplesize = (sampleformat == 1) ? sizeof(short) : sizeof(float);
+	fb->outchannels = outchannels;
+	fb->nrFrames = datasize / (samplesize * outchannels);
+	fb->sampledata = fb->mapbase + dataoffset;
+	if (fb->nrFrames < 1) PsychPAOpenFileBufferFailed(fb, filename, "Sound file does not contain at least one sample frame of sound data.");
+
+	// Float samples at a properly aligned offset can be used directly from the mapping, everything else needs decoding:
+	if ((sampleformat == 0) && (dataoffset % sizeof(float))) sampleformat = 2;
+	fb->sampleformat = sampleformat;
+
+	if (sampleformat > 0) {
+		// The decodebuffer is lazily backed by zero-filled pages as the read-ahead thread decodes into it,
+		// and chunks behind the playposition are released again, so memory consumption is bounded by
+		// the read-ahead windows:
+		fb->decodebuffersize = (size_t) (fb->nrFrames * outchannels * sizeof(float));
+		#if PSYCH_SYSTEM == PSYCH_WINDOWS
+		fb->decodebuffer = (float*) VirtualAlloc(NULL, fb->decodebuffersize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		#else
+		fb->decodebuffer = (float*) mmap(NULL, fb->decodebuffersize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+		if (fb->decodebuffer == (float*) MAP_FAILED) fb->decodebuffer = NULL;
+		#endif
+		if (NULL == fb->decodebuffer) PsychPAOpenFileBufferFailed(fb, filename, "Insufficient free memory for decoding sound file.");
+
+		fb->chunkcount = (fb->nrFrames + PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES - 1) / PSYCH_AUDIO_FILEBUFFER_CHUNKFRAMES;
+		fb->chunkready = (unsigned char*) calloc((size_t) fb->chunkcount, sizeof(unsigned char));
+		if (NULL == fb->chunkready) PsychPAOpenFileBufferFailed(fb, filename, "Insufficient free memory for decoding sound file.");
+	}
+
+	// Default read-ahead window is 2 seconds of sound at the samplerate of a WAV file, or at 48 kHz for raw files:
+	fb->readAheadFrames = (readAheadFrames > 0) ? readAheadFrames : ((wavRate > 0) ? (psych_int64) (2 * wavRate) : 96000);
+
+	// Prime the read-ahead window at the start of the sound, so playback from the start doesn't need to wait for the read-ahead thread:
+	PsychPAPrimeFileBuffer(fb, 0, fb->readAheadFrames * outchannels);
+
+	return(fb);
+}
+
+// Host API type id of devices opened via 'OpenOffline' on our offline render backend.
+// PortAudio never reports paInDevelopment for a real host API:
+#define kPsychPAOfflineHostAPI paInDevelopment
+
+// Number of per-buffer callback timings kept by the offline render backend for its statistics:
+#define PSYCH_AUDIO_OFFLINE_TIMINGS 4096
+
+// Initial size of an offline output file in bytes. It grows by doubling as needed:
+#define PSYCH_AUDIO_OFFLINE_FILESIZE (1024 * 1024)
+
+// A memory mapped input- or output file of the offline render backend:
+typedef struct PsychPAOfflineFile {
+	char*		base;			// Start of mapping, NULL if no file mapped.
+	psych_int64	size;			// Size of mapping in bytes.
+	psych_int64	pos;			// Current read/write position in bytes.
+	int			writable;		// 1 = Output file, 0 = Input file.
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	HANDLE		file;
+	HANDLE		mapping;
+	#else
+	int			fd;
+	#endif
+} PsychPAOfflineFile;
+
+// An offline render stream: Stands in for a PortAudio stream on devices opened via 'OpenOffline'.
+// A render thread calls the stream callback with synthetic timestamps, either as fast as possible
+// or paced to simulated realtime:
+typedef struct PsychPAOfflineStream {
+	struct PsychPAOfflineStream* next;	// Next stream in offlineStreamList, NULL if this is the last one.
+	PaStreamInfo	info;				// Stream info as returned by PsychPAStreamGetInfo().
+	PaStreamCallback* callback;			// Stream callback, ie., paCallback().
+	PaStreamFinishedCallback* finishedCallback;	// Stream finished callback, or NULL.
+	void*			userData;			// Userdata for both callbacks, ie., our device struct.
+	psych_thread	thread;				// Render thread.
+	psych_mutex		mutex;				// Mutex lock for state and statistics below.
+	psych_condition	signal;				// State change signal in both directions.
+	volatile int	active;				// 1 = Render thread is calling the callback, like Pa_IsStreamActive().
+	volatile int	stopped;			// 1 = Stream never started or stopped/aborted, like Pa_IsStreamStopped().
+	volatile int	stopRequest;		// 1 = Stop/Abort requested, 2 = Render thread shutdown requested.
+	int				realtime;			// 0 = Render as fast as possible, 1 = Pace rendering to simulated realtime.
+	unsigned long	framesPerBuffer;	// Size of each rendered buffer in frames.
+	int				outchannels;		// Number of output channels, zero if no output.
+	int				inchannels;			// Number of input channels, zero if no input.
+	float*			outbuffer;			// Output buffer handed to the callback, NULL if no output.
+	float*			inbuffer;			// Input buffer handed to the callback, NULL if no input.
+	double			tStart;				// Simulated time at which frame zero was rendered.
+	double			streamTime;			// Simulated time of the next buffer to render.
+	psych_int64		framesRendered;		// Number of frames rendered so far.
+	PsychPAOfflineFile outfile;			// Output file, if any.
+	PsychPAOfflineFile infile;			// Input file, if any.
+	// Statistics: Protected by mutex:
+	double			cpuLoad;			// Smoothed callback time divided by buffer duration, like Pa_GetStreamCpuLoad().
+	psych_int64		statsBuffers;		// Number of callbacks since last reset.
+	double			statsCpuSum;		// Sum of callback cpu times.
+	double			statsCpuMax;		// Maximum callback cpu time.
+	double			statsWallSum;		// Sum of callback wall clock times.
+	double			statsWallMax;		// Maximum callback wall clock time.
+	double			statsElapsed;		// Total wall clock time spent in render iterations, including file i/o.
+	double			timings[PSYCH_AUDIO_OFFLINE_TIMINGS];	// Ring of most recent callback cpu times.
+} PsychPAOfflineStream;
+
+PsychPAOfflineStream* offlineStreamList = NULL;	// List of all open offline streams. Only accessed from main thread.
+
+// Return the offline stream corresponding to 'stream', or NULL if 'stream' is a real PortAudio stream:
+static PsychPAOfflineStream* PsychPAGetOfflineStream(PaStream* stream)
+{
+	PsychPAOfflineStream* os;
+	for (os = offlineStreamList; os; os = os->next) if ((PaStream*) os == stream) return(os);
+	return(NULL);
+}
+
+// Return cpu time consumed by the calling thread in seconds, if the OS can tell us
+// with sufficient resolution, wall clock time otherwise:
+static double PsychPAGetThreadCPUTime(void)
+{
+	double t;
+
+	#if PSYCH_SYSTEM == PSYCH_LINUX
+	struct timespec ts;
+	if (0 == clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts)) return((double) ts.tv_sec + ((double) ts.tv_nsec / 1e9));
+	#endif
+
+	PsychGetAdjustedPrecisionTimerSeconds(&t);
+	return(t);
+}
+
+// Close offline file 'f'. Output files get truncated to the amount of data actually written:
+static void PsychPAOfflineFileClose(PsychPAOfflineFile* f)
+{
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	LARGE_INTEGER li;
+	if (f->base) UnmapViewOfFile(f->base);
+	if (f->mapping) CloseHandle(f->mapping);
+	if (f->file && (f->file != INVALID_HANDLE_VALUE)) {
+		if (f->writable) {
+			li.QuadPart = f->pos;
+			SetFilePointerEx(f->file, li, NULL, FILE_BEGIN);
+			SetEndOfFile(f->file);
+		}
+		CloseHandle(f->file);
+	}
+	#else
+	if (f->base) munmap(f->base, (size_t) f->size);
+	if (f->fd > 0) {
+		if (f->writable && ftruncate(f->fd, (off_t) f->pos) && (verbosity > 1)) printf("PTB-WARNING: PsychPortAudio: Could not truncate offline output file to final size [%s].\n", strerror(errno));
+		close(f->fd);
+	}
+	#endif
+
+	memset(f, 0, sizeof(PsychPAOfflineFile));
+}
+
+// (Re-)Map offline file 'f' with a size of 'size' bytes, growing an output file if needed.
+// Returns TRUE on success, FALSE on failure:
+static psych_bool PsychPAOfflineFileMap(PsychPAOfflineFile* f, psych_int64 size)
+{
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	LARGE_INTEGER li;
+
+	if (f->base) UnmapViewOfFile(f->base);
+	if (f->mapping) CloseHandle(f->mapping);
+	f->base = NULL;
+	f->mapping = NULL;
+
+	if (f->writable) {
+		li.QuadPart = size;
+		if (!SetFilePointerEx(f->file, li, NULL, FILE_BEGIN) || !SetEndOfFile(f->file)) return(FALSE);
+	}
+
+	f->mapping = CreateFileMapping(f->file, NULL, (f->writable) ? PAGE_READWRITE : PAGE_READONLY, (DWORD) (size >> 32), (DWORD) (size & 0xffffffff), NULL);
+	if (NULL == f->mapping) return(FALSE);
+	f->base = (char*) MapViewOfFile(f->mapping, (f->writable) ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, (SIZE_T) size);
+	#else
+	if (f->base) munmap(f->base, (size_t) f->size);
+	f->base = NULL;
+
+	if (f->writable && ftruncate(f->fd, (off_t) size)) return(FALSE);
+
+	f->base = (char*) mmap(NULL, (size_t) size, (f->writable) ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, f->fd, 0);
+	if (f->base == (char*) MAP_FAILED) f->base = NULL;
+	if (f->base && !f->writable) madvise(f->base, (size_t) size, MADV_SEQUENTIAL);
+	#endif
+
+	if (NULL == f->base) return(FALSE);
+	f->size = size;
+
+	return(TRUE);
+}
+
+// Open 'filename' as offline output file if 'writable', as input file otherwise. Returns FALSE on failure:
+static psych_bool PsychPAOfflineFileOpen(PsychPAOfflineFile* f, const char* filename, int writable)
+{
+	psych_int64 size;
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	LARGE_INTEGER li;
+	#else
+	struct stat st;
+	#endif
+
+	memset(f, 0, sizeof(PsychPAOfflineFile));
+	f->writable = writable;
+
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+	f->file = CreateFileA(filename, (writable) ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ, NULL, (writable) ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (f->file == INVALID_HANDLE_VALUE) return(FALSE);
+	if (!GetFileSizeEx(f->file, &li)) return(FALSE);
+	size = (psych_int64) li.QuadPart;
+	#else
+	f->fd = open(filename, (writable) ? (O_RDWR | O_CREAT | O_TRUNC) : O_RDONLY, 0644);
+	if (f->fd < 0) {
+		f->fd = 0;
+		return(FALSE);
+	}
+	if (fstat(f->fd, &st)) return(FALSE);
+	size = (psych_int64) st.st_size;
+	#endif
+
+	// An empty input file is valid, it just provides silence:
+	if (!writable && (size == 0)) return(TRUE);
+
+	return(PsychPAOfflineFileMap(f, (writable) ? PSYCH_AUDIO_OFFLINE_FILESIZE : size));
+}
+
+// Called by render thread with os->mutex held, after the callback asked to finish or after a stop request:
+// Stop calling the callback and signal the stream finished, like PortAudio does:
+static void PsychPAOfflineFinish(PsychPAOfflineStream* os)
+{
+	os->active = 0;
+	os->stopRequest = 0;
+
+	// Call finished callback without our mutex held, as it locks the device mutex:
+	if (os->finishedCallback) {
+		PsychUnlockMutex(&os->mutex);
+		os->finishedCallback(os->userData);
+		PsychLockMutex(&os->mutex);
+	}
+
+	PsychBroadcastCondition(&os->signal);
+}
+
+// Main routine of the render thread of an offline stream:
+static void* PsychPAOfflineThreadMain(void* arg)
+{
+	PsychPAOfflineStream* os = (PsychPAOfflineStream*) arg;
+	PaStreamCallbackTimeInfo timeInfo;
+	double tIteration, tCallback, tEnd, tCpu, cpuTime, wallTime, bufferDuration;
+	size_t outbytes, inbytes, n;
+	int rc;
+
+	bufferDuration = (double) os->framesPerBuffer / os->info.sampleRate;
+	outbytes = (size_t) os->framesPerBuffer * os->outchannels * sizeof(float);
+	inbytes = (size_t) os->framesPerBuffer * os->inchannels * sizeof(float);
+
+	PsychLockMutex(&os->mutex);
+	while (os->stopRequest != 2) {
+		// Idle until started:
+		if (!os->active) {
+			PsychWaitCondition(&os->signal, &os->mutex);
+			continue;
+		}
+
+		// Stop or abort requested? We have no queued buffers, so both are the same:
+		if (os->stopRequest == 1) {
+			PsychPAOfflineFinish(os);
+			continue;
+		}
+		PsychUnlockMutex(&os->mutex);
+
+		PsychGetAdjustedPrecisionTimerSeconds(&tIteration);
+
+		// Feed input from input file, silence after its end:
+		if (os->inbuffer) {
+			n = 0;
+			if (os->infile.base && (os->infile.pos < os->infile.size)) {
+				n = (size_t) ((os->infile.size - os->infile.pos < (psych_int64) inbytes) ? (os->infile.size - os->infile.pos) : (psych_int64) inbytes);
+				memcpy(os->inbuffer, os->infile.base + os->infile.pos, n);
+				os->infile.pos += n;
+			}
+			if (n < inbytes) memset(((char*) os->inbuffer) + n, 0, inbytes - n);
+		}
+
+		// Synthetic timestamps: Output hits the virtual speaker one output latency after the callback,
+		// input left the virtual microphone one input latency before the callback:
+		timeInfo.currentTime = os->streamTime;
+		timeInfo.outputBufferDacTime = os->streamTime + os->info.outputLatency;
+		timeInfo.inputBufferAdcTime = os->streamTime - os->info.inputLatency;
+
+		tCpu = PsychPAGetThreadCPUTime();
+		PsychGetAdjustedPrecisionTimerSeconds(&tCallback);
+		rc = os->callback(os->inbuffer, os->outbuffer, os->framesPerBuffer, &timeInfo, 0, os->userData);
+		cpuTime = PsychPAGetThreadCPUTime() - tCpu;
+		PsychGetAdjustedPrecisionTimerSeconds(&tEnd);
+		wallTime = tEnd - tCallback;
+
+		// Write output to output file, growing it if needed:
+		if (os->outbuffer && os->outfile.writable) {
+			if ((os->outfile.pos + (psych_int64) outbytes > os->outfile.size) && !PsychPAOfflineFileMap(&os->outfile, 2 * os->outfile.size + (psych_int64) outbytes)) {
+				printf("PTB-ERROR: PsychPortAudio: Offline render device could not grow its output file! Output file closed, further output discarded.\n");
+				PsychPAOfflineFileClose(&os->outfile);
+			}
+
+			if (os->outfile.base) {
+				memcpy(os->outfile.base + os->outfile.pos, os->outbuffer, outbytes);
+				os->outfile.pos += outbytes;
+			}
+		}
+
+		// Advance simulated time without accumulating roundoff errors:
+		os->framesRendered += os->framesPerBuffer;
+		os->streamTime = os->tStart + (double) os->framesRendered / os->info.sampleRate;
+
+		PsychGetAdjustedPrecisionTimerSeconds(&tEnd);
+
+		PsychLockMutex(&os->mutex);
+		os->cpuLoad = 0.9 * os->cpuLoad + 0.1 * (cpuTime / bufferDuration);
+		os->timings[os->statsBuffers % PSYCH_AUDIO_OFFLINE_TIMINGS] = cpuTime;
+		os->statsBuffers++;
+		os->statsCpuSum += cpuTime;
+		os->statsWallSum += wallTime;
+		os->statsElapsed += tEnd - tIteration;
+		if (cpuTime > os->statsCpuMax) os->statsCpuMax = cpuTime;
+		if (wallTime > os->statsWallMax) os->statsWallMax = wallTime;
+
+		// Callback wants to finish?
+		if (rc != paContinue) {
+			PsychPAOfflineFinish(os);
+			continue;
+		}
+
+		// In simulated realtime mode, the simulated time is GetSecs time, so wait until it is time for the next buffer:
+		if (os->realtime) {
+			PsychUnlockMutex(&os->mutex);
+			PsychWaitUntilSeconds(os->streamTime);
+			PsychLockMutex(&os->mutex);
+		}
+	}
+	PsychUnlockMutex(&os->mutex);
+
+	return(NULL);
+}
+
+// Create and start render thread of a new offline stream. Returns the stream, or NULL on failure:
+static PsychPAOfflineStream* PsychPAOfflineStreamOpen(int inchannels, int outchannels, double sampleRate, unsigned long framesPerBuffer,
+													   const char* outfilename, const char* infilename, int realtime, PaStreamCallback* callback, void* userData)
+{
+	PsychPAOfflineStream* os;
+	int rc;
+
+	os = (PsychPAOfflineStream*) calloc(1, sizeof(PsychPAOfflineStream));
+	if (NULL == os) return(NULL);
+
+	os->info.structVersion = 1;
+	os->info.sampleRate = sampleRate;
+	os->info.inputLatency = (inchannels > 0) ? (double) framesPerBuffer / sampleRate : 0.0;
+	os->info.outputLatency = (outchannels > 0) ? (double) framesPerBuffer / sampleRate : 0.0;
+	os->callback = callback;
+	os->userData = userData;
+	os->stopped = 1;
+	os->realtime = realtime;
+	os->framesPerBuffer = framesPerBuffer;
+	os->outchannels = outchannels;
+	os->inchannels = inchannels;
+
+	if (((outchannels > 0) && (NULL == (os->outbuffer = (float*) calloc((size_t) framesPerBuffer * outchannels, sizeof(float))))) ||
+		((inchannels > 0) && (NULL == (os->inbuffer = (float*) calloc((size_t) framesPerBuffer * inchannels, sizeof(float)))))) {
+		printf("PTB-ERROR: PsychPortAudio: Out of memory while creating offline render device.\n");
+		goto offline_open_failed;
+	}
+
+	if (outfilename && (outchannels > 0) && !PsychPAOfflineFileOpen(&os->outfile, outfilename, 1)) {
+		printf("PTB-ERROR: PsychPortAudio: Could not create offline output file '%s'.\n", outfilename);
+		goto offline_open_failed;
+	}
+
+	if (infilename && (inchannels > 0) && !PsychPAOfflineFileOpen(&os->infile, infilename, 0)) {
+		printf("PTB-ERROR: PsychPortAudio: Could not open offline input file '%s'.\n", infilename);
+		goto offline_open_failed;
+	}
+
+	PsychInitMutex(&os->mutex);
+	PsychInitCondition(&os->signal, NULL);
+
+	if ((rc = PsychCreateThread(&os->thread, NULL, PsychPAOfflineThreadMain, (void*) os))) {
+		printf("PTB-ERROR: PsychPortAudio: Could not create render thread for offline render device [%s].\n", strerror(rc));
+		PsychDestroyCondition(&os->signal);
+		PsychDestroyMutex(&os->mutex);
+		goto offline_open_failed;
+	}
+
+	os->next = offlineStreamList;
+	offlineStreamList = os;
+
+	return(os);
+
+offline_open_failed:
+	PsychPAOfflineFileClose(&os->outfile);
+	PsychPAOfflineFileClose(&os->infile);
+	if (os->outbuffer) free(os->outbuffer);
+	if (os->inbuffer) free(os->inbuffer);
+	free(os);
+
+	return(NULL);
+}
+
+// Wrappers around the PortAudio stream api, which dispatch to the offline render backend for
+// offline streams, and to PortAudio for everything else:
+static PaError PsychPAStreamStart(PaStream* stream)
+{
+	double now;
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_StartStream(stream));
+
+	PsychLockMutex(&os->mutex);
+	if (!os->stopped) {
+		PsychUnlockMutex(&os->mutex);
+		return(paStreamIsNotStopped);
+	}
+
+	// Simulated time continues where it stopped, but never lags behind GetSecs time at start.
+	// In simulated realtime mode, it starts at GetSecs time, so both timebases are the same:
+	PsychGetAdjustedPrecisionTimerSeconds(&now);
+	if (os->realtime || (os->streamTime < now)) os->streamTime = now;
+	os->tStart = os->streamTime - (double) os->framesRendered / os->info.sampleRate;
+
+	os->stopped = 0;
+	os->stopRequest = 0;
+	os->active = 1;
+	PsychBroadcastCondition(&os->signal);
+	PsychUnlockMutex(&os->mutex);
+
+	return(paNoError);
+}
+
+static PaError PsychPAStreamStop(PaStream* stream)
+{
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_StopStream(stream));
+
+	PsychLockMutex(&os->mutex);
+	if (os->stopped) {
+		PsychUnlockMutex(&os->mutex);
+		return(paStreamIsStopped);
+	}
+
+	// Ask render thread to stop calling the callback, wait for it to finish:
+	if (os->active) {
+		os->stopRequest = 1;
+		PsychBroadcastCondition(&os->signal);
+		while (os->active) PsychWaitCondition(&os->signal, &os->mutex);
+	}
+
+	os->stopped = 1;
+	PsychUnlockMutex(&os->mutex);
+
+	return(paNoError);
+}
+
+static PaError PsychPAStreamAbort(PaStream* stream)
+{
+	// Without queued buffers, abort is the same as stop for offline streams:
+	if (NULL == PsychPAGetOfflineStream(stream)) return(Pa_AbortStream(stream));
+	return(PsychPAStreamStop(stream));
+}
+
+static PaError PsychPAStreamClose(PaStream* stream)
+{
+	PsychPAOfflineStream** pos;
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_CloseStream(stream));
+
+	PsychPAStreamStop(stream);
+
+	// Shutdown render thread:
+	PsychLockMutex(&os->mutex);
+	os->stopRequest = 2;
+	PsychBroadcastCondition(&os->signal);
+	PsychUnlockMutex(&os->mutex);
+	PsychDeleteThread(&os->thread);
+
+	// Dequeue from list of offline streams:
+	for (pos = &offlineStreamList; *pos; pos = &((*pos)->next)) {
+		if (*pos == os) {
+			*pos = os->next;
+			break;
+		}
+	}
+
+	PsychDestroyCondition(&os->signal);
+	PsychDestroyMutex(&os->mutex);
+	PsychPAOfflineFileClose(&os->outfile);
+	PsychPAOfflineFileClose(&os->infile);
+	if (os->outbuffer) free(os->outbuffer);
+	if (os->inbuffer) free(os->inbuffer);
+	free(os);
+
+	return(paNoError);
+}
+
+static PaError PsychPAStreamIsActive(PaStream* stream)
+{
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_IsStreamActive(stream));
+	return((PaError) os->active);
+}
+
+static PaError PsychPAStreamIsStopped(PaStream* stream)
+{
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_IsStreamStopped(stream));
+	return((PaError) os->stopped);
+}
+
+static const PaStreamInfo* PsychPAStreamGetInfo(PaStream* stream)
+{
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_GetStreamInfo(stream));
+	return(&os->info);
+}
+
+static double PsychPAStreamGetCpuLoad(PaStream* stream)
+{
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_GetStreamCpuLoad(stream));
+	return(os->cpuLoad);
+}
+
+static PaError PsychPAStreamSetFinishedCallback(PaStream* stream, PaStreamFinishedCallback* finishedCallback)
+{
+	PsychPAOfflineStream* os = PsychPAGetOfflineStream(stream);
+	if (NULL == os) return(Pa_SetStreamFinishedCallback(stream, finishedCallback));
+
+	PsychLockMutex(&os->mutex);
+	os->finishedCallback = finishedCallback;
+	PsychUnlockMutex(&os->mutex);
+
+	return(paNoError);
+}
+
+static int PsychPACompareDoubles(const void* a, const void* b)
+{
+	return((*((const double*) a) > *((const double*) b)) - (*((const double*) a) < *((const double*) b)));
+}
+
+// Scan all schedules of all active and open audio devices to check if
+// given audiobuffer is referenced. Invalidate reference, if so:
+// The special handle == -1 invalidates all references except the ones to special buffer zero.
+psych_bool PsychPAInvalidateBufferReferences(int handle)
+{
+	unsigned int i, j;
+	psych_bool anylocked = FALSE;
+
+	// Scan all open audio devices:
+	for(i = 0; i < MAX_PSYCH_AUDIO_DEVS; i++) {
+		// Device open?
+		if (audiodevices[i].stream) {
+			// Schedule attached?
+			if (audiodevices[i].schedule) {
+				// Scan it and mark all references to our buffer(s) as invalid:
+				for (j = 0; j < audiodevices[i].schedule_size; j++) {
+					// Slot active and with relevant bufferhandle?
+					if ((audiodevices[i].schedule[j].bufferhandle == handle) || ((audiodevices[i].schedule[j].bufferhandle !=0) && (handle == -1)) ) {
+						// Invalidate this reference:
+						audiodevices[i].schedule[j].mode = 0;
+						audiodevices[i].schedule[j].bufferhandle = 0;
+						anylocked = TRUE;
+					}
+				}
+			}
+		}
+	}
+	
+	return(anylocked);
+}
+
+// Find a free slot in the bufferList for a new audiobuffer. Resize/Grow bufferList
+// if neccessary. Return handle to the free slot.
+static int PsychPAAllocateBufferSlot(void)
+{
+	PsychPABuffer* tmpptr;
+	int i, handle;
+	
+	// Does a bufferList exist?
+	if ((bufferListCount <= 0) || (bufferList == NULL)) {
+		// First call. Allocate and zero-fill initial bufferList:
+		bufferList = (PsychPABuffer*) calloc(PSYCH_AUDIO_BUFFERLIST_INCREMENT, sizeof(PsychPABuffer));
+		if (NULL == bufferList) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for allocating new audio buffers when trying to create internal bufferlist!");
+
+		bufferListCount = PSYCH_AUDIO_BUFFERLIST_INCREMENT;
+	} 
+
+	// Search a free slot in bufferList: We start at slot 1, ie., we skip slot 0.
+	// This because we don't want to ever return a handle of zero, as zero denotes the
+	// special per-audiodevice playback buffer.
+	i = 1; while ((i < bufferListCount) && (NULL != bufferList[i].outputbuffer)) i++;
+
+	// Success?
+	if ((i >= bufferListCount)) {
+		// Nope. Could not find free slot. Need to resize the bufferList with more capacity.
+		
+		// Need to lock bufferList lock to do this:
+		PsychLockMutex(&bufferListmutex);
+		
+		// Reallocate bufferList: This may relocate the bufferList:
+		tmpptr = (PsychPABuffer*) realloc((void*) bufferList, (bufferListCount + PSYCH_AUDIO_BUFFERLIST_INCREMENT) * sizeof(PsychPABuffer) );		
+		if (NULL == tmpptr) {
+			// Failed! Unlock mutex:
+			PsychUnlockMutex(&bufferListmutex);
+			
+			// Error out. The old allocation and parameters are still valid:
+			PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for allocating new audio buffers when trying to grow internal bufferlist!");
+		}
+		
+		// Assign new pointer and size:
+		bufferList = tmpptr;
+		tmpptr = &(bufferList[i]);
+		bufferListCount += PSYCH_AUDIO_BUFFERLIST_INCREMENT;
+		
+		// Initialize new segment of list to zero:
+		memset((void*) tmpptr, 0, PSYCH_AUDIO_BUFFERLIST_INCREMENT * sizeof(PsychPABuffer));
+
+		// Done resizing bufferlist. Unlock mutex:
+		PsychUnlockMutex(&bufferListmutex);
+
+		// Ready. 'i' now points to first free slot in new segment of extended bufferList.
+	}
+	
+	// Assign slotid of bufferList slot in handle:
+	handle = i;
+
+	// Invalidate all potential stale references to the new 'handle' in all schedules:
+	PsychPAInvalidateBufferReferences(handle);
+
+	return(handle);
+}
+
+// Create a new audiobuffer for 'outchannels' audio channels and 'nrFrames' samples
+// per channel. Init header, allocate zero-filled memory, enqeue in bufferList.
+// Return handle to buffer.
+int PsychPACreateAudioBuffer(psych_int64 outchannels, psych_int64 nrFrames)
+{
+	int handle = PsychPAAllocateBufferSlot();
+
+	// Allocate actual data buffer:
+	bufferList[handle].outputbuffersize = outchannels * nrFrames * sizeof(float);
+	bufferList[handle].outchannels = outchannels;
+	bufferList[handle].sampleRate = 0.0;
+	
+	if (NULL == ( bufferList[handle].outputbuffer = (float*) calloc(1, (size_t) bufferList[handle].outputbuffersize) )) {
+		// Out of memory: Release bufferList header and error out:
+		PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for allocating new audio buffer when trying to allocate actual buffer!");
+	}
+	
+	// Ok, we're ready with an empty, silence filled audiobuffer. Return its handle:
+	return(handle);
+}
+
+// Create a new audiobuffer backed by the sound file 'filename', enqeue in bufferList.
+// See PsychPAOpenFileBuffer() for meaning of the other parameters. Return handle to buffer.
+int PsychPACreateFileAudioBuffer(const char* filename, psych_int64 outchannels, int sampleformat, psych_int64 dataoffset, psych_int64 readAheadFrames, double* sampleRate)
+{
+	PsychPAFileBuffer* fb;
+	int handle, rc;
+
+	// Start the read-ahead thread on first use:
+	if (!fileBufferThreadActive) {
+		if ((rc = PsychCreateThread(&fileBufferThread, NULL, PsychPAFileBufferThreadMain, NULL))) {
+			printf("PTB-ERROR: PsychPortAudio: Could not create read-ahead thread for file backed audio buffers [%s].\n", strerror(rc));
+			PsychErrorExitMsg(PsychError_system, "Thread creation failed!");
+		}
+		fileBufferThreadActive = TRUE;
+	}
+
+	// Get a free slot first, so growing the bufferList can't fail after the file is mapped:
+	handle = PsychPAAllocateBufferSlot();
+
+	// Open and map the file, prime initial read-ahead window. Errors out on failure:
+	fb = PsychPAOpenFileBuffer(filename, outchannels, sampleformat, dataoffset, readAheadFrames, sampleRate);
+
+	bufferList[handle].outchannels = fb->outchannels;
+	bufferList[handle].outputbuffersize = fb->nrFrames * fb->outchannels * sizeof(float);
+	bufferList[handle].outputbuffer = (fb->decodebuffer) ? fb->decodebuffer : (float*) fb->sampledata;
+	bufferList[handle].filebuffer = fb;
+	bufferList[handle].sampleRate = (*sampleRate > 0) ? *sampleRate : 0.0;
+
+	// Hand it over to the read-ahead thread:
+	PsychLockMutex(&fileBufferMutex);
+	fb->next = fileBufferList;
+	fileBufferList = fb;
+	PsychSignalCondition(&fileBufferSignal);
+	PsychUnlockMutex(&fileBufferMutex);
+
+	return(handle);
+}
+
+// Delete all audio buffers and bufferList itself: Called during shutdown.
+void PsychPADeleteAllAudioBuffers(void)
+{
+	int i;
+	
+	if (bufferListCount > 0) {
+		
+		// Lock list:
+		PsychLockMutex(&bufferListmutex);
+
+		// Invalidate all referencing slots in all schedules:
+		PsychPAInvalidateBufferReferences(-1);
+		
+		// Free all audio buffers:
+		for (i = 0; i < bufferListCount; i++) {
+			if (NULL != bufferList[i].filebuffer) {
+				PsychPADeleteFileBuffer(bufferList[i].filebuffer);
+			}
+			else if (NULL != bufferList[i].outputbuffer) free(bufferList[i].outputbuffer);
+		}
+		
+		// Release memory for bufferheader array itself:
+		free(bufferList);
+		bufferList = NULL;
+		bufferListCount = 0;
+
+		// Unlock list:
+		PsychUnlockMutex(&bufferListmutex);
+	}
+	
+	return;
+}
+
+PsychPABuffer* PsychPAGetAudioBuffer(int handle)
+{
+	// Does buffer with given handle exist?
+	if ((handle < 0) || (handle >= bufferListCount) || (bufferList[handle].outputbuffer == NULL)) {
+		PsychErrorExitMsg(PsychError_user, "Invalid audio bufferhandle provided! The handle doesn't correspond to an existing audiobuffer.");
+	}
+	
+	return( &(bufferList[handle]) );
+}
+
+// Scan all schedules of all active and open audio devices to check which
+// audiobuffers are active and lock them:
+psych_bool PsychPAUpdateBufferReferences(void)
+{
+	int i;
+	unsigned int j;
+	psych_bool anylocked = FALSE;
+	
+	// First we reset all locked flags of all buffers:
+	for (i = 0; i < bufferListCount; i++) bufferList[i].locked = 0;
+	
+	// Scan all open audio devices:
+	for(i = 0; i < MAX_PSYCH_AUDIO_DEVS; i++) {
+		// Device open?
+		if (audiodevices[i].stream) {
+			// Schedule attached and device active?
+			if ((audiodevices[i].schedule) && ((audiodevices[i].state > 0) && PsychPAStreamIsActive(audiodevices[i].stream))) {
+				// Active schedule. Scan it and mark all referenced buffers as locked:
+				for (j = 0; j < audiodevices[i].schedule_size; j++) {
+					// Slot active and with valid bufferhandle?
+					if ((audiodevices[i].schedule[j].mode & 2) && (audiodevices[i].schedule[j].bufferhandle > 0)) {
+						// Mark used and active audiobuffer as locked:
+						bufferList[ audiodevices[i].schedule[j].bufferhandle ].locked = 1;
+						anylocked = TRUE;
+					}
+				}
+			}
+		}
+	}
+	
+	return(anylocked);
+}
+
+// Delete audiobuffer 'handle' if this is possible. If it isn't possible
+// at the moment, 'waitmode' will determine the strategy:
+int PsychPADeleteAudioBuffer(int handle, int waitmode)
+{
+	// Retrieve buffer:
+	PsychPABuffer* buffer = PsychPAGetAudioBuffer(handle);
+	
+	// Make sure all buffer locked flags are up to date:
+	PsychPAUpdateBufferReferences();
+	
+	// Buffer locked?
+	if (buffer->locked) {
+		// Yes :-( In 'waitmode' zero we fail:
+		if (waitmode == 0) return(0);
+		
+		// In waitmode 1, we retry spin-waiting until buffer available:
+		while (buffer->locked) {
+			PsychYieldIntervalSeconds(yieldInterval);
+			PsychPAUpdateBufferReferences();
+		}
+	}
+	
+	// Delete buffer:
+	if (NULL != buffer->filebuffer) {
+		PsychPADeleteFileBuffer(buffer->filebuffer);
+	}
+	else if (NULL != buffer->outputbuffer) free(buffer->outputbuffer);
+	memset(buffer, 0, sizeof(PsychPABuffer));
+	
+	// Success:
+	return(1);
+}
+
+static void PsychPALockDeviceMutex(PsychPADevice* dev)
+{
+	#ifdef MUTEX_LOCK_TIME_STATS
+	// Compute effective mutex lock hold time. Typical duration on a 2nd Rev. MacBookPro DualCore
+	// under typical playback load in the paCallback() is less than 100 microseconds, usually around 50 usecs, so
+	// nothing to worry about yet.
+	PsychGetAdjustedPrecisionTimerSeconds(&debugdummy1);
+	#endif
+	
+	if (uselocking) {
+		PsychLockMutex(&(dev->mutex));
+	}
+}
+
+static void PsychPAUnlockDeviceMutex(PsychPADevice* dev)
+{
+	if (uselocking) {
+		PsychUnlockMutex(&(dev->mutex));
+	}
+
+	#ifdef MUTEX_LOCK_TIME_STATS
+	PsychGetAdjustedPrecisionTimerSeconds(&debugdummy2);
+	dev->predictedLatency = debugdummy2 - debugdummy1;
+	#endif
+}
+
+static void PsychPACreateSignal(PsychPADevice* dev)
+{
+	if (uselocking) {
+		PsychInitCondition(&(dev->changeSignal), NULL);
+	}
+}
+
+
+static void PsychPADestroySignal(PsychPADevice* dev)
+{
+	if (uselocking) {
+		PsychDestroyCondition(&(dev->changeSignal));
+	}
+}
+
+static void PsychPASignalChange(PsychPADevice* dev)
+{
+	if (uselocking) {
+		PsychSignalCondition(&(dev->changeSignal));
+	}
+}
+
+static void PsychPAWaitForChange(PsychPADevice* dev)
+{
+	if (uselocking) {
 		// Locking and signalling: We have to wait for a signal, and we
 		// enter here with the device mutex held. Waiting is operating system dependent:
 		PsychWaitCondition(&(dev->changeSignal), &(dev->mutex));
 	}
 	else {
-		// No locking and signalling: Just yield for a bit, then retry...
-		PsychYieldIntervalSeconds(yieldInterval);
+		// No locking and signalling: Just yield for a bit, then retry...
+		PsychYieldIntervalSeconds(yieldInterval);
+	}
+}
+
+// Callback function which gets called when a portaudio stream (aka our engine) goes idle for any reason:
+// This will reset the device state to "idle/stopped" aka 0, reset pending stop requests and signal
+// the master thread if it is waiting for this to happen:
+void PAStreamFinishedCallback(void *userData)
+{
+    PsychPADevice* dev = (PsychPADevice*) userData;
+
+	// Lock device struct:
+	PsychPALockDeviceMutex(dev);
+
+	// Reset state to zero aka idle / stopped and reset pending requests:
+	dev->reqstate = 255;
+	
+	// Update "true" state to inactive:
+	dev->state = 0;
+
+	// If estimated stop time is still undefined at this point, it won't
+	// get computed anymore because the engine is stopped. We choose the
+	// last submitted samples playout time as best guess of the real
+	// stop time. On a regular stop (where hardware plays out all pending
+	// audio buffers) this is probably spot-on. On a fast abort however,
+	// this may be a too late estimate if the hardware really stopped
+	// immediately and dropped pending audio buffers, but we don't know
+	// how much was really played out as this is highly hardware dependent:
+	if (dev->estStopTime == 0) dev->estStopTime = dev->currentTime;
+
+	// Signal state change:
+	PsychPASignalChange(dev);
+
+	// Unlock device struct:
+	PsychPAUnlockDeviceMutex(dev);
+
+	// Ready.
+	return;
+}
+
+/* Logger callback function to output PortAudio debug messages at 'verbosity' > 5. */
+void PALogger(const char* msg)
+{
+	if (verbosity > 5) printf("PTB-DEBUG: PortAudio says: %s", msg);
+	return;
+}
+
+
+// Called exclusively from paCallback, with device-mutex held.
+// Check if a schedule is defined. If not, return repetition, playloop and bufferparameters
+// from the device struct, ie., old behaviour. If yes, check if an update of the schedule is
+// needed (ie., progressing to the next slot) and do so if needed. Return parameters from
+// current slot, or an abort signal if end of schedule reached.
+//
+// Return codes:
+// 0 = Valid buffer and playback parameters assigned. Proceed with audio playback as scheduled.
+// 1 = Regular end of playback or schedule reached. Finish playback.
+// 2 = Error abort, something is totally frelled.
+// 4 = Abort bufferfill operation for this host audio buffer via zerofill, but don't switch to idle mode / don't stop engine.
+//     Instead switch back to hot-standby so playback can be picked up again at a later point in time.
+//	   This is used to reschedule start of playback for a following slot at a later time.
+int PsychPAProcessSchedule(PsychPADevice* dev, psych_int64 *playposition, float** ret_playoutbuffer, psych_int64* ret_outsbsize, psych_int64* ret_outsboffset, double* ret_repeatCount, psych_int64* ret_playpositionlimit)
+{
+	psych_int64   loopStartFrame, loopEndFrame;
+	psych_int64  outsbsize, outsboffset;
+	psych_int64  outchannels = dev->outchannels;
+	unsigned int  slotid, cmd;
+	double		  repeatCount;
+	double		  reqTime;
+	psych_int64  playpositionlimit;
+	PsychPAFileBuffer* filebuffer = NULL;
+	
+	// NULL-Schedule?
+	if (dev->schedule == NULL) {
+		// Yes: Assign settings from dev-struct:
+		*ret_playoutbuffer = dev->outputbuffer;
+		outsbsize = dev->outputbuffersize / sizeof(float);
+		dev->slotSampleRate = 0.0;
+
+		// Fetch boundaries of playback loop:
+		loopStartFrame = dev->loopStartFrame;
+		loopEndFrame = dev->loopEndFrame;
+		repeatCount = dev->repeatCount;
+
+		// Revalidate boundaries of playback loop:
+		if (loopStartFrame * outchannels >= outsbsize) loopStartFrame = (outsbsize / outchannels) - 1;
+		if (loopStartFrame < 0) loopStartFrame = 0;
+		if (loopEndFrame * outchannels >= outsbsize) loopEndFrame = (outsbsize / outchannels) - 1;
+		if (loopEndFrame < 0) loopEndFrame = 0;
+		if (loopEndFrame < loopStartFrame) loopEndFrame = loopStartFrame;
+		
+		// Remap defined playback loop to "corrected" outsbsize and offset for later copy-op:
+		outsbsize   = (loopEndFrame - loopStartFrame + 1) * outchannels;
+		outsboffset = loopStartFrame * outchannels;
+		
+		// Compute playpositionlimit, the upper limit of played out samples from loop duration and repeatCount...
+		playpositionlimit = ((psych_int64) (repeatCount * outsbsize));
+		// ...and make sure it ends on integral sample frame boundaries:
+		playpositionlimit -= playpositionlimit % outchannels;
+
+		// Check if loop and repetition constraints are still valid:
+		if ( !((repeatCount == -1) || (*playposition < playpositionlimit)) || (NULL == *ret_playoutbuffer)) {
+			// No. Signal regular end of playback:
+			return(1);
+		}
+	}
+	else {
+		// No: Real schedule:
+		
+		do {
+			// Find current slot (with wraparound):
+			slotid = dev->schedule_pos % dev->schedule_size;
+			filebuffer = NULL;
+			
+			// Current slot valid and pending?
+			if ((dev->schedule[slotid].mode & 2) == 0) {
+				// No: End of schedule reached - Signal regular abort request and that's it:
+				return(1);
+			}
+			
+			// Current slot is valid: Assign it:
+			cmd = dev->schedule[slotid].command;
+			if (cmd > 0) {
+				// Special command buffer: Doesn't contain sound, but some special
+				// control commands. Process it, then advance to next slot...
+				
+				// This makes sure we repeat the loop, advancing to the next slot:
+				*ret_playoutbuffer = NULL;
+				outsbsize = 0;
+
+				// Compute absolute deadline from given tWhen timespec and type of timespec:
+				if (cmd & 4)  reqTime = dev->schedule[slotid].tWhen;						// Absolute system time specified.
+                // Relative to last requested start time. We use last true start time as fallback if the requested start time is undefined:
+				if (cmd & 8)  reqTime = ((dev->reqStartTime > 0.0) ? dev->reqStartTime : dev->startTime) + dev->schedule[slotid].tWhen;
+				if (cmd & 16) reqTime = dev->startTime + dev->schedule[slotid].tWhen;		// Relative to last true start time.
+				// TODO: The following two "end time" related ones are pretty broken - Can't
+				// work the way i want it to work, as relevant information is not available at
+				// the time we'd need it, ie., at this point in execution flow...
+				// Need to think about this, or scrap the idea of end-time related timeoffsets...
+				if (cmd & 32) reqTime = dev->reqStopTime + dev->schedule[slotid].tWhen;		// Relative to last requested end time.
+				if (cmd & 64) reqTime = dev->estStopTime + dev->schedule[slotid].tWhen;		// Relative to last true end time.
+				
+				// Pause-playback-and-restart command?
+				if (cmd & 1) {
+					// Yes. We should abort playback at this point, ie. fill the remainder
+					// of the audiobuffer with silence. Then we shall switch back to hot-standby
+					// and reschedule ourselves for restart of playback at a given target reqTime:
+					dev->reqStartTime = reqTime;
+
+					// Manually invalidate this slot and advance schedule to next one, whose
+					// resampling starts without fractional offset or ratio ramp of this one:
+					*playposition = 0;
+					dev->resamplePhase = 0.0;
+					dev->resampleRatio = 0.0;
+					// Only disable if the flag 4 aka "don't auto-disable" isn't set:
+					if (!(dev->schedule[slotid].mode & 4)) dev->schedule[slotid].mode &= ~2;
+					dev->schedule_pos++;
+
+					// Return with special code 4 to reschedule:
+					return(4);
+				}
+
+				// Reschedule end-of-playback command?
+				if (cmd & 2) {
+					// Yes. We should end playback at given target reqTime, then go idle:
+					dev->reqStopTime = reqTime;
+
+					// Nothing further to do here. Will auto-advance to next schedule slot after
+					// this one, possibly outputting further sound...
+				}
+				
+				// End of command buffer processing.
+			} // Regular audio buffer: First assign outbuffer size and pointer...
+			else if (dev->schedule[slotid].bufferhandle <= 0) {
+				// Default device playoutbuffer:
+				*ret_playoutbuffer = dev->outputbuffer;
+				outsbsize = dev->outputbuffersize / sizeof(float);
+				dev->slotSampleRate = 0.0;
+			}
+			else
+			{
+				// Dynamic buffer: Dereference bufferhandle and fetch buffer data for later use:
+				
+				// Need to lock bufferList lock to do this:
+				PsychLockMutex(&bufferListmutex);
+
+				if (bufferList && (dev->schedule[slotid].bufferhandle < bufferListCount)) {
+					// Fetch pointer to actual audio data buffer:
+					*ret_playoutbuffer = bufferList[dev->schedule[slotid].bufferhandle].outputbuffer;
+					
+					// Retrieve buffersize in samples:
+					outsbsize = bufferList[dev->schedule[slotid].bufferhandle].outputbuffersize / sizeof(float);
+
+					// Backing store if this is a file backed buffer:
+					filebuffer = bufferList[dev->schedule[slotid].bufferhandle].filebuffer;
+
+					// Samplerate of its sound data, if specified:
+					dev->slotSampleRate = bufferList[dev->schedule[slotid].bufferhandle].sampleRate;
+					
+					// Another child protection:
+					if (outchannels != bufferList[dev->schedule[slotid].bufferhandle].outchannels) {
+						*ret_playoutbuffer = NULL;
+						outsbsize = 0;
+					}
+				}
+				else {
+					*ret_playoutbuffer = NULL;
+					outsbsize = 0;
+				}
+				
+				// Unlock bufferList mutex again:
+				PsychUnlockMutex(&bufferListmutex);
+			}
+
+			// ... then loop and repeat parameters:
+			loopStartFrame = dev->schedule[slotid].loopStartFrame;
+			loopEndFrame   = dev->schedule[slotid].loopEndFrame;
+			repeatCount    = dev->schedule[slotid].repetitions;
+			
+			// Revalidate boundaries of playback loop:
+			if (loopStartFrame * outchannels >= outsbsize) loopStartFrame = (outsbsize / outchannels) - 1;
+			if (loopStartFrame < 0) loopStartFrame = 0;
+			if (loopEndFrame * outchannels >= outsbsize) loopEndFrame = (outsbsize / outchannels) - 1;
+			if (loopEndFrame < 0) loopEndFrame = 0;
+			if (loopEndFrame < loopStartFrame) loopEndFrame = loopStartFrame;
+			
+			// Remap defined playback loop to "corrected" outsbsize and offset for later copy-op:
+			outsbsize = (psych_int64) ((loopEndFrame - loopStartFrame + 1) * outchannels);
+			outsboffset = (psych_int64) (loopStartFrame * outchannels);
+			
+			// Compute playpositionlimit, the upper limit of played out samples from loop duration and repeatCount...
+			playpositionlimit = ((psych_int64) (repeatCount * outsbsize));
+			// ...and make sure it ends on integral sample frame boundaries:
+			playpositionlimit -= playpositionlimit % outchannels;
+			
+			// Check if loop and repetition constraints as well as actual audio buffer for this slot are still valid:
+			if ( !((repeatCount == -1) || (*playposition < playpositionlimit)) || (NULL == *ret_playoutbuffer) ) {
+				// Constraints violated. This slot is used up: Reset playposition, including fractional
+				// position and ratio ramp of the resampler, and advance to next slot:
+				*playposition = 0;
+				dev->resamplePhase = 0.0;
+				dev->resampleRatio = 0.0;
+				// Only disable if the flag 4 aka "don't auto-disable" isn't set:
+				if (!(dev->schedule[slotid].mode & 4)) dev->schedule[slotid].mode &= ~2;
+				dev->schedule_pos++;
+			}
+			else {
+				// Constraints ok, break out of do-while slot advance loop:
+				break;
+			}
+		} while(TRUE);
+
+		// Tell read-ahead thread where we are, if this is a file backed buffer:
+		if (filebuffer) PsychPAFileBufferHint(filebuffer, outsboffset + (*playposition % outsbsize), outsboffset, outsbsize);
+	}
+
+	// Remember backing store for the underrun check in paCallback():
+	dev->slotFileBuffer = filebuffer;
+	
+	*ret_outsbsize = outsbsize;
+	*ret_outsboffset = outsboffset;
+	*ret_repeatCount = repeatCount;
+	*ret_playpositionlimit = playpositionlimit;
+
+	// Safety check: If playoutbuffer is NULL at this point, then somethings screwed
+	// and we request abort of playback:
+	if (NULL == *ret_playoutbuffer) return(2);
+
+	// Return 0 exit to signal a valid update:
+	return(0);
+}
+
+// Quality presets of the resampler: Number of filter taps, beta parameter of the Kaiser window of the windowed sinc
+// filter kernel, and passband edge relative to the Nyquist frequency. Preset 0 is linear interpolation:
+static const int	resamplerTaps[PSYCH_AUDIO_RESAMPLER_PRESETS] = { 2, 16, 32, 64 };
+static const double resamplerBeta[PSYCH_AUDIO_RESAMPLER_PRESETS] = { 0.0, 6.0, 8.6, 10.0 };
+static const double resamplerPassband[PSYCH_AUDIO_RESAMPLER_PRESETS] = { 1.0, 0.85, 0.9, 0.94 };
+
+// Zeroth order modified Bessel function of the first kind, for the Kaiser window:
+static double PsychPABesselI0(double x)
+{
+	double sum = 1.0, term = 1.0;
+	int k;
+
+	for (k = 1; k < 50; k++) {
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1e-12) break;
+	}
+
+	return(sum);
+}
+
+// Release resampler 'rs':
+static void PsychPADestroyResampler(PsychPAResampler* rs)
+{
+	if (NULL == rs) return;
+	free(rs->table);
+	free(rs->window);
+	free(rs);
+}
+
+// Create a resampler with quality preset 'quality' for sound with 'outchannels' channels, whose anti-aliasing
+// cutoff is suitable for conversion ratios up to 'designRatio' source frames per output frame. Returns NULL on
+// out of memory:
+static PsychPAResampler* PsychPACreateResampler(int quality, double designRatio, psych_int64 outchannels)
+{
+	PsychPAResampler* rs;
+	double cutoff, x, u, h, sum, i0beta;
+	double* kernel;
+	int p, t, taps;
+
+	rs = (PsychPAResampler*) calloc(1, sizeof(PsychPAResampler));
+	if (NULL == rs) return(NULL);
+
+	taps = resamplerTaps[quality];
+	rs->quality = quality;
+	rs->taps = taps;
+	rs->designRatio = designRatio;
+	rs->table = (float*) malloc(sizeof(float) * (PSYCH_AUDIO_RESAMPLER_PHASES + 1) * taps);
+	rs->window = (float*) malloc(sizeof(float) * taps * (size_t) outchannels);
+	kernel = (double*) malloc(sizeof(double) * taps);
+	if (!rs->table || !rs->window || !kernel) {
+		free(kernel);
+		PsychPADestroyResampler(rs);
+		return(NULL);
+	}
+
+	// Cutoff frequency relative to source Nyquist frequency: When downsampling, ie., reading more than
+	// one source frame per output frame, it must be lowered to the output Nyquist frequency to prevent aliasing:
+	cutoff = resamplerPassband[quality] * ((designRatio > 1.0) ? 1.0 / designRatio : 1.0);
+	i0beta = PsychPABesselI0(resamplerBeta[quality]);
+
+	// Phase p of the table holds the taps for an output frame at fractional position p / PHASES between two
+	// source frames. Tap t applies to the source frame at offset t - taps/2 + 1 from the integral position:
+	for (p = 0; p <= PSYCH_AUDIO_RESAMPLER_PHASES; p++) {
+		sum = 0;
+		for (t = 0; t < taps; t++) {
+			x = (double) (t - taps / 2 + 1) - (double) p / PSYCH_AUDIO_RESAMPLER_PHASES;
+			if (quality == 0) {
+				// Linear interpolation:
+				h = 1.0 - fabs(x);
+				if (h < 0) h = 0;
+			}
+			else {
+				// Kaiser windowed sinc:
+				h = (x == 0) ? cutoff : sin(M_PI * cutoff * x) / (M_PI * x);
+				u = x / (taps / 2);
+				h *= (fabs(u) < 1.0) ? PsychPABesselI0(resamplerBeta[quality] * sqrt(1.0 - u * u)) / i0beta : 0.0;
+			}
+			kernel[t] = h;
+			sum += h;
+		}
+
+		// Normalize to unity gain at DC, to avoid ripple between phases:
+		for (t = 0; t < taps; t++) rs->table[p * taps + t] = (float) (kernel[t] / sum);
+	}
+
+	free(kernel);
+
+	return(rs);
+}
+
+// Compute the sample rate conversion ratio, ie., the number of source frames per output frame, of device 'dev'
+// for sound data with samplerate 'bufferRate', or with the samplerate of the device if 'bufferRate' is zero:
+static double PsychPAGetResampleRatio(PsychPADevice* dev, double bufferRate)
+{
+	double deviceRate = dev->streaminfo->sampleRate;
+	double sourceRate = (bufferRate > 0) ? bufferRate : ((dev->sourceRate > 0) ? dev->sourceRate : deviceRate);
+
+	return(sourceRate / deviceRate * dev->playbackRate);
+}
+
+// Make sure device 'dev' has a resampler suitable for its current settings and the buffers in its schedule,
+// if it needs one. Called from the main thread, as building the filter table is too expensive for the callback:
+static void PsychPAUpdateResampler(PsychPADevice* dev)
+{
+	PsychPAResampler* rs;
+	PsychPAResampler* oldrs;
+	double ratio, maxRatio;
+	psych_bool needed;
+	unsigned int i;
+	int h;
+
+	// Only playback on regular devices and slaves supports resampling:
+	if (!(dev->opmode & kPortAudioPlayBack) || (dev->opmode & kPortAudioIsMaster)) return;
+
+	// Find highest conversion ratio for the device itself and all buffers in its schedule:
+	maxRatio = PsychPAGetResampleRatio(dev, 0);
+	needed = (maxRatio != 1.0);
+
+	if (dev->schedule) {
+		PsychLockMutex(&bufferListmutex);
+		for (i = 0; i < dev->schedule_size; i++) {
+			h = dev->schedule[i].bufferhandle;
+			if (!(dev->schedule[i].mode & 2) || (h <= 0) || (h >= bufferListCount) || !(bufferList[h].sampleRate > 0)) continue;
+			ratio = PsychPAGetResampleRatio(dev, bufferList[h].sampleRate);
+			if (ratio != 1.0) needed = TRUE;
+			if (ratio > maxRatio) maxRatio = ratio;
+		}
+		PsychUnlockMutex(&bufferListmutex);
+	}
+
+	// Current resampler good enough?
+	if (!needed || (dev->resampler && (dev->resampler->quality == dev->resampleQuality) && (dev->resampler->designRatio >= maxRatio))) return;
+
+	// No: Build a new one. When downsampling, leave some headroom for rising playback rates,
+	// so continuous playback rate changes don't need a rebuild for each change:
+	rs = PsychPACreateResampler(dev->resampleQuality, (maxRatio > 1.0) ? maxRatio * 1.1 : 1.0, dev->outchannels);
+	if (NULL == rs) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for creating sample rate converter!");
+
+	// Swap it in:
+	PsychPALockDeviceMutex(dev);
+	oldrs = dev->resampler;
+	dev->resampler = rs;
+	PsychPAUnlockDeviceMutex(dev);
+
+	PsychPADestroyResampler(oldrs);
+}
+
+// Dot products of the 'taps' samples in 'x' with the taps of two adjacent filter phases 'h0' and 'h1',
+// linearly interpolated with weight 'frac'. Four independent accumulators per phase allow compilers
+// to use SIMD instructions:
+static float PsychPAResampleDot(const float* x, const float* h0, const float* h1, int taps, float frac)
+{
+	float a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+	float b0 = 0, b1 = 0, b2 = 0, b3 = 0;
+	float a, b;
+	int t;
+
+	for (t = 0; t + 3 < taps; t += 4) {
+		a0 += x[t] * h0[t]; a1 += x[t+1] * h0[t+1]; a2 += x[t+2] * h0[t+2]; a3 += x[t+3] * h0[t+3];
+		b0 += x[t] * h1[t]; b1 += x[t+1] * h1[t+1]; b2 += x[t+2] * h1[t+2]; b3 += x[t+3] * h1[t+3];
+	}
+
+	for (; t < taps; t++) {
+		a0 += x[t] * h0[t];
+		b0 += x[t] * h1[t];
+	}
+
+	a = (a0 + a1) + (a2 + a3);
+	b = (b0 + b1) + (b2 + b3);
+
+	return(a + frac * (b - a));
+}
+
+// Resample sound data of the current schedule slot of device 'dev' with conversion ratio 'ratio' into 'out', applying
+// 'gain'. Output samples are multiplied into 'out' if 'multiply' is set, assigned otherwise. Produces at most 'maxSamples'
+// output samples, less if the end of the last repetition of the slot is reached. Updates 'playposition', which counts
+// consumed source samples. Returns the number of produced output samples:
+static psych_int64 PsychPAResampleSlot(PsychPADevice* dev, float* out, psych_int64 maxSamples, const float* playoutbuffer, psych_int64 outsbsize, psych_int64 outsboffset,
+									   double repeatCount, psych_int64 playpositionlimit, psych_int64* playposition, double ratio, float gain, psych_bool multiply)
+{
+	PsychPAResampler* rs = dev->resampler;
+	psych_int64 outchannels = dev->outchannels;
+	psych_int64 frame, limitFrames, s, pos, framepos, back, n, c;
+	float* x = rs->window;
+	const float *h0, *h1;
+	double phase, pf, whole, r, step;
+	float frac, v;
+	int taps = rs->taps;
+	int t, p;
+
+	// Ramp the conversion ratio linearly from the ratio at the end of the previous callback to the new
+	// ratio, to avoid zipper noise on playback rate changes:
+	r = (dev->resampleRatio > 0) ? dev->resampleRatio : ratio;
+	step = (maxSamples >= outchannels) ? (ratio - r) / (double) (maxSamples / outchannels) : 0;
+
+	phase = dev->resamplePhase;
+	frame = *playposition / outchannels;
+	limitFrames = (repeatCount == -1) ? -1 : playpositionlimit / outchannels;
+
+	// Sample offset of the current frame inside the playloop, and distance of the first filter tap
+	// before it. Both are advanced with compare and wraparound, not with a division per frame:
+	framepos = (frame * outchannels) % outsbsize;
+	back = (psych_int64) (taps / 2 - 1) * outchannels;
+
+	for (n = 0; (n < maxSamples) && ((limitFrames < 0) || (frame < limitFrames)); n += outchannels) {
+		// Gather the 'taps' source frames around the current position into per-channel contiguous windows.
+		// Positions before the start of playback or after the end of the last repetition are silent. All sound
+		// data is already in the buffer, so the filter is centered on the current position without added latency:
+		s = frame - taps / 2 + 1;
+		if (s >= 0) {
+			pos = framepos - back;
+			while (pos < 0) pos += outsbsize;
+		}
+		else pos = 0;
+		for (t = 0; t < taps; t++, s++) {
+			if ((s < 0) || ((limitFrames >= 0) && (s >= limitFrames))) {
+				for (c = 0; c < outchannels; c++) x[c * taps + t] = 0;
+				continue;
+			}
+
+			for (c = 0; c < outchannels; c++) x[c * taps + t] = playoutbuffer[outsboffset + pos + c];
+			pos += outchannels;
+			if (pos >= outsbsize) pos -= outsbsize;
+		}
+
+		// Select the two filter phases around the fractional position and filter each channel:
+		pf = phase * PSYCH_AUDIO_RESAMPLER_PHASES;
+		p = (int) pf;
+		frac = (float) (pf - p);
+		h0 = &(rs->table[p * taps]);
+		h1 = h0 + taps;
+
+		for (c = 0; c < outchannels; c++) {
+			v = PsychPAResampleDot(&(x[c * taps]), h0, h1, taps, frac) * gain;
+			if (multiply) out[n + c] *= v; else out[n + c] = v;
+		}
+
+		// Advance fractional source position:
+		r += step;
+		phase += r;
+		whole = floor(phase);
+		frame += (psych_int64) whole;
+		phase -= whole;
+		framepos += (psych_int64) whole * outchannels;
+		while (framepos >= outsbsize) framepos -= outsbsize;
+	}
+
+	*playposition = frame * outchannels;
+	dev->resamplePhase = phase;
+	dev->resampleRatio = r;
+
+	return(n);
+}
+
+// Value of the task counter of a mixer pool while no job is pending: Any stray
+// increments by late workers will still yield an invalid task index:
+#define PSYCH_AUDIO_MIXER_NOTASKS 0x40000000
+
+// Forward declaration of our stream callback, as slave processing calls it recursively:
+static int paCallback( const void *inputBuffer, void *outputBuffer, unsigned long framesPerBuffer, const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags, void *userData );
+
+// Process one slave 'slaveId' of master 'dev': Run its AM modulator slave, if any, distribute captured
+// sound from 'in' to it, run its callback, then mix its output into 'mixBuffer', starting at sample frame
+// 'committedFrames'. 'outBuffer', 'gainBuffer' and 'inBuffer' are scratch buffers with the size of the
+// masters slaveOutBuffer, slaveGainBuffer and slaveInBuffer. Called by the master callback and by the
+// mixer threads of the master, each with its own scratch buffers:
+static void PsychPAMixSlave(PsychPADevice* dev, int slaveId, const float* in, float* mixBuffer, float* outBuffer, float* gainBuffer, float* inBuffer,
+							psych_int64 committedFrames, const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags)
+{
+	psych_int64 j, k;
+	psych_int64 outchannels = dev->outchannels;
+	psych_int64 inchannels = dev->inchannels;
+	float *tmpBuffer, *dstBuffer;
+	int modulatorSlave;
+
+	// Gain modulator slave for this real slave attached, valid and active?
+	// If this is the case, we need to unconditionally execute it here, regardless
+	// of what the actual 'slaveId' device is up to. Otherwise we can run into
+	// time sync issues and ugly deadlocks in the calling code:
+	modulatorSlave = audiodevices[slaveId].modulatorSlave;
+	if ((modulatorSlave > -1) && (audiodevices[modulatorSlave].stream) &&
+		(audiodevices[modulatorSlave].opmode & kPortAudioIsAMModulatorForSlave) && (audiodevices[modulatorSlave].state > 0)) {
+		// Yes. Execute it:
+		audiodevices[modulatorSlave].slaveDirty = 0;
+
+		// Prefill buffer with neutral 1.0:
+		tmpBuffer = gainBuffer;
+		for (j = 0; j < dev->batchsize * audiodevices[modulatorSlave].outchannels; j++) *(tmpBuffer++) = 1.0;
+
+		// This will potentially fill the gainBuffer with gain modulation values.
+		// The passed inBuffer is meaningless for a modulator slave and only contains random junk...
+		paCallback( (const void*) inBuffer, (void*) gainBuffer, (unsigned long) dev->batchsize, timeInfo, statusFlags, (void*) &(audiodevices[modulatorSlave]));
+	}
+	else {
+		// No. Either no modulator slave or slave not currently active. Signal this
+		// by setting modulatorSlave to a -1 value:
+		modulatorSlave = -1;
+	}
+
+	// Skip actual slaves processing if its state is zero == completely inactive.
+	if (audiodevices[slaveId].state == 0) return;
+
+	// Slave is active, need to process it:
+
+	// Reset dirty flag for this slave:
+	audiodevices[slaveId].slaveDirty = 0;
+
+	// Is this a playback slave?
+	if (audiodevices[slaveId].opmode & kPortAudioPlayBack) {
+		// Prefill slaves output buffer with 1.0, a neutral gain value for playback slaves
+		// without a AM modulator attached. The same prefill is needed with AM modulator,
+		// this time to make the modulator itself happy:
+		tmpBuffer = outBuffer;
+		for (j = 0; j < dev->batchsize * audiodevices[slaveId].outchannels; j++) *(tmpBuffer++) = 1.0;
+
+		// Ok, the outbuffer is filled with a neutral 1.0 gain value. This will work
+		// even if no per-slave gain modulation is provided by a modulator slave.
+
+		// Is a modulator slave active and did it write any gain AM values?
+		if ((modulatorSlave > -1) && (audiodevices[modulatorSlave].slaveDirty)) {
+			// Yes. Need to distribute them to proper channels in outBuffer:
+			tmpBuffer = gainBuffer;
+			dstBuffer = outBuffer;
+			for (j = 0; j < dev->batchsize; j++) {
+				// Iterate over all target channels in the slave device outputbuffer:
+				for (k = 0; k < audiodevices[modulatorSlave].outchannels; k++) {
+					// Modulate current sample in intermixbuffer via multiplication:
+					dstBuffer[(j * audiodevices[slaveId].outchannels) + audiodevices[modulatorSlave].outputmappings[k]] = *(tmpBuffer++) * audiodevices[modulatorSlave].outChannelVolumes[k];
+				}
+			}
+		}
+	}	// Ok, the outBuffer for this playback slave is prefilled with valid gain modulation data to apply to the actual sound output.
+
+	// Capture enabled on slave? If so, we need to distribute our captured audio data to it:
+	if (audiodevices[slaveId].opmode & kPortAudioCapture) {
+		tmpBuffer = inBuffer;
+		// For each sampleFrame in the input buffer:
+		for (j = 0; j < dev->batchsize; j++) {
+			// Iterate over all target channels in the slave devices inputbuffer:
+			for (k = 0; k < audiodevices[slaveId].inchannels; k++) {
+				// And fetch from corrsponding source channel of our device:
+				*(tmpBuffer++) = in[(j * inchannels) + audiodevices[slaveId].inputmappings[k]];
+			}
+		}
+	}
+
+	// Temporary input buffer is filled for slave callback: Execute it.
+	paCallback( (const void*) inBuffer, (void*) outBuffer, (unsigned long) dev->batchsize, timeInfo, statusFlags, (void*) &(audiodevices[slaveId]));
+
+	// Check if the paCallback actually filled anything into the outBuffer:
+	if ((audiodevices[slaveId].opmode & kPortAudioPlayBack) && audiodevices[slaveId].slaveDirty) {
+		// Slave has written meaningful data to its output buffer. Merge & mix it:
+
+		// Process from first non-silence sample slot (after silenceframes prefix) until end of buffer:
+		tmpBuffer = &(outBuffer[committedFrames * audiodevices[slaveId].outchannels]);
+
+		// Special AM-Modulator slave?
+		if (audiodevices[slaveId].opmode & kPortAudioIsAMModulator) {
+			// Yes: This slave doesn't provide audio data for mixing, but instead
+			// a time-series of gain modulation samples for amplitude modulation.
+			// Multiply the master channels samples with the slaves "gain samples"
+			// to apply AM modulation:
+			for (j = committedFrames; j < dev->batchsize; j++) {
+				// Iterate over all target channels in the slave device outputbuffer:
+				for (k = 0; k < audiodevices[slaveId].outchannels; k++) {
+					// Modulate current sample in intermixbuffer via multiplication:
+					mixBuffer[(j * outchannels) + audiodevices[slaveId].outputmappings[k]] *= *(tmpBuffer++) * audiodevices[slaveId].outChannelVolumes[k];
+				}
+			}
+		}
+		else {
+			// Regular mix: Mix all output channels of the slave into the proper target channels
+			// of the master by simple addition. Apply per-channel volume settings of the slave
+			// during mix:
+			for (j = committedFrames; j < dev->batchsize; j++) {
+				// Iterate over all target channels in the slave device outputbuffer:
+				for (k = 0; k < audiodevices[slaveId].outchannels; k++) {
+					// Mix current sample via addition:
+					mixBuffer[(j * outchannels) + audiodevices[slaveId].outputmappings[k]] += *(tmpBuffer++) * audiodevices[slaveId].outChannelVolumes[k];
+				}
+			}
+		}
 	}
 }
 
-// Callback function which gets called when a portaudio stream (aka our engine) goes idle for any reason:
-// This will reset the device state to "idle/stopped" aka 0, reset pending stop requests and signal
-// the master thread if it is waiting for this to happen:
-void PAStreamFinishedCallback(void *userData)
+// Claim and process slaves of the current job of mixer pool 'pool', until no unclaimed slaves are
+// left. Mixes into 'mixBuffer', using the given scratch buffers. If 'mixJob' is non-NULL, 'mixBuffer'
+// is private to the caller, and gets cleared before the first slave of a new job is mixed into it,
+// and the time spent in slave processing for that job is accumulated in 'jobCost'. If 'busy' is non-NULL,
+// it is set while the caller may claim or process slaves. Returns the time spent in slave processing
+// during this call:
+static double PsychPAMixerRunTasks(PsychPAMixerPool* pool, float* mixBuffer, float* outBuffer, float* gainBuffer, float* inBuffer, volatile int* mixJob, volatile double* jobCost, volatile int* busy)
 {
-    PsychPADevice* dev = (PsychPADevice*) userData;
+	double tStart, tEnd, cost = 0;
+	int task, job;
+
+	while (TRUE) {
+		// Tell the master that our mixBuffer may be modified before we try to claim a slave:
+		if (busy) {
+			*busy = 1;
+			PsychPAMemoryBarrier();
+		}
 
-	// Lock device struct:
-	PsychPALockDeviceMutex(dev);
+		if ((task = (int) PsychPAAtomicFetchAndIncrement(&pool->nextTask)) >= pool->numTasks) break;
 
-	// Reset state to zero aka idle / stopped and reset pending requests:
-	dev->reqstate = 255;
-	
-	// Update "true" state to inactive:
-	dev->state = 0;
+		PsychGetAdjustedPrecisionTimerSeconds(&tStart);
 
-	// If estimated stop time is still undefined at this point, it won't
-	// get computed anymore because the engine is stopped. We choose the
-	// last submitted samples playout time as best guess of the real
-	// stop time. On a regular stop (where hardware plays out all pending
-	// audio buffers) this is probably spot-on. On a fast abort however,
-	// this may be a too late estimate if the hardware really stopped
-	// immediately and dropped pending audio buffers, but we don't know
-	// how much was really played out as this is highly hardware dependent:
-	if (dev->estStopTime == 0) dev->estStopTime = dev->currentTime;
+		// First slave of this job for us? Then clear our private mix buffer:
+		job = pool->job;
+		if (mixJob && (*mixJob != job)) {
+			memset(mixBuffer, 0, (size_t) (pool->dev->batchsize * pool->dev->outchannels) * sizeof(float));
+			*jobCost = 0;
+			*mixJob = job;
+		}
 
-	// Signal state change:
-	PsychPASignalChange(dev);
+		PsychPAMixSlave(pool->dev, pool->tasks[task], pool->in, mixBuffer, outBuffer, gainBuffer, inBuffer, pool->committedFrames, &(pool->timeInfo), pool->statusFlags);
+
+		PsychGetAdjustedPrecisionTimerSeconds(&tEnd);
+		cost += tEnd - tStart;
+		if (jobCost) *jobCost += tEnd - tStart;
+
+		// Done with this slave. The atomic increment also publishes our mixBuffer content to the master:
+		pool->taskDone[task] = 1;
+		PsychPAAtomicFetchAndIncrement(&pool->tasksDone);
+	}
+
+	if (busy) *busy = 0;
+
+	return(cost);
+}
+
+// Is slave 'slaveId' still being processed by a mixer thread of 'pool' for an abandoned job? Then
+// nobody else must process it, as its callback must not run concurrently on two threads:
+static psych_bool PsychPAMixerSlaveInFlight(PsychPAMixerPool* pool, int slaveId)
+{
+	int i;
+
+	if ((NULL == pool) || (pool->tasksDone >= pool->numTasks)) return(FALSE);
+
+	for (i = 0; i < pool->numTasks; i++) {
+		if ((pool->tasks[i] == slaveId) && !pool->taskDone[i]) return(TRUE);
+	}
+
+	return(FALSE);
+}
+
+// Main routine of a mixer thread: Spin-wait for new jobs from the master callback and help processing them:
+static void* PsychPAMixerThreadMain(void* arg)
+{
+	PsychPAMixerWorker* w = (PsychPAMixerWorker*) arg;
+	PsychPAMixerPool* pool = w->pool;
+	double tLastJob, now;
+	int lastJob, spins = 0;
+	int rc;
+
+	// Try to run at realtime priority, like the audio callback thread. The master only uses
+	// the pool if all its mixer threads succeed, as a normal priority thread could get preempted
+	// at any time, making the master wait for it:
+	if ((rc = PsychSetThreadPriority(NULL, 2, 0)) > 0) {
+		if (verbosity > 5) printf("PTB-DEBUG: PsychPortAudio: Failed to raise priority of mixer thread [%s].\n", strerror(rc));
+		w->realtime = -1;
+	}
+	else {
+		w->realtime = 1;
+	}
+	PsychPAMemoryBarrier();
+
+	lastJob = pool->job;
+	PsychGetAdjustedPrecisionTimerSeconds(&tLastJob);
+
+	while (!pool->shutdown) {
+		if (pool->job == lastJob) {
+			// No new job: Keep spinning while the master is busy. If no jobs arrived for a while,
+			// e.g., because the master is idle or stopped, poll at a leisurely pace instead, so we
+			// don't waste a cpu core. The master processes all slaves itself if we are late:
+			PsychPACpuRelax();
+			if (++spins < 1000) continue;
+			spins = 0;
+
+			PsychGetAdjustedPrecisionTimerSeconds(&now);
+			if (now - tLastJob > PSYCH_AUDIO_MIXER_SPINTIMEOUT) PsychYieldIntervalSeconds(0.001);
+			continue;
+		}
+
+		lastJob = pool->job;
+		PsychPAMixerRunTasks(pool, w->mixBuffer, w->outBuffer, w->gainBuffer, w->inBuffer, &(w->mixJob), &(w->cost), &(w->busy));
+		PsychGetAdjustedPrecisionTimerSeconds(&tLastJob);
+	}
+
+	return(NULL);
+}
+
+// Stop all mixer threads of 'pool' and release it:
+static void PsychPADestroyMixerPool(PsychPAMixerPool* pool)
+{
+	int i;
+
+	if (NULL == pool) return;
+
+	pool->shutdown = 1;
+	PsychPAMemoryBarrier();
+
+	for (i = 0; i < pool->numWorkers; i++) {
+		if (pool->workers[i].running) PsychDeleteThread(&(pool->workers[i].thread));
+		free(pool->workers[i].mixBuffer);
+		free(pool->workers[i].outBuffer);
+		free(pool->workers[i].gainBuffer);
+		free(pool->workers[i].inBuffer);
+	}
+
+	free(pool->workers);
+	free(pool);
+}
+
+// Create a pool of 'numWorkers' mixer threads for a master with 'outchannels' output and 'inchannels' input
+// channels, with scratch buffers for callbacks of up to 'maxFrames' sample frames. Returns NULL on failure:
+static PsychPAMixerPool* PsychPACreateMixerPool(int numWorkers, psych_int64 maxFrames, psych_int64 outchannels, psych_int64 inchannels)
+{
+	PsychPAMixerPool* pool;
+	PsychPAMixerWorker* w;
+	int i, rc;
+
+	pool = (PsychPAMixerPool*) calloc(1, sizeof(PsychPAMixerPool));
+	if (NULL == pool) return(NULL);
+
+	pool->workers = (PsychPAMixerWorker*) calloc(numWorkers, sizeof(PsychPAMixerWorker));
+	if (NULL == pool->workers) {
+		free(pool);
+		return(NULL);
+	}
+
+	pool->numWorkers = numWorkers;
+	pool->nextTask = PSYCH_AUDIO_MIXER_NOTASKS;
+	pool->outCapacity = maxFrames * outchannels;
+	pool->inCapacity = maxFrames * inchannels;
+
+	// Allocate all scratch buffers upfront, as the realtime callback must not allocate memory:
+	for (i = 0; i < numWorkers; i++) {
+		w = &(pool->workers[i]);
+		w->mixBuffer = (float*) malloc((size_t) (pool->outCapacity + 1) * sizeof(float));
+		w->outBuffer = (float*) malloc((size_t) (pool->outCapacity + 1) * sizeof(float));
+		w->gainBuffer = (float*) malloc((size_t) (pool->outCapacity + 1) * sizeof(float));
+		w->inBuffer = (float*) malloc((size_t) (pool->inCapacity + 1) * sizeof(float));
+		if (!w->mixBuffer || !w->outBuffer || !w->gainBuffer || !w->inBuffer) {
+			printf("PTB-ERROR: PsychPortAudio: Out of memory while creating mixer thread scratch buffers.\n");
+			PsychPADestroyMixerPool(pool);
+			return(NULL);
+		}
+	}
+
+	for (i = 0; i < numWorkers; i++) {
+		pool->workers[i].pool = pool;
+		pool->workers[i].mixJob = -1;
+		if ((rc = PsychCreateThread(&(pool->workers[i].thread), NULL, PsychPAMixerThreadMain, (void*) &(pool->workers[i])))) {
+			printf("PTB-ERROR: PsychPortAudio: Failed to create mixer thread %i [%s].\n", i, strerror(rc));
+			PsychPADestroyMixerPool(pool);
+			return(NULL);
+		}
+		pool->workers[i].running = 1;
+	}
+
+	return(pool);
+}
+
+// Wait for all mixer threads of 'pool' to start up. Returns TRUE if all of them run at realtime
+// priority, FALSE if any of them failed to get it, or didn't start in time:
+static psych_bool PsychPAMixerPoolIsRealtime(PsychPAMixerPool* pool)
+{
+	double tDeadline, now;
+	int i;
+
+	PsychGetAdjustedPrecisionTimerSeconds(&tDeadline);
+	tDeadline += PSYCH_AUDIO_MIXER_STARTTIMEOUT;
+
+	for (i = 0; i < pool->numWorkers; i++) {
+		while (pool->workers[i].realtime == 0) {
+			PsychGetAdjustedPrecisionTimerSeconds(&now);
+			if (now > tDeadline) return(FALSE);
+			PsychYieldIntervalSeconds(0.001);
+		}
+
+		if (pool->workers[i].realtime < 0) return(FALSE);
+	}
+
+	return(TRUE);
+}
+
+// Process slaves 'tasks' of master 'dev' in parallel on its mixer thread pool and the calling callback
+// thread, mixing their output into 'mixBuffer'. Only done if the master has a mixer pool and the
+// measured cost of serial processing is high enough to amortize the dispatch overhead. Returns TRUE
+// if the slaves got processed, FALSE if the caller needs to process them serially. Slaves which the
+// mixer threads don't finish in time are left out of the mix and count as underruns of the master:
+static psych_bool PsychPAMixSlavesParallel(PsychPADevice* dev, const float* in, float* mixBuffer, int* tasks, int numTasks, psych_int64 committedFrames,
+										   const PaStreamCallbackTimeInfo* timeInfo, PaStreamCallbackFlags statusFlags)
+{
+	PsychPAMixerPool* pool = dev->mixerPool;
+	PsychPAMixerWorker* w;
+	PsychPAOfflineStream* os;
+	psych_int64 outsamples, insamples, k;
+	double cost, tDeadline, now;
+	psych_bool timedOut;
+	int i, spins;
+
+	if ((NULL == pool) || (numTasks < 2) || (dev->mixerSlaveCost * numTasks < dev->mixerMinCost)) return(FALSE);
+
+	// Mixer threads still busy with slaves of an abandoned job? Then the caller mixes serially, skipping those slaves:
+	if (pool->tasksDone < pool->numTasks) return(FALSE);
+
+	// Scratch buffers of the workers too small for this callback? Then the caller mixes serially, as
+	// we must not allocate memory here:
+	outsamples = dev->batchsize * dev->outchannels;
+	insamples = dev->batchsize * dev->inchannels;
+	if ((pool->outCapacity < outsamples) || (pool->inCapacity < insamples)) return(FALSE);
+
+	// Publish new job. The task counter is reset last, so any worker which
+	// successfully claims a task sees the new job parameters:
+	pool->dev = dev;
+	pool->in = in;
+	for (i = 0; i < numTasks; i++) {
+		pool->tasks[i] = tasks[i];
+		pool->taskDone[i] = 0;
+	}
+	pool->numTasks = numTasks;
+	pool->committedFrames = committedFrames;
+	pool->timeInfo = *timeInfo;
+	pool->statusFlags = statusFlags;
+	pool->tasksDone = 0;
+	pool->job++;
+	PsychPAMemoryBarrier();
+	pool->nextTask = 0;
+	PsychPAMemoryBarrier();
+
+	// Deadline for completion of all slaves: A fraction of the buffer duration, so the callback still
+	// returns in time if a mixer thread got preempted. Offline rendering as fast as possible has no
+	// deadline:
+	PsychGetAdjustedPrecisionTimerSeconds(&tDeadline);
+	tDeadline += PSYCH_AUDIO_MIXER_MAXWAIT * (double) dev->batchsize / (double) dev->streaminfo->sampleRate;
+	os = (dev->hostAPI == kPsychPAOfflineHostAPI) ? (PsychPAOfflineStream*) dev->stream : NULL;
+	if (os && !os->realtime) tDeadline = DBL_MAX;
+
+	// Help processing, mixing directly into the final mix buffer:
+	cost = PsychPAMixerRunTasks(pool, mixBuffer, dev->slaveOutBuffer, dev->slaveGainBuffer, dev->slaveInBuffer, NULL, NULL, NULL);
+
+	// Barrier: Spin until all slaves are processed or the deadline is reached. All slaves are claimed
+	// by now, so any unfinished ones are in progress on mixer threads:
+	timedOut = FALSE;
+	spins = 0;
+	while (pool->tasksDone < numTasks) {
+		PsychPACpuRelax();
+		if (++spins < 100) continue;
+		spins = 0;
+
+		PsychGetAdjustedPrecisionTimerSeconds(&now);
+		if (now > tDeadline) {
+			timedOut = TRUE;
+			break;
+		}
+	}
+	pool->nextTask = PSYCH_AUDIO_MIXER_NOTASKS;
+	PsychPAMemoryBarrier();
+
+	// Abandon unfinished slaves: They are missing from the mix, which counts as underrun:
+	if (timedOut) dev->xruns += (unsigned int) (numTasks - pool->tasksDone);
+
+	// Final mix: Sum up private mix buffers of all workers which processed slaves of this job. After a
+	// timeout, workers which are still busy may have an incomplete mix buffer, so leave them out:
+	for (i = 0; i < pool->numWorkers; i++) {
+		w = &(pool->workers[i]);
+		if (w->mixJob != pool->job) continue;
+		if (timedOut && w->busy) continue;
+
+		for (k = committedFrames * dev->outchannels; k < outsamples; k++) mixBuffer[k] += w->mixBuffer[k];
+		cost += w->cost;
+	}
+
+	// Update running estimate of the processing cost per slave:
+	dev->mixerSlaveCost = 0.9 * dev->mixerSlaveCost + 0.1 * (cost / numTasks);
+
+	return(TRUE);
+}
+
+// Realtime effect chain of a playback device: Cascaded biquad filters, uniformly partitioned FFT convolution
+// and a look-ahead limiter, applied in this order to the output of the device. The main thread never modifies
+// a chain that the audio thread may use. Instead it builds a new chain and publishes it via dev->dspPending.
+// The audio thread picks it up at the start of its next buffer, hands the replaced chain back via dev->dspRetired,
+// and the main thread releases it. Only the main thread allocates, reference counts and frees chains and their parts.
+
+// Impulse responses of all channels for convolution, in the frequency domain:
+typedef struct PsychPADspIR {
+	int			refCount;		// Number of chains using this IR.
+	int			partitionSize;	// Partition size B in sample frames. FFT size is 2 * B.
+	int			numPartitions;	// Number of partitions of the IR.
+	psych_int64	channels;		// Number of channels.
+	float*		spectra;		// channels * numPartitions spectra of B + 1 complex bins, scaled by 1 / (2 * B).
+} PsychPADspIR;
+
+// Runtime state of a chain, shared by successive chains with compatible settings, so their filter
+// states, convolution history and limiter gain carry over without any copying by the audio thread:
+typedef struct PsychPADspState {
+	int			refCount;		// Number of chains using this state.
+	psych_int64	channels;		// Number of channels.
+	double*		biquadState;	// PSYCH_AUDIO_DSP_MAX_BIQUADS * channels * 2 filter states.
+
+	// Convolution, if partitionSize > 0:
+	int			partitionSize;	// Partition size B.
+	int			maxPartitions;	// Capacity of the frequency domain delay line in partitions.
+	int			fdlPos;			// Slot of the newest input spectrum in the delay line.
+	int			blockPos;		// Number of frames in the current input block.
+	float*		fdl;			// Frequency domain delay line: channels * maxPartitions spectra of B + 1 complex bins.
+	float*		timeIn;			// channels * 2 * B frames: Previous and current input block.
+	float*		timeOut;		// channels * B frames: Current output block.
+	float*		fftBuffer;		// 2 * B complex values of FFT work space.
+	float*		accum;			// Two accumulators for output spectra, B + 1 complex bins each.
+	float*		twiddle;		// B complex twiddle factors.
+	int*		bitrev;			// 2 * B bit reversal permutation.
+
+	// Limiter, if lookahead > 0:
+	int			lookahead;		// Look-ahead in frames.
+	float*		delay;			// (lookahead - 1) * channels frames of delay line.
+	int			delayPos;
+	float*		dqVal;			// Monotonic queue for sliding window minimum of required gain: Values...
+	psych_int64* dqIdx;			// ...and frame indices.
+	int			dqHead, dqCount;
+	float*		box;			// Window of held minimum gains for box filter smoothing.
+	int			boxPos;
+	double		boxSum;
+	float		gain;			// Current gain.
+	psych_int64	frameCount;		// Frame counter.
+} PsychPADspState;
+
+// Effect chain:
+typedef struct PsychPADspChain {
+	// Settings, immutable once published:
+	int			numBiquads;										// Number of biquad sections, all further sections are identity.
+	double		biquads[PSYCH_AUDIO_DSP_MAX_BIQUADS][5];		// Coefficients b0, b1, b2, a1, a2 per section.
+	PsychPADspIR* ir;											// Impulse responses for convolution, NULL = No convolution.
+	float		limitThreshold;									// Limiter threshold, 0 = No limiter.
+	double		limitLookaheadSecs;								// Limiter look-ahead in seconds...
+	int			limitLookahead;									// ...and in frames.
+	double		limitReleaseSecs;								// Limiter release time in seconds...
+	float		limitRelease;									// ...and as per frame smoothing coefficient.
+	PsychPADspState* state;										// Runtime state.
+
+	// Only touched by the audio thread once published:
+	double		rampFrom[PSYCH_AUDIO_DSP_MAX_BIQUADS][5];		// Coefficients at start of coefficient ramp.
+	int			rampSections;									// Number of sections to process during ramp.
+	int			rampPos;										// Frames into coefficient ramp, PSYCH_AUDIO_DSP_RAMP_FRAMES = Done.
+	struct PsychPADspChain* fadeFrom;							// Replaced chain whose IR output gets crossfaded out, if any.
+} PsychPADspChain;
+
+// Setup twiddle factors and bit reversal permutation for a complex FFT of size 'n', a power of two:
+static void PsychPADspInitFFT(int n, float* twiddle, int* bitrev)
+{
+	int i, j, bits;
+
+	for (bits = 0; (1 << bits) < n; bits++);
+
+	for (i = 0; i < n; i++) {
+		for (j = 0, bitrev[i] = 0; j < bits; j++) if (i & (1 << j)) bitrev[i] |= 1 << (bits - 1 - j);
+	}
+
+	for (i = 0; i < n / 2; i++) {
+		twiddle[2 * i] = (float) cos(2.0 * M_PI * i / n);
+		twiddle[2 * i + 1] = (float) -sin(2.0 * M_PI * i / n);
+	}
+}
+
+// In-place radix-2 complex FFT of size 'n' of interleaved real/imaginary 'data'. Inverse if 'inverse', unscaled:
+static void PsychPADspFFT(float* data, int n, const float* twiddle, const int* bitrev, psych_bool inverse)
+{
+	int i, j, k, len, half, step;
+	float wr, wi, tr, ti;
+	float* a;
+	float* b;
+
+	for (i = 0; i < n; i++) {
+		j = bitrev[i];
+		if (j > i) {
+			tr = data[2 * i]; data[2 * i] = data[2 * j]; data[2 * j] = tr;
+			ti = data[2 * i + 1]; data[2 * i + 1] = data[2 * j + 1]; data[2 * j + 1] = ti;
+		}
+	}
+
+	for (len = 2; len <= n; len <<= 1) {
+		half = len / 2;
+		step = n / len;
+		for (i = 0; i < n; i += len) {
+			a = &data[2 * i];
+			b = &data[2 * (i + half)];
+			for (k = 0; k < half; k++) {
+				wr = twiddle[2 * k * step];
+				wi = (inverse) ? -twiddle[2 * k * step + 1] : twiddle[2 * k * step + 1];
+				tr = wr * b[2 * k] - wi * b[2 * k + 1];
+				ti = wr * b[2 * k + 1] + wi * b[2 * k];
+				b[2 * k] = a[2 * k] - tr;
+				b[2 * k + 1] = a[2 * k + 1] - ti;
+				a[2 * k] += tr;
+				a[2 * k + 1] += ti;
+			}
+		}
+	}
+}
+
+// acc += x * h for 'bins' complex values:
+static void PsychPADspMultiplyAccumulate(float* acc, const float* x, const float* h, int bins)
+{
+	int k;
+
+	for (k = 0; k < bins; k++) {
+		acc[2 * k] += x[2 * k] * h[2 * k] - x[2 * k + 1] * h[2 * k + 1];
+		acc[2 * k + 1] += x[2 * k] * h[2 * k + 1] + x[2 * k + 1] * h[2 * k];
+	}
+}
+
+// Reset runtime state 's' to silence:
+static void PsychPADspResetState(PsychPADspState* s)
+{
+	int i;
+
+	memset(s->biquadState, 0, sizeof(double) * PSYCH_AUDIO_DSP_MAX_BIQUADS * s->channels * 2);
+
+	if (s->partitionSize > 0) {
+		s->fdlPos = 0;
+		s->blockPos = 0;
+		memset(s->fdl, 0, sizeof(float) * 2 * (s->partitionSize + 1) * s->maxPartitions * s->channels);
+		memset(s->timeIn, 0, sizeof(float) * 2 * s->partitionSize * s->channels);
+		memset(s->timeOut, 0, sizeof(float) * s->partitionSize * s->channels);
+	}
+
+	if (s->lookahead > 0) {
+		if (s->lookahead > 1) memset(s->delay, 0, sizeof(float) * (s->lookahead - 1) * s->channels);
+		for (i = 0; i < s->lookahead; i++) s->box[i] = 1;
+		s->boxSum = s->lookahead;
+		s->delayPos = s->boxPos = s->dqHead = s->dqCount = 0;
+	}
+
+	s->gain = 1;
+	s->frameCount = 0;
+}
+
+// Release one reference to state 's':
+static void PsychPADspReleaseState(PsychPADspState* s)
+{
+	if ((NULL == s) || (--(s->refCount) > 0)) return;
+	free(s->biquadState);
+	free(s->fdl);
+	free(s->timeIn);
+	free(s->timeOut);
+	free(s->fftBuffer);
+	free(s->accum);
+	free(s->twiddle);
+	free(s->bitrev);
+	free(s->delay);
+	free(s->dqVal);
+	free(s->dqIdx);
+	free(s->box);
+	free(s);
+}
+
+// Create runtime state for 'channels' channels, convolution with 'partitionSize' and up to 'maxPartitions'
+// partitions, and limiter 'lookahead'. Zero partitionSize or lookahead means no convolution or limiter.
+// Returns NULL on out of memory:
+static PsychPADspState* PsychPADspCreateState(psych_int64 channels, int partitionSize, int maxPartitions, int lookahead)
+{
+	PsychPADspState* s;
+	psych_bool ok;
+
+	if (NULL == (s = (PsychPADspState*) calloc(1, sizeof(PsychPADspState)))) return(NULL);
+	s->refCount = 1;
+	s->channels = channels;
+	s->partitionSize = partitionSize;
+	s->maxPartitions = maxPartitions;
+	s->lookahead = lookahead;
+
+	ok = (NULL != (s->biquadState = (double*) malloc(sizeof(double) * PSYCH_AUDIO_DSP_MAX_BIQUADS * channels * 2)));
+
+	if (ok && (partitionSize > 0)) {
+		ok = (NULL != (s->fdl = (float*) malloc(sizeof(float) * 2 * (partitionSize + 1) * maxPartitions * channels))) &&
+			 (NULL != (s->timeIn = (float*) malloc(sizeof(float) * 2 * partitionSize * channels))) &&
+			 (NULL != (s->timeOut = (float*) malloc(sizeof(float) * partitionSize * channels))) &&
+			 (NULL != (s->fftBuffer = (float*) malloc(sizeof(float) * 4 * partitionSize))) &&
+			 (NULL != (s->accum = (float*) malloc(sizeof(float) * 4 * (partitionSize + 1)))) &&
+			 (NULL != (s->twiddle = (float*) malloc(sizeof(float) * 2 * partitionSize))) &&
+			 (NULL != (s->bitrev = (int*) malloc(sizeof(int) * 2 * partitionSize)));
+		if (ok) PsychPADspInitFFT(2 * partitionSize, s->twiddle, s->bitrev);
+	}
+
+	if (ok && (lookahead > 0)) {
+		ok = ((lookahead == 1) || (NULL != (s->delay = (float*) malloc(sizeof(float) * (lookahead - 1) * channels)))) &&
+			 (NULL != (s->dqVal = (float*) malloc(sizeof(float) * lookahead))) &&
+			 (NULL != (s->dqIdx = (psych_int64*) malloc(sizeof(psych_int64) * lookahead))) &&
+			 (NULL != (s->box = (float*) malloc(sizeof(float) * lookahead)));
+	}
+
+	if (!ok) {
+		PsychPADspReleaseState(s);
+		return(NULL);
+	}
+
+	PsychPADspResetState(s);
+
+	return(s);
+}
+
+// Release one reference to impulse response 'ir':
+static void PsychPADspReleaseIR(PsychPADspIR* ir)
+{
+	if ((NULL == ir) || (--(ir->refCount) > 0)) return;
+	free(ir->spectra);
+	free(ir);
+}
+
+// Create frequency domain representation of the impulse responses in 'data', a matrix with one row per
+// channel and 'taps' columns, for convolution with partition size 'partitionSize'. A 'data' matrix with
+// only one row applies to all 'channels'. Returns NULL on out of memory:
+static PsychPADspIR* PsychPADspCreateIR(const double* data, psych_int64 rows, psych_int64 taps, psych_int64 channels, int partitionSize)
+{
+	PsychPADspIR* ir;
+	float *twiddle, *fft, *spectrum;
+	int* bitrev;
+	int n = 2 * partitionSize;
+	int p, k;
+	psych_int64 c, t;
+
+	if (NULL == (ir = (PsychPADspIR*) calloc(1, sizeof(PsychPADspIR)))) return(NULL);
+	ir->refCount = 1;
+	ir->partitionSize = partitionSize;
+	ir->numPartitions = (int) ((taps + partitionSize - 1) / partitionSize);
+	ir->channels = channels;
+
+	ir->spectra = (float*) malloc(sizeof(float) * 2 * (partitionSize + 1) * ir->numPartitions * channels);
+	twiddle = (float*) malloc(sizeof(float) * n);
+	bitrev = (int*) malloc(sizeof(int) * n);
+	fft = (float*) malloc(sizeof(float) * 2 * n);
+	if (!ir->spectra || !twiddle || !bitrev || !fft) {
+		free(twiddle); free(bitrev); free(fft);
+		PsychPADspReleaseIR(ir);
+		return(NULL);
+	}
+
+	PsychPADspInitFFT(n, twiddle, bitrev);
+
+	// Spectrum of each partition, zero-padded to twice its size for overlap-save convolution. The 1 / n
+	// normalization of the inverse FFT is folded into the spectra:
+	for (c = 0; c < channels; c++) {
+		for (p = 0; p < ir->numPartitions; p++) {
+			memset(fft, 0, sizeof(float) * 2 * n);
+			for (k = 0; k < partitionSize; k++) {
+				t = (psych_int64) p * partitionSize + k;
+				if (t < taps) fft[2 * k] = (float) (data[t * rows + ((rows > 1) ? c : 0)] / n);
+			}
+
+			PsychPADspFFT(fft, n, twiddle, bitrev, FALSE);
+
+			spectrum = &(ir->spectra[2 * (partitionSize + 1) * (c * ir->numPartitions + p)]);
+			memcpy(spectrum, fft, sizeof(float) * 2 * (partitionSize + 1));
+		}
+	}
+
+	free(twiddle);
+	free(bitrev);
+	free(fft);
+
+	return(ir);
+}
+
+// Release effect chain 'chain', but not a chain it fades from:
+static void PsychPADspFreeChain(PsychPADspChain* chain)
+{
+	if (NULL == chain) return;
+	PsychPADspReleaseIR(chain->ir);
+	PsychPADspReleaseState(chain->state);
+	free(chain);
+}
+
+// Create a new effect chain for device 'dev' with the same settings as the chain last published for it,
+// sharing its IR and runtime state, or without any effects if there isn't one:
+static PsychPADspChain* PsychPADspCloneChain(PsychPADevice* dev)
+{
+	PsychPADspChain* chain;
+	int s;
+
+	chain = (PsychPADspChain*) calloc(1, sizeof(PsychPADspChain));
+	if (NULL == chain) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for creating effect chain!");
+
+	if (dev->dspLast) {
+		memcpy(chain, dev->dspLast, sizeof(PsychPADspChain));
+		if (chain->ir) chain->ir->refCount++;
+		if (chain->state) chain->state->refCount++;
+	}
+	else {
+		for (s = 0; s < PSYCH_AUDIO_DSP_MAX_BIQUADS; s++) chain->biquads[s][0] = 1.0;
+		chain->limitLookaheadSecs = 0.002;
+		chain->limitReleaseSecs = 0.05;
+	}
+
+	chain->rampPos = PSYCH_AUDIO_DSP_RAMP_FRAMES;
+	chain->fadeFrom = NULL;
+
+	return(chain);
+}
+
+// Release chain the audio thread handed back for device 'dev', if any:
+static void PsychPADspCollect(PsychPADevice* dev)
+{
+	PsychPADspFreeChain((PsychPADspChain*) PsychPAAtomicExchangePointer(&(dev->dspRetired), NULL));
+}
+
+// Make sure 'chain' for device 'dev' has runtime state compatible with its settings, keeping the shared state
+// if possible. 'maxPartitions' is the minimum convolution capacity for a new state. Then publish it to the audio thread:
+static void PsychPADspPublish(PsychPADevice* dev, PsychPADspChain* chain, int maxPartitions)
+{
+	PsychPADspState* s = chain->state;
+	int partitionSize = (chain->ir) ? chain->ir->partitionSize : 0;
+	int lookahead = (chain->limitThreshold > 0) ? chain->limitLookahead : 0;
+
+	if (chain->ir && (maxPartitions < chain->ir->numPartitions)) maxPartitions = chain->ir->numPartitions;
+
+	if (!s || (partitionSize && ((s->partitionSize != partitionSize) || (s->maxPartitions < chain->ir->numPartitions))) ||
+		(lookahead && (s->lookahead != lookahead))) {
+		// Need new state. Keep the existing parts which are compatible:
+		if (s && !partitionSize) { partitionSize = s->partitionSize; maxPartitions = s->maxPartitions; }
+		if (s && !lookahead) lookahead = s->lookahead;
+
+		chain->state = PsychPADspCreateState(dev->outchannels, partitionSize, maxPartitions, lookahead);
+		PsychPADspReleaseState(s);
+		if (NULL == chain->state) {
+			PsychPADspFreeChain(chain);
+			PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for creating effect chain!");
+		}
+	}
+
+	// Release chain retired by the audio thread, then publish. A previously published chain which the
+	// audio thread hasn't picked up yet gets replaced and released:
+	PsychPADspCollect(dev);
+	PsychPADspFreeChain((PsychPADspChain*) PsychPAAtomicExchangePointer(&(dev->dspPending), chain));
+	dev->dspLast = chain;
+}
+
+// Release all effect chains of device 'dev'. Must only be called while its audio processing is stopped:
+static void PsychPADspDestroy(PsychPADevice* dev)
+{
+	PsychPADspCollect(dev);
+	PsychPADspFreeChain(dev->dspPending);
+	if (dev->dspActive) PsychPADspFreeChain(dev->dspActive->fadeFrom);
+	PsychPADspFreeChain(dev->dspActive);
+	dev->dspPending = dev->dspActive = dev->dspLast = NULL;
+}
+
+// Current, possibly interpolated biquad coefficients of 'chain' into 'coeffs':
+static void PsychPADspCurrentBiquads(PsychPADspChain* chain, double coeffs[PSYCH_AUDIO_DSP_MAX_BIQUADS][5])
+{
+	double w = (double) chain->rampPos / PSYCH_AUDIO_DSP_RAMP_FRAMES;
+	int s, k;
+
+	for (s = 0; s < PSYCH_AUDIO_DSP_MAX_BIQUADS; s++) {
+		for (k = 0; k < 5; k++) coeffs[s][k] = chain->rampFrom[s][k] + w * (chain->biquads[s][k] - chain->rampFrom[s][k]);
+	}
+
+	if (chain->rampPos >= PSYCH_AUDIO_DSP_RAMP_FRAMES) memcpy(coeffs, chain->biquads, sizeof(chain->biquads));
+}
+
+// Apply biquad section with coefficients 'b' to 'frames' frames of channel 'channel' of interleaved 'buffer',
+// in transposed direct form II with filter state 'z':
+static void PsychPADspBiquad(float* buffer, psych_int64 frames, psych_int64 channels, psych_int64 channel, const double* b, double* z)
+{
+	double x, y, z1 = z[0], z2 = z[1];
+	psych_int64 t;
+
+	for (t = channel; t < frames * channels; t += channels) {
+		x = buffer[t];
+		y = b[0] * x + z1;
+		z1 = b[1] * x - b[3] * y + z2;
+		z2 = b[2] * x - b[4] * y;
+		buffer[t] = (float) y;
+	}
+
+	// Flush denormals in decaying filter states:
+	z[0] = (fabs(z1) < 1e-30) ? 0 : z1;
+	z[1] = (fabs(z2) < 1e-30) ? 0 : z2;
+}
+
+// Compute next output block of the convolution of 'chain' from the current input block:
+static void PsychPADspConvolveBlock(PsychPADspChain* chain)
+{
+	PsychPADspState* s = chain->state;
+	PsychPADspIR* ir = chain->ir;
+	PsychPADspIR* fadeIR = (chain->fadeFrom) ? chain->fadeFrom->ir : NULL;
+	int B = s->partitionSize, n = 2 * B, bins = B + 1;
+	float *timeIn, *timeOut, *acc, *x;
+	float w;
+	int k, p, slot, f;
+	psych_int64 c;
+
+	s->fdlPos = (s->fdlPos + 1) % s->maxPartitions;
+
+	for (c = 0; c < s->channels; c++) {
+		timeIn = &(s->timeIn[c * n]);
+		timeOut = &(s->timeOut[c * B]);
+
+		// Spectrum of previous and current input block into newest slot of delay line:
+		for (k = 0; k < n; k++) {
+			s->fftBuffer[2 * k] = timeIn[k];
+			s->fftBuffer[2 * k + 1] = 0;
+		}
+		PsychPADspFFT(s->fftBuffer, n, s->twiddle, s->bitrev, FALSE);
+		memcpy(&(s->fdl[2 * bins * (c * s->maxPartitions + s->fdlPos)]), s->fftBuffer, sizeof(float) * 2 * bins);
+
+		// Current block becomes previous block:
+		memcpy(timeIn, &(timeIn[B]), sizeof(float) * B);
+
+		// Output spectrum is the sum of the products of the IR partitions with the input spectra delayed by
+		// the partitions index. A second output with the IR of the replaced chain gets crossfaded out:
+		for (f = 0; f < ((fadeIR) ? 2 : 1); f++) {
+			acc = &(s->accum[2 * bins * f]);
+			memset(acc, 0, sizeof(float) * 2 * bins);
+			for (p = 0; p < ((f) ? fadeIR : ir)->numPartitions; p++) {
+				slot = (s->fdlPos - p + s->maxPartitions) % s->maxPartitions;
+				x = &(s->fdl[2 * bins * (c * s->maxPartitions + slot)]);
+				PsychPADspMultiplyAccumulate(acc, x, &(((f) ? fadeIR : ir)->spectra[2 * bins * (c * ((f) ? fadeIR : ir)->numPartitions + p)]), bins);
+			}
 
-	// Unlock device struct:
-	PsychPAUnlockDeviceMutex(dev);
+			// Inverse FFT of the hermitian symmetric spectrum of the real output:
+			memcpy(s->fftBuffer, acc, sizeof(float) * 2 * bins);
+			for (k = bins; k < n; k++) {
+				s->fftBuffer[2 * k] = acc[2 * (n - k)];
+				s->fftBuffer[2 * k + 1] = -acc[2 * (n - k) + 1];
+			}
+			PsychPADspFFT(s->fftBuffer, n, s->twiddle, s->bitrev, TRUE);
 
-	// Ready.
-	return;
+			// Second half is the valid part of the circular convolution:
+			for (k = 0; k < B; k++) {
+				if (f == 0) {
+					timeOut[k] = s->fftBuffer[2 * (B + k)];
+				}
+				else {
+					w = (float) (k + 1) / B;
+					timeOut[k] = w * timeOut[k] + (1 - w) * s->fftBuffer[2 * (B + k)];
+				}
+			}
+		}
+	}
 }
 
-/* Logger callback function to output PortAudio debug messages at 'verbosity' > 5. */
-void PALogger(const char* msg)
+// Apply effect chain of device 'dev' to 'frames' interleaved frames in 'buffer'. Called by the audio thread:
+static void PsychPADspProcess(PsychPADevice* dev, float* buffer, psych_int64 frames)
 {
-	if (verbosity > 5) printf("PTB-DEBUG: PortAudio says: %s", msg);
-	return;
-}
+	PsychPADspChain* chain;
+	PsychPADspChain* old;
+	PsychPADspState* s;
+	psych_int64 channels = dev->outchannels;
+	psych_int64 t, c, n, l;
+	double coeffs[5];
+	double w, *z;
+	float peak, g, held, target;
+	float* frame;
+	int i, k, nsec, B, L;
+
+	// Pick up new chain published by the main thread, unless the main thread didn't release the chain
+	// we handed back last time yet, or the current chain is still crossfading from its predecessor:
+	if (dev->dspPending && (NULL == dev->dspRetired) && !(dev->dspActive && dev->dspActive->fadeFrom)) {
+		chain = (PsychPADspChain*) PsychPAAtomicExchangePointer(&(dev->dspPending), NULL);
+		old = dev->dspActive;
+		if (old) {
+			// Ramp biquad coefficients from their current values to the new ones:
+			PsychPADspCurrentBiquads(old, chain->rampFrom);
+			chain->rampSections = (old->rampPos < PSYCH_AUDIO_DSP_RAMP_FRAMES && old->rampSections > old->numBiquads) ? old->rampSections : old->numBiquads;
+			if (chain->numBiquads > chain->rampSections) chain->rampSections = chain->numBiquads;
+			chain->rampPos = 0;
+
+			// New state? Carry over filter states and limiter gain at least:
+			if (old->state != chain->state) {
+				memcpy(chain->state->biquadState, old->state->biquadState, sizeof(double) * PSYCH_AUDIO_DSP_MAX_BIQUADS * channels * 2);
+				chain->state->gain = old->state->gain;
+			}
 
+			// Crossfade from old to new IR if both operate on the same convolution state, otherwise switch hard:
+			if (old->ir && chain->ir && (old->ir != chain->ir) && (old->state == chain->state)) {
+				chain->fadeFrom = old;
+			}
+			else {
+				PsychPAAtomicExchangePointer(&(dev->dspRetired), old);
+			}
+		}
+		dev->dspActive = chain;
+	}
 
-// Called exclusively from paCallback, with device-mutex held.
-// Check if a schedule is defined. If not, return repetition, playloop and bufferparameters
-// from the device struct, ie., old behaviour. If yes, check if an update of the schedule is
-// needed (ie., progressing to the next slot) and do so if needed. Return parameters from
-// current slot, or an abort signal if end of schedule reached.
-//
-// Return codes:
-// 0 = Valid buffer and playback parameters assigned. Proceed with audio playback as scheduled.
-// 1 = Regular end of playback or schedule reached. Finish playback.
-// 2 = Error abort, something is totally frelled.
-// 4 = Abort bufferfill operation for this host audio buffer via zerofill, but don't switch to idle mode / don't stop engine.
-//     Instead switch back to hot-standby so playback can be picked up again at a later point in time.
-//	   This is used to reschedule start of playback for a following slot at a later time.
-int PsychPAProcessSchedule(PsychPADevice* dev, psych_int64 *playposition, float** ret_playoutbuffer, psych_int64* ret_outsbsize, psych_int64* ret_outsboffset, double* ret_repeatCount, psych_int64* ret_playpositionlimit)
-{
-	psych_int64   loopStartFrame, loopEndFrame;
-	psych_int64  outsbsize, outsboffset;
-	psych_int64  outchannels = dev->outchannels;
-	unsigned int  slotid, cmd;
-	double		  repeatCount;
-	double		  reqTime;
-	psych_int64  playpositionlimit;
-	
-	// NULL-Schedule?
-	if (dev->schedule == NULL) {
-		// Yes: Assign settings from dev-struct:
-		*ret_playoutbuffer = dev->outputbuffer;
-		outsbsize = dev->outputbuffersize / sizeof(float);
+	if (NULL == (chain = dev->dspActive)) return;
+	s = chain->state;
 
-		// Fetch boundaries of playback loop:
-		loopStartFrame = dev->loopStartFrame;
-		loopEndFrame = dev->loopEndFrame;
-		repeatCount = dev->repeatCount;
+	// Cascaded biquads, with linear interpolation of the coefficients during the first PSYCH_AUDIO_DSP_RAMP_FRAMES
+	// frames after a change, then at full speed with the final coefficients:
+	nsec = (chain->rampPos < PSYCH_AUDIO_DSP_RAMP_FRAMES) ? chain->rampSections : chain->numBiquads;
+	n = (chain->rampPos < PSYCH_AUDIO_DSP_RAMP_FRAMES) ? PSYCH_AUDIO_DSP_RAMP_FRAMES - chain->rampPos : 0;
+	if (n > frames) n = frames;
 
-		// Revalidate boundaries of playback loop:
-		if (loopStartFrame * outchannels >= outsbsize) loopStartFrame = (outsbsize / outchannels) - 1;
-		if (loopStartFrame < 0) loopStartFrame = 0;
-		if (loopEndFrame * outchannels >= outsbsize) loopEndFrame = (outsbsize / outchannels) - 1;
-		if (loopEndFrame < 0) loopEndFrame = 0;
-		if (loopEndFrame < loopStartFrame) loopEndFrame = loopStartFrame;
-		
-		// Remap defined playback loop to "corrected" outsbsize and offset for later copy-op:
-		outsbsize   = (loopEndFrame - loopStartFrame + 1) * outchannels;
-		outsboffset = loopStartFrame * outchannels;
-		
-		// Compute playpositionlimit, the upper limit of played out samples from loop duration and repeatCount...
-		playpositionlimit = ((psych_int64) (repeatCount * outsbsize));
-		// ...and make sure it ends on integral sample frame boundaries:
-		playpositionlimit -= playpositionlimit % outchannels;
+	for (i = 0; i < nsec; i++) {
+		for (c = 0; c < channels; c++) {
+			z = &(s->biquadState[(i * channels + c) * 2]);
+			for (t = 0; t < n; t++) {
+				w = (double) (chain->rampPos + t + 1) / PSYCH_AUDIO_DSP_RAMP_FRAMES;
+				for (k = 0; k < 5; k++) coeffs[k] = chain->rampFrom[i][k] + w * (chain->biquads[i][k] - chain->rampFrom[i][k]);
+				PsychPADspBiquad(&(buffer[t * channels]), 1, channels, c, coeffs, z);
+			}
 
-		// Check if loop and repetition constraints are still valid:
-		if ( !((repeatCount == -1) || (*playposition < playpositionlimit)) || (NULL == *ret_playoutbuffer)) {
-			// No. Signal regular end of playback:
-			return(1);
+			PsychPADspBiquad(&(buffer[n * channels]), frames - n, channels, c, chain->biquads[i], z);
 		}
 	}
-	else {
-		// No: Real schedule:
-		
-		do {
-			// Find current slot (with wraparound):
-			slotid = dev->schedule_pos % dev->schedule_size;
-			
-			// Current slot valid and pending?
-			if ((dev->schedule[slotid].mode & 2) == 0) {
-				// No: End of schedule reached - Signal regular abort request and that's it:
-				return(1);
-			}
-			
-			// Current slot is valid: Assign it:
-			cmd = dev->schedule[slotid].command;
-			if (cmd > 0) {
-				// Special command buffer: Doesn't contain sound, but some special
-				// control commands. Process it, then advance to next slot...
-				
-				// This makes sure we repeat the loop, advancing to the next slot:
-				*ret_playoutbuffer = NULL;
-				outsbsize = 0;
 
-				// Compute absolute deadline from given tWhen timespec and type of timespec:
-				if (cmd & 4)  reqTime = dev->schedule[slotid].tWhen;						// Absolute system time specified.
-                // Relative to last requested start time. We use last true start time as fallback if the requested start time is undefined:
-				if (cmd & 8)  reqTime = ((dev->reqStartTime > 0.0) ? dev->reqStartTime : dev->startTime) + dev->schedule[slotid].tWhen;
-				if (cmd & 16) reqTime = dev->startTime + dev->schedule[slotid].tWhen;		// Relative to last true start time.
-				// TODO: The following two "end time" related ones are pretty broken - Can't
-				// work the way i want it to work, as relevant information is not available at
-				// the time we'd need it, ie., at this point in execution flow...
-				// Need to think about this, or scrap the idea of end-time related timeoffsets...
-				if (cmd & 32) reqTime = dev->reqStopTime + dev->schedule[slotid].tWhen;		// Relative to last requested end time.
-				if (cmd & 64) reqTime = dev->estStopTime + dev->schedule[slotid].tWhen;		// Relative to last true end time.
-				
-				// Pause-playback-and-restart command?
-				if (cmd & 1) {
-					// Yes. We should abort playback at this point, ie. fill the remainder
-					// of the audiobuffer with silence. Then we shall switch back to hot-standby
-					// and reschedule ourselves for restart of playback at a given target reqTime:
-					dev->reqStartTime = reqTime;
+	chain->rampPos += (int) n;
 
-					// Manually invalidate this slot and advance schedule to next one:
-					*playposition = 0;
-					// Only disable if the flag 4 aka "don't auto-disable" isn't set:
-					if (!(dev->schedule[slotid].mode & 4)) dev->schedule[slotid].mode &= ~2;
-					dev->schedule_pos++;
+	// Convolution, in blocks of partitionSize frames, with a latency of one block:
+	if (chain->ir) {
+		B = s->partitionSize;
+		for (t = 0; t < frames; t += n) {
+			n = B - s->blockPos;
+			if (n > frames - t) n = frames - t;
 
-					// Return with special code 4 to reschedule:
-					return(4);
+			for (c = 0; c < channels; c++) {
+				for (l = 0; l < n; l++) {
+					s->timeIn[c * 2 * B + B + s->blockPos + l] = buffer[(t + l) * channels + c];
+					buffer[(t + l) * channels + c] = s->timeOut[c * B + s->blockPos + l];
 				}
+			}
 
-				// Reschedule end-of-playback command?
-				if (cmd & 2) {
-					// Yes. We should end playback at given target reqTime, then go idle:
-					dev->reqStopTime = reqTime;
+			s->blockPos += (int) n;
+			if (s->blockPos == B) {
+				PsychPADspConvolveBlock(chain);
+				s->blockPos = 0;
 
-					// Nothing further to do here. Will auto-advance to next schedule slot after
-					// this one, possibly outputting further sound...
+				// Crossfade done: Hand back the replaced chain:
+				if (chain->fadeFrom) {
+					PsychPAAtomicExchangePointer(&(dev->dspRetired), chain->fadeFrom);
+					chain->fadeFrom = NULL;
 				}
-				
-				// End of command buffer processing.
-			} // Regular audio buffer: First assign outbuffer size and pointer...
-			else if (dev->schedule[slotid].bufferhandle <= 0) {
-				// Default device playoutbuffer:
-				*ret_playoutbuffer = dev->outputbuffer;
-				outsbsize = dev->outputbuffersize / sizeof(float);
 			}
-			else
-			{
-				// Dynamic buffer: Dereference bufferhandle and fetch buffer data for later use:
-				
-				// Need to lock bufferList lock to do this:
-				PsychLockMutex(&bufferListmutex);
+		}
+	}
 
-				if (bufferList && (dev->schedule[slotid].bufferhandle < bufferListCount)) {
-					// Fetch pointer to actual audio data buffer:
-					*ret_playoutbuffer = bufferList[dev->schedule[slotid].bufferhandle].outputbuffer;
-					
-					// Retrieve buffersize in samples:
-					outsbsize = bufferList[dev->schedule[slotid].bufferhandle].outputbuffersize / sizeof(float);
-					
-					// Another child protection:
-					if (outchannels != bufferList[dev->schedule[slotid].bufferhandle].outchannels) {
-						*ret_playoutbuffer = NULL;
-						outsbsize = 0;
-					}
-				}
-				else {
-					*ret_playoutbuffer = NULL;
-					outsbsize = 0;
+	// Look-ahead limiter: The gain required to keep each frame below the threshold is held at its minimum
+	// over 'L' frames, then smoothed by a box filter of 'L' frames, and applied to the input delayed by
+	// L - 1 frames, so the gain has fully ramped down when the peak is output. Gain recovers with the
+	// release time constant:
+	if (chain->limitThreshold > 0) {
+		L = s->lookahead;
+		for (t = 0; t < frames; t++) {
+			frame = &(buffer[t * channels]);
+			for (c = 0, peak = 0; c < channels; c++) if (fabsf(frame[c]) > peak) peak = fabsf(frame[c]);
+			g = (peak > chain->limitThreshold) ? chain->limitThreshold / peak : 1.0f;
+
+			// Sliding window minimum:
+			if ((s->dqCount > 0) && (s->dqIdx[s->dqHead] <= s->frameCount - L)) {
+				s->dqHead = (s->dqHead + 1) % L;
+				s->dqCount--;
+			}
+
+			while ((s->dqCount > 0) && (s->dqVal[(s->dqHead + s->dqCount - 1) % L] >= g)) s->dqCount--;
+			s->dqVal[(s->dqHead + s->dqCount) % L] = g;
+			s->dqIdx[(s->dqHead + s->dqCount) % L] = s->frameCount;
+			s->dqCount++;
+			held = s->dqVal[s->dqHead];
+
+			// Box filter, with exact recomputation of its sum once per window to avoid drift:
+			s->boxSum += held - s->box[s->boxPos];
+			s->box[s->boxPos] = held;
+			if (++(s->boxPos) == L) {
+				s->boxPos = 0;
+				for (k = 0, s->boxSum = 0; k < L; k++) s->boxSum += s->box[k];
+			}
+			target = (float) (s->boxSum / L);
+
+			s->gain = (target < s->gain) ? target : target + (s->gain - target) * chain->limitRelease;
+			s->frameCount++;
+
+			// Delay and apply gain:
+			for (c = 0; c < channels; c++) {
+				if (L > 1) {
+					g = s->delay[s->delayPos * channels + c];
+					s->delay[s->delayPos * channels + c] = frame[c];
+					frame[c] = g * s->gain;
 				}
-				
-				// Unlock bufferList mutex again:
-				PsychUnlockMutex(&bufferListmutex);
+				else frame[c] *= s->gain;
 			}
+			if ((L > 1) && (++(s->delayPos) == L - 1)) s->delayPos = 0;
+		}
+	}
+}
 
-			// ... then loop and repeat parameters:
-			loopStartFrame = dev->schedule[slotid].loopStartFrame;
-			loopEndFrame   = dev->schedule[slotid].loopEndFrame;
-			repeatCount    = dev->schedule[slotid].repetitions;
-			
-			// Revalidate boundaries of playback loop:
-			if (loopStartFrame * outchannels >= outsbsize) loopStartFrame = (outsbsize / outchannels) - 1;
-			if (loopStartFrame < 0) loopStartFrame = 0;
-			if (loopEndFrame * outchannels >= outsbsize) loopEndFrame = (outsbsize / outchannels) - 1;
-			if (loopEndFrame < 0) loopEndFrame = 0;
-			if (loopEndFrame < loopStartFrame) loopEndFrame = loopStartFrame;
-			
-			// Remap defined playback loop to "corrected" outsbsize and offset for later copy-op:
-			outsbsize = (psych_int64) ((loopEndFrame - loopStartFrame + 1) * outchannels);
-			outsboffset = (psych_int64) (loopStartFrame * outchannels);
-			
-			// Compute playpositionlimit, the upper limit of played out samples from loop duration and repeatCount...
-			playpositionlimit = ((psych_int64) (repeatCount * outsbsize));
-			// ...and make sure it ends on integral sample frame boundaries:
-			playpositionlimit -= playpositionlimit % outchannels;
-			
-			// Check if loop and repetition constraints as well as actual audio buffer for this slot are still valid:
-			if ( !((repeatCount == -1) || (*playposition < playpositionlimit)) || (NULL == *ret_playoutbuffer) ) {
-				// Constraints violated. This slot is used up: Reset playposition and advance to next slot:
-				*playposition = 0;
-				// Only disable if the flag 4 aka "don't auto-disable" isn't set:
-				if (!(dev->schedule[slotid].mode & 4)) dev->schedule[slotid].mode &= ~2;
-				dev->schedule_pos++;
+// Capture event detector of a capture device: Detects sound onsets and offsets in the captured sound,
+// e.g., for voice keys, directly in the audio callback on every captured sample frame. Settings and
+// detection state are protected by the device mutex. Detected events get passed to the main thread
+// via a lock-free single producer, single consumer queue. Onsets start the trigger device by posting
+// a start time to it lock-free, as the audio thread must not block on the mutex of another device.
+
+// One detected event:
+typedef struct PsychPADetectorEvent {
+	int			type;			// 1 = Onset, 2 = Offset.
+	psych_int64	frame;			// Index of the sample frame of the event since start of capture.
+	double		time;			// Capture time of that sample frame in GetSecs time.
+	double		level;			// RMS level at detection.
+	double		noiseFloor;		// Estimated RMS level of background noise at detection.
+} PsychPADetectorEvent;
+
+typedef struct PsychPADetector {
+	// Settings:
+	double		threshold;		// Absolute RMS threshold for onsets, 0 = None.
+	double		snr;			// Threshold for onsets relative to noise floor, 0 = None.
+	double		levelCoeff;		// Smoothing coefficient of squared signal for RMS level.
+	double		floorRise;		// Smoothing coefficient of noise floor estimate for rising...
+	double		floorFall;		// ...and falling levels.
+	psych_int64	minFrames;		// Minimum duration of onset state in frames, and duration below offset threshold for offset.
+	psych_int64	warmupFrames;	// Frames after start during which the noise floor gets estimated, but nothing detected.
+	int			channel;		// Input channel to use, -1 = Mix of all channels.
+	int			numBiquads;		// Number of band limiting filter sections, 0 = No band limiting.
+	double		biquads[2][5];	// Band limiting highpass and lowpass filter coefficients b0, b1, b2, a1, a2.
+	int			trigger;		// Slave device to start at onset, -1 = None.
+	double		triggerDelay;	// Start delay of trigger device after onset in seconds.
+
+	// Detection state:
+	double		z[2][2];		// Band limiting filter states.
+	double		meanSquare;		// Smoothed squared signal.
+	double		noiseFloor;		// Noise floor estimate.
+	double		onsetLevel;		// Threshold at last onset.
+	psych_int64	framesSeen;		// Frames processed since start.
+	psych_int64	onFrames;		// Frames since onset.
+	psych_int64	belowFrames;	// Consecutive frames below offset threshold since onset.
+	psych_bool	isOn;			// In onset state?
+
+	// Event queue: Written by the audio thread, read by the main thread:
+	PsychPADetectorEvent events[PSYCH_AUDIO_DETECTOR_QUEUESIZE];
+	volatile unsigned int writeCount;	// Total number of events written. Only modified by the audio thread.
+	volatile unsigned int readCount;	// Total number of events read. Only modified by the main thread.
+	volatile unsigned int overflows;	// Number of events lost because the queue was full.
+} PsychPADetector;
+
+// Reset detection state of 'det' for a new capture:
+static void PsychPAResetDetector(PsychPADetector* det)
+{
+	memset(det->z, 0, sizeof(det->z));
+	det->meanSquare = 0;
+	det->noiseFloor = 0;
+	det->onsetLevel = 0;
+	det->framesSeen = 0;
+	det->onFrames = 0;
+	det->belowFrames = 0;
+	det->isOn = FALSE;
+}
+
+// Append event to the queue of 'det', called by the audio thread:
+static void PsychPADetectorPush(PsychPADetector* det, int type, psych_int64 frame, double time, double level)
+{
+	PsychPADetectorEvent* ev;
+
+	if (det->writeCount - det->readCount >= PSYCH_AUDIO_DETECTOR_QUEUESIZE) {
+		det->overflows++;
+		return;
+	}
+
+	ev = &(det->events[det->writeCount % PSYCH_AUDIO_DETECTOR_QUEUESIZE]);
+	ev->type = type;
+	ev->frame = frame;
+	ev->time = time;
+	ev->level = level;
+	ev->noiseFloor = det->noiseFloor;
+
+	// Make event visible before it gets counted:
+	PsychPAMemoryBarrier();
+	det->writeCount++;
+}
+
+// Run capture event detector of device 'dev' on 'frames' captured frames in 'in'. 'firstFrame' is the index
+// of the first frame since start of capture, 'firstTime' its capture time in GetSecs time:
+static void PsychPARunDetector(PsychPADevice* dev, const float* in, psych_int64 frames, psych_int64 firstFrame, double firstTime)
+{
+	PsychPADetector* det = dev->detector;
+	PsychPADevice* target;
+	psych_int64 inchannels = dev->inchannels;
+	psych_int64 t, c;
+	double x, y, level, threshold, time;
+	int i;
+
+	for (t = 0; t < frames; t++) {
+		// Mono signal from selected channel, or mix of all channels:
+		if (det->channel >= 0) {
+			x = in[t * inchannels + det->channel];
+		}
+		else {
+			for (c = 0, x = 0; c < inchannels; c++) x += in[t * inchannels + c];
+			x /= inchannels;
+		}
+
+		// Optional band limiting:
+		for (i = 0; i < det->numBiquads; i++) {
+			y = det->biquads[i][0] * x + det->z[i][0];
+			det->z[i][0] = det->biquads[i][1] * x - det->biquads[i][3] * y + det->z[i][1];
+			det->z[i][1] = det->biquads[i][2] * x - det->biquads[i][4] * y;
+			x = y;
+		}
+
+		// Smoothed RMS level:
+		det->meanSquare += det->levelCoeff * (x * x - det->meanSquare);
+		if (det->meanSquare < 1e-30) det->meanSquare = 0;
+		level = sqrt(det->meanSquare);
+		det->framesSeen++;
+
+		if (!det->isOn) {
+			// Waiting for onset: Onset if level exceeds all enabled thresholds after warmup:
+			threshold = (det->threshold > det->snr * det->noiseFloor) ? det->threshold : det->snr * det->noiseFloor;
+			if ((det->framesSeen > det->warmupFrames) && (level > threshold)) {
+				time = firstTime + (double) t / dev->streaminfo->sampleRate;
+				PsychPADetectorPush(det, 1, firstFrame + t, time, level);
+				det->isOn = TRUE;
+				det->onsetLevel = threshold;
+				det->onFrames = 0;
+				det->belowFrames = 0;
+
+				// Start trigger device, if it waits for a start: Post the start time, its own
+				// paCallback() applies it at its next invocation if it is still in hot standby:
+				if (det->trigger >= 0) {
+					target = &audiodevices[det->trigger];
+					if (target->stream && (target->state == 1)) {
+						target->triggerStartTime = time + det->triggerDelay;
+						PsychPAMemoryBarrier();
+						target->triggerPosted = 1;
+					}
+				}
 			}
 			else {
-				// Constraints ok, break out of do-while slot advance loop:
-				break;
+				// Track noise floor, slowly upwards, faster downwards. Quickly during warmup:
+				if (det->framesSeen <= det->warmupFrames) det->noiseFloor += det->levelCoeff * (level - det->noiseFloor);
+				else det->noiseFloor += ((level > det->noiseFloor) ? det->floorRise : det->floorFall) * (level - det->noiseFloor);
 			}
-		} while(TRUE);
+		}
+		else {
+			// In onset state: Offset once the level stayed below the offset threshold for minFrames,
+			// but not earlier than minFrames after the onset. The offset is the first frame below:
+			det->onFrames++;
+			det->belowFrames = (level < PSYCH_AUDIO_DETECTOR_HYSTERESIS * det->onsetLevel) ? det->belowFrames + 1 : 0;
+			if ((det->onFrames >= det->minFrames) && (det->belowFrames >= det->minFrames)) {
+				time = firstTime + (double) (t - det->belowFrames + 1) / dev->streaminfo->sampleRate;
+				PsychPADetectorPush(det, 2, firstFrame + t - det->belowFrames + 1, time, level);
+				det->isOn = FALSE;
+			}
+		}
 	}
-	
-	*ret_outsbsize = outsbsize;
-	*ret_outsboffset = outsboffset;
-	*ret_repeatCount = repeatCount;
-	*ret_playpositionlimit = playpositionlimit;
+}
 
-	// Safety check: If playoutbuffer is NULL at this point, then somethings screwed
-	// and we request abort of playback:
-	if (NULL == *ret_playoutbuffer) return(2);
+// Sample copy loops for paCallback(): Each processes one contiguous segment of 'count' samples,
+// without any per-sample bounds checks or index wraparound, so compilers can auto-vectorize them:
 
-	// Return 0 exit to signal a valid update:
-	return(0);
+// dst = src * gain:
+static void PsychPACopyWithGain(float* dst, const float* src, psych_int64 count, float gain)
+{
+	psych_int64 k;
+	for (k = 0; k < count; k++) dst[k] = src[k] * gain;
+}
+
+// dst = dst * src * gain:
+static void PsychPAMultiplyWithGain(float* dst, const float* src, psych_int64 count, float gain)
+{
+	psych_int64 k;
+	for (k = 0; k < count; k++) dst[k] *= src[k] * gain;
+}
+
+// dst = dst * gain:
+static void PsychPAApplyGain(float* dst, psych_int64 count, float gain)
+{
+	psych_int64 k;
+	for (k = 0; k < count; k++) dst[k] *= gain;
 }
 
 /* paCallback: PortAudo I/O processing callback. 
@@ -749,11 +3516,15 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 	PsychPADevice* dev = (PsychPADevice*) userData;
 	float *out = (float*) outputBuffer;
 	float *in = (float*) inputBuffer;
+	unsigned long allFrames = framesPerBuffer;
 	float *playoutbuffer;
 	float *tmpBuffer, *mixBuffer;
 	float masterVolume, neutralValue;
 	psych_int64  j, k;
 	psych_int64 i, silenceframes, committedFrames, max_i;
+	psych_int64 n, segment, segmentpos;
+	double resampleRatio;
+	PsychPAFileBuffer* readfb;
 	psych_int64 inchannels, outchannels;
 	psych_int64  playposition, outsbsize, insbsize, recposition;
 	psych_int64  outsboffset;
@@ -764,7 +3535,10 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 	PaHostApiTypeId hA;
 	psych_bool stopEngine;
 	psych_bool isMaster, isSlave;
-	int slaveId, modulatorSlave, parc, numSlavesHandled;
+	int slaveId, parc, numSlavesHandled, numTasks;
+	int slaveTasks[MAX_PSYCH_AUDIO_SLAVES_PER_DEVICE];
+	psych_bool parallelMix;
+	double tMixStart, tMixEnd;
 
 	// Device struct attached to stream? If no device struct
 	// is attached, we can't continue and tell the engine to abort
@@ -881,6 +3655,14 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 			captureStartTime = now + ((double) (timeInfo->inputBufferAdcTime - timeInfo->currentTime));
 		}
 		
+		if (hA == kPsychPAOfflineHostAPI) {
+			// Offline render backend: Its synthetic timestamps are in its simulated timebase, which
+			// only matches GetSecs time in simulated realtime mode. Use them as they are:
+			now = (double) timeInfo->currentTime;
+			firstsampleonset = (double) ((dev->opmode & kPortAudioPlayBack) ? timeInfo->outputBufferDacTime : timeInfo->inputBufferAdcTime) + dev->latencyBias;
+			captureStartTime = (double) timeInfo->inputBufferAdcTime;
+		}
+
 		if (FALSE) {
 			// Debug code to compare our two timebases against each other: On OS/X,
 			// luckily both timebases are identical, ie. our UpTime() timebase used
@@ -1050,6 +3832,14 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 	// with real sampledata. Assuming the sound onset estimate provided by PA is
 	// correct, this should allow accurate sound onset. It all depends on the
 	// latency estimate...
+
+	// Start time posted by the capture event detector of another device? Apply it if we
+	// are still waiting for our start:
+	if (dev->triggerPosted) {
+		PsychPAMemoryBarrier();
+		if (dev->state == 1) dev->reqStartTime = dev->triggerStartTime;
+		dev->triggerPosted = 0;
+	}
 	
 	// Hot standby?
 	if (dev->state == 1) {
@@ -1171,8 +3961,11 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 		// Have scratch buffers ready. Clear output intermix buffer:
 		memset(outputBuffer, 0, dev->batchsize * outchannels * sizeof(float));
 
-		// Iterate over all slave device callbacks: Or at least until all registered slaves are handled.
+		// Iterate over all slave devices: Or at least until all registered slaves are handled.
+		// Collect all real audio slaves which may need processing:
 		numSlavesHandled = 0;
+		numTasks = 0;
+		parallelMix = TRUE;
 		for (i = 0; (i < MAX_PSYCH_AUDIO_SLAVES_PER_DEVICE) && (numSlavesHandled < dev->slaveCount); i++) {
 			// Valid slave slot?
 			slaveId = dev->slaves[i];
@@ -1180,131 +3973,43 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 			// We skip invalid slots and output capturer slaves:
 			if ((slaveId > -1) && !(audiodevices[slaveId].opmode & kPortAudioIsOutputCapture)) {
 				// Valid slave:
+				numSlavesHandled++;
 
-				// Is this device an AM modulator attached to a slave?
-				if (audiodevices[slaveId].opmode & kPortAudioIsAMModulatorForSlave) {
-					// Yes. Mark it as handled, then skip it. It will be called as part
-					// of processing of its parent slave:
-					numSlavesHandled++;
-					continue;
-				}
+				// Is this device an AM modulator attached to a slave? If so, skip it.
+				// It will be called as part of processing of its parent slave:
+				if (audiodevices[slaveId].opmode & kPortAudioIsAMModulatorForSlave) continue;
 
-				// This is a "real" audio slave, not a modulator or such:
-
-				// Gain modulator slave for this real slave attached, valid and active?
-				// If this is the case, we need to unconditionally execute it here, regardless
-				// of what the actual 'slaveId' device is up to. Otherwise we can run into
-				// time sync issues and ugly deadlocks in the calling code:
-				modulatorSlave = audiodevices[slaveId].modulatorSlave;
-				if ((modulatorSlave > -1) && (audiodevices[modulatorSlave].stream) &&
-					(audiodevices[modulatorSlave].opmode & kPortAudioIsAMModulatorForSlave) && (audiodevices[modulatorSlave].state > 0)) {
-					// Yes. Execute it:
-					audiodevices[modulatorSlave].slaveDirty = 0;
-
-					// Prefill buffer with neutral 1.0:
-					tmpBuffer = dev->slaveGainBuffer;
-					for (j = 0; j < dev->batchsize * audiodevices[modulatorSlave].outchannels; j++) *(tmpBuffer++) = 1.0;
-
-					// This will potentially fill the slaveGainBuffer with gain modulation values.
-					// The passed slaveInBuffer is meaningless for a modulator slave and only contains random junk...
-					paCallback( (const void*) dev->slaveInBuffer, (void*) dev->slaveGainBuffer, (unsigned long) dev->batchsize, timeInfo, statusFlags, (void*) &(audiodevices[modulatorSlave]));
-				}
-				else {
-					// No. Either no modulator slave or slave not currently active. Signal this
-					// by setting modulatorSlave to a -1 value:
-					modulatorSlave = -1;
+				// This is a "real" audio slave, not a modulator or such. Does it need processing?
+				if ((audiodevices[slaveId].state > 0) || (audiodevices[slaveId].modulatorSlave > -1)) {
+					// An active AM modulator for the master modulates the mix of all slaves processed
+					// before it, so the result depends on processing order. Can't parallelize then:
+					if ((audiodevices[slaveId].opmode & kPortAudioIsAMModulator) && (audiodevices[slaveId].state > 0)) parallelMix = FALSE;
+
+					slaveTasks[numTasks++] = slaveId;
 				}
+			}
+		}
 
-				// Skip actual slaves processing if its state is zero == completely inactive.
-				if (audiodevices[slaveId].state > 0) {
-					// Slave is active, need to process it:
+		// Process all collected slaves, in parallel on our mixer threads if possible and worthwhile, serially otherwise:
+		if (!parallelMix || !PsychPAMixSlavesParallel(dev, in, (float*) outputBuffer, slaveTasks, numTasks, committedFrames, timeInfo, statusFlags)) {
+			if (dev->mixerPool) PsychGetAdjustedPrecisionTimerSeconds(&tMixStart);
 
-					// Reset dirty flag for this slave:
-					audiodevices[slaveId].slaveDirty = 0;
+			for (i = 0; i < numTasks; i++) {
+				// Slave still owned by a late mixer thread? Can't process it now, so it counts as underrun:
+				if (PsychPAMixerSlaveInFlight(dev->mixerPool, slaveTasks[i])) {
+					dev->xruns++;
+					continue;
+				}
 
-					// Is this a playback slave?
-					if (audiodevices[slaveId].opmode & kPortAudioPlayBack) {
-						// Prefill slaves output buffer with 1.0, a neutral gain value for playback slaves
-						// without a AM modulator attached. The same prefill is needed with AM modulator,
-						// this time to make the modulator itself happy:
-						tmpBuffer = dev->slaveOutBuffer;
-						for (j = 0; j < dev->batchsize * audiodevices[slaveId].outchannels; j++) *(tmpBuffer++) = 1.0;
-
-						// Ok, the outbuffer is filled with a neutral 1.0 gain value. This will work
-						// even if no per-slave gain modulation is provided by a modulator slave.
-
-						// Is a modulator slave active and did it write any gain AM values?
-						if ((modulatorSlave > -1) && (audiodevices[modulatorSlave].slaveDirty)) {
-							// Yes. Need to distribute them to proper channels in slaveOutBuffer:
-							tmpBuffer = dev->slaveGainBuffer;
-							mixBuffer = dev->slaveOutBuffer;
-							for (j = 0; j < dev->batchsize; j++) {
-								// Iterate over all target channels in the slave device outputbuffer:
-								for (k = 0; k < audiodevices[modulatorSlave].outchannels; k++) {
-									// Modulate current sample in intermixbuffer via multiplication:
-									mixBuffer[(j * audiodevices[slaveId].outchannels) + audiodevices[modulatorSlave].outputmappings[k]] = *(tmpBuffer++) * audiodevices[modulatorSlave].outChannelVolumes[k];
-								}
-							}				
-						}
-					}	// Ok, the slaveOutBuffer for this playback slave is prefilled with valid gain modulation data to apply to the actual sound output.
+				PsychPAMixSlave(dev, slaveTasks[i], in, (float*) outputBuffer, dev->slaveOutBuffer, dev->slaveGainBuffer, dev->slaveInBuffer, committedFrames, timeInfo, statusFlags);
+			}
 
-					// Capture enabled on slave? If so, we need to distribute our captured audio data to it:
-					if (audiodevices[slaveId].opmode & kPortAudioCapture) {
-						tmpBuffer = dev->slaveInBuffer;
-						// For each sampleFrame in the input buffer:
-						for (j = 0; j < dev->batchsize; j++) {
-							// Iterate over all target channels in the slave devices inputbuffer:
-							for (k = 0; k < audiodevices[slaveId].inchannels; k++) {
-								// And fetch from corrsponding source channel of our device:
-								*(tmpBuffer++) = in[(j * inchannels) + audiodevices[slaveId].inputmappings[k]];
-							}
-						}
-					}
-					
-					// Temporary input buffer is filled for slave callback: Execute it.
-					paCallback( (const void*) dev->slaveInBuffer, (void*) dev->slaveOutBuffer, (unsigned long) dev->batchsize, timeInfo, statusFlags, (void*) &(audiodevices[slaveId]));
-					
-					// Check if the paCallback actually filled anything into the dev->slaveOutBuffer:
-					if ((audiodevices[slaveId].opmode & kPortAudioPlayBack) && audiodevices[slaveId].slaveDirty) {
-						// Slave has written meaningful data to its output buffer. Merge & mix it:
-						
-						// Process from first non-silence sample slot (after silenceframes prefix) until end of buffer:
-						tmpBuffer = &(dev->slaveOutBuffer[committedFrames * audiodevices[slaveId].outchannels]);
-						mixBuffer = (float*) outputBuffer;
-						
-						// Special AM-Modulator slave?
-						if (audiodevices[slaveId].opmode & kPortAudioIsAMModulator) {
-							// Yes: This slave doesn't provide audio data for mixing, but instead
-							// a time-series of gain modulation samples for amplitude modulation.
-							// Multiply the master channels samples with the slaves "gain samples"
-							// to apply AM modulation:
-							for (j = committedFrames; j < dev->batchsize; j++) {
-								// Iterate over all target channels in the slave device outputbuffer:
-								for (k = 0; k < audiodevices[slaveId].outchannels; k++) {
-									// Modulate current sample in intermixbuffer via multiplication:
-									mixBuffer[(j * outchannels) + audiodevices[slaveId].outputmappings[k]] *= *(tmpBuffer++) * audiodevices[slaveId].outChannelVolumes[k];
-								}
-							}
-						}
-						else {
-							// Regular mix: Mix all output channels of the slave into the proper target channels
-							// of the master by simple addition. Apply per-channel volume settings of the slave
-							// during mix:
-							for (j = committedFrames; j < dev->batchsize; j++) {
-								// Iterate over all target channels in the slave device outputbuffer:
-								for (k = 0; k < audiodevices[slaveId].outchannels; k++) {
-									// Mix current sample via addition:
-									mixBuffer[(j * outchannels) + audiodevices[slaveId].outputmappings[k]] += *(tmpBuffer++) * audiodevices[slaveId].outChannelVolumes[k];
-								}
-							}
-						}
-					}
-				}
-				
-				// One more slave handled:
-				numSlavesHandled++;
+			// Update running estimate of the processing cost per slave, to decide about parallel processing:
+			if (dev->mixerPool && (numTasks > 0)) {
+				PsychGetAdjustedPrecisionTimerSeconds(&tMixEnd);
+				dev->mixerSlaveCost = 0.9 * dev->mixerSlaveCost + 0.1 * ((tMixEnd - tMixStart) / numTasks);
 			}
-		}	// Next slave...
+		}
 
 		// Done merging sound data from slaves. Mastercode can now process special output capture slaves
 		// and other special post-mix slaves:
@@ -1391,11 +4096,22 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 			return(paAbort);
 		}
 		
+		// Run capture event detector, if any, on the captured data:
+		if (dev->detector && ((dev->detector->threshold > 0) || (dev->detector->snr > 0))) {
+			PsychPARunDetector(dev, in, dev->batchsize, recposition / inchannels, captureStartTime);
+		}
+
 		// This is the simple case (compared to playback processing).
-		// Just copy all available data to our internal buffer:
-		for (i=0; (i < dev->batchsize * inchannels); i++) {
-			dev->inputbuffer[recposition % insbsize] = (float) *in++;
-			recposition++;
+		// Just copy all available data to our internal ringbuffer, in
+		// contiguous segments up to the wraparound point of the ringbuffer:
+		for (n = dev->batchsize * inchannels; n > 0; n -= segment) {
+			segmentpos = recposition % insbsize;
+			segment = insbsize - segmentpos;
+			if (segment > n) segment = n;
+
+			memcpy(&(dev->inputbuffer[segmentpos]), in, (size_t) segment * sizeof(float));
+			in += segment;
+			recposition += segment;
 		}
 		
 		// Store updated recording position in device structure:
@@ -1445,33 +4161,77 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 			   ((parc = PsychPAProcessSchedule(dev, &playposition, &playoutbuffer, &outsbsize, &outsboffset, &repeatCount, &playpositionlimit)) == 0)) {
 			// Process this slot:
 
-			if (!isMaster && !isSlave) {
-				// Non-master, non-slave device: This is a regular sound device.
-				// Copy requested number of samples for each channel into the output buffer: Take the case of
-				// "loop forever" and "loop repeatCount" times into account, as well as stop times:
-				for (; (i < framesPerBuffer * outchannels) && (i < max_i) && ((repeatCount == -1) || (playposition < playpositionlimit)); i++) {
-					*(out++) = playoutbuffer[outsboffset + ( playposition % outsbsize )] * masterVolume;
-					playposition++;
+			// Compute number of samples to process for this slot: Limited by the free space in the host output
+			// buffer, by the max_i limit for the stop time, and by the end of the last repetition, unless
+			// we "loop forever":
+			n = framesPerBuffer * outchannels - i;
+			if (max_i - i < n) n = max_i - i;
+			if ((repeatCount != -1) && (playpositionlimit - playposition < n)) n = playpositionlimit - playposition;
+			if (n < 0) n = 0;
+
+			if (!isMaster && dev->resampler && ((resampleRatio = PsychPAGetResampleRatio(dev, dev->slotSampleRate)) != 1.0)) {
+				// Non-master device which needs sample rate conversion: The number of consumed source samples differs
+				// from the number of produced output samples, so only limit by output space and stop time. The
+				// resampler itself stops at the end of the last repetition:
+				n = framesPerBuffer * outchannels - i;
+				if (max_i - i < n) n = max_i - i;
+
+				// Source samples of a file backed buffer not yet decoded by the read-ahead thread? Count as underrun:
+				if ((readfb = dev->slotFileBuffer) != NULL) {
+					PsychPAFileBufferBeginRead(readfb);
+					if (!PsychPAFileBufferReady(readfb, outsboffset, outsbsize, playposition,
+												((psych_int64) ((double) (n / outchannels) * resampleRatio) + dev->resampler->taps + 1) * outchannels)) dev->xruns++;
 				}
+
+				// Slaves multiply for the same reason as below:
+				n = PsychPAResampleSlot(dev, out, n, playoutbuffer, outsbsize, outsboffset, repeatCount, playpositionlimit, &playposition, resampleRatio, masterVolume, isSlave);
+				if (readfb) PsychPAFileBufferEndRead(readfb);
+				out += n;
+				i += n;
 			}
 			else if (!isMaster) {
-				// Non-master device: This is a slave.
-				// Copy requested number of samples for each channel into the output buffer: Take the case of
-				// "loop forever" and "loop repeatCount" times into account, as well as stop times:
-				for (; (i < framesPerBuffer * outchannels) && (i < max_i) && ((repeatCount == -1) || (playposition < playpositionlimit)); i++) {
-					// We multiply in order to apply possible per-channel, per-sample gain values as
-					// defined by the master - i.e., by an AM modulator that is attached to us:
-					*(out++) *= playoutbuffer[outsboffset + ( playposition % outsbsize )] * masterVolume;
-					playposition++;
+				// Non-master device: Regular sound device or slave.
+				// Not resampling (anymore), so next resampling starts without fractional offset or ratio ramp:
+				dev->resamplePhase = 0.0;
+				dev->resampleRatio = 0.0;
+
+				// Samples of a file backed buffer not yet decoded by the read-ahead thread? Count as underrun:
+				if ((readfb = dev->slotFileBuffer) != NULL) {
+					PsychPAFileBufferBeginRead(readfb);
+					if (!PsychPAFileBufferReady(readfb, outsboffset, outsbsize, playposition, n)) dev->xruns++;
+				}
+
+				// Copy requested number of samples for each channel into the output buffer, in contiguous segments
+				// up to the wraparound point of the playback buffer, where the next repetition of the buffer starts:
+				for (; n > 0; n -= segment) {
+					segmentpos = playposition % outsbsize;
+					segment = outsbsize - segmentpos;
+					if (segment > n) segment = n;
+
+					if (!isSlave) {
+						// Non-master, non-slave device: This is a regular sound device.
+						PsychPACopyWithGain(out, &(playoutbuffer[outsboffset + segmentpos]), segment, masterVolume);
+					}
+					else {
+						// Slave: We multiply in order to apply possible per-channel, per-sample gain values as
+						// defined by the master - i.e., by an AM modulator that is attached to us:
+						PsychPAMultiplyWithGain(out, &(playoutbuffer[outsboffset + segmentpos]), segment, masterVolume);
+					}
+
+					out += segment;
+					i += segment;
+					playposition += segment;
 				}
+
+				if (readfb) PsychPAFileBufferEndRead(readfb);
 			}
 			else {
 				// Master device: We don't output our own audio data. Just apply the masterVolume
 				// gain setting common to all output channels of the device:
-				for (; (i < framesPerBuffer * outchannels) && (i < max_i) && ((repeatCount == -1) || (playposition < playpositionlimit)); i++) {
-					*(out++) *= masterVolume;
-					playposition++;
-				}		
+				PsychPAApplyGain(out, n, masterVolume);
+				out += n;
+				i += n;
+				playposition += n;
 			}
 
 			// Store updated playposition in device structure:
@@ -1508,6 +4268,9 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 				*out++ = neutralValue;
 				i++;
 			}
+
+			// Apply effect chain, if any, to the whole buffer, including leading and trailing silence:
+			if (dev->dspActive || dev->dspPending) PsychPADspProcess(dev, (float*) outputBuffer, (psych_int64) allFrames);
 			
 			// Signal that engine is stopped/will stop very soonish:
 			// Unless parc == 4 request a rescheduled restart, ie., switching to hot-standby
@@ -1535,6 +4298,9 @@ static int paCallback( const void *inputBuffer, void *outputBuffer,
 				return(paContinue);
 			}
 		}
+
+		// Apply effect chain, if any, to the whole buffer, including leading silence:
+		if (dev->dspActive || dev->dspPending) PsychPADspProcess(dev, (float*) outputBuffer, (psych_int64) allFrames);
 	}
 		
 	// Tell engine to continue stream processing, i.e., call us again...
@@ -1586,6 +4352,9 @@ void PsychPACloseStream(int id)
 				for (i = 0; i < MAX_PSYCH_AUDIO_DEVS; i++) if (audiodevices[i].modulatorSlave == id) { audiodevices[i].modulatorSlave = -1; }
 			}
 
+			// Detach from capture event detectors which would start us:
+			for (i = 0; i < MAX_PSYCH_AUDIO_DEVS; i++) if (audiodevices[i].detector && (audiodevices[i].detector->trigger == id)) { audiodevices[i].detector->trigger = -1; }
+
 			// Detached :-) -- Master can continue with whatever...
 			PsychPAUnlockDeviceMutex(&audiodevices[pamaster]);
 			
@@ -1596,10 +4365,10 @@ void PsychPACloseStream(int id)
 			// Portaudio shutdown.
 			
 			// Stop, shutdown and release audio stream:
-			Pa_StopStream(stream);
+			PsychPAStreamStop(stream);
 			
 			// Unregister the stream finished callback:
-			Pa_SetStreamFinishedCallback(stream, NULL);
+			PsychPAStreamSetFinishedCallback(stream, NULL);
 			
 			// Our device thread, callbacks and hardware are stopped, all mutexes are unlocked,
 			// all our potential slaves are inactive as well. We can safely destroy our slaves,
@@ -1619,7 +4388,7 @@ void PsychPACloseStream(int id)
 			// Destruction for both master- and regular audio devices:
 			
 			// Close and destroy the hardware portaudio stream:
-			Pa_CloseStream(stream);
+			PsychPAStreamClose(stream);
 		}
 		
 		// Common destruct path for all types of devices:
@@ -1648,6 +4417,23 @@ void PsychPACloseStream(int id)
 			audiodevices[id].schedule_size = 0;
 		}				
 
+		// Release effect chains, if any:
+		PsychPADspDestroy(&audiodevices[id]);
+
+		// Release capture event detector, if any:
+		free(audiodevices[id].detector);
+		audiodevices[id].detector = NULL;
+
+		// Release resampler, if any:
+		PsychPADestroyResampler(audiodevices[id].resampler);
+		audiodevices[id].resampler = NULL;
+
+		// Stop and release mixer threads, if any:
+		if(audiodevices[id].mixerPool) {
+			PsychPADestroyMixerPool(audiodevices[id].mixerPool);
+			audiodevices[id].mixerPool = NULL;
+		}
+
 		// Free associated sound intermixbuffers:
 		if(audiodevices[id].slaveOutBuffer) {
 			free(audiodevices[id].slaveOutBuffer);
@@ -1723,7 +4509,17 @@ void InitializeSynopsis(void)
 	synopsis[i++] =	"[oldMasterVolume, oldChannelVolumes] = PsychPortAudio('Volume', pahandle [, masterVolume][, channelVolumes]);";
 	synopsis[i++] = "enable = PsychPortAudio('DirectInputMonitoring', pahandle, enable [, inputChannel = -1][, outputChannel = 0][, gainLevel = 0.0][, stereoPan = 0.5]);";
 	synopsis[i++] = "[underflow, nextSampleStartIndex, nextSampleETASecs] = PsychPortAudio('FillBuffer', pahandle, bufferdata [, streamingrefill=0][, startIndex=Append]);";
-	synopsis[i++] =	"bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata);";
+	synopsis[i++] =	"bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata [, sampleRate]);";
+	synopsis[i++] = "pahandle = PsychPortAudio('OpenOffline' [, mode=1][, freq=48000][, channels=2][, buffersize=256][, outputFile][, inputFile][, realtime=0]);";
+	synopsis[i++] = "stats = PsychPortAudio('OfflineStatistics', pahandle [, reset=0]);";
+	synopsis[i++] = "[oldNumThreads, oldMinCost, slaveCost] = PsychPortAudio('MixerThreads', pamaster [, numThreads][, minCost]);";
+	synopsis[i++] = "[oldSourceRate, oldPlaybackRate, oldQuality] = PsychPortAudio('Resampling', pahandle [, sourceRate][, playbackRate][, quality]);";
+	synopsis[i++] = "oldCoefficients = PsychPortAudio('DspBiquads', pahandle [, coefficients]);";
+	synopsis[i++] = "latency = PsychPortAudio('DspConvolution', pahandle [, impulseResponse][, partitionSize=128][, maxLength]);";
+	synopsis[i++] = "[oldThreshold, oldLookahead, oldRelease] = PsychPortAudio('DspLimiter', pahandle [, threshold][, lookahead=0.002][, release=0.05]);";
+	synopsis[i++] = "PsychPortAudio('CaptureDetector', pahandle [, threshold=0][, snr=0][, window=0.005][, minDuration=0.1][, band][, channel=0][, triggerHandle=-1][, triggerDelay=0]);";
+	synopsis[i++] = "[events, overflows] = PsychPortAudio('GetCaptureEvents', pahandle);";
+	synopsis[i++] =	"[bufferhandle, nrFrames, sampleRate] = PsychPortAudio('CreateBufferFromFile' [, pahandle], filename [, nrChannels][, sampleFormat='float32'][, dataOffset=0][, readAheadFrames]);";
 	synopsis[i++] =	"PsychPortAudio('DeleteBuffer'[, bufferhandle] [, waitmode]);";
 	synopsis[i++] =	"PsychPortAudio('RefillBuffer', pahandle [, bufferhandle=0], bufferdata [, startIndex=0]);";
 	synopsis[i++] = "PsychPortAudio('SetLoop', pahandle[, startSample=0][, endSample=max][, UnitIsSeconds=0]);";
@@ -1731,6 +4527,7 @@ void InitializeSynopsis(void)
 	synopsis[i++] = "startTime = PsychPortAudio('RescheduleStart', pahandle, when [, waitForStart=0] [, repetitions] [, stopTime]);";
 	synopsis[i++] = "status = PsychPortAudio('GetStatus' pahandle);";
 	synopsis[i++] = "[audiodata absrecposition overflow cstarttime] = PsychPortAudio('GetAudioData', pahandle [, amountToAllocateSecs][, minimumAmountToReturnSecs][, maximumAmountToReturnSecs][, singleType=0]);";
+	synopsis[i++] = "[audiodata, absrecposition, firsttime] = PsychPortAudio('GetAudioDataRange', pahandle, rangeStart, rangeEnd [, units=0][, decimation=1][, dataType=0][, peek=1]);";
 	synopsis[i++] = "[startTime endPositionSecs xruns estStopTime] = PsychPortAudio('Stop', pahandle [,waitForEndOfPlayback=0] [, blockUntilStopped=1] [, repetitions] [, stopTime]);";
 	synopsis[i++] =	"PsychPortAudio('UseSchedule', pahandle, enableSchedule [, maxSize = 128]);";
 	synopsis[i++] =	"[success, freeslots] = PsychPortAudio('AddToSchedule', pahandle [, bufferHandle=0][, repetitions=1][, startSample=0][, endSample=max][, UnitIsSeconds=0][, specialFlags=0]);";
@@ -1806,11 +4603,16 @@ PsychError PsychPortAudioExit(void)
 		}
 		audiodevicecount = 0;
 		
+		// Stop read-ahead thread for file backed buffers:
+		PsychPAStopFileBufferThread();
+
 		// Delete all audio buffers and the bufferlist itself:
 		PsychPADeleteAllAudioBuffers();
 		
 		// Release audiobufferlist mutex lock:
 		PsychDestroyMutex(&bufferListmutex);
+		PsychDestroyCondition(&fileBufferSignal);
+		PsychDestroyMutex(&fileBufferMutex);
 		
 		// Shutdown PortAudio itself:
 		err = Pa_Terminate();
@@ -1906,6 +4708,11 @@ void PsychPortAudioInitialize(void)
 		bufferList = NULL;
 		PsychInitMutex(&bufferListmutex);
 
+		// Same for the list of file backed buffers. Their read-ahead thread gets started on first use:
+		fileBufferList = NULL;
+		PsychInitMutex(&fileBufferMutex);
+		PsychInitCondition(&fileBufferSignal, NULL);
+
 		// On Vista systems and later, we assume everything will be fine wrt. to timing and multi-core
 		// systems, but still perform consistency checks at each call to PsychGetPrecisionTimerSeconds().
 		// Therefore we don't lock our threads to a single core by default. On pre-Vista systems, we
@@ -2300,67 +5107,304 @@ PsychError PSYCHPORTAUDIOOpen(void)
 		inputParameters.suggestedLatency  = (latencyclass == 0 && inputDevInfo) ? inputDevInfo->defaultHighInputLatency : lowlatency;
 	}
 	else {
-		// Override provided: Use it.
-		outputParameters.suggestedLatency = suggestedLatency;
-		inputParameters.suggestedLatency  = suggestedLatency;
-	}
-
-	#if PSYCH_SYSTEM == PSYCH_OSX
-	// Apply OS/X CoreAudio specific optimizations:
-	if (latencyclass > 1) {
-		unsigned long flags = paMacCore_ChangeDeviceParameters;
-		if (latencyclass > 3) flags|= paMacCore_FailIfConversionRequired;
-		paSetupMacCoreStreamInfo( &hostapisettings, flags);
-		outputParameters.hostApiSpecificStreamInfo = (paMacCoreStreamInfo*) &hostapisettings;
-		inputParameters.hostApiSpecificStreamInfo = (paMacCoreStreamInfo*) &hostapisettings;
+		// Override provided: Use it.
+		outputParameters.suggestedLatency = suggestedLatency;
+		inputParameters.suggestedLatency  = suggestedLatency;
+	}
+
+	#if PSYCH_SYSTEM == PSYCH_OSX
+	// Apply OS/X CoreAudio specific optimizations:
+	if (latencyclass > 1) {
+		unsigned long flags = paMacCore_ChangeDeviceParameters;
+		if (latencyclass > 3) flags|= paMacCore_FailIfConversionRequired;
+		paSetupMacCoreStreamInfo( &hostapisettings, flags);
+		outputParameters.hostApiSpecificStreamInfo = (paMacCoreStreamInfo*) &hostapisettings;
+		inputParameters.hostApiSpecificStreamInfo = (paMacCoreStreamInfo*) &hostapisettings;
+	}
+	#endif
+	
+	// Our stream shall be primed initially with our callbacks data, not just with zeroes.
+	// In high latency-mode 0, we request sample clipping and dithering, so sound is more
+	// high quality on Windows. In low-latency mode, we don't dither by default to save computation time.
+	sflags = paPrimeOutputBuffersUsingStreamCallback;
+	sflags = (latencyclass <= 0) ? sflags : (sflags | paDitherOff);
+
+	// specialFlags 1: Don't prime outputbuffer via streamcallback:
+	if (specialFlags & 1) sflags &= ~paPrimeOutputBuffersUsingStreamCallback;
+
+	// specialFlags 2: Always clip audio data:
+	if (specialFlags & 2) sflags &= ~paClipOff;
+
+	// specialFlags 4: Never clip audio data:
+	if (specialFlags & 4) sflags |= paClipOff;
+
+	// specialFlags 8: Always dither audio data:
+	if (specialFlags & 8) sflags &= ~paDitherOff;
+
+	// specialFlags 16: Never dither audio data:
+	if (specialFlags & 16) sflags |= paDitherOff;
+
+	// Try to create & open stream:
+	err = Pa_OpenStream(
+            &stream,															/* Return stream pointer here on success. */
+            ((mode & kPortAudioCapture) ?  &inputParameters : NULL),			/* Requested input settings, or NULL in pure playback case. */
+			((mode & kPortAudioPlayBack) ? &outputParameters : NULL),			/* Requested input settings, or NULL in pure playback case. */
+            freq,																/* Requested sampling rate. */
+            buffersize,															/* Requested buffer size. */
+            sflags,																/* Define special stream property flags. */
+            paCallback,															/* Our processing callback. */
+            &audiodevices[audiodevicecount]);									/* Our own device info structure */
+            
+	if(err!=paNoError || stream == NULL) {
+			printf("PTB-ERROR: Failed to open audio device %i. PortAudio reports this error: %s \n", audiodevicecount, Pa_GetErrorText(err));
+			PsychErrorExitMsg(PsychError_system, "Failed to open PortAudio audio device.");
+	}
+	
+	// Setup our final device structure:
+	audiodevices[audiodevicecount].opmode = mode;
+	audiodevices[audiodevicecount].runMode = 1; // Keep engine running by default. Minimal extra cpu-load for significant reduction in startup latency.
+	audiodevices[audiodevicecount].stream = stream;
+	audiodevices[audiodevicecount].streaminfo = PsychPAStreamGetInfo(stream);
+	audiodevices[audiodevicecount].hostAPI = Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type;
+	audiodevices[audiodevicecount].startTime = 0.0;
+	audiodevices[audiodevicecount].reqStartTime = 0.0;
+	audiodevices[audiodevicecount].triggerPosted = 0;
+	audiodevices[audiodevicecount].reqStopTime = DBL_MAX;
+	audiodevices[audiodevicecount].estStopTime = 0;
+	audiodevices[audiodevicecount].currentTime = 0;		
+	audiodevices[audiodevicecount].state = 0;
+	audiodevices[audiodevicecount].reqstate = 255;
+	audiodevices[audiodevicecount].repeatCount = 1;
+	audiodevices[audiodevicecount].outputbuffer = NULL;
+	audiodevices[audiodevicecount].outputbuffersize = 0;
+	audiodevices[audiodevicecount].inputbuffer = NULL;
+	audiodevices[audiodevicecount].inputbuffersize = 0;
+	audiodevices[audiodevicecount].outchannels = mynrchannels[0];
+	audiodevices[audiodevicecount].inchannels = mynrchannels[1];
+	audiodevices[audiodevicecount].latencyBias = 0.0;
+	audiodevices[audiodevicecount].schedule = NULL;
+	audiodevices[audiodevicecount].schedule_size = 0;
+	audiodevices[audiodevicecount].schedule_pos = 0;
+	audiodevices[audiodevicecount].schedule_writepos = 0;
+	audiodevices[audiodevicecount].outdeviceidx = (audiodevices[audiodevicecount].opmode & kPortAudioPlayBack) ? outputParameters.device : -1;
+	audiodevices[audiodevicecount].indeviceidx  = (audiodevices[audiodevicecount].opmode & kPortAudioCapture)  ? inputParameters.device  : -1;
+	audiodevices[audiodevicecount].outputmappings = NULL;
+	audiodevices[audiodevicecount].inputmappings = NULL;
+	audiodevices[audiodevicecount].slaveCount = 0;
+	audiodevices[audiodevicecount].slaves = NULL;
+	audiodevices[audiodevicecount].pamaster = -1;
+	audiodevices[audiodevicecount].modulatorSlave = -1;
+	audiodevices[audiodevicecount].slaveOutBuffer = NULL;
+	audiodevices[audiodevicecount].slaveGainBuffer = NULL;
+	audiodevices[audiodevicecount].mixerPool = NULL;
+	audiodevices[audiodevicecount].mixerSlaveCost = 0.0;
+	audiodevices[audiodevicecount].mixerMinCost = PSYCH_AUDIO_MIXER_DEFAULT_MINCOST;
+	audiodevices[audiodevicecount].sourceRate = 0.0;
+	audiodevices[audiodevicecount].playbackRate = 1.0;
+	audiodevices[audiodevicecount].resampleQuality = PSYCH_AUDIO_RESAMPLER_DEFAULTQUALITY;
+	audiodevices[audiodevicecount].resampler = NULL;
+	audiodevices[audiodevicecount].resamplePhase = 0.0;
+	audiodevices[audiodevicecount].resampleRatio = 0.0;
+	audiodevices[audiodevicecount].slotSampleRate = 0.0;
+	audiodevices[audiodevicecount].slotFileBuffer = NULL;
+	audiodevices[audiodevicecount].dspActive = NULL;
+	audiodevices[audiodevicecount].dspPending = NULL;
+	audiodevices[audiodevicecount].dspRetired = NULL;
+	audiodevices[audiodevicecount].dspLast = NULL;
+	audiodevices[audiodevicecount].detector = NULL;
+	audiodevices[audiodevicecount].slaveInBuffer = NULL;
+	audiodevices[audiodevicecount].outChannelVolumes = NULL;
+	audiodevices[audiodevicecount].masterVolume = 1.0;
+	audiodevices[audiodevicecount].playposition = 0;
+	audiodevices[audiodevicecount].totalplaycount = 0;
+		
+	// If this is a master, create a slave device list and init it to "empty":
+	if (mode & kPortAudioIsMaster) {
+		audiodevices[audiodevicecount].slaves = (int*) malloc(sizeof(int) * MAX_PSYCH_AUDIO_SLAVES_PER_DEVICE);
+		if (NULL == audiodevices[audiodevicecount].slaves) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient memory during slave devicelist creation!");
+		for (i=0; i < MAX_PSYCH_AUDIO_SLAVES_PER_DEVICE; i++) audiodevices[audiodevicecount].slaves[i] = -1;
+
+		if (mode & kPortAudioPlayBack) {
+			// Allocate a dummy outputbuffer with one sampleframe:
+			audiodevices[audiodevicecount].outputbuffersize = sizeof(float) * audiodevices[audiodevicecount].outchannels * 1;
+			audiodevices[audiodevicecount].outputbuffer = (float*) malloc(audiodevices[audiodevicecount].outputbuffersize);
+			if (audiodevices[audiodevicecount].outputbuffer==NULL) PsychErrorExitMsg(PsychError_outofMemory, "Out of system memory when trying to allocate audio buffer.");
+		}
+		
+		if (mode & kPortAudioCapture) {
+			// Allocate a dummy inputbuffer with one sampleframe:
+			audiodevices[audiodevicecount].inputbuffersize = sizeof(float) * audiodevices[audiodevicecount].inchannels * 1;
+			audiodevices[audiodevicecount].inputbuffer = (float*) calloc(1, audiodevices[audiodevicecount].inputbuffersize);
+			if (audiodevices[audiodevicecount].inputbuffer == NULL) PsychErrorExitMsg(PsychError_outofMemory, "Free system memory exhausted when trying to allocate audio recording buffer!");
+		}		
+	}
+
+	// If we use locking, we need to initialize the per-device mutex:
+	if (uselocking && PsychInitMutex(&(audiodevices[audiodevicecount].mutex))) {
+		printf("PsychPortAudio: CRITICAL! Failed to initialize Mutex object for pahandle %i! Prepare for trouble!\n", audiodevicecount);
+		PsychErrorExitMsg(PsychError_system, "Audio device mutex creation failed!");
+	}
+	
+	// If we use locking, this will create & init the associated event variable:
+	PsychPACreateSignal(&(audiodevices[audiodevicecount]));
+	
+	// Register the stream finished callback:
+	PsychPAStreamSetFinishedCallback(audiodevices[audiodevicecount].stream, PAStreamFinishedCallback);
+
+	#if PSYCH_SYSTEM == PSYCH_OSX
+		// Query low-level audio driver of the CoreAudio HAL for hardware latency:
+		// Hmm, maybe not. Don't know if it is worth the hazzle... This is a constant that
+		// doesn't change throughout the lifetime of a machine, and it only makes up for about
+		// 0.3 msecs on a typical setup. Maybe if a user really needs that 0.3 msecs extra
+		// precision, he should simply download the free HALLab from Apple's Website or Developer
+		// tools, run it once, read the displayed constant and set it manually at PortAudio startup.
+		
+		// PaMacCoreStream* corestream = (PaMacCoreStream*) audiodevices[audiodevicecount].stream;
+		// audiodevices[audiodevicecount].latencyBias = 
+	#endif
+	
+	if (verbosity > 3) {
+		printf("PTB-INFO: New audio device with handle %i opened as PortAudio stream:\n",audiodevicecount);
+
+		if (audiodevices[audiodevicecount].opmode & kPortAudioPlayBack) {
+			printf("PTB-INFO: For %i channels Playback: Audio subsystem is %s, Audio device name is ", (int) audiodevices[audiodevicecount].outchannels, Pa_GetHostApiInfo(outputDevInfo->hostApi)->name);
+			printf("%s\n", outputDevInfo->name);
+		}
+
+		if (audiodevices[audiodevicecount].opmode & kPortAudioCapture) {
+			printf("PTB-INFO: For %i channels Capture: Audio subsystem is %s, Audio device name is ", (int) audiodevices[audiodevicecount].inchannels, Pa_GetHostApiInfo(inputDevInfo->hostApi)->name);
+			printf("%s\n", inputDevInfo->name);
+		}
+		
+		printf("PTB-INFO: Real samplerate %f Hz. Input latency %f msecs, Output latency %f msecs.\n",
+				audiodevices[audiodevicecount].streaminfo->sampleRate, audiodevices[audiodevicecount].streaminfo->inputLatency * 1000.0,
+				audiodevices[audiodevicecount].streaminfo->outputLatency * 1000.0);
+	}
+
+	// Return device handle:
+	PsychCopyOutDoubleArg(1, kPsychArgOptional, (double) audiodevicecount);
+	
+	// One more audio device...
+	audiodevicecount++;
+
+    return(PsychError_none);	
+}
+
+/* PsychPortAudio('OpenOffline') - Open and initialize an audio device on the offline render backend.
+ */
+PsychError PSYCHPORTAUDIOOpenOffline(void) 
+{
+ 	static char useString[] = "pahandle = PsychPortAudio('OpenOffline' [, mode=1][, freq=48000][, channels=2][, buffersize=256][, outputFile][, inputFile][, realtime=0]);";
+	//																		1		   2			 3			   4				5			  6			   7
+	static char synopsisString[] = 
+		"Open an audio device on the offline render backend and initialize it. Returns a 'pahandle' device handle for the device.\n"
+		"Offline devices don't use any sound hardware or PortAudio host API. Instead an internal render thread drives the "
+		"audio processing of the device, so they work on machines without any sound hardware, e.g., for automated tests of "
+		"playback schedules, slave mixing or AM modulation, and for benchmarking. Apart from that, they behave like "
+		"devices opened via 'Open', and can be used with all other subfunctions, e.g., as master devices for 'OpenSlave'.\n"
+		"'mode' Mode of operation, as for 'Open': 1 = playback, 2 = capture, 3 = full duplex, plus 8 for a master device.\n"
+		"'freq' Simulated samplerate in Hz. Defaults to 48000 Hz.\n"
+		"'channels' Number of audio channels, or a 2 element vector with playback and capture channels, as for 'Open'. "
+		"Defaults to 2 for stereo.\n"
+		"'buffersize' Number of sample frames processed per render iteration. Defaults to 256 frames.\n"
+		"'outputFile' Optional name of a file to write all output of the device to, as interleaved 32 bit float samples "
+		"in native byte order. The file is created or overwritten, and memory mapped for writing.\n"
+		"'inputFile' Optional name of a file with interleaved 32 bit float samples in native byte order, which is memory "
+		"mapped and fed to the device as captured sound. After its end, silence is captured.\n"
+		"'realtime' If set to 1, rendering is paced to realtime, so the device simulates real sound hardware and its timebase "
+		"is the GetSecs timebase. The default of 0 renders as fast as possible. In that case, the device runs on its own "
+		"simulated timebase, which starts at the GetSecs time at device start, but then advances by the duration of each "
+		"rendered buffer. All timestamps reported for the device and all times specified for it, e.g., a 'when' start "
+		"time, are then in this simulated time.\n"
+		"The simulated output and input latency is one 'buffersize' worth of frames. See 'OfflineStatistics' for "
+		"retrieving timing statistics of the audio processing.\n";
+
+	static char seeAlsoString[] = "Open OpenSlave OfflineStatistics Close ";	 
+  	
+	int freq, buffersize, mode, numel, realtime, i;
+	int* nrchannels;
+	int  mynrchannels[2];
+	char* outputFile = NULL;
+	char* inputFile = NULL;
+	PsychPAOfflineStream* os;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(7));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(0)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(1));	 // The maximum number of outputs
+
+	if (audiodevicecount >= MAX_PSYCH_AUDIO_DEVS) PsychErrorExitMsg(PsychError_user, "Maximum number of simultaneously open audio devices reached.");
+
+	freq = 48000;
+	buffersize = 256;
+	mode = kPortAudioPlayBack;
+	realtime = 0;
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	// Request optional mode of operation:
+	PsychCopyInIntegerArg(1, kPsychArgOptional, &mode);
+	if (mode < 1 || mode > 15 || mode & kPortAudioIsAMModulator || mode & kPortAudioIsAMModulatorForSlave || mode & kPortAudioIsOutputCapture || ((mode & kPortAudioMonitoring) && ((mode & kPortAudioFullDuplex) != kPortAudioFullDuplex))) {
+		PsychErrorExitMsg(PsychError_user, "Invalid mode for regular- or master-audio device provided: Outside valid range or invalid combination of flags.");
+	}
+
+	// Request optional frequency:
+	PsychCopyInIntegerArg(2, kPsychArgOptional, &freq);
+	if (freq < 1000 || freq > 200000) PsychErrorExitMsg(PsychError_user, "Invalid frequency provided. Valid values are 1000 to 200000 Hz.");
+
+	// Request optional number of channels:
+	numel = 0; nrchannels = NULL;
+	PsychAllocInIntegerListArg(3, kPsychArgOptional, &numel, &nrchannels);
+	if (numel == 0) {
+		mynrchannels[0] = 2;
+		mynrchannels[1] = 2;
+	}
+	else if (numel == 1) {
+		if (*nrchannels < 1 || *nrchannels > MAX_PSYCH_AUDIO_CHANNELS_PER_DEVICE) PsychErrorExitMsg(PsychError_user, "Invalid number of channels provided. Valid values are 1 to device maximum.");
+		mynrchannels[0] = *nrchannels;
+		mynrchannels[1] = *nrchannels;
+	}
+	else if (numel == 2) {
+		if (nrchannels[0] < 1 || nrchannels[0] > MAX_PSYCH_AUDIO_CHANNELS_PER_DEVICE) PsychErrorExitMsg(PsychError_user, "Invalid number of playback channels provided. Valid values are 1 to device maximum.");
+		if (nrchannels[1] < 1 || nrchannels[1] > MAX_PSYCH_AUDIO_CHANNELS_PER_DEVICE) PsychErrorExitMsg(PsychError_user, "Invalid number of capture channels provided. Valid values are 1 to device maximum.");
+		mynrchannels[0] = nrchannels[0];
+		mynrchannels[1] = nrchannels[1];
+	}
+	else {
+		PsychErrorExitMsg(PsychError_user, "You specified a list with more than two 'channels' entries? Can only be max 2 for playback- and capture.");
 	}
-	#endif
-	
-	// Our stream shall be primed initially with our callbacks data, not just with zeroes.
-	// In high latency-mode 0, we request sample clipping and dithering, so sound is more
-	// high quality on Windows. In low-latency mode, we don't dither by default to save computation time.
-	sflags = paPrimeOutputBuffersUsingStreamCallback;
-	sflags = (latencyclass <= 0) ? sflags : (sflags | paDitherOff);
 
-	// specialFlags 1: Don't prime outputbuffer via streamcallback:
-	if (specialFlags & 1) sflags &= ~paPrimeOutputBuffersUsingStreamCallback;
+	// Make sure that number of capture and playback channels is the same for fast monitoring/feedback mode:
+	if ((mode & kPortAudioMonitoring) && (mynrchannels[0] != mynrchannels[1])) PsychErrorExitMsg(PsychError_user, "Fast monitoring/feedback mode selected, but number of capture and playback channels differs! They must be the same for this mode!");
 
-	// specialFlags 2: Always clip audio data:
-	if (specialFlags & 2) sflags &= ~paClipOff;
+	// Request optional buffersize:
+	PsychCopyInIntegerArg(4, kPsychArgOptional, &buffersize);
+	if (buffersize < 1 || buffersize > 4096) PsychErrorExitMsg(PsychError_user, "Invalid buffersize provided. Valid values are 1 to 4096 samples.");
 
-	// specialFlags 4: Never clip audio data:
-	if (specialFlags & 4) sflags |= paClipOff;
+	PsychAllocInCharArg(5, kPsychArgOptional, &outputFile);
+	PsychAllocInCharArg(6, kPsychArgOptional, &inputFile);
 
-	// specialFlags 8: Always dither audio data:
-	if (specialFlags & 8) sflags &= ~paDitherOff;
+	PsychCopyInIntegerArg(7, kPsychArgOptional, &realtime);
+	if (realtime < 0 || realtime > 1) PsychErrorExitMsg(PsychError_user, "Invalid 'realtime' flag provided. Must be 0 or 1.");
 
-	// specialFlags 16: Never dither audio data:
-	if (specialFlags & 16) sflags |= paDitherOff;
+	// Create offline stream and its render thread:
+	os = PsychPAOfflineStreamOpen((mode & kPortAudioCapture) ? mynrchannels[1] : 0, (mode & kPortAudioPlayBack) ? mynrchannels[0] : 0, (double) freq,
+								  (unsigned long) buffersize, outputFile, inputFile, realtime, paCallback, &audiodevices[audiodevicecount]);
+	if (NULL == os) PsychErrorExitMsg(PsychError_system, "Failed to open offline render device.");
 
-	// Try to create & open stream:
-	err = Pa_OpenStream(
-            &stream,															/* Return stream pointer here on success. */
-            ((mode & kPortAudioCapture) ?  &inputParameters : NULL),			/* Requested input settings, or NULL in pure playback case. */
-			((mode & kPortAudioPlayBack) ? &outputParameters : NULL),			/* Requested input settings, or NULL in pure playback case. */
-            freq,																/* Requested sampling rate. */
-            buffersize,															/* Requested buffer size. */
-            sflags,																/* Define special stream property flags. */
-            paCallback,															/* Our processing callback. */
-            &audiodevices[audiodevicecount]);									/* Our own device info structure */
-            
-	if(err!=paNoError || stream == NULL) {
-			printf("PTB-ERROR: Failed to open audio device %i. PortAudio reports this error: %s \n", audiodevicecount, Pa_GetErrorText(err));
-			PsychErrorExitMsg(PsychError_system, "Failed to open PortAudio audio device.");
-	}
-	
 	// Setup our final device structure:
 	audiodevices[audiodevicecount].opmode = mode;
-	audiodevices[audiodevicecount].runMode = 1; // Keep engine running by default. Minimal extra cpu-load for significant reduction in startup latency.
-	audiodevices[audiodevicecount].stream = stream;
-	audiodevices[audiodevicecount].streaminfo = Pa_GetStreamInfo(stream);
-	audiodevices[audiodevicecount].hostAPI = Pa_GetHostApiInfo(referenceDevInfo->hostApi)->type;
+	audiodevices[audiodevicecount].runMode = 1;
+	audiodevices[audiodevicecount].stream = (PaStream*) os;
+	audiodevices[audiodevicecount].streaminfo = PsychPAStreamGetInfo((PaStream*) os);
+	audiodevices[audiodevicecount].hostAPI = kPsychPAOfflineHostAPI;
 	audiodevices[audiodevicecount].startTime = 0.0;
 	audiodevices[audiodevicecount].reqStartTime = 0.0;
+	audiodevices[audiodevicecount].triggerPosted = 0;
 	audiodevices[audiodevicecount].reqStopTime = DBL_MAX;
 	audiodevices[audiodevicecount].estStopTime = 0;
 	audiodevices[audiodevicecount].currentTime = 0;		
@@ -2378,8 +5422,8 @@ PsychError PSYCHPORTAUDIOOpen(void)
 	audiodevices[audiodevicecount].schedule_size = 0;
 	audiodevices[audiodevicecount].schedule_pos = 0;
 	audiodevices[audiodevicecount].schedule_writepos = 0;
-	audiodevices[audiodevicecount].outdeviceidx = (audiodevices[audiodevicecount].opmode & kPortAudioPlayBack) ? outputParameters.device : -1;
-	audiodevices[audiodevicecount].indeviceidx  = (audiodevices[audiodevicecount].opmode & kPortAudioCapture)  ? inputParameters.device  : -1;
+	audiodevices[audiodevicecount].outdeviceidx = -1;
+	audiodevices[audiodevicecount].indeviceidx  = -1;
 	audiodevices[audiodevicecount].outputmappings = NULL;
 	audiodevices[audiodevicecount].inputmappings = NULL;
 	audiodevices[audiodevicecount].slaveCount = 0;
@@ -2388,12 +5432,28 @@ PsychError PSYCHPORTAUDIOOpen(void)
 	audiodevices[audiodevicecount].modulatorSlave = -1;
 	audiodevices[audiodevicecount].slaveOutBuffer = NULL;
 	audiodevices[audiodevicecount].slaveGainBuffer = NULL;
+	audiodevices[audiodevicecount].mixerPool = NULL;
+	audiodevices[audiodevicecount].mixerSlaveCost = 0.0;
+	audiodevices[audiodevicecount].mixerMinCost = PSYCH_AUDIO_MIXER_DEFAULT_MINCOST;
+	audiodevices[audiodevicecount].sourceRate = 0.0;
+	audiodevices[audiodevicecount].playbackRate = 1.0;
+	audiodevices[audiodevicecount].resampleQuality = PSYCH_AUDIO_RESAMPLER_DEFAULTQUALITY;
+	audiodevices[audiodevicecount].resampler = NULL;
+	audiodevices[audiodevicecount].resamplePhase = 0.0;
+	audiodevices[audiodevicecount].resampleRatio = 0.0;
+	audiodevices[audiodevicecount].slotSampleRate = 0.0;
+	audiodevices[audiodevicecount].slotFileBuffer = NULL;
+	audiodevices[audiodevicecount].dspActive = NULL;
+	audiodevices[audiodevicecount].dspPending = NULL;
+	audiodevices[audiodevicecount].dspRetired = NULL;
+	audiodevices[audiodevicecount].dspLast = NULL;
+	audiodevices[audiodevicecount].detector = NULL;
 	audiodevices[audiodevicecount].slaveInBuffer = NULL;
 	audiodevices[audiodevicecount].outChannelVolumes = NULL;
 	audiodevices[audiodevicecount].masterVolume = 1.0;
 	audiodevices[audiodevicecount].playposition = 0;
 	audiodevices[audiodevicecount].totalplaycount = 0;
-		
+
 	// If this is a master, create a slave device list and init it to "empty":
 	if (mode & kPortAudioIsMaster) {
 		audiodevices[audiodevicecount].slaves = (int*) malloc(sizeof(int) * MAX_PSYCH_AUDIO_SLAVES_PER_DEVICE);
@@ -2425,36 +5485,13 @@ PsychError PSYCHPORTAUDIOOpen(void)
 	PsychPACreateSignal(&(audiodevices[audiodevicecount]));
 	
 	// Register the stream finished callback:
-	Pa_SetStreamFinishedCallback(audiodevices[audiodevicecount].stream, PAStreamFinishedCallback);
+	PsychPAStreamSetFinishedCallback(audiodevices[audiodevicecount].stream, PAStreamFinishedCallback);
 
-	#if PSYCH_SYSTEM == PSYCH_OSX
-		// Query low-level audio driver of the CoreAudio HAL for hardware latency:
-		// Hmm, maybe not. Don't know if it is worth the hazzle... This is a constant that
-		// doesn't change throughout the lifetime of a machine, and it only makes up for about
-		// 0.3 msecs on a typical setup. Maybe if a user really needs that 0.3 msecs extra
-		// precision, he should simply download the free HALLab from Apple's Website or Developer
-		// tools, run it once, read the displayed constant and set it manually at PortAudio startup.
-		
-		// PaMacCoreStream* corestream = (PaMacCoreStream*) audiodevices[audiodevicecount].stream;
-		// audiodevices[audiodevicecount].latencyBias = 
-	#endif
-	
 	if (verbosity > 3) {
-		printf("PTB-INFO: New audio device with handle %i opened as PortAudio stream:\n",audiodevicecount);
-
-		if (audiodevices[audiodevicecount].opmode & kPortAudioPlayBack) {
-			printf("PTB-INFO: For %i channels Playback: Audio subsystem is %s, Audio device name is ", (int) audiodevices[audiodevicecount].outchannels, Pa_GetHostApiInfo(outputDevInfo->hostApi)->name);
-			printf("%s\n", outputDevInfo->name);
-		}
-
-		if (audiodevices[audiodevicecount].opmode & kPortAudioCapture) {
-			printf("PTB-INFO: For %i channels Capture: Audio subsystem is %s, Audio device name is ", (int) audiodevices[audiodevicecount].inchannels, Pa_GetHostApiInfo(inputDevInfo->hostApi)->name);
-			printf("%s\n", inputDevInfo->name);
-		}
-		
-		printf("PTB-INFO: Real samplerate %f Hz. Input latency %f msecs, Output latency %f msecs.\n",
-				audiodevices[audiodevicecount].streaminfo->sampleRate, audiodevices[audiodevicecount].streaminfo->inputLatency * 1000.0,
-				audiodevices[audiodevicecount].streaminfo->outputLatency * 1000.0);
+		printf("PTB-INFO: New audio device with handle %i opened as offline render device, %s.\n", audiodevicecount, (realtime) ? "paced to realtime" : "rendering as fast as possible");
+		if (mode & kPortAudioPlayBack) printf("PTB-INFO: For %i channels Playback%s%s.\n", mynrchannels[0], (outputFile) ? " into file " : "", (outputFile) ? outputFile : "");
+		if (mode & kPortAudioCapture) printf("PTB-INFO: For %i channels Capture%s%s.\n", mynrchannels[1], (inputFile) ? " from file " : "", (inputFile) ? inputFile : "");
+		printf("PTB-INFO: Simulated samplerate %f Hz, %i frames per buffer.\n", (double) freq, buffersize);
 	}
 
 	// Return device handle:
@@ -2466,6 +5503,98 @@ PsychError PSYCHPORTAUDIOOpen(void)
     return(PsychError_none);	
 }
 
+/* PsychPortAudio('OfflineStatistics') - Return processing statistics of an offline render device.
+ */
+PsychError PSYCHPORTAUDIOOfflineStatistics(void) 
+{
+ 	static char useString[] = "stats = PsychPortAudio('OfflineStatistics', pahandle [, reset=0]);";
+	static char synopsisString[] = 
+		"Return timing statistics of the audio processing of offline render device 'pahandle', as opened via 'OpenOffline', "
+		"for benchmarking. 'pahandle' can also be a slave device of an offline master device, in which case the statistics "
+		"of the master are returned, as all processing of all slaves happens inside the processing of the master.\n"
+		"If 'reset' is set to 1, all statistics are reset after they have been returned.\n"
+		"Returns a struct 'stats' with the following fields:\n"
+		"'Buffers' Number of buffers processed since start or last reset.\n"
+		"'FramesPerBuffer' Number of sample frames per buffer.\n"
+		"'BufferDuration' Duration of one buffer in seconds, ie., the time budget for processing of one buffer on real hardware.\n"
+		"'FramesRendered' Total number of sample frames rendered since the device was opened.\n"
+		"'StreamTime' Current time in the simulated timebase of the device.\n"
+		"'MeanCPUTime', 'MedianCPUTime', 'P99CPUTime' and 'MaxCPUTime' Mean, median, 99th percentile and maximum cpu time "
+		"in seconds spent in audio processing per buffer. Median and percentile are computed over the last "
+		"4096 buffers. On Linux this is the cpu time consumed by the render thread, on other systems it is wall clock time.\n"
+		"'MeanWallTime' and 'MaxWallTime' Mean and maximum wall clock time in seconds spent in audio processing per buffer.\n"
+		"'CPULoad' Total cpu time divided by total duration of the processed sound.\n"
+		"'RealtimeFactor' Total duration of the processed sound divided by the total wall clock time needed for it, "
+		"including file i/o. Values above 1 mean faster than realtime.\n"
+		"'ThreadCPUClock' 1 if cpu times are really cpu times, 0 if they are wall clock times.\n";
+
+	static char seeAlsoString[] = "OpenOffline GetStatus ";	 
+
+	const char *FieldNames[] = { "Buffers", "FramesPerBuffer", "BufferDuration", "FramesRendered", "StreamTime", "MeanCPUTime", "MedianCPUTime", "P99CPUTime",
+								 "MaxCPUTime", "MeanWallTime", "MaxWallTime", "CPULoad", "RealtimeFactor", "ThreadCPUClock" };
+	PsychGenericScriptType *status;
+	PsychPAOfflineStream* os;
+	double timings[PSYCH_AUDIO_OFFLINE_TIMINGS];
+	double bufferDuration, n;
+	int pahandle = -1;
+	int reset = 0;
+	int count;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(2));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(1));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+	if (NULL == (os = PsychPAGetOfflineStream(audiodevices[pahandle].stream))) PsychErrorExitMsg(PsychError_user, "Audio device is not an offline render device opened via 'OpenOffline'.");
+
+	PsychCopyInIntegerArg(2, kPsychArgOptional, &reset);
+
+	bufferDuration = (double) os->framesPerBuffer / os->info.sampleRate;
+
+	// Snapshot statistics:
+	PsychLockMutex(&os->mutex);
+	n = (double) os->statsBuffers;
+	count = (os->statsBuffers < PSYCH_AUDIO_OFFLINE_TIMINGS) ? (int) os->statsBuffers : PSYCH_AUDIO_OFFLINE_TIMINGS;
+	memcpy(timings, os->timings, count * sizeof(double));
+
+	PsychAllocOutStructArray(1, kPsychArgOptional, 1, 14, FieldNames, &status);
+	PsychSetStructArrayDoubleElement("Buffers", 0, n, status);
+	PsychSetStructArrayDoubleElement("FramesPerBuffer", 0, (double) os->framesPerBuffer, status);
+	PsychSetStructArrayDoubleElement("BufferDuration", 0, bufferDuration, status);
+	PsychSetStructArrayDoubleElement("FramesRendered", 0, (double) os->framesRendered, status);
+	PsychSetStructArrayDoubleElement("StreamTime", 0, os->streamTime, status);
+	PsychSetStructArrayDoubleElement("MeanCPUTime", 0, (n > 0) ? os->statsCpuSum / n : 0, status);
+	PsychSetStructArrayDoubleElement("MaxCPUTime", 0, os->statsCpuMax, status);
+	PsychSetStructArrayDoubleElement("MeanWallTime", 0, (n > 0) ? os->statsWallSum / n : 0, status);
+	PsychSetStructArrayDoubleElement("MaxWallTime", 0, os->statsWallMax, status);
+	PsychSetStructArrayDoubleElement("CPULoad", 0, (n > 0) ? os->statsCpuSum / (n * bufferDuration) : 0, status);
+	PsychSetStructArrayDoubleElement("RealtimeFactor", 0, (os->statsElapsed > 0) ? (n * bufferDuration) / os->statsElapsed : 0, status);
+	PsychSetStructArrayDoubleElement("ThreadCPUClock", 0, (PSYCH_SYSTEM == PSYCH_LINUX) ? 1 : 0, status);
+
+	if (reset) {
+		os->statsBuffers = 0;
+		os->statsCpuSum = os->statsCpuMax = 0;
+		os->statsWallSum = os->statsWallMax = 0;
+		os->statsElapsed = 0;
+	}
+	PsychUnlockMutex(&os->mutex);
+
+	// Median and 99th percentile of most recent buffers:
+	qsort(timings, count, sizeof(double), PsychPACompareDoubles);
+	PsychSetStructArrayDoubleElement("MedianCPUTime", 0, (count > 0) ? timings[count / 2] : 0, status);
+	PsychSetStructArrayDoubleElement("P99CPUTime", 0, (count > 0) ? timings[(count * 99) / 100] : 0, status);
+
+	return(PsychError_none);
+}
+
 /* PsychPortAudio('OpenSlave') - Open and initialize a virtual audio slave device.
  */
 PsychError PSYCHPORTAUDIOOpenSlave(void) 
@@ -2749,10 +5878,11 @@ PsychError PSYCHPORTAUDIOOpenSlave(void)
 	audiodevices[audiodevicecount].opmode = mode;
 	audiodevices[audiodevicecount].runMode = 1;
 	audiodevices[audiodevicecount].stream = audiodevices[pamaster].stream;
-	audiodevices[audiodevicecount].streaminfo = Pa_GetStreamInfo(audiodevices[pamaster].stream);
+	audiodevices[audiodevicecount].streaminfo = PsychPAStreamGetInfo(audiodevices[pamaster].stream);
 	audiodevices[audiodevicecount].hostAPI = audiodevices[pamaster].hostAPI;
 	audiodevices[audiodevicecount].startTime = 0.0;
 	audiodevices[audiodevicecount].reqStartTime = 0.0;
+	audiodevices[audiodevicecount].triggerPosted = 0;
 	audiodevices[audiodevicecount].reqStopTime = DBL_MAX;
 	audiodevices[audiodevicecount].estStopTime = 0;
 	audiodevices[audiodevicecount].currentTime = 0;		
@@ -2778,6 +5908,22 @@ PsychError PSYCHPORTAUDIOOpenSlave(void)
 	audiodevices[audiodevicecount].modulatorSlave = -1;	
 	audiodevices[audiodevicecount].slaveOutBuffer = NULL;
 	audiodevices[audiodevicecount].slaveGainBuffer = NULL;
+	audiodevices[audiodevicecount].mixerPool = NULL;
+	audiodevices[audiodevicecount].mixerSlaveCost = 0.0;
+	audiodevices[audiodevicecount].mixerMinCost = PSYCH_AUDIO_MIXER_DEFAULT_MINCOST;
+	audiodevices[audiodevicecount].sourceRate = 0.0;
+	audiodevices[audiodevicecount].playbackRate = 1.0;
+	audiodevices[audiodevicecount].resampleQuality = PSYCH_AUDIO_RESAMPLER_DEFAULTQUALITY;
+	audiodevices[audiodevicecount].resampler = NULL;
+	audiodevices[audiodevicecount].resamplePhase = 0.0;
+	audiodevices[audiodevicecount].resampleRatio = 0.0;
+	audiodevices[audiodevicecount].slotSampleRate = 0.0;
+	audiodevices[audiodevicecount].slotFileBuffer = NULL;
+	audiodevices[audiodevicecount].dspActive = NULL;
+	audiodevices[audiodevicecount].dspPending = NULL;
+	audiodevices[audiodevicecount].dspRetired = NULL;
+	audiodevices[audiodevicecount].dspLast = NULL;
+	audiodevices[audiodevicecount].detector = NULL;
 	audiodevices[audiodevicecount].slaveInBuffer = NULL;
 	audiodevices[audiodevicecount].masterVolume = 1.0;
 	audiodevices[audiodevicecount].playposition = 0;
@@ -2987,6 +6133,9 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
 		// Seems so. Double check:
 		inbuffer = PsychPAGetAudioBuffer(inbufferhandle);
 		
+		// File backed buffer needs to be completely available for copy:
+		PsychPADecodeFileBufferFully(inbuffer->filebuffer);
+
 		// Assign properties:
 		inchannels = inbuffer->outchannels;
 		insamples  = inbuffer->outputbuffersize / sizeof(float) / inchannels;
@@ -3043,8 +6192,10 @@ PsychError PSYCHPORTAUDIOFillAudioBuffer(void)
 			if (audiodevices[pahandle].outputbuffer==NULL) PsychErrorExitMsg(PsychError_outofMemory, "Out of system memory when trying to allocate audio buffer.");
 		}
 		
-		// Reset play position:
+		// Reset play position, including fractional position of the resampler:
 		audiodevices[pahandle].playposition = 0;
+		audiodevices[pahandle].resamplePhase = 0.0;
+		audiodevices[pahandle].resampleRatio = 0.0;
 		
 		outdata = audiodevices[pahandle].outputbuffer;
 		if (indata || userfloat) {
@@ -3291,6 +6442,9 @@ PsychError PSYCHPORTAUDIORefillBuffer(void)
 			printf("PsychPortAudio-ERROR: Audio channel count %i of audiobuffer with handle %i doesn't match channel count %i of audio device!\n", buffer->outchannels, bufferhandle, audiodevices[pahandle].outchannels);
 			PsychErrorExitMsg(PsychError_user, "Target audio buffer 'bufferHandle' has an audio channel count that doesn't match channels of audio device!");
 		}
+
+		// Decode a file backed buffer completely, so the read-ahead thread can't overwrite the refilled data later on:
+		PsychPADecodeFileBufferFully(buffer->filebuffer);
 	}
 
 	// Bufferhandle instead of input data matrix provided?
@@ -3298,6 +6452,9 @@ PsychError PSYCHPORTAUDIORefillBuffer(void)
 		// Seems so. Double check:
 		inbuffer = PsychPAGetAudioBuffer(inbufferhandle);
 		
+		// File backed buffer needs to be completely available for copy:
+		PsychPADecodeFileBufferFully(inbuffer->filebuffer);
+
 		// Assign properties:
 		inchannels = inbuffer->outchannels;
 		insamples = inbuffer->outputbuffersize / sizeof(float) / inchannels;
@@ -3461,7 +6618,7 @@ PsychError PSYCHPORTAUDIODeleteBuffer(void)
  */
 PsychError PSYCHPORTAUDIOCreateBuffer(void) 
 {
- 	static char useString[] = "bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata);";
+ 	static char useString[] = "bufferhandle = PsychPortAudio('CreateBuffer' [, pahandle], bufferdata [, sampleRate]);";
 	static char synopsisString[] = 
 		"Create a new dynamic audio data playback buffer for a PortAudio audio device and fill it with initial data.\n"
 		"Return a 'bufferhandle' to the new buffer. 'pahandle' is the optional handle of the device "
@@ -3476,12 +6633,16 @@ PsychError PSYCHPORTAUDIOCreateBuffer(void)
 		"You can attach the buffer to an audio playback schedule for actual audio playback via the "
 		"PsychPortAudio('AddToSchedule') call.\n"
 		"The same buffer can be attached to and used by multiple audio devices simultaneously, or multiple "
-		"times within one or more playback schedules. ";
+		"times within one or more playback schedules.\n"
+		"'sampleRate' is the optional samplerate of the sound data in Hz. By default it is assumed to be the "
+		"samplerate of the device which plays it. If it is different, regular and slave devices will resample the "
+		"sound data during playback from a schedule, see PsychPortAudio('Resampling') for details. ";
 
-	static char seeAlsoString[] = "Open FillBuffer GetStatus ";	 
+	static char seeAlsoString[] = "Open FillBuffer GetStatus Resampling ";	 
   	
 	PsychPABuffer* buffer;
 	psych_int64 inchannels, insamples, p;
+	double sampleRate = 0;
 	size_t buffersize, outbuffersize;
 	double*	indata = NULL;
 	float* indatafloat = NULL;
@@ -3493,13 +6654,17 @@ PsychError PSYCHPORTAUDIOCreateBuffer(void)
 	PsychPushHelp(useString, synopsisString, seeAlsoString);
 	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
 	
-	PsychErrorExit(PsychCapNumInputArgs(2));     // The maximum number of inputs
+	PsychErrorExit(PsychCapNumInputArgs(3));     // The maximum number of inputs
 	PsychErrorExit(PsychRequireNumInputArgs(0)); // The required number of inputs	
 	PsychErrorExit(PsychCapNumOutputArgs(1));	 // The maximum number of outputs
 
 	// Make sure PortAudio is online:
 	PsychPortAudioInitialize();
 
+	// Get optional samplerate of the sound data:
+	PsychCopyInDoubleArg(3, kPsychArgOptional, &sampleRate);
+	if (sampleRate < 0 || sampleRate > 1e6) PsychErrorExitMsg(PsychError_user, "Invalid 'sampleRate' provided. Must be zero for device samplerate, or a positive value of at most 1 MHz.");
+
 	// Get data matrix with initial buffer content:
 	if (!PsychAllocInDoubleMatArg64(2, kPsychArgAnything, &inchannels, &insamples, &p, &indata)) {
 		// Or regular float matrix instead:
@@ -3528,6 +6693,7 @@ PsychError PSYCHPORTAUDIOCreateBuffer(void)
 	
 	// Deref bufferHandle:
 	buffer = PsychPAGetAudioBuffer(bufferhandle);
+	buffer->sampleRate = sampleRate;
 	outdata = buffer->outputbuffer;
 	outbuffersize = buffer->outputbuffersize;
 	buffersize = sizeof(float) * (size_t) inchannels * (size_t) insamples;
@@ -3553,6 +6719,203 @@ PsychError PSYCHPORTAUDIOCreateBuffer(void)
 	return(PsychError_none);
 }
 
+/* PsychPortAudio('CreateBufferFromFile') - Create dynamic audio outputbuffer backed by a sound file.
+ */
+PsychError PSYCHPORTAUDIOCreateBufferFromFile(void) 
+{
+ 	static char useString[] = "[bufferhandle, nrFrames, sampleRate] = PsychPortAudio('CreateBufferFromFile' [, pahandle], filename [, nrChannels][, sampleFormat='float32'][, dataOffset=0][, readAheadFrames]);";
+	//							  1				2		  3																 1			 2			  3				 4							5				 6
+	static char synopsisString[] = 
+		"Create a new dynamic audio data playback buffer whose content is streamed from the sound file 'filename'.\n"
+		"Return a 'bufferhandle' to the new buffer, the number of sample frames 'nrFrames' in the buffer, and the "
+		"samplerate 'sampleRate' stored in the file, or NaN if the file doesn't store a samplerate. The buffer "
+		"can be used anywhere a buffer created via 'CreateBuffer' can be used, e.g., in 'AddToSchedule', and "
+		"is deleted via 'DeleteBuffer'.\n"
+		"The file is not loaded into memory, but memory mapped, and only the parts of it that get played are "
+		"read from disk. A read-ahead thread follows the playback position of all playing buffers and reads "
+		"'readAheadFrames' sample frames ahead of it, so the realtime audio processing never has to wait for "
+		"the disk. The start of the buffer, and the start of the playloop of each 'AddToSchedule' slot which "
+		"uses the buffer, are read ahead immediately. This allows playback of sounds much larger than available "
+		"system memory and avoids long load times, e.g., for long continuous sound tracks.\n"
+		"'pahandle' is the optional handle of a device to validate the channel count and samplerate of the file against.\n"
+		"The file can be a WAV file with 16 bit integer or 32 bit float samples. Its channel count, sample format "
+		"and samplerate are detected automatically. Any other file is treated as a raw file with interleaved samples "
+		"for 'nrChannels' channels (default 1) in the native byte order of the machine, of the 'sampleFormat' "
+		"'float32' (default) or 'int16', starting 'dataOffset' bytes (default 0) into the file.\n"
+		"32 bit float samples at a file offset which is a multiple of 4 bytes are used directly from the mapped "
+		"file without any copy, so they must already be in the range -1.0 to +1.0. All other files are decoded "
+		"into float samples by the read-ahead thread. Decoded sound data behind the playback position is released "
+		"again, so memory consumption for decoding stays bounded by the read-ahead windows of the playing slots.\n"
+		"If playback reaches sound data which is not yet decoded, e.g., because the disk is too slow, this is "
+		"counted as an underrun in the 'XRuns' count of the device, as reported by 'GetStatus'.\n"
+		"'readAheadFrames' is the size of the read-ahead window in sample frames. It defaults to 2 seconds worth "
+		"of sound at the samplerate of a WAV file, or to 96000 frames for raw files.\n"
+		"Using a file backed buffer as source of a 'FillBuffer' or 'RefillBuffer' call, or as target of a "
+		"'RefillBuffer' call, will read and decode the whole file at once, and keep it decoded in memory until the "
+		"buffer is deleted. 'RefillBuffer' never modifies the file itself.\n";
+
+	static char seeAlsoString[] = "CreateBuffer DeleteBuffer AddToSchedule ";	 
+  	
+	char* filename = NULL;
+	char* formatname = NULL;
+	int pahandle = -1;
+	int bufferhandle = 0;
+	int nrChannels = 1;
+	int sampleformat = 0;
+	double dataOffset = 0;
+	double readAheadFrames = 0;
+	double sampleRate;
+	PsychPABuffer* buffer;
+	
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(6));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(2)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(3));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	// Validate optional pahandle:
+	if (PsychCopyInIntegerArg(1, kPsychArgOptional, &pahandle)) {
+		if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+		if ((audiodevices[pahandle].opmode & kPortAudioPlayBack) == 0) PsychErrorExitMsg(PsychError_user, "Audio device has not been opened for audio playback, so this call doesn't make sense.");
+	}
+
+	PsychAllocInCharArg(2, kPsychArgRequired, &filename);
+
+	PsychCopyInIntegerArg(3, kPsychArgOptional, &nrChannels);
+	if (nrChannels < 1 || nrChannels > MAX_PSYCH_AUDIO_CHANNELS_PER_DEVICE) PsychErrorExitMsg(PsychError_user, "Invalid 'nrChannels' provided.");
+
+	if (PsychAllocInCharArg(4, kPsychArgOptional, &formatname)) {
+		if (!strcmp(formatname, "float32")) {
+			sampleformat = 0;
+		}
+		else if (!strcmp(formatname, "int16")) {
+			sampleformat = 1;
+		}
+		else PsychErrorExitMsg(PsychError_user, "Invalid 'sampleFormat' provided. Must be 'float32' or 'int16'.");
+	}
+
+	PsychCopyInDoubleArg(5, kPsychArgOptional, &dataOffset);
+	if (dataOffset < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'dataOffset' provided. Must be greater or equal to zero.");
+
+	PsychCopyInDoubleArg(6, kPsychArgOptional, &readAheadFrames);
+	if (readAheadFrames < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'readAheadFrames' provided. Must be greater or equal to zero.");
+
+	// Create buffer and assign bufferhandle:
+	bufferhandle = PsychPACreateFileAudioBuffer(filename, (psych_int64) nrChannels, sampleformat, (psych_int64) dataOffset, (psych_int64) readAheadFrames, &sampleRate);
+	buffer = PsychPAGetAudioBuffer(bufferhandle);
+
+	if (pahandle >= 0) {
+		if (buffer->outchannels != audiodevices[pahandle].outchannels) {
+			printf("PTB-ERROR: Audio device %i has %i output channels, but sound file has non-matching number of %i channels.\n", pahandle, (int) audiodevices[pahandle].outchannels, (int) buffer->outchannels);
+			PsychPADeleteAudioBuffer(bufferhandle, 0);
+			PsychErrorExitMsg(PsychError_user, "Number of channels of sound file doesn't match number of output channels of selected audio device.\n");
+		}
+
+		if ((verbosity > 2) && (sampleRate > 0) && (sampleRate != audiodevices[pahandle].streaminfo->sampleRate)) {
+			printf("PTB-INFO: PsychPortAudio('CreateBufferFromFile'): Samplerate %f Hz of sound file '%s' doesn't match samplerate %f Hz\n", sampleRate, filename, audiodevices[pahandle].streaminfo->sampleRate);
+			printf("PTB-INFO: of audio device %i. The sound will be resampled when played from a schedule on this device.\n", pahandle);
+		}
+	}
+
+	// Return bufferhandle, size and samplerate:
+	PsychCopyOutDoubleArg(1, FALSE, (double) bufferhandle);
+	PsychCopyOutDoubleArg(2, FALSE, (double) (buffer->outputbuffersize / sizeof(float) / buffer->outchannels));
+	PsychCopyOutDoubleArg(3, FALSE, sampleRate);
+
+	// Done.
+	return(PsychError_none);
+}
+
+/* PsychPAConvertCapturedSamples() - Convert 'n' float samples from 'in' into the output matrix.
+ *
+ * Stores at sample offset 'outoffset' into whichever of 'outdouble', 'outfloat' or
+ * 'outint16' is non-NULL. int16 samples are clamped to the valid range.
+ */
+static void PsychPAConvertCapturedSamples(const float* in, psych_int64 n, psych_int64 outoffset, double* outdouble, float* outfloat, psych_int16* outint16)
+{
+	psych_int64 i;
+	float v;
+
+	if (outfloat) {
+		memcpy(outfloat + outoffset, in, (size_t) n * sizeof(float));
+	}
+	else if (outdouble) {
+		outdouble += outoffset;
+		for (i = 0; i < n; i++) outdouble[i] = (double) in[i];
+	}
+	else {
+		outint16 += outoffset;
+		for (i = 0; i < n; i++) {
+			v = in[i];
+			v = (v > 1.0f) ? 1.0f : ((v < -1.0f) ? -1.0f : v);
+			outint16[i] = (psych_int16) floorf(v * 32767.0f + 0.5f);
+		}
+	}
+
+	return;
+}
+
+/* PsychPACopyOutCapturedFrames() - Copy captured sound out of the capture ringbuffer of a device.
+ *
+ * Copies 'nframes' output sample frames, starting at absolute sample 'startsample' of the
+ * capture ringbuffer of 'dev', into the output matrix, see PsychPAConvertCapturedSamples().
+ * Each output frame is the average of 'decimation' consecutive captured frames. The ringbuffer
+ * is walked in contiguous segments without wraparound, so the inner loops are simple
+ * sequential loops, without a modulo per sample.
+ */
+static void PsychPACopyOutCapturedFrames(PsychPADevice* dev, psych_int64 startsample, psych_int64 nframes, int decimation, double* outdouble, float* outfloat, psych_int16* outint16)
+{
+	double acc[MAX_PSYCH_AUDIO_CHANNELS_PER_DEVICE];
+	float avg[MAX_PSYCH_AUDIO_CHANNELS_PER_DEVICE];
+	psych_int64 ringsize = (psych_int64) (dev->inputbuffersize / sizeof(float));
+	psych_int64 inchannels = (psych_int64) dev->inchannels;
+	psych_int64 nsamples = nframes * decimation * inchannels;
+	psych_int64 done = 0, outpos = 0, readpos, segment, i, c;
+	const float* in;
+	int count = 0;
+
+	if (nsamples <= 0 || ringsize <= 0) return;
+	for (c = 0; c < inchannels; c++) acc[c] = 0;
+
+	while (done < nsamples) {
+		// Contiguous segment up to the end of the ringbuffer or the end of the request:
+		readpos = (startsample + done) % ringsize;
+		segment = ringsize - readpos;
+		if (segment > nsamples - done) segment = nsamples - done;
+		in = &(dev->inputbuffer[readpos]);
+
+		if (decimation == 1) {
+			PsychPAConvertCapturedSamples(in, segment, outpos, outdouble, outfloat, outint16);
+			outpos += segment;
+		}
+		else {
+			// Box-filter 'decimation' frames into one. The ringbuffer holds whole frames and
+			// 'startsample' is frame aligned, so segments always start at a frame boundary:
+			for (i = 0; i < segment; i += inchannels) {
+				for (c = 0; c < inchannels; c++) acc[c] += (double) in[i + c];
+				if (++count == decimation) {
+					for (c = 0; c < inchannels; c++) {
+						avg[c] = (float) (acc[c] / (double) decimation);
+						acc[c] = 0;
+					}
+					PsychPAConvertCapturedSamples(avg, inchannels, outpos, outdouble, outfloat, outint16);
+					outpos += inchannels;
+					count = 0;
+				}
+			}
+		}
+
+		done += segment;
+	}
+
+	return;
+}
+
 /* PsychPortAudio('GetAudioData') - Retrieve captured audio data.
  */
 PsychError PSYCHPORTAUDIOGetAudioData(void) 
@@ -3790,43 +7153,173 @@ PsychError PSYCHPORTAUDIOGetAudioData(void)
 	// Copy out absolute sample read position of first sample in buffer:
 	PsychCopyOutDoubleArg(2, FALSE, (double) (audiodevices[pahandle].readposition / audiodevices[pahandle].inchannels));
 
-	// Copy the data, convert it from float to double: Take ringbuffer wraparound into account:
-	if (indatafloat) {
-		// Copy to float/single matrix:
-		while(buffersize > 0) {
-			// Fetch next sample and copy it to matrix:
-			*(indatafloat++) = (float) audiodevices[pahandle].inputbuffer[(audiodevices[pahandle].readposition % (audiodevices[pahandle].inputbuffersize / sizeof(float)))];
-			
-			// Update sample read counter:
-			audiodevices[pahandle].readposition++;
-			
-			// Decrement copy counter:
-			buffersize-=sizeof(float);
-		}
+	// Copy the data, convert it from float to double if needed: Take ringbuffer wraparound into account:
+	insamples = (psych_int64) (buffersize / sizeof(float));
+	PsychPACopyOutCapturedFrames(&audiodevices[pahandle], audiodevices[pahandle].readposition, insamples / audiodevices[pahandle].inchannels, 1, indata, indatafloat, NULL);
+
+	// Update sample read counter:
+	audiodevices[pahandle].readposition += insamples;
+	
+	// Copy out overrun flag:
+	PsychCopyOutDoubleArg(3, FALSE, (double) overrun);
+
+	// Return capture timestamp in system time of first captured sample in this session. This is a bit problematic:
+	// In full-duplex mode, at least OS/X doesn't return separate timestamps, so we'll provide the playback onset time
+	// instead - the best we can do. In pure capture mode we get a capture timestamp...
+	PsychCopyOutDoubleArg(4, FALSE, (audiodevices[pahandle].captureStartTime > 0) ? audiodevices[pahandle].captureStartTime : audiodevices[pahandle].startTime);
+	
+	// Buffer ready.
+	return(PsychError_none);
+}
+
+/* PsychPortAudio('GetAudioDataRange') - Retrieve a specific time window of captured audio data.
+ */
+PsychError PSYCHPORTAUDIOGetAudioDataRange(void) 
+{
+ 	static char useString[] = "[audiodata, absrecposition, firsttime] = PsychPortAudio('GetAudioDataRange', pahandle, rangeStart, rangeEnd [, units=0][, decimation=1][, dataType=0][, peek=1]);";
+	static char synopsisString[] = 
+		"Retrieve a specific range of captured audio data from the capture buffer of audio device 'pahandle'.\n"
+		"Unlike 'GetAudioData', which always returns all newly captured sound, this function returns the sound "
+		"captured within a given time window or sample range, e.g., the last 200 msecs before and after a "
+		"voice onset detected by PsychPortAudio('CaptureDetector'). The internal capture buffer must have been "
+		"allocated via PsychPortAudio('GetAudioData') beforehand, and only sound which is still stored in that "
+		"buffer can be returned, so the buffer must be big enough to hold the range of interest.\n"
+		"'rangeStart' and 'rangeEnd' define the range of sound to return. If 'units' is 0, the default, they are "
+		"times in system time, as returned by GetSecs(), and sound captured at or after 'rangeStart' and before "
+		"'rangeEnd' is returned, based on the 'cstarttime' capture timestamp of the session. If 'units' is 1, they "
+		"are absolute sample frame indices, counted from zero for the first captured frame of the session, as "
+		"returned by 'absrecposition' of 'GetAudioData', with 'rangeEnd' excluded from the returned range.\n"
+		"The range is clamped to the sound which is available: Parts which are not captured yet, and parts which "
+		"are already overwritten in the buffer or are about to be, are left out. Check the 'absrecposition' and "
+		"size of the returned matrix to find out which part of the requested range was returned.\n"
+		"'decimation' optional integer decimation factor: Each returned sample frame is the average of that many "
+		"captured frames, for a returned samplerate of the device samplerate divided by 'decimation'. Defaults to 1 "
+		"for no decimation. The averaging is only a simple box filter. Use 'DspBiquads' or a proper lowpass filter "
+		"in your script if aliasing of high frequencies would be a problem.\n"
+		"'dataType' optional type of the returned matrix: 0 = double() type, the default, 1 = single() type, "
+		"2 = int16() type, with samples scaled to the range -32767 to +32767.\n"
+		"'peek' if set to 1, the default, the data is only looked at, and the read position of 'GetAudioData' is not "
+		"changed, so 'GetAudioData' will still return all sound. If set to 0, the read position is advanced to the end of "
+		"the returned range, if it is not already beyond it, so 'GetAudioData' will only return sound captured after "
+		"that range.\n"
+		"'audiodata' is the matrix of returned sound, with one row per channel and one column per sample frame.\n"
+		"'absrecposition' is the absolute sample frame index of the first returned frame, as with 'GetAudioData'.\n"
+		"'firsttime' is the estimated capture time in system time of the first returned frame.\n";
+
+	static char seeAlsoString[] = "GetAudioData CaptureDetector GetCaptureEvents ";	 
+
+	PsychPADevice* dev;
+	psych_int64 ringframes, recframes, oldestframe, startframe, endframe, nframes;
+	double rangeStart, rangeEnd, startpos, endpos, sampleRate, t0;
+	double*	outdouble = NULL;
+	float* outfloat = NULL;
+	psych_int16* outint16 = NULL;
+	int pahandle = -1;
+	int units = 0;
+	int decimation = 1;
+	int dataType = 0;
+	int peek = 1;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+
+	PsychErrorExit(PsychCapNumInputArgs(7));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(3)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(3));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+	if ((audiodevices[pahandle].opmode & kPortAudioCapture) == 0) PsychErrorExitMsg(PsychError_user, "Audio device has not been opened for audio capture, so this call doesn't make sense.");
+	dev = &audiodevices[pahandle];
+
+	if (dev->inputbuffersize == 0) PsychErrorExitMsg(PsychError_user, "No capture buffer allocated. You must first call PsychPortAudio('GetAudioData') to allocate it!");
+
+	PsychCopyInDoubleArg(2, kPsychArgRequired, &rangeStart);
+	PsychCopyInDoubleArg(3, kPsychArgRequired, &rangeEnd);
+	if (!(rangeEnd >= rangeStart)) PsychErrorExitMsg(PsychError_user, "Invalid range: 'rangeEnd' must not be smaller than 'rangeStart', and neither must be NaN.");
+
+	PsychCopyInIntegerArg(4, kPsychArgOptional, &units);
+	if (units < 0 || units > 1) PsychErrorExitMsg(PsychError_user, "Invalid 'units' provided. Must be 0 for seconds or 1 for sample frames.");
+
+	PsychCopyInIntegerArg(5, kPsychArgOptional, &decimation);
+	if (decimation < 1) PsychErrorExitMsg(PsychError_user, "Invalid 'decimation' provided. Must be 1 or greater.");
+
+	PsychCopyInIntegerArg(6, kPsychArgOptional, &dataType);
+	if (dataType < 0 || dataType > 2) PsychErrorExitMsg(PsychError_user, "Invalid 'dataType' provided. Must be 0 for double, 1 for single or 2 for int16.");
+
+	PsychCopyInIntegerArg(7, kPsychArgOptional, &peek);
+	if (peek < 0 || peek > 1) PsychErrorExitMsg(PsychError_user, "'peek' flag must be zero or one!");
+
+	sampleRate = (double) dev->streaminfo->sampleRate;
+	ringframes = (psych_int64) (dev->inputbuffersize / sizeof(float)) / dev->inchannels;
+
+	// The engine is potentially running, so we need to mutex-lock our accesses:
+	PsychPALockDeviceMutex(dev);
+
+	// Never fetch the last sampleframe while the engine is running, as it may be incomplete,
+	// same as in 'GetAudioData':
+	recframes = dev->recposition / dev->inchannels;
+	if (dev->state > 0) recframes--;
+
+	// Leave one host buffer of headroom at the old end of the ringbuffer while running, as
+	// those frames could get overwritten by the engine while we copy them out:
+	oldestframe = recframes - ringframes + ((dev->state > 0) ? dev->batchsize : 0);
+
+	t0 = (dev->captureStartTime > 0) ? dev->captureStartTime : dev->startTime;
+
+	PsychPAUnlockDeviceMutex(dev);
+
+	if (recframes < 0) recframes = 0;
+	if (oldestframe < 0) oldestframe = 0;
+
+	// Map requested range to absolute frame positions:
+	if (units == 0) {
+		if (t0 <= 0) PsychErrorExitMsg(PsychError_user, "No capture timestamp available yet, because capture hasn't started yet. Can't map times to sample frames.");
+		startpos = floor((rangeStart - t0) * sampleRate + 0.5);
+		endpos = floor((rangeEnd - t0) * sampleRate + 0.5);
 	}
 	else {
-		// Copy to double matrix:
-		while(buffersize > 0) {
-			// Fetch next sample and copy it to matrix:
-			*(indata++) = (double) audiodevices[pahandle].inputbuffer[(audiodevices[pahandle].readposition % (audiodevices[pahandle].inputbuffersize / sizeof(float)))];
-			
-			// Update sample read counter:
-			audiodevices[pahandle].readposition++;
-			
-			// Decrement copy counter:
-			buffersize-=sizeof(float);
-		}
+		startpos = floor(rangeStart);
+		endpos = floor(rangeEnd);
+	}
+
+	// Clamp to what is available, before conversion to frame indices, so huge or infinite values can't overflow:
+	if (startpos < (double) oldestframe) startpos = (double) oldestframe;
+	if (startpos > (double) recframes) startpos = (double) recframes;
+	if (endpos < (double) oldestframe) endpos = (double) oldestframe;
+	if (endpos > (double) recframes) endpos = (double) recframes;
+	startframe = (psych_int64) startpos;
+	endframe = (psych_int64) endpos;
+	nframes = (endframe > startframe) ? (endframe - startframe) / decimation : 0;
+
+	switch (dataType) {
+		case 0:
+			PsychAllocOutDoubleMatArg(1, FALSE, dev->inchannels, nframes, 1, &outdouble);
+		break;
+
+		case 1:
+			PsychAllocOutFloatMatArg(1, FALSE, dev->inchannels, nframes, 1, &outfloat);
+		break;
+
+		case 2:
+			PsychAllocOutInt16MatArg(1, FALSE, dev->inchannels, nframes, 1, &outint16);
+		break;
 	}
-	
-	// Copy out overrun flag:
-	PsychCopyOutDoubleArg(3, FALSE, (double) overrun);
 
-	// Return capture timestamp in system time of first captured sample in this session. This is a bit problematic:
-	// In full-duplex mode, at least OS/X doesn't return separate timestamps, so we'll provide the playback onset time
-	// instead - the best we can do. In pure capture mode we get a capture timestamp...
-	PsychCopyOutDoubleArg(4, FALSE, (audiodevices[pahandle].captureStartTime > 0) ? audiodevices[pahandle].captureStartTime : audiodevices[pahandle].startTime);
-	
-	// Buffer ready.
+	PsychPACopyOutCapturedFrames(dev, startframe * dev->inchannels, nframes, decimation, outdouble, outfloat, outint16);
+
+	// Advance the read position of 'GetAudioData' if this isn't a peek:
+	if (!peek && (dev->readposition < (startframe + nframes * decimation) * dev->inchannels)) {
+		dev->readposition = (startframe + nframes * decimation) * dev->inchannels;
+	}
+
+	PsychCopyOutDoubleArg(2, FALSE, (double) startframe);
+	PsychCopyOutDoubleArg(3, FALSE, t0 + ((double) startframe) / sampleRate);
+
 	return(PsychError_none);
 }
 
@@ -3916,7 +7409,7 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
 	}
 
 	// Audio engine running? That is the minimum requirement for this function to work:
-	if (!Pa_IsStreamActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Audio device not started. You need to call the 'Start' function first!");
+	if (!PsychPAStreamIsActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Audio device not started. You need to call the 'Start' function first!");
 
 	// Lock the device:
 	PsychPALockDeviceMutex(&audiodevices[pahandle]);
@@ -3964,17 +7457,23 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
 	// Reset recorded samples counter:
 	audiodevices[pahandle].recposition = 0;
 
+	// Reset capture event detector, as it counts samples since start of capture:
+	if (audiodevices[pahandle].detector) PsychPAResetDetector(audiodevices[pahandle].detector);
+
 	// Reset read samples counter: This will discard possibly not yet fetched data.
 	audiodevices[pahandle].readposition = 0;
 
-	// Reset play position:
+	// Reset play position, including fractional position of the resampler:
 	audiodevices[pahandle].playposition = 0;
+	audiodevices[pahandle].resamplePhase = 0.0;
+	audiodevices[pahandle].resampleRatio = 0.0;
 	
 	// Reset total count of played out samples:
 	audiodevices[pahandle].totalplaycount = 0;
 	
-	// Setup new rescheduled target start time:
+	// Setup new rescheduled target start time, discarding any stale trigger from a capture event detector:
 	audiodevices[pahandle].reqStartTime = when;
+	audiodevices[pahandle].triggerPosted = 0;
 
 	if (audiodevices[pahandle].runMode == 1) {
 		// Set the state to hot-standby to actually make this scheduling request active:
@@ -3983,7 +7482,7 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
 
 	// Safety check for deadlock avoidance with waiting slaves:
 	if ((waitForStart > 0) && (audiodevices[pahandle].opmode & kPortAudioIsSlave) &&
-		(!Pa_IsStreamActive(audiodevices[pahandle].stream) || Pa_IsStreamStopped(audiodevices[pahandle].stream) ||
+		(!PsychPAStreamIsActive(audiodevices[pahandle].stream) || PsychPAStreamIsStopped(audiodevices[pahandle].stream) ||
 		 audiodevices[audiodevices[pahandle].pamaster].state < 1)) {
 		// We are a slave that shall wait for start, but the master audio device hasn't even
 		// started its engine. This looks like a deadlock to avoid:
@@ -3997,7 +7496,7 @@ PsychError PSYCHPORTAUDIORescheduleStart(void)
 		// Wait for real start of device: We enter the first while() loop iteration with
 		// the device lock still held from above, so the while() loop will iterate at
 		// least once...
-		while (audiodevices[pahandle].state == 1 && Pa_IsStreamActive(audiodevices[pahandle].stream)) {
+		while (audiodevices[pahandle].state == 1 && PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
 			// Wait for a state-change before reevaluating the .state:
 			PsychPAWaitForChange(&audiodevices[pahandle]);
 		}
@@ -4113,16 +7612,19 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 	// Make sure current state is zero, aka fully stopped and engine is really stopped: Output a warning if this looks like an
 	// unintended "too early" restart: [No need to mutex-lock here, as iff these .state setting is not met,
 	// then we are good and they can't change by themselves behind our back -- paCallback() can't change .state to > 0]
-	if ((audiodevices[pahandle].state > 0) && Pa_IsStreamActive(audiodevices[pahandle].stream)) {
+	if ((audiodevices[pahandle].state > 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
 		if (verbosity > 1) {
 			printf("PsychPortAudio-WARNING: 'Start' method on audiodevice %i called, although playback on device not yet completely stopped.\nWill forcefully restart with possible audible artifacts or timing glitches.\nCheck your playback timing or use the 'Stop' function properly!\n", pahandle);
 		}
 	}
 
 	// Safeguard: If the stream is not stopped in runMode 0, do it now:
-	if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) {
-		if (audiodevices[pahandle].runMode == 0) Pa_StopStream(audiodevices[pahandle].stream);
+	if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) {
+		if (audiodevices[pahandle].runMode == 0) PsychPAStreamStop(audiodevices[pahandle].stream);
 	}
+
+	// Make sure a suitable resampler is ready if sample rate conversion is needed:
+	PsychPAUpdateResampler(&audiodevices[pahandle]);
 	
 	// Mutex-lock here: Needed if engine already/still running in runMode1, doesn't hurt if engine is stopped
 	PsychPALockDeviceMutex(&audiodevices[pahandle]);
@@ -4142,11 +7644,21 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 	// Reset recorded samples counter:
 	audiodevices[pahandle].recposition = 0;
 
+	// Reset capture event detector, as it counts samples since start of capture:
+	if (audiodevices[pahandle].detector) PsychPAResetDetector(audiodevices[pahandle].detector);
+
 	// Reset read samples counter: This will discard possibly not yet fetched data.
 	audiodevices[pahandle].readposition = 0;
 
-	// Reset play position:
-	if (!resume) audiodevices[pahandle].playposition = 0;
+	// Reset play position, including fractional position of the resampler:
+	if (!resume) {
+		audiodevices[pahandle].playposition = 0;
+		audiodevices[pahandle].resamplePhase = 0.0;
+		audiodevices[pahandle].resampleRatio = 0.0;
+
+		// Start effect chain from silence, without reverb tails etc. from previous playback:
+		if (audiodevices[pahandle].dspActive) PsychPADspResetState(audiodevices[pahandle].dspActive->state);
+	}
 	
 	// Reset total count of played out samples:
 	if (!resume) audiodevices[pahandle].totalplaycount = 0;
@@ -4157,15 +7669,16 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 	// Reset any pending requests:
 	audiodevices[pahandle].reqstate = 255;
 
-	// Setup target start time:
+	// Setup target start time, discarding any stale trigger from a capture event detector:
 	audiodevices[pahandle].reqStartTime = when;
+	audiodevices[pahandle].triggerPosted = 0;
 
 	// Mark state as "hot-started":
 	audiodevices[pahandle].state = 1;
 
 	if (!(audiodevices[pahandle].opmode & kPortAudioIsSlave)) {
 		// Engine running?
-		if (!Pa_IsStreamActive(audiodevices[pahandle].stream) || Pa_IsStreamStopped(audiodevices[pahandle].stream)) {
+		if (!PsychPAStreamIsActive(audiodevices[pahandle].stream) || PsychPAStreamIsStopped(audiodevices[pahandle].stream)) {
 			// Try to start stream if the engine isn't running, either because it is the very
 			// first call to 'Start' in any runMode, or because the engine got stopped in
 			// preparation for a restart in runMode zero. Need to drop the lock during
@@ -4173,10 +7686,10 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 			PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
 			
 			// Safeguard: If the stream is not stopped, do it now:
-			if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) Pa_StopStream(audiodevices[pahandle].stream);
+			if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) PsychPAStreamStop(audiodevices[pahandle].stream);
 			
 			// Start engine:
-			if ((err=Pa_StartStream(audiodevices[pahandle].stream))!=paNoError) {
+			if ((err=PsychPAStreamStart(audiodevices[pahandle].stream))!=paNoError) {
 				printf("PTB-ERROR: Failed to start audio device %i. PortAudio reports this error: %s \n", pahandle, Pa_GetErrorText(err));
 				PsychErrorExitMsg(PsychError_system, "Failed to start PortAudio audio device.");
 			}
@@ -4190,7 +7703,7 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 	
 	// Safety check for deadlock avoidance with waiting slaves:
 	if ((waitForStart > 0) && (audiodevices[pahandle].opmode & kPortAudioIsSlave) &&
-		(!Pa_IsStreamActive(audiodevices[pahandle].stream) || Pa_IsStreamStopped(audiodevices[pahandle].stream) ||
+		(!PsychPAStreamIsActive(audiodevices[pahandle].stream) || PsychPAStreamIsStopped(audiodevices[pahandle].stream) ||
 		 audiodevices[audiodevices[pahandle].pamaster].state < 1)) {
 		// We are a slave that shall wait for start, but the master audio device hasn't even
 		// started its engine. This looks like a deadlock to avoid:
@@ -4206,7 +7719,7 @@ PsychError PSYCHPORTAUDIOStartAudioDevice(void)
 		// We need to enter the first while() loop iteration with
 		// the device lock held from above, so the while() loop will iterate at
 		// least once...
-		while (audiodevices[pahandle].state == 1 && Pa_IsStreamActive(audiodevices[pahandle].stream)) {
+		while (audiodevices[pahandle].state == 1 && PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
 			// Wait for a state-change before reevaluating the .state:
 			PsychPAWaitForChange(&audiodevices[pahandle]);
 		}
@@ -4349,9 +7862,9 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
 	// allowed if we have infinite repetitions set, but a finite stopTime is defined, so
 	// the engine will eventually stop by itself. Same goes for an operative schedule which
 	// will run empty if not regularly updated:
-	if ((waitforend == 1) && Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0) &&
+	if ((waitforend == 1) && PsychPAStreamIsActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0) &&
 		(audiodevices[pahandle].opmode & kPortAudioPlayBack) && ((audiodevices[pahandle].repeatCount != -1) || (audiodevices[pahandle].schedule) || (audiodevices[pahandle].reqStopTime < DBL_MAX))) {
-		while ( ((audiodevices[pahandle].runMode == 0) && Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) ||
+		while ( ((audiodevices[pahandle].runMode == 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) ||
 				((audiodevices[pahandle].runMode == 1) && (audiodevices[pahandle].state > 0))) {
 
 			// Wait for a state-change before reevaluating:
@@ -4381,7 +7894,7 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
 			PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
 				
 			// If blockUntilStopped is non-zero, then explicitely stop as well:
-			if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) && (err=Pa_StopStream(audiodevices[pahandle].stream))!=paNoError) {
+			if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) && (err=PsychPAStreamStop(audiodevices[pahandle].stream))!=paNoError) {
 				printf("PTB-ERROR: Failed to stop audio device %i. PortAudio reports this error: %s \n", pahandle, Pa_GetErrorText(err));
 				PsychErrorExitMsg(PsychError_system, "Failed to stop PortAudio audio device.");
 			}
@@ -4400,7 +7913,7 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
 			PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
 			
 			// If blockUntilStopped is non-zero, then send abort request to hardware:
-			if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) && ((err=Pa_AbortStream(audiodevices[pahandle].stream))!=paNoError)) {
+			if ((blockUntilStopped > 0) && (audiodevices[pahandle].runMode == 0) && (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) && ((err=PsychPAStreamAbort(audiodevices[pahandle].stream))!=paNoError)) {
 				printf("PTB-ERROR: Failed to abort audio device %i. PortAudio reports this error: %s \n", pahandle, Pa_GetErrorText(err));
 				PsychErrorExitMsg(PsychError_system, "Failed to fast stop (abort) PortAudio audio device.");
 			}
@@ -4415,8 +7928,8 @@ PsychError PSYCHPORTAUDIOStopAudioDevice(void)
 		PsychPALockDeviceMutex(&audiodevices[pahandle]);
 
 		// Wait for stop / idle:
-		if (Pa_IsStreamActive(audiodevices[pahandle].stream)) {
-			while ( ((audiodevices[pahandle].runMode == 0) && Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) ||
+		if (PsychPAStreamIsActive(audiodevices[pahandle].stream)) {
+			while ( ((audiodevices[pahandle].runMode == 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) ||
 					((audiodevices[pahandle].runMode == 1) && (audiodevices[pahandle].state > 0))) {
 				
 				// Wait for a state-change before reevaluating:
@@ -4579,7 +8092,7 @@ PsychError PSYCHPORTAUDIOGetStatus(void)
 	PsychSetStructArrayDoubleElement("TotalCalls", 0, audiodevices[pahandle].paCalls, status);
 	PsychSetStructArrayDoubleElement("TimeFailed", 0, audiodevices[pahandle].noTime, status);
 	PsychSetStructArrayDoubleElement("BufferSize", 0, audiodevices[pahandle].batchsize, status);
-	PsychSetStructArrayDoubleElement("CPULoad", 0, (Pa_IsStreamActive(audiodevices[pahandle].stream)) ? Pa_GetStreamCpuLoad(audiodevices[pahandle].stream) : 0.0, status);
+	PsychSetStructArrayDoubleElement("CPULoad", 0, (PsychPAStreamIsActive(audiodevices[pahandle].stream)) ? PsychPAStreamGetCpuLoad(audiodevices[pahandle].stream) : 0.0, status);
 	PsychSetStructArrayDoubleElement("PredictedLatency", 0, audiodevices[pahandle].predictedLatency, status);
 	PsychSetStructArrayDoubleElement("LatencyBias", 0, audiodevices[pahandle].latencyBias, status);
 	PsychSetStructArrayDoubleElement("SampleRate", 0, audiodevices[pahandle].streaminfo->sampleRate, status);
@@ -4692,13 +8205,642 @@ PsychError PSYCHPORTAUDIOLatencyBias(void)
 	// Set new bias, if one was provided:
 	if (bias!=DBL_MAX) {
 		if (audiodevices[pahandle].opmode & kPortAudioIsSlave) PsychErrorExitMsg(PsychError_user, "Change of latency bias is not allowed on slave devices! Set it on associated master device.");
-		if (Pa_IsStreamActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) PsychErrorExitMsg(PsychError_user, "Tried to change 'biasSecs' while device is active! Forbidden!");
+		if (PsychPAStreamIsActive(audiodevices[pahandle].stream) && (audiodevices[pahandle].state > 0)) PsychErrorExitMsg(PsychError_user, "Tried to change 'biasSecs' while device is active! Forbidden!");
 		audiodevices[pahandle].latencyBias = bias;
 	}
 	
 	return(PsychError_none);
 }
 
+/* PsychPortAudio('MixerThreads') - Setup parallel processing of slaves of a master device.
+ */
+PsychError PSYCHPORTAUDIOMixerThreads(void) 
+{
+ 	static char useString[] = "[oldNumThreads, oldMinCost, slaveCost] = PsychPortAudio('MixerThreads', pamaster [, numThreads][, minCost]);";
+	static char synopsisString[] = 
+		"Setup parallel processing of the slave devices attached to master device 'pamaster', and/or return current settings.\n"
+		"By default, a master device processes all its slave devices one after another on the single audio processing "
+		"thread of the sound hardware. With many slaves, e.g., dozens of virtual sound sources, and short buffer durations, "
+		"a single processor core may not be able to keep up. Setting 'numThreads' to a value greater than zero creates "
+		"that many additional mixer threads for 'pamaster'. The slaves then get processed in parallel by the mixer threads "
+		"and the audio processing thread, and the output of all slaves gets summed up at the end. Values up to the number "
+		"of processor cores in your machine minus one are sensible. A 'numThreads' of zero stops and removes all mixer threads. "
+		"Mixer threads run at realtime priority, and spin-wait for work while the master is active, so each "
+		"mixer thread fully occupies one processor core during playback. They stop spinning after 0.1 seconds without work. "
+		"If the mixer threads can't get realtime priority, a warning is printed and the slaves keep being processed serially.\n"
+		"The master waits for its mixer threads for at most half of its buffer duration. Slaves which a mixer thread doesn't "
+		"finish in time, e.g., because it got preempted, are left out of the mix and count as underruns in 'xruns'.\n"
+		"Parallel processing has some overhead, so it only gets used if the measured processing time of all slaves per "
+		"buffer, estimated from a running average of the processing time per slave, exceeds 'minCost' seconds. The default "
+		"is 0.0001 seconds, ie., 100 microseconds. Buffers of more than 8192 sample frames, or of more than the current "
+		"buffersize of the master when the mixer threads were created, if that is larger, are always processed serially.\n"
+		"Slaves which are AM modulators for the master itself modulate the mix of all slaves processed before them, so "
+		"the result depends on processing order. Whenever such a slave is active, all slaves get processed serially.\n"
+		"Returns the old number of mixer threads in 'oldNumThreads', the old 'minCost' in 'oldMinCost', and the current "
+		"running estimate of the processing time per slave and buffer in seconds in 'slaveCost'. The estimate is only "
+		"measured while the master has mixer threads.\n";
+
+	static char seeAlsoString[] = "OpenSlave OpenOffline ";	 
+	
+	PsychPAMixerPool* pool;
+	PsychPAMixerPool* oldPool;
+	double minCost = -1;
+	int pahandle = -1;
+	int numThreads = -1;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(3));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(3));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+	if (!(audiodevices[pahandle].opmode & kPortAudioIsMaster)) PsychErrorExitMsg(PsychError_user, "Mixer threads can only be used on master devices.");
+
+	// Return current/old settings:
+	PsychCopyOutDoubleArg(1, kPsychArgOptional, (audiodevices[pahandle].mixerPool) ? (double) audiodevices[pahandle].mixerPool->numWorkers : 0);
+	PsychCopyOutDoubleArg(2, kPsychArgOptional, audiodevices[pahandle].mixerMinCost);
+	PsychCopyOutDoubleArg(3, kPsychArgOptional, audiodevices[pahandle].mixerSlaveCost);
+
+	// Set new minimum cost for parallel processing, if one was provided:
+	if (PsychCopyInDoubleArg(3, kPsychArgOptional, &minCost)) {
+		if (minCost < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'minCost' provided. Must be zero or greater.");
+		audiodevices[pahandle].mixerMinCost = minCost;
+	}
+
+	// Change number of mixer threads, if requested:
+	if (PsychCopyInIntegerArg(2, kPsychArgOptional, &numThreads)) {
+		if (numThreads < 0 || numThreads > PSYCH_AUDIO_MAX_MIXER_THREADS) PsychErrorExitMsg(PsychError_user, "Invalid 'numThreads' provided. Must be between 0 and 32.");
+
+		// Create new pool without any locks held:
+		pool = NULL;
+		if ((numThreads > 0) && (NULL == (pool = PsychPACreateMixerPool(numThreads, (audiodevices[pahandle].batchsize > PSYCH_AUDIO_MIXER_MAXFRAMES) ? audiodevices[pahandle].batchsize : PSYCH_AUDIO_MIXER_MAXFRAMES,
+																		audiodevices[pahandle].outchannels, audiodevices[pahandle].inchannels)))) {
+			PsychErrorExitMsg(PsychError_system, "Failed to create mixer threads.");
+		}
+
+		// Only use mixer threads at realtime priority, as the master callback waits for them. Keep mixing serially otherwise:
+		if (pool && !PsychPAMixerPoolIsRealtime(pool)) {
+			if (verbosity > 1) printf("PTB-WARNING: PsychPortAudio('MixerThreads'): Mixer threads could not get realtime priority. Slaves of master device %i will be processed serially.\n", pahandle);
+			PsychPADestroyMixerPool(pool);
+			pool = NULL;
+			numThreads = 0;
+		}
+
+		// Swap it in: The master callback only uses the pool with the device mutex held:
+		PsychPALockDeviceMutex(&audiodevices[pahandle]);
+		oldPool = audiodevices[pahandle].mixerPool;
+		audiodevices[pahandle].mixerPool = pool;
+		audiodevices[pahandle].mixerSlaveCost = 0;
+		PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+
+		// Destroy old pool, if any:
+		PsychPADestroyMixerPool(oldPool);
+
+		if (verbosity > 3) printf("PTB-INFO: Audio master device %i now uses %i mixer threads for parallel processing of its slaves.\n", pahandle, numThreads);
+	}
+
+	return(PsychError_none);
+}
+
+/* PsychPortAudio('Resampling') - Setup sample rate conversion and playback rate of a device.
+ */
+PsychError PSYCHPORTAUDIOResampling(void) 
+{
+ 	static char useString[] = "[oldSourceRate, oldPlaybackRate, oldQuality] = PsychPortAudio('Resampling', pahandle [, sourceRate][, playbackRate][, quality]);";
+	static char synopsisString[] = 
+		"Setup sample rate conversion and playback rate of audio device 'pahandle', and/or return current settings.\n"
+		"Only regular playback devices and playback slave devices support this, but not master devices.\n"
+		"'sourceRate' is the samplerate in Hz of the sound data in the devices own playback buffer, as filled via "
+		"PsychPortAudio('FillBuffer'). A setting of zero, the default, means that the sound data has the samplerate "
+		"of the device. Buffers created via PsychPortAudio('CreateBuffer') or PsychPortAudio('CreateBufferFromFile') "
+		"can carry their own samplerate, which is used instead of 'sourceRate' when they are played from a schedule.\n"
+		"'playbackRate' is a speed factor, 1.0 by default. Values greater than 1.0 play faster and at higher pitch, "
+		"values smaller than 1.0 slower and at lower pitch. It can be changed at any time, also during playback, and "
+		"changes are applied smoothly over the duration of one audio buffer, e.g., for simulation of doppler shifts "
+		"of moving sound sources. Allowed values are between 0.01 and 16.\n"
+		"'quality' selects the quality of the resampler: 0 = Linear interpolation, cheapest but audible aliasing and "
+		"high frequency loss. 1 = 16 tap windowed sinc filter. 2 = 32 tap windowed sinc filter, the default. "
+		"3 = 64 tap windowed sinc filter, highest quality with the least aliasing and flattest frequency response "
+		"up to 94% of the Nyquist frequency, at four times the computation time of quality 1.\n"
+		"Conversion doesn't add any latency, because the sound data is already completely in the buffer. Playback "
+		"of a non-looped buffer starts and ends with a fade in and fade out of a few samples, as the filter reaches "
+		"past the first and last sample. When looping, each repetition wraps around to the start of the buffer. "
+		"The 'startSample' and 'endSample' of PsychPortAudio('GetStatus') refer to samples of the sound data.\n"
+		"Returns the old settings in 'oldSourceRate', 'oldPlaybackRate' and 'oldQuality'.\n";
+
+	static char seeAlsoString[] = "FillBuffer CreateBuffer CreateBufferFromFile OpenSlave ";	 
+	
+	double sourceRate, playbackRate, ratio;
+	int pahandle = -1;
+	int quality;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(3));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+	if ((audiodevices[pahandle].opmode & kPortAudioPlayBack) == 0) PsychErrorExitMsg(PsychError_user, "Audio device has not been opened for audio playback, so this call doesn't make sense.");
+	if (audiodevices[pahandle].opmode & kPortAudioIsMaster) PsychErrorExitMsg(PsychError_user, "Sample rate conversion is not supported on master devices, only on their slaves.");
+
+	// Return current/old settings:
+	PsychCopyOutDoubleArg(1, kPsychArgOptional, audiodevices[pahandle].sourceRate);
+	PsychCopyOutDoubleArg(2, kPsychArgOptional, audiodevices[pahandle].playbackRate);
+	PsychCopyOutDoubleArg(3, kPsychArgOptional, (double) audiodevices[pahandle].resampleQuality);
+
+	// Get and validate new settings, if any:
+	sourceRate = audiodevices[pahandle].sourceRate;
+	if (PsychCopyInDoubleArg(2, kPsychArgOptional, &sourceRate) && (sourceRate < 0 || sourceRate > 1e6)) {
+		PsychErrorExitMsg(PsychError_user, "Invalid 'sourceRate' provided. Must be zero for device samplerate, or a positive value of at most 1 MHz.");
+	}
+
+	playbackRate = audiodevices[pahandle].playbackRate;
+	if (PsychCopyInDoubleArg(3, kPsychArgOptional, &playbackRate) && (playbackRate < 0.01 || playbackRate > 16)) {
+		PsychErrorExitMsg(PsychError_user, "Invalid 'playbackRate' provided. Must be between 0.01 and 16.");
+	}
+
+	quality = audiodevices[pahandle].resampleQuality;
+	if (PsychCopyInIntegerArg(4, kPsychArgOptional, &quality) && (quality < 0 || quality >= PSYCH_AUDIO_RESAMPLER_PRESETS)) {
+		PsychErrorExitMsg(PsychError_user, "Invalid 'quality' provided. Must be between 0 and 3.");
+	}
+
+	// Resulting conversion ratio must stay in a range where the filter table and per frame work stay bounded.
+	// A 'sourceRate' of zero means the samplerate of the device, so only 'playbackRate' contributes then:
+	ratio = ((sourceRate > 0) ? sourceRate / audiodevices[pahandle].streaminfo->sampleRate : 1.0) * playbackRate;
+	if ((ratio > 32) || (ratio < 0.001)) {
+		PsychErrorExitMsg(PsychError_user, "Combination of 'sourceRate' and 'playbackRate' would need an unsupported conversion ratio. Must be between 0.001 and 32.");
+	}
+
+	// Apply:
+	PsychPALockDeviceMutex(&audiodevices[pahandle]);
+	audiodevices[pahandle].sourceRate = sourceRate;
+	audiodevices[pahandle].playbackRate = playbackRate;
+	audiodevices[pahandle].resampleQuality = quality;
+	PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+
+	// Build or rebuild resampler if needed:
+	PsychPAUpdateResampler(&audiodevices[pahandle]);
+
+	return(PsychError_none);
+}
+
+// Validate 'pahandle' for use with an effect chain:
+static void PsychPADspCheckDevice(int pahandle)
+{
+	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+	if ((audiodevices[pahandle].opmode & kPortAudioPlayBack) == 0) PsychErrorExitMsg(PsychError_user, "Audio device has not been opened for audio playback, so this call doesn't make sense.");
+	if (audiodevices[pahandle].opmode & (kPortAudioIsAMModulator | kPortAudioIsOutputCapture)) PsychErrorExitMsg(PsychError_user, "Effects are not supported on AM modulator or output capture devices.");
+}
+
+/* PsychPortAudio('DspBiquads') - Setup biquad filters of the effect chain of a device.
+ */
+PsychError PSYCHPORTAUDIODspBiquads(void) 
+{
+ 	static char useString[] = "oldCoefficients = PsychPortAudio('DspBiquads', pahandle [, coefficients]);";
+	static char synopsisString[] = 
+		"Setup cascaded biquad filters in the effect chain of audio device 'pahandle', and/or return current settings.\n"
+		"Each regular audio playback device, master device and slave device has an optional realtime effect chain which "
+		"processes the sound output of the device, with cascaded biquad filters, followed by convolution, see "
+		"PsychPortAudio('DspConvolution'), followed by a look-ahead limiter, see PsychPortAudio('DspLimiter'). The "
+		"effect chain of a slave processes the sound of the slave before it gets mixed into the output of its master, "
+		"the effect chain of a master the final mix of all its slaves. Effect chains are not supported on AM modulators "
+		"and output capture devices.\n"
+		"'coefficients' is a 5 rows by n columns matrix, each column the coefficients [b0 ; b1 ; b2 ; a1 ; a2] of one "
+		"second order section, with a0 normalized to 1, in the usual notation of transfer functions, e.g., as computed "
+		"by many filter design functions, like the Matlab function tf2sos(). Up to 16 sections can be used, ie., filters "
+		"of up to order 32, e.g., for equalization or bandpass filtering. All channels of the device are filtered with "
+		"the same filter. Each section must be a stable filter. An empty matrix removes all filters.\n"
+		"The new filter gets applied at the start of the next audio buffer, without any locking or disruption of audio "
+		"processing. The coefficients change smoothly from their old to their new values over the next 512 sample "
+		"frames, so they can be changed at any time during playback without clicks.\n"
+		"Returns the old coefficients in 'oldCoefficients'.\n";
+
+	static char seeAlsoString[] = "DspConvolution DspLimiter Volume ";	 
+	
+	PsychPADspChain* chain;
+	PsychPADspChain* last;
+	double* coeffs;
+	double* oldCoeffs;
+	int m, n, p, i, k;
+	int pahandle = -1;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(2));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(1));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	PsychPADspCheckDevice(pahandle);
+
+	// Return current/old settings:
+	last = audiodevices[pahandle].dspLast;
+	n = (last) ? last->numBiquads : 0;
+	PsychAllocOutDoubleMatArg(1, kPsychArgOptional, 5, n, 1, &oldCoeffs);
+	for (i = 0; i < n; i++) for (k = 0; k < 5; k++) *(oldCoeffs++) = last->biquads[i][k];
+
+	// New coefficients?
+	if (!PsychAllocInDoubleMatArg(2, kPsychArgOptional, &m, &n, &p, &coeffs)) return(PsychError_none);
+
+	if (m * n * p > 0) {
+		if (m != 5 || p != 1) PsychErrorExitMsg(PsychError_user, "Invalid 'coefficients' matrix provided. Must have 5 rows.");
+		if (n > PSYCH_AUDIO_DSP_MAX_BIQUADS) PsychErrorExitMsg(PsychError_user, "Invalid 'coefficients' matrix provided. Must have at most 16 columns.");
+	}
+	else n = 0;
+
+	// Poles of each section must be inside the unit circle:
+	for (i = 0; i < n; i++) {
+		if (!(fabs(coeffs[i * 5 + 4]) < 1) || !(fabs(coeffs[i * 5 + 3]) < 1 + coeffs[i * 5 + 4])) {
+			printf("PTB-ERROR: Biquad section %i with a1 = %f, a2 = %f is unstable.\n", i + 1, coeffs[i * 5 + 3], coeffs[i * 5 + 4]);
+			PsychErrorExitMsg(PsychError_user, "Invalid 'coefficients' provided. Filter must be stable.");
+		}
+	}
+
+	// Build and publish new chain:
+	chain = PsychPADspCloneChain(&audiodevices[pahandle]);
+	chain->numBiquads = n;
+	for (i = 0; i < PSYCH_AUDIO_DSP_MAX_BIQUADS; i++) {
+		for (k = 0; k < 5; k++) chain->biquads[i][k] = (i < n) ? coeffs[i * 5 + k] : ((k == 0) ? 1.0 : 0.0);
+	}
+
+	PsychPADspPublish(&audiodevices[pahandle], chain, 0);
+
+	return(PsychError_none);
+}
+
+/* PsychPortAudio('DspConvolution') - Setup convolution of the effect chain of a device.
+ */
+PsychError PSYCHPORTAUDIODspConvolution(void) 
+{
+ 	static char useString[] = "latency = PsychPortAudio('DspConvolution', pahandle [, impulseResponse][, partitionSize=128][, maxLength]);";
+	static char synopsisString[] = 
+		"Setup convolution with impulse responses in the effect chain of audio device 'pahandle', and/or return current latency.\n"
+		"See PsychPortAudio('DspBiquads') for a general description of effect chains.\n"
+		"'impulseResponse' is a matrix with one row per output channel of the device, each row the impulse response for "
+		"that channel, e.g., the left and right ear head related impulse responses (HRIR) of a virtual sound source "
+		"position for a stereo slave device, or a room impulse response. A single row applies to all channels. An empty "
+		"matrix removes convolution. Include the direct sound in the impulse response if you want it, as only the "
+		"convolved sound is output.\n"
+		"Convolution is computed in the frequency domain, with the impulse response split into partitions of "
+		"'partitionSize' sample frames each, which must be a power of two between 16 and 8192, 128 by default. "
+		"Convolution delays the sound by 'partitionSize' sample frames. Smaller partitions have lower latency, but "
+		"need more computation for long impulse responses.\n"
+		"A new impulse response gets applied without any locking or disruption of audio processing. If the partition "
+		"size didn't change and the impulse response is not longer than the longest one used so far on this device, or "
+		"than 'maxLength' sample frames, the output with the old impulse response is crossfaded into the output "
+		"with the new one over one partition, so impulse responses can be changed during playback, e.g., for moving "
+		"virtual sound sources. Otherwise the switch is immediate and may cause an audible click.\n"
+		"Returns the 'latency' of the convolution in seconds, or zero if convolution is not used.\n";
+
+	static char seeAlsoString[] = "DspBiquads DspLimiter ";	 
+	
+	PsychPADspChain* chain;
+	PsychPADspIR* ir;
+	double* data;
+	psych_int64 m, n, p;
+	int partitionSize = 128;
+	int maxLength = 0;
+	int pahandle = -1;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(1));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	PsychPADspCheckDevice(pahandle);
+
+	PsychCopyInIntegerArg(3, kPsychArgOptional, &partitionSize);
+	if (partitionSize < 16 || partitionSize > 8192 || (partitionSize & (partitionSize - 1))) PsychErrorExitMsg(PsychError_user, "Invalid 'partitionSize' provided. Must be a power of two between 16 and 8192.");
+
+	PsychCopyInIntegerArg(4, kPsychArgOptional, &maxLength);
+	if (maxLength < 0) PsychErrorExitMsg(PsychError_user, "Invalid 'maxLength' provided. Must be zero or greater.");
+
+	// New impulse response?
+	if (PsychAllocInDoubleMatArg64(2, kPsychArgOptional, &m, &n, &p, &data)) {
+		if (m * n * p > 0) {
+			if ((m != 1 && m != audiodevices[pahandle].outchannels) || p != 1) PsychErrorExitMsg(PsychError_user, "Invalid 'impulseResponse' provided. Must have one row, or one row per output channel of the device.");
+
+			ir = PsychPADspCreateIR(data, m, n, audiodevices[pahandle].outchannels, partitionSize);
+			if (NULL == ir) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for impulse response!");
+		}
+		else ir = NULL;
+
+		// Build and publish new chain:
+		chain = PsychPADspCloneChain(&audiodevices[pahandle]);
+		PsychPADspReleaseIR(chain->ir);
+		chain->ir = ir;
+
+		PsychPADspPublish(&audiodevices[pahandle], chain, (maxLength + partitionSize - 1) / partitionSize);
+	}
+
+	// Return latency:
+	chain = audiodevices[pahandle].dspLast;
+	PsychCopyOutDoubleArg(1, kPsychArgOptional, (chain && chain->ir) ? (double) chain->ir->partitionSize / audiodevices[pahandle].streaminfo->sampleRate : 0);
+
+	return(PsychError_none);
+}
+
+/* PsychPortAudio('DspLimiter') - Setup limiter of the effect chain of a device.
+ */
+PsychError PSYCHPORTAUDIODspLimiter(void) 
+{
+ 	static char useString[] = "[oldThreshold, oldLookahead, oldRelease] = PsychPortAudio('DspLimiter', pahandle [, threshold][, lookahead=0.002][, release=0.05]);";
+	static char synopsisString[] = 
+		"Setup look-ahead limiter at the end of the effect chain of audio device 'pahandle', and/or return current settings.\n"
+		"See PsychPortAudio('DspBiquads') for a general description of effect chains.\n"
+		"The limiter reduces the gain of all channels together just enough to keep the absolute value of all output "
+		"samples at or below 'threshold', e.g., to prevent clipping after convolution or summing many slaves. A "
+		"'threshold' of zero, the default, disables the limiter. The gain starts to ramp down 'lookahead' seconds "
+		"before a peak, so it follows without distortion, and recovers afterwards with a time constant of 'release' "
+		"seconds. The limiter delays the sound by 'lookahead' seconds. 'lookahead' must be between 0 and 0.05 seconds, "
+		"'release' between 0.001 and 10 seconds.\n"
+		"Threshold and release changes are applied smoothly during playback. Changing 'lookahead' resets the limiter, "
+		"and the convolution state if convolution is used, and may cause an audible click.\n"
+		"Returns the old settings in 'oldThreshold', 'oldLookahead' and 'oldRelease'.\n";
+
+	static char seeAlsoString[] = "DspBiquads DspConvolution ";	 
+	
+	PsychPADspChain* chain;
+	PsychPADspChain* last;
+	double threshold, lookahead, release, sampleRate;
+	int pahandle = -1;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(4));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(3));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	PsychPADspCheckDevice(pahandle);
+	sampleRate = audiodevices[pahandle].streaminfo->sampleRate;
+
+	// Return current/old settings:
+	last = audiodevices[pahandle].dspLast;
+	threshold = (last) ? last->limitThreshold : 0;
+	lookahead = (last) ? last->limitLookaheadSecs : 0.002;
+	release = (last) ? last->limitReleaseSecs : 0.05;
+	PsychCopyOutDoubleArg(1, kPsychArgOptional, threshold);
+	PsychCopyOutDoubleArg(2, kPsychArgOptional, lookahead);
+	PsychCopyOutDoubleArg(3, kPsychArgOptional, release);
+
+	// Nothing to change?
+	if (PsychGetNumInputArgs() < 2) return(PsychError_none);
+
+	if (PsychCopyInDoubleArg(2, kPsychArgOptional, &threshold) && !(threshold >= 0)) PsychErrorExitMsg(PsychError_user, "Invalid 'threshold' provided. Must be zero or greater.");
+	if (PsychCopyInDoubleArg(3, kPsychArgOptional, &lookahead) && !(lookahead >= 0 && lookahead <= 0.05)) PsychErrorExitMsg(PsychError_user, "Invalid 'lookahead' provided. Must be between 0 and 0.05 seconds.");
+	if (PsychCopyInDoubleArg(4, kPsychArgOptional, &release) && !(release >= 0.001 && release <= 10)) PsychErrorExitMsg(PsychError_user, "Invalid 'release' provided. Must be between 0.001 and 10 seconds.");
+
+	// Build and publish new chain:
+	chain = PsychPADspCloneChain(&audiodevices[pahandle]);
+	chain->limitThreshold = (float) threshold;
+	chain->limitLookaheadSecs = lookahead;
+	chain->limitLookahead = 1 + (int) (lookahead * sampleRate + 0.5);
+	chain->limitReleaseSecs = release;
+	chain->limitRelease = (float) exp(-1.0 / (release * sampleRate));
+
+	PsychPADspPublish(&audiodevices[pahandle], chain, 0);
+
+	return(PsychError_none);
+}
+
+/* PsychPortAudio('CaptureDetector') - Setup capture event detector of a device.
+ */
+PsychError PSYCHPORTAUDIOCaptureDetector(void) 
+{
+ 	static char useString[] = "PsychPortAudio('CaptureDetector', pahandle [, threshold=0][, snr=0][, window=0.005][, minDuration=0.1][, band][, channel=0][, triggerHandle=-1][, triggerDelay=0]);";
+	static char synopsisString[] = 
+		"Setup detection of sound onsets and offsets in the captured sound of audio capture device 'pahandle', e.g., for a voice key.\n"
+		"Detection runs in the audio processing thread on every captured sample frame, without any need to fetch the captured "
+		"sound via PsychPortAudio('GetAudioData'). Detected events are stored in a queue of up to 256 events, from which "
+		"PsychPortAudio('GetCaptureEvents') fetches them, with their exact sample index and capture time.\n"
+		"The detector computes the RMS level of the captured sound, smoothed with a time constant of 'window' seconds, by "
+		"default 0.005 seconds. An onset is detected when the level exceeds the absolute 'threshold', and the estimated "
+		"level of the background noise times 'snr'. Either setting can be zero to disable it, but if both are zero, the "
+		"detector is disabled. The noise level is estimated continuously while waiting for an onset, starting with the "
+		"first 0.1 seconds after start of capture, during which no onsets are detected. An offset is detected when the "
+		"level has fallen below 70% of the onset threshold for at least 'minDuration' seconds, but not earlier than "
+		"'minDuration' seconds after the onset. Then the detector waits for the next onset.\n"
+		"'band' optionally restricts detection to a frequency band, given as [lowHz, highHz] in Hz, e.g., [300, 3000] for "
+		"speech, to reject low frequency rumble and high frequency noise. 'channel' selects the input channel to use, "
+		"with 0, the default, meaning the average of all channels.\n"
+		"'triggerHandle' optionally selects a playback slave device of the same master device to start at the first "
+		"onset. The slave must have been started via PsychPortAudio('Start') with a start time 'when' of inf, so it waits "
+		"in hot-standby. At onset, its start time is set to the capture time of the onset plus 'triggerDelay' seconds. "
+		"As slaves are processed one after another, playback starts at the earliest in the next audio buffer after the "
+		"onset was captured.\n"
+		"Settings can be changed anytime. Detection state is reset when capture is started via PsychPortAudio('Start').\n";
+
+	static char seeAlsoString[] = "GetCaptureEvents GetAudioData Start ";	 
+	
+	PsychPADetector* det;
+	double threshold = 0, snr = 0, window = 0.005, minDuration = 0.1, triggerDelay = 0;
+	double sampleRate, w0, alpha, cosw0, a0;
+	double* band;
+	int m, n, p, i;
+	int pahandle = -1;
+	int channel = 0;
+	int triggerHandle = -1;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(9));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(0));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+	if (((audiodevices[pahandle].opmode & kPortAudioCapture) == 0) || (audiodevices[pahandle].opmode & (kPortAudioIsMaster | kPortAudioIsOutputCapture))) {
+		PsychErrorExitMsg(PsychError_user, "Audio device is not a regular or slave device opened for audio capture, so this call doesn't make sense.");
+	}
+	sampleRate = audiodevices[pahandle].streaminfo->sampleRate;
+
+	if (PsychCopyInDoubleArg(2, kPsychArgOptional, &threshold) && !(threshold >= 0)) PsychErrorExitMsg(PsychError_user, "Invalid 'threshold' provided. Must be zero or greater.");
+	if (PsychCopyInDoubleArg(3, kPsychArgOptional, &snr) && !(snr >= 0)) PsychErrorExitMsg(PsychError_user, "Invalid 'snr' provided. Must be zero or greater.");
+	if (PsychCopyInDoubleArg(4, kPsychArgOptional, &window) && !(window > 0 && window <= 1)) PsychErrorExitMsg(PsychError_user, "Invalid 'window' provided. Must be greater than zero and at most 1 second.");
+	if (PsychCopyInDoubleArg(5, kPsychArgOptional, &minDuration) && !(minDuration >= 0)) PsychErrorExitMsg(PsychError_user, "Invalid 'minDuration' provided. Must be zero or greater.");
+
+	band = NULL;
+	if (PsychAllocInDoubleMatArg(6, kPsychArgOptional, &m, &n, &p, &band) && (m * n * p > 0)) {
+		if ((m * n * p != 2) || !(band[0] >= 0) || !(band[1] > band[0]) || !(band[1] < sampleRate / 2)) {
+			PsychErrorExitMsg(PsychError_user, "Invalid 'band' provided. Must be a vector [lowHz, highHz] with 0 <= lowHz < highHz < samplerate / 2.");
+		}
+	}
+	else band = NULL;
+
+	if (PsychCopyInIntegerArg(7, kPsychArgOptional, &channel) && (channel < 0 || channel > audiodevices[pahandle].inchannels)) {
+		PsychErrorExitMsg(PsychError_user, "Invalid 'channel' provided. Must be zero or a valid input channel number of the device.");
+	}
+
+	if (PsychCopyInIntegerArg(8, kPsychArgOptional, &triggerHandle) && (triggerHandle != -1)) {
+		if (triggerHandle < 0 || triggerHandle >= MAX_PSYCH_AUDIO_DEVS || audiodevices[triggerHandle].stream == NULL || triggerHandle == pahandle ||
+			!(audiodevices[triggerHandle].opmode & kPortAudioIsSlave) || !(audiodevices[triggerHandle].opmode & kPortAudioPlayBack) ||
+			!(audiodevices[pahandle].opmode & kPortAudioIsSlave) || (audiodevices[triggerHandle].pamaster != audiodevices[pahandle].pamaster)) {
+			PsychErrorExitMsg(PsychError_user, "Invalid 'triggerHandle' provided. Must be a playback slave device of the same master device.");
+		}
+	}
+
+	PsychCopyInDoubleArg(9, kPsychArgOptional, &triggerDelay);
+	if (!(triggerDelay >= 0)) PsychErrorExitMsg(PsychError_user, "Invalid 'triggerDelay' provided. Must be zero or greater.");
+
+	// Create detector on first use:
+	if (NULL == audiodevices[pahandle].detector) {
+		det = (PsychPADetector*) calloc(1, sizeof(PsychPADetector));
+		if (NULL == det) PsychErrorExitMsg(PsychError_outofMemory, "Insufficient free memory for capture event detector!");
+		PsychPAResetDetector(det);
+		det->trigger = -1;
+
+		PsychPALockDeviceMutex(&audiodevices[pahandle]);
+		audiodevices[pahandle].detector = det;
+		PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+	}
+
+	// Apply settings:
+	PsychPALockDeviceMutex(&audiodevices[pahandle]);
+	det = audiodevices[pahandle].detector;
+
+	det->threshold = threshold;
+	det->snr = snr;
+	det->levelCoeff = 1.0 - exp(-1.0 / (window * sampleRate));
+	det->floorRise = 1.0 - exp(-1.0 / (PSYCH_AUDIO_DETECTOR_FLOORRISE * sampleRate));
+	det->floorFall = 1.0 - exp(-1.0 / (PSYCH_AUDIO_DETECTOR_FLOORFALL * sampleRate));
+	det->minFrames = (psych_int64) (minDuration * sampleRate + 0.5);
+	det->warmupFrames = (psych_int64) (PSYCH_AUDIO_DETECTOR_WARMUP * sampleRate);
+	det->channel = channel - 1;
+	det->trigger = triggerHandle;
+	det->triggerDelay = triggerDelay;
+
+	// Band limiting by a second order highpass and lowpass filter with Butterworth Q:
+	det->numBiquads = 0;
+	if (band) {
+		for (i = 0; i < 2; i++) {
+			if ((i == 0) && (band[0] <= 0)) continue;
+			w0 = 2.0 * M_PI * band[i] / sampleRate;
+			cosw0 = cos(w0);
+			alpha = sin(w0) / (2.0 * M_SQRT1_2);
+			a0 = 1.0 + alpha;
+			det->biquads[det->numBiquads][0] = ((i == 0) ? (1.0 + cosw0) : (1.0 - cosw0)) / 2.0 / a0;
+			det->biquads[det->numBiquads][1] = ((i == 0) ? -(1.0 + cosw0) : (1.0 - cosw0)) / a0;
+			det->biquads[det->numBiquads][2] = det->biquads[det->numBiquads][0];
+			det->biquads[det->numBiquads][3] = -2.0 * cosw0 / a0;
+			det->biquads[det->numBiquads][4] = (1.0 - alpha) / a0;
+			det->numBiquads++;
+		}
+	}
+	memset(det->z, 0, sizeof(det->z));
+
+	PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
+
+	return(PsychError_none);
+}
+
+/* PsychPortAudio('GetCaptureEvents') - Fetch events detected by the capture event detector of a device.
+ */
+PsychError PSYCHPORTAUDIOGetCaptureEvents(void) 
+{
+ 	static char useString[] = "[events, overflows] = PsychPortAudio('GetCaptureEvents', pahandle);";
+	static char synopsisString[] = 
+		"Fetch all events detected since the last call by the capture event detector of audio device 'pahandle'.\n"
+		"See PsychPortAudio('CaptureDetector') for setup of the detector. Returns a struct array 'events' with one element "
+		"per event, in order of detection, which is empty if there are no new events. Each element has the following fields:\n"
+		"'Type' 1 for an onset, 2 for an offset.\n"
+		"'Sample' Index of the sample frame of the event in the captured sound since start of capture, counting from zero. "
+		"This is the position of the event in the sound returned by PsychPortAudio('GetAudioData').\n"
+		"'Time' Capture time of that sample frame in GetSecs time.\n"
+		"'Level' RMS level of the sound at detection.\n"
+		"'NoiseFloor' Estimated RMS level of the background noise at detection.\n"
+		"The detected position is where the smoothed level crossed the threshold, which lags behind the true start of a "
+		"sound by a fraction of the 'window' time constant, depending on the loudness of the sound. Offsets lag behind "
+		"the true end of a sound by the decay time of the smoothed level, a few times the 'window' time constant.\n"
+		"'overflows' is the total number of events lost so far, because the queue was full. Fetching events at least "
+		"every few seconds avoids this.\n"
+		"Fetching events is lock-free, it doesn't interfere with audio processing.\n";
+
+	static char seeAlsoString[] = "CaptureDetector GetAudioData ";	 
+	
+	const char *FieldNames[] = { "Type", "Sample", "Time", "Level", "NoiseFloor" };
+	PsychGenericScriptType *events;
+	PsychPADetector* det;
+	PsychPADetectorEvent* ev;
+	unsigned int count, i;
+	int pahandle = -1;
+
+	// Setup online help: 
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp(); return(PsychError_none); };
+	
+	PsychErrorExit(PsychCapNumInputArgs(1));     // The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1)); // The required number of inputs	
+	PsychErrorExit(PsychCapNumOutputArgs(2));	 // The maximum number of outputs
+
+	// Make sure PortAudio is online:
+	PsychPortAudioInitialize();
+
+	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
+	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided.");
+
+	det = audiodevices[pahandle].detector;
+	if (NULL == det) PsychErrorExitMsg(PsychError_user, "Capture event detector not setup on this device. Call PsychPortAudio('CaptureDetector') first.");
+
+	// Events written so far, read them only after reading the count:
+	count = det->writeCount - det->readCount;
+	PsychPAMemoryBarrier();
+
+	PsychAllocOutStructArray(1, kPsychArgOptional, (int) count, 5, FieldNames, &events);
+	for (i = 0; i < count; i++) {
+		ev = &(det->events[(det->readCount + i) % PSYCH_AUDIO_DETECTOR_QUEUESIZE]);
+		PsychSetStructArrayDoubleElement("Type", (int) i, (double) ev->type, events);
+		PsychSetStructArrayDoubleElement("Sample", (int) i, (double) ev->frame, events);
+		PsychSetStructArrayDoubleElement("Time", (int) i, ev->time, events);
+		PsychSetStructArrayDoubleElement("Level", (int) i, ev->level, events);
+		PsychSetStructArrayDoubleElement("NoiseFloor", (int) i, ev->noiseFloor, events);
+	}
+
+	// Release the slots only after reading them:
+	PsychPAMemoryBarrier();
+	det->readCount += count;
+
+	PsychCopyOutDoubleArg(2, kPsychArgOptional, (double) det->overflows);
+
+	return(PsychError_none);
+}
+
 /* PsychPortAudio('Volume') - Set volume per device.
  */
 PsychError PSYCHPORTAUDIOVolume(void) 
@@ -4968,7 +9110,7 @@ PsychError PSYCHPORTAUDIORunMode(void)
 		if (audiodevices[pahandle].opmode & kPortAudioIsSlave) PsychErrorExitMsg(PsychError_user, "Change of runmode is not allowed on slave devices!");
 
 		// Stop engine if it is running:
-		if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) Pa_StopStream(audiodevices[pahandle].stream);
+		if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) PsychPAStreamStop(audiodevices[pahandle].stream);
 
 		// Reset state:
 		audiodevices[pahandle].state = 0;
@@ -5200,7 +9342,7 @@ PsychError PSYCHPORTAUDIOUseSchedule(void)
 	// Make sure the device is fully idle: We can check without mutex held, as a device which is
 	// already idle (state == 0) can't switch by itself out of idle state (state > 0), neither
 	// can an inactive stream start itself.
-	if ((audiodevices[pahandle].state > 0) && Pa_IsStreamActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Tried to enable/disable audio schedule while audio device is active. Forbidden! Call 'Stop' first.");
+	if ((audiodevices[pahandle].state > 0) && PsychPAStreamIsActive(audiodevices[pahandle].stream)) PsychErrorExitMsg(PsychError_user, "Tried to enable/disable audio schedule while audio device is active. Forbidden! Call 'Stop' first.");
 
 	// At this point the deivce is idle and will remain so during this routines execution,
 	// so it won't touch any of the schedule related variables and we can manipulate them
@@ -5434,6 +9576,14 @@ PsychError PSYCHPORTAUDIOAddToSchedule(void)
 
 	if (endSample < startSample) PsychErrorExitMsg(PsychError_user, "Invalid 'endSample' provided. Must be greater or equal than 'startSample'!");
 	
+	// Prime read-ahead window at start of playloop of a file backed buffer, so playback of this
+	// slot doesn't depend on the read-ahead thread catching up in time:
+	if ((bufferHandle > 0) && (buffer->filebuffer)) {
+		PsychLockMutex(&fileBufferMutex);
+		PsychPAPrimeFileBuffer(buffer->filebuffer, (psych_int64) startSample * buffer->outchannels, buffer->filebuffer->readAheadFrames * buffer->outchannels);
+		PsychUnlockMutex(&fileBufferMutex);
+	}
+
 	// Copy in optional specialFlags:
 	PsychCopyInIntegerArg(7, kPsychArgOptional, &specialFlags);
 	
@@ -5479,6 +9629,9 @@ PsychError PSYCHPORTAUDIOAddToSchedule(void)
 	// Unlock device:
 	PsychPAUnlockDeviceMutex(&audiodevices[pahandle]);
 
+	// Make sure a suitable resampler is ready if the buffer has a different samplerate:
+	if (success) PsychPAUpdateResampler(&audiodevices[pahandle]);
+
 	// Return optional result code:
 	PsychCopyOutDoubleArg(1, kPsychArgOptional, (double) success);
 
@@ -5538,7 +9691,7 @@ PsychError PSYCHPORTAUDIOSetOpMode(void)
 	// Set new opMode, if one was provided:
 	if (opMode != -1) {
 		// Stop engine if it is running:
-		if (!Pa_IsStreamStopped(audiodevices[pahandle].stream)) Pa_StopStream(audiodevices[pahandle].stream);
+		if (!PsychPAStreamIsStopped(audiodevices[pahandle].stream)) PsychPAStreamStop(audiodevices[pahandle].stream);
 
 		// Reset state:
 		audiodevices[pahandle].state = 0;
@@ -5635,6 +9788,7 @@ PsychError PSYCHPORTAUDIODirectInputMonitoring(void)
 	// Get mandatory device handle:
 	PsychCopyInIntegerArg(1, kPsychArgRequired, &pahandle);
 	if (pahandle < 0 || pahandle>=MAX_PSYCH_AUDIO_DEVS || audiodevices[pahandle].stream == NULL) PsychErrorExitMsg(PsychError_user, "Invalid audio device handle provided. No such device with that handle open!");
+	if (audiodevices[pahandle].hostAPI == kPsychPAOfflineHostAPI) PsychErrorExitMsg(PsychError_user, "Direct input monitoring is not supported on offline render devices.");
 
 	// Get mandatory enable flag:
 	PsychCopyInIntegerArg(2, kPsychArgRequired, &enable);
@@ -47,6 +47,19 @@ PsychError PSYCHPORTAUDIOVerbosity(void);
 
 // Open audio device:
 PsychError PSYCHPORTAUDIOOpen(void);
+// Open audio device on offline render backend:
+PsychError PSYCHPORTAUDIOOpenOffline(void);
+// Return processing statistics of offline render device:
+PsychError PSYCHPORTAUDIOOfflineStatistics(void);
+// Setup parallel processing of slaves:
+PsychError PSYCHPORTAUDIOMixerThreads(void);
+PsychError PSYCHPORTAUDIOResampling(void);
+PsychError PSYCHPORTAUDIODspBiquads(void);
+PsychError PSYCHPORTAUDIODspConvolution(void);
+PsychError PSYCHPORTAUDIODspLimiter(void);
+PsychError PSYCHPORTAUDIOCaptureDetector(void);
+PsychError PSYCHPORTAUDIOGetCaptureEvents(void);
+PsychError PSYCHPORTAUDIOGetAudioDataRange(void);
 // Open virtual audio slave device:
 PsychError PSYCHPORTAUDIOOpenSlave(void);
 // Close audio device, shutdown PortAudio if last device is closed:
@@ -83,6 +96,8 @@ PsychError PSYCHPORTAUDIOUseSchedule(void);
 PsychError PSYCHPORTAUDIOAddToSchedule(void);
 // Create and fill dynamic audio buffer:
 PsychError PSYCHPORTAUDIOCreateBuffer(void); 
+// Create dynamic audio buffer backed by a sound file:
+PsychError PSYCHPORTAUDIOCreateBufferFromFile(void);
 // Delete dynamic audio buffer:
 PsychError PSYCHPORTAUDIODeleteBuffer(void); 
 // Change device opMode at runtime:
@@ -45,6 +45,8 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("Verbosity", &PSYCHPORTAUDIOVerbosity));
 	PsychErrorExit(PsychRegister("Open", &PSYCHPORTAUDIOOpen));
 	PsychErrorExit(PsychRegister("OpenSlave", &PSYCHPORTAUDIOOpenSlave));
+	PsychErrorExit(PsychRegister("OpenOffline", &PSYCHPORTAUDIOOpenOffline));
+	PsychErrorExit(PsychRegister("OfflineStatistics", &PSYCHPORTAUDIOOfflineStatistics));
 	PsychErrorExit(PsychRegister("Close", &PSYCHPORTAUDIOClose));
 	PsychErrorExit(PsychRegister("Start", &PSYCHPORTAUDIOStartAudioDevice));
 	PsychErrorExit(PsychRegister("RescheduleStart", &PSYCHPORTAUDIORescheduleStart));
@@ -62,10 +64,19 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("UseSchedule", &PSYCHPORTAUDIOUseSchedule));
 	PsychErrorExit(PsychRegister("AddToSchedule", &PSYCHPORTAUDIOAddToSchedule));
 	PsychErrorExit(PsychRegister("CreateBuffer", &PSYCHPORTAUDIOCreateBuffer));
+	PsychErrorExit(PsychRegister("CreateBufferFromFile", &PSYCHPORTAUDIOCreateBufferFromFile));
 	PsychErrorExit(PsychRegister("DeleteBuffer", &PSYCHPORTAUDIODeleteBuffer));
 	PsychErrorExit(PsychRegister("SetOpMode", &PSYCHPORTAUDIOSetOpMode));
 	PsychErrorExit(PsychRegister("DirectInputMonitoring", &PSYCHPORTAUDIODirectInputMonitoring));
 	PsychErrorExit(PsychRegister("Volume", &PSYCHPORTAUDIOVolume));
+	PsychErrorExit(PsychRegister("MixerThreads", &PSYCHPORTAUDIOMixerThreads));
+	PsychErrorExit(PsychRegister("Resampling", &PSYCHPORTAUDIOResampling));
+	PsychErrorExit(PsychRegister("DspBiquads", &PSYCHPORTAUDIODspBiquads));
+	PsychErrorExit(PsychRegister("DspConvolution", &PSYCHPORTAUDIODspConvolution));
+	PsychErrorExit(PsychRegister("DspLimiter", &PSYCHPORTAUDIODspLimiter));
+	PsychErrorExit(PsychRegister("CaptureDetector", &PSYCHPORTAUDIOCaptureDetector));
+	PsychErrorExit(PsychRegister("GetCaptureEvents", &PSYCHPORTAUDIOGetCaptureEvents));
+	PsychErrorExit(PsychRegister("GetAudioDataRange", &PSYCHPORTAUDIOGetAudioDataRange));
 
 	// Setup synopsis help strings:
 	InitializeSynopsis();   //Scripting glue won't require this if the function takes no arguments.
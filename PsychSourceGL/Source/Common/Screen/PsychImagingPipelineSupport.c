@@ -12,6 +12,11 @@
 	HISTORY:
 	
 		12/05/06	mk	Wrote it.
+		10/19/26	agent	Add process-wide GLSL program binary cache for PsychCreateGLSLProgram(), persisted to disk.
+		10/19/26	agent	Add pool for recycling of FBOs of offscreen windows and textures.
+		10/19/26	agent	Execute hook chains via cached, compiled execution plans with preparsed slot parameters.
+		10/19/26	agent	Fuse runs of per-pixel shader slots, marked as "Fusable:", into single shader passes.
+		10/19/26	agent	Cache encoded CLUTs of the CLUT builtins, only reencode changed entries, draw Bits++ T-Lock line in one draw call.
 		
 	DESCRIPTION:
 	
@@ -35,6 +40,7 @@
 */
 
 #include "Screen.h"
+#include <ctype.h>
 
 static char texturePlanar1FragmentShaderSrc[] =
 "\n"
@@ -325,6 +331,7 @@ void PsychInitImagingPipelineDefaultsForWindowRecord(PsychWindowRecordType *wind
 	for (i=0; i<MAX_SCREEN_HOOKS; i++) {
 		windowRecord->HookChainEnabled[i]=FALSE;
 		windowRecord->HookChain[i]=NULL;
+		windowRecord->HookChainPlan[i]=NULL;
 	}
 	
 	// Disable all special framebuffer objects by default:
@@ -1009,7 +1016,7 @@ void PsychInitializeImagingPipeline(PsychWindowRecordType *windowRecord, int ima
 				
 				// Create anaglyph shader and set proper defaults: These can be changed from the M-File if wanted.
 				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-INFO: Creating internal anaglyph stereo compositing shader...\n");
-				glsl = PsychCreateGLSLProgram(anaglyphshadersrc, NULL, NULL);
+				glsl = PsychCreateGLSLProgram(windowRecord, anaglyphshadersrc, NULL, NULL);
 				if (glsl) {
 					// Bind it:
 					glUseProgram(glsl);
@@ -1059,7 +1066,7 @@ void PsychInitializeImagingPipeline(PsychWindowRecordType *windowRecord, int ima
 			case kPsychFreeCrossFusionStereo:
 				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-INFO: Creating internal dualview stereo compositing shader...\n");
 				
-				glsl = PsychCreateGLSLProgram(passthroughshadersrc, NULL, NULL);
+				glsl = PsychCreateGLSLProgram(windowRecord, passthroughshadersrc, NULL, NULL);
 				if (glsl) {
 					// Bind it:
 					glUseProgram(glsl);
@@ -1075,7 +1082,7 @@ void PsychInitializeImagingPipeline(PsychWindowRecordType *windowRecord, int ima
 					PsychErrorExitMsg(PsychError_user, "PTB-ERROR: Failed to create left channel dualview stereo processing shader -- Dualview stereo won't work!\n");
 				}
 				
-				glsl = PsychCreateGLSLProgram(passthroughshadersrc, NULL, NULL);
+				glsl = PsychCreateGLSLProgram(windowRecord, passthroughshadersrc, NULL, NULL);
 				if (glsl) {
 					// Bind it:
 					glUseProgram(glsl);
@@ -1099,7 +1106,7 @@ void PsychInitializeImagingPipeline(PsychWindowRecordType *windowRecord, int ima
 			case kPsychCompressedTRBLStereo:
 				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-INFO: Creating internal vertical split stereo compositing shader...\n");
 				
-				glsl = PsychCreateGLSLProgram(passthroughshadersrc, NULL, NULL);
+				glsl = PsychCreateGLSLProgram(windowRecord, passthroughshadersrc, NULL, NULL);
 				if (glsl) {
 					// Bind it:
 					glUseProgram(glsl);
@@ -1115,7 +1122,7 @@ void PsychInitializeImagingPipeline(PsychWindowRecordType *windowRecord, int ima
 					PsychErrorExitMsg(PsychError_user, "PTB-ERROR: Failed to create left channel dualview stereo processing shader -- Dualview stereo won't work!\n");
 				}
 				
-				glsl = PsychCreateGLSLProgram(passthroughshadersrc, NULL, NULL);
+				glsl = PsychCreateGLSLProgram(windowRecord, passthroughshadersrc, NULL, NULL);
 				if (glsl) {
 					// Bind it:
 					glUseProgram(glsl);
@@ -1175,21 +1182,291 @@ void PsychInitializeImagingPipeline(PsychWindowRecordType *windowRecord, int ima
 	return;
 }
 
+/* Process-wide GLSL program binary cache for PsychCreateGLSLProgram():
+ *
+ * Compiling and linking the builtin shaders of the imaging pipeline, the high
+ * precision texture shaders and the planar texture shaders is the dominant cost
+ * of opening a window with the full imaging pipeline enabled. The same sources
+ * get compiled again for each window and each texture shader assignment.
+ *
+ * Program objects are not shared between callers, as callers set per-program
+ * uniforms, e.g., different 'Image1' texture units for the same passthrough
+ * shader, and destroy their programs individually, possibly in a context which
+ * is not shared with the one of another window. Instead we cache the linked
+ * program binaries, as retrieved via GL_ARB_get_program_binary, keyed by a hash
+ * of the shader sources and the renderer identification strings. Each call still
+ * gets its own fresh program object, but created via glProgramBinary() instead of
+ * a full compile and link.
+ *
+ * Binaries are also persisted to disk in the Psychtoolbox configuration folder,
+ * so later sessions can skip compilation entirely. The environment variable
+ * PSYCHTOOLBOX_SHADERCACHE can be set to "0" to disable the disk cache, or to a
+ * folder path to store the cache files somewhere else. Drivers reject binaries
+ * from other driver versions at glProgramBinary() time. We then fall back to
+ * regular compilation and replace the stale cache entry.
+ */
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH			0x8741
+#endif
+
+// Magic id at start of each cache file, followed by hash, format and length of the binary:
+#define PSYCH_GLSLCACHE_MAGIC	"PTBGLSL1"
+
+typedef void (GLAPIENTRY *PsychGetProgramBinaryProcPtr)(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary);
+typedef void (GLAPIENTRY *PsychProgramBinaryProcPtr)(GLuint program, GLenum binaryFormat, const GLvoid *binary, GLsizei length);
+typedef void (GLAPIENTRY *PsychProgramParameteriProcPtr)(GLuint program, GLenum pname, GLint value);
+
+typedef struct PsychGLSLCacheEntry {
+	psych_uint64				hash;
+	GLenum						format;
+	GLsizei						length;
+	void*						binary;
+	struct PsychGLSLCacheEntry*	next;
+} PsychGLSLCacheEntry;
+
+static PsychGLSLCacheEntry*				glslCacheHead = NULL;
+static PsychGetProgramBinaryProcPtr		psych_glGetProgramBinary = NULL;
+static PsychProgramBinaryProcPtr		psych_glProgramBinary = NULL;
+static PsychProgramParameteriProcPtr	psych_glProgramParameteri = NULL;
+
+static void* PsychGLSLCacheGetProcAddress(const char* name)
+{
+	#if PSYCH_SYSTEM == PSYCH_LINUX
+		return((void*) glXGetProcAddressARB((const GLubyte*) name));
+	#endif
+
+	#if PSYCH_SYSTEM == PSYCH_WINDOWS
+		return((void*) wglGetProcAddress(name));
+	#endif
+
+	#if PSYCH_SYSTEM == PSYCH_OSX
+		// Defined in glew.c:
+		extern void* NSGLGetProcAddress(const GLubyte *name);
+		return(NSGLGetProcAddress((const GLubyte*) name));
+	#endif
+}
+
+// Check if program binaries are supported by the context of 'windowRecord', which must be the current context:
+static psych_bool PsychGLSLCacheSupported(PsychWindowRecordType *windowRecord)
+{
+	if (!(windowRecord->gfxcaps & kPsychGfxCapProgramBinary)) return(FALSE);
+
+	// Entry points are context specific on some systems, so resolve them for the current context at each use:
+	psych_glGetProgramBinary = (PsychGetProgramBinaryProcPtr) PsychGLSLCacheGetProcAddress("glGetProgramBinary");
+	psych_glProgramBinary = (PsychProgramBinaryProcPtr) PsychGLSLCacheGetProcAddress("glProgramBinary");
+	psych_glProgramParameteri = (PsychProgramParameteriProcPtr) PsychGLSLCacheGetProcAddress("glProgramParameteri");
+
+	return((psych_glGetProgramBinary && psych_glProgramBinary && psych_glProgramParameteri) ? TRUE : FALSE);
+}
+
+// 64 bit FNV-1a hash, continued from 'hash' over string 'str', including its terminating zero:
+static psych_uint64 PsychGLSLCacheHashString(psych_uint64 hash, const char* str)
+{
+	if (str == NULL) str = "";
+
+	do {
+		hash ^= (psych_uint64) (unsigned char) *str;
+		hash *= 1099511628211ULL;
+	} while (*(str++));
+
+	return(hash);
+}
+
+// Compute cache key for given shader sources on the current renderer and driver:
+static psych_uint64 PsychGLSLCacheComputeHash(const char* fragmentsrc, const char* vertexsrc, const char* primitivesrc)
+{
+	psych_uint64 hash = 14695981039346656037ULL;
+
+	hash = PsychGLSLCacheHashString(hash, fragmentsrc);
+	hash = PsychGLSLCacheHashString(hash, vertexsrc);
+	hash = PsychGLSLCacheHashString(hash, primitivesrc);
+	hash = PsychGLSLCacheHashString(hash, (const char*) glGetString(GL_VENDOR));
+	hash = PsychGLSLCacheHashString(hash, (const char*) glGetString(GL_RENDERER));
+	hash = PsychGLSLCacheHashString(hash, (const char*) glGetString(GL_VERSION));
+
+	return(hash);
+}
+
+// Build filename of disk cache file for 'hash'. Returns FALSE if disk cache is disabled or unavailable:
+static psych_bool PsychGLSLCacheGetFilename(psych_uint64 hash, char* filename, size_t maxlen)
+{
+	const char* cachedir = getenv("PSYCHTOOLBOX_SHADERCACHE");
+	const char* separator = "";
+
+	// Disk cache disabled by usercode?
+	if (cachedir && (strcmp(cachedir, "0") == 0)) return(FALSE);
+
+	// Default to Psychtoolbox configuration folder, which always ends with a separator:
+	if ((cachedir == NULL) || (strlen(cachedir) == 0)) {
+		cachedir = PsychRuntimeGetPsychtoolboxRoot(TRUE);
+		if (strlen(cachedir) == 0) return(FALSE);
+	}
+	else {
+		if ((cachedir[strlen(cachedir) - 1] != '/') && (cachedir[strlen(cachedir) - 1] != '\\')) separator = "/";
+	}
+
+	snprintf(filename, maxlen, "%s%sPsychGLSLProgramCache_%08x%08x.bin", cachedir, separator, (unsigned int) (hash >> 32), (unsigned int) (hash & 0xffffffff));
+	return(TRUE);
+}
+
+// Lookup cache entry for 'hash' in memory, or try to load it from disk if not in memory:
+static PsychGLSLCacheEntry* PsychGLSLCacheLookup(psych_uint64 hash)
+{
+	PsychGLSLCacheEntry* entry;
+	char filename[FILENAME_MAX];
+	char magic[8];
+	psych_uint64 filehash;
+	psych_uint32 format, length;
+	FILE* fd;
+
+	for (entry = glslCacheHead; entry; entry = entry->next) {
+		if (entry->hash == hash) return(entry);
+	}
+
+	if (!PsychGLSLCacheGetFilename(hash, filename, sizeof(filename)) || ((fd = fopen(filename, "rb")) == NULL)) return(NULL);
+
+	// Validate header:
+	if ((fread(magic, sizeof(magic), 1, fd) != 1) || (memcmp(magic, PSYCH_GLSLCACHE_MAGIC, sizeof(magic)) != 0) ||
+		(fread(&filehash, sizeof(filehash), 1, fd) != 1) || (filehash != hash) ||
+		(fread(&format, sizeof(format), 1, fd) != 1) || (fread(&length, sizeof(length), 1, fd) != 1) ||
+		(length == 0) || (length > 64 * 1024 * 1024)) {
+		if (PsychPrefStateGet_Verbosity() > 4) printf("PTB-INFO: Ignoring invalid GLSL program cache file %s.\n", filename);
+		fclose(fd);
+		return(NULL);
+	}
+
+	entry = (PsychGLSLCacheEntry*) calloc(1, sizeof(PsychGLSLCacheEntry));
+	if (entry) entry->binary = malloc((size_t) length);
+	if ((entry == NULL) || (entry->binary == NULL) || (fread(entry->binary, (size_t) length, 1, fd) != 1)) {
+		if (entry) free(entry->binary);
+		free(entry);
+		fclose(fd);
+		return(NULL);
+	}
+	fclose(fd);
+
+	entry->hash = hash;
+	entry->format = (GLenum) format;
+	entry->length = (GLsizei) length;
+	entry->next = glslCacheHead;
+	glslCacheHead = entry;
+
+	if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Loaded GLSL program binary of %i bytes from cache file %s.\n", (int) length, filename);
+
+	return(entry);
+}
+
+// Remove entry for 'hash' from memory and disk cache, e.g., after the driver rejected it:
+static void PsychGLSLCacheRemove(psych_uint64 hash)
+{
+	PsychGLSLCacheEntry** pentry;
+	PsychGLSLCacheEntry* entry;
+	char filename[FILENAME_MAX];
+
+	for (pentry = &glslCacheHead; *pentry; pentry = &((*pentry)->next)) {
+		if ((*pentry)->hash == hash) {
+			entry = *pentry;
+			*pentry = entry->next;
+			free(entry->binary);
+			free(entry);
+			break;
+		}
+	}
+
+	if (PsychGLSLCacheGetFilename(hash, filename, sizeof(filename))) remove(filename);
+}
+
+// Retrieve binary of freshly linked program 'glsl' and store it under 'hash' in memory and on disk:
+static void PsychGLSLCacheStore(psych_uint64 hash, GLuint glsl)
+{
+	PsychGLSLCacheEntry* entry;
+	char filename[FILENAME_MAX];
+	psych_uint32 format, length;
+	GLint binlength = 0;
+	FILE* fd;
+
+	glGetProgramiv(glsl, GL_PROGRAM_BINARY_LENGTH, &binlength);
+	if (glGetError() || (binlength <= 0)) return;
+
+	entry = (PsychGLSLCacheEntry*) calloc(1, sizeof(PsychGLSLCacheEntry));
+	if (entry) entry->binary = malloc((size_t) binlength);
+	if ((entry == NULL) || (entry->binary == NULL)) {
+		if (entry) free(entry->binary);
+		free(entry);
+		return;
+	}
+
+	psych_glGetProgramBinary(glsl, (GLsizei) binlength, &(entry->length), &(entry->format), entry->binary);
+	if (glGetError() || (entry->length <= 0)) {
+		free(entry->binary);
+		free(entry);
+		return;
+	}
+
+	entry->hash = hash;
+	entry->next = glslCacheHead;
+	glslCacheHead = entry;
+
+	// Persist to disk. Failure to do so is not critical, we just have to compile again next session:
+	if (PsychGLSLCacheGetFilename(hash, filename, sizeof(filename)) && ((fd = fopen(filename, "wb")) != NULL)) {
+		format = (psych_uint32) entry->format;
+		length = (psych_uint32) entry->length;
+		if ((fwrite(PSYCH_GLSLCACHE_MAGIC, 8, 1, fd) != 1) || (fwrite(&hash, sizeof(hash), 1, fd) != 1) ||
+			(fwrite(&format, sizeof(format), 1, fd) != 1) || (fwrite(&length, sizeof(length), 1, fd) != 1) ||
+			(fwrite(entry->binary, (size_t) length, 1, fd) != 1)) {
+			fclose(fd);
+			remove(filename);
+			if (PsychPrefStateGet_Verbosity() > 4) printf("PTB-INFO: Failed to write GLSL program cache file %s.\n", filename);
+		}
+		else {
+			fclose(fd);
+			if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Stored GLSL program binary of %i bytes in cache file %s.\n", (int) length, filename);
+		}
+	}
+
+	return;
+}
+
+/* PsychFreeGLSLProgramCache()
+ *  Release all in-memory GLSL program cache entries. Called at Screen shutdown.
+ *  Disk cache files are kept for use by later sessions.
+ */
+void PsychFreeGLSLProgramCache(void)
+{
+	PsychGLSLCacheEntry* entry;
+
+	while ((entry = glslCacheHead)) {
+		glslCacheHead = entry->next;
+		free(entry->binary);
+		free(entry);
+	}
+
+	return;
+}
+
 /* PsychCreateGLSLProgram()
  *  Try to create GLSL shader from source strings and return handle to new shader.
  *  Returns the shader handle if it worked, 0 otherwise.
  *
+ *  windowRecord - Window whose OpenGL context is bound. Used for detection of program binary cache support.
  *  fragmentsrc - Source string for fragment shader. NULL if none needed.
  *  vertexsrc   - Source string for vertex shader. NULL if none needed.
  *  primitivesrc - Source string for primitive shader. NULL if none needed.
  *
  */
-GLuint PsychCreateGLSLProgram(const char* fragmentsrc, const char* vertexsrc, const char* primitivesrc)
+GLuint PsychCreateGLSLProgram(PsychWindowRecordType *windowRecord, const char* fragmentsrc, const char* vertexsrc, const char* primitivesrc)
 {
 	GLuint glsl = 0;
 	GLuint shader;
 	GLint status;
 	char errtxt[10000];
+	psych_bool usecache;
+	psych_uint64 hash = 0;
+	PsychGLSLCacheEntry* entry;
 	
 	// Reset error state:
 	while (glGetError());
@@ -1200,8 +1477,33 @@ GLuint PsychCreateGLSLProgram(const char* fragmentsrc, const char* vertexsrc, co
 		return(0);
 	}
 	
+	// Program binary cache available? Then try to create program from a cached binary:
+	usecache = PsychGLSLCacheSupported(windowRecord);
+	if (usecache) {
+		hash = PsychGLSLCacheComputeHash(fragmentsrc, vertexsrc, primitivesrc);
+		entry = PsychGLSLCacheLookup(hash);
+		if (entry) {
+			glsl = glCreateProgram();
+			psych_glProgramBinary(glsl, entry->format, entry->binary, entry->length);
+			glGetProgramiv(glsl, GL_LINK_STATUS, &status);
+			if ((glGetError() == GL_NO_ERROR) && (status == GL_TRUE)) {
+				if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Created GLSL program %i from cached program binary.\n", (int) glsl);
+				return(glsl);
+			}
+
+			// Rejected by driver, e.g., after a driver upgrade. Drop it and compile from source:
+			if (PsychPrefStateGet_Verbosity() > 4) printf("PTB-INFO: Cached GLSL program binary rejected by driver. Recompiling from source.\n");
+			glDeleteProgram(glsl);
+			PsychGLSLCacheRemove(hash);
+			while (glGetError());
+		}
+	}
+
 	// Create GLSL program object:
 	glsl = glCreateProgram();
+
+	// Allow retrieval of program binary for the cache after linking:
+	if (usecache) psych_glProgramParameteri(glsl, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 	
 	// Fragment shader wanted?
 	if (fragmentsrc) {
@@ -1291,6 +1593,12 @@ GLuint PsychCreateGLSLProgram(const char* fragmentsrc, const char* vertexsrc, co
 	
 	while (glGetError());
 
+	// Store binary of new program in cache for reuse by later calls and sessions:
+	if (usecache) {
+		PsychGLSLCacheStore(hash, glsl);
+		while (glGetError());
+	}
+
 	// Return new GLSL program object handle:
 	return(glsl);
 }
@@ -1322,6 +1630,7 @@ psych_bool PsychCreateFBO(PsychFBO** fbo, GLenum fboInternalFormat, psych_bool n
 		(*fbo)->fboid = 0;
 		(*fbo)->stexid = 0;
 		(*fbo)->ztexid = 0;
+		(*fbo)->format = 0;
 		
 		(*fbo)->width = width;
 		(*fbo)->height = height;
@@ -1784,10 +2093,284 @@ psych_bool PsychCreateFBO(PsychFBO** fbo, GLenum fboInternalFormat, psych_bool n
 	// Test all GL errors:
 	PsychTestForGLErrors();
 
+	// Remember color buffer format if we created the color buffer ourselves. This marks the FBO as recyclable:
+	if (fboInternalFormat > 1) (*fbo)->format = fboInternalFormat;
+
 	// Well done.
 	return(TRUE);
 }
 
+/* FBO pool for recycling of framebuffer objects:
+ *
+ * Offscreen windows, 'TransformTexture' targets and textures normalized by
+ * PsychNormalizeTextureOrientation() get a PsychFBO with its own color buffer
+ * and optional depth/stencil buffers. Scripts which create and close many
+ * transient offscreen windows per trial would otherwise allocate and destroy
+ * these GPU ressources at a high rate, which causes allocation stalls.
+ *
+ * When such a window or texture gets closed, its FBO is put into a pool instead
+ * of being destroyed. PsychCreatePooledFBO() recycles a pooled FBO of matching
+ * size, color format, depth buffer and multisample configuration, if any, and
+ * only creates a new one otherwise. FBOs are not shared between OpenGL contexts,
+ * so each pool entry is tagged with its context and can only be recycled by, or
+ * deleted from, that context. All entries of a context are deleted when its
+ * onscreen window gets closed.
+ *
+ * The pool enforces a memory budget of 256 MB by default. Least recently released
+ * entries get evicted when the budget is exceeded. The environment variable
+ * PSYCHTOOLBOX_FBOPOOL_MAXMB sets a different budget in Megabytes, a setting of
+ * zero disables pooling.
+ */
+typedef struct PsychFBOPoolEntry {
+	PsychFBO*					fbo;			// The pooled FBO.
+	void*						context;		// OpenGL context in which it was created.
+	size_t						bytes;			// Estimated VRAM consumption.
+	double						lastused;		// Time of release into the pool.
+	struct PsychFBOPoolEntry*	next;
+} PsychFBOPoolEntry;
+
+static PsychFBOPoolEntry*	fboPoolHead = NULL;
+static double				fboPoolBudget = -1;
+static size_t				fboPoolBytes = 0;
+static int					fboPoolCount = 0;
+static int					fboPoolHits = 0;
+static int					fboPoolMisses = 0;
+static int					fboPoolEvictions = 0;
+
+// Delete all OpenGL objects of a PsychFBO. The PsychFBO struct itself is not freed:
+static void PsychDeleteFBOObjects(PsychFBO* fboptr)
+{
+	// Detach and delete color buffer texture/renderbuffer:
+	if (fboptr->coltexid) {
+		if (glIsTexture(fboptr->coltexid)) {
+			// Color buffer is a texture:
+			glDeleteTextures(1, &(fboptr->coltexid));
+		}
+		else {
+			// Color buffer is a renderbuffer:
+			glDeleteRenderbuffersEXT(1, &(fboptr->coltexid));
+		}
+	}
+
+	// Detach and delete depth buffer (and probably stencil buffer) texture, if any:
+	if (fboptr->ztexid) {
+		if (glIsTexture(fboptr->ztexid)) {
+			// Depths buffer is a texture:
+			glDeleteTextures(1, &(fboptr->ztexid));
+		}
+		else {
+			// Depths buffer is a renderbuffer:
+			glDeleteRenderbuffersEXT(1, &(fboptr->ztexid));
+		}
+	}
+
+	// Detach and delete stencil renderbuffer, if a separate stencil buffer was needed:
+	if (fboptr->stexid) glDeleteRenderbuffersEXT(1, &(fboptr->stexid));
+
+	// Delete FBO itself:
+	if (fboptr->fboid) glDeleteFramebuffersEXT(1, &(fboptr->fboid));
+
+	return;
+}
+
+// Return pool budget in bytes, zero if pooling is disabled:
+static double PsychFBOPoolGetBudget(void)
+{
+	if (fboPoolBudget < 0) {
+		fboPoolBudget = 256;
+		if (getenv("PSYCHTOOLBOX_FBOPOOL_MAXMB")) fboPoolBudget = atof(getenv("PSYCHTOOLBOX_FBOPOOL_MAXMB"));
+		if (fboPoolBudget < 0) fboPoolBudget = 0;
+		fboPoolBudget = fboPoolBudget * 1024 * 1024;
+	}
+
+	return(fboPoolBudget);
+}
+
+// Rough estimate of VRAM consumption of a FBO:
+static size_t PsychFBOPoolEstimateBytes(PsychFBO* fbo)
+{
+	size_t bpp;
+
+	switch (fbo->format) {
+		case GL_RGBA16:
+		case GL_RGBA16_SNORM:
+		case GL_RGBA_FLOAT16_APPLE:
+		case GL_RGB_FLOAT16_APPLE:
+		case GL_RGB16_SNORM:
+			bpp = 8;
+		break;
+
+		case GL_RGBA_FLOAT32_APPLE:
+		case GL_RGB_FLOAT32_APPLE:
+			bpp = 16;
+		break;
+
+		default:
+			bpp = 4;
+	}
+
+	// Add 4 bytes per pixel for depth+stencil buffers:
+	if (fbo->ztexid) bpp += 4;
+
+	return(bpp * (size_t) fbo->width * (size_t) fbo->height * (size_t) ((fbo->multisample > 1) ? fbo->multisample : 1));
+}
+
+// Evict least recently used entries of context 'context' until the pool fits into the budget.
+// 'context' must be the currently bound OpenGL context:
+static void PsychFBOPoolEnforceBudget(void* context)
+{
+	PsychFBOPoolEntry** pentry;
+	PsychFBOPoolEntry** poldest;
+	PsychFBOPoolEntry* entry;
+
+	while ((double) fboPoolBytes > PsychFBOPoolGetBudget()) {
+		// Find least recently used entry which can be deleted in this context:
+		poldest = NULL;
+		for (pentry = &fboPoolHead; *pentry; pentry = &((*pentry)->next)) {
+			if (((*pentry)->context == context) && ((poldest == NULL) || ((*pentry)->lastused < (*poldest)->lastused))) poldest = pentry;
+		}
+
+		// Nothing left to evict in this context? Entries of other contexts will get deleted when their window closes:
+		if (poldest == NULL) break;
+
+		entry = *poldest;
+		*poldest = entry->next;
+
+		if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: FBO pool: Evicting %i x %i FBO %i to stay within budget.\n", entry->fbo->width, entry->fbo->height, entry->fbo->fboid);
+
+		PsychDeleteFBOObjects(entry->fbo);
+		free(entry->fbo);
+		fboPoolBytes -= entry->bytes;
+		fboPoolCount--;
+		fboPoolEvictions++;
+		free(entry);
+	}
+
+	return;
+}
+
+/* PsychCreatePooledFBO()
+ * Same as PsychCreateFBO() for creating a complete FBO with its own color buffer, but
+ * recycles a matching FBO from the FBO pool if possible. 'windowRecord' is the window
+ * whose OpenGL context is currently bound.
+ */
+psych_bool PsychCreatePooledFBO(PsychWindowRecordType *windowRecord, PsychFBO** fbo, GLenum fboInternalFormat, psych_bool needzbuffer, int width, int height, int multisample)
+{
+	PsychFBOPoolEntry** pentry;
+	PsychFBOPoolEntry* entry;
+	void* context = (void*) windowRecord->targetSpecific.contextObject;
+
+	for (pentry = &fboPoolHead; *pentry; pentry = &((*pentry)->next)) {
+		entry = *pentry;
+		if ((entry->context == context) && (entry->fbo->format == fboInternalFormat) && (entry->fbo->multisample == multisample) &&
+			(entry->fbo->width == width) && (entry->fbo->height == height) && (((entry->fbo->ztexid) ? TRUE : FALSE) == needzbuffer)) {
+			// Match: Remove from pool and hand it out:
+			*pentry = entry->next;
+			*fbo = entry->fbo;
+			fboPoolBytes -= entry->bytes;
+			fboPoolCount--;
+			fboPoolHits++;
+			free(entry);
+
+			if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: FBO pool: Recycling %i x %i FBO %i.\n", width, height, (*fbo)->fboid);
+			return(TRUE);
+		}
+	}
+
+	// No match. Create a new one:
+	if (PsychFBOPoolGetBudget() > 0) fboPoolMisses++;
+	return(PsychCreateFBO(fbo, fboInternalFormat, needzbuffer, width, height, multisample));
+}
+
+/* PsychRecycleTextureFBOs()
+ * Called when texture or offscreen window 'windowRecord' gets closed: Move all FBOs with
+ * their own color buffers into the FBO pool for later reuse, and detach them from the
+ * windowRecord. Must be called before PsychFreeTextureForWindowRecord(), so the texture
+ * which backs an offscreen window does not get destroyed.
+ */
+void PsychRecycleTextureFBOs(PsychWindowRecordType *windowRecord)
+{
+	PsychFBOPoolEntry* entry;
+	PsychFBO* fboptr;
+	void* context = (void*) windowRecord->targetSpecific.contextObject;
+	int i, j;
+
+	// Pooling disabled or no OpenGL context left for this window?
+	if ((PsychFBOPoolGetBudget() <= 0) || (context == NULL)) return;
+
+	PsychSetGLContext(windowRecord);
+
+	for (i = 0; i < windowRecord->fboCount; i++) {
+		fboptr = windowRecord->fboTable[i];
+
+		// Only complete FBOs which own their color buffer are recyclable:
+		if ((fboptr == NULL) || (fboptr->format == 0) || (fboptr->fboid == 0)) continue;
+
+		entry = (PsychFBOPoolEntry*) calloc(1, sizeof(PsychFBOPoolEntry));
+		if (entry == NULL) continue;
+
+		// Delete all references to this fbo, so it doesn't get destroyed at window close:
+		for (j = 0; j < windowRecord->fboCount; j++) if (fboptr == windowRecord->fboTable[j]) windowRecord->fboTable[j] = NULL;
+		if (windowRecord->textureNumber == fboptr->coltexid) windowRecord->textureNumber = 0;
+
+		entry->fbo = fboptr;
+		entry->context = context;
+		entry->bytes = PsychFBOPoolEstimateBytes(fboptr);
+		PsychGetAdjustedPrecisionTimerSeconds(&(entry->lastused));
+		entry->next = fboPoolHead;
+		fboPoolHead = entry;
+		fboPoolBytes += entry->bytes;
+		fboPoolCount++;
+	}
+
+	PsychFBOPoolEnforceBudget(context);
+
+	return;
+}
+
+/* PsychFBOPoolPurgeContext()
+ * Delete all pooled FBOs which belong to the OpenGL context of onscreen window 'windowRecord'.
+ * Called at onscreen window close time, while the windows context is still bound.
+ */
+void PsychFBOPoolPurgeContext(PsychWindowRecordType *windowRecord)
+{
+	PsychFBOPoolEntry** pentry;
+	PsychFBOPoolEntry* entry;
+	void* context = (void*) windowRecord->targetSpecific.contextObject;
+
+	pentry = &fboPoolHead;
+	while (*pentry) {
+		entry = *pentry;
+		if (entry->context == context) {
+			*pentry = entry->next;
+			PsychDeleteFBOObjects(entry->fbo);
+			free(entry->fbo);
+			fboPoolBytes -= entry->bytes;
+			fboPoolCount--;
+			free(entry);
+		}
+		else {
+			pentry = &(entry->next);
+		}
+	}
+
+	return;
+}
+
+/* PsychFBOPoolGetStats()
+ * Return current number of pooled FBOs, their estimated memory consumption in bytes,
+ * and the number of pool hits, misses and evictions so far.
+ */
+void PsychFBOPoolGetStats(int* count, double* bytes, int* hits, int* misses, int* evictions)
+{
+	*count = fboPoolCount;
+	*bytes = (double) fboPoolBytes;
+	*hits = fboPoolHits;
+	*misses = fboPoolMisses;
+	*evictions = fboPoolEvictions;
+	return;
+}
+
 /* PsychCreateShadowFBOForTexture()
  * Check if provided PTB texture already has a PsychFBO attached. Do nothing if so.
  * If a FBO is missing, create one.
@@ -1832,7 +2415,7 @@ void PsychCreateShadowFBOForTexture(PsychWindowRecordType *textureRecord, psych_
 			// Need 32 bpc floating point precision?
 			if (forImagingmode & kPsychNeed32BPCFloat) { fboInternalFormat = GL_RGBA_FLOAT32_APPLE; textureRecord->bpc = 32; }
 			
-			PsychCreateFBO(&(textureRecord->fboTable[0]), fboInternalFormat, (PsychPrefStateGet_3DGfx() > 0) ? TRUE : FALSE, (int) PsychGetWidthFromRect(textureRecord->rect), (int) PsychGetHeightFromRect(textureRecord->rect), 0);
+			PsychCreatePooledFBO(textureRecord, &(textureRecord->fboTable[0]), fboInternalFormat, (PsychPrefStateGet_3DGfx() > 0) ? TRUE : FALSE, (int) PsychGetWidthFromRect(textureRecord->rect), (int) PsychGetHeightFromRect(textureRecord->rect), 0);
 			
 			// Manually set up the texture id from our color attachment texture id:
 			textureRecord->textureNumber = textureRecord->fboTable[0]->coltexid;
@@ -1991,7 +2574,7 @@ void PsychNormalizeTextureOrientation(PsychWindowRecordType *sourceRecord)
 		}
 		
 		// Now create proper FBO:
-		if (!PsychCreateFBO(&(sourceRecord->fboTable[0]), (GLenum) fboInternalFormat, needzbuffer, width, height, 0)) {
+		if (!PsychCreatePooledFBO(sourceRecord, &(sourceRecord->fboTable[0]), (GLenum) fboInternalFormat, needzbuffer, width, height, 0)) {
 			PsychErrorExitMsg(PsychError_internal, "Failed to normalize texture orientation - Creation of framebuffer object failed!");
 		}
 		
@@ -2067,6 +2650,35 @@ void PsychNormalizeTextureOrientation(PsychWindowRecordType *sourceRecord)
 	return;
 }
 
+/* Internal: PsychPipelineInvalidateHookPlan() - Discard compiled execution plan of a hook-chain.
+ * Must be called whenever slots are added to or removed from the chain. The plan gets recompiled
+ * on next execution of the chain. Fused shaders owned by the plan are deleted, so this needs a
+ * still existing OpenGL context if the plan contains fused shaders.
+ */
+static void PsychPipelineInvalidateHookPlan(PsychWindowRecordType *windowRecord, int hookidx)
+{
+	PsychHookPlan* plan = windowRecord->HookChainPlan[hookidx];
+	int i;
+
+	if (plan) {
+		for (i = 0; i < plan->numOps; i++) {
+			if (plan->ops[i].fusedHook) {
+				if (plan->ops[i].fusedHook->shaderid) {
+					PsychSetGLContext(windowRecord);
+					glDeleteProgram(plan->ops[i].fusedHook->shaderid);
+				}
+				free(plan->ops[i].fusedHook->idString);
+				free(plan->ops[i].fusedHook->pString1);
+				free(plan->ops[i].fusedHook);
+				free(plan->ops[i].fusedUniforms);
+			}
+		}
+		free(plan->ops);
+		free(plan);
+		windowRecord->HookChainPlan[hookidx] = NULL;
+	}
+}
+
 /* PsychShutdownImagingPipeline()
  * Shutdown imaging pipeline for a windowRecord and free all ressources associated with it.
  */
@@ -2078,6 +2690,13 @@ void PsychShutdownImagingPipeline(PsychWindowRecordType *windowRecord, psych_boo
 	
 	// Do OpenGL specific cleanup:
 	if (openglpart) {
+		// Discard all execution plans, while the fused shaders they own can still be deleted:
+		for (i=0; i<MAX_SCREEN_HOOKS; i++) PsychPipelineInvalidateHookPlan(windowRecord, i);
+
+		// Delete VBO of cached Bits++ T-Lock line:
+		if (windowRecord->clutCache.tlockVBO) glDeleteBuffers(1, &(windowRecord->clutCache.tlockVBO));
+		windowRecord->clutCache.tlockVBO = 0;
+
 		// Yes. Mode specific cleanup:
 		for (i=0; i<windowRecord->fboCount; i++) {
 			// Delete i'th FBO, if any:
@@ -2086,35 +2705,8 @@ void PsychShutdownImagingPipeline(PsychWindowRecordType *windowRecord, psych_boo
 				// Delete all remaining references to this fbo:
 				for (i=0; i<windowRecord->fboCount; i++) if (fboptr == windowRecord->fboTable[i]) windowRecord->fboTable[i] = NULL;
 				
-				// Detach and delete color buffer texture/renderbuffer:
-				if (fboptr->coltexid) {
-					if (glIsTexture(fboptr->coltexid)) {
-						// Color buffer is a texture:
-						glDeleteTextures(1, &(fboptr->coltexid));
-					}
-					else {
-						// Color buffer is a renderbuffer:
-						glDeleteRenderbuffersEXT(1, &(fboptr->coltexid));
-					}
-				}
-
-				// Detach and delete depth buffer (and probably stencil buffer) texture, if any:
-				if (fboptr->ztexid) {
-					if (glIsTexture(fboptr->ztexid)) {
-						// Depths buffer is a texture:
-						glDeleteTextures(1, &(fboptr->ztexid));
-					}
-					else {
-						// Depths buffer is a renderbuffer:
-						glDeleteRenderbuffersEXT(1, &(fboptr->ztexid));
-					}
-				}
-
-				// Detach and delete stencil renderbuffer, if a separate stencil buffer was needed:
-				if (fboptr->stexid) glDeleteRenderbuffersEXT(1, &(fboptr->stexid));
-
-				// Delete FBO itself:
-				if (fboptr->fboid) glDeleteFramebuffersEXT(1, &(fboptr->fboid));
+				// Detach and delete all buffers and the FBO itself:
+				PsychDeleteFBOObjects(fboptr);
 				
 				// Delete PsychFBO struct associated with this FBO:
 				free(fboptr); fboptr = NULL;
@@ -2131,6 +2723,11 @@ void PsychShutdownImagingPipeline(PsychWindowRecordType *windowRecord, psych_boo
 			PsychPipelineResetHook(windowRecord, PsychHookPointNames[i]);
 		}
 		
+		// Release CLUT cache:
+		free(windowRecord->clutCache.rgb);
+		free(windowRecord->clutCache.runtimeCmd);
+		memset(&(windowRecord->clutCache), 0, sizeof(windowRecord->clutCache));
+
 		// Global off:
 		windowRecord->imagingMode=0;
 	}
@@ -2188,6 +2785,9 @@ PsychHookFunction* PsychAddNewHookFunction(PsychWindowRecordType *windowRecord,
 	// Allocate a hook structure:
 	hookfunc =	(PtrPsychHookFunction) calloc(1, sizeof(PsychHookFunction));
 	if (hookfunc==NULL) PsychErrorExitMsg(PsychError_outofMemory, "Failed to allocate memory for new hook function.");
+
+	// Chain changes, so its execution plan is outdated:
+	PsychPipelineInvalidateHookPlan(windowRecord, hookidx);
 	
 	// Enqueue at beginning or end of chain:
 	if (where==0) {
@@ -2271,6 +2871,7 @@ void PsychPipelineResetHook(PsychWindowRecordType *windowRecord, const char* hoo
 
 	// Null-out hook chain:
 	windowRecord->HookChain[hookidx]=NULL;
+	PsychPipelineInvalidateHookPlan(windowRecord, hookidx);
 	return;
 }
 
@@ -2391,6 +2992,7 @@ void PsychPipelineDeleteHookSlot(PsychWindowRecordType *windowRecord, const char
 	
 	// Detach it from hookchain, update predecessors next pointer so it points to successor:
 	*prehookfunc = hookfunc->next;
+	PsychPipelineInvalidateHookPlan(windowRecord, hookidx);
 	
 	// Detached. Delete hookfunc:
 	free(hookfunc->pString1);
@@ -2563,15 +3165,583 @@ psych_bool PsychIsHookChainOperational(PsychWindowRecordType *windowRecord, int
 	return(TRUE);
 }
 
+/* PsychPipelineParseHookSlotParams()
+ * Parse the parameter string pString1 of a hook slot once, so execution of the slot doesn't need to
+ * parse it again and again on each flip. Parameters are only marked valid if all of them parse. If
+ * a parameter is malformed, execution falls back to parsing pString1 and reports the error as before.
+ */
+static void PsychPipelineParseHookSlotParams(PsychHookFunction* hookfunc)
+{
+	static const char* texspecs[4] = { "TEXTURE1D", "TEXTURE2D", "TEXTURERECT2D", "TEXTURE3D" };
+	static const GLenum textargets[4] = { GL_TEXTURE_1D, GL_TEXTURE_2D, GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_3D };
+	PsychHookSlotParams* params = &(hookfunc->params);
+	const char* pstr = (hookfunc->pString1) ? hookfunc->pString1 : "";
+	const char* pstrpos;
+	char fmt[32];
+	int i, texunit, texid;
+
+	memset(params, 0, sizeof(PsychHookSlotParams));
+	params->scaleX = params->scaleY = 1.0;
+	params->yPosition = 1;
+
+	// Override blitter, as selected in PsychPipelineExecuteBlitter():
+	if (strstr(pstr, "Blitter:")) {
+		if (strstr(pstr, "Blitter:IdentityBlit")) params->blitter = (void*) &PsychBlitterIdentity;
+		if (strstr(pstr, "Blitter:DisplayListBlit")) params->blitter = (void*) &PsychBlitterDisplayList;
+		if (params->blitter == NULL) return;
+	}
+
+	// Texture bindings, in the order they get bound by PsychPipelineExecuteBlitter():
+	for (i = 0; i < 4; i++) {
+		sprintf(fmt, "%s(%%i)=%%i", texspecs[i]);
+		pstrpos = pstr;
+		while ((pstrpos = strstr(pstrpos, texspecs[i]))) {
+			if (2 == sscanf(pstrpos, fmt, &texunit, &texid)) {
+				if (params->numTextures >= kPsychMaxHookSlotTextures) return;
+				params->texTarget[params->numTextures] = textargets[i];
+				params->texUnit[params->numTextures] = texunit;
+				params->texId[params->numTextures] = (GLuint) texid;
+				params->numTextures++;
+			}
+			pstrpos++;
+		}
+	}
+
+	// Blitter parameters:
+	if ((pstrpos = strstr(pstr, "OvrSize:"))) {
+		if (sscanf(pstrpos, "OvrSize:%i:%i", &(params->ovrWidth), &(params->ovrHeight)) != 2) return;
+		params->ovrSize = TRUE;
+	}
+	if (strstr(pstr, "Bilinear")) params->bilinear = TRUE;
+	if ((pstrpos = strstr(pstr, "Offset:")) && (sscanf(pstrpos, "Offset:%i:%i", &(params->offsetX), &(params->offsetY)) != 2)) return;
+	if ((pstrpos = strstr(pstr, "Scaling:")) && (sscanf(pstrpos, "Scaling:%f:%f", &(params->scaleX), &(params->scaleY)) != 2)) return;
+	if ((pstrpos = strstr(pstr, "Handle:")) && (sscanf(pstrpos, "Handle:%u", &(params->displayList)) != 1)) return;
+
+	// Builtin function parameters:
+	if ((hookfunc->hookfunctype == kPsychBuiltinFunc) && strstr(hookfunc->idString, "Builtin:RestrictToScissorROI") &&
+		(4 != sscanf(pstr, "%i:%i:%i:%i", &(params->scissor[0]), &(params->scissor[1]), &(params->scissor[2]), &(params->scissor[3])))) return;
+	if ((pstrpos = strstr(pstr, "yPosition=")) && (sscanf(pstrpos, "yPosition=%i", &(params->yPosition)) != 1)) return;
+	if ((pstrpos = strstr(pstr, "xPosition=")) && (sscanf(pstrpos, "xPosition=%i", &(params->xPosition)) != 1)) return;
+
+	// Per-pixel entry function of the shader for shader fusion:
+	if ((pstrpos = strstr(pstr, "Fusable:")) && (sscanf(pstrpos, "Fusable:%63[A-Za-z0-9_]", params->fuseEntry) != 1)) params->fuseEntry[0] = 0;
+
+	params->valid = TRUE;
+	return;
+}
+
+/* PsychPipelineSameSlotTextures()
+ * Returns TRUE if two preparsed hook slots bind exactly the same textures.
+ */
+static psych_bool PsychPipelineSameSlotTextures(PsychHookSlotParams* p1, PsychHookSlotParams* p2)
+{
+	int i;
+	if (!p1->valid || !p2->valid || p1->numTextures != p2->numTextures) return(FALSE);
+	for (i = 0; i < p1->numTextures; i++) {
+		if (p1->texTarget[i] != p2->texTarget[i] || p1->texUnit[i] != p2->texUnit[i] || p1->texId[i] != p2->texId[i]) return(FALSE);
+	}
+	return(TRUE);
+}
+
+/* Shader fusion:
+ *
+ * A run of GLSL shader slots, each one followed by a Builtin:FlipFBOs ping-pong swap, needs one full
+ * pass over the image per slot. If all shaders of such a run only transform the color of each pixel,
+ * without sampling neighbour pixels or other positions of the input image, they can be fused into one
+ * shader which applies all transforms in one pass. Shaders opt in via "Fusable:name" in their slot's
+ * blitter string, where "name" is the per-pixel entry function vec4 name(vec4 incolor) of the shader,
+ * and the shaders main() must be equivalent to gl_FragColor = name(texture2DRect(Image, gl_TexCoord[0].st)).
+ *
+ * The fused program links the original fragment shader objects of each slot, recompiled from their
+ * source with all global functions and active uniforms renamed via #define's to names unique for each
+ * slot, and a generated main() which calls the entry functions of all slots in order. Uniform values
+ * are copied from the original slot shaders on each execution, so usercode can keep changing them.
+ * If fusion fails for whatever reason, the slots simply get executed one by one as before.
+ */
+#define kPsychMaxFusedStages	16
+#define kPsychMaxFuseNames		128
+#define kPsychMaxFuseShaders	8
+
+/* Returns TRUE if the shader slot hookfunc can be fused with neighbour slots. */
+static psych_bool PsychPipelineIsFusableSlot(PsychHookFunction* hookfunc)
+{
+	PsychHookSlotParams* p = &(hookfunc->params);
+	int i;
+
+	if ((hookfunc->hookfunctype != kPsychShaderFunc) || (hookfunc->shaderid == 0) || !p->valid || (p->fuseEntry[0] == 0)) return(FALSE);
+
+	// Only one-to-one blits of the input image:
+	if ((p->blitter && (p->blitter != (void*) &PsychBlitterIdentity)) || p->ovrSize || p->bilinear ||
+		(p->offsetX != 0) || (p->offsetY != 0) || (p->scaleX != 1) || (p->scaleY != 1)) return(FALSE);
+
+	// Texture unit 0 carries the input image:
+	for (i = 0; i < p->numTextures; i++) if (p->texUnit[i] == 0) return(FALSE);
+
+	return(TRUE);
+}
+
+/* Merge texture bindings of slot p2 into merged. Returns FALSE and leaves merged alone if they conflict. */
+static psych_bool PsychPipelineMergeSlotTextures(PsychHookSlotParams* merged, PsychHookSlotParams* p2)
+{
+	int i, j, n = merged->numTextures;
+
+	for (i = 0; i < p2->numTextures; i++) {
+		for (j = 0; j < merged->numTextures; j++) if (merged->texUnit[j] == p2->texUnit[i]) break;
+		if (j < merged->numTextures) {
+			// Unit already used: Only ok if the same texture is bound to it:
+			if ((merged->texTarget[j] != p2->texTarget[i]) || (merged->texId[j] != p2->texId[i])) return(FALSE);
+		}
+		else if (n++ >= kPsychMaxHookSlotTextures) return(FALSE);
+	}
+
+	for (i = 0; i < p2->numTextures; i++) {
+		for (j = 0; j < merged->numTextures; j++) if (merged->texUnit[j] == p2->texUnit[i]) break;
+		if (j == merged->numTextures) {
+			merged->texTarget[j] = p2->texTarget[i];
+			merged->texUnit[j] = p2->texUnit[i];
+			merged->texId[j] = p2->texId[i];
+			merged->numTextures++;
+		}
+	}
+
+	return(TRUE);
+}
+
+/* Add name to list of names to rename, unless already in list or a builtin. Returns new count, -1 on overflow. */
+static int PsychPipelineAddFuseName(char names[][kPsychMaxFuseNameLength], int count, const char* name)
+{
+	int i;
+
+	if ((count < 0) || (strncmp(name, "gl_", 3) == 0)) return(count);
+	for (i = 0; i < count; i++) if (strcmp(names[i], name) == 0) return(count);
+	if ((count >= kPsychMaxFuseNames) || (strlen(name) >= kPsychMaxFuseNameLength)) return(-1);
+	strcpy(names[count], name);
+	return(count + 1);
+}
+
+/* Add names of all functions declared or defined at global scope of GLSL source string src to names list. */
+static int PsychPipelineScanGLSLFunctions(const char* src, char names[][kPsychMaxFuseNameLength], int count)
+{
+	char prev[kPsychMaxFuseNameLength], last[kPsychMaxFuseNameLength];
+	const char* p = src;
+	int depth = 0, len;
+
+	prev[0] = last[0] = 0;
+	while (*p) {
+		// Skip comments and preprocessor lines:
+		if ((p[0] == '/') && (p[1] == '/')) {
+			while (*p && (*p != '\n')) p++;
+			continue;
+		}
+		if ((p[0] == '/') && (p[1] == '*')) {
+			for (p += 2; *p && !((p[0] == '*') && (p[1] == '/')); p++);
+			if (*p) p += 2;
+			continue;
+		}
+		if (*p == '#') {
+			while (*p && (*p != '\n')) p += ((p[0] == '\\') && p[1]) ? 2 : 1;
+			continue;
+		}
+
+		// Identifier or keyword?
+		if (isalpha((int) *p) || (*p == '_')) {
+			for (len = 0; isalnum((int) p[len]) || (p[len] == '_'); len++);
+			strcpy(prev, last);
+			if (len < kPsychMaxFuseNameLength) {
+				memcpy(last, p, len);
+				last[len] = 0;
+			}
+			else last[0] = 0;
+			p += len;
+			continue;
+		}
+
+		if (!isspace((int) *p)) {
+			// Type followed by name followed by '(' at global scope is a function:
+			if ((*p == '(') && (depth == 0) && prev[0] && last[0]) count = PsychPipelineAddFuseName(names, count, last);
+			if (*p == '{') depth++;
+			if (*p == '}') depth--;
+			prev[0] = last[0] = 0;
+		}
+		p++;
+	}
+
+	return(count);
+}
+
+/* Map GLSL uniform type to 1-4 = float vectors, 5-8 = int/bool vectors or samplers, 9-11 = 2x2 - 4x4 matrices, 0 = unsupported. */
+static int PsychPipelineFusedUniformKind(GLenum type)
+{
+	switch (type) {
+		case GL_FLOAT:				return(1);
+		case GL_FLOAT_VEC2:			return(2);
+		case GL_FLOAT_VEC3:			return(3);
+		case GL_FLOAT_VEC4:			return(4);
+		case GL_INT:
+		case GL_BOOL:
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_2D_RECT_ARB:	return(5);
+		case GL_INT_VEC2:
+		case GL_BOOL_VEC2:			return(6);
+		case GL_INT_VEC3:
+		case GL_BOOL_VEC3:			return(7);
+		case GL_INT_VEC4:
+		case GL_BOOL_VEC4:			return(8);
+		case GL_FLOAT_MAT2:			return(9);
+		case GL_FLOAT_MAT3:			return(10);
+		case GL_FLOAT_MAT4:			return(11);
+	}
+	return(0);
+}
+
+/* Copy current uniform values of the original slot shaders into the fused shader of op and bind it. */
+static void PsychPipelineSyncFusedUniforms(PsychHookPlanOp* op)
+{
+	PsychFusedUniform* u;
+	GLfloat f[16];
+	GLint v[4];
+	int i;
+
+	glUseProgram(op->fusedHook->shaderid);
+	for (i = 0; i < op->numFusedUniforms; i++) {
+		u = &(op->fusedUniforms[i]);
+		if (u->kind >= 5 && u->kind <= 8) glGetUniformiv(u->srcProgram, u->srcLocation, v);
+		else glGetUniformfv(u->srcProgram, u->srcLocation, f);
+
+		switch (u->kind) {
+			case 1:	 glUniform1fv(u->dstLocation, 1, f); break;
+			case 2:	 glUniform2fv(u->dstLocation, 1, f); break;
+			case 3:	 glUniform3fv(u->dstLocation, 1, f); break;
+			case 4:	 glUniform4fv(u->dstLocation, 1, f); break;
+			case 5:	 glUniform1iv(u->dstLocation, 1, v); break;
+			case 6:	 glUniform2iv(u->dstLocation, 1, v); break;
+			case 7:	 glUniform3iv(u->dstLocation, 1, v); break;
+			case 8:	 glUniform4iv(u->dstLocation, 1, v); break;
+			case 9:	 glUniformMatrix2fv(u->dstLocation, 1, GL_FALSE, f); break;
+			case 10: glUniformMatrix3fv(u->dstLocation, 1, GL_FALSE, f); break;
+			case 11: glUniformMatrix4fv(u->dstLocation, 1, GL_FALSE, f); break;
+		}
+	}
+}
+
+/* PsychPipelineFuseShaderSlots()
+ * Build a fused shader for the numStages shader slots in stages[] and turn op into a shader op which
+ * executes it. merged are the blitter parameters for the fused op, with the texture bindings of all
+ * slots. Returns FALSE if fusion isn't possible, with no changes to op.
+ */
+static psych_bool PsychPipelineFuseShaderSlots(PsychHookPlanOp* op, PsychHookFunction** stages, int numStages, PsychHookSlotParams* merged)
+{
+	char names[kPsychMaxFuseNames][kPsychMaxFuseNameLength];
+	char uname[kPsychMaxFuseNameLength + 16], dname[2 * kPsychMaxFuseNameLength];
+	char *defines = NULL, *source = NULL, *mainsrc = NULL, *idstring = NULL;
+	const char* strings[3];
+	GLint lengths[3];
+	GLuint shaders[kPsychMaxFuseShaders];
+	GLuint glsl, shader;
+	GLint status, nshaders, nuniforms, srclen, size, srcloc, dstloc;
+	GLenum type;
+	GLsizei namelen;
+	PsychFusedUniform* uniforms = NULL;
+	PsychHookFunction* fusedHook;
+	int k, i, e, count, numUniforms = 0, maxUniforms = 0;
+	size_t len;
+	char* pos;
+	psych_bool rc = FALSE;
+
+	// Need to query shader source code from the driver:
+	if (!glGetAttachedShaders || !glGetShaderSource || !glGetActiveUniform || !glGetUniformfv || !glGetUniformiv) return(FALSE);
+
+	while (glGetError());
+	glsl = glCreateProgram();
+	if (glsl == 0) return(FALSE);
+
+	mainsrc = (char*) calloc(1, 1024 + numStages * 3 * kPsychMaxFuseNameLength);
+	defines = (char*) malloc(kPsychMaxFuseNames * 3 * kPsychMaxFuseNameLength);
+	if (!mainsrc || !defines) goto fusefail;
+	strcpy(mainsrc, "#extension GL_ARB_texture_rectangle : enable\n\nuniform sampler2DRect psychFusedInputImage;\n\n");
+
+	for (k = 0; k < numStages; k++) {
+		// Names to rename: main(), the entry function and all active uniforms:
+		count = PsychPipelineAddFuseName(names, 0, "main");
+		count = PsychPipelineAddFuseName(names, count, stages[k]->params.fuseEntry);
+
+		glGetProgramiv(stages[k]->shaderid, GL_ACTIVE_UNIFORMS, &nuniforms);
+		for (i = 0; (i < nuniforms) && (count >= 0); i++) {
+			glGetActiveUniform(stages[k]->shaderid, i, sizeof(uname) - 1, &namelen, &size, &type, uname);
+			if (strncmp(uname, "gl_", 3) == 0) continue;
+			if (strchr(uname, '.') || (PsychPipelineFusedUniformKind(type) == 0)) goto fusefail;
+			if ((pos = strchr(uname, '['))) *pos = 0;
+			count = PsychPipelineAddFuseName(names, count, uname);
+		}
+
+		// ...and all global functions. Only fragment shaders are fusable:
+		glGetAttachedShaders(stages[k]->shaderid, kPsychMaxFuseShaders, &nshaders, shaders);
+		if (nshaders < 1) goto fusefail;
+		for (i = 0; (i < nshaders) && (count >= 0); i++) {
+			glGetShaderiv(shaders[i], GL_SHADER_TYPE, &status);
+			if (status != GL_FRAGMENT_SHADER) goto fusefail;
+			glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &srclen);
+			if (srclen < 1 || !(source = (char*) malloc(srclen + 1))) goto fusefail;
+			glGetShaderSource(shaders[i], srclen + 1, NULL, source);
+			count = PsychPipelineScanGLSLFunctions(source, names, count);
+			free(source); source = NULL;
+		}
+		if (count < 0) goto fusefail;
+
+		defines[0] = 0;
+		for (i = 0; i < count; i++) sprintf(defines + strlen(defines), "#define %s psychFused%i_%s\n", names[i], k, names[i]);
+
+		// Recompile all shader objects of the slot with renamed names. Defines go after a #version statement:
+		for (i = 0; i < nshaders; i++) {
+			glGetShaderiv(shaders[i], GL_SHADER_SOURCE_LENGTH, &srclen);
+			if (!(source = (char*) malloc(srclen + 1))) goto fusefail;
+			glGetShaderSource(shaders[i], srclen + 1, NULL, source);
+
+			pos = strstr(source, "#version");
+			if (pos) pos = strchr(pos, '\n');
+			len = (pos) ? (size_t) (pos - source + 1) : 0;
+			strings[0] = source;		lengths[0] = (GLint) len;
+			strings[1] = defines;		lengths[1] = (GLint) strlen(defines);
+			strings[2] = source + len;	lengths[2] = (GLint) strlen(source + len);
+
+			shader = glCreateShader(GL_FRAGMENT_SHADER);
+			glShaderSource(shader, 3, (const char**) strings, lengths);
+			glCompileShader(shader);
+			free(source); source = NULL;
+			glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+			glAttachShader(glsl, shader);
+			glDeleteShader(shader);
+			if (status != GL_TRUE) goto fusefail;
+		}
+
+		sprintf(mainsrc + strlen(mainsrc), "vec4 psychFused%i_%s(vec4 incolor);\n", k, stages[k]->params.fuseEntry);
+	}
+
+	// Generated main(): Sample input image, apply all stages in order:
+	strcat(mainsrc, "\nvoid main(void)\n{\n    vec4 color = texture2DRect(psychFusedInputImage, gl_TexCoord[0].st);\n");
+	for (k = 0; k < numStages; k++) sprintf(mainsrc + strlen(mainsrc), "    color = psychFused%i_%s(color);\n", k, stages[k]->params.fuseEntry);
+	strcat(mainsrc, "    gl_FragColor = color;\n}\n");
+	if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Fused shader main() follows:\n\n%s\n\n", mainsrc);
+
+	shader = glCreateShader(GL_FRAGMENT_SHADER);
+	glShaderSource(shader, 1, (const char**) &mainsrc, NULL);
+	glCompileShader(shader);
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	glAttachShader(glsl, shader);
+	glDeleteShader(shader);
+	if (status != GL_TRUE) goto fusefail;
+
+	glLinkProgram(glsl);
+	glGetProgramiv(glsl, GL_LINK_STATUS, &status);
+	if (status != GL_TRUE) goto fusefail;
+
+	// Map all active uniforms of the slot shaders, array elements one by one, to their renamed counterparts:
+	for (k = 0; k < numStages; k++) {
+		glGetProgramiv(stages[k]->shaderid, GL_ACTIVE_UNIFORMS, &nuniforms);
+		for (i = 0; i < nuniforms; i++) {
+			glGetActiveUniform(stages[k]->shaderid, i, sizeof(uname) - 1, &namelen, &size, &type, uname);
+			if (strncmp(uname, "gl_", 3) == 0) continue;
+			if ((pos = strchr(uname, '['))) *pos = 0;
+			len = strlen(uname);
+			for (e = 0; e < size; e++) {
+				if (size > 1) sprintf(uname + len, "[%i]", e);
+				sprintf(dname, "psychFused%i_%s", k, uname);
+				srcloc = glGetUniformLocation(stages[k]->shaderid, uname);
+				dstloc = glGetUniformLocation(glsl, dname);
+				if ((srcloc < 0) || (dstloc < 0)) continue;
+
+				if (numUniforms >= maxUniforms) {
+					maxUniforms += 32;
+					if (!(pos = (char*) realloc(uniforms, maxUniforms * sizeof(PsychFusedUniform)))) goto fusefail;
+					uniforms = (PsychFusedUniform*) pos;
+				}
+				uniforms[numUniforms].srcProgram = stages[k]->shaderid;
+				uniforms[numUniforms].srcLocation = srcloc;
+				uniforms[numUniforms].dstLocation = dstloc;
+				uniforms[numUniforms].kind = PsychPipelineFusedUniformKind(type);
+				numUniforms++;
+			}
+		}
+	}
+
+	// Synthetic shader slot for the fused shader:
+	len = 8;
+	for (k = 0; k < numStages; k++) len += strlen(stages[k]->idString) + 1;
+	fusedHook = (PsychHookFunction*) calloc(1, sizeof(PsychHookFunction));
+	idstring = (char*) malloc(len);
+	if (!fusedHook || !idstring || !(fusedHook->pString1 = strdup(""))) {
+		free(fusedHook);
+		goto fusefail;
+	}
+	strcpy(idstring, "Fused:");
+	for (k = 0; k < numStages; k++) {
+		if (k > 0) strcat(idstring, "+");
+		strcat(idstring, stages[k]->idString);
+	}
+
+	fusedHook->idString = idstring;
+	fusedHook->hookfunctype = kPsychShaderFunc;
+	fusedHook->shaderid = glsl;
+	fusedHook->params = *merged;
+	fusedHook->params.blitter = NULL;
+	fusedHook->params.fuseEntry[0] = 0;
+
+	glUseProgram(glsl);
+	glUniform1i(glGetUniformLocation(glsl, "psychFusedInputImage"), 0);
+	glUseProgram(0);
+
+	op->hookfunc = fusedHook;
+	op->opcode = kPsychPlanOpShader;
+	op->fusedHook = fusedHook;
+	op->numFused = numStages;
+	op->numFusedUniforms = numUniforms;
+	op->fusedUniforms = uniforms;
+	uniforms = NULL;
+	idstring = NULL;
+	glsl = 0;
+	rc = TRUE;
+
+fusefail:
+	if (!rc && (PsychPrefStateGet_Verbosity() > 4)) {
+		printf("PTB-INFO: Could not fuse %i shader slots, starting with slot '%s'. Executing them one by one.\n", numStages, stages[0]->idString);
+		if (glsl) {
+			glGetProgramInfoLog(glsl, sizeof(names) - 1, NULL, (GLchar*) names);
+			printf("%s\n", (char*) names);
+		}
+	}
+
+	if (glsl) glDeleteProgram(glsl);
+	free(uniforms);
+	free(idstring);
+	free(source);
+	free(defines);
+	free(mainsrc);
+	while (glGetError());
+
+	return(rc);
+}
+
+/* PsychPipelineFuseHookPlan()
+ * Replace all runs of fusable shader slots, separated by Builtin:FlipFBOs ping-pong swaps, in plan by
+ * single shader ops with fused shaders.
+ */
+static void PsychPipelineFuseHookPlan(PsychWindowRecordType *windowRecord, PsychHookPlan* plan)
+{
+	PsychHookFunction* stages[kPsychMaxFusedStages];
+	PsychHookSlotParams merged;
+	int i, n, end;
+
+	for (i = 0; i < plan->numOps; i++) {
+		if ((plan->ops[i].opcode != kPsychPlanOpShader) || !PsychPipelineIsFusableSlot(plan->ops[i].hookfunc)) continue;
+
+		// Collect run of fusable slots with compatible texture bindings:
+		merged = plan->ops[i].hookfunc->params;
+		stages[0] = plan->ops[i].hookfunc;
+		n = 1;
+		end = i;
+		while ((n < kPsychMaxFusedStages) && (end + 2 < plan->numOps) && (plan->ops[end + 1].opcode == kPsychPlanOpFlipFBOs) &&
+			   (plan->ops[end + 2].opcode == kPsychPlanOpShader) && PsychPipelineIsFusableSlot(plan->ops[end + 2].hookfunc) &&
+			   PsychPipelineMergeSlotTextures(&merged, &(plan->ops[end + 2].hookfunc->params))) {
+			stages[n++] = plan->ops[end + 2].hookfunc;
+			end += 2;
+		}
+		if (n < 2) continue;
+
+		PsychSetGLContext(windowRecord);
+		if (PsychPipelineFuseShaderSlots(&(plan->ops[i]), stages, n, &merged)) {
+			// Fused op replaces all ops of the run:
+			memmove(&(plan->ops[i + 1]), &(plan->ops[end + 1]), (plan->numOps - end - 1) * sizeof(PsychHookPlanOp));
+			plan->numOps -= end - i;
+			if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Fused %i shader slots into shader slot '%s'.\n", n, plan->ops[i].hookfunc->idString);
+		}
+		else {
+			i = end;
+		}
+	}
+}
+
+/* PsychPipelineCompileHookPlan()
+ * Compile a hook chain into an execution plan: A flat array with one operation per slot, with the
+ * type of each slot resolved and all slot parameters preparsed, so execution doesn't need to walk
+ * the linked list and compare id strings each time. The plan is cached until the chain is modified.
+ *
+ * Runs of fusable shader slots get fused into single shader passes, see PsychPipelineFuseHookPlan().
+ * Consecutive GLSL shader slots which bind the same textures share their texture setup: Textures
+ * are bound once for the whole run of shader slots instead of being unbound and rebound in between.
+ *
+ * hookBlitterFunction is the master blitter the chain gets executed with. Fusion is only possible
+ * for the default identity blitter.
+ */
+static PsychHookPlan* PsychPipelineCompileHookPlan(PsychWindowRecordType *windowRecord, int hookId, void* hookBlitterFunction)
+{
+	PtrPsychHookFunction hookfunc;
+	PsychHookPlan* plan;
+	PsychHookPlanOp* op;
+	int i, count = 0;
+
+	for (hookfunc = windowRecord->HookChain[hookId]; hookfunc; hookfunc = hookfunc->next) count++;
+
+	plan = (PsychHookPlan*) calloc(1, sizeof(PsychHookPlan));
+	if (plan) plan->ops = (PsychHookPlanOp*) calloc(count, sizeof(PsychHookPlanOp));
+	if (plan == NULL || plan->ops == NULL) {
+		free(plan);
+		PsychErrorExitMsg(PsychError_outofMemory, "Failed to allocate memory for hook chain execution plan.");
+	}
+
+	for (hookfunc = windowRecord->HookChain[hookId], i = 0; hookfunc; hookfunc = hookfunc->next, i++) {
+		op = &(plan->ops[i]);
+		op->hookfunc = hookfunc;
+		op->opcode = kPsychPlanOpSlot;
+		PsychPipelineParseHookSlotParams(hookfunc);
+
+		if (hookfunc->hookfunctype == kPsychShaderFunc) op->opcode = kPsychPlanOpShader;
+
+		if (hookfunc->hookfunctype == kPsychBuiltinFunc) {
+			if (strcmp(hookfunc->idString, "Builtin:FlipFBOs")==0) {
+				op->opcode = kPsychPlanOpFlipFBOs;
+			}
+			else if (strstr(hookfunc->idString, "Builtin:RestrictToScissorROI")) {
+				op->opcode = kPsychPlanOpScissorROI;
+			}
+		}
+	}
+	plan->numOps = count;
+
+	// Fuse shader slots of onscreen windows. Proxy windows don't have their own OpenGL context:
+	if ((hookBlitterFunction == NULL) && PsychIsOnscreenWindow(windowRecord)) PsychPipelineFuseHookPlan(windowRecord, plan);
+
+	for (i = 0; i < plan->numOps; i++) {
+		op = &(plan->ops[i]);
+		// Both slots need a shader, so the 2nd one replaces the shader of the 1st one:
+		if ((op->opcode == kPsychPlanOpShader) && (i > 0) && (plan->ops[i-1].opcode == kPsychPlanOpShader) && plan->ops[i-1].hookfunc->shaderid && op->hookfunc->shaderid &&
+			PsychPipelineSameSlotTextures(&(plan->ops[i-1].hookfunc->params), &(op->hookfunc->params))) {
+			plan->ops[i-1].keepState = TRUE;
+			op->stateKept = TRUE;
+		}
+
+		if (op->opcode == kPsychPlanOpFlipFBOs) plan->numPingPongs++;
+	}
+
+	if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Compiled execution plan for hook chain '%s' with %i slots, %i ops and %i ping-pong passes.\n", PsychHookPointNames[hookId], count, plan->numOps, plan->numPingPongs);
+
+	windowRecord->HookChainPlan[hookId] = plan;
+	return(plan);
+}
+
 /* PsychPipelineExecuteHook()
  * Execute the full hook processing chain for a specific hook and a specific windowRecord.
  * This checks if the chain is enabled. If it isn't enabled, it skips processing.
  * If it is enabled, it iterates over the full chain, executes all assigned hook functions in order and uses the FBO's between minfbo and maxfbo
- * as pingpong buffers if neccessary.
+ * as pingpong buffers if neccessary. The chain is executed via its compiled execution plan, which is compiled
+ * on first execution after a change of the chain.
  */
 psych_bool PsychPipelineExecuteHook(PsychWindowRecordType *windowRecord, int hookId, void* hookUserData, void* hookBlitterFunction, psych_bool srcIsReadonly, psych_bool allowFBOSwizzle, PsychFBO** srcfbo1, PsychFBO** srcfbo2, PsychFBO** dstfbo, PsychFBO** bouncefbo)
 {
 	PtrPsychHookFunction hookfunc;
+	PsychHookPlan* plan;
+	PsychHookPlanOp* op;
 	int i=0;
 	int pendingFBOpingpongs = 0;
 	PsychFBO *mysrcfbo1, *mysrcfbo2, *mydstfbo, *mynxtfbo;
@@ -2594,16 +3764,12 @@ psych_bool PsychPipelineExecuteHook(PsychWindowRecordType *windowRecord, int hoo
 	// Is this an image processing hook?
 	gfxprocessing = (dstfbo!=NULL) ? TRUE : FALSE;
 
-	// Get start of enabled chain:
-	hookfunc = windowRecord->HookChain[hookId];
+	// Get execution plan of enabled chain, compile it if chain is new or changed:
+	plan = windowRecord->HookChainPlan[hookId];
+	if (plan == NULL) plan = PsychPipelineCompileHookPlan(windowRecord, hookId, hookBlitterFunction);
 
-	// Count number of needed ping-pong FBO switches inside this chain:
-	while(hookfunc) {
-		// Pingpong command?
-		if (hookfunc->hookfunctype == kPsychBuiltinFunc && strcmp(hookfunc->idString, "Builtin:FlipFBOs")==0) pendingFBOpingpongs++;
-		// Process next hookfunc slot in chain, if any:
-		hookfunc = hookfunc->next;
-	}
+	// Number of needed ping-pong FBO switches inside this chain:
+	pendingFBOpingpongs = plan->numPingPongs;
 
 	if (gfxprocessing) {
 		// Prepare gfx-processing:
@@ -2670,11 +3836,11 @@ psych_bool PsychPipelineExecuteHook(PsychWindowRecordType *windowRecord, int hoo
 	}
 
 	
-	// Reget start of enabled chain:
-	hookfunc = windowRecord->HookChain[hookId];
-
 	// Iterate over all slots:
-	while(hookfunc) {
+	for (i = 0; i < plan->numOps; i++) {
+		op = &(plan->ops[i]);
+		hookfunc = op->hookfunc;
+
 		// Debug output, if requested:
 		if (PsychPrefStateGet_Verbosity()>4) {
 			printf("Hookchain '%s' : Slot %i: Id='%s' : ", PsychHookPointNames[hookId], i, hookfunc->idString);
@@ -2698,7 +3864,7 @@ psych_bool PsychPipelineExecuteHook(PsychWindowRecordType *windowRecord, int hoo
 		}
 		
 		// Is this a ping-pong command?
-		if (hookfunc->hookfunctype == kPsychBuiltinFunc && strcmp(hookfunc->idString, "Builtin:FlipFBOs")==0) {
+		if (op->opcode == kPsychPlanOpFlipFBOs) {
 			// Ping pong buffer swap requested:
 			pendingFBOpingpongs--;
 			mysrcfbo1 = mydstfbo;
@@ -2723,14 +3889,18 @@ psych_bool PsychPipelineExecuteHook(PsychWindowRecordType *windowRecord, int hoo
 		}
 		else {
 			// Restricted area processing?
-			if (hookfunc->hookfunctype == kPsychBuiltinFunc && strstr(hookfunc->idString, "Builtin:RestrictToScissorROI")) {
+			if (op->opcode == kPsychPlanOpScissorROI) {
 				// Restrict pixel processing to specified region of interest ROI by setting
 				// up a proper scissor rectangle and enabling scissor tests. The special
 				// ROI (-1,-1,-1,-1) means: Disable scissor testing -> Unrestrict. 
-				if (4!=sscanf(hookfunc->pString1, "%i:%i:%i:%i", &sciss_x, &sciss_y, &sciss_w, &sciss_h)) {
+				if (!hookfunc->params.valid) {
 					if (PsychPrefStateGet_Verbosity()>0) printf("PTB-ERROR: In PsychPipelineExecuteHook: Builtin:RestrictToScissorROI - Parameter parse error in string %s\n", hookfunc->idString);
 					return(FALSE);
 				}
+				sciss_x = hookfunc->params.scissor[0];
+				sciss_y = hookfunc->params.scissor[1];
+				sciss_w = hookfunc->params.scissor[2];
+				sciss_h = hookfunc->params.scissor[3];
 				
 				if (sciss_x==-1 && sciss_y==-1 && sciss_w==-1 && sciss_h==-1) {
 					// Disable scissor tests:
@@ -2745,6 +3915,19 @@ psych_bool PsychPipelineExecuteHook(PsychWindowRecordType *windowRecord, int hoo
 					scissor_ignore = TRUE;
 				}
 			}
+			else if (op->opcode == kPsychPlanOpShader) {
+				// Fused shader slots? Update its uniforms from the original shaders:
+				if (op->fusedHook) PsychPipelineSyncFusedUniforms(op);
+
+				// GLSL shader slot - Execute blitter directly, sharing texture setup with neighbour shader slots:
+				if (!PsychPipelineExecuteBlitterShared(windowRecord, hookfunc, hookUserData, hookBlitterFunction, srcIsReadonly, allowFBOSwizzle, &mysrcfbo1, &mysrcfbo2, &mydstfbo, &mynxtfbo, op->stateKept, op->keepState)) {
+					// Failed!
+					if (PsychPrefStateGet_Verbosity()>0) {
+						printf("PTB-ERROR: Failed in processing of Hookchain '%s' : Slot %i: Id='%s'  --> Aborting chain processing. Set verbosity to 5 for extended debug output.\n", PsychHookPointNames[hookId], i, hookfunc->idString);
+					}
+					return(FALSE);
+				}
+			}
 			else {
 				// Normal hook function - Process this hook function:
 				if (!PsychPipelineExecuteHookSlot(windowRecord, hookId, hookfunc, hookUserData, hookBlitterFunction, srcIsReadonly, allowFBOSwizzle, &mysrcfbo1, &mysrcfbo2, &mydstfbo, &mynxtfbo)) {
@@ -2757,9 +3940,6 @@ psych_bool PsychPipelineExecuteHook(PsychWindowRecordType *windowRecord, int hoo
 			}
 		}
 		
-		// Process next hookfunc slot in chain, if any:
-		i++;
-		hookfunc = hookfunc->next;
 	}
 
 	if (gfxprocessing) {
@@ -3104,13 +4284,147 @@ void PsychPipelineSetupRenderFlow(PsychFBO* srcfbo1, PsychFBO* srcfbo2, PsychFBO
 	return;
 }
 
+/* PsychPipelineBindSlotTextures()
+ * Bind (bind = TRUE) or unbind (bind = FALSE) the textures specified via TEXTURExx(unit)=texid
+ * in the parameter string of a hook slot. Uses preparsed parameters if available.
+ */
+static void PsychPipelineBindSlotTextures(PsychHookFunction* hookfunc, psych_bool bind)
+{
+	char*  pstrpos = NULL;
+	int i, texunit, texid;
+
+	if (hookfunc->params.valid) {
+		for (i = 0; i < hookfunc->params.numTextures; i++) {
+			glActiveTextureARB(GL_TEXTURE0_ARB + hookfunc->params.texUnit[i]);
+			if (bind) {
+				glEnable(hookfunc->params.texTarget[i]);
+				glBindTexture(hookfunc->params.texTarget[i], hookfunc->params.texId[i]);
+				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to target %i of texunit %i\n", hookfunc->params.texId[i], (int) hookfunc->params.texTarget[i], hookfunc->params.texUnit[i]);
+			}
+			else {
+				glBindTexture(hookfunc->params.texTarget[i], 0);
+				glDisable(hookfunc->params.texTarget[i]);
+			}
+		}
+
+		glActiveTextureARB(GL_TEXTURE0_ARB);
+		return;
+	}
+
+	if (bind) {
+		// Setup code for 1D textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURE1D")) {
+			if (2==sscanf(pstrpos, "TEXTURE1D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glEnable(GL_TEXTURE_1D);
+				glBindTexture(GL_TEXTURE_1D, texid);
+				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_1D target of texunit %i\n", texid, texunit);
+			}
+			pstrpos++;
+		}
+
+		// Setup code for 2D textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURE2D")) {
+			if (2==sscanf(pstrpos, "TEXTURE2D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glEnable(GL_TEXTURE_2D);
+				glBindTexture(GL_TEXTURE_2D, texid);
+				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_2D target of texunit %i\n", texid, texunit);
+			}
+			pstrpos++;
+		}
+
+		// Setup code for 2D rectangle textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURERECT2D")) {
+			if (2==sscanf(pstrpos, "TEXTURERECT2D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glEnable(GL_TEXTURE_RECTANGLE_EXT);
+				glBindTexture(GL_TEXTURE_RECTANGLE_EXT, texid);
+				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_RECTANGLE_EXT target of texunit %i\n", texid, texunit);
+			}
+			pstrpos++;
+		}
+
+		// Setup code for 3D textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURE3D")) {
+			if (2==sscanf(pstrpos, "TEXTURE3D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glEnable(GL_TEXTURE_3D);
+				glBindTexture(GL_TEXTURE_3D, texid);
+				if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_3D target of texunit %i\n", texid, texunit);
+			}
+			pstrpos++;
+		}
+	}
+	else {
+		// Teardown code for 1D textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURE1D")) {
+			if (2==sscanf(pstrpos, "TEXTURE1D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glBindTexture(GL_TEXTURE_1D, 0);
+				glDisable(GL_TEXTURE_1D);
+			}
+			pstrpos++;
+		}
+
+		// Teardown code for 2D textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURE2D")) {
+			if (2==sscanf(pstrpos, "TEXTURE2D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glBindTexture(GL_TEXTURE_2D, 0);
+				glDisable(GL_TEXTURE_2D);
+			}
+			pstrpos++;
+		}
+
+		// Teardown code for 2D rectangle textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURERECT2D")) {
+			if (2==sscanf(pstrpos, "TEXTURERECT2D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
+				glDisable(GL_TEXTURE_RECTANGLE_EXT);
+			}
+			pstrpos++;
+		}
+
+		// Teardown code for 3D textures:
+		pstrpos = hookfunc->pString1;
+		while (pstrpos=strstr(pstrpos, "TEXTURE3D")) {
+			if (2==sscanf(pstrpos, "TEXTURE3D(%i)=%i", &texunit, &texid)) {
+				glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
+				glBindTexture(GL_TEXTURE_3D, 0);
+				glDisable(GL_TEXTURE_3D);
+			}
+			pstrpos++;
+		}
+	}
+
+	glActiveTextureARB(GL_TEXTURE0_ARB);
+	return;
+}
+
 psych_bool PsychPipelineExecuteBlitter(PsychWindowRecordType *windowRecord, PsychHookFunction* hookfunc, void* hookUserData, void* hookBlitterFunction, psych_bool srcIsReadonly, psych_bool allowFBOSwizzle, PsychFBO** srcfbo1, PsychFBO** srcfbo2, PsychFBO** dstfbo, PsychFBO** bouncefbo)
+{
+	return(PsychPipelineExecuteBlitterShared(windowRecord, hookfunc, hookUserData, hookBlitterFunction, srcIsReadonly, allowFBOSwizzle, srcfbo1, srcfbo2, dstfbo, bouncefbo, FALSE, FALSE));
+}
+
+/* PsychPipelineExecuteBlitterShared()
+ * Like PsychPipelineExecuteBlitter(), but can skip texture setup, because the textures are still bound by
+ * the previous blit, and teardown of texture bindings and shader, because the next blit uses the same textures.
+ * Used by hook chain execution plans for runs of shader slots.
+ */
+psych_bool PsychPipelineExecuteBlitterShared(PsychWindowRecordType *windowRecord, PsychHookFunction* hookfunc, void* hookUserData, void* hookBlitterFunction, psych_bool srcIsReadonly, psych_bool allowFBOSwizzle, PsychFBO** srcfbo1, PsychFBO** srcfbo2, PsychFBO** dstfbo, PsychFBO** bouncefbo, psych_bool skipSetup, psych_bool skipTeardown)
 {
 	psych_bool rc = TRUE;
 	PsychBlitterFunc blitterfnc = NULL;
 	GLenum glerr;
-	char*  pstrpos = NULL;
-	int texunit, texid;
 	
 	// Select proper blitter function:
 	
@@ -3119,7 +4433,11 @@ psych_bool PsychPipelineExecuteBlitter(PsychWindowRecordType *windowRecord, Psyc
 	blitterfnc = hookBlitterFunction;
 	
 	// Any special override blitter defined in parameter string?
-	if (strstr(hookfunc->pString1, "Blitter:")) {
+	if (hookfunc->params.valid) {
+		// Already selected when parsing the parameter string:
+		if (hookfunc->params.blitter) blitterfnc = (PsychBlitterFunc) hookfunc->params.blitter;
+	}
+	else if (strstr(hookfunc->pString1, "Blitter:")) {
 		// Yes. Which one?
 		blitterfnc = NULL;
 		
@@ -3143,55 +4461,8 @@ psych_bool PsychPipelineExecuteBlitter(PsychWindowRecordType *windowRecord, Psyc
 	
 	// TODO: Common setup code for texturing, filtering, alpha blending, z-test and such...
 	
-	// Setup code for 1D textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURE1D")) {
-		if (2==sscanf(pstrpos, "TEXTURE1D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glEnable(GL_TEXTURE_1D);
-			glBindTexture(GL_TEXTURE_1D, texid);
-			if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_1D target of texunit %i\n", texid, texunit);
-		}
-		pstrpos++;
-	}
-
-	// Setup code for 2D textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURE2D")) {
-		if (2==sscanf(pstrpos, "TEXTURE2D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glEnable(GL_TEXTURE_2D);
-			glBindTexture(GL_TEXTURE_2D, texid);
-			if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_2D target of texunit %i\n", texid, texunit);
-		}
-		pstrpos++;
-	}
-
-	// Setup code for 2D rectangle textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURERECT2D")) {
-		if (2==sscanf(pstrpos, "TEXTURERECT2D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glEnable(GL_TEXTURE_RECTANGLE_EXT);
-			glBindTexture(GL_TEXTURE_RECTANGLE_EXT, texid);
-			if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_RECTANGLE_EXT target of texunit %i\n", texid, texunit);
-		}
-		pstrpos++;
-	}
-
-	// Setup code for 3D textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURE3D")) {
-		if (2==sscanf(pstrpos, "TEXTURE3D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glEnable(GL_TEXTURE_3D);
-			glBindTexture(GL_TEXTURE_3D, texid);
-			if (PsychPrefStateGet_Verbosity()>4) printf("PTB-DEBUG: Binding gltexid %i to GL_TEXTURE_3D target of texunit %i\n", texid, texunit);
-		}
-		pstrpos++;
-	}
-
-	glActiveTextureARB(GL_TEXTURE0_ARB);
+	// Setup code for textures, unless still bound from previous blit:
+	if (!skipSetup) PsychPipelineBindSlotTextures(hookfunc, TRUE);
 	
 	// Need a shader for this blit op?
 	if (hookfunc->shaderid) {
@@ -3231,55 +4502,14 @@ psych_bool PsychPipelineExecuteBlitter(PsychWindowRecordType *windowRecord, Psyc
 	
 	// TODO: Common teardown code for texturing, filtering and such...
 
-	// Teardown code for 1D textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURE1D")) {
-		if (2==sscanf(pstrpos, "TEXTURE1D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glBindTexture(GL_TEXTURE_1D, 0);
-			glDisable(GL_TEXTURE_1D);
-		}
-		pstrpos++;
-	}
+	// Teardown code for textures, unless the next blit uses the same ones. Always teardown on failure:
+	if (!skipTeardown || !rc) {
+		PsychPipelineBindSlotTextures(hookfunc, FALSE);
 
-	// Teardown code for 2D textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURE2D")) {
-		if (2==sscanf(pstrpos, "TEXTURE2D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glBindTexture(GL_TEXTURE_2D, 0);
-			glDisable(GL_TEXTURE_2D);
-		}
-		pstrpos++;
+		// Reset shader assignment, if any:
+		if ((hookfunc->shaderid) && glUseProgram) glUseProgram(0);
 	}
 
-	// Teardown code for 2D rectangle textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURERECT2D")) {
-		if (2==sscanf(pstrpos, "TEXTURERECT2D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glBindTexture(GL_TEXTURE_RECTANGLE_EXT, 0);
-			glDisable(GL_TEXTURE_RECTANGLE_EXT);
-		}
-		pstrpos++;
-	}
-
-	// Teardown code for 3D textures:
-	pstrpos = hookfunc->pString1;
-	while (pstrpos=strstr(pstrpos, "TEXTURE3D")) {
-		if (2==sscanf(pstrpos, "TEXTURE3D(%i)=%i", &texunit, &texid)) {
-			glActiveTextureARB(GL_TEXTURE0_ARB + texunit);
-			glBindTexture(GL_TEXTURE_3D, 0);
-			glDisable(GL_TEXTURE_3D);
-		}
-		pstrpos++;
-	}
-
-	glActiveTextureARB(GL_TEXTURE0_ARB);
-
-	// Reset shader assignment, if any:
-	if ((hookfunc->shaderid) && glUseProgram) glUseProgram(0);
-
 	// Return result code:
 	return(rc);
 }
@@ -3306,6 +4536,23 @@ psych_bool PsychBlitterIdentity(PsychWindowRecordType *windowRecord, PsychHookFu
 	w = (*srcfbo1)->width;
 	h = (*srcfbo1)->height;
 
+	// Preparsed blitter parameters available? Then use them instead of parsing the blitterString:
+	if (hookfunc->params.valid) {
+		if (hookfunc->params.ovrSize) {
+			w = hookfunc->params.ovrWidth;
+			h = hookfunc->params.ovrHeight;
+		}
+		bilinearfiltering = hookfunc->params.bilinear;
+		if (bilinearfiltering) {
+			glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		}
+		x = hookfunc->params.offsetX;
+		y = hookfunc->params.offsetY;
+		sx = hookfunc->params.scaleX;
+		sy = hookfunc->params.scaleY;
+	}
+	else {
 	// Check for override width x height parameter in the blitterString: An integral (w,h)
 	// size the blit. This allows to blit a target quad with a size different from srcfbo1, without
 	// scaling or filtering it. Mostly useful in conjunction with specific shaders.
@@ -3346,6 +4593,7 @@ psych_bool PsychBlitterIdentity(PsychWindowRecordType *windowRecord, PsychHookFu
 			PsychErrorExitMsg(PsychError_internal, "In PsychBlitterIdentity(): Scaling: blit string parameter is invalid! Parse error...\n");
 		}
 	}
+	}
 
 	if (x!=0 || y!=0 || sx!=1.0 || sy!=1.0) {
 		glMatrixMode(GL_MODELVIEW);
@@ -3423,7 +4671,11 @@ psych_bool PsychBlitterDisplayList(PsychWindowRecordType *windowRecord, PsychHoo
 	}	
 
 	// Query display list handle:
-	if (strp=strstr(hookfunc->pString1, "Handle:")) {
+	if (hookfunc->params.valid && hookfunc->params.displayList) {
+		// Preparsed:
+		gllist = hookfunc->params.displayList;
+	}
+	else if (strp=strstr(hookfunc->pString1, "Handle:")) {
 		// Parse and assign offset:
 		if (sscanf(strp, "Handle:%i", &gllist)!=1) {
 			PsychErrorExitMsg(PsychError_internal, "In PsychBlitterDisplayList(): Handle: Parse error fetching display list handle!\n");
@@ -3436,6 +4688,19 @@ psych_bool PsychBlitterDisplayList(PsychWindowRecordType *windowRecord, PsychHoo
 	// Handle valid?
 	if (!glIsList(gllist)) PsychErrorExitMsg(PsychError_internal, "In PsychBlitterDisplayList(): Invalid display list handle provided!\n");
 	
+	// Preparsed blitter parameters available? Then use them instead of parsing the blitterString:
+	if (hookfunc->params.valid) {
+		bilinearfiltering = hookfunc->params.bilinear;
+		if (bilinearfiltering) {
+			glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_RECTANGLE_EXT, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		}
+		x = hookfunc->params.offsetX;
+		y = hookfunc->params.offsetY;
+		sx = hookfunc->params.scaleX;
+		sy = hookfunc->params.scaleY;
+	}
+	else {
 	// Bilinear filtering of srcfbo1 texture requested?
 	if (strstr(hookfunc->pString1, "Bilinear")) {
 		// Yes. Enable it.
@@ -3466,6 +4731,7 @@ psych_bool PsychBlitterDisplayList(PsychWindowRecordType *windowRecord, PsychHoo
 			PsychErrorExitMsg(PsychError_internal, "In PsychBlitterDisplayList(): Scaling: blit string parameter is invalid! Parse error...\n");
 		}
 	}
+	}
 
 	if (x!=0 || y!=0 || sx!=1.0 || sy!=1.0) {
 		glMatrixMode(GL_MODELVIEW);
@@ -3503,18 +4769,92 @@ psych_bool PsychBlitterDisplayList(PsychWindowRecordType *windowRecord, PsychHoo
 	return(TRUE);
 }
 
+/* PsychPipelineUpdateClutCache() - Update CLUT cache of windowRecord with its current CLUT.
+ *
+ * Compares the current CLUT against the cached one and copies all changed entries into the cache.
+ * If anything changed, the generation of the cache is incremented and the range of changed entries
+ * is recorded, so the CLUT encoders can update only the changed part of their encoded CLUT.
+ * Returns FALSE if out of memory.
+ */
+static psych_bool PsychPipelineUpdateClutCache(PsychWindowRecordType *windowRecord)
+{
+	PsychClutCache* cache = &(windowRecord->clutCache);
+	psych_bool resized = FALSE;
+	int i, first = -1, last = -1;
+	float* p;
+
+	// Different size? Then all entries changed:
+	if (cache->size != windowRecord->inTableSize) {
+		free(cache->rgb);
+		cache->rgb = (float*) malloc(windowRecord->inTableSize * 3 * sizeof(float));
+		cache->size = (cache->rgb) ? windowRecord->inTableSize : 0;
+		if (cache->rgb == NULL) return(FALSE);
+		resized = TRUE;
+	}
+
+	for (i = 0, p = cache->rgb; i < cache->size; i++, p += 3) {
+		if (resized || (p[0] != windowRecord->inRedTable[i]) || (p[1] != windowRecord->inGreenTable[i]) || (p[2] != windowRecord->inBlueTable[i])) {
+			p[0] = windowRecord->inRedTable[i];
+			p[1] = windowRecord->inGreenTable[i];
+			p[2] = windowRecord->inBlueTable[i];
+			if (first < 0) first = i;
+			last = i;
+		}
+	}
+
+	if (first >= 0) {
+		cache->generation++;
+		cache->firstChanged = first;
+		cache->lastChanged = last;
+	}
+
+	return(TRUE);
+}
+
+/* PsychPipelineClutCacheRange() - Range of CLUT entries to reencode.
+ *
+ * Returns the range of entries an encoder, whose encoded CLUT is of cache generation 'encoded', needs to
+ * encode again to get up to date. Returns FALSE if already up to date.
+ */
+static psych_bool PsychPipelineClutCacheRange(PsychClutCache* cache, unsigned int encoded, int* first, int* last)
+{
+	if (encoded == cache->generation) return(FALSE);
+
+	if ((encoded != 0) && (encoded + 1 == cache->generation)) {
+		// Only missed the last change:
+		*first = cache->firstChanged;
+		*last = cache->lastChanged;
+	}
+	else {
+		// Missed more, or nothing encoded yet:
+		*first = 0;
+		*last = cache->size - 1;
+	}
+
+	return(TRUE);
+}
+
 /* PsychPipelineBuiltinRenderClutBitsPlusPlus - Encode Bits++ CLUT into framebuffer.
  * 
  * This builtin routine takes the current gamma table for this windowRecord, encodes it into a Bits++
  * compatible T-Lock CLUT and renders it into the framebuffer.
+ *
+ * The encoded T-Lock line is cached in the windows CLUT cache, preferably in a VBO, and only the changed
+ * entries of a new CLUT get encoded and uploaded again. The line is drawn with one draw call.
  */
 psych_bool PsychPipelineBuiltinRenderClutBitsPlusPlus(PsychWindowRecordType *windowRecord, PsychHookFunction* hookfunc)
 {
+	// T-Lock unlock key:
+	static const GLubyte tlockKey[12 * 3] = { 36, 106, 133, 63, 136, 163, 8, 19, 138, 211, 25, 46, 3, 115, 164, 112, 68, 9, 56, 41, 49, 34, 159, 208,
+											  0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
 	char* strp;
 	const int bitshift = 16; // Bits++ expects 16 bit numbers, but ignores 2 least significant bits --> Effective 14 bit.
-	int i, x, y;
+	int i, x, y, first, last;
 	unsigned int r, g, b;
 	double t1, t2;
+	psych_bool firstuse;
+	PsychClutCache* cache = &(windowRecord->clutCache);
+	GLubyte* c;
 	y=1;
 	x=0;
 	
@@ -3533,8 +4873,13 @@ psych_bool PsychPipelineBuiltinRenderClutBitsPlusPlus(PsychWindowRecordType *win
 		PsychGetAdjustedPrecisionTimerSeconds(&t1);
 	}
 
+	// Options preparsed?
+	if (hookfunc->params.valid) {
+		x = hookfunc->params.xPosition;
+		y = hookfunc->params.yPosition;
+	}
 	// Options provided?
-	if (strlen(hookfunc->pString1)>0) {
+	else if (strlen(hookfunc->pString1)>0) {
 		// Check for override vertical position for line. Default is first scanline of display.
 		if (strp=strstr(hookfunc->pString1, "yPosition=")) {
 			// Parse and assign offset:
@@ -3552,54 +4897,83 @@ psych_bool PsychPipelineBuiltinRenderClutBitsPlusPlus(PsychWindowRecordType *win
 		}
 	}
 	
-	// Render CLUT as sequence of single points:	
-	glPointSize(1);
-	glBegin(GL_POINTS);
-	
-	// First the T-Lock unlock key:
-	glColor3ub(36, 106, 133);
-	glVertex2i(x++, y);
-	glColor3ub(63, 136, 163);
-	glVertex2i(x++, y);
-	glColor3ub(8, 19, 138);
-	glVertex2i(x++, y);
-	glColor3ub(211, 25, 46);
-	glVertex2i(x++, y);
-	glColor3ub(3, 115, 164);
-	glVertex2i(x++, y);
-	glColor3ub(112, 68, 9);
-	glVertex2i(x++, y);
-	glColor3ub(56, 41, 49);
-	glVertex2i(x++, y);
-	glColor3ub(34, 159, 208);
-	glVertex2i(x++, y);
-	glColor3ub(0, 0, 0);
-	glVertex2i(x++, y);
-	glColor3ub(0, 0, 0);
-	glVertex2i(x++, y);
-	glColor3ub(0, 0, 0);
-	glVertex2i(x++, y);
-	glColor3ub(0, 0, 0);
-	glVertex2i(x++, y);
-	
+	// Update cached CLUT:
+	if (!PsychPipelineUpdateClutCache(windowRecord)) {
+		if (PsychPrefStateGet_Verbosity()>0) printf("PTB-ERROR: Bits++ CLUT encoding failed. Out of memory. Skipped!\n");
+		return(FALSE);
+	}
+
+	// First use? Setup T-Lock unlock key and VBO, if supported:
+	firstuse = (cache->tlockGeneration == 0) ? TRUE : FALSE;
+	if (firstuse) {
+		memcpy(cache->tlockColors, tlockKey, sizeof(tlockKey));
+		if (GLEW_VERSION_1_5 && (cache->tlockVBO == 0)) {
+			glGenBuffers(1, &(cache->tlockVBO));
+			glBindBuffer(GL_ARRAY_BUFFER, cache->tlockVBO);
+			glBufferData(GL_ARRAY_BUFFER, sizeof(cache->tlockVertices) + sizeof(cache->tlockColors), NULL, GL_DYNAMIC_DRAW);
+		}
+	}
+
+	if (cache->tlockVBO) glBindBuffer(GL_ARRAY_BUFFER, cache->tlockVBO);
+
+	// Vertices of the line as sequence of single points, one per pixel:
+	if (firstuse || (cache->tlockX != x) || (cache->tlockY != y)) {
+		for (i = 0; i < kPsychTLockPixels; i++) {
+			cache->tlockVertices[i * 2] = x + i;
+			cache->tlockVertices[i * 2 + 1] = y;
+		}
+		cache->tlockX = x;
+		cache->tlockY = y;
+		if (cache->tlockVBO) glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(cache->tlockVertices), cache->tlockVertices);
+	}
+
 	// Now the encoded CLUT: We encode 16 bit values in a high and a low pixel,
 	// Bits++ throws away the two least significant bits - get 14 bit output resolution.
-	for (i=0; i<256; i++) {
-		// Convert 0.0 - 1.0 float value into 0 - 2^14 -1 integer range of Bits++
-		r = (unsigned int)(windowRecord->inRedTable[i] * (float)((1 << bitshift) - 1) + 0.5f);
-		g = (unsigned int)(windowRecord->inGreenTable[i] * (float)((1 << bitshift) - 1) + 0.5f);
-		b = (unsigned int)(windowRecord->inBlueTable[i] * (float)((1 << bitshift) - 1) + 0.5f);
-		
-		// Pixel with high-byte of 16 bit value:
-		glColor3ub((GLubyte) ((r >> 8) & 0xff), (GLubyte) ((g >> 8) & 0xff), (GLubyte) ((b >> 8) & 0xff));
-		glVertex2i(x++, y);
-		
-		// Pixel with low-byte of 16 bit value:
-		glColor3ub((GLubyte) (r & 0xff), (GLubyte) (g  & 0xff), (GLubyte) (b  & 0xff));
-		glVertex2i(x++, y);
+	// Only entries which changed since last encode need encoding:
+	if (PsychPipelineClutCacheRange(cache, cache->tlockGeneration, &first, &last)) {
+		if (last > 255) last = 255;
+		for (i = first; i <= last; i++) {
+			// Convert 0.0 - 1.0 float value into 0 - 2^14 -1 integer range of Bits++
+			r = (unsigned int)(cache->rgb[i * 3 + 0] * (float)((1 << bitshift) - 1) + 0.5f);
+			g = (unsigned int)(cache->rgb[i * 3 + 1] * (float)((1 << bitshift) - 1) + 0.5f);
+			b = (unsigned int)(cache->rgb[i * 3 + 2] * (float)((1 << bitshift) - 1) + 0.5f);
+
+			// Pixel with high-byte of 16 bit value:
+			c = &(cache->tlockColors[(12 + i * 2) * 3]);
+			c[0] = (GLubyte) ((r >> 8) & 0xff);
+			c[1] = (GLubyte) ((g >> 8) & 0xff);
+			c[2] = (GLubyte) ((b >> 8) & 0xff);
+
+			// Pixel with low-byte of 16 bit value:
+			c[3] = (GLubyte) (r & 0xff);
+			c[4] = (GLubyte) (g & 0xff);
+			c[5] = (GLubyte) (b & 0xff);
+		}
+
+		// Upload changed part:
+		if (cache->tlockVBO && !firstuse && (first <= last)) glBufferSubData(GL_ARRAY_BUFFER, sizeof(cache->tlockVertices) + (12 + first * 2) * 3, (last - first + 1) * 2 * 3, &(cache->tlockColors[(12 + first * 2) * 3]));
+		cache->tlockGeneration = cache->generation;
 	}
-	
-	glEnd();
+
+	// Upload all of it, including the unlock key, on first use:
+	if (cache->tlockVBO && firstuse) glBufferSubData(GL_ARRAY_BUFFER, sizeof(cache->tlockVertices), sizeof(cache->tlockColors), cache->tlockColors);
+
+	// Render CLUT line in one go:
+	glPointSize(1);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	if (cache->tlockVBO) {
+		glVertexPointer(2, GL_INT, 0, (const GLvoid*) 0);
+		glColorPointer(3, GL_UNSIGNED_BYTE, 0, (const GLvoid*) sizeof(cache->tlockVertices));
+	}
+	else {
+		glVertexPointer(2, GL_INT, 0, cache->tlockVertices);
+		glColorPointer(3, GL_UNSIGNED_BYTE, 0, cache->tlockColors);
+	}
+	glDrawArrays(GL_POINTS, 0, kPsychTLockPixels);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (cache->tlockVBO) glBindBuffer(GL_ARRAY_BUFFER, 0);
 	
 	if (PsychPrefStateGet_Verbosity() > 4) {  
 		glFinish();
@@ -3618,10 +4992,14 @@ psych_bool PsychPipelineBuiltinRenderClutBitsPlusPlus(PsychWindowRecordType *win
  */
 psych_bool PsychPipelineBuiltinRenderClutViaRuntime(PsychWindowRecordType *windowRecord, PsychHookFunction* hookfunc)
 {
-	char* strp;
+	// Each CLUT entry is formatted with fixed width, so single entries can be updated in place:
+	const int entrylen = 29;
+	char entry[64];
 	char* outcmd = NULL;
-	int i, cmdlen;
+	int i, cmdlen, first, last;
 	double t1, t2;
+	PsychClutCache* cache = &(windowRecord->clutCache);
+	float* p;
 	
 	// Be lazy: Only execute call if there is actually a pending CLUT for update:
 	if (windowRecord->inRedTable == NULL) {
@@ -3638,19 +5016,39 @@ psych_bool PsychPipelineBuiltinRenderClutViaRuntime(PsychWindowRecordType *windo
 		PsychGetAdjustedPrecisionTimerSeconds(&t1);
 	}
 
+	// Update cached CLUT:
+	if (!PsychPipelineUpdateClutCache(windowRecord)) {
+		if (PsychPrefStateGet_Verbosity()>0) printf("PTB-ERROR: PsychPipelineBuiltinRenderClutViaRuntime: CLUT encoding failed. Out of memory. Skipped!\n");
+		return(FALSE);
+	}
+
+	// Need a new command string for different command or CLUT size?
 	cmdlen = strlen(hookfunc->pString1);
-	outcmd = (char*) calloc(cmdlen + 10 + (windowRecord->inTableSize * 3 * 10), sizeof(char));
-	sprintf(outcmd, "%s [", hookfunc->pString1);
-	strp = &outcmd[strlen(outcmd)];
-	
-	for (i = 0; i < windowRecord->inTableSize; i++) {
-		sprintf(strp, "%06f %06f %06f ; ", windowRecord->inRedTable[i], windowRecord->inGreenTable[i], windowRecord->inBlueTable[i]);
-		strp = &outcmd[strlen(outcmd)];		
-		// printf("%06f %06f %06f ; ", windowRecord->inRedTable[i], windowRecord->inGreenTable[i], windowRecord->inBlueTable[i]);
+	if ((cache->runtimeCmd == NULL) || (cache->runtimeEntries != cache->size) || (cache->runtimePrefixLength != cmdlen) || strncmp(cache->runtimeCmd, hookfunc->pString1, cmdlen)) {
+		free(cache->runtimeCmd);
+		cache->runtimeCmd = (char*) calloc(cmdlen + 2 + (cache->size * entrylen) + 5, sizeof(char));
+		if (cache->runtimeCmd == NULL) {
+			if (PsychPrefStateGet_Verbosity()>0) printf("PTB-ERROR: PsychPipelineBuiltinRenderClutViaRuntime: CLUT encoding failed. Out of memory. Skipped!\n");
+			return(FALSE);
+		}
+		sprintf(cache->runtimeCmd, "%s [", hookfunc->pString1);
+		sprintf(cache->runtimeCmd + cmdlen + 2 + (cache->size * entrylen), "]); ");
+		cache->runtimePrefixLength = cmdlen;
+		cache->runtimeEntries = cache->size;
+		cache->runtimeGeneration = 0;
 	}
 
-	strp = &outcmd[strlen(outcmd)];
-	sprintf(strp, "]); ");
+	// Format all entries changed since last call. Values are in range 0 - 1, and fabs() turns -0 into 0,
+	// so each value needs exactly 8 characters:
+	if (PsychPipelineClutCacheRange(cache, cache->runtimeGeneration, &first, &last)) {
+		for (i = first; i <= last; i++) {
+			p = &(cache->rgb[i * 3]);
+			sprintf(entry, "%8.6f %8.6f %8.6f ; ", fabs(p[0]), fabs(p[1]), fabs(p[2]));
+			memcpy(cache->runtimeCmd + cmdlen + 2 + (i * entrylen), entry, entrylen);
+		}
+		cache->runtimeGeneration = cache->generation;
+	}
+	outcmd = cache->runtimeCmd;
 	
 	// Release the gamma table:
 	free(windowRecord->inRedTable); windowRecord->inRedTable = NULL;
@@ -3661,7 +5059,6 @@ psych_bool PsychPipelineBuiltinRenderClutViaRuntime(PsychWindowRecordType *windo
 	
 	// Execute callback into runtime:
 	PsychRuntimeEvaluateString(outcmd);
-	free(outcmd);
 	
 	if (PsychPrefStateGet_Verbosity() > 4) {  
 		PsychGetAdjustedPrecisionTimerSeconds(&t2);
@@ -3804,7 +5201,7 @@ psych_bool PsychAssignHighPrecisionTextureShaders(PsychWindowRecordType* texture
 		// Do we have bilinear filtershader already? Don't have this stuff for GL_TEXTURE_2D btw...
 		if (windowRecord->textureFilterShader == 0 && !(usepoweroftwo & 1)) {
 			// Nope. Need to create one:
-			windowRecord->textureFilterShader = PsychCreateGLSLProgram(textureBilinearFilterFragmentShaderSrc, textureBilinearFilterVertexShaderSrc, NULL);
+			windowRecord->textureFilterShader = PsychCreateGLSLProgram(windowRecord, textureBilinearFilterFragmentShaderSrc, textureBilinearFilterVertexShaderSrc, NULL);
 			if ((windowRecord->textureFilterShader == 0) && PsychPrefStateGet_Verbosity() > 1) {
 				printf("PTB-WARNING: Created a floating point texture as requested, or manual filtering wanted, but was unable to create a float filter shader.\n");
 				printf("PTB-WARNING: (Custom) Filtering - and therefore anti-aliasing - of this texture won't work or at least not at the requested precision.\n");
@@ -3837,7 +5234,7 @@ psych_bool PsychAssignHighPrecisionTextureShaders(PsychWindowRecordType* texture
 			// Yes, need it - Create a shader if one doesn't yet exist:
 			if (windowRecord->textureLookupShader == 0 && !(usepoweroftwo & 1)) {
 				// Create one:
-				windowRecord->textureLookupShader = PsychCreateGLSLProgram(textureLookupFragmentShaderSrc, textureBilinearFilterVertexShaderSrc, NULL);
+				windowRecord->textureLookupShader = PsychCreateGLSLProgram(windowRecord, textureLookupFragmentShaderSrc, textureBilinearFilterVertexShaderSrc, NULL);
 				if ((windowRecord->textureLookupShader == 0) && PsychPrefStateGet_Verbosity() > 1) {
 					printf("PTB-WARNING: Failed to create a texture lookup shader. High precision texture drawing therefore won't work.\n");
 				}				
@@ -3869,19 +5266,19 @@ psych_bool PsychAssignPlanarTextureShaders(PsychWindowRecordType* textureRecord,
 		// Nope. Need to create one:
 		switch (channels) {
 			case 1:
-				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(texturePlanar1FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
+				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(windowRecord, texturePlanar1FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
 			break;
 
 			case 2:
-				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(texturePlanar2FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
+				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(windowRecord, texturePlanar2FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
 			break;
 
 			case 3:
-				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(texturePlanar3FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
+				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(windowRecord, texturePlanar3FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
 			break;
 
 			case 4:
-				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(texturePlanar4FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
+				windowRecord->texturePlanarShader[channels - 1] = PsychCreateGLSLProgram(windowRecord, texturePlanar4FragmentShaderSrc, texturePlanarVertexShaderSrc, NULL);
 			break;
 
 			default:
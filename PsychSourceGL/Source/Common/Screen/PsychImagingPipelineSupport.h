@@ -86,6 +86,12 @@ void	PsychPipelineSetupRenderFlow(PsychFBO* srcfbo1, PsychFBO* srcfbo2, PsychFBO
 // Create OpenGL framebuffer object for internal rendering, setup PTB info struct for it:
 psych_bool PsychCreateFBO(PsychFBO** fbo, GLenum fboInternalFormat, psych_bool needzbuffer, int width, int height, int multisample);
 
+// FBO pool: Create FBO or recycle a matching one, return FBOs of closed textures to pool, purge pool of a context, get statistics:
+psych_bool PsychCreatePooledFBO(PsychWindowRecordType *windowRecord, PsychFBO** fbo, GLenum fboInternalFormat, psych_bool needzbuffer, int width, int height, int multisample);
+void PsychRecycleTextureFBOs(PsychWindowRecordType *windowRecord);
+void PsychFBOPoolPurgeContext(PsychWindowRecordType *windowRecord);
+void PsychFBOPoolGetStats(int* count, double* bytes, int* hits, int* misses, int* evictions);
+
 // Check if provided PTB texture already has a PsychFBO attached. Do nothing if so. If a FBO is missing, create one:
 void PsychCreateShadowFBOForTexture(PsychWindowRecordType *textureRecord, psych_bool asRendertarget, int forImagingmode);
 
@@ -94,9 +100,12 @@ void PsychNormalizeTextureOrientation(PsychWindowRecordType *sourceRecord);
 
 psych_bool PsychIsHookChainOperational(PsychWindowRecordType *windowRecord, int hookid);
 psych_bool PsychPipelineExecuteBlitter(PsychWindowRecordType *windowRecord, PsychHookFunction* hookfunc, void* hookUserData, void* hookBlitterFunction, psych_bool srcIsReadonly, psych_bool allowFBOSwizzle, PsychFBO** srcfbo1, PsychFBO** srcfbo2, PsychFBO** dstfbo, PsychFBO** bouncefbo);
+psych_bool PsychPipelineExecuteBlitterShared(PsychWindowRecordType *windowRecord, PsychHookFunction* hookfunc, void* hookUserData, void* hookBlitterFunction, psych_bool srcIsReadonly, psych_bool allowFBOSwizzle, PsychFBO** srcfbo1, PsychFBO** srcfbo2, PsychFBO** dstfbo, PsychFBO** bouncefbo, psych_bool skipSetup, psych_bool skipTeardown);
 
 // Try to create GLSL shader from source strings and return handle to new shader.
-GLuint  PsychCreateGLSLProgram(const char* fragmentsrc, const char* vertexsrc, const char* primitivesrc);
+GLuint  PsychCreateGLSLProgram(PsychWindowRecordType *windowRecord, const char* fragmentsrc, const char* vertexsrc, const char* primitivesrc);
+// Release in-memory GLSL program binary cache at Screen shutdown:
+void	PsychFreeGLSLProgramCache(void);
 
 // Assign special filter/lookup shaders to textures, e.g., in HDR mode, for float textures, etc...
 psych_bool PsychAssignHighPrecisionTextureShaders(PsychWindowRecordType* textureRecord, PsychWindowRecordType* windowRecord, int usefloatformat, int userRequest);
@@ -28,6 +28,8 @@
 		10/11/05	mk		Support for special Quicktime movie textures added.
 		01/02/05	mk		Moved from OSX folder to Common folder. Contains nearly only shared code.
 		3/07/06		awi		Print warnings conditionally according to PsychPrefStateGet_SuppressAllWarnings(). 
+		10/19/26	agent	Add PsychBatchBlitTexturesToDisplay() for batched drawing of many rects of one texture.
+		10/19/26	agent	Optional texture uploads via a ring of pixel buffer objects.
 	
 	DESCRIPTION:
 	
@@ -68,6 +70,270 @@ static GLenum  texturetarget = 0;
 // only used if texture creation failed and out-of-memory is a likely suspect.
 static size_t texmemguesstimate = 0;
 
+/* Texture uploads via pixel buffer objects:
+ *
+ * If the ConserveVRAM setting kPsychUsePBOTextureUploads is set, PsychCreateTexture()
+ * does not let glTexImage2D() / glTexSubImage2D() source the texture content directly
+ * from the textureMemory buffer in system RAM. Instead the content gets copied into one
+ * PBO of a small ring of pixel buffer objects and the texture is specified from that PBO.
+ * The copy into the PBO still happens synchronously in the calling thread, so texture
+ * creation itself is not non-blocking. Only the transfer from the PBO into VRAM is left
+ * to the driver, which can perform it via DMA after PsychCreateTexture() has returned,
+ * instead of stalling the texture specification call. The system RAM buffer can be
+ * released or reused immediately.
+ *
+ * A sync fence is inserted after each upload. The texture keeps its own fence in
+ * textureUploadFence, which marks it as "pending" until PsychWaitForPendingTextureUpload()
+ * retires it, at latest when the texture gets drawn for the first time or preloaded via
+ * Screen('PreloadTextures'). Each ring slot also keeps a fence, so a slot only gets reused
+ * after the upload which sourced from it has completed. PBOs belong to an OpenGL context,
+ * so there is one ring per context, deleted when its onscreen window gets closed.
+ *
+ * Only entry points known to the bundled GLEW are used. It predates OpenGL 4.x, so
+ * persistently mapped buffers via ARB_buffer_storage are not available, just as program
+ * binaries in PsychImagingPipelineSupport.c need manually resolved entry points.
+ */
+#define PSYCH_NUM_UPLOAD_PBOS 4
+
+typedef struct PsychUploadRing {
+	void*					context;						// OpenGL context in which the PBOs were created.
+	GLuint					pbo[PSYCH_NUM_UPLOAD_PBOS];		// Ring of PBOs.
+	GLsync					fence[PSYCH_NUM_UPLOAD_PBOS];	// Fence of last upload per PBO, NULL if none.
+	int						slot;							// Next PBO to use.
+	struct PsychUploadRing*	next;
+} PsychUploadRing;
+
+static PsychUploadRing*	uploadRingHead = NULL;
+static PsychUploadRing*	uploadRingActive = NULL;
+static int				uploadRingPending = 0;
+
+// Return size in bytes of one pixel of the textures upload data, or zero if unknown:
+static size_t PsychGetUploadPixelSize(PsychWindowRecordType *win)
+{
+	size_t components, typesize;
+
+	// Standard path: Derive from requested pixeldepth:
+	if (win->textureinternalformat == 0) return((size_t) win->depth / 8);
+
+	switch (win->textureexternaltype) {
+		case GL_UNSIGNED_BYTE:
+		case GL_BYTE:
+			typesize = 1;
+		break;
+
+		case GL_UNSIGNED_SHORT:
+		case GL_SHORT:
+		case GL_HALF_FLOAT_ARB:
+			typesize = 2;
+		break;
+
+		case GL_UNSIGNED_INT:
+		case GL_INT:
+		case GL_FLOAT:
+			typesize = 4;
+		break;
+
+		// Packed types which define the size of a whole pixel:
+		case GL_UNSIGNED_INT_8_8_8_8:
+		case GL_UNSIGNED_INT_8_8_8_8_REV:
+		case GL_UNSIGNED_INT_2_10_10_10_REV:
+			return(4);
+
+		case GL_UNSIGNED_SHORT_8_8_APPLE:
+		case GL_UNSIGNED_SHORT_8_8_REV_APPLE:
+			return(2);
+
+		default:
+			return(0);
+	}
+
+	switch (win->textureexternalformat) {
+		case GL_LUMINANCE:
+		case GL_RED:
+		case GL_ALPHA:
+			components = 1;
+		break;
+
+		case GL_LUMINANCE_ALPHA:
+			components = 2;
+		break;
+
+		case GL_RGB:
+		case GL_BGR:
+			components = 3;
+		break;
+
+		case GL_RGBA:
+		case GL_BGRA:
+			components = 4;
+		break;
+
+		default:
+			return(0);
+	}
+
+	return(components * typesize);
+}
+
+// Find or create the upload ring for the OpenGL context of 'win', which must be bound.
+// Returns NULL if the GL implementation lacks PBO or sync object support:
+static PsychUploadRing* PsychGetUploadRing(PsychWindowRecordType *win)
+{
+	PsychUploadRing* ring;
+	void* context = (void*) win->targetSpecific.contextObject;
+
+	if ((context == NULL) || !(GLEW_ARB_pixel_buffer_object || GLEW_VERSION_2_1) || !(GLEW_ARB_sync || GLEW_VERSION_3_2)) return(NULL);
+
+	for (ring = uploadRingHead; ring; ring = ring->next) if (ring->context == context) return(ring);
+
+	ring = (PsychUploadRing*) calloc(1, sizeof(PsychUploadRing));
+	if (ring == NULL) return(NULL);
+
+	ring->context = context;
+	glGenBuffers(PSYCH_NUM_UPLOAD_PBOS, ring->pbo);
+	ring->next = uploadRingHead;
+	uploadRingHead = ring;
+
+	if (PsychPrefStateGet_Verbosity() > 3) printf("PTB-INFO: Using texture uploads via a ring of %i pixel buffer objects.\n", PSYCH_NUM_UPLOAD_PBOS);
+
+	return(ring);
+}
+
+// Copy the texture content of 'win' of 'width' x 'height' pixels into the next free
+// PBO of the upload ring and leave that PBO bound as GL_PIXEL_UNPACK_BUFFER, so the
+// following glTex(Sub)Image2D calls source from it at offset zero. Returns FALSE and
+// leaves no PBO bound if the content can't be staged, in which case the caller uploads
+// synchronously from win->textureMemory as usual:
+static psych_bool PsychStageTextureUpload(PsychWindowRecordType *win, int width, int height)
+{
+	PsychUploadRing* ring;
+	GLenum waitresult;
+	GLint alignment;
+	size_t pixelsize, stride, bytes;
+	void* dst;
+
+	if ((win->textureMemory == NULL) || (width < 1) || (height < 1) || ((pixelsize = PsychGetUploadPixelSize(win)) == 0)) return(FALSE);
+	if ((ring = PsychGetUploadRing(win)) == NULL) return(FALSE);
+
+	// Size of the upload data, taking row alignment into account:
+	alignment = (win->textureByteAligned > 1) ? win->textureByteAligned : 1;
+	stride = (((size_t) width * pixelsize) + (size_t) alignment - 1) / (size_t) alignment * (size_t) alignment;
+	bytes = stride * (size_t) (height - 1) + (size_t) width * pixelsize;
+
+	// Wait until the last upload from this slot has completed:
+	if (ring->fence[ring->slot]) {
+		do {
+			waitresult = glClientWaitSync(ring->fence[ring->slot], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+		} while (waitresult == GL_TIMEOUT_EXPIRED);
+		glDeleteSync(ring->fence[ring->slot]);
+		ring->fence[ring->slot] = NULL;
+	}
+
+	// Orphan old storage of the PBO, allocate new storage, map and fill it:
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring->pbo[ring->slot]);
+	glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr) (stride * (size_t) height), NULL, GL_STREAM_DRAW);
+	dst = glMapBuffer(GL_PIXEL_UNPACK_BUFFER, GL_WRITE_ONLY);
+	if (dst == NULL) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		if (PsychPrefStateGet_Verbosity() > 5) printf("PTB-DEBUG: Failed to map upload PBO for texture of %i x %i texels. Uploading synchronously.\n", width, height);
+		return(FALSE);
+	}
+
+	memcpy(dst, (void*) win->textureMemory, bytes);
+	if (!glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) {
+		// Content got lost during mapping, e.g., due to a display mode switch:
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		return(FALSE);
+	}
+
+	uploadRingActive = ring;
+	return(TRUE);
+}
+
+// Finish an upload staged by PsychStageTextureUpload(): Unbind the PBO, fence the
+// upload for slot reuse and mark texture 'win' as pending:
+static void PsychFinishTextureUpload(PsychWindowRecordType *win)
+{
+	PsychUploadRing* ring = uploadRingActive;
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	ring->fence[ring->slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	ring->slot = (ring->slot + 1) % PSYCH_NUM_UPLOAD_PBOS;
+	uploadRingActive = NULL;
+
+	if (win->textureUploadFence) glDeleteSync(win->textureUploadFence);
+	else uploadRingPending++;
+	win->textureUploadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	// Make sure the upload gets submitted to the GPU now, instead of whenever the
+	// command buffer fills up:
+	glFlush();
+
+	return;
+}
+
+/* PsychWaitForPendingTextureUpload()
+ * Retire a pending PBO upload of texture 'win', if any. If 'blocking' is TRUE, wait until
+ * the upload has completed, otherwise only mark the texture as no longer pending: Texture
+ * specification from a bound PBO is ordered with respect to all following commands, so
+ * drawing the texture needs no extra synchronization.
+ */
+void PsychWaitForPendingTextureUpload(PsychWindowRecordType *win, psych_bool blocking)
+{
+	GLenum waitresult;
+
+	if (win->textureUploadFence == NULL) return;
+
+	if (blocking) {
+		do {
+			waitresult = glClientWaitSync(win->textureUploadFence, GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);
+		} while (waitresult == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(win->textureUploadFence);
+	win->textureUploadFence = NULL;
+	uploadRingPending--;
+
+	return;
+}
+
+/* PsychDeleteTextureUploadRing()
+ * Delete the PBO upload ring of the OpenGL context of onscreen window 'windowRecord'.
+ * Called at onscreen window close time, while the windows context is still bound.
+ */
+void PsychDeleteTextureUploadRing(PsychWindowRecordType *windowRecord)
+{
+	PsychUploadRing** pring;
+	PsychUploadRing* ring;
+	void* context = (void*) windowRecord->targetSpecific.contextObject;
+	int i;
+
+	pring = &uploadRingHead;
+	while (*pring) {
+		ring = *pring;
+		if (ring->context == context) {
+			*pring = ring->next;
+			for (i = 0; i < PSYCH_NUM_UPLOAD_PBOS; i++) if (ring->fence[i]) glDeleteSync(ring->fence[i]);
+			glDeleteBuffers(PSYCH_NUM_UPLOAD_PBOS, ring->pbo);
+			free(ring);
+		}
+		else {
+			pring = &(ring->next);
+		}
+	}
+
+	return;
+}
+
+/* PsychGetNumPendingTextureUploads()
+ * Return number of textures whose PBO upload has not been retired yet.
+ */
+int PsychGetNumPendingTextureUploads(void)
+{
+	return(uploadRingPending);
+}
+
 void PsychDetectTextureTarget(PsychWindowRecordType *win)
 {
     // First time invocation?
@@ -141,6 +407,8 @@ void PsychInitWindowRecordTextureFields(PsychWindowRecordType *win)
 		// setting will be used for the GL_UNPACK_ALIGNMENT setting in PsychCreateTexture() and friends
 		// to optimize texture upload:
 		win->textureByteAligned=0;
+		// No PBO texture upload pending:
+		win->textureUploadFence=NULL;
 }
 
 
@@ -231,7 +499,8 @@ void PsychCreateTexture(PsychWindowRecordType *win)
 	long							screenWidth, screenHeight;
 	int								twidth, theight, pass, texcount;
 	void*							texmemptr;
-	psych_bool							recycle = FALSE, avoidCPUGPUSync;
+	void*							uploadptr;
+	psych_bool							recycle = FALSE, avoidCPUGPUSync, pboupload, staged = FALSE;
 	GLenum							glerr;
 	int								verbosity;
 
@@ -264,6 +533,10 @@ void PsychCreateTexture(PsychWindowRecordType *win)
 	// storage of textures instead of VRAM caching in order to conserve VRAM memory on
 	// low-mem gfx-cards. Enable clientstorage, if so...
 	clientstorage = (PsychPrefStateGet_ConserveVRAM() & kPsychDontCacheTextures) ? TRUE : FALSE;
+
+	// Texture upload via PBO's requested? Not possible with client storage, which
+	// needs the system RAM buffer as backing store anyway:
+	pboupload = ((PsychPrefStateGet_ConserveVRAM() & kPsychUsePBOTextureUploads) && !clientstorage && (win->textureOrientation != 1)) ? TRUE : FALSE;
 	
 	// Create a unique texture handle for this texture:
 	// If the texture already has a handle assigned then this means that we shouldn't
@@ -374,6 +647,13 @@ void PsychCreateTexture(PsychWindowRecordType *win)
 		twidth=sourceWidth;
 		theight=sourceHeight;
 		texmemptr=win->textureMemory;
+
+		// Rectangle textures get their content already at creation time in stage 1 below, so
+		// stage a PBO upload now, if requested. texmemptr becomes the offset into the PBO:
+		if (pboupload && PsychStageTextureUpload(win, (int) sourceWidth, (int) sourceHeight)) {
+			staged = TRUE;
+			texmemptr = NULL;
+		}
 	}
 	
 	// We only execute this pass for really new textures, not for recycled ones:
@@ -470,6 +750,7 @@ void PsychCreateTexture(PsychWindowRecordType *win)
 					
 					// Free all ressources already allocated for this failed texture creation request:
 					glBindTexture(texturetarget, 0);
+					if (staged) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 					glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 					glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 					glDeleteTextures(1, &win->textureNumber);
@@ -567,6 +848,10 @@ void PsychCreateTexture(PsychWindowRecordType *win)
 	
 	// Stage 2: If its a 2D texture or a recycled texture, fill it with content via glTexSubImage2D:
 	if (texturetarget==GL_TEXTURE_2D || recycle) {
+	  // Power of two textures were created empty in stage 1, so stage a PBO upload now, if requested:
+	  if (pboupload && !staged) staged = PsychStageTextureUpload(win, (int) sourceWidth, (int) sourceHeight);
+	  uploadptr = (staged) ? NULL : (void*) win->textureMemory;
+
 	  // Special setup code for pot2 textures: Fill the empty power of two texture object with content:
 	  // We only fill a subrectangle (of sourceWidth x sourceHeight size) with our images content. The
 	  // unused border contains all zero == black.
@@ -575,29 +860,32 @@ void PsychCreateTexture(PsychWindowRecordType *win)
 	    // Standard path: Derive texture format and such from requested pixeldepth:
 	    switch(win->depth) {
 	    case 8:
-	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_LUMINANCE, GL_UNSIGNED_BYTE, win->textureMemory);
+	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_LUMINANCE, GL_UNSIGNED_BYTE, uploadptr);
 	      break;
 	    
 	    case 16:
-	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, win->textureMemory);
+	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, uploadptr);
 	      break;
 	    
 	    case 24:
-	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_RGB, GL_UNSIGNED_BYTE, win->textureMemory);
+	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_RGB, GL_UNSIGNED_BYTE, uploadptr);
 	      break;
 	    
 	    case 32:
-	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_BGRA, ((win->gfxcaps & kPsychGfxCapNeedsUnsignedByteRGBATextureUpload) ? GL_UNSIGNED_BYTE : GL_UNSIGNED_INT_8_8_8_8_REV), win->textureMemory);
+	      glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, GL_BGRA, ((win->gfxcaps & kPsychGfxCapNeedsUnsignedByteRGBATextureUpload) ? GL_UNSIGNED_BYTE : GL_UNSIGNED_INT_8_8_8_8_REV), uploadptr);
 	      break;
 	    }
 	  }
 	  else {
 	    // Requested internal format and external data representation are explicitely requested: Use it.
-	    glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, win->textureexternalformat, win->textureexternaltype, win->textureMemory);
+	    glTexSubImage2D(texturetarget, 0, 0, 0, (GLsizei)sourceWidth, (GLsizei)sourceHeight, win->textureexternalformat, win->textureexternaltype, uploadptr);
 	    glinternalFormat = win->textureinternalformat;
 	  }
 	}
 
+	// Asynchronous upload submitted? Mark texture as pending:
+	if (staged) PsychFinishTextureUpload(win);
+
 	// New internal format requested?
 	if ((!avoidCPUGPUSync || (verbosity > 10)) && (!recycle && (gl_lastrequestedinternalFormat != glinternalFormat))) {
 		// Seems so...
@@ -717,6 +1005,9 @@ void PsychFreeTextureForWindowRecord(PsychWindowRecordType *win)
         // work for some strange reason :(
         if ((win->textureMemory) && (win->textureNumber > 0)) glFinish(); // FinishObjectAPPLE(GL_TEXTURE_2D, win->textureNumber);
 
+        // Retire a still pending PBO upload before the texture goes away:
+        PsychWaitForPendingTextureUpload(win, FALSE);
+
         // Perform standard OpenGL texture cleanup if needed:
 		if (win->textureNumber != 0) {
 			glDeleteTextures(1, &win->textureNumber);
@@ -740,88 +1031,72 @@ void PsychFreeTextureForWindowRecord(PsychWindowRecordType *win)
 }
 
 
-void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordType *target, double *sourceRect, double *targetRect,
-                               double rotationAngle, int filterMode, double globalAlpha)
+/* PsychGetTextureBlitCoords() - Compute texture coordinates for blitting sourceRect of texture 'source'.
+ *
+ * Returns the texture coordinates of the corners of sourceRect in sourceX, sourceY, sourceXEnd, sourceYEnd,
+ * the size of the texture image in sourceWidth and sourceHeight, and for GL_TEXTURE_2D textures the size of
+ * the real underlying power-of-two texture in tWidth and tHeight.
+ */
+static void PsychGetTextureBlitCoords(PsychWindowRecordType *source, double *sourceRect, GLenum texturetarget,
+									  GLdouble *sourceX, GLdouble *sourceY, GLdouble *sourceXEnd, GLdouble *sourceYEnd,
+									  GLdouble *sourceWidth, GLdouble *sourceHeight, GLdouble *tWidth, GLdouble *tHeight)
 {
-        GLdouble				sourceWidth, sourceHeight, tWidth, tHeight;
-        GLdouble                sourceX, sourceY, sourceXEnd, sourceYEnd;
-		double                  transX, transY;
-        GLenum                  texturetarget;
-		GLint					attrib;
-		GLuint					shader = 0;
-		
-        // Enable targets framebuffer as current drawingtarget, except if this is a
-		// blit operation from a window into itself and the imaging pipe is on:
-        if ((source != target) || (target->imagingMode==0)) {
-			PsychSetDrawingTarget(target);
-		}
-		else {
-			// Activate rendering context of target window without changing drawing target:
-			PsychSetGLContext(target);
-		}
-		
-        // Setup texture-target if not already done:
-        PsychDetectTextureTarget(target);
-        
-        // Query target for this specific texture:
-        texturetarget = PsychGetTextureTarget(source);
-
-		//printf("%i\n", source->textureOrientation);
-		
         // This code allows the application of sourceRect, as it is meant to be:
         // CAUTION: This calculation with sourceHeight - xxxx  depends on if GPU texture swapping
         // is on or off!!!!
         // 0 == Transposed as from Matlab image array aka renderswap off. 1 == Renderswapped
         // texture (currently not yet enabled). 2 == Offscreen window in normal orientation.
         if ((source->textureOrientation == 1 && renderswap) || source->textureOrientation == 2) {
-            sourceHeight=PsychGetHeightFromRect(source->rect);
-            sourceWidth=PsychGetWidthFromRect(source->rect);
+            *sourceHeight=PsychGetHeightFromRect(source->rect);
+            *sourceWidth=PsychGetWidthFromRect(source->rect);
 
-            sourceX=sourceRect[kPsychLeft];
-            sourceY=sourceHeight - sourceRect[kPsychBottom];
-            sourceXEnd=sourceRect[kPsychRight];
-            sourceYEnd=sourceHeight - sourceRect[kPsychTop];
+            *sourceX=sourceRect[kPsychLeft];
+            *sourceY=*sourceHeight - sourceRect[kPsychBottom];
+            *sourceXEnd=sourceRect[kPsychRight];
+            *sourceYEnd=*sourceHeight - sourceRect[kPsychTop];
         }
         else {
-            sourceHeight=PsychGetWidthFromRect(source->rect);
-			sourceWidth=PsychGetHeightFromRect(source->rect);
-            sourceX=sourceRect[kPsychTop];
-            sourceY=sourceRect[kPsychLeft];
-            sourceXEnd=sourceRect[kPsychBottom];
-            sourceYEnd=sourceRect[kPsychRight];
+            *sourceHeight=PsychGetWidthFromRect(source->rect);
+			*sourceWidth=PsychGetHeightFromRect(source->rect);
+            *sourceX=sourceRect[kPsychTop];
+            *sourceY=sourceRect[kPsychLeft];
+            *sourceXEnd=sourceRect[kPsychBottom];
+            *sourceYEnd=sourceRect[kPsychRight];
         }
     
 		// Overrides for special cases: Corevideo textures from Quicktime-subsystem or upside-down
         // texture from Quicktime GWorld or Sequence-Grabber...
         if (source->textureOrientation == 3) {
-            sourceHeight=PsychGetHeightFromRect(source->rect);
-			sourceWidth=PsychGetWidthFromRect(source->rect);
-			sourceX=sourceRect[kPsychLeft];
-            sourceY=sourceRect[kPsychBottom];
-            sourceXEnd=sourceRect[kPsychRight];
-            sourceYEnd=sourceRect[kPsychTop];
+            *sourceHeight=PsychGetHeightFromRect(source->rect);
+			*sourceWidth=PsychGetWidthFromRect(source->rect);
+			*sourceX=sourceRect[kPsychLeft];
+            *sourceY=sourceRect[kPsychBottom];
+            *sourceXEnd=sourceRect[kPsychRight];
+            *sourceYEnd=sourceRect[kPsychTop];
         }
 
 		// This case can happen with some QT movies, they are upside down in an unusual way:
         if (source->textureOrientation == 4) {
-            sourceHeight=PsychGetHeightFromRect(source->rect);
-			sourceWidth=PsychGetWidthFromRect(source->rect);
-			sourceX=sourceRect[kPsychLeft];
-            sourceY=sourceHeight - sourceRect[kPsychBottom];
-            sourceXEnd=sourceRect[kPsychRight];
-            sourceYEnd=sourceHeight - sourceRect[kPsychTop];
+            *sourceHeight=PsychGetHeightFromRect(source->rect);
+			*sourceWidth=PsychGetWidthFromRect(source->rect);
+			*sourceX=sourceRect[kPsychLeft];
+            *sourceY=*sourceHeight - sourceRect[kPsychBottom];
+            *sourceXEnd=sourceRect[kPsychRight];
+            *sourceYEnd=*sourceHeight - sourceRect[kPsychTop];
         }
 
+	*tWidth = *tHeight = 0;
+
         // Special case handling for GL_TEXTURE_2D textures. We need to map the
 	// absolute texture coordinates (in pixels) to the interval 0.0 - 1.0 where
 	// 1.0 == full extent of power of two texture...
 	if (texturetarget==GL_TEXTURE_2D) {
 	  // Find size of real underlying texture (smallest power of two which is
 	  // greater than or equal to the image size:
-	  tWidth=1;
-	  while (tWidth < sourceWidth) tWidth*=2;
-	  tHeight=1;
-	  while (tHeight < sourceHeight) tHeight*=2;
+	  *tWidth=1;
+	  while (*tWidth < *sourceWidth) *tWidth*=2;
+	  *tHeight=1;
+	  while (*tHeight < *sourceHeight) *tHeight*=2;
 
 	  // Remap texcoords into 0-1 subrange: We subtract 0.5 pixel-units before
 	  // mapping to accomodate for roundoff-error in the power-of-two gfx
@@ -831,15 +1106,35 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 	  // http://home.planet.nl/~monstrous/skybox.html
 	  //sourceX-=0.5f;
 	  //sourceY-=0.5f;
-	  sourceXEnd-=0.5f;
-	  sourceYEnd-=0.5f;
+	  *sourceXEnd-=0.5f;
+	  *sourceYEnd-=0.5f;
 	  // Remap:
-	  sourceX=sourceX / tWidth;
-	  sourceXEnd=sourceXEnd / tWidth;
-	  sourceY=sourceY / tHeight;
-	  sourceYEnd=sourceYEnd / tHeight;
+	  *sourceX=*sourceX / *tWidth;
+	  *sourceXEnd=*sourceXEnd / *tWidth;
+	  *sourceY=*sourceY / *tHeight;
+	  *sourceYEnd=*sourceYEnd / *tHeight;
 	}
 
+	return;
+}
+
+/* PsychIsTextureInNormalOrientation() - Does the texture use "normal" coordinate assignments for blitting,
+ * or the swapped ones of transposed Matlab/Octave image matrices?
+ */
+static psych_bool PsychIsTextureInNormalOrientation(PsychWindowRecordType *source)
+{
+	return(((source->textureOrientation == 1 && renderswap) || source->textureOrientation == 2 || source->targetSpecific.QuickTimeGLTexture ||
+			source->textureOrientation == 3 || source->textureOrientation == 4) ? TRUE : FALSE);
+}
+
+/* PsychSetupTextureBlitState() - Bind texture 'source' and setup filtering, wrap mode and any
+ * automatic filter- or lookup shader for blitting it with 'filterMode'. Returns the bound
+ * automatic shader, or zero if none.
+ */
+static GLuint PsychSetupTextureBlitState(PsychWindowRecordType *source, PsychWindowRecordType *target, GLenum texturetarget, int filterMode, psych_bool wrapTexture)
+{
+	GLuint shader = 0;
+
 	// MK: We need to reenable the proper texturing mode. This fixes bug reported in Forum message 3055,
 	// because SCREENDrawText glDisable'd GL_TEXTURE_RECTANGLE_EXT, without this routine reenabling it.
 	glDisable(GL_TEXTURE_2D);
@@ -849,6 +1144,8 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 	// enable texture mapping and just blit the quad, with interpolated
 	// texture coordinates set up for purely procedural shading.
 	if (source->textureNumber > 0) {
+		// Retire a pending PBO upload of the texture, drawing it is ordered after the upload anyway:
+		PsychWaitForPendingTextureUpload(source, FALSE);
 		glEnable(texturetarget);
 		glBindTexture(texturetarget, source->textureNumber);
 	}
@@ -894,30 +1191,12 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 		}
 	}
 
-	// Any automatic shader assigned yet?
-	if (shader > 0) {
-		// In case our texture (filter)/(lookup) shader also requests/defines a 'modulateColor'
-		// attribute in its vertex shader part, this attribute is assigned the 
-		// unclamped RGBA 'modulateColor' after normalization via the colorrange
-		// value of Screen('ColorRange'), or the unclamped globalAlpha value:
-		if ((attrib = glGetAttribLocationARB(shader, "modulateColor")) >= 0) {
-			if(globalAlpha == DBL_MAX) {
-				// globalAlpha disabled: Pass the 'modulateColor' vector:
-				glVertexAttrib4dvARB(attrib, target->currentColor);
-			}
-			else {
-				// modulateColor disabled: Pass (1,1,1) as RGB color and globalAlpha as alpha:
-				glVertexAttrib4fARB(attrib, 1.0, 1.0, 1.0, (GLfloat) globalAlpha);
-			}
-		}
-	}
-
 	// Setup texture wrap-mode: We usually default to clamping - the best we can do
 	// for the rectangle textures we usually use. Special case is the intentional
 	// use of power-of-two textures with a real power-of-two size. In that case we
 	// enable wrapping mode to allow for scrolling effects -- useful for drifting
 	// gratings.
-	if (texturetarget==GL_TEXTURE_2D && tWidth==sourceWidth && tHeight==sourceHeight) {
+	if (wrapTexture) {
 	  // Special case: Scrollable real power-of-two textures. Enable wrapping.
 	  glTexParameteri(texturetarget, GL_TEXTURE_WRAP_S, GL_REPEAT);
 	  glTexParameteri(texturetarget, GL_TEXTURE_WRAP_T, GL_REPEAT);	  
@@ -934,10 +1213,84 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 	// global blending without need for a texture alpha-channel...
 	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
+	return(shader);
+}
+
+/* PsychTeardownTextureBlitState() - Undo texture binding of PsychSetupTextureBlitState(). */
+static void PsychTeardownTextureBlitState(PsychWindowRecordType *source, GLenum texturetarget)
+{
+	// Only disable texture mapping if we actually enabled it.
+	if (source->textureNumber > 0) {
+		// Reset filters to nearest: This is important in case this texture
+		// is used as color buffer attachment of a FBO, because using the
+		// FBO would fail in puzzling ways if filtermode!=GL_NEAREST.
+		glTexParameteri(texturetarget, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(texturetarget, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        // Unbind texture:
+		glBindTexture(texturetarget, 0);
+        glDisable(texturetarget);
+	}
+
+	return;
+}
+
+void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordType *target, double *sourceRect, double *targetRect,
+                               double rotationAngle, int filterMode, double globalAlpha)
+{
+        GLdouble				sourceWidth, sourceHeight, tWidth, tHeight;
+        GLdouble                sourceX, sourceY, sourceXEnd, sourceYEnd;
+		double                  transX, transY;
+        GLenum                  texturetarget;
+		GLint					attrib;
+		GLuint					shader = 0;
+		
+        // Enable targets framebuffer as current drawingtarget, except if this is a
+		// blit operation from a window into itself and the imaging pipe is on:
+        if ((source != target) || (target->imagingMode==0)) {
+			PsychSetDrawingTarget(target);
+		}
+		else {
+			// Activate rendering context of target window without changing drawing target:
+			PsychSetGLContext(target);
+		}
+		
+        // Setup texture-target if not already done:
+        PsychDetectTextureTarget(target);
+        
+        // Query target for this specific texture:
+        texturetarget = PsychGetTextureTarget(source);
+
+		//printf("%i\n", source->textureOrientation);
+		
+	// Compute texture coordinates for sourceRect:
+	PsychGetTextureBlitCoords(source, sourceRect, texturetarget, &sourceX, &sourceY, &sourceXEnd, &sourceYEnd, &sourceWidth, &sourceHeight, &tWidth, &tHeight);
+
+	// Bind texture, setup filtering, wrap mode and automatic filter- or lookup shaders:
+	shader = PsychSetupTextureBlitState(source, target, texturetarget, filterMode, (texturetarget==GL_TEXTURE_2D && tWidth==sourceWidth && tHeight==sourceHeight) ? TRUE : FALSE);
+
+	// Any automatic shader assigned yet?
+	if (shader > 0) {
+		// In case our texture (filter)/(lookup) shader also requests/defines a 'modulateColor'
+		// attribute in its vertex shader part, this attribute is assigned the 
+		// unclamped RGBA 'modulateColor' after normalization via the colorrange
+		// value of Screen('ColorRange'), or the unclamped globalAlpha value:
+		if ((attrib = glGetAttribLocationARB(shader, "modulateColor")) >= 0) {
+			if(globalAlpha == DBL_MAX) {
+				// globalAlpha disabled: Pass the 'modulateColor' vector:
+				glVertexAttrib4dvARB(attrib, target->currentColor);
+			}
+			else {
+				// modulateColor disabled: Pass (1,1,1) as RGB color and globalAlpha as alpha:
+				glVertexAttrib4fARB(attrib, 1.0, 1.0, 1.0, (GLfloat) globalAlpha);
+			}
+		}
+	}
+
 	// A globalAlpha of DBL_MAX means: Don't set vertex color here, higher-level code
 	// has done it already. Used in SCREENDrawTexture for a global override color...
 	if (globalAlpha != DBL_MAX) glColor4f(1, 1, 1, globalAlpha);
-	
+
 	// Apply a rotation transform for rotated drawing, either to modelview-,
 	// or texture matrix.
 	if ((rotationAngle != 0.0) && !(source->specialflags & kPsychDontDoRotation)) {
@@ -1049,8 +1402,7 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 	glBegin(GL_QUADS);
 	// Coordinate assignments depend on internal texture orientation...
 	// Override for special case: Corevideo texture from Quicktime-subsystem.
-	if ((source->textureOrientation == 1 && renderswap) || source->textureOrientation == 2 || source->targetSpecific.QuickTimeGLTexture ||
-		source->textureOrientation == 3 || source->textureOrientation == 4) {
+	if (PsychIsTextureInNormalOrientation(source)) {
 		// NEW CODE: Uses "normal" coordinate assignments, so that the rotation == 0 deg. case
 		// is the fastest case --> Most common orientation has highest performance.
 		//lower left
@@ -1096,18 +1448,8 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 		glMatrixMode(GL_MODELVIEW);
 	}
 	
-	// Only disable texture mapping if we actually enabled it.
-	if (source->textureNumber > 0) {
-		// Reset filters to nearest: This is important in case this texture
-		// is used as color buffer attachment of a FBO, because using the
-		// FBO would fail in puzzling ways if filtermode!=GL_NEAREST.
-		glTexParameteri(texturetarget, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-		glTexParameteri(texturetarget, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-        // Unbind texture:
-		glBindTexture(texturetarget, 0);
-        glDisable(texturetarget);
-	}
+	// Unbind texture and reset its filter modes:
+	PsychTeardownTextureBlitState(source, texturetarget);
 	
 	/* Dead and disabled: Left here for documentation...
 	if ((filterMode > 0 && source->textureFilterShader > 0) || (source->textureFilterShader < 0)) {
@@ -1125,6 +1467,240 @@ void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordT
 	return;
 }
 
+/* PsychBatchBlitTexturesToDisplay() - Blit many rectangles of one texture with one draw call.
+ *
+ * This is the batched equivalent of 'count' calls to PsychBlitTextureToDisplay() with the
+ * same 'source' texture and 'filterMode', as used by Screen('DrawTextures'). Instead of one
+ * immediate mode quad per item with full state setup, all quads are assembled into vertex
+ * arrays and drawn via one glDrawArrays() call. Rotations are applied on the CPU to the vertex
+ * positions or texture coordinates. Per item parameters for procedural or filter shaders, i.e.,
+ * 'srcRect', 'dstRect', 'sizeAngleFilterMode', 'modulateColor' and 'auxParameters0' - 7, are
+ * passed as per-vertex attribute arrays.
+ *
+ * sourceRects, targetRects - 4 * count rectangles.
+ * rotationAngles - count rotation angles in degrees.
+ * colors - 4 * count RGBA vertex colors, or NULL to use the current vertex color for all items.
+ * auxParameters - numAuxComponents * count auxParameters, or NULL if none.
+ *
+ * The caller must make sure that source != target.
+ */
+void PsychBatchBlitTexturesToDisplay(PsychWindowRecordType *source, PsychWindowRecordType *target, int count, double *sourceRects, double *targetRects,
+									 double *rotationAngles, int filterMode, double *colors, double *auxParameters, int numAuxComponents)
+{
+	GLdouble		sourceWidth, sourceHeight, tWidth, tHeight;
+	GLdouble		sourceX, sourceY, sourceXEnd, sourceYEnd;
+	GLdouble		tx[4], ty[4], vx[4], vy[4];
+	double			transX, transY, cosa, sina, dx, dy, *sourceRect, *targetRect;
+	GLenum			texturetarget;
+	GLuint			shader, usershader, activeshader;
+	GLint			modulateColorAttrib, srcRectAttrib, dstRectAttrib, sizeAngleFilterModeAttrib, auxAttrib[8];
+	GLfloat			*vertices, *texcoords, *vcolors, *modulateColors, *srcRectArray, *dstRectArray, *sizeAngleFilterModeArray, *auxArray[8];
+	char			auxName[20];
+	int				i, j, k, m, nrAux;
+	psych_bool		rotateVertices, rotateTexcoords;
+
+	if (count <= 0) return;
+
+	PsychSetDrawingTarget(target);
+	PsychDetectTextureTarget(target);
+	texturetarget = PsychGetTextureTarget(source);
+
+	// Wrap mode only depends on texture size, so derive it from the first item:
+	PsychGetTextureBlitCoords(source, sourceRects, texturetarget, &sourceX, &sourceY, &sourceXEnd, &sourceYEnd, &sourceWidth, &sourceHeight, &tWidth, &tHeight);
+	shader = PsychSetupTextureBlitState(source, target, texturetarget, filterMode, (texturetarget==GL_TEXTURE_2D && tWidth==sourceWidth && tHeight==sourceHeight) ? TRUE : FALSE);
+
+	// User supplied procedural or image processing texture shader overrides automatic shaders:
+	usershader = (source->textureFilterShader < 0) ? (GLuint) (-1 * source->textureFilterShader) : 0;
+	if (usershader > 0) {
+		if (0 == PsychSetShader(target, usershader)) PsychErrorExitMsg(PsychError_user, "Tried to use a user defined texture shader or procedural texture, but your hardware doesn't support GLSL shaders.");
+	}
+	else if (shader == 0) {
+		PsychSetShader(target, 0);
+	}
+	activeshader = (usershader > 0) ? usershader : shader;
+
+	// Find out which per-item attributes the shader wants:
+	modulateColorAttrib = srcRectAttrib = dstRectAttrib = sizeAngleFilterModeAttrib = -1;
+	for (k = 0; k < 8; k++) auxAttrib[k] = -1;
+	nrAux = 0;
+	if (activeshader > 0) {
+		modulateColorAttrib = glGetAttribLocationARB(activeshader, "modulateColor");
+		if (usershader > 0) {
+			srcRectAttrib = glGetAttribLocationARB(usershader, "srcRect");
+			dstRectAttrib = glGetAttribLocationARB(usershader, "dstRect");
+			sizeAngleFilterModeAttrib = glGetAttribLocationARB(usershader, "sizeAngleFilterMode");
+			if (auxParameters) {
+				nrAux = numAuxComponents / 4;
+				if (nrAux > 8) nrAux = 8;
+				for (k = 0; k < nrAux; k++) {
+					sprintf(auxName, "auxParameters%i", k);
+					auxAttrib[k] = glGetAttribLocationARB(usershader, auxName);
+				}
+			}
+		}
+	}
+
+	// Allocate vertex arrays, 4 vertices per item:
+	vertices = (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 2 * 4 * count);
+	texcoords = (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 2 * 4 * count);
+	vcolors = (colors) ? (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 4 * 4 * count) : NULL;
+	modulateColors = (colors && (modulateColorAttrib >= 0)) ? (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 4 * 4 * count) : NULL;
+	srcRectArray = (srcRectAttrib >= 0) ? (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 4 * 4 * count) : NULL;
+	dstRectArray = (dstRectAttrib >= 0) ? (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 4 * 4 * count) : NULL;
+	sizeAngleFilterModeArray = (sizeAngleFilterModeAttrib >= 0) ? (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 4 * 4 * count) : NULL;
+	for (k = 0; k < 8; k++) auxArray[k] = (auxAttrib[k] >= 0) ? (GLfloat*) PsychMallocTemp(sizeof(GLfloat) * 4 * 4 * count) : NULL;
+
+	for (i = 0; i < count; i++) {
+		sourceRect = &(sourceRects[i * 4]);
+		targetRect = &(targetRects[i * 4]);
+		PsychGetTextureBlitCoords(source, sourceRect, texturetarget, &sourceX, &sourceY, &sourceXEnd, &sourceYEnd, &sourceWidth, &sourceHeight, &tWidth, &tHeight);
+
+		// Same vertex order and texture coordinate assignment as in PsychBlitTextureToDisplay():
+		vx[0] = targetRect[kPsychLeft];  vy[0] = targetRect[kPsychTop];
+		vx[1] = targetRect[kPsychLeft];  vy[1] = targetRect[kPsychBottom];
+		vx[2] = targetRect[kPsychRight]; vy[2] = targetRect[kPsychBottom];
+		vx[3] = targetRect[kPsychRight]; vy[3] = targetRect[kPsychTop];
+
+		if (PsychIsTextureInNormalOrientation(source)) {
+			tx[0] = sourceX;    ty[0] = sourceYEnd;
+			tx[1] = sourceX;    ty[1] = sourceY;
+			tx[2] = sourceXEnd; ty[2] = sourceY;
+			tx[3] = sourceXEnd; ty[3] = sourceYEnd;
+		}
+		else {
+			tx[0] = sourceX;    ty[0] = sourceY;
+			tx[1] = sourceXEnd; ty[1] = sourceY;
+			tx[2] = sourceXEnd; ty[2] = sourceYEnd;
+			tx[3] = sourceX;    ty[3] = sourceYEnd;
+		}
+
+		// Rotation around center of quad, either of vertex positions (modelview) or texture coordinates (texture matrix):
+		rotateVertices = rotateTexcoords = FALSE;
+		cosa = 1.0; sina = 0.0;
+		if ((rotationAngles[i] != 0.0) && !(source->specialflags & kPsychDontDoRotation)) {
+			if (!(source->specialflags & kPsychUseTextureMatrixForRotation)) rotateVertices = TRUE; else rotateTexcoords = TRUE;
+			cosa = cos(rotationAngles[i] * M_PI / 180.0);
+			sina = sin(rotationAngles[i] * M_PI / 180.0);
+		}
+
+		if (rotateVertices) {
+			transX = (targetRect[kPsychRight] + targetRect[kPsychLeft]) * 0.5;
+			transY = (targetRect[kPsychTop] + targetRect[kPsychBottom]) * 0.5;
+			for (j = 0; j < 4; j++) {
+				dx = vx[j] - transX; dy = vy[j] - transY;
+				vx[j] = transX + dx * cosa - dy * sina;
+				vy[j] = transY + dx * sina + dy * cosa;
+			}
+		}
+
+		if (rotateTexcoords) {
+			transX = (sourceX + sourceXEnd) * 0.5;
+			transY = (sourceY + sourceYEnd) * 0.5;
+			for (j = 0; j < 4; j++) {
+				dx = tx[j] - transX; dy = ty[j] - transY;
+				tx[j] = transX + dx * cosa - dy * sina;
+				ty[j] = transY + dx * sina + dy * cosa;
+			}
+		}
+
+		for (j = 0; j < 4; j++) {
+			k = i * 4 + j;
+			vertices[k * 2 + 0] = (GLfloat) vx[j];
+			vertices[k * 2 + 1] = (GLfloat) vy[j];
+			texcoords[k * 2 + 0] = (GLfloat) tx[j];
+			texcoords[k * 2 + 1] = (GLfloat) ty[j];
+
+			if (vcolors) {
+				vcolors[k * 4 + 0] = (GLfloat) colors[i * 4 + 0];
+				vcolors[k * 4 + 1] = (GLfloat) colors[i * 4 + 1];
+				vcolors[k * 4 + 2] = (GLfloat) colors[i * 4 + 2];
+				vcolors[k * 4 + 3] = (GLfloat) colors[i * 4 + 3];
+			}
+
+			if (modulateColors) memcpy(&(modulateColors[k * 4]), &(vcolors[k * 4]), sizeof(GLfloat) * 4);
+
+			if (srcRectArray) {
+				srcRectArray[k * 4 + 0] = (GLfloat) sourceRect[kPsychLeft];
+				srcRectArray[k * 4 + 1] = (GLfloat) sourceRect[kPsychTop];
+				srcRectArray[k * 4 + 2] = (GLfloat) sourceRect[kPsychRight];
+				srcRectArray[k * 4 + 3] = (GLfloat) sourceRect[kPsychBottom];
+			}
+
+			if (dstRectArray) {
+				dstRectArray[k * 4 + 0] = (GLfloat) targetRect[kPsychLeft];
+				dstRectArray[k * 4 + 1] = (GLfloat) targetRect[kPsychTop];
+				dstRectArray[k * 4 + 2] = (GLfloat) targetRect[kPsychRight];
+				dstRectArray[k * 4 + 3] = (GLfloat) targetRect[kPsychBottom];
+			}
+
+			if (sizeAngleFilterModeArray) {
+				sizeAngleFilterModeArray[k * 4 + 0] = (GLfloat) sourceWidth;
+				sizeAngleFilterModeArray[k * 4 + 1] = (GLfloat) sourceHeight;
+				sizeAngleFilterModeArray[k * 4 + 2] = (GLfloat) rotationAngles[i];
+				sizeAngleFilterModeArray[k * 4 + 3] = (GLfloat) filterMode;
+			}
+
+			for (m = 0; m < nrAux; m++) {
+				if (auxArray[m] == NULL) continue;
+				auxArray[m][k * 4 + 0] = (GLfloat) auxParameters[i * numAuxComponents + m * 4 + 0];
+				auxArray[m][k * 4 + 1] = (GLfloat) auxParameters[i * numAuxComponents + m * 4 + 1];
+				auxArray[m][k * 4 + 2] = (GLfloat) auxParameters[i * numAuxComponents + m * 4 + 2];
+				auxArray[m][k * 4 + 3] = (GLfloat) auxParameters[i * numAuxComponents + m * 4 + 3];
+			}
+		}
+	}
+
+	// Setup all arrays:
+	glVertexPointer(2, GL_FLOAT, 0, vertices);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, 0, texcoords);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	if (vcolors) {
+		glColorPointer(4, GL_FLOAT, 0, vcolors);
+		glEnableClientState(GL_COLOR_ARRAY);
+	}
+
+	// modulateColor is either per item, or the current modulateColor for all items:
+	if (modulateColors) {
+		glVertexAttribPointerARB(modulateColorAttrib, 4, GL_FLOAT, GL_FALSE, 0, modulateColors);
+		glEnableVertexAttribArrayARB(modulateColorAttrib);
+	}
+	else if (modulateColorAttrib >= 0) {
+		glVertexAttrib4dvARB(modulateColorAttrib, target->currentColor);
+	}
+
+	if (srcRectArray) { glVertexAttribPointerARB(srcRectAttrib, 4, GL_FLOAT, GL_FALSE, 0, srcRectArray); glEnableVertexAttribArrayARB(srcRectAttrib); }
+	if (dstRectArray) { glVertexAttribPointerARB(dstRectAttrib, 4, GL_FLOAT, GL_FALSE, 0, dstRectArray); glEnableVertexAttribArrayARB(dstRectAttrib); }
+	if (sizeAngleFilterModeArray) { glVertexAttribPointerARB(sizeAngleFilterModeAttrib, 4, GL_FLOAT, GL_FALSE, 0, sizeAngleFilterModeArray); glEnableVertexAttribArrayARB(sizeAngleFilterModeAttrib); }
+	for (k = 0; k < 8; k++) {
+		if (auxArray[k]) { glVertexAttribPointerARB(auxAttrib[k], 4, GL_FLOAT, GL_FALSE, 0, auxArray[k]); glEnableVertexAttribArrayARB(auxAttrib[k]); }
+	}
+
+	// Draw all quads at once:
+	glDrawArrays(GL_QUADS, 0, 4 * count);
+
+	// Disable and reset all arrays:
+	if (modulateColors) glDisableVertexAttribArrayARB(modulateColorAttrib);
+	if (srcRectArray) glDisableVertexAttribArrayARB(srcRectAttrib);
+	if (dstRectArray) glDisableVertexAttribArrayARB(dstRectAttrib);
+	if (sizeAngleFilterModeArray) glDisableVertexAttribArrayARB(sizeAngleFilterModeAttrib);
+	for (k = 0; k < 8; k++) if (auxArray[k]) glDisableVertexAttribArrayARB(auxAttrib[k]);
+
+	if (vcolors) {
+		glDisableClientState(GL_COLOR_ARRAY);
+		glColorPointer(4, GL_FLOAT, 0, NULL);
+	}
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, 0, NULL);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, NULL);
+
+	// Unbind texture and reset its filter modes:
+	PsychTeardownTextureBlitState(source, texturetarget);
+
+	return;
+}
+
 /* PsychGetTextureTarget
  * Returns GLenum with the texture target used for all PTB operations.
  * This way, external code can bind the correct target for given hardware.
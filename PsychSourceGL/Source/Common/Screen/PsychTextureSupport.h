@@ -31,9 +31,14 @@ void PsychCreateTexture(PsychWindowRecordType *win);
 void PsychFreeTextureForWindowRecord(PsychWindowRecordType *win);
 void PsychBlitTextureToDisplay(PsychWindowRecordType *source, PsychWindowRecordType *target, double *sourceRect, double *targetRect,
                                double rotationAngle, int filterMode, double globalAlpha);
+void PsychBatchBlitTexturesToDisplay(PsychWindowRecordType *source, PsychWindowRecordType *target, int count, double *sourceRects, double *targetRects,
+									 double *rotationAngles, int filterMode, double *colors, double *auxParameters, int numAuxComponents);
 GLenum PsychGetTextureTarget(PsychWindowRecordType *win);
 void PsychMapTexCoord(PsychWindowRecordType *tex, double* tx, double* ty);
 void PsychDetectTextureTarget(PsychWindowRecordType *win);
+void PsychWaitForPendingTextureUpload(PsychWindowRecordType *win, psych_bool blocking);
+void PsychDeleteTextureUploadRing(PsychWindowRecordType *windowRecord);
+int  PsychGetNumPendingTextureUploads(void);
 
 //end include once
 #endif
@@ -1534,6 +1534,9 @@ void PsychCloseWindow(PsychWindowRecordType *windowRecord)
 				// a window close due to error-abort or other abort with async flips active:
 				PsychReleaseFlipInfoStruct(windowRecord);
 
+				// Release the swap log, now that no flipper thread can append to it anymore:
+				PsychSwapLogRelease(windowRecord);
+
 				// Check if 10 bpc native framebuffer support was supposed to be enabled:
 				if (((windowRecord->specialflags & kPsychNative10bpcFBActive) || (PsychPrefStateGet_ConserveVRAM() & kPsychBypassLUTFor10BitFramebuffer))
 				    && PsychOSIsKernelDriverAvailable(windowRecord->screenNumber)) {
@@ -1559,6 +1562,12 @@ void PsychCloseWindow(PsychWindowRecordType *windowRecord)
 				// hook-chains:
 				PsychShutdownImagingPipeline(windowRecord, TRUE);
 				
+				// Delete all pooled FBOs of this windows OpenGL context:
+				PsychFBOPoolPurgeContext(windowRecord);
+
+				// Delete PBO ring for texture uploads of this windows OpenGL context:
+				PsychDeleteTextureUploadRing(windowRecord);
+
 				// Call cleanup routine of text renderers to cleanup anything text related for this windowRecord:
 				PsychCleanupTextRenderer(windowRecord);
 
@@ -1570,6 +1579,14 @@ void PsychCloseWindow(PsychWindowRecordType *windowRecord)
 			windowRecord->gpuRenderTimeQuery = 0;
 		}
 
+		// Destroy query of the flip timing model:
+		if (windowRecord->timingModel.gpuQuery) {
+			if (windowRecord->timingModel.gpuQueryState == 1) glEndQuery(GL_TIME_ELAPSED_EXT);
+			glDeleteQueries(1, &windowRecord->timingModel.gpuQuery);
+			windowRecord->timingModel.gpuQuery = 0;
+			windowRecord->timingModel.gpuQueryState = 0;
+		}
+
 				// Sync and idle the pipeline again:
                 glFinish();
 
@@ -1603,6 +1620,8 @@ void PsychCloseWindow(PsychWindowRecordType *windowRecord)
     }
     else if(windowRecord->windowType==kPsychTexture) {
                 // Texture or Offscreen window - which is also just a form of texture.
+				// Return its recyclable FBOs to the FBO pool first, so they don't get destroyed:
+				PsychRecycleTextureFBOs(windowRecord);
 				PsychFreeTextureForWindowRecord(windowRecord);
 
 				// Shutdown only OpenGL related parts of imaging pipeline for this windowRecord, i.e.
@@ -1693,6 +1712,45 @@ void PsychFlushGL(PsychWindowRecordType *windowRecord)
 #define strerror(x) "UNKNOWN"
 #endif
 
+// Memory barrier for the lock-free flip queue and swap log shared between masterthread and flipper thread:
+#if PSYCH_SYSTEM == PSYCH_WINDOWS
+#define PsychFlipQueueMemoryBarrier() MemoryBarrier()
+#else
+#define PsychFlipQueueMemoryBarrier() __sync_synchronize()
+#endif
+
+/* PsychReleaseFlipQueue() -- Release the flip queue of an onscreen window and its OpenGL resources.
+ * Must only be called after the flipper thread has terminated.
+ */
+static void PsychReleaseFlipQueue(PsychWindowRecordType *windowRecord)
+{
+	PsychFlipQueue* flipQueue = windowRecord->flipInfo->flipQueue;
+	PsychFlipQueueEntry* entry;
+	int i;
+
+	PsychSetGLContext(windowRecord);
+
+	// Make sure the final imaging pipeline stage targets the system framebuffer again, in case an
+	// error aborted PsychEnqueueFlip() while it was redirected to one of our entries:
+	windowRecord->fboTable[windowRecord->finalizedFBO[0]] = flipQueue->sysfbo;
+
+	for (i = 0; i < kPsychMaxFlipQueueDepth; i++) {
+		entry = &(flipQueue->entries[i]);
+		if (entry->fence) glDeleteSync(entry->fence);
+		if (entry->fbo) {
+			if (entry->fbo->fboid) glDeleteFramebuffersEXT(1, &(entry->fbo->fboid));
+			if (entry->fbo->coltexid) glDeleteTextures(1, &(entry->fbo->coltexid));
+			free(entry->fbo);
+		}
+	}
+
+	free(flipQueue->results);
+	free(flipQueue);
+	windowRecord->flipInfo->flipQueue = NULL;
+
+	return;
+}
+
 /* PsychReleaseFlipInfoStruct() -- Cleanup flipInfo struct
  *
  * This routine cleans up the flipInfo struct field of onscreen window records at
@@ -1750,6 +1808,10 @@ void PsychReleaseFlipInfoStruct(PsychWindowRecordType *windowRecord)
 		// function in a running session! (WTF?!?)
 		PsychSetThreadPriority(&(flipRequest->flipperThread), 0, 0);
 
+		// In flip queue mode we don't hold the lock. Acquire it, so our termination request
+		// can't race with the flipper threads check for new work:
+		if (flipRequest->flipQueue) PsychLockMutex(&(flipRequest->performFlipLock));
+
 		// Set opmode to "terminate please":
 		flipRequest->opmode = -1;
 
@@ -1770,7 +1832,7 @@ void PsychReleaseFlipInfoStruct(PsychWindowRecordType *windowRecord)
 		// any of these cases, the flipper thread is sleeping on its condition variable, waiting
 		// for new instructions and we have the lock. Check for asyncstate 2 or 0 to decide
 		// if we need to release the lock:
-		if ((flipRequest->asyncstate == 0) || (flipRequest->asyncstate == 2)) {
+		if ((flipRequest->asyncstate == 0) || (flipRequest->asyncstate == 2) || (flipRequest->flipQueue)) {
 			// Unlock the lock, so the thread can't block on it:
 			PsychUnlockMutex(&(flipRequest->performFlipLock));
 		}
@@ -1803,6 +1865,9 @@ void PsychReleaseFlipInfoStruct(PsychWindowRecordType *windowRecord)
 		// At this point, the thread and all other async flip resources have been terminated and released.
 	}
 
+	// Release flip queue, discarding all flips which weren't executed yet:
+	if (flipRequest->flipQueue) PsychReleaseFlipQueue(windowRecord);
+
 	// Release struct:
 	free(flipRequest);
 	windowRecord->flipInfo = NULL;
@@ -1849,6 +1914,8 @@ void* PsychFlipperThreadMain(void* windowRecordToCast)
     int viewid;
 	psych_uint64 vblcount = 0;
 	psych_uint64 vblqcount = 0;
+	PsychFlipQueue* flipQueue;
+	PsychFlipQueueEntry* entry;
 
 	// Select async flip implementation: Old-Style -- One context for both master-thread and flipper-thread:
 	psych_bool oldStyle = (PsychPrefStateGet_ConserveVRAM() & kPsychUseOldStyleAsyncFlips) ? TRUE : FALSE;
@@ -1893,8 +1960,80 @@ void* PsychFlipperThreadMain(void* windowRecordToCast)
 		PsychOSSetVBLSyncLevel(windowRecord, 1);
 	}
     
-	// We have a special dispatch loop for our home-grown frame-sequential stereo implementation:
-	if (windowRecord->stereomode != kPsychFrameSequentialStereo) {
+	// We have a special dispatch loop for queued flips via Screen('AsyncFlipEnqueue'):
+	if (flipRequest->flipQueue) {
+		flipQueue = flipRequest->flipQueue;
+
+		// Set our state as "initialized, ready & waiting":
+		flipRequest->flipperState = 1;
+
+		// Flip queue dispatch loop: Executes queued flips back to back, sleeps while the queue is empty.
+		// The queue itself is lock-free, we only hold the lock while checking for work or termination,
+		// so the masterthread can wake us up via flipperGoGoGo without ever missing a wakeup:
+		while (TRUE) {
+			// Check if we are supposed to terminate:
+			if (flipRequest->opmode == -1) {
+				// We hold the mutex, so set us to state "terminating with lock held" and exit the loop:
+				flipRequest->flipperState = 4;
+				break;
+			}
+
+			// Queue empty? Then sleep until the masterthread enqueues a flip or wants us to terminate:
+			if (flipQueue->tail == flipQueue->head) {
+				flipRequest->flipperState = 1;
+				if ((rc=PsychWaitCondition(&(flipRequest->flipperGoGoGo), &(flipRequest->performFlipLock)))) {
+					fprintf(stderr, "PTB-ERROR: In PsychFlipperThreadMain():  pthread_cond_wait() on flipperGoGoGo trigger failed  [%s].\n", strerror(rc));
+					flipRequest->flipperState = 5;
+					PsychOSUnsetGLContext(windowRecord);
+					return(NULL);
+				}
+
+				continue;
+			}
+
+			// Work to do: Release the lock while executing the flip, so enqueuing doesn't block on us:
+			flipRequest->flipperState = 2;
+			PsychUnlockMutex(&(flipRequest->performFlipLock));
+
+			// Make sure we see the entry as written by the masterthread before it advanced 'head':
+			PsychFlipQueueMemoryBarrier();
+			entry = &(flipQueue->entries[flipQueue->tail % kPsychMaxFlipQueueDepth]);
+
+			// Let the GPU wait for completion of the masterthreads rendering of the stimulus image:
+			if (entry->fence) {
+				glWaitSync(entry->fence, 0, GL_TIMEOUT_IGNORED);
+				glDeleteSync(entry->fence);
+				entry->fence = NULL;
+			}
+
+			// Setup view: We set the full backbuffer area of the window.
+			PsychSetupView(windowRecord, TRUE);
+
+			// Copy the stimulus image into the backbuffer:
+			glBindFramebufferEXT(GL_READ_FRAMEBUFFER_EXT, entry->fbo->fboid);
+			glBindFramebufferEXT(GL_DRAW_FRAMEBUFFER_EXT, 0);
+			glDrawBuffer(GL_BACK);
+			glBlitFramebufferEXT(0, 0, entry->fbo->width, entry->fbo->height, 0, 0, flipQueue->sysfbo->width, flipQueue->sysfbo->height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+			glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+
+			// Execute synchronous flip: dont_clear is always 2, as the drawBufferFBOs are owned by the masterthread,
+			// which performed the requested post-flip clear already when it enqueued this flip:
+			entry->vbl_timestamp = PsychFlipWindowBuffers(windowRecord, 0, entry->vbl_synclevel, 2, entry->flipwhen, &(entry->beamPosAtFlip), &(entry->miss_estimate), &(entry->time_at_flipend), &(entry->time_at_onset));
+
+			// The entry and its image buffer must be fully consumed before the masterthread may reuse them:
+			glFinish();
+
+			// Publish results, then mark entry as executed:
+			PsychFlipQueueMemoryBarrier();
+			flipQueue->tail++;
+			flipRequest->flipperState = 3;
+
+			// Reacquire the lock for the checks at the top of the loop:
+			PsychLockMutex(&(flipRequest->performFlipLock));
+		}
+		// Exit from flip queue dispatch loop.
+	}
+	else if (windowRecord->stereomode != kPsychFrameSequentialStereo) {
 		// Set our state as "initialized, ready & waiting":
 		flipRequest->flipperState = 1;
 
@@ -2157,6 +2296,108 @@ void* PsychFlipperThreadMain(void* windowRecordToCast)
 	return(NULL);
 }
 
+/* PsychCreateFlipperThread() -- Create and start the flipper thread of an onscreen window.
+ *
+ * Creates the mutex, condition variable and the flipper thread itself, boosts its priority and
+ * waits until the thread is initialized and ready. Returns with flipRequest->performFlipLock
+ * held by the calling masterthread.
+ */
+static void PsychCreateFlipperThread(PsychWindowRecordType *windowRecord)
+{
+	int rc;
+	PsychFlipInfoStruct* flipRequest = windowRecord->flipInfo;
+
+	// Create & Init the two mutexes:
+	if ((rc=PsychInitMutex(&(flipRequest->performFlipLock)))) {
+		printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): Could not create performFlipLock mutex lock [%s].\n", strerror(rc));
+		PsychErrorExitMsg(PsychError_system, "Insufficient system ressources for mutex creation as part of async flip setup!");
+	}
+	
+	if ((rc=PsychInitCondition(&(flipRequest->flipperGoGoGo), NULL))) {
+		printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): Could not create flipperGoGoGo condition variable [%s].\n", strerror(rc));
+		PsychErrorExitMsg(PsychError_system, "Insufficient system ressources for condition variable creation as part of async flip setup!");
+	}
+	
+	// Set initial thread state to "inactive, not initialized at all":
+	flipRequest->flipperState = 0;
+	
+	// Create and startup thread:
+	if ((rc=PsychCreateThread(&(flipRequest->flipperThread), NULL, PsychFlipperThreadMain, (void*) windowRecord))) {
+		printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): Could not create flipper  [%s].\n", strerror(rc));
+		PsychErrorExitMsg(PsychError_system, "Insufficient system ressources for mutex creation as part of async flip setup!");
+	}
+
+	// Additionally try to schedule flipperThread MMCSS: This will lift it roughly into the
+	// same scheduling range as HIGH_PRIORITY_CLASS, even if we are non-admin users
+	// on Vista and Windows-7 and later, however with a scheduler safety net applied.
+	// For some braindead reasons, apparently only one thread can be scheduled in class 10,
+	// so we need to make sure the masterthread is not MMCSS scheduled, otherwise our new
+	// request will fail:
+	if (PSYCH_SYSTEM == PSYCH_WINDOWS) {
+		// On Windows, we have to set flipperThread to +2 RT priority levels while
+		// throwing ourselves off RT priority scheduling. This is a brain-dead requirement
+		// of Vista et al's MMCSS scheduler which only allows one of our threads being
+		// scheduled like that :( -- Disable RT scheduling for ourselves (masterthread):
+		PsychSetThreadPriority((psych_thread*) 0x1, 0, 0);
+	}
+
+	// Boost priority of flipperThread by 2 levels and switch it to RT scheduling,
+	// unless it is already RT-Scheduled. As the thread inherited our scheduling
+	// priority from PsychCreateThread(), we only need to +2 tweak it from there:
+	// Note: On OS/X this means ultra-low latency non-preemptible operation (as we need), with up to
+	// 3 msecs uninterrupted computation time out of 10 msecs if we really need it. Normally we can
+	// get along with << 1 msec, but some pathetic cases of GPU driver bugs could drive it up to 3 msecs
+	// in the async flipper thread:
+	PsychSetThreadPriority(&(flipRequest->flipperThread), 10, 2);
+
+	// The thread is started with flipperState == 0, ie., not "initialized and ready", the lock is unlocked.
+	// First thing the thread will do is try to lock the lock, then set its flipperState to 1 == initialized and
+	// ready, then init itself, then enter a wait on our flipperGoGoGo condition variable and atomically unlock
+	// the lock.
+	// We now need to try to acquire the lock, then - after we got it - check if we got it because we were faster
+	// than the flipperThread and he didn't have a chance to get it (iff flipperState still == 0) - in which case
+	// we need to release the lock, wait a bit and then retry a lock->check->sleep->unlock->... cycle. If we got it
+	// because flipperState == 1 then this means the thread had the lock, initialized itself, set its state to ready
+	// and went sleeping and releasing the lock (that's why we could lock it). In that case, the thread is ready to
+	// do work for us and is just waiting for us. At that point we: a) Have the lock, b) can trigger the thread via
+	// condition variable to do work for us. That's the condition we want and we can proceed as in the non-firsttimeinit
+	// case...
+	while (TRUE) {
+		// Try to lock, block until available if not available:
+	
+		//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_LOCK\n"); fflush(NULL);
+
+		if ((rc=PsychLockMutex(&(flipRequest->performFlipLock)))) {
+			printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): First mutex_lock in init failed  [%s].\n", strerror(rc));
+			PsychErrorExitMsg(PsychError_system, "Internal error or deadlock avoided as part of async flip setup!");
+		}
+		
+		//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_LOCKED!\n"); fflush(NULL);
+
+		// Got it! Check condition:
+		if (flipRequest->flipperState == 1 || flipRequest->flipperState == 6) {
+			// Thread ready and we have the lock: Proceed...
+			break;
+		}
+
+		//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_UNLOCK\n"); fflush(NULL);
+
+		if ((rc=PsychUnlockMutex(&(flipRequest->performFlipLock)))) {
+			printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): First mutex_unlock in init failed  [%s].\n", strerror(rc));
+			PsychErrorExitMsg(PsychError_system, "Internal error or deadlock avoided as part of async flip setup!");
+		}
+
+		//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_UNLOCKED\n"); fflush(NULL);
+
+		// Thread not ready. Sleep a millisecond and repeat...
+		PsychYieldIntervalSeconds(0.001);
+
+		//printf("ENTERING THREADCREATEFINISHED MUTEX: RETRY\n"); fflush(NULL);
+	}
+
+	return;
+}
+
 /*	PsychFlipWindowBuffersIndirect()
  *
  *	This is a wrapper around PsychFlipWindowBuffers(); which gets all flip request parameters
@@ -2269,101 +2510,8 @@ psych_bool PsychFlipWindowBuffersIndirect(PsychWindowRecordType *windowRecord)
 
 		// First time async request? Threads already set up?
 		if (flipRequest->flipperThread == (psych_thread) NULL) {
-			// First time init: Need to startup flipper thread:
-
-			// printf("IN THREADCREATE\n"); fflush(NULL);
-
-			// Create & Init the two mutexes:
-			if ((rc=PsychInitMutex(&(flipRequest->performFlipLock)))) {
-				printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): Could not create performFlipLock mutex lock [%s].\n", strerror(rc));
-				PsychErrorExitMsg(PsychError_system, "Insufficient system ressources for mutex creation as part of async flip setup!");
-			}
-			
-			if ((rc=PsychInitCondition(&(flipRequest->flipperGoGoGo), NULL))) {
-				printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): Could not create flipperGoGoGo condition variable [%s].\n", strerror(rc));
-				PsychErrorExitMsg(PsychError_system, "Insufficient system ressources for condition variable creation as part of async flip setup!");
-			}
-			
-			// Set initial thread state to "inactive, not initialized at all":
-			flipRequest->flipperState = 0;
-			
-			// Create and startup thread:
-			if ((rc=PsychCreateThread(&(flipRequest->flipperThread), NULL, PsychFlipperThreadMain, (void*) windowRecord))) {
-				printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): Could not create flipper  [%s].\n", strerror(rc));
-				PsychErrorExitMsg(PsychError_system, "Insufficient system ressources for mutex creation as part of async flip setup!");
-			}
-
-			// Additionally try to schedule flipperThread MMCSS: This will lift it roughly into the
-			// same scheduling range as HIGH_PRIORITY_CLASS, even if we are non-admin users
-			// on Vista and Windows-7 and later, however with a scheduler safety net applied.
-			// For some braindead reasons, apparently only one thread can be scheduled in class 10,
-			// so we need to make sure the masterthread is not MMCSS scheduled, otherwise our new
-			// request will fail:
-			if (PSYCH_SYSTEM == PSYCH_WINDOWS) {
-				// On Windows, we have to set flipperThread to +2 RT priority levels while
-				// throwing ourselves off RT priority scheduling. This is a brain-dead requirement
-				// of Vista et al's MMCSS scheduler which only allows one of our threads being
-				// scheduled like that :( -- Disable RT scheduling for ourselves (masterthread):
-				PsychSetThreadPriority((psych_thread*) 0x1, 0, 0);
-			}
-
-			// Boost priority of flipperThread by 2 levels and switch it to RT scheduling,
-			// unless it is already RT-Scheduled. As the thread inherited our scheduling
-			// priority from PsychCreateThread(), we only need to +2 tweak it from there:
-			// Note: On OS/X this means ultra-low latency non-preemptible operation (as we need), with up to
-			// 3 msecs uninterrupted computation time out of 10 msecs if we really need it. Normally we can
-			// get along with << 1 msec, but some pathetic cases of GPU driver bugs could drive it up to 3 msecs
-			// in the async flipper thread:
-			PsychSetThreadPriority(&(flipRequest->flipperThread), 10, 2);
-
-			// The thread is started with flipperState == 0, ie., not "initialized and ready", the lock is unlocked.
-			// First thing the thread will do is try to lock the lock, then set its flipperState to 1 == initialized and
-			// ready, then init itself, then enter a wait on our flipperGoGoGo condition variable and atomically unlock
-			// the lock.
-			// We now need to try to acquire the lock, then - after we got it - check if we got it because we were faster
-			// than the flipperThread and he didn't have a chance to get it (iff flipperState still == 0) - in which case
-			// we need to release the lock, wait a bit and then retry a lock->check->sleep->unlock->... cycle. If we got it
-			// because flipperState == 1 then this means the thread had the lock, initialized itself, set its state to ready
-			// and went sleeping and releasing the lock (that's why we could lock it). In that case, the thread is ready to
-			// do work for us and is just waiting for us. At that point we: a) Have the lock, b) can trigger the thread via
-			// condition variable to do work for us. That's the condition we want and we can proceed as in the non-firsttimeinit
-			// case...
-			while (TRUE) {
-				// Try to lock, block until available if not available:
-			
-				//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_LOCK\n"); fflush(NULL);
-
-				if ((rc=PsychLockMutex(&(flipRequest->performFlipLock)))) {
-					printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): First mutex_lock in init failed  [%s].\n", strerror(rc));
-					PsychErrorExitMsg(PsychError_system, "Internal error or deadlock avoided as part of async flip setup!");
-				}
-				
-				//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_LOCKED!\n"); fflush(NULL);
-
-				// Got it! Check condition:
-				if (flipRequest->flipperState == 1 || flipRequest->flipperState == 6) {
-					// Thread ready and we have the lock: Proceed...
-					break;
-				}
-
-				//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_UNLOCK\n"); fflush(NULL);
-
-				if ((rc=PsychUnlockMutex(&(flipRequest->performFlipLock)))) {
-					printf("PTB-ERROR: In Screen('FlipAsyncBegin'): PsychFlipWindowBuffersIndirect(): First mutex_unlock in init failed  [%s].\n", strerror(rc));
-					PsychErrorExitMsg(PsychError_system, "Internal error or deadlock avoided as part of async flip setup!");
-				}
-
-				//printf("ENTERING THREADCREATEFINISHED MUTEX: MUTEX_UNLOCKED\n"); fflush(NULL);
-
-				// Thread not ready. Sleep a millisecond and repeat...
-				PsychYieldIntervalSeconds(0.001);
-
-				//printf("ENTERING THREADCREATEFINISHED MUTEX: RETRY\n"); fflush(NULL);
-			}
-
-			// End of first-time init for this windowRecord and its thread.
-
-			// printf("FIRST TIME INIT DONE\n"); fflush(NULL);
+			// First time init: Need to startup flipper thread. We hold the lock afterwards:
+			PsychCreateFlipperThread(windowRecord);
 		}
 		
 		// Our flipperThread is ready to do work for us (waiting on flipperGoGoGo condition variable) and
@@ -2514,6 +2662,587 @@ psych_bool PsychFlipWindowBuffersIndirect(PsychWindowRecordType *windowRecord)
 	return(TRUE);
 }
 
+/* PsychFlipWindowGroupIndirect() -- Execute the flip requests of a group of onscreen windows concurrently.
+ *
+ * Each of the 'count' windows in 'windowRecords' must have its flipInfo struct filled with an async flip
+ * request (opmode 1), no async flip pending and no flip queue. All windows are validated before any of them
+ * is touched. The flip of each window is executed by its own flipper
+ * thread, just as for Screen('AsyncFlipBegin'). Preflip operations and thread creation are done for all
+ * windows first, then all flipper threads are released back to back, so the bufferswaps of all windows are
+ * issued concurrently instead of one after the other. Then waits for completion of all flips, leaving each
+ * flipInfo struct with the results of its flip and an asyncstate of 2, as after Screen('AsyncFlipEnd').
+ */
+void PsychFlipWindowGroupIndirect(PsychWindowRecordType **windowRecords, int count)
+{
+	int i, rc;
+	PsychFlipInfoStruct* flipRequest;
+
+	// Validate all flip requests before touching any window, so an error doesn't leave some of them half prepared:
+	for (i = 0; i < count; i++) {
+		flipRequest = windowRecords[i]->flipInfo;
+		if ((flipRequest->opmode != 1) || (flipRequest->asyncstate != 0) || (flipRequest->flipQueue)) PsychErrorExitMsg(PsychError_internal, "Invalid flip request, flip still in progress or queued flips in PsychFlipWindowGroupIndirect()!");
+	}
+
+	// Phase 1: Preflip operations on the masterthread, as they are not thread-safe. Makes sure each flipper
+	// thread exists and waits for its trigger, with us holding its lock:
+	for (i = 0; i < count; i++) {
+		flipRequest = windowRecords[i]->flipInfo;
+		PsychPreFlipOperations(windowRecords[i], flipRequest->dont_clear);
+		windowRecords[i]->PipelineFlushDone = TRUE;
+		glFinish();
+
+		if (flipRequest->flipperThread == (psych_thread) NULL) PsychCreateFlipperThread(windowRecords[i]);
+
+		// Detach from the windows OpenGL context, as for Screen('AsyncFlipBegin'):
+		PsychSetDrawingTarget(NULL);
+		PsychOSUnsetGLContext(windowRecords[i]);
+	}
+
+	// Phase 2: Release all flipper threads:
+	for (i = 0; i < count; i++) {
+		flipRequest = windowRecords[i]->flipInfo;
+		asyncFlipOpsActive++;
+		flipRequest->flipperState = 1;
+
+		if ((rc=PsychSignalCondition(&(flipRequest->flipperGoGoGo)))) {
+			printf("PTB-ERROR: In Screen('FlipGroup'): PsychFlipWindowGroupIndirect(): pthread_cond_signal in trigger operation failed  [%s].\n", strerror(rc));
+			PsychErrorExitMsg(PsychError_internal, "This must not ever happen! PTB design bug or severe operating system or runtime environment malfunction!! Memory corruption?!?");
+		}
+
+		if ((rc=PsychUnlockMutex(&(flipRequest->performFlipLock)))) {
+			printf("PTB-ERROR: In Screen('FlipGroup'): PsychFlipWindowGroupIndirect(): mutex_unlock in trigger operation failed  [%s].\n", strerror(rc));
+			PsychErrorExitMsg(PsychError_internal, "This must not ever happen! PTB design bug or severe operating system or runtime environment malfunction!! Memory corruption?!?");
+		}
+
+		flipRequest->asyncstate = 1;
+	}
+
+	// Phase 3: Wait for completion of all flips:
+	for (i = 0; i < count; i++) {
+		windowRecords[i]->flipInfo->opmode = 2;
+		PsychFlipWindowBuffersIndirect(windowRecords[i]);
+	}
+
+	return;
+}
+
+/* PsychCollectQueuedFlips() -- Gather results of executed queued flips.
+ *
+ * Moves the results of all flips which the flipper thread has executed since the last call from
+ * the flip queue of onscreen window 'windowRecord' into the queues results buffer, thereby making
+ * their queue entries available for new flips. The most recent results are also stored in the
+ * flipInfo struct, so Screen('AsyncFlipCheckEnd') et al. can return them. If 'waitForAll' is TRUE,
+ * waits until all queued flips have been executed.
+ *
+ * Returns the number of queued flips which are still pending.
+ */
+int PsychCollectQueuedFlips(PsychWindowRecordType *windowRecord, psych_bool waitForAll)
+{
+	PsychFlipInfoStruct* flipRequest = windowRecord->flipInfo;
+	PsychFlipQueue* flipQueue = flipRequest->flipQueue;
+	PsychFlipQueueEntry* entry;
+	unsigned int tail;
+	double* row;
+
+	if (NULL == flipQueue) return(0);
+
+	while (TRUE) {
+		// Make sure we see the results written by the flipper thread before it advanced 'tail':
+		tail = flipQueue->tail;
+		PsychFlipQueueMemoryBarrier();
+
+		for (; flipQueue->collected != tail; flipQueue->collected++) {
+			entry = &(flipQueue->entries[flipQueue->collected % kPsychMaxFlipQueueDepth]);
+
+			// Grow results buffer if needed:
+			if (flipQueue->resultCount >= flipQueue->resultCapacity) {
+				flipQueue->resultCapacity = (flipQueue->resultCapacity > 0) ? flipQueue->resultCapacity * 2 : kPsychMaxFlipQueueDepth * 4;
+				flipQueue->results = (double*) realloc(flipQueue->results, (size_t) flipQueue->resultCapacity * kPsychFlipQueueResultColumns * sizeof(double));
+				if (NULL == flipQueue->results) {
+					flipQueue->resultCount = flipQueue->resultCapacity = 0;
+					PsychErrorExitMsg(PsychError_outofMemory, "Out of memory when trying to store results of queued flips!");
+				}
+			}
+
+			// Flip id, then the same values as returned by Screen('Flip'):
+			row = &(flipQueue->results[flipQueue->resultCount * kPsychFlipQueueResultColumns]);
+			row[0] = (double) (flipQueue->collected + 1);
+			row[1] = entry->vbl_timestamp;
+			row[2] = entry->time_at_onset;
+			row[3] = entry->time_at_flipend;
+			row[4] = entry->miss_estimate;
+			row[5] = (double) entry->beamPosAtFlip;
+			flipQueue->resultCount++;
+
+			flipRequest->vbl_timestamp = entry->vbl_timestamp;
+			flipRequest->time_at_onset = entry->time_at_onset;
+			flipRequest->time_at_flipend = entry->time_at_flipend;
+			flipRequest->miss_estimate = entry->miss_estimate;
+			flipRequest->beamPosAtFlip = entry->beamPosAtFlip;
+		}
+
+		if (!waitForAll || (tail == flipQueue->head)) break;
+
+		if (flipRequest->flipperState == 5) PsychErrorExitMsg(PsychError_system, "Flipper thread died while executing queued flips! Aborted.");
+
+		// Not yet finished. Sleep a millisecond and repeat...
+		PsychYieldIntervalSeconds(0.001);
+	}
+
+	return((int) (flipQueue->head - flipQueue->collected));
+}
+
+/* PsychEnqueueFlip() -- Queue a flip of onscreen window 'windowRecord' for execution by its flipper thread.
+ *
+ * This is the implementation of Screen('AsyncFlipEnqueue'): Runs the imaging pipeline to render
+ * the final stimulus image into a free entry of the windows flip queue instead of into the system
+ * backbuffer, then hands the entry over to the flipper thread, which shows the image at the first
+ * vertical retrace after 'flipwhen', with 'vbl_synclevel' as in PsychFlipWindowBuffers(). Finally
+ * the drawBufferFBOs are prepared for drawing of the next stimulus according to 'dont_clear', just
+ * as after a regular flip, so usercode can continue drawing the next frames immediately.
+ *
+ * The queue is a lock-free single producer, single consumer ring of kPsychMaxFlipQueueDepth entries,
+ * each with its own parameters, result slot and image buffer. The flipper thread executes queued
+ * flips back to back and only sleeps while the queue is empty. The queue and thread are created at
+ * the first queued flip on a window. If the queue is full, we wait until the oldest flip is done.
+ *
+ * Returns the id of the queued flip, ie. the count of flips queued so far on the window.
+ */
+unsigned int PsychEnqueueFlip(PsychWindowRecordType *windowRecord, int dont_clear, int vbl_synclevel, double flipwhen)
+{
+	PsychFlipInfoStruct* flipRequest = windowRecord->flipInfo;
+	PsychFlipQueue* flipQueue = flipRequest->flipQueue;
+	PsychFlipQueueEntry* entry;
+	GLint redbits;
+	int rc;
+
+	if (NULL == flipQueue) {
+		// First queued flip on this window: Check if its configuration allows for flip queueing. The final
+		// stimulus image must be a single image which the imaging pipeline would write into the backbuffer:
+		if (windowRecord->imagingMode == 0 || windowRecord->imagingMode == kPsychNeedFastOffscreenWindows) {
+			PsychErrorExitMsg(PsychError_user, "Queued flips need the imaging pipeline to be enabled. See 'help PsychImaging' on how to enable it.");
+		}
+
+		if ((windowRecord->stereomode == kPsychOpenGLStereo) || (windowRecord->stereomode == kPsychFrameSequentialStereo) || (windowRecord->stereomode == kPsychDualWindowStereo) ||
+			(windowRecord->imagingMode & kPsychNeedDualWindowOutput) || (windowRecord->fboTable[windowRecord->finalizedFBO[0]]->fboid != 0)) {
+			PsychErrorExitMsg(PsychError_user, "Queued flips are not supported in quad-buffered, frame-sequential or dual-window stereo modes, or with dual-window output.");
+		}
+
+		if (!(windowRecord->gfxcaps & kPsychGfxCapFBOBlit)) {
+			PsychErrorExitMsg(PsychError_user, "Queued flips need support for EXT_framebuffer_blit, which your graphics hardware or driver does not provide.");
+		}
+
+		if (PsychPrefStateGet_ConserveVRAM() & kPsychUseOldStyleAsyncFlips) {
+			PsychErrorExitMsg(PsychError_user, "Tried to queue flips while Screen('Preference', 'ConserveVRAM') setting kPsychUseOldStyleAsyncFlips is set! Forbidden!");
+		}
+
+		// The flipper thread runs in exactly one mode during its lifetime:
+		if (flipRequest->flipperThread) {
+			PsychErrorExitMsg(PsychError_user, "Tried to queue flips on a window which already used Screen('AsyncFlipBegin')! Mixing both is forbidden.");
+		}
+
+		flipQueue = (PsychFlipQueue*) calloc(1, sizeof(PsychFlipQueue));
+		if (NULL == flipQueue) PsychErrorExitMsg(PsychError_outofMemory, "Out of memory when trying to allocate flip queue!");
+
+		// Image buffers have the same format as a finalizedFBO which isn't the backbuffer: RGBA8, unless the
+		// backbuffer has a higher bit depth. See PsychInitImagingPipeline():
+		PsychSetDrawingTarget(NULL);
+		PsychSetGLContext(windowRecord);
+		glGetIntegerv(GL_RED_BITS, &redbits);
+		flipQueue->fboFormat = (redbits <= 8) ? GL_RGBA8 : ((windowRecord->gfxcaps & kPsychGfxCapFPFBO32) ? GL_RGBA_FLOAT32_APPLE : GL_RGBA16_SNORM);
+		flipQueue->sysfbo = windowRecord->fboTable[windowRecord->finalizedFBO[0]];
+		flipRequest->flipQueue = flipQueue;
+
+		// Startup flipper thread in flip queue mode. It doesn't need the lock for executing flips:
+		PsychCreateFlipperThread(windowRecord);
+		if ((rc=PsychUnlockMutex(&(flipRequest->performFlipLock)))) {
+			printf("PTB-ERROR: In Screen('AsyncFlipEnqueue'): PsychEnqueueFlip(): mutex_unlock in init failed  [%s].\n", strerror(rc));
+			PsychErrorExitMsg(PsychError_system, "Internal error or deadlock avoided as part of flip queue setup!");
+		}
+	}
+
+	// Gather results of executed flips, wait for a free entry if the queue is full:
+	while (PsychCollectQueuedFlips(windowRecord, FALSE) >= kPsychMaxFlipQueueDepth) {
+		if (flipRequest->flipperState == 5) PsychErrorExitMsg(PsychError_system, "Flipper thread died while executing queued flips! Aborted.");
+		PsychYieldIntervalSeconds(0.001);
+	}
+
+	entry = &(flipQueue->entries[flipQueue->head % kPsychMaxFlipQueueDepth]);
+
+	PsychSetGLContext(windowRecord);
+
+	// Allocate image buffer of the entry on its first use:
+	if (NULL == entry->fbo) {
+		if (!PsychCreateFBO(&(entry->fbo), flipQueue->fboFormat, FALSE, flipQueue->sysfbo->width, flipQueue->sysfbo->height, 0)) {
+			free(entry->fbo);
+			entry->fbo = NULL;
+			PsychErrorExitMsg(PsychError_system, "Could not create image buffer for a queued flip! Out of video memory?");
+		}
+	}
+
+	// Perform preflip operations with the image buffer of the entry as final target of the imaging
+	// pipeline, instead of the system backbuffer. This redirects all stages which would target the
+	// backbuffer, as they all reference it via the same fboTable slot:
+	windowRecord->fboTable[windowRecord->finalizedFBO[0]] = entry->fbo;
+	PsychPreFlipOperations(windowRecord, dont_clear);
+	windowRecord->fboTable[windowRecord->finalizedFBO[0]] = flipQueue->sysfbo;
+
+	// The flipper thread must not read the image before the GPU has finished rendering it. Use a
+	// fence if supported, so we don't stall, otherwise finish rendering right here:
+	if (glFenceSync) {
+		entry->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		glFlush();
+	}
+	else {
+		glFinish();
+	}
+
+	entry->vbl_synclevel = vbl_synclevel;
+	entry->flipwhen = flipwhen;
+	entry->vbl_timestamp = -1;
+
+	// Publish the entry to the flipper thread:
+	PsychFlipQueueMemoryBarrier();
+	flipQueue->head++;
+
+	// Wakeup the flipper thread in case it sleeps on an empty queue:
+	PsychLockMutex(&(flipRequest->performFlipLock));
+	PsychSignalCondition(&(flipRequest->flipperGoGoGo));
+	PsychUnlockMutex(&(flipRequest->performFlipLock));
+
+	// Prepare the drawBufferFBOs for drawing the next stimulus, as a regular flip would do after
+	// the bufferswap. This never touches the system framebuffer owned by the flipper thread now:
+	PsychPostFlipOperations(windowRecord, dont_clear);
+
+	// Reset flags used for avoiding redundant Pipeline flushes and backbuffer-backups:
+	windowRecord->PipelineFlushDone = false;
+	windowRecord->backBufferBackupDone = false;
+
+	// Call hookchain with callbacks to be performed after flip: For queued flips this happens at
+	// queueing time, not at the - much later - completion time of the flip:
+	PsychPipelineExecuteHook(windowRecord, kPsychScreenFlipImpliedOperations, NULL, NULL, FALSE, FALSE, NULL, NULL, NULL, NULL);
+
+	return(flipQueue->head);
+}
+
+// Number of samples over which the fits of the flip timing model are averaged, and the number
+// of refresh cycles over which the refresh duration is averaged:
+#define kPsychTimingModelWindow 32
+#define kPsychTimingModelRefreshWindow 600
+
+/*
+ * PsychTimingModelFit() - Exponentially weighted update of running mean and variance by sample 'x' with weight 'alpha'.
+ */
+static void PsychTimingModelFit(double* mean, double* var, double x, double alpha)
+{
+	double delta = x - *mean;
+	*mean += alpha * delta;
+	*var = (1.0 - alpha) * (*var + alpha * delta * delta);
+}
+
+/*
+ * PsychUpdateFlipTimingModel() - Fit the presentation timing model of an onscreen window to a completed flip.
+ *
+ * Called by PsychFlipWindowBuffers() after timestamping of a flip. 'msc' is the vblank count of swap completion,
+ * as reported by the OS, or -1 if unknown. 'tOnset' is the final swap completion timestamp, 'tCompletion' the raw
+ * timestamp when completion was detected, 'submitTime' the time spent in Flip before swap submission.
+ */
+static void PsychUpdateFlipTimingModel(PsychWindowRecordType *windowRecord, psych_int64 msc, double tOnset, double tCompletion, double submitTime)
+{
+	PsychFlipTimingModel *model = &(windowRecord->timingModel);
+	double frames = 0, duration;
+
+	if (tOnset <= 0) return;
+
+	if (model->nrSamples == 0) {
+		// First sample: Start with the refresh duration measured at window creation time:
+		model->refreshDuration = windowRecord->VideoRefreshInterval;
+		model->refreshVar = 0;
+		model->refreshFrames = 0;
+	}
+	else if (model->refTime > 0) {
+		// Number of refresh cycles since the previous swap: Exact if the OS reports vblank counts for both swaps,
+		// otherwise estimated from elapsed time, which is only trustworthy over a few refresh cycles:
+		if ((msc >= 0) && model->mscValid) {
+			frames = (double) (msc - model->refMsc);
+			if (frames > 3600) frames = 0;
+		}
+		else {
+			frames = floor((tOnset - model->refTime) / model->refreshDuration + 0.5);
+			if (frames > 20) frames = 0;
+		}
+
+		if (frames >= 1) {
+			duration = (tOnset - model->refTime) / frames;
+			if (fabs(duration - model->refreshDuration) < 0.1 * model->refreshDuration) {
+				// Plausible: Each sample counts with the number of refresh cycles it spans:
+				PsychTimingModelFit(&model->refreshDuration, &model->refreshVar, duration, frames / (frames + ((model->refreshFrames < kPsychTimingModelRefreshWindow) ? model->refreshFrames : kPsychTimingModelRefreshWindow)));
+				model->refreshFrames += frames;
+				model->nrRejected = 0;
+			}
+			else if ((++model->nrRejected > 10) && (msc >= 0) && model->mscValid) {
+				// Persistent mismatch, e.g., after a video mode change. Restart fit from the exactly known duration:
+				model->refreshDuration = duration;
+				model->refreshVar = 0;
+				model->refreshFrames = frames;
+				model->nrRejected = 0;
+			}
+		}
+	}
+
+	// Latency between swap completion and its detection by Flip, as long as it is plausible:
+	if ((tCompletion >= tOnset) && (tCompletion - tOnset < model->refreshDuration)) {
+		PsychTimingModelFit(&model->swapLatency, &model->swapLatencyVar, tCompletion - tOnset, 1.0 / ((model->nrSamples < kPsychTimingModelWindow) ? model->nrSamples + 1 : kPsychTimingModelWindow));
+	}
+
+	PsychTimingModelFit(&model->submitTime, &model->submitTimeVar, submitTime, 1.0 / ((model->nrSamples < kPsychTimingModelWindow) ? model->nrSamples + 1 : kPsychTimingModelWindow));
+
+	// Reanchor the model at this swap:
+	model->refMsc = (msc >= 0) ? msc : ((model->refTime > 0) ? model->refMsc + (psych_int64) frames : 0);
+	model->mscValid = (msc >= 0) ? TRUE : FALSE;
+	model->refTime = tOnset;
+	model->nrSamples++;
+
+	return;
+}
+
+/*
+ * PsychTimingModelGPUQuery() - Measure GPU time of the preflip operations of the imaging pipeline for the flip timing model.
+ *
+ * Called by PsychPreFlipOperations() on the masterthread, with 'start' TRUE before and FALSE after the preflip operations.
+ * Collects the result of a previous measurement if it is available, and only starts a new measurement if no measurement is
+ * pending and no GPU rendertime query of Screen('GetWindowInfo') is in progress, as GL_TIME_ELAPSED_EXT queries can't nest.
+ */
+static void PsychTimingModelGPUQuery(PsychWindowRecordType *windowRecord, psych_bool start)
+{
+	PsychFlipTimingModel *model = &(windowRecord->timingModel);
+	GLuint gpuTimeElapsed;
+
+	if (!model->active || (model->gpuQueryState < 0) || (windowRecord->imagingMode == 0) || (windowRecord->gpuRenderTimeQuery)) return;
+
+	// End a running measurement. At start, such a measurement was left running by an error abort of the preflip operations:
+	if (model->gpuQueryState == 1) {
+		glEndQuery(GL_TIME_ELAPSED_EXT);
+		model->gpuQueryState = 2;
+	}
+
+	if (!start) return;
+
+	if (model->gpuQueryState == 2) {
+		// Measurement pending: Collect its result if it is available, without stalling the pipeline:
+		gpuTimeElapsed = 0;
+		glGetQueryObjectuiv(model->gpuQuery, GL_QUERY_RESULT_AVAILABLE, &gpuTimeElapsed);
+		if (gpuTimeElapsed == 0) return;
+
+		glGetQueryObjectuiv(model->gpuQuery, GL_QUERY_RESULT, &gpuTimeElapsed);
+		PsychTimingModelFit(&model->gpuRenderTime, &model->gpuRenderTimeVar, (double) gpuTimeElapsed / (double) 1e9, 1.0 / ((model->nrGPUSamples < kPsychTimingModelWindow) ? model->nrGPUSamples + 1 : kPsychTimingModelWindow));
+		model->nrGPUSamples++;
+		model->gpuQueryState = 0;
+	}
+
+	if (model->gpuQuery == 0) {
+		if (!glewIsSupported("GL_EXT_timer_query")) {
+			// Unsupported: Don't try again.
+			model->gpuQueryState = -1;
+			return;
+		}
+		glGenQueries(1, &model->gpuQuery);
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED_EXT, model->gpuQuery);
+	model->gpuQueryState = 1;
+
+	return;
+}
+
+/*
+ * PsychPredictFlipOnset() - Predict earliest achievable stimulus onset from the flip timing model.
+ *
+ * Predicts the onset of a frame submitted for flip now, with a deadline 'tWhen' as in PsychFlipWindowBuffers().
+ * If 'submitted' is TRUE, the preflip operations are already done and don't add to the time until the frame is
+ * ready for swap. Returns the predicted time 'tReady' when the frame is ready for swap, the time 'tOnset' and
+ * vblank count 'onsetMsc' of onset (-1 if vblank counts are unknown), and the time 'tFlipEnd' when Flip would
+ * detect completion of the swap. Returns FALSE if the model isn't ready for predictions yet.
+ */
+psych_bool PsychPredictFlipOnset(PsychWindowRecordType *windowRecord, double tWhen, psych_bool submitted, double* tReady, double* tOnset, psych_int64* onsetMsc, double* tFlipEnd)
+{
+	PsychFlipTimingModel *model = &(windowRecord->timingModel);
+	double tNow, frames;
+
+	if ((model->nrSamples < 2) || (model->refTime <= 0)) return(FALSE);
+
+	// Frame is ready for swap after the remaining work, with a margin of three standard deviations:
+	PsychGetAdjustedPrecisionTimerSeconds(&tNow);
+	*tReady = tNow + model->gpuRenderTime + 3 * sqrt(model->gpuRenderTimeVar);
+	if (!submitted) *tReady += model->submitTime + 3 * sqrt(model->submitTimeVar);
+
+	// Onset at the first vblank after both the ready time and the deadline:
+	frames = floor((((*tReady > tWhen) ? *tReady : tWhen) - model->refTime) / model->refreshDuration) + 1;
+	if (frames < 1) frames = 1;
+
+	*tOnset = model->refTime + frames * model->refreshDuration;
+	*onsetMsc = (model->mscValid) ? model->refMsc + (psych_int64) frames : -1;
+	*tFlipEnd = *tOnset + model->swapLatency;
+
+	return(TRUE);
+}
+
+/*
+ * PsychSwapLogAppend() - Append a record of a completed swap to the swap log of an onscreen window.
+ *
+ * Called by PsychFlipWindowBuffers() at the end of each flip, from whichever thread executes the flip.
+ * Columns of a record are: Flip count, type of flip request (0 = Screen('Flip'), 1 = async flip,
+ * 2 = queued flip), flipId of a queued flip or zero, target time 'when', vblank timestamp, stimulus
+ * onset, end of flip, miss_estimate, beamposition, msc, ust and sbc of swap completion or -1 if unknown.
+ */
+static void PsychSwapLogAppend(PsychWindowRecordType *windowRecord, double flipwhen, double time_at_vbl, double time_at_onset, double time_at_flipend,
+							   double miss_estimate, int beamPosAtFlip, psych_int64 msc, psych_int64 ust, psych_int64 sbc)
+{
+	PsychSwapLog *swapLog = windowRecord->swapLog;
+	double *record;
+	unsigned int head = swapLog->head;
+
+	// Log full? Then drop this record:
+	if (head - swapLog->tail >= swapLog->capacity) {
+		swapLog->dropped++;
+		return;
+	}
+
+	record = &(swapLog->records[(head % swapLog->capacity) * kPsychSwapLogColumns]);
+	record[0] = (double) windowRecord->flipCount;
+	if (PsychIsMasterThread()) {
+		record[1] = 0;
+		record[2] = 0;
+	}
+	else if (windowRecord->flipInfo->flipQueue) {
+		// The executing queued flip is the one after the 'tail' already executed ones:
+		record[1] = 2;
+		record[2] = (double) (windowRecord->flipInfo->flipQueue->tail + 1);
+	}
+	else {
+		record[1] = 1;
+		record[2] = 0;
+	}
+	record[3] = flipwhen;
+	record[4] = time_at_vbl;
+	record[5] = time_at_onset;
+	record[6] = time_at_flipend;
+	record[7] = miss_estimate;
+	record[8] = (double) beamPosAtFlip;
+	record[9] = (double) msc;
+	record[10] = (double) ust;
+	record[11] = (double) sbc;
+
+	// Publish the record only after it is completely written:
+	PsychFlipQueueMemoryBarrier();
+	swapLog->head = head + 1;
+
+	return;
+}
+
+/*
+ * PsychSwapLogSetup() - Enable or disable logging of completed swaps of an onscreen window.
+ *
+ * Enabling allocates the log for 'capacity' records, or for one hour of flips at the video refresh rate if
+ * 'capacity' is zero. The log is only reallocated if its capacity changes, which is only possible while no
+ * async or queued flips are pending. Disabling keeps the log and its unfetched records.
+ */
+void PsychSwapLogSetup(PsychWindowRecordType *windowRecord, psych_bool enable, unsigned int capacity)
+{
+	PsychSwapLog *swapLog = windowRecord->swapLog;
+
+	if (!enable) {
+		if (swapLog) swapLog->enabled = FALSE;
+		return;
+	}
+
+	if (capacity == 0) capacity = (unsigned int) ceil(3600.0 / windowRecord->VideoRefreshInterval);
+
+	if (swapLog == NULL) {
+		swapLog = (PsychSwapLog*) calloc(1, sizeof(PsychSwapLog));
+		if (swapLog == NULL) PsychErrorExitMsg(PsychError_outofMemory, "Out of memory when trying to allocate the swap log!");
+		windowRecord->swapLog = swapLog;
+	}
+
+	if (swapLog->capacity != capacity) {
+		if (windowRecord->flipInfo && ((windowRecord->flipInfo->asyncstate != 0) ||
+			(windowRecord->flipInfo->flipQueue && (windowRecord->flipInfo->flipQueue->head != windowRecord->flipInfo->flipQueue->tail)))) {
+			PsychErrorExitMsg(PsychError_user, "Tried to change the capacity of the swap log while async flips are pending! Finalize them first.");
+		}
+
+		free(swapLog->records);
+		swapLog->records = NULL;
+		swapLog->capacity = 0;
+		swapLog->head = swapLog->tail = swapLog->dropped = swapLog->droppedFetched = 0;
+
+		swapLog->records = (double*) malloc(sizeof(double) * kPsychSwapLogColumns * capacity);
+		if (swapLog->records == NULL) PsychErrorExitMsg(PsychError_outofMemory, "Out of memory when trying to allocate the swap log! Use a smaller capacity.");
+		swapLog->capacity = capacity;
+	}
+
+	PsychFlipQueueMemoryBarrier();
+	swapLog->enabled = TRUE;
+
+	return;
+}
+
+/*
+ * PsychSwapLogPending() - Return number of records in the swap log of an onscreen window which are not yet fetched.
+ */
+unsigned int PsychSwapLogPending(PsychWindowRecordType *windowRecord)
+{
+	if ((windowRecord->swapLog == NULL) || (windowRecord->swapLog->capacity == 0)) return(0);
+	return(windowRecord->swapLog->head - windowRecord->swapLog->tail);
+}
+
+/*
+ * PsychSwapLogFetch() - Fetch the 'n' oldest records from the swap log of an onscreen window.
+ *
+ * 'n' must not exceed the count returned by a preceding PsychSwapLogPending(). The records are returned in
+ * 'records' as a column-major n x kPsychSwapLogColumns matrix, ie., one column per value. Returns the number
+ * of records dropped due to a full log since the previous fetch.
+ */
+unsigned int PsychSwapLogFetch(PsychWindowRecordType *windowRecord, double* records, unsigned int n)
+{
+	PsychSwapLog *swapLog = windowRecord->swapLog;
+	unsigned int tail, i, j, dropped;
+	double *record;
+
+	if ((swapLog == NULL) || (swapLog->capacity == 0)) return(0);
+
+	// Only read the records after reading the 'head' which published them in PsychSwapLogPending():
+	PsychFlipQueueMemoryBarrier();
+	tail = swapLog->tail;
+
+	for (i = 0; i < n; i++) {
+		record = &(swapLog->records[((tail + i) % swapLog->capacity) * kPsychSwapLogColumns]);
+		for (j = 0; j < kPsychSwapLogColumns; j++) records[j * n + i] = record[j];
+	}
+
+	dropped = swapLog->dropped - swapLog->droppedFetched;
+	swapLog->droppedFetched += dropped;
+
+	// Release the fetched records for reuse by the flipping thread:
+	PsychFlipQueueMemoryBarrier();
+	swapLog->tail = tail + n;
+
+	return(dropped);
+}
+
+/*
+ * PsychSwapLogRelease() - Release the swap log of an onscreen window. Must only be called after the flipper thread has terminated.
+ */
+void PsychSwapLogRelease(PsychWindowRecordType *windowRecord)
+{
+	if (windowRecord->swapLog == NULL) return;
+
+	free(windowRecord->swapLog->records);
+	free(windowRecord->swapLog);
+	windowRecord->swapLog = NULL;
+
+	return;
+}
+
 #if PSYCH_SYSTEM == PSYCH_WINDOWS
 #undef strerror
 #endif
@@ -2611,6 +3340,13 @@ double PsychFlipWindowBuffers(PsychWindowRecordType *windowRecord, int multiflip
 	double targetWhen;			// Target time for OS-Builtin swap scheduling.
 	double tSwapComplete;		// Swap completion timestamp for OS-Builtin timestamping.
 	psych_int64 swap_msc;		// Swap completion vblank count for OS-Builtin timestamping.
+	psych_int64 targetMSC;		// Target vblank count for swap scheduling by the flip timing model, zero if unused.
+	psych_int64 deadlineMSC;
+	psych_int64 onsetMSC = -1;	// Vblank count of swap completion for the flip timing model and swap log, -1 if unknown.
+	psych_int64 onsetUST = -1;	// Raw OpenML ust and sbc of swap completion for the swap log, -1 if unknown.
+	psych_int64 onsetSBC = -1;
+	double tflipstart;			// Time of entry into this function, for the flip timing model.
+	double tready, tpredicted_onset, tpredicted_flipend;
 
     int vbltimestampmode = PsychPrefStateGet_VBLTimestampingMode();
     PsychWindowRecordType **windowRecordArray=NULL;
@@ -2630,6 +3366,8 @@ double PsychFlipWindowBuffers(PsychWindowRecordType *windowRecord, int multiflip
     if(windowRecord->windowType!=kPsychDoubleBufferOnscreen)
         PsychErrorExitMsg(PsychError_internal,"Attempt to swap a single window buffer");
     
+    PsychGetAdjustedPrecisionTimerSeconds(&tflipstart);
+
     // Retrieve estimate of interframe flip-interval:
     if (windowRecord->nrIFISamples > 0) {
         currentflipestimate=windowRecord->IFIRunningSum / ((double) windowRecord->nrIFISamples);
@@ -2827,8 +3565,24 @@ double PsychFlipWindowBuffers(PsychWindowRecordType *windowRecord, int multiflip
 	// any of the involved commands fail:
 	osspecific_asyncflip_scheduled = TRUE;
 
+	// Schedule by target MSC instead of target time requested? Only for flips with deadline on single windows, as
+	// vblank counts of slave windows or other windows of a multiflip are unrelated to the ones of our window:
+	if (windowRecord->timingModel.scheduleByMsc && (flipwhen > 0) && (multiflip == 0) && (windowRecord->slaveWindow == NULL) &&
+		PsychPredictFlipOnset(windowRecord, flipwhen, TRUE, &tready, &tpredicted_onset, &targetMSC, &tpredicted_flipend) && (targetMSC > 0)) {
+		// Vblank which would meet the deadline, if the frame would be ready in time:
+		deadlineMSC = windowRecord->timingModel.refMsc + (psych_int64) floor((flipwhen - windowRecord->timingModel.refTime) / windowRecord->timingModel.refreshDuration) + 1;
+		if (targetMSC > deadlineMSC) {
+			// Frame won't be ready in time for the deadline. Target the earliest achievable vblank instead:
+			windowRecord->timingModel.nrPredictedMisses++;
+			if (verbosity > 5) printf("PTB-DEBUG: Flip timing model predicts deadline miss: Frame ready at %f secs, deadline %f secs. Targeting msc %lld instead of %lld.\n", tready, flipwhen, targetMSC, deadlineMSC);
+		}
+	}
+	else {
+		targetMSC = 0;
+	}
+
 	// Schedule swap on main window:
-	if ((swap_msc = PsychOSScheduleFlipWindowBuffers(windowRecord, targetWhen, 0, 0, 0, targetSwapFlags)) < 0) {
+	if ((swap_msc = PsychOSScheduleFlipWindowBuffers(windowRecord, targetWhen, targetMSC, 0, 0, targetSwapFlags)) < 0) {
 		// Scheduling failed or unsupported!
 		if ((swap_msc < -1) && (verbosity > 1)) printf("PTB-WARNING: PsychOSScheduleFlipWindowBuffers() FAILED: errorcode = %i, targetWhen = %f, targetSwapFlags = %i.\n", (int) swap_msc, (float) targetWhen, (int) targetSwapFlags);
 		
@@ -3619,6 +4373,22 @@ double PsychFlipWindowBuffers(PsychWindowRecordType *windowRecord, int multiflip
 		
 		// Store optional OS-Builtin swap timestamp as well:
 		windowRecord->osbuiltin_swaptime = tSwapComplete;
+
+		// Vblank count of the swap is either the one reported by OS-Builtin timestamping, or the one of the
+		// VBL-IRQ timestamp after the swap, if that timestamp belongs to the swap:
+		if ((vbltimestampmode == 4) && (swap_msc >= 0)) {
+			onsetMSC = swap_msc;
+			onsetUST = windowRecord->reference_ust;
+			onsetSBC = windowRecord->reference_sbc;
+		}
+		else {
+			onsetMSC = ((postflip_vbltimestamp > 0) && (fabs(postflip_vbltimestamp - time_at_vbl) < 0.25 * currentrefreshestimate)) ? (psych_int64) postflip_vblcount : -1;
+		}
+
+		// Fit the flip timing model to this flip:
+		if (windowRecord->stereomode != kPsychFrameSequentialStereo) {
+			PsychUpdateFlipTimingModel(windowRecord, onsetMSC, time_at_vbl, time_at_swapcompletion, tprescheduleswap - tflipstart);
+		}
     }
     else {
         // syncing to vbl is disabled, time_at_vbl becomes meaningless, so we set it to a
@@ -3632,6 +4402,9 @@ double PsychFlipWindowBuffers(PsychWindowRecordType *windowRecord, int multiflip
         windowRecord->rawtime_at_swapcompletion = 0;
         windowRecord->postflip_vbltimestamp = -1;
         windowRecord->osbuiltin_swaptime = 0;
+
+        // No onset timestamp the flip timing model could be anchored to:
+        windowRecord->timingModel.refTime = 0;
     }
 
 	// Increment the "flips successfully completed" counter:
@@ -3721,6 +4494,11 @@ double PsychFlipWindowBuffers(PsychWindowRecordType *windowRecord, int multiflip
 
     // We take a second timestamp here to mark the end of the Flip-routine and return it to "userspace"
     PsychGetAdjustedPrecisionTimerSeconds(time_at_flipend);
+
+    // Log this swap if requested:
+    if (windowRecord->swapLog && windowRecord->swapLog->enabled) {
+        PsychSwapLogAppend(windowRecord, flipwhen, time_at_vbl, *time_at_onset, *time_at_flipend, (sync_to_vbl) ? *miss_estimate : 0, *beamPosAtFlip, onsetMSC, onsetUST, onsetSBC);
+    }
     
     // Done. Return high resolution system time in seconds when VBL happened.
     return(time_at_vbl);
@@ -4278,6 +5056,9 @@ void PsychPreFlipOperations(PsychWindowRecordType *windowRecord, int clearmode)
     if (windowRecord->flipInfo->asyncstate > 0) {
         PsychErrorExitMsg(PsychError_internal, "PsychPreFlipOperations() called on onscreen window with pending async flip?!? Forbidden!");
     }
+
+    // Start GPU time measurement of the preflip operations for the flip timing model, if enabled:
+    PsychTimingModelGPUQuery(windowRecord, TRUE);
     
     // Disable any shaders:
     PsychSetShader(windowRecord, 0);
@@ -4623,6 +5404,8 @@ void PsychPreFlipOperations(PsychWindowRecordType *windowRecord, int clearmode)
     // unlucky name. It actually signals that all the preflip processing has been done, the old name is historical.
     windowRecord->backBufferBackupDone = true;
 
+    PsychTimingModelGPUQuery(windowRecord, FALSE);
+
     // End time measurement for any previously submitted rendering commands if a
     // GPU rendertime query was requested (See Screen('GetWindowInfo', ..); for infoType 5.
     if (windowRecord->gpuRenderTimeQuery) {
@@ -5367,6 +6150,8 @@ psych_bool PsychIsUserspaceRendering(void)
 
 int PsychRessourceCheckAndReminder(psych_bool displayMessage) {
 	int i,j = 0;
+	int poolCount, poolHits, poolMisses, poolEvictions;
+	double poolBytes;
 
 	#if PSYCH_SYSTEM != PSYCH_LINUX
 	// Check for open movies:
@@ -5400,6 +6185,18 @@ int PsychRessourceCheckAndReminder(psych_bool displayMessage) {
 		printf("PTB-INFO: crashes. Please check your code. (Screen('Close') is a quick way to release all textures and offscreen windows)\n\n");
 	}
 	
+	// Report FBO pool usage:
+	PsychFBOPoolGetStats(&poolCount, &poolBytes, &poolHits, &poolMisses, &poolEvictions);
+	if (displayMessage && (PsychPrefStateGet_Verbosity() > 3) && (poolHits + poolMisses > 0)) {
+		printf("PTB-INFO: FBO pool for offscreen windows and textures: %i framebuffers with %f MB of VRAM pooled. %i recycled, %i newly created, %i evicted.\n",
+			   poolCount, (float) (poolBytes / 1024 / 1024), poolHits, poolMisses, poolEvictions);
+	}
+
+	// Report textures whose PBO upload was never retired by drawing or preloading them:
+	if (displayMessage && (PsychPrefStateGet_Verbosity() > 3) && (PsychGetNumPendingTextureUploads() > 0)) {
+		printf("PTB-INFO: %i textures with PBO uploads were never drawn or preloaded.\n", PsychGetNumPendingTextureUploads());
+	}
+
 	// Return total sum of open ressource hogs ;-)
 	return(i + j);
 }
@@ -5466,6 +6263,10 @@ int PsychSetShader(PsychWindowRecordType *windowRecord, int shader)
 	return(shader);
 }
 
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
 /* PsychDetectAndAssignGfxCapabilities()
  *
  * This routine must be called with the OpenGL context of the given 'windowRecord' active,
@@ -5488,6 +6289,7 @@ void PsychDetectAndAssignGfxCapabilities(PsychWindowRecordType *windowRecord)
 	psych_bool ati = FALSE;
 	GLint maxtexsize=0, maxcolattachments=0, maxaluinst=0;
 	GLboolean nativeStereo = FALSE;
+	GLint numBinaryFormats = 0;
 
 	// Init Id string for GPU core to zero. This has at most 8 Bytes, including 0-terminator,
 	// so use at most 7 letters!
@@ -5668,6 +6470,17 @@ void PsychDetectAndAssignGfxCapabilities(PsychWindowRecordType *windowRecord)
 		windowRecord->gfxcaps |= kPsychGfxCapNativeStereo;
 	}
 
+	// Retrievable GLSL program binaries for the program binary cache of PsychCreateGLSLProgram()? Some drivers
+	// expose the extension, but support zero binary formats, which makes it useless:
+	if (strstr((char*) glGetString(GL_EXTENSIONS), "GL_ARB_get_program_binary")) {
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+		while (glGetError());
+		if (numBinaryFormats > 0) {
+			if (verbose) printf("Hardware supports retrieval of GLSL program binaries.\n");
+			windowRecord->gfxcaps |= kPsychGfxCapProgramBinary;
+		}
+	}
+
 	// Running under Chromium OpenGL virtualization or Mesa Software Rasterizer?
 	if ((strstr((char*) glGetString(GL_VENDOR), "Humper") && strstr((char*) glGetString(GL_RENDERER), "Chromium")) ||
         (strstr((char*) glGetString(GL_VENDOR), "Mesa") && strstr((char*) glGetString(GL_RENDERER), "Software Rasterizer"))) {
@@ -55,7 +55,15 @@ double	PsychGetWhiteValueFromWindow(PsychWindowRecordType *windowRecord);
 void	PsychSwitchFixedFunctionStereoDrawbuffer(PsychWindowRecordType *windowRecord);
 int	PsychRessourceCheckAndReminder(psych_bool displayMessage);
 psych_bool	PsychFlipWindowBuffersIndirect(PsychWindowRecordType *windowRecord);
+void	PsychFlipWindowGroupIndirect(PsychWindowRecordType **windowRecords, int count);
 void	PsychReleaseFlipInfoStruct(PsychWindowRecordType *windowRecord);
+unsigned int PsychEnqueueFlip(PsychWindowRecordType *windowRecord, int dont_clear, int vbl_synclevel, double flipwhen);
+int		PsychCollectQueuedFlips(PsychWindowRecordType *windowRecord, psych_bool waitForAll);
+psych_bool PsychPredictFlipOnset(PsychWindowRecordType *windowRecord, double tWhen, psych_bool submitted, double* tReady, double* tOnset, psych_int64* onsetMsc, double* tFlipEnd);
+void	PsychSwapLogSetup(PsychWindowRecordType *windowRecord, psych_bool enable, unsigned int capacity);
+unsigned int PsychSwapLogPending(PsychWindowRecordType *windowRecord);
+unsigned int PsychSwapLogFetch(PsychWindowRecordType *windowRecord, double* records, unsigned int n);
+void	PsychSwapLogRelease(PsychWindowRecordType *windowRecord);
 int	PsychSetShader(PsychWindowRecordType *windowRecord, int shader);
 void	PsychDetectAndAssignGfxCapabilities(PsychWindowRecordType *windowRecord);
 void	PsychExecuteBufferSwapPrefix(PsychWindowRecordType *windowRecord);
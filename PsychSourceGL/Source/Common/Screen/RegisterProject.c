@@ -130,6 +130,9 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("AsyncFlipEnd", &SCREENFlip));
 	PsychErrorExit(PsychRegister("AsyncFlipCheckEnd", &SCREENFlip));
 	PsychErrorExit(PsychRegister("WaitUntilAsyncFlipCertain" , &SCREENWaitUntilAsyncFlipCertain));
+	PsychErrorExit(PsychRegister("AsyncFlipEnqueue", &SCREENAsyncFlipEnqueue));
+	PsychErrorExit(PsychRegister("AsyncFlipQueueResults", &SCREENAsyncFlipQueueResults));
+	PsychErrorExit(PsychRegister("FlipGroup", &SCREENFlipGroup));
 	PsychErrorExit(PsychRegister("FillRect", &SCREENFillRect));
 	PsychErrorExit(PsychRegister("GetImage", &SCREENGetImage));
 	PsychErrorExit(PsychRegister("PutImage", &SCREENPutImage));
@@ -224,6 +227,7 @@ PsychError PsychModuleInit(void)
 	PsychErrorExit(PsychRegister("AddFrameToMovie", &SCREENGetImage));
 	PsychErrorExit(PsychRegister("AddAudioBufferToMovie", &SCREENAddAudioBufferToMovie));
 	PsychErrorExit(PsychRegister("GetFlipInfo", &SCREENGetFlipInfo));
+	PsychErrorExit(PsychRegister("PredictFlip", &SCREENPredictFlip));
     
 	PsychSetModuleAuthorByInitials("awi");
 	PsychSetModuleAuthorByInitials("dhb");
@@ -185,7 +185,7 @@ PsychError SCREENColorRange(void)
 				// colors as standard vertex attribute and "tunnels" that down to the 
 				// raster-backends. Obviously only works with GLSL capable hardware and
 				// only for internal drawing commands where we can bind the shader whenever needed:
-				tunnelShader = PsychCreateGLSLProgram(fragmentTunnelSrc, vertexTunnelSrc, NULL);
+				tunnelShader = PsychCreateGLSLProgram(windowRecord, fragmentTunnelSrc, vertexTunnelSrc, NULL);
 				if (tunnelShader) {
 					// Got a shader :-) -- Assign it as color clamping shader to onscreen windowRecord:
 					windowRecord->unclampedDrawShader = tunnelShader;
@@ -23,6 +23,7 @@
                 5/13/05         mk              Support for rotated drawing of textures.
                 7/23/05         mk              New options filterMode and globalAlpha. 
                 9/30/05         mk              Remove size check for texturesize <= windowsize. This restriction doesn't apply anymore for new texture mapping code.
+                10/19/26        agent           DrawTextures: Batched drawing of consecutive items with the same texture and filterMode.
  
 	DESCRIPTION:
 
@@ -201,6 +202,31 @@ static char synopsisString[] =
 
 }
 
+// Draw all items accumulated in the batch buffers of Screen('DrawTextures') with one batched blit:
+static void PsychFlushDrawTexturesBatch(PsychWindowRecordType *source, PsychWindowRecordType *target, int *batchCount, double *srcRects, double *dstRects,
+										double *angles, int filterMode, double *colors, double *auxParameters, int numAuxComponents, int textureShader, int specialFlags)
+{
+	int backupShader;
+
+	if (*batchCount <= 0) return;
+
+	// Set rotation mode flag for texture matrix rotation if secialFlags is set accordingly:
+	if (specialFlags & kPsychUseTextureMatrixForRotation) source->specialflags|=kPsychUseTextureMatrixForRotation;
+	if (specialFlags & kPsychDontDoRotation) source->specialflags|=kPsychDontDoRotation;
+
+	// Perform batched blit, either with or without an override texture shader applied:
+	backupShader = source->textureFilterShader;
+	if (textureShader > -1) source->textureFilterShader = -1 * textureShader;
+	PsychBatchBlitTexturesToDisplay(source, target, *batchCount, srcRects, dstRects, angles, filterMode, colors, auxParameters, numAuxComponents);
+	source->textureFilterShader = backupShader;
+
+	// Reset rotation mode flag:
+	source->specialflags &= ~(kPsychUseTextureMatrixForRotation | kPsychDontDoRotation);
+
+	*batchCount = 0;
+	return;
+}
+
 // Batch-drawing version of DrawTexture:
 PsychError SCREENDrawTextures(void) 
 {
@@ -235,6 +261,11 @@ PsychError SCREENDrawTextures(void)
 	int textureShader, backupShader;
 	int specialFlags = 0;
 
+	PsychWindowRecordType			*batchSource = NULL;
+	double							*batchSrcRects = NULL, *batchDstRects = NULL, *batchAngles = NULL, *batchColors = NULL, *batchAux = NULL;
+	int								batchCount = 0, batchFilterMode = 0;
+	psych_bool						useBatch;
+
     //all subfunctions should have these two lines.  
     PsychPushHelp(useString, synopsisString, seeAlsoString);
     if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
@@ -408,23 +439,36 @@ PsychError SCREENDrawTextures(void)
 
 	// Ok, everything consistent so far.
 	
+	// Batched drawing: Consecutive items which use the same texture and filterMode are collected
+	// in the batch buffers and then drawn with one call to PsychBatchBlitTexturesToDisplay(), instead
+	// of one PsychBlitTextureToDisplay() call with full state setup per item:
+	useBatch = (numRef > 1) ? TRUE : FALSE;
+	if (useBatch) {
+		batchSrcRects = (double*) PsychMallocTemp(sizeof(double) * 4 * numRef);
+		batchDstRects = (double*) PsychMallocTemp(sizeof(double) * 4 * numRef);
+		batchAngles   = (double*) PsychMallocTemp(sizeof(double) * numRef);
+		// A single global modulateColor is already set as current vertex color, otherwise we need per item colors:
+		if (nc != 1) batchColors = (double*) PsychMallocTemp(sizeof(double) * 4 * numRef);
+		if (numAuxParams > 0) batchAux = (double*) PsychMallocTemp(sizeof(double) * numAuxComponents * numRef);
+	}
+
 	// Texture blitting loop:
 	for (i=0; i < numRef; i++) {
 		// Draw i'th texture:
 		
 		// Check if more than one texture provided. If not then the one single texture has been
-		// setup already above:
-		if (numTexs > 1) {
+		// setup already above. Also skip lookup if the handle is the same as for the previous item:
+		if ((numTexs > 1) && ((i == 0) || (texids[i] != texids[i-1]))) {
 			// More than one texture handle provided: Need to allocate i'th one in:
 			if(!IsWindowIndex((PsychWindowIndexType) texids[i])) {
-				printf("PTB-ERROR: %i th entry in texture handle vector is not a valid handle!\n");
+				printf("PTB-ERROR: %i th entry in texture handle vector is not a valid handle!\n", i + 1);
 				PsychErrorExitMsg(PsychError_user, "Invalid texture handle provided to Screen('DrawTextures').");
 			}
 
 			// Get it:
 			FindWindowRecord((PsychWindowIndexType) texids[i], &source);
 			if(source->windowType!=kPsychTexture) {
-				printf("PTB-ERROR: %i th entry in texture handle vector is not a valid handle!\n");
+				printf("PTB-ERROR: %i th entry in texture handle vector is not a valid handle!\n", i + 1);
 				PsychErrorExitMsg(PsychError_user, "The second argument supplied was not a texture handle!");
 			}
 
@@ -470,6 +514,52 @@ PsychError SCREENDrawTextures(void)
 		// Disable alpha if modulateColor active:
 		if (nc > 0) globalAlpha = DBL_MAX;
 
+		// Check parameters:
+		if (filterMode<0 || filterMode>3) {
+			PsychErrorExitMsg(PsychError_user, "filterMode needs to be 0 for nearest neighbour filter, or 1 for bilinear filter, or 2 for mipmapped filter or 3 for mipmapped-linear filter.");    
+		}
+
+		// Batched drawing of this item? Not possible for drawing a texture into itself:
+		if (useBatch && (source != target)) {
+			// Draw pending batch first if this item can't be added to it:
+			if ((batchCount > 0) && ((source != batchSource) || ((int) filterMode != batchFilterMode))) {
+				PsychFlushDrawTexturesBatch(batchSource, target, &batchCount, batchSrcRects, batchDstRects, batchAngles, batchFilterMode, batchColors, batchAux, numAuxComponents, textureShader, specialFlags);
+			}
+
+			batchSource = source;
+			batchFilterMode = (int) filterMode;
+			PsychCopyRect(&(batchSrcRects[batchCount * 4]), sourceRect);
+			PsychCopyRect(&(batchDstRects[batchCount * 4]), targetRect);
+			batchAngles[batchCount] = rotationAngle;
+
+			if (batchAux) memcpy(&(batchAux[batchCount * numAuxComponents]), (numAuxParams == 1) ? auxParameters : &(auxParameters[i * numAuxComponents]), sizeof(double) * numAuxComponents);
+
+			if (batchColors) {
+				if (nc == 0) {
+					// No modulateColor: Color is (1,1,1,globalAlpha):
+					batchColors[batchCount * 4 + 0] = batchColors[batchCount * 4 + 1] = batchColors[batchCount * 4 + 2] = 1.0;
+					batchColors[batchCount * 4 + 3] = globalAlpha;
+				}
+				else {
+					// Per item modulateColors, same conversion as in the non-batched case below:
+					for (j = 0; j < 4; j++) {
+						if (j < mc) {
+							batchColors[batchCount * 4 + j] = (colors) ? colors[i * mc + j] : ((double) bytecolors[i * mc + j] / 255.0);
+						}
+						else {
+							batchColors[batchCount * 4 + j] = 1.0;
+						}
+					}
+				}
+			}
+
+			batchCount++;
+			continue;
+		}
+
+		// Non-batched drawing of this item: Draw pending batch first to keep drawing order:
+		PsychFlushDrawTexturesBatch(batchSource, target, &batchCount, batchSrcRects, batchDstRects, batchAngles, batchFilterMode, batchColors, batchAux, numAuxComponents, textureShader, specialFlags);
+
 		// Pass auxParameters for current primitive in the auxShaderParams field.
 		target->auxShaderParamsCount = numAuxComponents;
 		if (numAuxParams > 0) {
@@ -526,11 +616,6 @@ PsychError SCREENDrawTextures(void)
 			}			
 		}
 		
-		// Ok, everything assigned. Check parameters:
-		if (filterMode<0 || filterMode>3) {
-			PsychErrorExitMsg(PsychError_user, "filterMode needs to be 0 for nearest neighbour filter, or 1 for bilinear filter, or 2 for mipmapped filter or 3 for mipmapped-linear filter.");    
-		}
-
 		// Set rotation mode flag for texture matrix rotation if secialFlags is set accordingly:
 		if (specialFlags & kPsychUseTextureMatrixForRotation) source->specialflags|=kPsychUseTextureMatrixForRotation;
 		if (specialFlags & kPsychDontDoRotation) source->specialflags|=kPsychDontDoRotation;
@@ -552,6 +637,9 @@ PsychError SCREENDrawTextures(void)
 		// Next one...
 	}
 
+	// Draw remaining batched items:
+	PsychFlushDrawTexturesBatch(batchSource, target, &batchCount, batchSrcRects, batchDstRects, batchAngles, batchFilterMode, batchColors, batchAux, numAuxComponents, textureShader, specialFlags);
+
 	target->auxShaderParams = NULL;
 	target->auxShaderParamsCount = 0;
 
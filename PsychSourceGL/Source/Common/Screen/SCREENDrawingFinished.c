@@ -121,6 +121,10 @@ PsychError SCREENDrawingFinished(void)
     // textures:
     if (PsychIsOnscreenWindow(windowRecord) && (windowRecord->flipInfo->asyncstate > 0)) runPreFlipOps = FALSE;
 
+    // Same for windows with queued flips: The flipper thread may be busy with the system backbuffer, and
+    // Screen('AsyncFlipEnqueue') must run the preflip-operations itself to render into its queue entry:
+    if (PsychIsOnscreenWindow(windowRecord) && (windowRecord->flipInfo->flipQueue)) runPreFlipOps = FALSE;
+
     // Perform preflip-operations: Backbuffer backups for the different dontclear-modes
     // and special compositing operations for specific stereo algorithms...
     if (runPreFlipOps) {
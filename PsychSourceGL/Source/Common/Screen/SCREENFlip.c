@@ -138,7 +138,9 @@ PsychError SCREENFlip(void)
     "immediately with the results of the last completed flip, regardless if it was a synchronous Screen('Flip') or an "
     "asynchronous flip long finished ago.\n"
 	"Screen('AsyncFlipCheckEnd') provides a non-blocking, polling version of this command -- one that doesn't pause if "
-	"the referenced operation hasn't completed yet.";
+	"the referenced operation hasn't completed yet.\n"
+	"On a window with flips queued via Screen('AsyncFlipEnqueue'), this command waits until all queued flips have "
+	"completed and returns the results of the last one.";
 
 	static char useString3[] = "[VBLTimestamp StimulusOnsetTime FlipTimestamp Missed Beampos] = Screen('AsyncFlipCheckEnd', windowPtr);";
 	static char synopsisString3[] = 
@@ -150,9 +152,11 @@ PsychError SCREENFlip(void)
     "it will return the results of the last completed flip, regardless if it was a synchronous Screen('Flip') or an "
     "asynchronous flip long finished ago.\n"
 	"Screen('AsyncFlipEnd') provides a blocking version of this command -- one that pauses until the operation completes if "
-	"the referenced operation hasn't completed yet.";
+	"the referenced operation hasn't completed yet.\n"
+	"On a window with flips queued via Screen('AsyncFlipEnqueue'), this command returns the results of the most recently "
+	"completed queued flip without waiting.";
 
-	static char seeAlsoString[] = "DrawingFinished WaitUntilAsyncFlipCertain AsyncFlipBegin AsyncFlipCheckEnd AsyncFlipEnd Flip";
+	static char seeAlsoString[] = "DrawingFinished WaitUntilAsyncFlipCertain AsyncFlipBegin AsyncFlipCheckEnd AsyncFlipEnd AsyncFlipEnqueue Flip";
 
 	PsychFlipInfoStruct*  flipRequest;
 	PsychWindowRecordType *windowRecord;
@@ -270,6 +274,13 @@ PsychError SCREENFlip(void)
 		// PsychFlipWindowBuffersIndirect() routine:
 		flipRequest = windowRecord->flipInfo;
 
+		// Queued flips from Screen('AsyncFlipEnqueue') can't be mixed with classic async flips. A synchronous
+		// flip waits until all queued flips are done, then flips as usual:
+		if (flipRequest->flipQueue) {
+			if (opmode == 1) PsychErrorExitMsg(PsychError_user, "Screen('AsyncFlipBegin') called on a window which uses queued flips via Screen('AsyncFlipEnqueue')! This is forbidden.");
+			PsychCollectQueuedFlips(windowRecord, TRUE);
+		}
+
 		if (flipRequest->asyncstate != 0) {
 			// Started, executing or finalized async flip in progress. We can't trigger a new flip request
 			// before the current one has finished. Perform a blocking wait for flip completion, basically
@@ -337,6 +348,11 @@ PsychError SCREENFlip(void)
 	else {
 		// opmode == 2 or 3 - 'AsyncFlipEnd' or 'AsyncFlipCheckEnd':
 		flipRequest = windowRecord->flipInfo;
+
+		// With queued flips, 'AsyncFlipEnd' waits for all of them to complete, 'AsyncFlipCheckEnd' just
+		// gathers the results of the completed ones. Both return the results of the most recent one:
+		if (flipRequest->flipQueue) PsychCollectQueuedFlips(windowRecord, (opmode == 2) ? TRUE : FALSE);
+
 		if (flipRequest->asyncstate == 0) {
 			// No started, executing or finalized async flip in progress! No async flip operation triggered
 			// which we could finalize. This is fine. We basically no-op and return the cached last known
@@ -580,3 +596,274 @@ PsychError SCREENWaitUntilAsyncFlipCertain(void)
 	// Done.
 	return(PsychError_none);	
 }
+
+PsychError SCREENAsyncFlipEnqueue(void)
+{
+	// If you change the useString then also change the corresponding synopsis string in ScreenSynopsis.c
+	static char useString[] = "[flipId, pendingFlips] = Screen('AsyncFlipEnqueue', windowPtr [, when] [, dontclear] [, dontsync]);";
+	static char synopsisString[] =
+	"Queue a flip of onscreen window \"windowPtr\" for asynchronous execution and return immediately.\n"
+	"This works like Screen('AsyncFlipBegin'), but you don't need to wait for completion of the flip before "
+	"you draw and queue the next frame: Up to 16 flips can be pending per window, each with its own stimulus "
+	"image, 'when' deadline and result slot. A background thread executes them back to back in the order in "
+	"which they were queued. This allows to prerender short stimulus sequences, e.g., 10 frames, in advance, "
+	"so presentation timing is robust against temporary hiccups of Matlab or Octave. If the queue is full, "
+	"the command waits until the oldest queued flip has completed.\n"
+	"\"when\", \"dontclear\" and \"dontsync\" have the same meaning as for Screen('Flip'). Your window is "
+	"prepared for drawing of the next frame according to 'dontclear' immediately.\n"
+	"Returns 'flipId', the running count of flips queued on the window, and 'pendingFlips', the number of "
+	"queued flips not yet completed, including this one.\n"
+	"Use Screen('AsyncFlipQueueResults') to retrieve the timestamps of completed queued flips in bulk.\n"
+	"Restrictions: The imaging pipeline must be enabled (see 'help PsychImaging'), and quad-buffered, frame-"
+	"sequential or dual-window stereo modes and dual-window output are not supported. Screen('AsyncFlipBegin') "
+	"can't be used on the same window. A regular Screen('Flip') waits until all queued flips are completed. "
+	"The 'ScreenFlipImpliedOperations' hook chain of the imaging pipeline executes at queueing time, not at "
+	"completion time of the flip. Gamma table updates via Screen('LoadNormalizedGammaTable', windowPtr, table, 1) "
+	"are rejected while queued flips are pending. Wait for completion of all queued flips via "
+	"Screen('AsyncFlipQueueResults', windowPtr, 1) first, then the new table gets loaded by the next queued flip.";
+	static char seeAlsoString[] = "AsyncFlipQueueResults AsyncFlipBegin AsyncFlipEnd Flip";
+
+	PsychWindowRecordType *windowRecord;
+	int dont_clear, vbl_synclevel;
+	double flipwhen, tNow;
+	unsigned int flipId;
+
+	// Push usage string and/or give online help:
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp();return(PsychError_none);};
+
+	PsychErrorExit(PsychCapNumInputArgs(4));		// The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1));	// The required number of inputs
+	PsychErrorExit(PsychCapNumOutputArgs(2));		// The maximum number of outputs
+
+	PsychAllocInWindowRecordArg(kPsychUseDefaultArgPosition, TRUE, &windowRecord);
+	if (!PsychIsOnscreenWindow(windowRecord)) PsychErrorExitMsg(PsychError_user, "AsyncFlipEnqueue called on something else than an onscreen window. You can only flip onscreen windows.");
+	if (windowRecord->windowType!=kPsychDoubleBufferOnscreen) PsychErrorExitMsg(PsychError_user, "AsyncFlipEnqueue called on window without backbuffers. Specify numberOfBuffers=2 in Screen('OpenWindow') if you want to use Flip.");
+	if (windowRecord->flipInfo->asyncstate != 0) PsychErrorExitMsg(PsychError_user, "AsyncFlipEnqueue called while an async flip from Screen('AsyncFlipBegin') is pending! This is forbidden.");
+
+	flipwhen = 0;
+	PsychCopyInDoubleArg(2, FALSE, &flipwhen);
+	if (flipwhen < 0) PsychErrorExitMsg(PsychError_user, "Only 'when' values greater or equal to 0 are supported");
+	PsychGetAdjustedPrecisionTimerSeconds(&tNow);
+	if (flipwhen - tNow > 1000) PsychErrorExitMsg(PsychError_user, "\nYou specified a 'when' value to AsyncFlipEnqueue that's over 1000 seconds in the future?!? Aborting, assuming that's an error.\n\n");
+
+	dont_clear = 0;
+	PsychCopyInIntegerArg(3, FALSE, &dont_clear);
+	if (dont_clear < 0 || dont_clear > 2) PsychErrorExitMsg(PsychError_user, "Only 'dontclear' values 0 (== clear after flip), 1 (== don't clear) and 2 (== don't do anything) are supported");
+
+	vbl_synclevel = 0;
+	PsychCopyInIntegerArg(4, FALSE, &vbl_synclevel);
+	if (vbl_synclevel < 0 || vbl_synclevel > 2) PsychErrorExitMsg(PsychError_user, "Only 'dontsync' values 0 (== fully synchronize with VBL), 1 (== don't wait for VBL) and 2 (== Ignore VBL) are supported");
+
+	// Store current preflip GPU graphics surface addresses, if supported:
+	PsychStoreGPUSurfaceAddresses(windowRecord);
+
+	flipId = PsychEnqueueFlip(windowRecord, dont_clear, vbl_synclevel, flipwhen);
+
+	PsychCopyOutDoubleArg(1, FALSE, (double) flipId);
+	PsychCopyOutDoubleArg(2, FALSE, (double) PsychCollectQueuedFlips(windowRecord, FALSE));
+
+	// Execute hook chain for preparation of user space drawing ops:
+	PsychPipelineExecuteHook(windowRecord, kPsychUserspaceBufferDrawingPrepare, NULL, NULL, FALSE, FALSE, NULL, NULL, NULL, NULL);
+
+	return(PsychError_none);
+}
+
+PsychError SCREENAsyncFlipQueueResults(void)
+{
+	// If you change the useString then also change the corresponding synopsis string in ScreenSynopsis.c
+	static char useString[] = "[results, pendingFlips] = Screen('AsyncFlipQueueResults', windowPtr [, waitForAll=0]);";
+	static char synopsisString[] =
+	"Return the results of all flips queued via Screen('AsyncFlipEnqueue') on onscreen window \"windowPtr\" "
+	"which have completed since the last call of this function.\n"
+	"If \"waitForAll\" is 1, wait until all queued flips have completed, otherwise return immediately.\n"
+	"'results' is a matrix with one row per completed flip, in order of completion, and the columns "
+	"[flipId VBLTimestamp StimulusOnsetTime FlipTimestamp Missed Beampos]. 'flipId' is the id returned "
+	"by Screen('AsyncFlipEnqueue') for that flip, the other columns are the values returned by Screen('Flip'). "
+	"The matrix is empty if no queued flips have completed since the last call.\n"
+	"'pendingFlips' is the number of queued flips not yet completed.";
+	static char seeAlsoString[] = "AsyncFlipEnqueue Flip";
+
+	PsychWindowRecordType *windowRecord;
+	PsychFlipQueue *flipQueue;
+	int waitForAll, pending, i, j, n;
+	double *results;
+
+	// Push usage string and/or give online help:
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp();return(PsychError_none);};
+
+	PsychErrorExit(PsychCapNumInputArgs(2));		// The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1));	// The required number of inputs
+	PsychErrorExit(PsychCapNumOutputArgs(2));		// The maximum number of outputs
+
+	PsychAllocInWindowRecordArg(kPsychUseDefaultArgPosition, TRUE, &windowRecord);
+	if (!PsychIsOnscreenWindow(windowRecord)) PsychErrorExitMsg(PsychError_user, "AsyncFlipQueueResults called on something else than an onscreen window.");
+
+	waitForAll = 0;
+	PsychCopyInIntegerArg(2, FALSE, &waitForAll);
+
+	pending = PsychCollectQueuedFlips(windowRecord, (waitForAll > 0) ? TRUE : FALSE);
+
+	// Return results and clear them: Stored per flip, returned as one row per flip:
+	flipQueue = windowRecord->flipInfo->flipQueue;
+	n = (flipQueue) ? flipQueue->resultCount : 0;
+	PsychAllocOutDoubleMatArg(1, FALSE, n, kPsychFlipQueueResultColumns, 1, &results);
+	for (i = 0; i < n; i++) {
+		for (j = 0; j < kPsychFlipQueueResultColumns; j++) results[j * n + i] = flipQueue->results[i * kPsychFlipQueueResultColumns + j];
+	}
+	if (flipQueue) flipQueue->resultCount = 0;
+
+	PsychCopyOutDoubleArg(2, FALSE, (double) pending);
+
+	return(PsychError_none);
+}
+
+PsychError SCREENFlipGroup(void)
+{
+	// If you change the useString then also change the corresponding synopsis string in ScreenSynopsis.c
+	static char useString[] = "[results, skew] = Screen('FlipGroup', windowPtrs [, when] [, dontclear] [, dontsync]);";
+	static char synopsisString[] =
+	"Flip a group of onscreen windows, e.g., on different displays, concurrently and wait for completion.\n"
+	"\"windowPtrs\" is a vector with the handles of the onscreen windows to flip. Each window must be a "
+	"double-buffered onscreen window and can only be listed once.\n"
+	"\"when\", \"dontclear\" and \"dontsync\" have the same meaning as for Screen('Flip') and apply to all windows "
+	"of the group. All preflip operations of all windows are performed first, then the flips are executed "
+	"in parallel by one background thread per window, just as with Screen('AsyncFlipBegin'), so the flips "
+	"of all windows target the same 'when' deadline instead of being serialized one after the other. "
+	"If you enabled flip scheduling by vblank count on a window via Screen('PredictFlip'), the common 'when' "
+	"deadline is converted into a target vblank count for that window's display by its flip timing model. "
+	"Vblank counts of different displays are unrelated, so there is no common target vblank count.\n"
+	"Any pending async flip on a window is finalized first.\n"
+	"Returns the matrix 'results' with one row per window, in the order of \"windowPtrs\", and the columns "
+	"[VBLTimestamp StimulusOnsetTime FlipTimestamp Missed Beampos MSC Skew]. The first five columns are the values "
+	"returned by Screen('Flip') for that window. 'MSC' is the vblank count of stimulus onset, or -1 if unknown. "
+	"'Skew' is the stimulus onset time of the window minus the earliest stimulus onset time in the group.\n"
+	"'skew' is the vector [maxSkew, onsetSD] with the maximum skew and the standard deviation of the stimulus "
+	"onset times of the group in seconds. Displays which don't refresh in sync can't achieve a skew below "
+	"the phase difference of their refresh cycles.\n"
+	"Restrictions: Multiflip, frame-sequential stereo, windows which are the right view of a dual-window "
+	"stereo setup and windows which use queued flips via Screen('AsyncFlipEnqueue') are not supported.";
+	static char seeAlsoString[] = "Flip AsyncFlipBegin AsyncFlipEnd PredictFlip";
+
+	PsychWindowRecordType **windowRecords;
+	PsychFlipInfoStruct *flipRequest;
+	int dont_clear, vbl_synclevel, m, n, p, count, i, j;
+	double flipwhen, tNow, *windowPtrs, *results, *skew;
+	double tMinOnset, tMaxOnset, tMean, tVar;
+	int nValid;
+
+	// Push usage string and/or give online help:
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if(PsychIsGiveHelp()) {PsychGiveHelp();return(PsychError_none);};
+
+	PsychErrorExit(PsychCapNumInputArgs(4));		// The maximum number of inputs
+	PsychErrorExit(PsychRequireNumInputArgs(1));	// The required number of inputs
+	PsychErrorExit(PsychCapNumOutputArgs(2));		// The maximum number of outputs
+
+	PsychAllocInDoubleMatArg(1, TRUE, &m, &n, &p, &windowPtrs);
+	count = m * n * p;
+	if (count < 1) PsychErrorExitMsg(PsychError_user, "FlipGroup called with an empty list of windows.");
+
+	windowRecords = (PsychWindowRecordType**) PsychMallocTemp(count * sizeof(PsychWindowRecordType*));
+	for (i = 0; i < count; i++) {
+		PsychErrorExit(FindWindowRecord((PsychWindowIndexType) windowPtrs[i], &windowRecords[i]));
+		if (!PsychIsOnscreenWindow(windowRecords[i])) PsychErrorExitMsg(PsychError_user, "FlipGroup called with something else than an onscreen window. You can only flip onscreen windows.");
+		if (windowRecords[i]->windowType != kPsychDoubleBufferOnscreen) PsychErrorExitMsg(PsychError_user, "FlipGroup called with a window without backbuffers. Specify numberOfBuffers=2 in Screen('OpenWindow') if you want to use Flip.");
+		if (windowRecords[i]->stereomode == kPsychFrameSequentialStereo) PsychErrorExitMsg(PsychError_user, "FlipGroup called with a window in frame-sequential stereo mode. This is not supported.");
+		if (windowRecords[i]->flipInfo->flipQueue) PsychErrorExitMsg(PsychError_user, "FlipGroup called with a window which uses queued flips via Screen('AsyncFlipEnqueue')! This is forbidden.");
+		for (j = 0; j < i; j++) {
+			if (windowRecords[j] == windowRecords[i]) PsychErrorExitMsg(PsychError_user, "FlipGroup called with a window listed more than once.");
+		}
+	}
+
+	// The right view window of dual-window stereo is flipped by its master window, it can't be flipped on its own:
+	for (i = 0; i < count; i++) {
+		for (j = 0; j < count; j++) {
+			if (windowRecords[i]->slaveWindow == windowRecords[j]) PsychErrorExitMsg(PsychError_user, "FlipGroup called with the right view window of a dual-window stereo setup. Only list the left view window.");
+		}
+	}
+
+	flipwhen = 0;
+	PsychCopyInDoubleArg(2, FALSE, &flipwhen);
+	if (flipwhen < 0) PsychErrorExitMsg(PsychError_user, "Only 'when' values greater or equal to 0 are supported");
+	PsychGetAdjustedPrecisionTimerSeconds(&tNow);
+	if (flipwhen - tNow > 1000) PsychErrorExitMsg(PsychError_user, "\nYou specified a 'when' value to FlipGroup that's over 1000 seconds in the future?!? Aborting, assuming that's an error.\n\n");
+
+	dont_clear = 0;
+	PsychCopyInIntegerArg(3, FALSE, &dont_clear);
+	if (dont_clear < 0 || dont_clear > 2) PsychErrorExitMsg(PsychError_user, "Only 'dontclear' values 0 (== clear after flip), 1 (== don't clear) and 2 (== don't do anything) are supported");
+
+	vbl_synclevel = 0;
+	PsychCopyInIntegerArg(4, FALSE, &vbl_synclevel);
+	if (vbl_synclevel < 0 || vbl_synclevel > 2) PsychErrorExitMsg(PsychError_user, "Only 'dontsync' values 0 (== fully synchronize with VBL), 1 (== don't wait for VBL) and 2 (== Ignore VBL) are supported");
+
+	for (i = 0; i < count; i++) {
+		flipRequest = windowRecords[i]->flipInfo;
+
+		// Finalize pending async flips, as Screen('Flip') does:
+		if (flipRequest->asyncstate != 0) {
+			flipRequest->opmode = 2;
+			if (PsychFlipWindowBuffersIndirect(windowRecords[i])) flipRequest->asyncstate = 0;
+		}
+
+		// Pack the flip request of this window as an async flip:
+		flipRequest->opmode			= 1;
+		flipRequest->dont_clear		= dont_clear;
+		flipRequest->flipwhen		= flipwhen;
+		flipRequest->multiflip		= 0;
+		flipRequest->vbl_synclevel	= vbl_synclevel;
+		flipRequest->vbl_timestamp	= -1;
+
+		// Store current preflip GPU graphics surface addresses, if supported:
+		PsychStoreGPUSurfaceAddresses(windowRecords[i]);
+	}
+
+	// Execute all flips concurrently and wait for their completion:
+	PsychFlipWindowGroupIndirect(windowRecords, count);
+
+	// Find earliest and latest valid stimulus onset of the group:
+	tMinOnset = tMaxOnset = tMean = tVar = 0;
+	nValid = 0;
+	for (i = 0; i < count; i++) {
+		flipRequest = windowRecords[i]->flipInfo;
+		if (flipRequest->time_at_onset <= 0) continue;
+		if ((nValid == 0) || (flipRequest->time_at_onset < tMinOnset)) tMinOnset = flipRequest->time_at_onset;
+		if ((nValid == 0) || (flipRequest->time_at_onset > tMaxOnset)) tMaxOnset = flipRequest->time_at_onset;
+		nValid++;
+	}
+
+	// Return per window results, one row per window:
+	PsychAllocOutDoubleMatArg(1, FALSE, count, 7, 1, &results);
+	for (i = 0; i < count; i++) {
+		flipRequest = windowRecords[i]->flipInfo;
+		results[0 * count + i] = flipRequest->vbl_timestamp;
+		results[1 * count + i] = flipRequest->time_at_onset;
+		results[2 * count + i] = flipRequest->time_at_flipend;
+		results[3 * count + i] = flipRequest->miss_estimate;
+		results[4 * count + i] = (double) flipRequest->beamPosAtFlip;
+		// Onset MSC is the reference point of the flip timing model, if it got updated by this flip:
+		results[5 * count + i] = (windowRecords[i]->timingModel.mscValid && (windowRecords[i]->timingModel.refTime == flipRequest->vbl_timestamp)) ?
+								 (double) windowRecords[i]->timingModel.refMsc : -1;
+		results[6 * count + i] = (flipRequest->time_at_onset > 0 && nValid > 0) ? flipRequest->time_at_onset - tMinOnset : -1;
+		if (flipRequest->time_at_onset > 0) tMean += flipRequest->time_at_onset - tMinOnset;
+
+		// Flip completed, ready for new flips. Prepare the window for user space drawing:
+		flipRequest->asyncstate = 0;
+		PsychPipelineExecuteHook(windowRecords[i], kPsychUserspaceBufferDrawingPrepare, NULL, NULL, FALSE, FALSE, NULL, NULL, NULL, NULL);
+	}
+
+	// Skew statistics of the group, relative to earliest onset for numerical accuracy:
+	if (nValid > 0) tMean /= nValid;
+	for (i = 0; i < count; i++) {
+		flipRequest = windowRecords[i]->flipInfo;
+		if (flipRequest->time_at_onset > 0) tVar += (flipRequest->time_at_onset - tMinOnset - tMean) * (flipRequest->time_at_onset - tMinOnset - tMean);
+	}
+	if (nValid > 0) tVar /= nValid;
+
+	PsychAllocOutDoubleMatArg(2, FALSE, 1, 2, 1, &skew);
+	skew[0] = (nValid > 0) ? tMaxOnset - tMinOnset : -1;
+	skew[1] = (nValid > 0) ? sqrt(tVar) : -1;
+
+	return(PsychError_none);
+}
@@ -10,6 +10,7 @@
   HISTORY:
 
   5.09.2011	mk		Created.
+  19.10.2026	agent	Add swap log with bulk retrieval (infoType 4, 5 and 6), supported on all platforms.
  
   DESCRIPTION:
   
@@ -25,7 +26,7 @@
 
 #include "Screen.h"
 
-static char useString[] = "info = Screen('GetFlipInfo', windowPtr [, infoType=0] [, auxArg1]);";
+static char useString[] = "[info, droppedCount] = Screen('GetFlipInfo', windowPtr [, infoType=0] [, auxArg1]);";
 static char synopsisString[] = 
 	"Returns a struct with miscellaneous info about finished flips on the specified onscreen window.\n"
 	"\n"
@@ -49,7 +50,26 @@ static char synopsisString[] =
 	"OnsetVBLCount: Video refresh cycle count when the flip completed.\n"
 	"SwapbuffersCount: Serial number of this info struct. Corresponds to the handle returned for 'infoType' zero.\n"
 	"SwapType: How was the flip executed? Low level info about strategy chosen by GPU.\n"
-	"Note: Currently only PAGEFLIP flips are considered to have reliable timing and trustworthy timestamps!\n\n";
+	"Note: Currently only PAGEFLIP flips are considered to have reliable timing and trustworthy timestamps!\n\n"
+	"Swap log:\n"
+	"---------\n\n"
+	"On all platforms, infoTypes 4 to 6 control a swap log, which records every completed flip, as executed by "
+	"Screen('Flip'), async flips or queued flips via Screen('AsyncFlipEnqueue'). The log is preallocated and written "
+	"by the thread which executes the flip without any locking, so it is suitable for a full timing audit of long "
+	"sessions at high refresh rates, without the overhead of collecting the return values of each flip in your script.\n"
+	"If set to 4, logging into the swap log is enabled. 'auxArg1' optionally specifies the capacity of the log in "
+	"flips. By default, the log is allocated for one hour of flips at the video refresh rate. Each flip needs 96 Bytes.\n"
+	"If set to 5, logging into the swap log is disabled. Not yet fetched records stay in the log.\n"
+	"If set to 6, all records in the swap log are fetched and returned in 'info' as a n-by-12 matrix, one row per "
+	"flip, and 'droppedCount' returns the number of flips which were not logged since the last fetch, because the "
+	"log was full. Fetch often enough to avoid this. The columns of 'info' are:\n"
+	"1 = Flip count of the window, as in Screen('GetWindowInfo') field 'FlipCount'. 2 = Type of flip request: 0 = "
+	"Screen('Flip'), 1 = Async flip, 2 = Queued flip. 3 = 'flipId' of a queued flip, as returned by Screen('AsyncFlipEnqueue'), "
+	"otherwise zero. 4 = Target time 'when' of the flip. 5 = VBLTimestamp. 6 = StimulusOnsetTime. 7 = FlipTimestamp. "
+	"8 = Missed. 9 = Beampos. Columns 5 to 9 are the same as the return values of Screen('Flip'). 10 = Video refresh cycle "
+	"count (MSC) of swap completion. 11 = Raw OpenML UST timestamp of swap completion. 12 = OpenML swapbuffers count (SBC) "
+	"of the swap. Columns 10 to 12 are -1 if unknown, e.g., UST and SBC are only known on Linux with OpenML timestamping "
+	"(VBLTimestampingMode 4).\n\n";
 
 static char seeAlsoString[] = "OpenWindow, Flip, NominalFrameRate";
 
@@ -58,21 +78,47 @@ PsychError SCREENGetFlipInfo(void)
 	PsychWindowRecordType *windowRecord;
 	int infoType = 0, retIntArg;
 	double auxArg1, auxArg2, auxArg3;
+	double *records;
+	unsigned int n, dropped;
 
 	// All subfunctions should have these two lines.  
 	PsychPushHelp(useString, synopsisString, seeAlsoString);
 	if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
 
-	PsychErrorExit(PsychCapNumInputArgs(2));     //The maximum number of inputs
+	PsychErrorExit(PsychCapNumInputArgs(3));     //The maximum number of inputs
 	PsychErrorExit(PsychRequireNumInputArgs(1)); //The required number of inputs	
-	PsychErrorExit(PsychCapNumOutputArgs(1));    //The maximum number of outputs
+	PsychErrorExit(PsychCapNumOutputArgs(2));    //The maximum number of outputs
 
 	PsychAllocInWindowRecordArg(kPsychUseDefaultArgPosition, TRUE, &windowRecord);
 	if (!PsychIsOnscreenWindow(windowRecord)) PsychErrorExitMsg(PsychError_user, "Invalid 'windowPtr' specified. Not an onscreen window!");
 
 	// Query infoType flag: Defaults to zero.
 	PsychCopyInIntegerArg(2, FALSE, &infoType);
-	if (infoType < 0 || infoType > 3) PsychErrorExitMsg(PsychError_user, "Invalid 'infoType' argument specified! Valid are 0, 1, 2, 3.");
+	if (infoType < 0 || infoType > 6) PsychErrorExitMsg(PsychError_user, "Invalid 'infoType' argument specified! Valid are 0, 1, 2, 3, 4, 5, 6.");
+
+	// Type 4: Enable swap log, with optional capacity:
+	if (infoType == 4) {
+		auxArg1 = 0;
+		PsychCopyInDoubleArg(3, FALSE, &auxArg1);
+		if (auxArg1 < 0 || auxArg1 > INT_MAX / kPsychSwapLogColumns) PsychErrorExitMsg(PsychError_user, "Invalid swap log capacity 'auxArg1' specified!");
+		PsychSwapLogSetup(windowRecord, TRUE, (unsigned int) auxArg1);
+		return(PsychError_none);
+	}
+
+	// Type 5: Disable swap log:
+	if (infoType == 5) {
+		PsychSwapLogSetup(windowRecord, FALSE, 0);
+		return(PsychError_none);
+	}
+
+	// Type 6: Fetch all records from swap log:
+	if (infoType == 6) {
+		n = PsychSwapLogPending(windowRecord);
+		PsychAllocOutDoubleMatArg(1, FALSE, (int) n, kPsychSwapLogColumns, 0, &records);
+		dropped = PsychSwapLogFetch(windowRecord, records, n);
+		PsychCopyOutDoubleArg(2, FALSE, (double) dropped);
+		return(PsychError_none);
+	}
 
 #if PSYCH_SYSTEM == PSYCH_LINUX
 	// Type 0: Return SBC handle of last scheduled flip:
@@ -83,6 +83,14 @@ static char synopsisString[] =
 	"Same as 'AppendShader' but add shader slot to beginning of the hook chain. It's recommended that you prepend slots instead of "
 	"appending them, because PTB itself may add special slots at the end of a chain."
 	"\n\n"
+	"Shader slots whose shader only transforms the color of each pixel can opt in to shader fusion via the token "
+	"'Fusable:name' in 'blittercfg': 'name' is the name of a function vec4 name(vec4 incolor) in the shader which "
+	"computes the output color from the input color, and the shaders main() must be equivalent to "
+	"gl_FragColor = name(texture2DRect(Image, gl_TexCoord[0].st)). A run of fusable slots in an onscreen windows hook chain, "
+	"separated by 'Builtin:FlipFBOs' slots, is then executed as one shader pass instead of one pass per slot. Slots which "
+	"need other blitter settings than the default identity blit, or which sample the input image at other positions, must "
+	"not be marked fusable. If fusion fails, the slots get executed one by one as usual."
+	"\n\n"
 	"Screen('HookFunction', windowPtr, 'AppendCFunction', hookname, idString, voidfunctionptr); \n"
 	"Screen('HookFunction', windowPtr, 'PrependCFunction', hookname, idString, voidfunctionptr); \n"
 	"Attach a C callable function to the chain. voidfunctionptr is a double value which encodes a memory pointer to the function in "
@@ -170,6 +170,13 @@ PsychError SCREENLoadNormalizedGammaTable(void)
 		 // Sanity checks:
 		 if (!PsychIsOnscreenWindow(windowRecord)) PsychErrorExitMsg(PsychError_user, "Target window for gamma table upload is not an onscreen window!");
 		 if (windowRecord->inRedTable && loadOnNextFlip!=2) PsychErrorExitMsg(PsychError_user, "This window has already a new gamma table assigned for upload on next Flip!");
+
+		 // Queued flips are executed by the flipper thread, which uploads and releases a table assigned for upload on next
+		 // Flip. Therefore no such table must be assigned or modified while any of them is pending:
+		 if (windowRecord->flipInfo && windowRecord->flipInfo->flipQueue && (windowRecord->flipInfo->flipQueue->head != windowRecord->flipInfo->flipQueue->tail) &&
+			 ((loadOnNextFlip == 1) || (windowRecord->inRedTable && windowRecord->loadGammaTableOnNextFlip > 0))) {
+			 PsychErrorExitMsg(PsychError_user, "Gamma table upload on next Flip is not possible while queued flips are pending! Wait for them via Screen('AsyncFlipQueueResults', window, 1) first.");
+		 }
 		 
 		 if (windowRecord->inRedTable && windowRecord->inTableSize != inM) {
 			free(windowRecord->inRedTable); windowRecord->inRedTable = NULL;
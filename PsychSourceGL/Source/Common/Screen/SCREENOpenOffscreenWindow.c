@@ -339,8 +339,8 @@ PsychError SCREENOpenOffscreenWindow(void)
 			}
 		}
 
-		// Allocate framebuffer object for this Offscreen window:
-		if (!PsychCreateFBO(&(windowRecord->fboTable[0]), fboInternalFormat, needzbuffer, PsychGetWidthFromRect(rect), PsychGetHeightFromRect(rect), multiSample)) {
+		// Allocate framebuffer object for this Offscreen window, or recycle one from the FBO pool:
+		if (!PsychCreatePooledFBO(targetWindow, &(windowRecord->fboTable[0]), fboInternalFormat, needzbuffer, PsychGetWidthFromRect(rect), PsychGetHeightFromRect(rect), multiSample)) {
 			// Failed!
 			PsychErrorExitMsg(PsychError_user, "Creation of Offscreen window in imagingmode failed for some reason :(");
 		}
@@ -0,0 +1,134 @@
+/*
+  SCREENPredictFlip.c
+
+  AUTHORS:
+
+  agent at local                  agent
+
+  PLATFORMS:	All
+
+  HISTORY:
+
+  19.10.2026	agent	Created.
+
+  DESCRIPTION:
+
+  Predicts the earliest achievable stimulus onset of a flip from the online flip timing model
+  of a window, and controls scheduling of flips by target vblank count (MSC).
+
+  NOTES:
+
+  Be careful with length of struct field names! Only names up to 31 characters are
+  supported by Matlab 5.x (and maybe 6.x -- untested). Larger names cause matching
+  failure!
+
+*/
+
+#include "Screen.h"
+
+static char useString[] = "[predictedOnset, predictedMSC, readyTime, predictedFlipEnd, model] = Screen('PredictFlip', windowPtr [, when=0] [, scheduleByMSC]);";
+static char synopsisString[] =
+	"Predict the earliest achievable stimulus onset time for a frame submitted for flip now.\n"
+	"\n"
+	"After each completed Screen('Flip') or async flip on an onscreen window, Psychtoolbox fits "
+	"a model of the presentation timing of that window to the timestamps of the flip: The duration of "
+	"a video refresh cycle, the time spent in Flip before the bufferswap is submitted, the latency "
+	"between bufferswap completion and its detection by Flip, and - once this function was called at least "
+	"once, with the imaging pipeline enabled and GPU timer queries supported - the GPU time of the image "
+	"processing of the imaging pipeline. Where supported, e.g., on Linux with OpenML, video refresh "
+	"cycles are counted exactly via the MSC vblank count of the display, otherwise they are estimated "
+	"from the timestamps. The model needs at least two completed flips before it can make predictions.\n\n"
+	"This allows to detect a deadline miss before it happens, e.g., to drop or simplify a stimulus frame "
+	"instead of presenting it late.\n\n"
+	"\"windowPtr\" is the handle of the onscreen window.\n"
+	"\"when\" is the same deadline as in Screen('Flip'). Defaults to zero, which means 'asap'.\n"
+	"\"scheduleByMSC\" If set to 1, subsequent flips with a 'when' deadline are scheduled for the target MSC "
+	"predicted by the model, instead of a target system time. If the model predicts that the frame can't be "
+	"ready for swap in time for the deadline, the swap is scheduled for the earliest achievable vblank instead "
+	"and a predicted deadline miss is counted. Scheduling by MSC only works on systems with OpenML support, "
+	"and not with dual window stereo or multiflips. If set to 0, flips are scheduled by system time, which "
+	"is the default.\n\n"
+	"Returns the predicted stimulus onset time 'predictedOnset' and the corresponding video refresh cycle "
+	"count 'predictedMSC', or -1 if vblank counts are unsupported. 'readyTime' is the predicted time at which "
+	"the frame would be ready for swap, 'predictedFlipEnd' the predicted time at which Flip would detect the "
+	"completion of the swap. All return values are -1 if the model isn't ready for predictions yet.\n"
+	"'model' is a struct with the current parameters of the model, all durations in seconds:\n\n"
+	"Samples: Number of completed flips which contributed to the model.\n"
+	"RefreshDuration, RefreshDurationSD: Fitted duration of a video refresh cycle and its standard deviation.\n"
+	"SubmitTime, SubmitTimeSD: Fitted time spent in Flip before bufferswap submission.\n"
+	"SwapCompletionLatency, SwapCompletionLatencySD: Fitted latency of detection of bufferswap completion.\n"
+	"GPURenderTime, GPURenderTimeSD: Fitted GPU time of the imaging pipeline, zero if unknown.\n"
+	"ReferenceTime, ReferenceMSC: Onset time and MSC of the most recent completed flip, the reference of predictions.\n"
+	"PredictedMisses: Number of flips scheduled by MSC for which a deadline miss was predicted.\n"
+	"ScheduleByMSC: Current setting of 'scheduleByMSC'.\n";
+
+static char seeAlsoString[] = "OpenWindow, Flip, GetFlipInterval, GetFlipInfo";
+
+PsychError SCREENPredictFlip(void)
+{
+	const char *FieldNames[] = { "Samples", "RefreshDuration", "RefreshDurationSD", "SubmitTime", "SubmitTimeSD", "SwapCompletionLatency",
+								 "SwapCompletionLatencySD", "GPURenderTime", "GPURenderTimeSD", "ReferenceTime", "ReferenceMSC",
+								 "PredictedMisses", "ScheduleByMSC" };
+	const int fieldCount = 13;
+	PsychGenericScriptType *s;
+	PsychWindowRecordType *windowRecord;
+	PsychFlipTimingModel *model;
+	double when = 0;
+	double tReady, tOnset, tFlipEnd;
+	psych_int64 onsetMsc;
+	int scheduleByMsc;
+
+	// All subfunctions should have these two lines.
+	PsychPushHelp(useString, synopsisString, seeAlsoString);
+	if (PsychIsGiveHelp()) { PsychGiveHelp(); return(PsychError_none); };
+
+	PsychErrorExit(PsychCapNumInputArgs(3));
+	PsychErrorExit(PsychRequireNumInputArgs(1));
+	PsychErrorExit(PsychCapNumOutputArgs(5));
+
+	// Get the window record:
+	PsychAllocInWindowRecordArg(1, TRUE, &windowRecord);
+	if (windowRecord->windowType != kPsychDoubleBufferOnscreen) {
+		PsychErrorExitMsg(PsychError_user, "PredictFlip called on something else than a onscreen window with backbuffers.");
+	}
+
+	model = &(windowRecord->timingModel);
+
+	PsychCopyInDoubleArg(2, FALSE, &when);
+
+	if (PsychCopyInIntegerArg(3, FALSE, &scheduleByMsc)) {
+		if (scheduleByMsc < 0 || scheduleByMsc > 1) PsychErrorExitMsg(PsychError_user, "Invalid 'scheduleByMSC' setting provided. Must be 0 or 1.");
+		model->scheduleByMsc = (scheduleByMsc > 0) ? TRUE : FALSE;
+	}
+
+	// From now on, also fit the GPU time of the imaging pipeline:
+	model->active = TRUE;
+
+	if (!PsychPredictFlipOnset(windowRecord, when, FALSE, &tReady, &tOnset, &onsetMsc, &tFlipEnd)) {
+		// Not enough completed flips yet:
+		tReady = tOnset = tFlipEnd = -1;
+		onsetMsc = -1;
+	}
+
+	PsychCopyOutDoubleArg(1, FALSE, tOnset);
+	PsychCopyOutDoubleArg(2, FALSE, (double) onsetMsc);
+	PsychCopyOutDoubleArg(3, FALSE, tReady);
+	PsychCopyOutDoubleArg(4, FALSE, tFlipEnd);
+
+	PsychAllocOutStructArray(5, FALSE, 1, fieldCount, FieldNames, &s);
+	PsychSetStructArrayDoubleElement("Samples", 0, model->nrSamples, s);
+	PsychSetStructArrayDoubleElement("RefreshDuration", 0, model->refreshDuration, s);
+	PsychSetStructArrayDoubleElement("RefreshDurationSD", 0, sqrt(model->refreshVar), s);
+	PsychSetStructArrayDoubleElement("SubmitTime", 0, model->submitTime, s);
+	PsychSetStructArrayDoubleElement("SubmitTimeSD", 0, sqrt(model->submitTimeVar), s);
+	PsychSetStructArrayDoubleElement("SwapCompletionLatency", 0, model->swapLatency, s);
+	PsychSetStructArrayDoubleElement("SwapCompletionLatencySD", 0, sqrt(model->swapLatencyVar), s);
+	PsychSetStructArrayDoubleElement("GPURenderTime", 0, model->gpuRenderTime, s);
+	PsychSetStructArrayDoubleElement("GPURenderTimeSD", 0, sqrt(model->gpuRenderTimeVar), s);
+	PsychSetStructArrayDoubleElement("ReferenceTime", 0, model->refTime, s);
+	PsychSetStructArrayDoubleElement("ReferenceMSC", 0, (model->mscValid) ? (double) model->refMsc : -1, s);
+	PsychSetStructArrayDoubleElement("PredictedMisses", 0, model->nrPredictedMisses, s);
+	PsychSetStructArrayDoubleElement("ScheduleByMSC", 0, (model->scheduleByMsc) ? 1 : 0, s);
+
+	return(PsychError_none);
+}
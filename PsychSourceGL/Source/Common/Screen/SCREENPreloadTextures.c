@@ -17,6 +17,7 @@
 		mm/dd/yy   
  
 		12/04/05	mk		Created  							
+		10/19/26	agent	Wait for completion of pending PBO texture uploads.
 		
 	TO DO:
   
@@ -39,7 +40,10 @@ static char synopsisString[] =
 "The return value 'resident' tells you, if all requested textures could be preloaded. A value of 1 "
 "means full success. The 'texidresident' vector tells you for each texture, if that "
 "specific texture could be preloaded. Preloading requested textures can fail if your gfx-hardware "
-"has an insufficient amount of free VRAM memory. ";
+"has an insufficient amount of free VRAM memory. "
+"If texture uploads via pixel buffer objects are enabled via Screen('Preference', 'ConserveVRAM'), "
+"see 'help ConserveVRAMSettings', then this function also waits for completion of all pending "
+"uploads of the requested textures, so you can use it at the end of an inter-trial interval. ";
 
 static char seeAlsoString[] = "MakeTexture DrawTexture GetMovieImage";	 
 
@@ -104,6 +108,8 @@ PsychError SCREENPreloadTextures(void)
             for(i=0; i<numWindows; i++) {                
                 if (windowRecordArray[i]->windowType==kPsychTexture) {
                     n++;
+                    // Retire pending PBO upload, if any. Our glFinish() below waits for its completion:
+                    PsychWaitForPendingTextureUpload(windowRecordArray[i], FALSE);
                     // Prioritize this texture:
                     glPrioritizeTextures(1, (GLuint*) &(windowRecordArray[i]->textureNumber), &maxprio);
                     // Bind this texture:
@@ -139,6 +145,8 @@ PsychError SCREENPreloadTextures(void)
                 texwin = NULL;
                 if (IsWindowIndex(myhandle)) FindWindowRecord(myhandle, &texwin);
                 if (texwin && texwin->windowType==kPsychTexture) {
+                    // Retire pending PBO upload, if any. Our glFinish() below waits for its completion:
+                    PsychWaitForPendingTextureUpload(texwin, FALSE);
                     // Prioritize this texture:
                     glPrioritizeTextures(1, (GLuint*) &(texwin->textureNumber), &maxprio);
                     // Bind this texture:
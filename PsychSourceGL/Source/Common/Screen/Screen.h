@@ -233,10 +233,14 @@ PsychError	SCREENGetMouseHelper(void);
 PsychError	SCREENResolution(void);
 PsychError	SCREENResolutions(void);
 PsychError	SCREENWaitUntilAsyncFlipCertain(void);
+PsychError	SCREENAsyncFlipEnqueue(void);
+PsychError	SCREENAsyncFlipQueueResults(void);
+PsychError	SCREENFlipGroup(void);
 PsychError	SCREENCreateMovie(void);
 PsychError	SCREENFinalizeMovie(void);
 PsychError      SCREENAddAudioBufferToMovie(void);
 PsychError      SCREENGetFlipInfo(void);
+PsychError      SCREENPredictFlip(void);
 PsychError      SCREENConfigureDisplay(void);
 
 //PsychError SCREENSetGLSynchronous(void);		//SCREENSetGLSynchronous.c
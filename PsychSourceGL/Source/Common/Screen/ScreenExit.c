@@ -15,6 +15,7 @@
 		12/20/01	awi		Created.
 		1/25/04		awi		Added update provided by mk. It makes the ScreenCloseAllWindows call.  
                 7/22/05         mk              Added call to CloseWindowBank() to free dynamic window bank array.
+		10/19/26	agent	Release GLSL program binary cache.
 	DESCRIPTION:
 	
 		ScreenExitFunction is called before the Screen module is flushed.
@@ -55,6 +56,9 @@ PsychError ScreenExitFunction(void)
 	// This is defined in Common/Screen/SCREENFillPoly.c
 	PsychCleanupSCREENFillPoly();
 
+	// Release in-memory cache of GLSL program binaries:
+	PsychFreeGLSLProgramCache();
+
 	// Release our internal locale object for character <-> unicode conversion:
 	PsychSetUnicodeTextConversionLocale(NULL);
 
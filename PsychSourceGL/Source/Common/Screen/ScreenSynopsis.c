@@ -136,7 +136,11 @@ void InitializeSynopsis()
 	synopsis[i++] = "[VBLTimestamp StimulusOnsetTime FlipTimestamp Missed Beampos] = Screen('AsyncFlipEnd', windowPtr);";
 	synopsis[i++] = "[VBLTimestamp StimulusOnsetTime FlipTimestamp Missed Beampos] = Screen('AsyncFlipCheckEnd', windowPtr);";
 	synopsis[i++] = "[VBLTimestamp StimulusOnsetTime swapCertainTime] = Screen('WaitUntilAsyncFlipCertain', windowPtr);";
-	synopsis[i++] = "[info] = Screen('GetFlipInfo', windowPtr [, infoType=0] [, auxArg1]);";
+	synopsis[i++] = "[flipId, pendingFlips] = Screen('AsyncFlipEnqueue', windowPtr [, when] [, dontclear] [, dontsync]);";
+	synopsis[i++] = "[results, pendingFlips] = Screen('AsyncFlipQueueResults', windowPtr [, waitForAll=0]);";
+	synopsis[i++] = "[results, skew] = Screen('FlipGroup', windowPtrs [, when] [, dontclear] [, dontsync]);";
+	synopsis[i++] = "[info, droppedCount] = Screen('GetFlipInfo', windowPtr [, infoType=0] [, auxArg1]);";
+	synopsis[i++] = "[predictedOnset, predictedMSC, readyTime, predictedFlipEnd, model] = Screen('PredictFlip', windowPtr [, when=0] [, scheduleByMSC]);";
 	synopsis[i++] = "[telapsed] = Screen('DrawingFinished', windowPtr [, dontclear] [, sync]);";
 	synopsis[i++] = "framesSinceLastWait = Screen('WaitBlanking', windowPtr [, waitFrames]);";
 
@@ -247,6 +247,10 @@ typedef struct {
 // by default on GPU's which support it:
 #define kPsychDontAutoEnableImagingPipeline (1 << 24)
 
+// Upload texture content via a ring of pixel buffer objects in PsychCreateTexture(),
+// instead of directly from system memory:
+#define kPsychUsePBOTextureUploads (1 << 25)
+
 //function protoptypes
 
 //Accessors for PsychDepthType 
@@ -94,6 +94,7 @@ TO DO:
 #define kPsychGfxCapSNTex16		32768		// Hw supports 16 bit signed normalized integer textures.
 #define kPsychGfxCapUYVYTexture         65536		// Hw supports UYVY encoded textures. Used for GStreamer video capture/playback engine optimizations.
 #define kPsychGfxCapNativeStereo        (1 << 17)       // Hw supports native OpenGL quad-buffered stereo (frame-sequential etc.).
+#define kPsychGfxCapProgramBinary       (1 << 18)       // Hw supports retrieval and loading of linked GLSL program binaries, aka ARB_get_program_binary.
 
 // Definition of flags for imagingMode of Image processing pipeline.
 // These are used internally, but need to be exposed to Matlab as well.
@@ -139,6 +140,32 @@ TO DO:
 // The following numbers are allocated to specialFlags flag above: A (S) means, shared with imagingMode:
 // 1,2,4,8,16,32,64,1024,S-2048,S-8192, 32768, S-65536. --> Flags of 2^17 and higher are available, as well as 128,256,512,4096, 16384
 
+// Parameters of a hook function, preparsed from its pString1 by the hook chain plan compiler:
+#define kPsychMaxHookSlotTextures	8
+#define kPsychMaxFuseNameLength		64
+
+typedef struct PsychHookSlotParams {
+	psych_bool				valid;			// TRUE if all parameters below are parsed. FALSE means: Parse pString1 at execution time.
+	void*					blitter;		// PsychBlitterFunc selected via "Blitter:" spec, NULL if none selected.
+	int						numTextures;	// Number of "TEXTURExx(unit)=texid" bindings:
+	GLenum					texTarget[kPsychMaxHookSlotTextures];
+	int						texUnit[kPsychMaxHookSlotTextures];
+	GLuint					texId[kPsychMaxHookSlotTextures];
+	psych_bool				ovrSize;		// "OvrSize:w:h" given?
+	int						ovrWidth;
+	int						ovrHeight;
+	int						offsetX;		// "Offset:x:y"
+	int						offsetY;
+	float					scaleX;			// "Scaling:sx:sy"
+	float					scaleY;
+	psych_bool				bilinear;		// "Bilinear" filtering requested?
+	GLuint					displayList;	// "Handle:id" of display list for DisplayListBlit, zero if none.
+	int						scissor[4];		// x:y:w:h of Builtin:RestrictToScissorROI.
+	int						xPosition;		// T-Lock line position of Builtin:RenderClutBits++.
+	int						yPosition;
+	char					fuseEntry[kPsychMaxFuseNameLength];	// Name of per-pixel entry function for shader fusion, given via "Fusable:name". Empty if not fusable.
+} PsychHookSlotParams;
+
 // Definition of a single hook function spec:
 typedef struct PsychHookFunction*	PtrPsychHookFunction;
 typedef struct PsychHookFunction {
@@ -149,8 +176,65 @@ typedef struct PsychHookFunction {
 	void*					cprocfunc;
 	unsigned int			shaderid;
 	unsigned int			luttexid1;
+	PsychHookSlotParams		params;			// Preparsed pString1, hook functions are immutable after creation.
 } PsychHookFunction;
 
+// Opcodes of the operations of a compiled hook chain execution plan:
+#define kPsychPlanOpSlot			0	// Execute slot via PsychPipelineExecuteHookSlot().
+#define kPsychPlanOpShader			1	// Execute GLSL shader slot via blitter.
+#define kPsychPlanOpFlipFBOs		2	// Builtin:FlipFBOs ping-pong buffer swap.
+#define kPsychPlanOpScissorROI		3	// Builtin:RestrictToScissorROI.
+
+// Uniform of a shader slot which got fused into a fused shader, whose value is copied over on each execution:
+typedef struct PsychFusedUniform {
+	GLuint					srcProgram;		// GLSL program of the original shader slot.
+	GLint					srcLocation;	// Location of uniform in srcProgram.
+	GLint					dstLocation;	// Location of renamed uniform in the fused program.
+	int						kind;			// Value type and size, as returned by PsychPipelineFusedUniformKind().
+} PsychFusedUniform;
+
+// One operation of a compiled hook chain execution plan:
+typedef struct PsychHookPlanOp {
+	PtrPsychHookFunction	hookfunc;		// Hook slot this operation was compiled from, or fusedHook.
+	int						opcode;			// kPsychPlanOpXXX.
+	psych_bool				keepState;		// Shader op: Next op is a shader op with identical texture bindings, so keep them bound.
+	psych_bool				stateKept;		// Shader op: Previous op kept its texture bindings for us.
+	PtrPsychHookFunction	fusedHook;		// Shader op: Synthetic slot with the fused shader of multiple shader slots, owned by the plan. NULL if not fused.
+	int						numFused;		// Number of shader slots fused into fusedHook.
+	int						numFusedUniforms;
+	PsychFusedUniform*		fusedUniforms;	// Uniforms to copy from the original slot shaders into fusedHook's shader.
+} PsychHookPlanOp;
+
+// Compiled execution plan of a hook chain: A flat array of operations, one per slot.
+typedef struct PsychHookPlan {
+	int						numOps;
+	int						numPingPongs;	// Number of Builtin:FlipFBOs ops in chain.
+	PsychHookPlanOp*		ops;
+} PsychHookPlan;
+
+// Number of pixels of a Bits++ T-Lock CLUT line: 12 pixels unlock key, then 256 entries encoded in 2 pixels each:
+#define kPsychTLockPixels	(12 + 2 * 256)
+
+// Cache of the CLUT last encoded by the CLUT encoding builtins of the imaging pipeline. Each new CLUT
+// gets compared against the cached one, so the encoders only need to update the changed entries:
+typedef struct PsychClutCache {
+	int						size;				// Number of entries in rgb, zero if cache is empty.
+	float*					rgb;				// Interleaved red, green, blue values of the cached CLUT.
+	unsigned int			generation;			// Incremented whenever the cached CLUT changes.
+	int						firstChanged;		// Range of entries which changed with the last increment of generation.
+	int						lastChanged;
+	unsigned int			tlockGeneration;	// Generation of the CLUT encoded in the Bits++ T-Lock line, zero if none encoded yet.
+	int						tlockX;				// Position of the T-Lock line in tlockVertices.
+	int						tlockY;
+	GLint					tlockVertices[kPsychTLockPixels * 2];
+	GLubyte					tlockColors[kPsychTLockPixels * 3];
+	GLuint					tlockVBO;			// VBO with tlockVertices followed by tlockColors, zero if VBO's are unsupported.
+	unsigned int			runtimeGeneration;	// Generation of the CLUT encoded in runtimeCmd, zero if none encoded yet.
+	char*					runtimeCmd;			// Command string of Builtin:RenderClutViaRuntime with the encoded CLUT.
+	int						runtimePrefixLength;	// Length of the hook slots command prefix in runtimeCmd.
+	int						runtimeEntries;		// Number of CLUT entries encoded in runtimeCmd.
+} PsychClutCache;
+
 // Definition of an OpenGL Framebuffer object (FBO) for internal use.
 typedef struct PsychFBO {
 	GLuint					fboid;		// Handle to FBO.
@@ -160,10 +244,44 @@ typedef struct PsychFBO {
 	int						width;		// Width of FBO.
 	int						height;		// Height of FBO.
 	int						multisample; // Multisampling level of FBO: 0 == No multisampling. > 0 means Multisampled.
+	GLenum					format;		// Internal format of color buffer if created by PsychCreateFBO(), zero if color buffer is owned by someone else.
 } PsychFBO;
 
 // Typedefs for WindowRecord in WindowBank.h
 
+// Maximum number of flips which can be queued for an onscreen window via Screen('AsyncFlipEnqueue'):
+#define kPsychMaxFlipQueueDepth 16
+
+// Number of values per flip in the results of Screen('AsyncFlipQueueResults'):
+#define kPsychFlipQueueResultColumns 6
+
+// One queued flip: The final stimulus image, the parameters of its flip and the results after execution:
+typedef struct PsychFlipQueueEntry {
+	PsychFBO*				fbo;				// Color buffer with the final stimulus image. Allocated on first use of the entry.
+	GLsync					fence;				// Fence for completion of the rendering into fbo, or NULL if rendering was finished via glFinish().
+	int						vbl_synclevel;
+	double					flipwhen;
+	int						beamPosAtFlip;
+	double					miss_estimate;
+	double					time_at_flipend;
+	double					time_at_onset;
+	double					vbl_timestamp;
+} PsychFlipQueueEntry;
+
+// Lock-free single producer, single consumer ring of queued flips: The masterthread enqueues at 'head',
+// the flipper thread executes at 'tail'. Both are running counts, the entry index is count modulo queue depth:
+typedef struct PsychFlipQueue {
+	PsychFlipQueueEntry		entries[kPsychMaxFlipQueueDepth];
+	volatile unsigned int	head;				// Number of flips enqueued so far. Only written by the masterthread.
+	volatile unsigned int	tail;				// Number of flips executed so far. Only written by the flipper thread.
+	unsigned int			collected;			// Number of executed flips whose results were moved into 'results'.
+	PsychFBO*				sysfbo;				// Pseudo-FBO of the system framebuffer, target of the final image in non-queued operation.
+	GLenum					fboFormat;			// Internal format of the entries color buffers.
+	double*					results;			// Uncollected results of executed flips, kPsychFlipQueueResultColumns values per flip.
+	int						resultCount;		// Number of flips in 'results'.
+	int						resultCapacity;		// Number of flips for which 'results' is allocated.
+} PsychFlipQueue;
+
 // This support structure for async flips is supported on all non-Windows platforms, aka all Unix platforms:
 // It gets attached to the asyncFlipInfo* of a windowRecord whenever async flips are used.
 typedef struct PsychFlipInfoStruct {
@@ -185,8 +303,50 @@ typedef struct PsychFlipInfoStruct {
 	psych_thread			flipperThread;		// Thread handle for background flipping thread.
 	psych_mutex				performFlipLock;	// Primary lock.
 	psych_condition			flipperGoGoGo;		// Signalling condition variable to trigger execution of a flip request by the flipper thread.
+	PsychFlipQueue*			flipQueue;			// Queue of flips for Screen('AsyncFlipEnqueue'), NULL if flip queueing isn't used.
 } PsychFlipInfoStruct;
 
+// Number of values per completed swap in the swap log of Screen('GetFlipInfo'):
+#define kPsychSwapLogColumns 12
+
+// Lock-free single producer, single consumer log of completed swaps: The thread which executes a flip, masterthread
+// or flipper thread, appends at 'head', the masterthread fetches at 'tail'. Both are running counts, the record index
+// is count modulo capacity. Records are never overwritten: If the log is full, new records are dropped and counted:
+typedef struct PsychSwapLog {
+	double*					records;			// Preallocated storage for 'capacity' records of kPsychSwapLogColumns values.
+	unsigned int			capacity;			// Maximum number of records not yet fetched.
+	volatile unsigned int	head;				// Number of records appended so far. Only written by the flipping thread.
+	volatile unsigned int	tail;				// Number of records fetched so far. Only written by the masterthread.
+	volatile unsigned int	dropped;			// Number of records dropped due to a full log. Only written by the flipping thread.
+	unsigned int			droppedFetched;		// Value of 'dropped' at the last fetch. Only written by the masterthread.
+	volatile psych_bool		enabled;			// Logging enabled?
+} PsychSwapLog;
+
+// Online model of the presentation timing of an onscreen window: Fitted by PsychFlipWindowBuffers() to each completed
+// flip, used for prediction of achievable stimulus onset times by Screen('PredictFlip') and for scheduling of flips by MSC:
+typedef struct PsychFlipTimingModel {
+	int						nrSamples;			// Number of completed flips which contributed to the model.
+	int						nrGPUSamples;		// Number of GPU rendertime measurements which contributed to the model.
+	int						nrRejected;			// Number of consecutive refresh duration samples rejected as outliers.
+	int						nrPredictedMisses;	// Number of flips for which a deadline miss was predicted at swap scheduling time.
+	double					refreshFrames;		// Number of refresh cycles which contributed to the refresh duration fit.
+	psych_bool				active;				// TRUE once Screen('PredictFlip') was used: Enables GPU rendertime measurements.
+	psych_bool				scheduleByMsc;		// TRUE = Schedule flips with a 'when' deadline for a target MSC predicted by the model.
+	psych_bool				mscValid;			// TRUE if refMsc is a vblank count reported by the OS, FALSE if it is only counted by us.
+	psych_int64				refMsc;				// Vblank count of the most recent completed swap.
+	double					refTime;			// Onset timestamp of the most recent completed swap, zero if none.
+	double					refreshDuration;	// Fitted duration of a video refresh cycle.
+	double					refreshVar;
+	double					swapLatency;		// Fitted latency from swap completion until Flip detects the completion.
+	double					swapLatencyVar;
+	double					submitTime;			// Fitted time spent in Flip before swap submission: Preflip operations, flushes etc.
+	double					submitTimeVar;
+	double					gpuRenderTime;		// Fitted GPU time of the preflip operations of the imaging pipeline, zero if unknown.
+	double					gpuRenderTimeVar;
+	GLuint					gpuQuery;			// GL_TIME_ELAPSED_EXT query object for measurement of gpuRenderTime, zero if none.
+	int						gpuQueryState;		// 0 = No measurement pending, 1 = gpuQuery started, 2 = gpuQuery ended, result not yet collected, -1 = Unsupported.
+} PsychFlipTimingModel;
+
 
 #if PSYCH_SYSTEM == PSYCH_OSX
 // Definition of OS-X core graphics and Core OpenGL handles:
@@ -284,6 +444,7 @@ typedef struct _PsychWindowRecordType_{
 		GLint				textureLookupShader;	// Optional GLSL handle for nearest neighbour texture drawing shader.
 		GLint				textureByteAligned;		// 0 = No knowledge about byte alignment of texture data. > 1, texture rows are x byte aligned.
 		GLint				texturePlanarShader[4]; // Optional GLSL program handles for shaders to apply to planar storage textures - 4 handles for 4 possible channel counts.
+		GLsync				textureUploadFence;		// Fence of a pending asynchronous PBO texture upload, NULL if none is pending.
 
 	//line stipple attributes, for windows not textures.
 	GLushort				stipplePattern;
@@ -325,6 +486,8 @@ typedef struct _PsychWindowRecordType_{
 		psych_int64								reference_sbc;			// SBC reference swapbuffers count from OpenML. (Optional)
 		psych_int64								target_sbc;				// Target SBC value for next glXWaitForSbcOML() call from OpenML. (Optional)
 		psych_int64								lastSwaptarget_msc;		// Target MSC value for which most recent swap was scheduled by DRM/DRI2 from OpenML. (Optional)
+		PsychFlipTimingModel					timingModel;			// Online model of presentation timing, see PsychUpdateFlipTimingModel().
+		PsychSwapLog*							swapLog;				// Log of completed swaps for Screen('GetFlipInfo'), NULL if logging never enabled.
 		
 	// Pointers to temporary arrays with gamma tables to upload to the gfx-card at next Screen('Flip'):
 	// They default to NULL and get possibly set in Screen('LoadNormalizedGammaTable'):
@@ -333,6 +496,7 @@ typedef struct _PsychWindowRecordType_{
 	float* inBlueTable;
 	int    inTableSize;					// Number of slots in the LUT tables.
 	int    loadGammaTableOnNextFlip;	// Type of upload operation: 0 = None, 1 = Load on next Flip via OS gamma table routines, then reset flag.
+	PsychClutCache clutCache;			// Last CLUT encoded by the imaging pipelines CLUT encoding builtins, and its encodings.
 	
 	// Settings for the image processing and hook callback pipeline: See PsychImagingPipelineSupport.hc for definition and implementation:
 	double					colorRange;								// Maximum allowable color component value. See SCREENColorRange.c for explanation.
@@ -342,6 +506,7 @@ typedef struct _PsychWindowRecordType_{
 	double					clearColor[4];							// Window clear color (as GL double vector) to use in PsychGLClear();
 	int						imagingMode;							// Master mode switch for imaging and callback hook pipeline.
 	PtrPsychHookFunction	HookChain[MAX_SCREEN_HOOKS];			// Array of pointers to the hook-chains for different hooks.
+	PsychHookPlan*			HookChainPlan[MAX_SCREEN_HOOKS];		// Compiled execution plans of the hook-chains, NULL if not yet compiled or invalidated.
 	psych_bool					HookChainEnabled[MAX_SCREEN_HOOKS];		// Array of Booleans to en-/disable single chains temporarily.
 
 	// Indices into our FBO table: The special value -1 means: Don't use.
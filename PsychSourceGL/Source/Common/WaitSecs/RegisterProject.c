@@ -34,6 +34,7 @@ PsychError PsychModuleInit(void)
 	// Wait until specific deadline:
 	PsychErrorExit(PsychRegister("UntilTime", &WAITSECSWaitUntilSecs));
 	PsychErrorExit(PsychRegister("YieldSecs", &WAITSECSYieldSecs));
+	PsychErrorExit(PsychRegister("WakeupStatistics", &WAITSECSWakeupStatistics));
 	
 	//report the version
 	PsychErrorExit(PsychRegister("Version", &MODULEVersion));
@@ -16,6 +16,7 @@
 		4/6/05			awi		Use mach_wait_until() instead of looping.  Mario's suggestion.  
 		4/7/05			awi		Relocate mach_wait_until() call within PsychWaitIntervalSeconds().
 		1/2/08			mk		Add subfunction for waiting until absolute time, and return of wakeup time. 
+		10/19/26		agent	Add 'WakeupStatistics' subfunction.
 		
 
 	NOTES: 
@@ -46,6 +47,7 @@ void WAITSECSSynopsis(void)
 	printf("[realWakeupTimeSecs] = WaitSecs(waitPeriodSecs);              -- Wait for at least 'waitPeriodSecs' seconds. Try to be precise.\n");
 	printf("[realWakeupTimeSecs] = WaitSecs('UntilTime', whenSecs);       -- Wait until at least time 'whenSecs'.\n");
 	printf("[realWakeupTimeSecs] = WaitSecs('YieldSecs', waitPeriodSecs); -- Wait for at least 'waitPeriodSecs' seconds. Be more sloppy.\n");
+	printf("stats = WaitSecs('WakeupStatistics' [, reset=0]);             -- Return histograms of wakeup errors of waits. Linux only.\n");
 	printf("\nThe optional 'realWakeupTimeSecs' is the real system time when WaitSecs finished waiting,\n");
 	printf("just as if you'd call realWakeupTimeSecs = GetSecs; after calling WaitSecs. This for your\n");
 	printf("convenience and to reduce call overhead and drift a bit for this common combo of commands.\n\n");
@@ -154,3 +156,67 @@ PsychError WAITSECSYieldSecs(void)
 
     return(PsychError_none);	
 }
+
+PsychError WAITSECSWakeupStatistics(void)
+{
+    static char useString[] = "stats = WaitSecs('WakeupStatistics' [, reset=0]);";
+    //                         1                                     1
+    static char synopsisString[] = 
+    "Return a struct 'stats' with statistics about the accuracy of all waits performed by WaitSecs so far. "
+    "This is currently only supported on Linux.\n"
+    "If the optional 'reset' flag is set to 1, all statistics are reset to zero after returning them.\n"
+    "Waits are performed by sleeping until shortly before the deadline, then busy-waiting for the remaining "
+    "'SpinWindow' seconds. The spin window adapts to the observed wakeup latencies of the sleeps.\n"
+    "The struct contains the following fields:\n"
+    "'NumWaits' Total number of waits.\n"
+    "'NumMisses' Number of waits which returned more than 0.1 msecs after their deadline.\n"
+    "'SpinWindow' Current spin window in seconds.\n"
+    "'BinEdges' Vector with the lower edges of the histogram bins in seconds. The last bin counts all "
+    "values of at least the last edge.\n"
+    "'WakeupErrorHistogram' Histogram of wakeup errors, ie. how late the waits returned after their deadline.\n"
+    "'SleepLatencyHistogram' Histogram of wakeup latencies of the sleeps, ie. how late the operating system "
+    "woke up the sleeping thread.\n";
+    static char seeAlsoString[] = "";
+
+    const char *FieldNames[] = { "NumWaits", "NumMisses", "SpinWindow", "BinEdges", "WakeupErrorHistogram", "SleepLatencyHistogram" };
+    PsychGenericScriptType *s;
+    int reset = 0;
+
+    //all sub functions should have these two lines
+    PsychPushHelp(useString, synopsisString,seeAlsoString);
+    if(PsychIsGiveHelp()){PsychGiveHelp();return(PsychError_none);};
+
+    //check to see if the user supplied superfluous arguments
+    PsychErrorExit(PsychCapNumOutputArgs(1));
+    PsychErrorExit(PsychCapNumInputArgs(1));
+
+    PsychCopyInIntegerArg(1, FALSE, &reset);
+
+    #if PSYCH_SYSTEM == PSYCH_LINUX
+    {
+        PsychGenericScriptType *binEdgesMat, *wakeupMat, *sleepMat;
+        double *binEdges, *wakeupErrors, *sleepLatencies;
+        double numWaits, numMisses, spinWindow;
+
+        PsychAllocOutStructArray(1, FALSE, -1, 6, FieldNames, &s);
+        PsychAllocateNativeDoubleMat(1, PSYCH_WAIT_HISTOBINS, 1, &binEdges, &binEdgesMat);
+        PsychAllocateNativeDoubleMat(1, PSYCH_WAIT_HISTOBINS, 1, &wakeupErrors, &wakeupMat);
+        PsychAllocateNativeDoubleMat(1, PSYCH_WAIT_HISTOBINS, 1, &sleepLatencies, &sleepMat);
+
+        PsychOSGetWaitStatistics(binEdges, wakeupErrors, sleepLatencies, &numWaits, &numMisses, &spinWindow, (reset > 0) ? TRUE : FALSE);
+
+        PsychSetStructArrayDoubleElement("NumWaits", 0, numWaits, s);
+        PsychSetStructArrayDoubleElement("NumMisses", 0, numMisses, s);
+        PsychSetStructArrayDoubleElement("SpinWindow", 0, spinWindow, s);
+        PsychSetStructArrayNativeElement("BinEdges", 0, binEdgesMat, s);
+        PsychSetStructArrayNativeElement("WakeupErrorHistogram", 0, wakeupMat, s);
+        PsychSetStructArrayNativeElement("SleepLatencyHistogram", 0, sleepMat, s);
+    }
+    #else
+        (void) s;
+        (void) FieldNames;
+        PsychErrorExitMsg(PsychError_unimplemented, "Sorry, wakeup statistics are only supported on Linux.");
+    #endif
+
+    return(PsychError_none);
+}
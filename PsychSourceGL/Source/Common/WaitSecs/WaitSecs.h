@@ -28,6 +28,7 @@ PsychError MODULEVersion(void);			//MODULEVersion.c
 PsychError WAITSECSWaitSecs(void);
 PsychError WAITSECSWaitUntilSecs(void);
 PsychError WAITSECSYieldSecs(void);
+PsychError WAITSECSWakeupStatistics(void);
 
 //end include once
 #endif
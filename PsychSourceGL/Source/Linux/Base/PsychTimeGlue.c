@@ -15,6 +15,9 @@
 
   	2/20/06       mk		Wrote it. Derived from Windows version.  
 1/03/09		  mk		Add generic Mutex locking support as service to ptb modules. Add PsychYieldIntervalSeconds().
+10/19/26	  agent	Selectable clock sources: clock_gettime() CLOCK_REALTIME by default, optionally
+						CLOCK_MONOTONIC_RAW or invariant TSC, calibrated against CLOCK_REALTIME.
+10/19/26	  agent	Adaptive per-thread spin window for PsychWaitUntilSeconds(), wakeup statistics.
 
   	DESCRIPTION:
 	
@@ -32,6 +35,13 @@
 #include <time.h>
 #include <errno.h>
 #include <sched.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+#ifndef CLOCK_MONOTONIC_RAW
+#define CLOCK_MONOTONIC_RAW 4
+#endif
 
 /*
  *		file local state variables
@@ -44,12 +54,386 @@ static double	        kernelTimebaseFrequencyHz;
 static double           sleepwait_threshold = 0.01;
 static double		clockinc = 0;
 
+/* Clock sources for PsychGetPrecisionTimerSeconds(), selectable via the environment
+ * variable PSYCHTOOLBOX_CLOCKSOURCE:
+ *
+ * "gettimeofday" - Legacy gettimeofday(), microsecond resolution.
+ * "realtime"     - clock_gettime(CLOCK_REALTIME) via the vDSO, nanosecond resolution. The default.
+ * "monotonicraw" - clock_gettime(CLOCK_MONOTONIC_RAW), not subject to NTP slewing.
+ * "tsc"          - The processors invariant timestamp counter, read via rdtsc, if available.
+ *
+ * All sources report time in the CLOCK_REALTIME aka gettimeofday() timebase which is used
+ * everywhere else in PTB, e.g., for clock_nanosleep(), pthread_cond_timedwait() and
+ * PsychOSMonotonicToRefTime(). The "monotonicraw" and "tsc" sources get mapped to it via one
+ * global offset, calibrated against CLOCK_REALTIME once at clock source selection time, so
+ * timestamps taken by different threads, e.g., audio or flipper threads, are comparable and
+ * the clock never steps backwards. The price is that these sources don't follow later NTP
+ * adjustments of CLOCK_REALTIME, ie. they can drift away from it by up to 0.5 msecs per second
+ * while NTP slews the clock. Therefore deadlines for sleeps in CLOCK_REALTIME, ie. for
+ * clock_nanosleep() and pthread_cond_timedwait(), get converted from our clock into the
+ * CLOCK_REALTIME domain right before each sleep, via PsychClockToRealtime(), so sleeps end
+ * on time even after hours of drift. Selection happens exactly once, protected by pthread_once().
+ */
+#define PSYCH_CLOCK_GETTIMEOFDAY	0
+#define PSYCH_CLOCK_REALTIME		1
+#define PSYCH_CLOCK_MONOTONICRAW	2
+#define PSYCH_CLOCK_TSC				3
+
+static const char*	clockSourceNames[] = { "gettimeofday", "realtime", "monotonicraw", "tsc" };
+static int			clocksource = -1;
+static double		clockOverhead = 0;
+static double		clockOffsetUncertainty = 0;
+static double		tscTicksPerSecond = 0;
+static double		tscFrequencyErrorPPM = 0;
+static psych_uint64	tscBase = 0;
+static double		clockOffset = 0;
+static pthread_once_t	clockSourceOnce = PTHREAD_ONCE_INIT;
+
+/* Adaptive hybrid sleep/spin waiting for PsychWaitUntilSeconds():
+ *
+ * A wait sleeps via clock_nanosleep() until 'spinWindow' seconds before the deadline, then
+ * busy-waits for the remainder. Each thread has its own spin window, as the wakeup latencies
+ * of, e.g., a realtime priority flipper or audio thread are very different from the ones of
+ * a normal priority thread, and one bad episode of one thread shouldn't penalize all others.
+ *
+ * The wakeup latency of each sleep, ie. how late clock_nanosleep() returned, gets recorded in
+ * a per-thread ring buffer of the last PSYCH_WAKEUP_SAMPLES sleeps. Every 16 sleeps the spin
+ * window is set to the 99th percentile of these latencies plus a safety margin, so it grows
+ * after bad episodes, and decays back down once they are over. A missed deadline grows it
+ * immediately.
+ *
+ * Wakeup errors of all waits, ie. how late PsychWaitUntilSeconds() returned, and the latencies
+ * of all sleeps get accumulated in histograms over all threads of a module, which can be
+ * retrieved via PsychOSGetWaitStatistics().
+ */
+#define PSYCH_WAKEUP_SAMPLES 128
+
+typedef struct PsychWaitState {
+	double			spinWindow;						// Current spin window in seconds, zero if uninitialized.
+	double			latency[PSYCH_WAKEUP_SAMPLES];	// Ring buffer of recent sleep wakeup latencies.
+	int				count;							// Number of valid samples in latency[].
+	int				next;							// Next slot in latency[] to write.
+	int				sleeps;							// Number of sleeps since last spin window update.
+	unsigned int	missed_count;					// Number of consecutive missed deadlines.
+} PsychWaitState;
+
+static __thread PsychWaitState waitState;
+
+static const double	waitHistoBinEdges[PSYCH_WAIT_HISTOBINS] = { 0, 1e-6, 2e-6, 5e-6, 1e-5, 2e-5, 5e-5, 1e-4, 2e-4, 5e-4, 1e-3, 2e-3, 5e-3, 1e-2 };
+static unsigned int	wakeupErrorHisto[PSYCH_WAIT_HISTOBINS];
+static unsigned int	sleepLatencyHisto[PSYCH_WAIT_HISTOBINS];
+static unsigned int	waitCount = 0;
+static unsigned int	waitMissCount = 0;
+
+// Per-thread state for the monotonicity check:
+static __thread double	threadOldSecs = -1;
+
+static double PsychGetMinSpinWindow(void);
+
+#if defined(__i386__) || defined(__x86_64__)
+static inline psych_uint64 PsychReadTSC(void)
+{
+	unsigned int lo, hi;
+	__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+	return(((psych_uint64) hi << 32) | (psych_uint64) lo);
+}
+
+// Check for an invariant TSC, ie. one which runs at constant rate regardless of
+// power management states and is synchronized across all processor cores:
+static psych_bool PsychHasInvariantTSC(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) || (eax < 0x80000007)) return(FALSE);
+	if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) return(FALSE);
+	return((edx & (1 << 8)) ? TRUE : FALSE);
+}
+#else
+static inline psych_uint64 PsychReadTSC(void)
+{
+	return(0);
+}
+
+static psych_bool PsychHasInvariantTSC(void)
+{
+	return(FALSE);
+}
+#endif
+
+static double PsychReadPosixClock(clockid_t clock)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return((double) ts.tv_sec + ((double) ts.tv_nsec / 1e9));
+}
+
+// Read uncalibrated time in seconds of calibrated clock source 'source':
+static double PsychReadRawClock(int source)
+{
+	if (source == PSYCH_CLOCK_TSC) return((double) (PsychReadTSC() - tscBase) / tscTicksPerSecond);
+	return(PsychReadPosixClock(CLOCK_MONOTONIC_RAW));
+}
+
+// Calibrate offset from raw clock time to CLOCK_REALTIME: Take 'samples' reads of CLOCK_REALTIME,
+// each bracketed by two raw clock reads, and use the one with the tightest bracket. Returns the
+// uncertainty of the offset in seconds, which is half of that bracket:
+static double PsychCalibrateClockOffset(int source, int samples, double* offset)
+{
+	double r1, r2, t, uncertainty = -1;
+
+	while (samples-- > 0) {
+		r1 = PsychReadRawClock(source);
+		t  = PsychReadPosixClock(CLOCK_REALTIME);
+		r2 = PsychReadRawClock(source);
+		if ((uncertainty < 0) || ((r2 - r1) / 2 < uncertainty)) {
+			uncertainty = (r2 - r1) / 2;
+			*offset = t - (r1 + r2) / 2;
+		}
+	}
+
+	return(uncertainty);
+}
+
+// Measure TSC frequency against CLOCK_MONOTONIC_RAW over two consecutive intervals of
+// 'interval' seconds each. Returns the mean frequency and the relative difference between
+// both measurements in ppm as an estimate of the calibration error:
+static double PsychCalibrateTSC(double interval, double* errorPPM)
+{
+	psych_uint64 tsc[3];
+	double t[3], f1, f2;
+	struct timespec rqtp;
+	int i;
+
+	rqtp.tv_sec = 0;
+	rqtp.tv_nsec = (long) (interval * 1e9);
+
+	for (i = 0; i < 3; i++) {
+		if (i > 0) nanosleep(&rqtp, NULL);
+		t[i] = PsychReadPosixClock(CLOCK_MONOTONIC_RAW);
+		tsc[i] = PsychReadTSC();
+		t[i] = (t[i] + PsychReadPosixClock(CLOCK_MONOTONIC_RAW)) / 2;
+	}
+
+	f1 = (double) (tsc[1] - tsc[0]) / (t[1] - t[0]);
+	f2 = (double) (tsc[2] - tsc[1]) / (t[2] - t[1]);
+	*errorPPM = fabs(f1 - f2) / ((f1 + f2) / 2) * 1e6;
+
+	return((double) (tsc[2] - tsc[0]) / (t[2] - t[0]));
+}
+
+// Read current time in seconds of the selected clock source, in CLOCK_REALTIME timebase:
+static double PsychReadClock(void)
+{
+	struct timespec ts;
+	struct timeval tv;
+
+	switch (clocksource) {
+		case PSYCH_CLOCK_GETTIMEOFDAY:
+			// Legacy gettimeofday() - It works with microsecond resolution and is implemented
+			// via the highest precision time source on each Linux system, just as
+			// clock_gettime(CLOCK_REALTIME).
+			gettimeofday(&tv, NULL);
+			return(((double) tv.tv_sec) + (((double) tv.tv_usec) / 1000000.0));
+
+		case PSYCH_CLOCK_REALTIME:
+			// clock_gettime() reads the same clock as gettimeofday(), but at nanosecond
+			// resolution. On all modern systems it is executed in userspace via the vDSO
+			// without any system call:
+			clock_gettime(CLOCK_REALTIME, &ts);
+			return(((double) ts.tv_sec) + ((double) ts.tv_nsec / 1e9));
+
+		default:
+			// Calibrated CLOCK_MONOTONIC_RAW or TSC: Map into CLOCK_REALTIME timebase via
+			// the global offset:
+			return(PsychReadRawClock(clocksource) + clockOffset);
+	}
+}
+
+// Convert time 'secs' of the selected clock source into CLOCK_REALTIME, for use as deadline of a sleep
+// in CLOCK_REALTIME. Measures the current offset between both clocks on each call, so drift of the
+// calibrated clock sources against CLOCK_REALTIME doesn't delay wakeups:
+static double PsychClockToRealtime(double secs)
+{
+	double r1, r2, t;
+
+	if (clocksource < PSYCH_CLOCK_MONOTONICRAW) return(secs);
+
+	r1 = PsychReadClock();
+	t  = PsychReadPosixClock(CLOCK_REALTIME);
+	r2 = PsychReadClock();
+
+	return(secs + t - (r1 + r2) / 2);
+}
+
+// Select and setup clock source for PsychGetPrecisionTimerSeconds(). Called once via pthread_once():
+static void PsychInitClockSource(void)
+{
+	struct timespec res;
+	char* env = getenv("PSYCHTOOLBOX_CLOCKSOURCE");
+	double t0, t1 = 0;
+	int i, source = PSYCH_CLOCK_REALTIME;
+
+	if (env && (strlen(env) > 0)) {
+		for (i = 0; i < 4; i++) if (strcmp(env, clockSourceNames[i]) == 0) source = i;
+		if (strcmp(env, clockSourceNames[source])) printf("PTB-WARNING: Unknown clock source '%s' requested via PSYCHTOOLBOX_CLOCKSOURCE. Using 'realtime' instead.\n", env);
+	}
+
+	if ((source == PSYCH_CLOCK_MONOTONICRAW) && clock_getres(CLOCK_MONOTONIC_RAW, &res)) {
+		printf("PTB-WARNING: Clock source 'monotonicraw' requested, but not supported by this Linux kernel. Using 'realtime' instead.\n");
+		source = PSYCH_CLOCK_REALTIME;
+	}
+
+	if ((source == PSYCH_CLOCK_TSC) && (!PsychHasInvariantTSC() || clock_getres(CLOCK_MONOTONIC_RAW, &res))) {
+		printf("PTB-WARNING: Clock source 'tsc' requested, but this machine has no invariant TSC. Using 'realtime' instead.\n");
+		source = PSYCH_CLOCK_REALTIME;
+	}
+
+	switch (source) {
+		case PSYCH_CLOCK_GETTIMEOFDAY:
+			clock_getres(CLOCK_REALTIME, &res);
+			clockinc = ((double) res.tv_sec) + ((double) res.tv_nsec / 1.e9);
+			if (clockinc < 1e-6) clockinc = 1e-6;
+		break;
+
+		case PSYCH_CLOCK_REALTIME:
+			clock_getres(CLOCK_REALTIME, &res);
+			clockinc = ((double) res.tv_sec) + ((double) res.tv_nsec / 1.e9);
+		break;
+
+		case PSYCH_CLOCK_MONOTONICRAW:
+			clock_getres(CLOCK_MONOTONIC_RAW, &res);
+			clockinc = ((double) res.tv_sec) + ((double) res.tv_nsec / 1.e9);
+		break;
+
+		case PSYCH_CLOCK_TSC:
+			tscTicksPerSecond = PsychCalibrateTSC(0.025, &tscFrequencyErrorPPM);
+			tscBase = PsychReadTSC();
+			clockinc = 1.0 / tscTicksPerSecond;
+		break;
+	}
+
+	// Calibrate the mapping of the calibrated sources to CLOCK_REALTIME, once for all threads:
+	if (source >= PSYCH_CLOCK_MONOTONICRAW) clockOffsetUncertainty = PsychCalibrateClockOffset(source, 100, &clockOffset);
+
+	clocksource = source;
+
+	// clockinc contains the real clock tick resolution in secs. This is useful as a constraint
+	// on sleepwait_threshold etc. for our sleep routines...
+
+	// sleepwait_threshold is the start value of the adaptive spin window of each thread.
+	// It should be significantly higher than the granularity of the underlying system
+	// clock, say 100x the resolution, but no higher than 10 msecs, and no lower than
+	// 100 microseconds. We start with optimistic 250 microseconds...
+	sleepwait_threshold = 0.00025;
+	if (sleepwait_threshold < PsychGetMinSpinWindow()) sleepwait_threshold = PsychGetMinSpinWindow();
+	if (sleepwait_threshold > 0.010) sleepwait_threshold = 0.010;
+	// Only output info about sleepwait threshold and clock resolution if we consider the
+	// clock rather low res, ie. increments bigger 20 microseconds:
+	if (clockinc > 0.00002) printf("PTB-INFO: Real resolution of (rather low resolution!) system clock is %1.4f microseconds, dynamic sleepwait_threshold starts with %lf msecs...\n", clockinc * 1e6, sleepwait_threshold * 1e3);
+
+	// Measure mean per-call overhead:
+	t0 = PsychReadClock();
+	for (i = 0; i < 1000; i++) t1 = PsychReadClock();
+	clockOverhead = (t1 - t0) / 1000;
+
+	if (env && (strlen(env) > 0)) {
+		printf("PTB-INFO: Using clock source '%s': Resolution %f nsecs, overhead %f nsecs per query.\n", clockSourceNames[clocksource], clockinc * 1e9, clockOverhead * 1e9);
+		if (clocksource >= PSYCH_CLOCK_MONOTONICRAW) printf("PTB-INFO: Mapping to CLOCK_REALTIME calibrated to +/- %f nsecs.\n", clockOffsetUncertainty * 1e9);
+		if (clocksource == PSYCH_CLOCK_TSC) printf("PTB-INFO: TSC runs at %f Mhz, estimated calibration error %f ppm.\n", tscTicksPerSecond / 1e6, tscFrequencyErrorPPM);
+	}
+
+	return;
+}
+
+/* PsychOSGetClockSourceInfo() -- Linux only.
+ *
+ * Return name of the clock source used by PsychGetPrecisionTimerSeconds(). Also return
+ * its resolution, the measured mean overhead of one query, the uncertainty of its mapping
+ * to CLOCK_REALTIME, all in seconds, and for the TSC clock source the estimated error of
+ * its frequency calibration in ppm.
+ */
+const char* PsychOSGetClockSourceInfo(double* resolution, double* overhead, double* offsetUncertainty, double* frequencyErrorPPM)
+{
+	pthread_once(&clockSourceOnce, PsychInitClockSource);
+
+	*resolution = clockinc;
+	*overhead = clockOverhead;
+	*offsetUncertainty = clockOffsetUncertainty;
+	*frequencyErrorPPM = tscFrequencyErrorPPM;
+
+	return(clockSourceNames[clocksource]);
+}
+
+// Tell the cpu that we are busy-waiting, to reduce power consumption and contention with
+// a sibling hyperthread:
+static inline void PsychCPURelax(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	__asm__ __volatile__("pause");
+#endif
+}
+
+// Count 'value' in histogram 'histo', thread-safe:
+static void PsychAddToWaitHistogram(unsigned int* histo, double value)
+{
+	int i;
+	for (i = PSYCH_WAIT_HISTOBINS - 1; (i > 0) && (value < waitHistoBinEdges[i]); i--);
+	__sync_fetch_and_add(&histo[i], 1);
+}
+
+// Lower limit of the spin window: Significantly higher than the granularity of the
+// underlying system clock, say 100x the resolution, and no lower than 100 microseconds:
+static double PsychGetMinSpinWindow(void)
+{
+	return((100 * clockinc > 0.0001) ? 100 * clockinc : 0.0001);
+}
+
+// Return spin window of the calling thread, initialize it if needed:
+static double PsychGetSpinWindow(void)
+{
+	double now;
+
+	if (waitState.spinWindow <= 0) {
+		// Make sure sleepwait_threshold is initialized to our start value:
+		PsychGetPrecisionTimerSeconds(&now);
+		waitState.spinWindow = sleepwait_threshold;
+	}
+
+	return(waitState.spinWindow);
+}
+
+// Record 'latency' of a sleep of the calling thread and update its spin window:
+static void PsychUpdateSpinWindow(double latency)
+{
+	double sorted[PSYCH_WAKEUP_SAMPLES];
+	double v, window;
+	int i, j;
+
+	waitState.latency[waitState.next] = latency;
+	waitState.next = (waitState.next + 1) % PSYCH_WAKEUP_SAMPLES;
+	if (waitState.count < PSYCH_WAKEUP_SAMPLES) waitState.count++;
+	if ((++waitState.sleeps < 16) || (waitState.count < 16)) return;
+	waitState.sleeps = 0;
+
+	// Insertion sort of the recent latencies:
+	for (i = 0; i < waitState.count; i++) {
+		v = waitState.latency[i];
+		for (j = i; (j > 0) && (sorted[j - 1] > v); j--) sorted[j] = sorted[j - 1];
+		sorted[j] = v;
+	}
+
+	// 99th percentile plus 50% safety margin:
+	window = 1.5 * sorted[(int) ceil(0.99 * waitState.count) - 1];
+	if (window < PsychGetMinSpinWindow()) window = PsychGetMinSpinWindow();
+	if (window > 0.010) window = 0.010;
+	waitState.spinWindow = window;
+}
+
 void PsychWaitUntilSeconds(double whenSecs)
 {
   struct timespec rqtp;
-  double targettime;
-  static unsigned int missed_count=0;
+  double targettime, sleeptime, spinwindow;
   double now=0.0;
+  psych_bool slept = FALSE;
   int rc;
 
   // Get current time:
@@ -58,23 +442,26 @@ void PsychWaitUntilSeconds(double whenSecs)
   // If the deadline has already passed, we do nothing and return immediately:
   if (now >= whenSecs) return;
 
-  // Waiting stage 1: If we have more than sleepwait_threshold seconds left
-  // until the deadline, we call the OS usleep() function, so the
-  // CPU gets released for (difference - sleepwait_threshold) seconds to other processes and threads.
+  // Waiting stage 1: If we have more than spinwindow seconds left
+  // until the deadline, we call the OS clock_nanosleep() function, so the
+  // CPU gets released for (difference - spinwindow) seconds to other processes and threads.
   // -> Good for general system behaviour and for lowered power-consumption (longer battery runtime for
   // Laptops) as the CPU can go idle if nothing else to do...
 
-  // Set an absolute deadline of whenSecs - sleepwait_threshold. We busy-wait the last few microseconds
+  // Set an absolute deadline of whenSecs - spinwindow. We busy-wait the last few microseconds
   // to take scheduling jitter/delays gracefully into account:
-  targettime    = whenSecs - sleepwait_threshold;
-
-  // Convert targettime to timespec for the Posix clock functions:
-  rqtp.tv_sec   = (unsigned long long) targettime;
-  rqtp.tv_nsec = ((targettime - (double) rqtp.tv_sec) * (double) 1e9);  
+  spinwindow    = PsychGetSpinWindow();
+  targettime    = whenSecs - spinwindow;
 
   // Use clock_nanosleep() to high-res sleep until targettime, repeat if that gets
   // prematurely interrupted for whatever reason...
   while(now < targettime) {
+    // Convert targettime to CLOCK_REALTIME, as our clock source may have drifted against it,
+    // then to timespec for the Posix clock functions:
+    sleeptime     = PsychClockToRealtime(targettime);
+    rqtp.tv_sec   = (unsigned long long) sleeptime;
+    rqtp.tv_nsec = ((sleeptime - (double) rqtp.tv_sec) * (double) 1e9);
+
     // MK: Oldstyle - obsolete: usleep((unsigned long)((whenSecs - now - sleepwait_threshold) * 1000000.0f));
 
     // Starting in 2008, we use high-precision/high-resolution POSIX realtime timers for precise waiting:
@@ -83,47 +470,92 @@ void PsychWaitUntilSeconds(double whenSecs)
     // cause inconsistencies to other times reported by different useful system services which all measure
     // against wall clock, and in practice, the effect of NTP adjustments is minimal or negligible, as these
     // never create backwards running time or large timewarps, only 1 ppm level adjustments per second, ie,
-    // the effect is way below the sleepwait_threshold for any reasonable sleep time -- easily compensated by
+    // the effect is way below the spinwindow for any reasonable sleep time -- easily compensated by
     // our hybrid approach...
     // We use TIMER_ABSTIME, so we are totally drift-free and restartable in case our sleep gets interrupted by
     // signals. If clock_nanosleep gets EINTR - Interrupted by a posix signal, we simply loop and restart the
     // sleep. If it returns a different error condition, we abort sleep iteration -- something would be seriously
     // wrong... 
     if ((rc = clock_nanosleep(CLOCK_REALTIME, TIMER_ABSTIME, &rqtp, NULL)) && (rc != EINTR)) break;
+    slept = TRUE;
 
     // Update our 'now' time for reiterating or continuing with busy-sleep...
     PsychGetPrecisionTimerSeconds(&now);
   }
 
-  // Waiting stage 2: We are less than sleepwait_threshold seconds away from deadline.
-  // Perform busy-waiting until deadline reached:
-  while(now < whenSecs) PsychGetPrecisionTimerSeconds(&now);
+  // Record wakeup latency of the sleep and adapt spin window for future waits:
+  if (slept) {
+    PsychAddToWaitHistogram(sleepLatencyHisto, now - targettime);
+    PsychUpdateSpinWindow(now - targettime);
+  }
+
+  // Waiting stage 2: We are less than spinwindow seconds away from deadline.
+  // Perform busy-waiting until deadline reached. We never yield the cpu here, as
+  // under contention a sched_yield() can cost a whole timeslice and overshoot the
+  // deadline. Sleeping is the job of stage 1, we only relax the cpu while spinning:
+  while(now < whenSecs) {
+    PsychCPURelax();
+    PsychGetPrecisionTimerSeconds(&now);
+  }
+
+  __sync_fetch_and_add(&waitCount, 1);
+  PsychAddToWaitHistogram(wakeupErrorHisto, now - whenSecs);
 
   // Check for deadline-miss of more than 0.1 ms:
   if (now - whenSecs > 0.0001) {
     // Deadline missed by over 0.1 ms.
-    missed_count++;
-    // As long as the threshold is below a msec, immediately increase by 100 microsecs...
-    if (sleepwait_threshold < 0.001) sleepwait_threshold+=0.0001;
-
-    // If threshold has reached 1 msec, we require multiple consecutive misses before increasing any further:
-    if (missed_count>5) {
-      // Too many consecutive misses. Increase our threshold for sleep-waiting
-      // by 0.1 ms until it reaches max. 10 ms.
-      if (sleepwait_threshold < 0.01) sleepwait_threshold+=0.0001;
+    waitState.missed_count++;
+    __sync_fetch_and_add(&waitMissCount, 1);
+
+    // If the sleep overshot into the spin window, immediately grow the window to
+    // that latency plus safety margin, limited to 10 msecs:
+    if (slept && (now - targettime > 0.5 * waitState.spinWindow)) {
+      waitState.spinWindow = 1.5 * (now - targettime);
+      if (waitState.spinWindow > 0.010) waitState.spinWindow = 0.010;
+    }
+
+    // Report multiple consecutive misses:
+    if (waitState.missed_count>5) {
       printf("PTB-WARNING: Wait-Deadline missed for %i consecutive times (Last miss %lf ms). New sleepwait_threshold is %lf ms.\n",
-	     missed_count, (now - whenSecs)*1000.0f, sleepwait_threshold*1000.0f);
+	     waitState.missed_count, (now - whenSecs)*1000.0f, waitState.spinWindow*1000.0f);
     }
   }
   else {
     // No miss detected. Reset counter...
-    missed_count=0;
+    waitState.missed_count=0;
   }
 
   // Ready.
   return;
 }
 
+/* PsychOSGetWaitStatistics() -- Linux only.
+ *
+ * Return statistics of PsychWaitUntilSeconds() over all threads: The lower bin edges in seconds,
+ * and the histogram counts of the wakeup errors of waits and of the wakeup latencies of sleeps,
+ * all arrays of PSYCH_WAIT_HISTOBINS elements. Also return the total number of waits, the number
+ * of waits which missed their deadline by more than 0.1 msecs, and the current spin window of the
+ * calling thread. Reset all histograms and counters afterwards if 'reset' is TRUE.
+ */
+void PsychOSGetWaitStatistics(double* binEdges, double* wakeupErrors, double* sleepLatencies, double* numWaits, double* numMisses, double* spinWindow, psych_bool reset)
+{
+	int i;
+
+	for (i = 0; i < PSYCH_WAIT_HISTOBINS; i++) {
+		binEdges[i] = waitHistoBinEdges[i];
+		wakeupErrors[i] = (double) wakeupErrorHisto[i];
+		sleepLatencies[i] = (double) sleepLatencyHisto[i];
+		if (reset) wakeupErrorHisto[i] = sleepLatencyHisto[i] = 0;
+	}
+
+	*numWaits = (double) waitCount;
+	*numMisses = (double) waitMissCount;
+	*spinWindow = PsychGetSpinWindow();
+	if (reset) waitCount = waitMissCount = 0;
+
+	return;
+}
+
 void PsychWaitIntervalSeconds(double delaySecs)
 {
   double deadline;
@@ -168,11 +600,11 @@ void PsychYieldIntervalSeconds(double delaySecs)
 	}
 	else {
 		// On Linux we use standard wait ops - they're good enough for us.
-		// However, we make sure that the wait lasts at least 2x the sleepwait_threshold,
-		// so the cpu gets certainly released to other threads, instead of getting hogged
-		// by busy-waiting for too short delaySecs intervals - which would be detrimental
-		// to the goals of PsychYieldIntervalSeconds():
-		delaySecs = (delaySecs > 2.0 * sleepwait_threshold) ? delaySecs : (2.0 * sleepwait_threshold);
+		// However, we make sure that the wait lasts at least 2x the spin window of the
+		// calling thread, so the cpu gets certainly released to other threads, instead of
+		// getting hogged by busy-waiting for too short delaySecs intervals - which would be
+		// detrimental to the goals of PsychYieldIntervalSeconds():
+		delaySecs = (delaySecs > 2.0 * PsychGetSpinWindow()) ? delaySecs : (2.0 * PsychGetSpinWindow());
 		PsychWaitIntervalSeconds(delaySecs);
 	}
 }
@@ -189,6 +621,9 @@ double	PsychGetKernelTimebaseFrequencyHz(void)
 void PsychInitTimeGlue(void)
 {
   // TODO: Add Mutex init code for the timeglue mutex!
+
+  // Select and calibrate the clock source, while we are still single-threaded:
+  pthread_once(&clockSourceOnce, PsychInitClockSource);
   
   // Set this, although its totally pointless on our implementation...
   PsychEstimateGetSecsValueAtTickCountZero();
@@ -262,11 +697,13 @@ double PsychOSGetLinuxMonotonicTime(void)
  */
 double PsychOSMonotonicToRefTime(double monotonicTime)
 {
-	double now, tMonotonic;
-	// Get current reftime:
+	double now, now2, tMonotonic;
+	// Get current CLOCK_MONOTONIC time, bracketed by two reads of the current reftime,
+	// so it corresponds to the midpoint of both:
 	PsychGetAdjustedPrecisionTimerSeconds(&now);
-	// Get current CLOCK_MONOTONIC time:
 	tMonotonic = PsychOSGetLinuxMonotonicTime();
+	PsychGetAdjustedPrecisionTimerSeconds(&now2);
+	now = (now + now2) / 2;
 	// Given input monotonicTime time value closer to tMonotonic than to GetSecs time?
 	if (fabs(monotonicTime - tMonotonic) < fabs(monotonicTime - now)) {
 		// Timestamps are in monotonic time! Need to remap.
@@ -285,46 +722,15 @@ double PsychOSMonotonicToRefTime(double monotonicTime)
 void PsychGetPrecisionTimerSeconds(double *secs)
 
 {
-  static psych_bool firstTime = TRUE;
-  struct timespec res;
-
-  // First time invocation?
-  if (firstTime) {
-	// We query the real clock tick resolution in secs and store in global clockinc.
-	// This is useful as a constraint on sleepwait_threshold etc. for our sleep routines...
-	clock_getres(CLOCK_REALTIME, &res);
-	clockinc = ((double) res.tv_sec) + ((double) res.tv_nsec / 1.e9);
-
-	// sleepwait_threshold should be significantly higher than the granularity of
-	// the underlying system clock, say 100x the resolution, but no higher than 10 msecs,
-	// and no lower than 100 microseconds. We start with optimistic 250 microseconds...
-	sleepwait_threshold = 0.00025;
-	if (sleepwait_threshold < 100 * clockinc) sleepwait_threshold = 100 * clockinc;
-	if (sleepwait_threshold > 0.010) sleepwait_threshold = 0.010;
-	// Only output info about sleepwait threshold and clock resolution if we consider the
-	// clock rather low res, ie. increments bigger 20 microseconds:
-	if (clockinc > 0.00002) printf("PTB-INFO: Real resolution of (rather low resolution!) system clock is %1.4f microseconds, dynamic sleepwait_threshold starts with %lf msecs...\n", clockinc * 1e6, sleepwait_threshold * 1e3);
+  double ss;
 
-	firstTime = FALSE;
-  }
+  // Clock source not yet selected? This only happens if we get called before PsychInitTimeGlue():
+  pthread_once(&clockSourceOnce, PsychInitClockSource);
 
-  // We use gettimeofday() - It works with microsecond resolution and
-  // is implemented via the highest precision time source on each
-  // Linux system, e.g., the processors performance counters on
-  // Intel Pentium systems. Actually, the resolution of the underlying
-  // clocksource is often much better than 1 microsecond, e.g., nanoseconds,
-  // but Linux chooses always the highest precision reliable source, so in
-  // case TSC's are broken and HPET's are not available and ACPI PM-Timers
-  // aren't available, it could be a worse than 1 usec source, although this
-  // is extremely unlikely...
-  static double oldss = -1;
-  double ss;
-  struct timeval tv;
-  gettimeofday(&tv, NULL);
-  ss = ((double) tv.tv_sec) + (((double) tv.tv_usec) / 1000000.0);
+  ss = PsychReadClock();
 
-  // Some correctness checks against last queried value, if initialized:
-  if (oldss > -1) {
+  // Some correctness checks against last queried value of this thread, if initialized:
+  if (threadOldSecs > -1) {
 	// Old reference available. We check for monotonicity, ie. if time
 	// is not going backwards. That's all we can do, as we don't have access
 	// to a reference clock. We can't check for clock halts either, because
@@ -339,15 +745,13 @@ void PsychGetPrecisionTimerSeconds(double *secs)
 	// It may also be useful is somebody is running a very old Linux kernel without
 	// sophisticated checking and for testing/debugging PTB and its error-handling itself by
 	// fault-injection... 
-	// MK: DISABLED FOR THIS RELEASE: Gives false alarms due to some race-condition when
-	// function is called from multiple concurrent threads. Proper fix is known, but i
-	// want to get a beta out now and not in a week...
-	// if (ss < oldss) {
-	if (FALSE) {
+	// The reference value is kept per thread, so concurrent calls from multiple threads
+	// can't cause false alarms anymore.
+	if (ss < threadOldSecs) {
 		// Time warp detected! Time going backwards!!! Nothing we can do, only report
 		// it:
 		printf("\n\nPTB-CRITICAL-ERROR: Your systems clock is reporting time to run backwards!!!\n");
-		printf("PTB-CRITICAL-ERROR: (Delta %lf secs). This is impossible and indicates some\n", ss - oldss);
+		printf("PTB-CRITICAL-ERROR: (Delta %lf secs). This is impossible and indicates some\n", ss - threadOldSecs);
 		printf("PTB-CRITICAL-ERROR: broken clock hardware or Linux setup!! Stop using this machine\n");
 		printf("PTB-CRITICAL-ERROR: for psychophysics immmediately and resolve the problem!!!\n\n");
 		fflush(NULL);
@@ -355,7 +759,7 @@ void PsychGetPrecisionTimerSeconds(double *secs)
   }
 
   // Init reference timestamp for checking in next call:
-  oldss = ss;
+  threadOldSecs = ss;
 
   // Assign final time value:
   *secs= ss;  
@@ -633,8 +1037,9 @@ int PsychTimedWaitCondition(psych_condition* condition, psych_mutex* mutex, doub
 	struct timespec abstime;
 	double tnow;
 
-	// Convert relative wait time to absolute system time:
-	PsychGetAdjustedPrecisionTimerSeconds(&tnow);
+	// Convert relative wait time to absolute CLOCK_REALTIME time, as used by pthread_cond_timedwait(),
+	// independent of the clock source of PsychGetPrecisionTimerSeconds():
+	tnow = PsychReadPosixClock(CLOCK_REALTIME);
 	maxwaittimesecs+=tnow;
 
 	// Split maxwaittimesecs in...
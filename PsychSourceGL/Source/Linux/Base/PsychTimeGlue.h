@@ -15,6 +15,8 @@
 
   	2/20/06	mk		Wrote it.  
 	1/03/09	mk		Add generic Mutex locking support as service to ptb modules.
+	10/19/26	agent	Add PsychOSGetClockSourceInfo().
+	10/19/26	agent	Add PsychOSGetWaitStatistics().
 	
   	DESCRIPTION:
 
@@ -68,5 +70,10 @@ int PsychIsCurrentThreadEqualToPsychThread(psych_thread threadhandle);
 // Linux specific: CLOCK_MONOTONIC time in seconds -- Usually the system uptime:
 double PsychOSGetLinuxMonotonicTime(void);
 double PsychOSMonotonicToRefTime(double monotonicTime);
+const char* PsychOSGetClockSourceInfo(double* resolution, double* overhead, double* offsetUncertainty, double* frequencyErrorPPM);
+
+// Linux specific: Histograms of wakeup errors and sleep latencies of PsychWaitUntilSeconds():
+#define PSYCH_WAIT_HISTOBINS 14
+void PsychOSGetWaitStatistics(double* binEdges, double* wakeupErrors, double* sleepLatencies, double* numWaits, double* numMisses, double* spinWindow, psych_bool reset);
 //end include once
 #endif
@@ -40,13 +40,40 @@ function s=GetSecs(s,subscript)
 %
 % LINUX : _________________________________________________________________
 %
-% On Linux, the gettimeofday() system call is used, which usually has
-% microsecond resolution and accuracy. Linux always chooses the highest
-% precision clock on a system for that call, usually the processors
-% performance counter or the HPET high precision event timer, or the ACPI
-% power management timer - whatever is the best tradeoff between
-% reliability, acccuracy and performance. To our current knowledge, all
-% computers running a Linux 2.6 kernel have reliably working clocks.
+% On Linux, the clock_gettime(CLOCK_REALTIME) system call is used, which
+% has nanosecond resolution and is executed without entering the kernel on
+% modern systems. It reads the same clock as the gettimeofday() call.
+% Linux always chooses the highest precision clock on a system for that
+% call, usually the processors performance counter or the HPET high
+% precision event timer, or the ACPI power management timer - whatever is
+% the best tradeoff between reliability, acccuracy and performance. To our
+% current knowledge, all computers running a Linux 2.6 kernel have reliably
+% working clocks.
+%
+% The environment variable PSYCHTOOLBOX_CLOCKSOURCE allows to select a
+% different clock source. It must be set before any Psychtoolbox mex file
+% gets loaded, e.g., via setenv('PSYCHTOOLBOX_CLOCKSOURCE', 'tsc');
+%
+% 'realtime'     = clock_gettime(CLOCK_REALTIME). The default.
+% 'gettimeofday' = gettimeofday(), with microsecond resolution, as used by
+%                  Psychtoolbox versions before October 2026.
+% 'monotonicraw' = clock_gettime(CLOCK_MONOTONIC_RAW), which is not slewed
+%                  by NTP time synchronization.
+% 'tsc'          = The processors timestamp counter, if it is an invariant
+%                  TSC, ie. one which runs at a constant rate and is
+%                  synchronized across all processor cores. This is the
+%                  fastest clock source on most machines.
+%
+% The 'monotonicraw' and 'tsc' clocks get calibrated against the default
+% clock once, when the clock source is selected, so all sources report time
+% in the same timebase. They don't follow later adjustments of the default
+% clock by NTP time synchronization, so they can drift away from it by up
+% to 0.5 msecs per second while NTP slews the default clock. WaitSecs and
+% other timed waits account for this drift, so they still end on time.
+%
+% info = GetSecs('ClockInfo'); returns information about the clock in
+% use, e.g., its resolution, the measured duration of one query and the
+% quality of its calibration.
 %
 %
 % See also: WaitSecs, GetSecsTest, 
@@ -64,5 +91,6 @@ function s=GetSecs(s,subscript)
 % 10/25/05 awi  Divided into general section and OS 9 & Win specific sections.
 %               Imported into OS X PTB.
 % 01/28/08 mk   Updated help texts to match current implementation.
+% 10/19/26 agent Document clock sources on Linux and GetSecs('ClockInfo').
 
 AssertMex('GetSecs.m');
@@ -37,6 +37,29 @@ function varargout = PsychPortAudio(varargin)
 %
 % - Efficient, causes only very low cpu load.
 %
+% - Streaming playback of long sounds directly from WAV or raw sound files
+%   without loading them into memory, see "PsychPortAudio CreateBufferFromFile?".
+%
+% - Offline rendering without any sound hardware, as fast as possible or
+%   paced to realtime, for testing and benchmarking, see
+%   "PsychPortAudio OpenOffline?" and "PsychPortAudioOfflineBenchmark".
+%
+% - High quality sample rate conversion and smooth playback rate changes,
+%   e.g., for doppler shifts, see "PsychPortAudio Resampling?" and
+%   "PsychPortAudioResamplingBenchmark".
+%
+% - Realtime effect chains with biquad filters, convolution, e.g., for
+%   HRTF or room impulse responses, and a look-ahead limiter, per slave and
+%   per device, see "PsychPortAudio DspBiquads?".
+%
+% - Sample accurate detection of sound onsets in captured sound, e.g., for
+%   voice keys, without fetching the sound, see
+%   "PsychPortAudio CaptureDetector?".
+%
+% - Retrieval of captured sound for specific time windows, e.g., around a
+%   voice onset, with decimation and single or int16 output, see
+%   "PsychPortAudio GetAudioDataRange?".
+%
 % See the "help InitializePsychSound" for more info on low-latency
 % configurations. See "help BasicSoundOutputDemo" for a very basic demo of
 % sound output (without special emphasis on low-latency). See
@@ -63,6 +86,8 @@ function varargout = PsychPortAudio(varargin)
 % History:
 % 06/07/2007 Written (MK).
 % 11/01/2008 Remove warning messages about "early beta release" (MK).
+% 10/19/2026 Mention file backed buffers (agent).
+% 10/19/2026 Mention offline rendering (agent).
 
 % Some check for not yet supported operating systems:
 AssertMex('PsychPortAudio.m');
@@ -49,7 +49,11 @@ function r=WaitSecs(s,se)
 % WaitSecs always uses the POSIX realtime high-precision timing facilities
 % (clock_nanosleep(CLOCK_RT,...)). It sleeps the main MATLAB thread for the
 % given wait period, surrendering CPU time to other processes while waiting.
-% WaitSecs is now safe to use at any priority setting.
+% WaitSecs is now safe to use at any priority setting. The final part of
+% each wait is spent busy-waiting, to compensate for the wakeup latency of
+% the operating system. The length of that spin window adapts to the
+% observed wakeup latencies. stats = WaitSecs('WakeupStatistics'); returns
+% histograms of the wakeup errors, see WaitSecs('WakeupStatistics?').
 %
 % NB.: Use of a modern 2.6.x kernel is recommended, and many modern
 % distros, e.g., Ubuntu 7.1, offer the option of installing a special
@@ -66,4 +70,5 @@ function r=WaitSecs(s,se)
 % 2/4/00    dgp     Updated for Mac OS 9.
 % 7/2/04    awi     Divided into separate sections for OS X, Mac and Windows.  
 % 7/10/04   awi     Edits for clarity.
+% 10/19/26  agent   Document adaptive spin window and WakeupStatistics on Linux.
 AssertMex('WaitSecs.m');
@@ -269,6 +269,26 @@
 % just as on pre 2012 PTB's.
 %
 %
+% 2^25 == kPsychUsePBOTextureUploads
+% Upload the content of textures created via Screen('MakeTexture') or
+% Screen('SetOpenGLTextureFromMemPointer') via pixel buffer objects: The
+% image data is copied into a pixel buffer object, then the graphics card
+% transfers it from there into its VRAM in the background. The copy into
+% the pixel buffer object still happens inside Screen('MakeTexture'), so
+% the command does not return immediately, but it doesn't have to wait for
+% the transfer into VRAM. This can reduce the time spent in
+% Screen('MakeTexture') when streaming large image sequences during
+% inter-trial intervals, depending on graphics card and driver. Textures
+% are marked as pending until their upload has completed. Drawing a pending
+% texture will always show its final content, but may need to wait for the
+% upload to complete. Call Screen('PreloadTextures') at the end of an
+% inter-trial interval to wait for completion of all pending uploads. This
+% needs a GPU and driver with support for pixel buffer objects and sync
+% objects, ie. OpenGL 3.2 or the GL_ARB_pixel_buffer_object and
+% GL_ARB_sync extensions. Otherwise the flag is ignored. It is also ignored
+% if kPsychDontCacheTextures is set.
+%
+%
 % --> It's always better to update your graphics drivers with fixed
 % versions or buy proper hardware than using these workarounds. They are
 % meant as a last ressort, e.g., if you need to get something going quickly
@@ -38,6 +38,10 @@
   Compile this with:
   
   mex -O pnet.c
+
+  On Linux, the background receive thread for 'asyncstart' may need:
+
+  mex -O pnet.c -lpthread
   
   Notes for Windows implementation
  
@@ -61,11 +65,15 @@
   **********************************************************/
     
 /******* GENERAL DEFINES *********/
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE   /* For recvmmsg() and sendmmsg() */
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <ctype.h>
+#include <limits.h>
 
 /******* WINDOWS ONLY DEFINES *********/
 #ifdef WIN32
@@ -99,6 +107,34 @@
 #define DEFAULT_USLEEP        500		/* MK: Changed from 10 msecs to 0.5 msec == 500 microsecs. for lower latency. Should not be a problem on good OS/X and Linux :-) */
 #endif
 
+/******* ASYNCHRONOUS RECEIVE, LINUX ONLY *********/
+/* Background receive thread, driven by epoll, for 'asyncstart', 'readlines' and 'readpackets'. */
+#ifdef __linux__
+#define PNET_ASYNC
+#define IFASYNC(dothis) dothis
+#define IFNOASYNC(dothis)
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <time.h>
+#else
+#define IFASYNC(dothis)
+#define IFNOASYNC(dothis) dothis
+#endif
+
+/******* BATCHED UDP PACKET TRANSFER AND SIMD BYTE SWAPPING *********/
+/* recvmmsg() and sendmmsg() move many UDP packets per system call on Linux. */
+#ifdef __linux__
+#define PNET_MMSG
+#endif
+
+/* SSSE3 pshufb byte swapping on x86 with gcc or clang, selected at runtime if cpu supports it. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PNET_SSSE3
+#include <tmmintrin.h>
+#endif
+
 #ifndef INADDR_NONE
 #define INADDR_NONE (-1)
 #endif
@@ -118,6 +154,8 @@
 #define MAX_CON         100       /* Maximum number of simultanius tcpip connections.*/
 #define NAMEBUFF_LEN    100
 #define MINBUFFSIZE     1000      /* readbuffer will shrink to this size if datalength is smaller. */
+#define KEEPBUFFSIZE    16777216  /* Emptied buffers up to this size are kept, so bulk transfers don't realloc() each time. */
+#define MAXBATCH        64        /* Maximum number of UDP packets per recvmmsg() or sendmmsg() call. */
 #define CBNAMELEN       30
 
 #define CON_FREE         -1       /* Find a new free struct in struct array */
@@ -129,6 +167,11 @@
 #define DEFAULT_READTIMEOUT   double_inf
 #define DEFAULT_INPUT_SIZE    50000
 
+#define ASYNC_DEFAULT_BUFFSIZE  1048576   /* Default size of receive ringbuffer of a connection in asynchronous mode. */
+#define ASYNC_DEFAULT_RECORDS   8192      /* Default maximum number of queued lines or packets of a connection. */
+#define ASYNC_MAXPACKET         65536     /* Maximum size of a UDP packet. */
+#define ASYNC_MAXEVENTS         64        /* Maximum number of events handled per epoll_wait() call. */
+
 /* Different status of a con_info struct handles a file descriptor    */
 #define STATUS_FREE       -1
 #define STATUS_NOCONNECT   0    // Disconnected pipe that is note closed 
@@ -154,6 +197,38 @@ typedef struct
     int pos;         /* Length used of buffer for data storage.*/
 } io_buff;
 
+#ifdef PNET_ASYNC
+/* A received line (TCP) or packet (UDP) in the ringbuffer of a connection in asynchronous mode. */
+typedef struct
+{
+    long long start;  /* Absolute ringbuffer position of first byte. */
+    int len;          /* Length in bytes, without newline delimiter. */
+    long long end;    /* Absolute ringbuffer position after the record, including delimiter. */
+    double time;      /* Arrival time in seconds, same clock as GetSecs. */
+} async_record;
+
+/* State of a connection that is served by the background receive thread. Protected by async_mutex. */
+typedef struct
+{
+    int fid;
+    int udp;                  /* One record per received packet, instead of one per line. */
+    char *ring;               /* Ringbuffer of received bytes. */
+    int ringsize;
+    long long head;           /* Absolute count of bytes received into ringbuffer. */
+    long long tail;           /* Absolute count of bytes fetched from ringbuffer. */
+    long long scanpos;        /* Received bytes are scanned for newlines up to here. */
+    long long linestart;      /* Start of current incomplete line. */
+    double lasttime;          /* Arrival time of last received bytes. */
+    async_record *records;    /* Queue of complete lines or packets. */
+    int maxrecords;
+    long long rechead;        /* Absolute count of queued records. */
+    long long rectail;        /* Absolute count of fetched records. */
+    int stalled;              /* Ringbuffer full, receive paused until data is fetched. */
+    int eof;                  /* Connection closed by peer, or receive error. */
+    double dropped;           /* Number of packets dropped due to full buffers. */
+} async_info;
+#endif
+
 /* Structure that hold all information about a tcpip connection. */
 typedef struct
 {
@@ -165,6 +240,7 @@ typedef struct
     io_buff read;
     int status;       /* STATUS_... FREE, NOCONNECT, SERVER, CLIENT ... */
     char callback[CBNAMELEN+1];
+    IFASYNC( async_info *async; )  /* Non-NULL if in asynchronous mode. */
 } con_info;
 
 
@@ -181,6 +257,16 @@ con_info con[MAX_CON];
 int con_index=0;                   /* Current index possition for list of handlers */
 unsigned long mex_call_counter=0;  /* Counter that counts how many calls that have been done to pnet */
 
+#ifdef PNET_ASYNC
+/* Background receive thread, shared by all connections in asynchronous mode */
+pthread_t       async_thread;
+pthread_mutex_t async_mutex=PTHREAD_MUTEX_INITIALIZER;
+int             async_epfd=-1;          /* epoll instance of receive thread, -1 if thread is not running. */
+int             async_wakefd=-1;        /* eventfd to wake up receive thread. */
+int             async_quit=0;           /* Tells receive thread to exit. */
+long long       async_generation=0;     /* Incremented by receive thread on each loop iteration. */
+#endif
+
 /***********************************************************************/
 void Print_Start_Message(){
     mexPrintf("\n===============================================================================\n"
@@ -237,7 +323,7 @@ void newbuffsize(io_buff *buff,int newsize)
 	//	fprintf(stderr,"NEWSIZE UP %d -> %d\n",buff->len,newsize*2);
 	buff->ptr=myrealloc(buff->ptr,newsize*2);
 	buff->len=newsize*2;
-    }else if(newsize*4 < buff->len){ // Decrease...
+    }else if(newsize*4 < buff->len && buff->len > KEEPBUFFSIZE){ // Decrease, but keep moderately sized buffers...
 	//	fprintf(stderr,"NEWSIZE DOWN %d -> %d\n",buff->len,newsize*2);
 	buff->ptr=myrealloc(buff->ptr,newsize*2);
 	buff->len=newsize*2;
@@ -354,6 +440,27 @@ void byteswapdata(char *ptr,const int elements,const int elementsize,int mode)
     }
 }
 
+#ifdef PNET_SSSE3
+/********************************************************************/
+/* Swaps 2, 4 or 8 byte elements 16 bytes at a time with pshufb.    */
+/* Returns number of bytes done, the rest is left to the caller.    */
+__attribute__((target("ssse3")))
+int byteswapcopy_ssse3(char *dest,const char *src,const int bytes,const int elementsize)
+{
+    __m128i mask;
+    int n;
+    if(elementsize==2)
+	mask=_mm_set_epi8(14,15,12,13,10,11,8,9,6,7,4,5,2,3,0,1);
+    else if(elementsize==4)
+	mask=_mm_set_epi8(12,13,14,15,8,9,10,11,4,5,6,7,0,1,2,3);
+    else
+	mask=_mm_set_epi8(8,9,10,11,12,13,14,15,0,1,2,3,4,5,6,7);
+    for(n=0;n+16<=bytes;n+=16)
+	_mm_storeu_si128((__m128i *)&dest[n],_mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)&src[n]),mask));
+    return n;
+}
+#endif
+
 /********************************************************************/
 /*Makes byte swapping, or not depending on the mode argument        */
 void byteswapcopy(char *dest,char *src,const int elements,const int elementsize,int mode)
@@ -365,7 +472,27 @@ void byteswapcopy(char *dest,char *src,const int elements,const int elementsize,
     if(is_intel_order[0]==1 && mode==2)   mode=1;    
     if(is_intel_order[0]==0 && mode==3)   mode=1;
     //    fprintf(stderr,"SWAP COPY E:%d SI:%d SWAP:%d\n",elements,elementsize,mode);
-    if(mode==1){
+    if(mode==1 && (elementsize==2 || elementsize==4 || elementsize==8)){
+	// Bulk path for the common types: Vectorized, then element wise for the rest.
+	const int bytes=elements*elementsize;
+	int done=0,e;
+#ifdef PNET_SSSE3
+	static int has_ssse3=-1;
+	if(has_ssse3<0)
+	    has_ssse3=__builtin_cpu_supports("ssse3")?1:0;
+	if(has_ssse3)
+	    done=byteswapcopy_ssse3(dest,src,bytes,elementsize);
+#endif
+	for(e=done;e<bytes;e+=elementsize){
+	    unsigned char *dp=(unsigned char *)&dest[e];
+	    const unsigned char *sp=(const unsigned char *)&src[e];
+	    unsigned char t[8];
+	    int n;
+	    for(n=0;n<elementsize;n++)
+		t[n]=sp[elementsize-1-n];
+	    memcpy(dp,t,elementsize);
+	}
+    }else if(mode==1){
 	int e,n;
 	//	fprintf(stderr,"SWAP COPY\n");
 	for(e=0;e<elements;e++){
@@ -379,7 +506,7 @@ void byteswapcopy(char *dest,char *src,const int elements,const int elementsize,
 	//	fprintf(stderr,"SWAP COPY END\n");
     }
     else
-	    memmove(dest,src,elements*elementsize);
+	    memcpy(dest,src,elements*elementsize);
 }
 
 /********************************************************************/
@@ -797,6 +924,540 @@ int writedata()
     return sentlen;
 }
 
+/**********************************************************************/
+/* Sends the write buffer as UDP packets of at most packetsize bytes  */
+/* each. Returns number of packets sent. Empties the write buffer.    */
+int writepacketbatch(int packetsize)
+{
+    const double timeoutat=my_now()+con[con_index].writetimeout;
+    const int len=con[con_index].write.pos;
+    const int packets=(len+packetsize-1)/packetsize;
+    const int noconnect=IS_STATUS_UDP_NO_CON(con[con_index].status);
+    int sent=0;
+    int retval;
+
+    if(con[con_index].status<STATUS_IO_OK)
+	return 0;
+    while(sent<packets){
+#ifdef PNET_MMSG
+	struct mmsghdr msgs[MAXBATCH];
+	struct iovec iov[MAXBATCH];
+	int n;
+	const int batch=(packets-sent<MAXBATCH)?packets-sent:MAXBATCH;
+	memset(msgs,0,batch*sizeof(struct mmsghdr));
+	for(n=0;n<batch;n++){
+	    const int start=(sent+n)*packetsize;
+	    iov[n].iov_base=&con[con_index].write.ptr[start];
+	    iov[n].iov_len=(len-start<packetsize)?len-start:packetsize;
+	    msgs[n].msg_hdr.msg_iov=&iov[n];
+	    msgs[n].msg_hdr.msg_iovlen=1;
+	    if(noconnect){
+		msgs[n].msg_hdr.msg_name=&con[con_index].remote_addr;
+		msgs[n].msg_hdr.msg_namelen=sizeof(struct sockaddr_in);
+	    }
+	}
+	retval=sendmmsg(con[con_index].fid,msgs,batch,MSG_NOSIGNAL);
+#else
+	const int start=sent*packetsize;
+	const int plen=(len-start<packetsize)?len-start:packetsize;
+	if(noconnect)
+	    retval=sendto(con[con_index].fid,&con[con_index].write.ptr[start],plen,MSG_NOSIGNAL,
+			  (struct sockaddr *)&con[con_index].remote_addr,sizeof(struct sockaddr));
+	else
+	    retval=send(con[con_index].fid,&con[con_index].write.ptr[start],plen,MSG_NOSIGNAL);
+	if(retval>=0)
+	    retval=1;
+#endif
+	if(retval<0 && s_errno!=EWOULDBLOCK){
+	    perror( "sendmmsg() / sendto() / send()" );
+	    break;
+	}
+	if(retval>0)
+	    sent+=retval;
+	else if(timeoutat<=my_now())
+	    break;
+	else
+	    usleep(DEFAULT_USLEEP);
+    }
+    con[con_index].write.pos=0;
+    newbuffsize(&con[con_index].write,0);
+    return sent;
+}
+
+/**********************************************************************/
+/* Receives up to maxpackets UDP packets of at most maxsize bytes each*/
+/* into the read buffer, one after the other. Blocks until at least  */
+/* one packet is received, or until readtimeout. Packet sizes go into*/
+/* sizes. Returns number of packets received.                         */
+int readpacketbatch(int maxpackets,int maxsize,int noblock,double *sizes)
+{
+    const double timeoutat=my_now()+con[con_index].readtimeout;
+    io_buff *buff=&con[con_index].read;
+    struct sockaddr_in from;
+    int received=0;
+    int retval,n;
+
+    buff->pos=0;
+    if(0==IS_STATUS_IO_OK(con[con_index].status))
+	return 0;
+    // Receive into slots of maxsize bytes, compacted below:
+    newbuffsize(buff,maxpackets*maxsize);
+    while(received<maxpackets){
+#ifdef PNET_MMSG
+	struct mmsghdr msgs[MAXBATCH];
+	struct iovec iov[MAXBATCH];
+	struct sockaddr_in addrs[MAXBATCH];
+	const int batch=(maxpackets-received<MAXBATCH)?maxpackets-received:MAXBATCH;
+	memset(msgs,0,batch*sizeof(struct mmsghdr));
+	for(n=0;n<batch;n++){
+	    iov[n].iov_base=&buff->ptr[(received+n)*maxsize];
+	    iov[n].iov_len=maxsize;
+	    msgs[n].msg_hdr.msg_iov=&iov[n];
+	    msgs[n].msg_hdr.msg_iovlen=1;
+	    msgs[n].msg_hdr.msg_name=&addrs[n];
+	    msgs[n].msg_hdr.msg_namelen=sizeof(struct sockaddr_in);
+	}
+	retval=recvmmsg(con[con_index].fid,msgs,batch,MSG_DONTWAIT,NULL);
+	for(n=0;n<retval;n++)
+	    sizes[received+n]=msgs[n].msg_len;
+	if(retval>0)
+	    from=addrs[retval-1];
+#else
+	int fromlen=sizeof(from);
+	retval=recvfrom(con[con_index].fid,&buff->ptr[received*maxsize],maxsize,MSG_NOSIGNAL,
+			(struct sockaddr *)&from,&fromlen);
+	if(retval>=0){
+	    sizes[received]=retval;
+	    retval=1;
+	}
+#endif
+	if(retval<0 && s_errno!=EWOULDBLOCK){
+	    perror( "recvmmsg() / recvfrom()" );
+	    break;
+	}
+	if(retval>0){
+	    received+=retval;
+	    con[con_index].remote_addr.sin_addr = from.sin_addr;
+	    con[con_index].remote_addr.sin_port = from.sin_port;
+	}else if(received>0 || noblock || timeoutat<=my_now())
+	    break;
+	else
+	    usleep(DEFAULT_USLEEP);
+    }
+    // Move packets together. The buffer is kept at its size, so the next batch
+    // doesn't need to realloc() it again:
+    for(n=0;n<received;n++){
+	memmove(&buff->ptr[buff->pos],&buff->ptr[n*maxsize],(int)sizes[n]);
+	buff->pos+=(int)sizes[n];
+    }
+    return received;
+}
+
+#ifdef PNET_ASYNC
+/********************************************************************/
+/* Current time in seconds, in the CLOCK_REALTIME timebase of GetSecs */
+double async_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME,&ts);
+    return (double)ts.tv_sec+1e-9*(double)ts.tv_nsec;
+}
+
+/********************************************************************/
+/* Queue a record for bytes start to stop, ending at end. Mutex held. */
+void async_pushrecord(async_info *a,long long start,long long stop,long long end)
+{
+    async_record *r=&a->records[a->rechead%a->maxrecords];
+    r->start=start;
+    r->len=(int)(stop-start);
+    r->end=end;
+    r->time=a->lasttime;
+    a->rechead++;
+}
+
+/********************************************************************/
+/* Scan received bytes for newlines and queue each complete line.   */
+/* Only bytes not scanned before are scanned. Mutex held.           */
+void async_scanlines(async_info *a)
+{
+    while(a->scanpos<a->head && a->rechead-a->rectail<a->maxrecords){
+	const int off=(int)(a->scanpos%a->ringsize);
+	int n=a->ringsize-off;
+	long long pos,stop;
+	char *nl;
+	if(n>a->head-a->scanpos)
+	    n=(int)(a->head-a->scanpos);
+	nl=memchr(&a->ring[off],'\n',n);
+	if(nl==NULL){
+	    a->scanpos+=n;
+	    continue;
+	}
+	pos=a->scanpos+(nl-&a->ring[off]);
+	stop=pos;
+	if(stop>a->linestart && a->ring[(stop-1)%a->ringsize]=='\r')  // Strip carriage return as well.
+	    stop--;
+	async_pushrecord(a,a->linestart,stop,pos+1);
+	a->linestart=a->scanpos=pos+1;
+    }
+    // Ringbuffer filled by a single incomplete line? Return it as a splitted line, like 'readline':
+    if(a->head-a->tail==a->ringsize && a->rechead==a->rectail && a->linestart<a->head){
+	async_pushrecord(a,a->linestart,a->head,a->head);
+	a->linestart=a->scanpos=a->head;
+    }
+}
+
+/********************************************************************/
+/* Receive all pending data of a connection into its ringbuffer.    */
+/* Called by the receive thread with mutex held.                    */
+void async_receive(async_info *a)
+{
+    static char scratch[ASYNC_MAXPACKET];
+    struct iovec iov[3];
+    struct epoll_event ev;
+    int loops,n;
+
+    for(loops=0;loops<ASYNC_MAXEVENTS && !a->eof;loops++){
+	const int freebytes=a->ringsize-(int)(a->head-a->tail);
+	const int off=(int)(a->head%a->ringsize);
+	const int n1=(a->ringsize-off<freebytes)?a->ringsize-off:freebytes;
+	iov[0].iov_base=&a->ring[off];
+	iov[0].iov_len=n1;
+	iov[1].iov_base=a->ring;
+	iov[1].iov_len=freebytes-n1;
+	if(a->udp){
+	    // Packets which don't fit into the free space end up in scratch and get dropped:
+	    struct msghdr msg;
+	    struct cmsghdr *cmsg;
+	    char control[256];
+	    iov[2].iov_base=scratch;
+	    iov[2].iov_len=sizeof(scratch);
+	    memset(&msg,0,sizeof(msg));
+	    msg.msg_iov=iov;
+	    msg.msg_iovlen=3;
+	    msg.msg_control=control;
+	    msg.msg_controllen=sizeof(control);
+	    n=recvmsg(a->fid,&msg,MSG_DONTWAIT);
+	    if(n<0)
+		break;
+	    a->lasttime=async_now();
+	    for(cmsg=CMSG_FIRSTHDR(&msg);cmsg!=NULL;cmsg=CMSG_NXTHDR(&msg,cmsg)){
+		if(cmsg->cmsg_level==SOL_SOCKET && cmsg->cmsg_type==SCM_TIMESTAMPNS){
+		    struct timespec ts;
+		    memcpy(&ts,CMSG_DATA(cmsg),sizeof(ts));
+		    a->lasttime=(double)ts.tv_sec+1e-9*(double)ts.tv_nsec;
+		}
+	    }
+	    if(n>freebytes || (msg.msg_flags & MSG_TRUNC) || a->rechead-a->rectail>=a->maxrecords){
+		a->dropped++;
+		continue;
+	    }
+	    async_pushrecord(a,a->head,a->head+n,a->head+n);
+	    a->head+=n;
+	}else{
+	    if(freebytes==0)
+		break;
+	    n=readv(a->fid,iov,(freebytes>n1)?2:1);
+	    if(n<0 && (errno==EAGAIN || errno==EWOULDBLOCK || errno==EINTR))
+		break;
+	    if(n<=0){
+		a->eof=1;
+		break;
+	    }
+	    a->lasttime=async_now();
+	    a->head+=n;
+	    async_scanlines(a);
+	}
+    }
+    if(a->eof){
+	epoll_ctl(async_epfd,EPOLL_CTL_DEL,a->fid,&ev);
+    }else if(!a->udp && a->head-a->tail==a->ringsize){
+	// Ringbuffer full: Pause receive, so TCP flow control throttles the sender.
+	ev.events=0;
+	ev.data.ptr=a;
+	epoll_ctl(async_epfd,EPOLL_CTL_MOD,a->fid,&ev);
+	a->stalled=1;
+    }
+}
+
+/********************************************************************/
+/* Main loop of the background receive thread                       */
+void *async_threadmain(void *arg)
+{
+    struct epoll_event events[ASYNC_MAXEVENTS];
+    eventfd_t val;
+    int n,i;
+    while(1){
+	pthread_mutex_lock(&async_mutex);
+	async_generation++;
+	if(async_quit){
+	    pthread_mutex_unlock(&async_mutex);
+	    break;
+	}
+	pthread_mutex_unlock(&async_mutex);
+
+	n=epoll_wait(async_epfd,events,ASYNC_MAXEVENTS,-1);
+
+	pthread_mutex_lock(&async_mutex);
+	for(i=0;i<n;i++){
+	    if(events[i].data.ptr==NULL)
+		eventfd_read(async_wakefd,&val);
+	    else
+		async_receive((async_info *)events[i].data.ptr);
+	}
+	pthread_mutex_unlock(&async_mutex);
+    }
+    return NULL;
+}
+
+/********************************************************************/
+/* Start the background receive thread, if not already running      */
+void async_startthread(void)
+{
+    struct epoll_event ev;
+    if(async_epfd>=0)
+	return;
+    async_epfd=epoll_create(ASYNC_MAXEVENTS);
+    if(async_epfd<0)
+	mexErrMsgTxt("Could not create epoll instance for asynchronous receive!");
+    async_wakefd=eventfd(0,EFD_NONBLOCK);
+    ev.events=EPOLLIN;
+    ev.data.ptr=NULL;
+    async_quit=0;
+    if(async_wakefd<0 || epoll_ctl(async_epfd,EPOLL_CTL_ADD,async_wakefd,&ev)!=0 ||
+       pthread_create(&async_thread,NULL,async_threadmain,NULL)!=0){
+	if(async_wakefd>=0)
+	    close(async_wakefd);
+	close(async_epfd);
+	async_epfd=async_wakefd=-1;
+	mexErrMsgTxt("Could not start background receive thread!");
+    }
+}
+
+/********************************************************************/
+/* Stop the background receive thread, if running                   */
+void async_stopthread(void)
+{
+    if(async_epfd<0)
+	return;
+    pthread_mutex_lock(&async_mutex);
+    async_quit=1;
+    pthread_mutex_unlock(&async_mutex);
+    eventfd_write(async_wakefd,1);
+    pthread_join(async_thread,NULL);
+    close(async_wakefd);
+    close(async_epfd);
+    async_epfd=async_wakefd=-1;
+}
+
+/********************************************************************/
+/* Put current connection into asynchronous mode                    */
+void async_start(int ringsize,int maxrecords)
+{
+    con_info *c=&con[con_index];
+    async_info *a;
+    struct epoll_event ev;
+    const int on=1;
+
+    if(c->async)
+	mexErrMsgTxt("Connection is already in asynchronous mode!");
+    if(!IS_STATUS_IO_OK(c->status))
+	mexErrMsgTxt("Asynchronous mode needs a connected TCP connection or an UDP socket!");
+    if(ringsize<ASYNC_MAXPACKET)
+	ringsize=ASYNC_MAXPACKET;
+    if(maxrecords<1)
+	maxrecords=1;
+
+    a=(async_info *)calloc(1,sizeof(async_info));
+    if(a)
+	a->ring=(char *)malloc(ringsize);
+    if(a && a->ring)
+	a->records=(async_record *)malloc(maxrecords*sizeof(async_record));
+    if(a==NULL || a->ring==NULL || a->records==NULL){
+	if(a)
+	    free(a->ring);
+	free(a);
+	mexErrMsgTxt("Internal out of memory!");
+    }
+    a->fid=c->fid;
+    a->udp=!IS_STATUS_TCP_CONNECTED(c->status);
+    a->ringsize=ringsize;
+    a->maxrecords=maxrecords;
+    a->lasttime=async_now();
+
+    if(a->udp){
+	// Kernel arrival timestamps, and enough kernel buffer to ride out bursts:
+	setsockopt(a->fid,SOL_SOCKET,SO_TIMESTAMPNS,&on,sizeof(on));
+	setsockopt(a->fid,SOL_SOCKET,SO_RCVBUF,&ringsize,sizeof(ringsize));
+    }else if(c->read.pos>0){
+	// Take over data already in the read buffer:
+	const int n=(c->read.pos<ringsize)?c->read.pos:ringsize;
+	memcpy(a->ring,c->read.ptr,n);
+	a->head=n;
+	c->read.pos-=n;
+	memmove(c->read.ptr,&c->read.ptr[n],c->read.pos);
+	async_scanlines(a);
+    }
+
+    async_startthread();
+    pthread_mutex_lock(&async_mutex);
+    ev.events=EPOLLIN;
+    ev.data.ptr=a;
+    if(epoll_ctl(async_epfd,EPOLL_CTL_ADD,a->fid,&ev)!=0){
+	pthread_mutex_unlock(&async_mutex);
+	free(a->records);
+	free(a->ring);
+	free(a);
+	mexErrMsgTxt("Could not add connection to background receive thread!");
+    }
+    c->async=a;
+    pthread_mutex_unlock(&async_mutex);
+}
+
+/********************************************************************/
+/* Put current connection back into normal mode. Unfetched TCP data */
+/* goes back into the read buffer for the normal read commands.     */
+void async_stop(void)
+{
+    con_info *c=&con[con_index];
+    async_info *a=c->async;
+    struct epoll_event ev;
+    long long generation,n;
+    int done=0;
+
+    if(a==NULL)
+	return;
+    pthread_mutex_lock(&async_mutex);
+    epoll_ctl(async_epfd,EPOLL_CTL_DEL,a->fid,&ev);
+    c->async=NULL;
+    generation=async_generation;
+    pthread_mutex_unlock(&async_mutex);
+
+    // Wait until the receive thread is done with any events for this connection
+    // it may have fetched before the connection was removed from epoll:
+    eventfd_write(async_wakefd,1);
+    while(!done){
+	pthread_mutex_lock(&async_mutex);
+	done=(async_generation>generation);
+	pthread_mutex_unlock(&async_mutex);
+	if(!done)
+	    usleep(DEFAULT_USLEEP);
+    }
+
+    if(!a->udp){
+	n=a->head-a->tail;
+	if(n>0){
+	    const int off=(int)(a->tail%a->ringsize);
+	    const int n1=(a->ringsize-off<n)?a->ringsize-off:(int)n;
+	    newbuffsize(&c->read,c->read.pos+(int)n);
+	    memcpy(&c->read.ptr[c->read.pos],&a->ring[off],n1);
+	    memcpy(&c->read.ptr[c->read.pos+n1],a->ring,(int)n-n1);
+	    c->read.pos+=(int)n;
+	}
+	if(a->eof)
+	    c->status=STATUS_NOCONNECT;
+    }
+    free(a->records);
+    free(a->ring);
+    free(a);
+}
+
+/********************************************************************/
+/* Return all queued lines or packets of current connection as cell */
+/* array of row vectors, and their arrival times as column vector.  */
+void async_returnrecords(const int argno,int lines)
+{
+    con_info *c=&con[con_index];
+    async_info *a=c->async;
+    const int maxreturn=my_mexInputSize(argno);
+    const mxClassID id=(!lines && my_mexFindInputOption(argno,"UINT8"))?mxUINT8_CLASS:mxCHAR_CLASS;
+    mxArray *cell,*times;
+    int i,n;
+
+    if(a==NULL)
+	mexErrMsgTxt("Connection is not in asynchronous mode! Use 'asyncstart' first.");
+    if(!lines && !a->udp)
+	mexErrMsgTxt("'readpackets' works only with UDP sockets, use 'readlines' for TCP.");
+
+    pthread_mutex_lock(&async_mutex);
+    n=(int)(a->rechead-a->rectail);
+    if(n>maxreturn)
+	n=maxreturn;
+    cell=mxCreateCellMatrix(n,1);
+    times=mxCreateDoubleMatrix(n,1,mxREAL);
+    for(i=0;i<n;i++){
+	const async_record *r=&a->records[(a->rectail+i)%a->maxrecords];
+	const int off=(int)(r->start%a->ringsize);
+	int len=r->len,k;
+	mxArray *data;
+	// Strip line delimiters at end of packets:
+	if(lines && a->udp && len>0 && a->ring[(r->start+len-1)%a->ringsize]=='\n')
+	    len--;
+	if(lines && a->udp && len>0 && a->ring[(r->start+len-1)%a->ringsize]=='\r')
+	    len--;
+	if(id==mxUINT8_CLASS){
+	    unsigned char *p;
+	    const int n1=(a->ringsize-off<len)?a->ringsize-off:len;
+	    data=mxCreateNumericMatrix(1,len,mxUINT8_CLASS,mxREAL);
+	    p=(unsigned char *)mxGetData(data);
+	    memcpy(p,&a->ring[off],n1);
+	    memcpy(&p[n1],a->ring,len-n1);
+	}else{
+	    mwSize dims[2];
+	    mxChar *p;
+	    dims[0]=1;
+	    dims[1]=len;
+	    data=mxCreateCharArray(2,dims);
+	    p=(mxChar *)mxGetData(data);
+	    for(k=0;k<len;k++)
+		p[k]=(unsigned char)a->ring[(off+k)%a->ringsize];
+	}
+	mxSetCell(cell,i,data);
+	mxGetPr(times)[i]=r->time;
+    }
+    if(n>0){
+	a->tail=a->records[(a->rectail+n-1)%a->maxrecords].end;
+	a->rectail+=n;
+    }
+    // Continue with the space freed by this call:
+    if(!a->udp)
+	async_scanlines(a);
+    if(a->stalled){
+	struct epoll_event ev;
+	ev.events=EPOLLIN;
+	ev.data.ptr=a;
+	epoll_ctl(async_epfd,EPOLL_CTL_MOD,a->fid,&ev);
+	a->stalled=0;
+    }
+    pthread_mutex_unlock(&async_mutex);
+
+    if(! (gret_args>gnlhs && gret_args>1) )
+	gplhs[gret_args++]=cell;
+    else
+	mxDestroyArray(cell);
+    if(gnlhs>1)
+	gplhs[gret_args++]=times;
+    else
+	mxDestroyArray(times);
+}
+
+/********************************************************************/
+/* Returns [bytes, lines or packets, dropped packets, disconnected] */
+void async_status(void)
+{
+    async_info *a=con[con_index].async;
+    double stat[4]={0,0,0,0};
+    if(a){
+	pthread_mutex_lock(&async_mutex);
+	stat[0]=(double)(a->head-a->tail);
+	stat[1]=(double)(a->rechead-a->rectail);
+	stat[2]=a->dropped;
+	stat[3]=a->eof;
+	pthread_mutex_unlock(&async_mutex);
+    }
+    my_mexReturnMatrix(1,4,stat);
+}
+#endif
+
 /********************************************************************/
 /* Init current record with values                                  */
 void init_con(int fid,int status)
@@ -812,6 +1473,7 @@ void init_con(int fid,int status)
 /* Close con struct                                                 */
 void close_con()
 {
+    IFASYNC( async_stop(); )
     if(con[con_index].fid>=0)
 	close(con[con_index].fid);
     else
@@ -840,6 +1502,7 @@ void CleanUpMex(void)
 {
     if(closeall()) /* close all still open connections...*/
 	mexWarnMsgTxt("Unloading mex file. Unclosed tcp/udp/ip connections will be closed!");
+    IFASYNC( async_stopthread(); )
     IFWINDOWS(   WSACleanup();  );
 }
 
@@ -1161,6 +1824,34 @@ void mexFunction(
 	    writedata();
 	    return;
     }
+    IFASYNC( if(con[con_index].async && (myoptstrcmp(fun,"READ")==0 || myoptstrcmp(fun,"READLINE")==0 ||
+				       myoptstrcmp(fun,"READTOFILE")==0 || myoptstrcmp(fun,"READPACKET")==0))
+	mexErrMsgTxt("Connection is in asynchronous mode! Use 'readlines', 'readpackets' or 'asyncstop'."); )
+    if(myoptstrcmp(fun,"ASYNCSTART")==0){
+	IFASYNC( async_start(my_mexIsInputArgOK(2)?(int)my_mexInputScalar(2):ASYNC_DEFAULT_BUFFSIZE,
+			     my_mexIsInputArgOK(3)?(int)my_mexInputScalar(3):ASYNC_DEFAULT_RECORDS); )
+	IFNOASYNC( mexErrMsgTxt("Asynchronous mode is only supported on Linux."); )
+	return;
+    }
+    if(myoptstrcmp(fun,"ASYNCSTOP")==0){
+	IFASYNC( async_stop(); )
+	return;
+    }
+    if(myoptstrcmp(fun,"ASYNCSTATUS")==0){
+	IFASYNC( async_status(); )
+	IFNOASYNC( mexErrMsgTxt("Asynchronous mode is only supported on Linux."); )
+	return;
+    }
+    if(myoptstrcmp(fun,"READLINES")==0){
+	IFASYNC( async_returnrecords(2,1); )
+	IFNOASYNC( mexErrMsgTxt("Asynchronous mode is only supported on Linux."); )
+	return;
+    }
+    if(myoptstrcmp(fun,"READPACKETS")==0){
+	IFASYNC( async_returnrecords(2,0); )
+	IFNOASYNC( mexErrMsgTxt("Asynchronous mode is only supported on Linux."); )
+	return;
+    }
     if(myoptstrcmp(fun,"READ")==0){
 	    if(IS_STATUS_TCP_CONNECTED(con[con_index].status))
 	        readtype2buff( (int)my_mexInputSize(2),str2classid(my_mexFindInputString(2)),0,my_mexFindInputOption(2,"noblock"));
@@ -1236,6 +1927,34 @@ void mexFunction(
 	con[con_index].write.pos=0;
 	return;
     }
+    if(myoptstrcmp(fun,"WRITEPACKETBATCH")==0){
+	const int packetsize=(int)my_mexInputScalar(2);
+	if(IS_STATUS_TCP_CONNECTED(con[con_index].status))
+	    mexErrMsgTxt("'writepacketbatch' works only with UDP sockets.");
+	if(packetsize<1)
+	    mexErrMsgTxt("Invalid packetsize for 'writepacketbatch'.");
+	if(IS_STATUS_UDP_NO_CON(con[con_index].status))
+	    ipv4_lookup(my_mexInputOptionString(3),my_mexInputScalar(4));
+	my_mexReturnValue(writepacketbatch(packetsize));
+	return;
+    }
+    if(myoptstrcmp(fun,"READPACKETBATCH")==0){
+	const int maxpackets=(int)my_mexInputScalar(2);
+	const int maxsize=(my_mexIsInputArgOK(3) && !mxIsChar(my_mexInputArg(3)))?(int)my_mexInputScalar(3):65536;
+	double *sizes;
+	int n;
+	IFASYNC( if(con[con_index].async) mexErrMsgTxt("Connection is in asynchronous mode! Use 'readpackets' or 'asyncstop'."); )
+	if(IS_STATUS_TCP_CONNECTED(con[con_index].status))
+	    mexErrMsgTxt("'readpacketbatch' works only with UDP sockets.");
+	// newbuffsize() allocates twice the requested size as int, so stay well below INT_MAX:
+	if(maxpackets<1 || maxsize<1 || (double)maxpackets*maxsize>INT_MAX/4)
+	    mexErrMsgTxt("Invalid maxpackets or maxsize for 'readpacketbatch'.");
+	sizes=(double *)mxMalloc(maxpackets*sizeof(double));
+	n=readpacketbatch(maxpackets,maxsize,my_mexFindInputOption(2,"noblock"),sizes);
+	my_mexReturnMatrix(n,1,sizes);
+	mxFree(sizes);
+	return;
+    }
     if(myoptstrcmp(fun,"STATUS")==0){
 	my_mexReturnValue(con[con_index].status);
 	return;
@@ -204,6 +204,64 @@
 %     The packet is stored in the sockets read buffer and can then be readed
 %     from the buffer with same commands as for TCP connections. When reciving
 %     a new packet old non used data from the last packet is discarded.
+%     
+%  n=pnet(sock,'writepacketbatch',packetsize [,'hostname',port]);
+%     
+%     Splits contents of the sockets write buffer into UDP packets of at most
+%     "packetsize" bytes each and sends them all. Returns the number of sent
+%     packets. On Linux many packets are sent per system call, which makes
+%     streaming of large arrays much faster than a loop of 'writepacket'.
+%     
+%  sizes=pnet(sock,'readpacketbatch',maxpackets [,maxsize][,'noblock']);
+%     
+%     Receives up to "maxpackets" UDP packets of at most "maxsize" bytes
+%     each (by default 65536). Blocks until the first packet is received,
+%     then takes all packets already received. The packets are stored one
+%     after the other in the sockets read buffer and a column vector with
+%     the size of each packet is returned, so they can be read with 'read'.
+%
+%  Asynchronous receive (Linux only)
+%  =================================
+%
+%         A background thread can receive data on TCP connections and UDP
+%         sockets while matlab is busy with other things, e.g., during
+%         stimulus presentation. Received data is queued as lines (TCP) or
+%         packets (UDP) together with the time of arrival, in the same
+%         timebase as GetSecs. UDP packets get the arrival time of the kernel.
+%         All connections in asynchronous mode share one thread that waits
+%         for incoming data with epoll(), so there is no polling involved.
+%         While in asynchronous mode 'read', 'readline', 'readpacket' and
+%         'readtofile' can not be used on the connection.
+%     
+%  pnet(con,'asyncstart' [,buffsize][,maxrecords]);
+%     
+%     Puts connection/socket "con" into asynchronous mode. "buffsize" is the
+%     size of the receive buffer in bytes, by default 1048576. "maxrecords"
+%     is the maximum number of queued lines or packets, by default 8192. If
+%     the buffer of a TCP connection is full, receive pauses until data is
+%     fetched, so no data is lost. UDP packets which don't fit are dropped.
+%     
+%  pnet(con,'asyncstop');
+%     
+%     Stops asynchronous mode. Not yet fetched data of TCP connections is
+%     moved to the read buffer, for use with the normal read commands.
+%     
+%  [lines,times]=pnet(con,'readlines' [,maxlines]);
+%     
+%     Never blocks. Returns all queued lines, or at most "maxlines", as cell
+%     array of strings without newline characters, and their arrival times
+%     as column vector. For UDP sockets each packet is one line.
+%     
+%  [packets,times]=pnet(sock,'readpackets' [,maxpackets][,'uint8']);
+%     
+%     Like 'readlines' for UDP sockets, but packets are returned unmodified,
+%     as char or, with option 'uint8', as uint8 row vectors.
+%     
+%  stat=pnet(con,'asyncstatus');
+%     
+%     Returns [bytes, records, droppedpackets, disconnected] for the queued
+%     data of connection "con". "disconnected" is 1 if the remote host has
+%     closed the TCP connection. Queued data can still be fetched then.
 %
 %  General alternative syntax
 %  ==========================
@@ -64,6 +64,23 @@
 %                        then call to moglcore.mexmac to run OpenGL functions
 % 
 %
+% Command buffers: Sequences of OpenGL commands with scalar arguments, e.g.,
+% glBegin, glVertex3f, glColor3f, glTranslatef, can be recorded once and
+% then replayed with a single call, e.g., once per frame. This avoids the
+% overhead of thousands of individual calls into moglcore:
+%
+% handle = moglcore('BEGINBUFFER' [, handle]);  % Start recording.
+% ... OpenGL calls, recorded instead of executed ...
+% count = moglcore('ENDBUFFER');                % Stop recording.
+% moglcore('EXECBUFFER', handle);               % Replay the buffer.
+% moglcore('PATCHBUFFER', handle, cmdindices, argindices, values);
+% moglcore('DELETEBUFFER', handle);
+%
+% PATCHBUFFER changes arguments of recorded commands between replays,
+% commands and arguments numbered from 1 in order of recording. Commands
+% with return values or non-scalar arguments can not be recorded.
+% OpenGL errors are only checked once after each replayed buffer.
+%
 % The following three commands will completely regenerate mogl.
 % 
 % >> autocode     % generate gl_auto.c and wrapper M-files
@@ -73,3 +90,4 @@
 % 06-Jan-2006 -- created (RFM)
 % 27-Mar-2011 -- edited (MK)
 % 27-Mar-2011 -- Update info about license - New MIT license (MK)
+% 19-Oct-2026 -- Document command buffers (agent)
@@ -14,6 +14,7 @@
  * 24-Mar-2011 -- Make 64-bit clean (MK).
  * 27-Mar-2011 -- Remove obsolete and totally bitrotten Octave-2 support (MK).
  * 03-Apr-2011 -- Allow to receive pointers encoded in double's, uint32 or uint64. Adapt dynamically (MK).
+ * 19-Oct-2026 -- Hashed command lookup. Recordable command buffers, replayed via EXECBUFFER (agent).
  *
  */
 
@@ -56,9 +57,67 @@ static int glBeginLevel = 0;
 #define CMDLEN 64
 char cmd[CMDLEN];
 
+// Hash table for lookup of commands in gl_manual_map and gl_auto_map. Must be a
+// power of two and at least twice the number of commands for short probe sequences:
+#define MOGL_CMDHASHSIZE 2048
+static cmdhandler* cmdhash[MOGL_CMDHASHSIZE];
+static int cmdhashcount = 0;
+
+// Command buffers: Sequences of recorded OpenGL commands with their scalar arguments,
+// replayed by a single call to moglcore('EXECBUFFER', handle):
+#define MOGL_MAXCMDBUFFERS 1024
+#define MOGL_MAXRECORDARGS 16
+#define MOGL_MAXARGCLASSES 16
+#define MOGL_MAXREPLAYOUTARGS 4
+
+typedef struct moglcmdarg {
+    mxClassID       classid;    // Class of the scalar argument.
+    size_t          size;       // Size of the scalar in bytes.
+    union {
+        double          d;
+        float           f;
+        psych_uint64    u64;
+        unsigned char   bytes[8];
+    } data;                     // Value in its native format.
+} moglcmdarg;
+
+typedef struct moglcmdrecord {
+    cmdhandler*     handler;    // Resolved command: Name and wrapper function.
+    int             nargs;      // Number of arguments.
+    size_t          argoffset;  // Index of first argument in args[] of the buffer.
+} moglcmdrecord;
+
+typedef struct moglcmdbuffer {
+    moglcmdrecord*  records;
+    moglcmdarg*     args;
+    size_t          count;
+    size_t          maxcount;
+    size_t          argcount;
+    size_t          maxargcount;
+    int             beginbalance;   // Number of glBegin() minus number of glEnd() commands.
+} moglcmdbuffer;
+
+static moglcmdbuffer* cmdbuffers[MOGL_MAXCMDBUFFERS];
+
+// Handle of command buffer which is currently recorded, zero if none:
+static int recordbuffer = 0;
+
+// Persistent scalar arrays to pass arguments during replay, one per argument slot and class:
+static mxArray* replayargs[MOGL_MAXRECORDARGS][MOGL_MAXARGCLASSES];
+
 // binary search routine
 int binsearch(cmdhandler *map, int mapsize, char *str);
 
+// hashed command lookup in gl_manual_map and gl_auto_map
+cmdhandler* mogl_lookupcmd(const char *str);
+
+// command buffer routines
+void mogl_recordcmd(cmdhandler* handler, int nlhs, int nrhs, const mxArray *prhs[]);
+void mogl_execbuffer(moglcmdbuffer* buf);
+void mogl_patchbuffer(moglcmdbuffer* buf, const mxArray *cmdindices, const mxArray *argindices, const mxArray *values);
+moglcmdbuffer* mogl_getcmdbuffer(int nrhs, const mxArray *prhs[]);
+void mogl_deletecmdbuffer(int handle);
+
 // error handler
 void mogl_usageerr();
 
@@ -83,6 +142,8 @@ void mogl_checkerrors(const char* cmd, const mxArray *prhs[]);
 
 void mexExitFunction(void)
 {
+  int i, j;
+
   // Release all memory in bufferlist 1 - The one that usually
   // persists over calls to moglcore.
   PsychFreeAllTempMemory(1);
@@ -90,7 +151,17 @@ void mexExitFunction(void)
   // Release all memory for persistent GLU tesselator memory list:
   PsychFreeAllTempMemory(2);
   PsychFreeAllTempMemory(3);
-  
+
+  // Release all command buffers and their replay arguments:
+  recordbuffer = 0;
+  for (i = 1; i <= MOGL_MAXCMDBUFFERS; i++) mogl_deletecmdbuffer(i);
+  for (i = 0; i < MOGL_MAXRECORDARGS; i++) {
+      for (j = 0; j < MOGL_MAXARGCLASSES; j++) {
+          if (replayargs[i][j]) mxDestroyArray(replayargs[i][j]);
+          replayargs[i][j] = NULL;
+      }
+  }
+
   firsttime = 1;
 }
 
@@ -103,6 +174,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     // Start of dispatcher:
     int i;
     GLenum err;
+    cmdhandler* handler;
+    moglcmdbuffer* buf;
 
     // see whether there's a string command
     if(nrhs<1 || !mxIsChar(prhs[0])) mogl_usageerr();
@@ -152,6 +225,61 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
       goto moglreturn;
     }
 
+    // Command buffer management. These subcommands are all upper case, so the gl*, glu*
+    // and glm* commands can skip these string compares:
+    if (cmd[0] != 'g') {
+        // handle = moglcore('BEGINBUFFER' [, handle]): Start recording of commands into a new
+        // command buffer, or into the existing buffer 'handle', replacing its old content:
+        if (strcmp(cmd, "BEGINBUFFER")==0) {
+            if (recordbuffer > 0) mogl_printfexit("MOGL-ERROR: BEGINBUFFER called while a command buffer is already recorded! Call ENDBUFFER first.");
+
+            if (nrhs >= 2) {
+                buf = mogl_getcmdbuffer(nrhs, prhs);
+                i = (int) mxGetScalar(prhs[1]);
+                buf->count = 0;
+                buf->argcount = 0;
+                buf->beginbalance = 0;
+            }
+            else {
+                for (i = 1; i <= MOGL_MAXCMDBUFFERS && cmdbuffers[i - 1]; i++);
+                if (i > MOGL_MAXCMDBUFFERS) mogl_printfexit("MOGL-ERROR: Maximum number of command buffers reached! Delete unused ones via DELETEBUFFER.");
+                cmdbuffers[i - 1] = (moglcmdbuffer*) calloc(1, sizeof(moglcmdbuffer));
+                if (NULL == cmdbuffers[i - 1]) mexErrMsgTxt("MOGL-FATAL ERROR: Out of memory in BEGINBUFFER!\n");
+            }
+
+            recordbuffer = i;
+            plhs[0] = mxCreateDoubleMatrix(1, 1, mxREAL);
+            *mxGetPr(plhs[0]) = (double) i;
+            goto moglreturn;
+        }
+
+        // count = moglcore('ENDBUFFER'): Stop recording, return number of recorded commands:
+        if (strcmp(cmd, "ENDBUFFER")==0) {
+            if (recordbuffer == 0) mogl_printfexit("MOGL-ERROR: ENDBUFFER called without a preceding BEGINBUFFER!");
+            plhs[0] = mxCreateDoubleMatrix(1, 1, mxREAL);
+            *mxGetPr(plhs[0]) = (double) cmdbuffers[recordbuffer - 1]->count;
+            recordbuffer = 0;
+            goto moglreturn;
+        }
+
+        // moglcore('PATCHBUFFER', handle, cmdindices, argindices, values): Change arguments of recorded commands:
+        if (strcmp(cmd, "PATCHBUFFER")==0) {
+            buf = mogl_getcmdbuffer(nrhs, prhs);
+            if (nrhs < 5) mogl_printfexit("MOGL-ERROR: PATCHBUFFER needs a buffer handle and vectors of command indices, argument indices and values!");
+            mogl_patchbuffer(buf, prhs[2], prhs[3], prhs[4]);
+            goto moglreturn;
+        }
+
+        // moglcore('DELETEBUFFER', handle): Delete a command buffer:
+        if (strcmp(cmd, "DELETEBUFFER")==0) {
+            mogl_getcmdbuffer(nrhs, prhs);
+            i = (int) mxGetScalar(prhs[1]);
+            if (recordbuffer == i) recordbuffer = 0;
+            mogl_deletecmdbuffer(i);
+            goto moglreturn;
+        }
+    }
+
     // Abort here if dummymode >= 10: Input arg. processing run, but no real
     // command parsing and processing;
     if (dummymode >= 10) {
@@ -215,6 +343,14 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
         firsttime = 0;
     }   
 	
+    // Command buffer recording active? Then record the command instead of executing it:
+    if (recordbuffer > 0) {
+        if (strcmp(cmd, "EXECBUFFER")==0) mogl_printfexit("MOGL-ERROR: EXECBUFFER can not be called while a command buffer is recorded!");
+        if ((handler = mogl_lookupcmd(cmd)) == NULL) mogl_usageerr();
+        mogl_recordcmd(handler, nlhs, nrhs - 1, (const mxArray**) prhs + 1);
+        goto moglreturn;
+    }
+
     // If glBeginLevel >  1 then most probably the script was aborted after execution of glBegin() but
     // before execution of glEnd(). In that case, we reset the level to zero.
     if (glBeginLevel > 1) glBeginLevel = 0;
@@ -223,16 +359,21 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[])
     // relate to errors caused by us:
     if (glBeginLevel == 0 && debuglevel > 0 && (strstr(cmd, "glGetError")==NULL)) glGetError();
         
-    // look for command in manual command map
-    if( (i=binsearch(gl_manual_map,gl_manual_map_count,cmd))>=0 ) {
-        gl_manual_map[i].cmdfn(nlhs,plhs,nrhs-1,(const mxArray**) prhs+1);
+    // look for command in manual and auto command map, manual map takes precedence
+    if( (handler=mogl_lookupcmd(cmd))!=NULL ) {
+        handler->cmdfn(nlhs,plhs,nrhs-1,(const mxArray**) prhs+1);
         if (debuglevel > 0) mogl_checkerrors(cmd, prhs);
         goto moglreturn;
     }
-    
-    // look for command in auto command map
-    if( (i=binsearch(gl_auto_map,gl_auto_map_count,cmd))>=0 ) {
-        gl_auto_map[i].cmdfn(nlhs,plhs,nrhs-1,(const mxArray**) prhs+1);
+
+    // moglcore('EXECBUFFER', handle): Replay all commands in a command buffer:
+    if (strcmp(cmd, "EXECBUFFER")==0) {
+        buf = mogl_getcmdbuffer(nrhs, prhs);
+        mogl_execbuffer(buf);
+
+        // Account for glBegin() and glEnd() in the buffer, then check for errors once for the whole buffer:
+        glBeginLevel += buf->beginbalance;
+        if (glBeginLevel < 0) glBeginLevel = 0;
         if (debuglevel > 0) mogl_checkerrors(cmd, prhs);
         goto moglreturn;
     }
@@ -262,6 +403,257 @@ int binsearch(cmdhandler *map, int mapsize, char *str) {
     return( -1 );
 }
 
+// hash function for command strings (FNV-1a)
+static unsigned int mogl_hashstr(const char *str) {
+    unsigned int h = 2166136261U;
+    while (*str) {
+        h ^= (unsigned char) *(str++);
+        h *= 16777619U;
+    }
+    return( h );
+}
+
+// insert a command map into the command hash table, unless a command of the same name is already in it
+static void mogl_hashcmdmap(cmdhandler *map, int mapsize) {
+    unsigned int h;
+    int i;
+
+    for (i = 0; i < mapsize; i++) {
+        h = mogl_hashstr(map[i].cmdstr) & (MOGL_CMDHASHSIZE - 1);
+        while (cmdhash[h] && strcmp(cmdhash[h]->cmdstr, map[i].cmdstr)) h = (h + 1) & (MOGL_CMDHASHSIZE - 1);
+        if (NULL == cmdhash[h]) {
+            cmdhash[h] = &map[i];
+            cmdhashcount++;
+        }
+    }
+}
+
+// look up a command in gl_manual_map and gl_auto_map via the command hash table
+cmdhandler* mogl_lookupcmd(const char *str) {
+    unsigned int h;
+
+    // Build hash table on first use, manual map first, so it takes precedence:
+    if (cmdhashcount == 0) {
+        if (2 * (gl_manual_map_count + gl_auto_map_count) > MOGL_CMDHASHSIZE) mexErrMsgTxt("MOGL-BUG: MOGL_CMDHASHSIZE too small for number of commands! Increase it and recompile.");
+        mogl_hashcmdmap(gl_manual_map, gl_manual_map_count);
+        mogl_hashcmdmap(gl_auto_map, gl_auto_map_count);
+    }
+
+    h = mogl_hashstr(str) & (MOGL_CMDHASHSIZE - 1);
+    while (cmdhash[h]) {
+        if (strcmp(cmdhash[h]->cmdstr, str) == 0) return( cmdhash[h] );
+        h = (h + 1) & (MOGL_CMDHASHSIZE - 1);
+    }
+
+    return( NULL );
+}
+
+// Command buffers:
+//
+// Scripts which issue thousands of small commands like glVertex3f() or glTranslatef()
+// per frame spend most of their time in the Matlab/Octave -> moglcore call overhead
+// and command lookup. Such sequences can be recorded once into a command buffer:
+//
+// handle = moglcore('BEGINBUFFER' [, handle]);
+// ... calls to gl-commands, recorded instead of executed ...
+// count = moglcore('ENDBUFFER');
+//
+// and then replayed with a single call, e.g., once per frame:
+//
+// moglcore('EXECBUFFER', handle);
+//
+// Recording resolves the command name once. Replay passes the recorded arguments to
+// the command wrappers via persistent scalar arrays, without any lookup or per-call
+// allocation. Only commands without return values and with real numeric scalar
+// arguments can be recorded. glGetError() is only checked once after a whole buffer,
+// not after each command. Arguments can be changed between replays, e.g., for animation:
+//
+// moglcore('PATCHBUFFER', handle, cmdindices, argindices, values);
+//
+// sets argument argindices(k) of recorded command cmdindices(k) to values(k), both
+// 1-based, with commands numbered in the order of recording. Values are converted
+// into the class of the recorded argument. moglcore('DELETEBUFFER', handle) deletes
+// a buffer.
+
+// report a command which can't be recorded
+static void mogl_recorderr(const char* cmdstr) {
+    char errtxt[1000];
+
+    recordbuffer = 0;
+    sprintf(errtxt, "MOGL-ERROR: Command %s() can not be recorded into a command buffer: Only commands without return values\n"
+                    "MOGL-ERROR: and with at most %i real numeric scalar arguments can be recorded. Recording aborted.\n", cmdstr, MOGL_MAXRECORDARGS);
+    mogl_printfexit(errtxt);
+}
+
+// append a command with its arguments to the command buffer which is currently recorded
+void mogl_recordcmd(cmdhandler* handler, int nlhs, int nrhs, const mxArray *prhs[]) {
+    moglcmdbuffer* buf = cmdbuffers[recordbuffer - 1];
+    moglcmdrecord* rec;
+    moglcmdarg* arg;
+    void* p;
+    size_t n;
+    int j;
+
+    if (nlhs > 0 || nrhs > MOGL_MAXRECORDARGS) mogl_recorderr(handler->cmdstr);
+    for (j = 0; j < nrhs; j++) {
+        if (!mxIsNumeric(prhs[j]) || mxIsComplex(prhs[j]) || (mxGetNumberOfElements(prhs[j]) != 1) ||
+            (mxGetElementSize(prhs[j]) > sizeof(psych_uint64)) || ((int) mxGetClassID(prhs[j]) >= MOGL_MAXARGCLASSES)) mogl_recorderr(handler->cmdstr);
+    }
+
+    // Grow record and argument arrays if needed:
+    if (buf->count == buf->maxcount) {
+        n = (buf->maxcount > 0) ? 2 * buf->maxcount : 256;
+        if (NULL == (p = realloc(buf->records, n * sizeof(moglcmdrecord)))) mexErrMsgTxt("MOGL-FATAL ERROR: Out of memory in command buffer recording!\n");
+        buf->records = (moglcmdrecord*) p;
+        buf->maxcount = n;
+    }
+
+    if (buf->argcount + nrhs > buf->maxargcount) {
+        n = (buf->maxargcount > 0) ? 2 * buf->maxargcount : 1024;
+        if (NULL == (p = realloc(buf->args, n * sizeof(moglcmdarg)))) mexErrMsgTxt("MOGL-FATAL ERROR: Out of memory in command buffer recording!\n");
+        buf->args = (moglcmdarg*) p;
+        buf->maxargcount = n;
+    }
+
+    rec = &(buf->records[buf->count]);
+    rec->handler = handler;
+    rec->nargs = nrhs;
+    rec->argoffset = buf->argcount;
+
+    for (j = 0; j < nrhs; j++) {
+        arg = &(buf->args[buf->argcount + j]);
+        arg->classid = mxGetClassID(prhs[j]);
+        arg->size = mxGetElementSize(prhs[j]);
+        arg->data.u64 = 0;
+        memcpy(arg->data.bytes, mxGetData(prhs[j]), arg->size);
+
+        // Create persistent replay argument for this slot and class, if not yet done:
+        if (NULL == replayargs[j][arg->classid]) {
+            replayargs[j][arg->classid] = mxCreateNumericMatrix(1, 1, arg->classid, mxREAL);
+            mexMakeArrayPersistent(replayargs[j][arg->classid]);
+        }
+    }
+
+    buf->argcount += nrhs;
+    buf->count++;
+
+    if (strcmp(handler->cmdstr, "glBegin")==0) buf->beginbalance++;
+    if (strcmp(handler->cmdstr, "glEnd")==0) buf->beginbalance--;
+}
+
+// replay all commands in a command buffer
+void mogl_execbuffer(moglcmdbuffer* buf) {
+    mxArray* outargs[MOGL_MAXREPLAYOUTARGS];
+    const mxArray* inargs[MOGL_MAXRECORDARGS];
+    moglcmdrecord* rec;
+    moglcmdarg* arg;
+    size_t i;
+    int j;
+
+    for (j = 0; j < MOGL_MAXREPLAYOUTARGS; j++) outargs[j] = NULL;
+
+    for (i = 0; i < buf->count; i++) {
+        rec = &(buf->records[i]);
+        arg = &(buf->args[rec->argoffset]);
+        for (j = 0; j < rec->nargs; j++) {
+            memcpy(mxGetData(replayargs[j][arg[j].classid]), arg[j].data.bytes, arg[j].size);
+            inargs[j] = replayargs[j][arg[j].classid];
+        }
+
+        rec->handler->cmdfn(0, outargs, rec->nargs, inargs);
+
+        // Some wrappers return values even if none are requested. Release them:
+        for (j = 0; j < MOGL_MAXREPLAYOUTARGS; j++) {
+            if (outargs[j]) mxDestroyArray(outargs[j]);
+            outargs[j] = NULL;
+        }
+    }
+}
+
+// change arguments of recorded commands in a command buffer
+void mogl_patchbuffer(moglcmdbuffer* buf, const mxArray *cmdindices, const mxArray *argindices, const mxArray *values) {
+    moglcmdarg* arg;
+    double *c, *a, *v;
+    size_t k, n, ci, ai;
+
+    n = mxGetNumberOfElements(cmdindices);
+    if (!mxIsDouble(cmdindices) || !mxIsDouble(argindices) || !mxIsDouble(values) ||
+        (mxGetNumberOfElements(argindices) != n) || (mxGetNumberOfElements(values) != n)) {
+        mogl_printfexit("MOGL-ERROR: PATCHBUFFER needs double vectors of command indices, argument indices and values of equal length!");
+    }
+
+    c = mxGetPr(cmdindices);
+    a = mxGetPr(argindices);
+    v = mxGetPr(values);
+
+    for (k = 0; k < n; k++) {
+        if (c[k] < 1 || c[k] > (double) buf->count) mogl_printfexit("MOGL-ERROR: PATCHBUFFER command index out of range!");
+        ci = (size_t) c[k] - 1;
+        if (a[k] < 1 || a[k] > (double) buf->records[ci].nargs) mogl_printfexit("MOGL-ERROR: PATCHBUFFER argument index out of range!");
+        ai = (size_t) a[k] - 1;
+        arg = &(buf->args[buf->records[ci].argoffset + ai]);
+
+        switch (arg->classid) {
+            case mxDOUBLE_CLASS:
+                arg->data.d = v[k];
+                break;
+            case mxSINGLE_CLASS:
+                arg->data.f = (float) v[k];
+                break;
+            case mxINT8_CLASS:
+                *((signed char*) arg->data.bytes) = (signed char) v[k];
+                break;
+            case mxUINT8_CLASS:
+                *((unsigned char*) arg->data.bytes) = (unsigned char) v[k];
+                break;
+            case mxINT16_CLASS:
+                *((short*) arg->data.bytes) = (short) v[k];
+                break;
+            case mxUINT16_CLASS:
+                *((unsigned short*) arg->data.bytes) = (unsigned short) v[k];
+                break;
+            case mxINT32_CLASS:
+                *((int*) arg->data.bytes) = (int) v[k];
+                break;
+            case mxUINT32_CLASS:
+                *((unsigned int*) arg->data.bytes) = (unsigned int) v[k];
+                break;
+            #ifndef MATLABR11
+            case mxINT64_CLASS:
+                *((psych_int64*) arg->data.bytes) = (psych_int64) v[k];
+                break;
+            case mxUINT64_CLASS:
+                arg->data.u64 = (psych_uint64) v[k];
+                break;
+            #endif
+            default:
+                mogl_printfexit("MOGL-ERROR: PATCHBUFFER can not patch argument of this type!");
+        }
+    }
+}
+
+// validate command buffer handle in prhs[1], return its command buffer
+moglcmdbuffer* mogl_getcmdbuffer(int nrhs, const mxArray *prhs[]) {
+    int handle;
+
+    if (nrhs < 2) mogl_printfexit("MOGL-ERROR: Command buffer handle missing!");
+    handle = (int) mxGetScalar(prhs[1]);
+    if (handle < 1 || handle > MOGL_MAXCMDBUFFERS || NULL == cmdbuffers[handle - 1]) mogl_printfexit("MOGL-ERROR: Invalid command buffer handle!");
+
+    return( cmdbuffers[handle - 1] );
+}
+
+// delete a command buffer, if it exists
+void mogl_deletecmdbuffer(int handle) {
+    moglcmdbuffer* buf = cmdbuffers[handle - 1];
+
+    if (NULL == buf) return;
+    free(buf->records);
+    free(buf->args);
+    free(buf);
+    cmdbuffers[handle - 1] = NULL;
+}
+
 // error handler
 void mogl_usageerr() {
     glBeginLevel = 0;
@@ -147,8 +147,10 @@ typedef struct mogl_tess_struct {
 // Definition of unsigned int 64 bit datatype for Windows vs. Unix
 #ifndef WINDOWS
 typedef unsigned long long int psych_uint64;
+typedef long long int psych_int64;
 #else
 typedef ULONGLONG psych_uint64;
+typedef LONGLONG psych_int64;
 #endif
 
 // Definition of how a memory pointer is encoded in the runtime env.
@@ -0,0 +1,165 @@
+function results = ARToolkitDetectionBenchmark(nFrames, imgSize)
+% ARToolkitDetectionBenchmark - Benchmark PsychCV's ARToolkit marker detection.
+%
+% Usage: results = ARToolkitDetectionBenchmark([nFrames=300][, imgSize=[640 480]])
+%
+% Synthesizes test scene images from the marker patterns 'patt.hiro' and
+% 'patt.kanji' stored in PsychDemos/ARToolkitDemoData/, then times marker
+% detection and pose estimation on them, both in the classic synchronous
+% mode via PsychCV('ARDetectMarkers') and in the asynchronous mode via
+% PsychCV('ARDetectMarkersAsync') and PsychCV('ARDetectMarkersPoll').
+%
+% For the asynchronous mode, the time the calling thread is blocked per
+% frame is reported separately from the detection time on the worker
+% thread, as the former is what matters for the responsiveness of an
+% experiment loop.
+%
+% No camera or onscreen window is needed for this benchmark.
+%
+% Parameters:
+%
+% nFrames = Number of frames to process in each mode. Defaults to 300.
+%
+% imgSize = [width, height] of the synthetic scene images. Defaults to
+% [640 480].
+%
+% Returns a struct 'results' with the measured timings in seconds and
+% the fraction of frames in which both markers were detected.
+%
+
+% History:
+% 19.10.2026  agent  Written.
+
+if ~IsOctave
+    error('Sorry, ARToolkit support (= the PsychCV mex file) is currently only available on GNU/Octave, not on Matlab.');
+end
+
+if nargin < 1 || isempty(nFrames)
+    nFrames = 300;
+end
+
+if nargin < 2 || isempty(imgSize)
+    imgSize = [640 480];
+end
+
+w = imgSize(1);
+h = imgSize(2);
+
+ardata = [ PsychtoolboxRoot 'PsychDemos/ARToolkitDemoData/' ];
+
+% Build a set of scene images with both markers at different positions
+% and sizes, as grayscale images in ARToolkits row-major memory layout:
+nScenes = 8;
+scenes = cell(1, nScenes);
+for i = 1:nScenes
+    img = uint8(255 * ones(h, w));
+    sz = round(min(w, h) * (0.25 + 0.05 * mod(i, 3)));
+    img = PasteMarker(img, LoadPattern([ardata 'patt.hiro']), sz, round(w * 0.1) + 4 * i, round(h * 0.2) + 2 * i);
+    img = PasteMarker(img, LoadPattern([ardata 'patt.kanji']), sz, round(w * 0.55) - 3 * i, round(h * 0.3) + 3 * i);
+    scenes{i} = img';
+end
+
+olddir = pwd;
+
+try
+    PsychCV('Verbosity', 2);
+    imgbuffer = PsychCV('ARInitialize', [ardata 'camera_para.dat'], w, h, 1);
+
+    % Need to cd() into marker directory, as some paths inside the marker
+    % config files are coded relative to working directory:
+    cd(ardata);
+    marker(1) = PsychCV('ARLoadMarker', 'patt.hiro', 0);
+    marker(2) = PsychCV('ARLoadMarker', 'patt.kanji', 0);
+    cd(olddir);
+
+    % Synchronous detection:
+    tsync = zeros(1, nFrames);
+    detsync = 0;
+    for i = 1:nFrames
+        PsychCV('CopyMatrixToMemBuffer', scenes{mod(i, nScenes) + 1}, imgbuffer);
+        t = GetSecs;
+        detectedMarkers = PsychCV('ARDetectMarkers', [], 128);
+        tsync(i) = GetSecs - t;
+        detsync = detsync + all([detectedMarkers.MatchError] < realmax);
+    end
+
+    % Asynchronous detection: Keep two frames in flight, like a video
+    % capture loop would do:
+    tblock = zeros(1, nFrames);
+    tworker = [];
+    latency = [];
+    detasync = 0;
+    dropped = 0;
+    tstart = GetSecs;
+    for i = 1:nFrames
+        t = GetSecs;
+        PsychCV('CopyMatrixToMemBuffer', scenes{mod(i, nScenes) + 1}, imgbuffer);
+        [frameId, dropped] = PsychCV('ARDetectMarkersAsync', [], 128, t); %#ok<ASGLU>
+        [detectedMarkers, frameTimestamp, frameId, detectDuration] = PsychCV('ARDetectMarkersPoll', (i > 2));
+        tblock(i) = GetSecs - t;
+        if frameId >= 0
+            tworker(end+1) = detectDuration; %#ok<AGROW>
+            latency(end+1) = GetSecs - frameTimestamp; %#ok<AGROW>
+            detasync = detasync + all([detectedMarkers.MatchError] < realmax);
+        end
+    end
+
+    % Drain the queue:
+    while 1
+        [detectedMarkers, frameTimestamp, frameId, detectDuration] = PsychCV('ARDetectMarkersPoll', 1);
+        if frameId < 0
+            break;
+        end
+        tworker(end+1) = detectDuration; %#ok<AGROW>
+        latency(end+1) = GetSecs - frameTimestamp; %#ok<AGROW>
+        detasync = detasync + all([detectedMarkers.MatchError] < realmax);
+    end
+    tasynctotal = GetSecs - tstart;
+
+    PsychCV('ARShutdown');
+catch
+    cd(olddir);
+    PsychCV('ARShutdown');
+    psychrethrow(psychlasterror);
+end
+
+results.syncDetectTime = tsync;
+results.syncDetectionRate = detsync / nFrames;
+results.asyncBlockTime = tblock;
+results.asyncWorkerTime = tworker;
+results.asyncLatency = latency;
+results.asyncDetectionRate = detasync / numel(tworker);
+results.asyncDroppedFrames = dropped;
+results.asyncFramesPerSecond = numel(tworker) / tasynctotal;
+
+fprintf('\nARToolkit detection benchmark: %i frames of %i x %i pixels, 2 markers.\n\n', nFrames, w, h);
+fprintf('Synchronous : %f msecs per frame (median), %f msecs max. Detection rate %f %%.\n', 1000 * median(tsync), 1000 * max(tsync), 100 * results.syncDetectionRate);
+fprintf('Asynchronous: Calling thread blocked for %f msecs per frame (median), %f msecs max.\n', 1000 * median(tblock), 1000 * max(tblock));
+fprintf('              Worker needs %f msecs per frame (median). Latency submit -> poll %f msecs (median).\n', 1000 * median(tworker), 1000 * median(latency));
+fprintf('              %f frames per second, %i frames dropped. Detection rate %f %%.\n\n', results.asyncFramesPerSecond, dropped, 100 * results.asyncDetectionRate);
+
+return;
+
+% Load the first (unrotated) 16 x 16 pattern from an ARToolkit pattern
+% file, convert it from BGR to luminance:
+function patt = LoadPattern(filename)
+fid = fopen(filename, 'rt');
+if fid == -1
+    error('Could not open marker pattern file %s.', filename);
+end
+data = fscanf(fid, '%d', 3 * 16 * 16);
+fclose(fid);
+data = reshape(data, 16, 16, 3);
+patt = uint8(mean(permute(data, [2 1 3]), 3));
+return;
+
+% Paste a marker of 'sz' x 'sz' pixels at top-left position (x,y) into
+% image 'img': The pattern covers the inner half of the marker, surrounded
+% by a black border of a quarter marker width on each side:
+function img = PasteMarker(img, patt, sz, x, y)
+marker = zeros(sz, sz);
+inner = round(sz / 4) + 1 : sz - round(sz / 4);
+idx = ceil((1:numel(inner)) * 16 / numel(inner));
+marker(inner, inner) = patt(idx, idx);
+img(y:y+sz-1, x:x+sz-1) = uint8(marker);
+return;
@@ -3,6 +3,7 @@
 % help Psychtoolbox % For an overview, triple-click me & hit enter.
 % help PsychDemos % For demos, triple-click me & hit enter.
 %
+%   ARToolkitDetectionBenchmark     - Benchmark synchronous vs. asynchronous PsychCV ARToolkit marker detection.
 %   AlphaAdditionTest               - Combine planes by OpenGL alpha addition and verify the result.
 %   AlphaBlendingTest               - Multiple tests of OpenGL alpha blending. 
 %   AlphaBlendSettingTest           - Set and readback alpha blending settings by screen; verify match. 
@@ -53,6 +54,8 @@
 %   PsychHIDTest                    - PsychHID MEX file for HID-compliant USB devices.
 %   PupilDiameterTest               - Test functions that compute pupil diameter from luminance.
 %   PsychPortAudioDataPixxTimingTest - Test PsychPortAudio's timing with a DataPixx device and a audio line cable.
+%   PsychPortAudioOfflineBenchmark  - Benchmark audio processing cost of PsychPortAudio on offline devices, without sound hardware.
+%   PsychPortAudioResamplingBenchmark - Measure quality and speed of PsychPortAudio sample rate conversion.
 %   PsychPortAudioTimingTest        - Testsignal generator for test of PsychPortAudios timing with external measurement equipment.
 %   QuestTest                       - Some Quest simulations, more elaborate than QuestDemo.
 %   ResolutionTest                  - Use Screen Resolutions to print table of display resolutions.
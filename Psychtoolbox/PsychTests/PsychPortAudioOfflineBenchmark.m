@@ -0,0 +1,123 @@
+function results = PsychPortAudioOfflineBenchmark(topology, nrchannels, buffersize, duration, freq)
+% PsychPortAudioOfflineBenchmark - Benchmark audio processing of PsychPortAudio.
+%
+% Usage: results = PsychPortAudioOfflineBenchmark([topology=[8]][, nrchannels=2][, buffersize=256][, duration=10][, freq=48000])
+%
+% Opens one or more offline render devices via PsychPortAudio('OpenOffline'),
+% each as a master device with a number of playback slave devices attached,
+% plays white noise on all slaves, and renders 'duration' seconds of
+% sound as fast as possible. Then reports the cpu time spent in the audio
+% processing per buffer, as returned by PsychPortAudio('OfflineStatistics').
+%
+% No sound hardware is needed for this benchmark, and the results are not
+% disturbed by the timing behaviour of any sound hardware or host audio
+% api, so it is suitable to compare the efficiency of different versions
+% of the driver, or different settings, against each other.
+%
+% Parameters:
+%
+% topology = Vector with one element per master device, each element the
+% number of slave devices attached to that master. Defaults to [8], ie.,
+% one master with 8 slaves.
+%
+% nrchannels = Number of audio channels of all devices. Defaults to 2.
+%
+% buffersize = Number of sample frames per processed buffer. Defaults to 256.
+%
+% duration = Duration of sound to render per master in seconds. Defaults to 10.
+%
+% freq = Samplerate in Hz. Defaults to 48000.
+%
+% Returns a struct array 'results' with the statistics of each master.
+%
+
+% History:
+% 19.10.2026  agent  Written.
+
+if nargin < 1 || isempty(topology)
+    topology = 8;
+end
+
+if nargin < 2 || isempty(nrchannels)
+    nrchannels = 2;
+end
+
+if nargin < 3 || isempty(buffersize)
+    buffersize = 256;
+end
+
+if nargin < 4 || isempty(duration)
+    duration = 10;
+end
+
+if nargin < 5 || isempty(freq)
+    freq = 48000;
+end
+
+InitializePsychSound;
+oldverbosity = PsychPortAudio('Verbosity', 2);
+
+try
+    % One second of noise, played in an endless loop by all slaves:
+    noise = 0.1 * (2 * rand(nrchannels, freq) - 1);
+
+    masters = zeros(1, numel(topology));
+    slaves = [];
+    for m = 1:numel(topology)
+        % Playback master device, rendering as fast as possible:
+        masters(m) = PsychPortAudio('OpenOffline', 1 + 8, freq, nrchannels, buffersize);
+        for s = 1:topology(m)
+            slaves(end+1) = PsychPortAudio('OpenSlave', masters(m), 1, nrchannels); %#ok<AGROW>
+            PsychPortAudio('FillBuffer', slaves(end), noise);
+        end
+    end
+
+    % Start all slaves, then the masters:
+    for s = slaves
+        PsychPortAudio('Start', s, 0, 0, 0);
+    end
+
+    tstart = GetSecs;
+    for m = masters
+        PsychPortAudio('Start', m, 0, 0, 0);
+    end
+
+    % Wait until all masters have rendered 'duration' seconds of sound:
+    for m = masters
+        while 1
+            stats = PsychPortAudio('OfflineStatistics', m);
+            if stats.FramesRendered >= duration * freq
+                break;
+            end
+            WaitSecs('YieldSecs', 0.01);
+        end
+        PsychPortAudio('Stop', m);
+    end
+    telapsed = GetSecs - tstart;
+
+    for i = 1:numel(masters)
+        results(i) = PsychPortAudio('OfflineStatistics', masters(i)); %#ok<AGROW>
+    end
+
+    PsychPortAudio('Close');
+    PsychPortAudio('Verbosity', oldverbosity);
+catch
+    PsychPortAudio('Close');
+    PsychPortAudio('Verbosity', oldverbosity);
+    psychrethrow(psychlasterror);
+end
+
+fprintf('\nPsychPortAudio offline benchmark: %i channels, %i frames per buffer, %i Hz.\n', nrchannels, buffersize, freq);
+fprintf('Rendered %f seconds of sound per master in %f seconds of wall clock time.\n\n', duration, telapsed);
+if ~results(1).ThreadCPUClock
+    fprintf('Note: Cpu times are wall clock times on this operating system.\n\n');
+end
+
+for i = 1:numel(results)
+    fprintf('Master %i with %i slaves: %i buffers of %f msecs each.\n', i, topology(i), results(i).Buffers, 1000 * results(i).BufferDuration);
+    fprintf('  Cpu time per buffer: Mean %f msecs, median %f msecs, 99th percentile %f msecs, max %f msecs.\n', ...
+            1000 * results(i).MeanCPUTime, 1000 * results(i).MedianCPUTime, 1000 * results(i).P99CPUTime, 1000 * results(i).MaxCPUTime);
+    fprintf('  Cpu load %f %%, %f times faster than realtime.\n\n', 100 * results(i).CPULoad, results(i).RealtimeFactor);
+end
+
+return;